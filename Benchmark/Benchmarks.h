@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "../Common/Clock.h"
+#include "../Common/VertexTypes.h"
+
+// Each benchmark prints its own table to stdout
+void RunTransformBenchmark();
+void RunCullingBenchmark();
+void RunOcclusionBenchmark();
+void RunBvhBenchmark();
+void RunMeshBenchmark();
+void RunMeshOptimizerBenchmark();
+void RunVertexQuantizationBenchmark();
+void RunMeshCacheBenchmark();
+void RunImportBenchmark();
+void RunPrimitiveBenchmark();
+void RunIcosphereBenchmark();
+void RunSimplifyBenchmark();
+void RunCodecBenchmark();
+void RunTangentBenchmark();
+void RunJobBenchmark();
+void RunCommandBenchmark();
+void RunSortBenchmark();
+
+// Writes the triangles as an OBJ file (v, vn, f v//vn) that ImportMesh reads back as they were
+bool WriteBenchmarkObj(const char* fileName, const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices);
+
+// Calls of the global operator new so far, which MainFramework.cpp replaces to count them
+uint64_t GetAllocationCount();
+
+// Runs function once to warm up caches, then repeats it until at least minimumMilliseconds have passed.
+// Returns the average time of one run in milliseconds.
+template <typename Function>
+double MeasureMilliseconds(Function function, double minimumMilliseconds = 200.0)
+{
+	function();
+
+	uint32_t runCount = 0;
+	const uint64_t startTicks = Clock::GetTicks();
+	double elapsedMilliseconds = 0.0;
+	do
+	{
+		function();
+		++runCount;
+		elapsedMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - startTicks);
+	} while (elapsedMilliseconds < minimumMilliseconds);
+
+	return elapsedMilliseconds / runCount;
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/Bvh.h"
+
+namespace
+{
+	constexpr uint32_t OBJECT_COUNT = 1000000;
+	constexpr float WORLD_HALF_SIZE = 500.0f;
+	constexpr float MOVE_DISTANCE = 2.0f;
+	constexpr uint32_t RAY_COUNT = 100000;
+	constexpr uint32_t VERIFIED_RAY_COUNT = 16;
+	constexpr uint32_t BOX_QUERY_COUNT = 10000;
+	constexpr float BOX_QUERY_HALF_SIZE = 10.0f;
+
+	void FillRandomBoxes(uint32_t count, std::mt19937& random, BoxBoundsArrays& outBounds)
+	{
+		std::uniform_real_distribution<float> position(-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+		outBounds.Resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			outBounds.CenterX[i] = position(random);
+			outBounds.CenterY[i] = position(random);
+			outBounds.CenterZ[i] = position(random);
+			outBounds.ExtentX[i] = size(random);
+			outBounds.ExtentY[i] = size(random);
+			outBounds.ExtentZ[i] = size(random);
+		}
+	}
+
+	bool SameObjects(std::vector<uint32_t> a, uint32_t countA, std::vector<uint32_t> b, uint32_t countB)
+	{
+		if (countA != countB)
+		{
+			return false;
+		}
+		std::sort(a.begin(), a.begin() + countA);
+		std::sort(b.begin(), b.begin() + countB);
+		return std::equal(a.begin(), a.begin() + countA, b.begin());
+	}
+
+	// Closest box hit by testing every object
+	bool RayCastBruteForce(const BoxBoundsArrays& bounds, const Float3& origin, const Float3& direction, float maxDistance, BvhRayHit& outHit)
+	{
+		const float origins[3]{ origin.x, origin.y, origin.z };
+		const float inverseDirection[3]{ 1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z };
+		const std::vector<float>* centers[3]{ &bounds.CenterX, &bounds.CenterY, &bounds.CenterZ };
+		const std::vector<float>* extents[3]{ &bounds.ExtentX, &bounds.ExtentY, &bounds.ExtentZ };
+
+		bool bHit = false;
+		for (uint32_t i = 0; i < bounds.GetCount(); ++i)
+		{
+			float nearDistance = 0.0f;
+			float farDistance = maxDistance;
+			for (int32_t axis = 0; axis < 3; ++axis)
+			{
+				const float t0 = ((*centers[axis])[i] - (*extents[axis])[i] - origins[axis]) * inverseDirection[axis];
+				const float t1 = ((*centers[axis])[i] + (*extents[axis])[i] - origins[axis]) * inverseDirection[axis];
+				nearDistance = fmaxf(nearDistance, fminf(t0, t1));
+				farDistance = fminf(farDistance, fmaxf(t0, t1));
+			}
+			if (nearDistance <= farDistance && (!bHit || nearDistance < outHit.Distance))
+			{
+				outHit = { i, nearDistance };
+				maxDistance = nearDistance;
+				bHit = true;
+			}
+		}
+		return bHit;
+	}
+}
+
+void RunBvhBenchmark()
+{
+	std::mt19937 random(12345);
+	BoxBoundsArrays bounds;
+	FillRandomBoxes(OBJECT_COUNT, random, bounds);
+
+	printf("%u objects, %u-wide nodes, up to %u objects per leaf, %u SAH bins\n", OBJECT_COUNT, BVH_WIDTH, BVH_MAX_LEAF_SIZE, BVH_BIN_COUNT);
+
+	// Build
+	Bvh bvh;
+	const double buildMilliseconds = MeasureMilliseconds([&]() { bvh.Build(bounds); }, 0.0);
+	printf("build          %10.3f ms    %u nodes\n", buildMilliseconds, bvh.GetNodeCount());
+
+	// Frustum culling against the linear SIMD pass
+	const Float4x4 viewMatrix = MatrixLookAtLH({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f });
+	const Float4x4 projectionMatrix = MatrixPerspectiveFovLH(ConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	const Frustum frustum = ExtractFrustumPlanes(viewMatrix * projectionMatrix);
+
+	std::vector<uint32_t> linearIndices(OBJECT_COUNT);
+	std::vector<uint32_t> bvhIndices(OBJECT_COUNT);
+	uint32_t linearCount = 0;
+	uint32_t bvhCount = 0;
+	const double linearMilliseconds = MeasureMilliseconds([&]() { linearCount = CullBoxes(frustum, bounds, 0, OBJECT_COUNT, linearIndices.data()); });
+	const double bvhMilliseconds = MeasureMilliseconds([&]() { bvhCount = bvh.CullFrustum(frustum, bvhIndices.data()); });
+	printf("cull linear    %10.3f ms    %u visible\n", linearMilliseconds, linearCount);
+	printf("cull bvh       %10.3f ms    %u visible    matches: %s\n", bvhMilliseconds, bvhCount, SameObjects(linearIndices, linearCount, bvhIndices, bvhCount) ? "yes" : "NO");
+
+	// Rays from the camera through the frustum
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<Float3> rayDirections(RAY_COUNT);
+	for (Float3& direction : rayDirections)
+	{
+		direction = Normalize({ unit(random) * 0.4f, unit(random) * 0.25f, 1.0f });
+	}
+
+	uint32_t hitCount = 0;
+	const double rayMilliseconds = MeasureMilliseconds([&]()
+		{
+			hitCount = 0;
+			for (const Float3& direction : rayDirections)
+			{
+				BvhRayHit hit;
+				hitCount += bvh.RayCast({ 0.0f, 0.0f, 0.0f }, direction, 2000.0f, hit) ? 1 : 0;
+			}
+		});
+
+	bool bRaysMatch = true;
+	for (uint32_t i = 0; i < VERIFIED_RAY_COUNT; ++i)
+	{
+		BvhRayHit hit{};
+		BvhRayHit expectedHit{};
+		const bool bHit = bvh.RayCast({ 0.0f, 0.0f, 0.0f }, rayDirections[i], 2000.0f, hit);
+		const bool bExpectedHit = RayCastBruteForce(bounds, { 0.0f, 0.0f, 0.0f }, rayDirections[i], 2000.0f, expectedHit);
+		bRaysMatch = bRaysMatch && bHit == bExpectedHit && (!bHit || hit.Distance == expectedHit.Distance);
+	}
+	printf("ray cast       %10.3f ms    %.0f rays/s    %u hits    matches: %s\n", rayMilliseconds, RAY_COUNT * 1000.0 / rayMilliseconds, hitCount,
+		bRaysMatch ? "yes" : "NO");
+
+	// Box overlap queries
+	std::uniform_real_distribution<float> position(-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+	std::vector<Float3> queryCenters(BOX_QUERY_COUNT);
+	for (Float3& center : queryCenters)
+	{
+		center = { position(random), position(random), position(random) };
+	}
+
+	const Float3 queryHalfSize{ BOX_QUERY_HALF_SIZE, BOX_QUERY_HALF_SIZE, BOX_QUERY_HALF_SIZE };
+	uint64_t overlapCount = 0;
+	const double boxMilliseconds = MeasureMilliseconds([&]()
+		{
+			overlapCount = 0;
+			for (const Float3& center : queryCenters)
+			{
+				overlapCount += bvh.QueryBox(center - queryHalfSize, center + queryHalfSize, bvhIndices.data());
+			}
+		});
+	printf("box query      %10.3f ms    %.0f queries/s    %.1f objects per query\n", boxMilliseconds, BOX_QUERY_COUNT * 1000.0 / boxMilliseconds,
+		overlapCount / (double)BOX_QUERY_COUNT);
+
+	// Every object moves a little, as if animated, then the tree is refit until its cost calls for a rebuild
+	std::uniform_real_distribution<float> offset(-MOVE_DISTANCE, MOVE_DISTANCE);
+	for (int32_t step = 1; step <= 4; ++step)
+	{
+		for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+		{
+			bounds.CenterX[i] += offset(random) * step;
+			bounds.CenterY[i] += offset(random) * step;
+			bounds.CenterZ[i] += offset(random) * step;
+		}
+
+		const double refitMilliseconds = MeasureMilliseconds([&]() { bvh.Refit(bounds); }, 0.0);
+		bvhCount = bvh.CullFrustum(frustum, bvhIndices.data());
+		linearCount = CullBoxes(frustum, bounds, 0, OBJECT_COUNT, linearIndices.data());
+		printf("refit %d        %10.3f ms    cost ratio %.3f    matches: %s\n", step, refitMilliseconds, bvh.GetCostRatio(),
+			SameObjects(linearIndices, linearCount, bvhIndices, bvhCount) ? "yes" : "NO");
+	}
+
+	const double rebuildMilliseconds = MeasureMilliseconds([&]() { bvh.Build(bounds); }, 0.0);
+	printf("rebuild        %10.3f ms    cost ratio %.3f\n", rebuildMilliseconds, bvh.GetCostRatio());
+}
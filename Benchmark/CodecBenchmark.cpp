@@ -0,0 +1,122 @@
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MeshCache.h"
+#include "../Common/MeshCodec.h"
+#include "../Common/PrimitiveMeshes.h"
+
+namespace
+{
+	struct CodecBenchmarkMesh
+	{
+		const char* Name;
+		PrimitiveShape Shape;
+	};
+
+	// The largest sphere needs 32-bit indices
+	const CodecBenchmarkMesh CODEC_MESHES[] =
+	{
+		{ "box8", { PRIMITIVE_TYPE_BOX, 8, 0 } },
+		{ "uvsphere64", { PRIMITIVE_TYPE_UV_SPHERE, 64, 64 } },
+		{ "uvsphere1024", { PRIMITIVE_TYPE_UV_SPHERE, 1024, 1024 } },
+		{ "icosphere6", { PRIMITIVE_TYPE_ICOSPHERE, 6, 0 } },
+		{ "torus", { PRIMITIVE_TYPE_TORUS, 128, 64 } },
+	};
+
+	// Same chain as the Lighting sample
+	const int32_t LOD_SEGMENT_COUNTS[] = { 256, 128, 64, 32, 16, 8, 4 };
+
+	double GetMegabytesPerSecond(size_t size, double milliseconds)
+	{
+		return milliseconds > 0.0 ? size / (1024.0 * 1024.0) / (milliseconds / 1000.0) : 0.0;
+	}
+
+	void PrintRow(const char* name, const char* stream, size_t rawSize, size_t encodedSize, double encodeMilliseconds, double decodeMilliseconds,
+		double scalarMilliseconds, bool bMatches)
+	{
+		char scalarText[32] = "-";
+		if (scalarMilliseconds > 0.0)
+		{
+			snprintf(scalarText, sizeof(scalarText), "%.1f", GetMegabytesPerSecond(rawSize, scalarMilliseconds));
+		}
+		printf("%-13s %-9s %10.1f %10.1f %7.2f %10.1f %10.1f %10s %8s\n", name, stream, rawSize / 1024.0, encodedSize / 1024.0, (double)rawSize / encodedSize,
+			GetMegabytesPerSecond(rawSize, encodeMilliseconds), GetMegabytesPerSecond(rawSize, decodeMilliseconds), scalarText, bMatches ? "yes" : "NO");
+	}
+
+	void RunVertexRow(const char* name, const char* stream, const void* vertices, uint32_t vertexCount, uint32_t vertexSize)
+	{
+		const size_t rawSize = (size_t)vertexCount * vertexSize;
+		std::vector<uint8_t> encoded;
+		const double encodeMilliseconds = MeasureMilliseconds([&]() { EncodeVertexBuffer(vertices, vertexCount, vertexSize, encoded); });
+
+		std::vector<uint8_t> decoded(rawSize);
+		std::vector<uint8_t> scalarDecoded(rawSize);
+		bool bDecoded = true;
+		const double decodeMilliseconds = MeasureMilliseconds([&]()
+			{
+				bDecoded = DecodeVertexBuffer(encoded.data(), encoded.size(), decoded.data(), vertexCount, vertexSize) && bDecoded;
+			});
+		const double scalarMilliseconds = MeasureMilliseconds([&]()
+			{
+				bDecoded = DecodeVertexBufferScalar(encoded.data(), encoded.size(), scalarDecoded.data(), vertexCount, vertexSize) && bDecoded;
+			});
+
+		const bool bMatches = bDecoded && !memcmp(decoded.data(), vertices, rawSize) && decoded == scalarDecoded;
+		PrintRow(name, stream, rawSize, encoded.size(), encodeMilliseconds, decodeMilliseconds, scalarMilliseconds, bMatches);
+	}
+
+	template <typename Index>
+	void RunIndexRow(const char* name, const std::vector<Index>& indices)
+	{
+		const uint32_t indexCount = (uint32_t)indices.size();
+		std::vector<uint8_t> encoded;
+		const double encodeMilliseconds = MeasureMilliseconds([&]() { EncodeIndexBuffer(indices.data(), indexCount, encoded); });
+
+		std::vector<Index> decoded(indexCount);
+		bool bDecoded = true;
+		const double decodeMilliseconds = MeasureMilliseconds([&]()
+			{
+				bDecoded = DecodeIndexBuffer(encoded.data(), encoded.size(), decoded.data(), indexCount) && bDecoded;
+			});
+
+		PrintRow(name, sizeof(Index) == sizeof(uint16_t) ? "index16" : "index32", indices.size() * sizeof(Index), encoded.size(), encodeMilliseconds,
+			decodeMilliseconds, 0.0, bDecoded && decoded == indices);
+	}
+
+	// Both vertex streams and the indices, as WriteMeshCache compresses them
+	void RunCodecRows(const char* name, const MeshCacheData& meshes)
+	{
+		const uint32_t vertexCount = (uint32_t)meshes.Vertices.size();
+		RunVertexRow(name, "vertices", meshes.Vertices.data(), vertexCount, sizeof(VertexData));
+		RunVertexRow(name, "quantized", meshes.QuantizedVertices.data(), vertexCount, sizeof(QuantizedVertexData));
+		if (meshes.Indices.Format == INDEX_FORMAT_UINT16)
+		{
+			RunIndexRow(name, meshes.Indices.Indices16);
+		}
+		else
+		{
+			RunIndexRow(name, meshes.Indices.Indices32);
+		}
+	}
+}
+
+void RunCodecBenchmark()
+{
+	printf("Lossless vertex and index codec on meshes optimized for the vertex cache, with both vertex streams\n");
+	printf("Decode is the SSE2 path, scalar the byte at a time reference. Matches checks both against the source.\n");
+	printf("%-13s %-9s %10s %10s %7s %10s %10s %10s %8s\n", "mesh", "stream", "raw KB", "encoded KB", "ratio", "enc MB/s", "dec MB/s", "scalar", "matches");
+
+	for (const CodecBenchmarkMesh& mesh : CODEC_MESHES)
+	{
+		MeshCacheData meshes;
+		GeneratePrimitiveLodMeshes(&mesh.Shape, 1, true, meshes);
+		RunCodecRows(mesh.Name, meshes);
+	}
+
+	MeshCacheData meshes;
+	GenerateSphereLodMeshes(LOD_SEGMENT_COUNTS, (uint32_t)std::size(LOD_SEGMENT_COUNTS), true, meshes);
+	RunCodecRows("lighting", meshes);
+}
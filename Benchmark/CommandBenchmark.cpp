@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/JobSystem.h"
+#include "../Common/NullRenderDevice.h"
+
+namespace
+{
+	constexpr uint32_t OBJECT_COUNT = 262144;
+	const uint32_t THREAD_COUNTS[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+	// Objects per command list, the same as the Lighting sample
+	constexpr uint32_t LIST_OBJECT_COUNT = 1024;
+
+	// Object constant ranges the draws cycle through
+	constexpr uint32_t CONSTANT_RANGE_COUNT = 4096;
+
+	// Resources of per-object draws like the Lighting sample without instancing: one triangle, with the frame and view
+	// constants and one constant buffer range per object
+	struct CommandBenchmarkResources
+	{
+		BufferHandle VertexBuffer;
+		BufferHandle IndexBuffer;
+		BufferHandle FrameConstantBuffer;
+		BufferHandle ViewConstantBuffer;
+		BufferHandle ObjectConstantBuffer;
+		InputLayoutHandle InputLayout;
+		VertexShaderHandle VertexShader;
+		PixelShaderHandle PixelShader;
+		RasterizerStateHandle RasterizerState;
+	};
+
+	bool InitResources(RenderDevice& device, CommandBenchmarkResources& outResources)
+	{
+		const VertexData vertices[3]{};
+		const uint16_t indices[3]{ 0, 1, 2 };
+		const Float4 constants{};
+		outResources.VertexBuffer = device.CreateBuffer({ BUFFER_TYPE_VERTEX, BUFFER_USAGE_IMMUTABLE, sizeof(vertices) }, vertices);
+		outResources.IndexBuffer = device.CreateBuffer({ BUFFER_TYPE_INDEX, BUFFER_USAGE_IMMUTABLE, sizeof(indices) }, indices);
+		outResources.FrameConstantBuffer = device.CreateBuffer({ BUFFER_TYPE_CONSTANT, BUFFER_USAGE_DEFAULT, sizeof(constants) }, &constants);
+		outResources.ViewConstantBuffer = device.CreateBuffer({ BUFFER_TYPE_CONSTANT, BUFFER_USAGE_DEFAULT, sizeof(constants) }, &constants);
+		outResources.ObjectConstantBuffer = device.CreateBuffer({ BUFFER_TYPE_CONSTANT, BUFFER_USAGE_DEFAULT, CONSTANT_RANGE_COUNT * CONSTANT_BUFFER_ALIGNMENT }, nullptr);
+
+		outResources.VertexShader = device.CreateVertexShader({ "Lighting.hlsl", nullptr, "VSPerObject", "vs_4_1" });
+		outResources.PixelShader = device.CreatePixelShader({ "Lighting.hlsl", nullptr, "PS", "ps_4_1" });
+		const InputElementDesc elements[]
+		{
+			{ "POSITION", 0, VERTEX_FORMAT_FLOAT3, 0, 0 },
+			{ "NORMAL", 0, VERTEX_FORMAT_FLOAT3, 0, 12 }
+		};
+		outResources.InputLayout = device.CreateInputLayout(elements, 2, outResources.VertexShader);
+		outResources.RasterizerState = device.CreateRasterizerState({ FILL_MODE_SOLID, CULL_MODE_NONE, false, true });
+
+		return outResources.VertexBuffer.IsValid() && outResources.IndexBuffer.IsValid() && outResources.ObjectConstantBuffer.IsValid() && outResources.InputLayout.IsValid();
+	}
+
+	void BindState(RenderContext& context, const CommandBenchmarkResources& resources)
+	{
+		context.SetRasterizerState(resources.RasterizerState);
+		context.SetInputLayout(resources.InputLayout);
+		context.SetVertexBuffer(0, resources.VertexBuffer, sizeof(VertexData), 0);
+		context.SetIndexBuffer(resources.IndexBuffer, INDEX_FORMAT_UINT16, 0);
+		context.SetVertexShader(resources.VertexShader);
+		context.SetVertexConstantBuffer(0, resources.FrameConstantBuffer);
+		context.SetVertexConstantBuffer(1, resources.ViewConstantBuffer);
+		context.SetPixelShader(resources.PixelShader);
+	}
+
+	void DrawObjects(RenderContext& context, const CommandBenchmarkResources& resources, uint32_t begin, uint32_t end)
+	{
+		for (uint32_t object = begin; object < end; ++object)
+		{
+			context.SetVertexConstantBufferRange(2, resources.ObjectConstantBuffer, object % CONSTANT_RANGE_COUNT * CONSTANT_BUFFER_ALIGNMENT, CONSTANT_BUFFER_ALIGNMENT);
+			context.DrawIndexed(3, 0, 0);
+		}
+	}
+}
+
+void RunCommandBenchmark()
+{
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const uint32_t maxThreadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+	const uint32_t listCount = (OBJECT_COUNT + LIST_OBJECT_COUNT - 1) / LIST_OBJECT_COUNT;
+
+	NullRenderDevice device;
+	device.Init(false);
+	CommandBenchmarkResources resources;
+	if (!InitResources(device, resources))
+	{
+		printf("Failed to create the resources of the command benchmark\n");
+		return;
+	}
+
+	std::vector<CommandList*> commandLists(listCount);
+	for (CommandList*& commandList : commandLists)
+	{
+		commandList = device.CreateCommandList();
+	}
+
+	// Every object on the immediate context of the null device, the reference for the lists
+	const double immediateMilliseconds = MeasureMilliseconds([&]()
+		{
+			BindState(device, resources);
+			DrawObjects(device, resources, 0, OBJECT_COUNT);
+			device.Present();
+		});
+	const RenderDeviceStats immediateStats = device.GetFrameStats();
+
+	printf("Command lists: %u per-object draws (constant buffer range and DrawIndexed) recorded in %u lists of %u objects by 1 to %u threads (%u hardware threads)\n",
+		OBJECT_COUNT, listCount, LIST_OBJECT_COUNT, maxThreadCount, hardwareThreadCount);
+	printf("Immediate: %.3f ms for the same draws validated on the null device without lists. Execute validates and runs every list on the calling thread.\n",
+		immediateMilliseconds);
+	printf("Matches compares the draws and indices executed with those of the immediate context, without validation errors.\n");
+	printf("%8s %12s %10s %12s %14s %9s %12s %8s\n", "threads", "commands", "record ms", "M cmd/s", "M cmd/s/thread", "speedup", "execute ms", "matches");
+
+	double oneThreadMilliseconds = 0.0;
+	for (uint32_t threadCount : THREAD_COUNTS)
+	{
+		if (threadCount > maxThreadCount)
+		{
+			break;
+		}
+
+		JobSystem jobSystem;
+		jobSystem.Init(threadCount);
+		const double recordMilliseconds = MeasureMilliseconds([&]()
+			{
+				jobSystem.ParallelFor(OBJECT_COUNT, LIST_OBJECT_COUNT, [&](uint32_t begin, uint32_t end, uint32_t)
+					{
+						CommandList& commandList = *commandLists[begin / LIST_OBJECT_COUNT];
+						commandList.Begin();
+						BindState(commandList, resources);
+						DrawObjects(commandList, resources, begin, end);
+						commandList.End();
+					});
+			});
+		jobSystem.Free();
+
+		uint64_t commandCount = 0;
+		for (const CommandList* commandList : commandLists)
+		{
+			commandCount += commandList->GetCommandCount();
+		}
+
+		const uint32_t errorCount = device.GetValidationErrorCount();
+		const double executeMilliseconds = MeasureMilliseconds([&]()
+			{
+				for (CommandList* commandList : commandLists)
+				{
+					device.ExecuteCommandList(commandList);
+				}
+				device.Present();
+			});
+		const RenderDeviceStats& executedStats = device.GetFrameStats();
+		const bool bMatches = executedStats.DrawCount == immediateStats.DrawCount && executedStats.IndexCount == immediateStats.IndexCount &&
+			device.GetValidationErrorCount() == errorCount;
+
+		if (threadCount == 1)
+		{
+			oneThreadMilliseconds = recordMilliseconds;
+		}
+		const double commandsPerSecond = commandCount / 1000.0 / recordMilliseconds;
+		printf("%8u %12llu %10.3f %12.2f %14.2f %9.2f %12.3f %8s\n", threadCount, (unsigned long long)commandCount, recordMilliseconds, commandsPerSecond,
+			commandsPerSecond / threadCount, oneThreadMilliseconds / recordMilliseconds, executeMilliseconds, bMatches ? "yes" : "NO");
+	}
+
+	device.Free();
+}
@@ -0,0 +1,100 @@
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/FrustumCulling.h"
+#include "../Common/Simd.h"
+#include "../Common/ThreadPool.h"
+
+namespace
+{
+	constexpr uint32_t OBJECT_COUNT = 1000000;
+	constexpr float WORLD_HALF_SIZE = 500.0f;
+	const uint32_t THREAD_COUNTS[] = { 1, 2, 4, 8, 16 };
+
+	void FillRandomBounds(uint32_t count, SphereBoundsArrays& outSpheres, BoxBoundsArrays& outBoxes)
+	{
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<float> position(-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+		outSpheres.Resize(count);
+		outBoxes.Resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			outSpheres.CenterX[i] = outBoxes.CenterX[i] = position(random);
+			outSpheres.CenterY[i] = outBoxes.CenterY[i] = position(random);
+			outSpheres.CenterZ[i] = outBoxes.CenterZ[i] = position(random);
+			outSpheres.Radius[i] = size(random);
+			outBoxes.ExtentX[i] = size(random);
+			outBoxes.ExtentY[i] = size(random);
+			outBoxes.ExtentZ[i] = size(random);
+		}
+	}
+
+	void PrintRow(const char* name, uint32_t threadCount, double milliseconds, uint32_t visibleCount, bool bMatches)
+	{
+		printf("%-8s %-10s %8u %10.3f %14.0f %10u %8s\n", name, threadCount ? "parallel" : "serial", threadCount ? threadCount : 1, milliseconds,
+			OBJECT_COUNT / milliseconds, visibleCount, bMatches ? "yes" : "NO");
+	}
+
+	// Compares against the scalar reference, then times the serial SIMD path and the parallel one at every thread count
+	template <typename Bounds, typename CullFunction, typename CullParallelFunction>
+	void BenchmarkBounds(const char* name, const Frustum& frustum, const Bounds& bounds, CullFunction cullScalar, CullFunction cull,
+		CullParallelFunction cullParallel, uint32_t maxThreadCount)
+	{
+		std::vector<uint32_t> referenceIndices(OBJECT_COUNT);
+		std::vector<uint32_t> visibleIndices(OBJECT_COUNT);
+
+		uint32_t referenceCount = 0;
+		const double scalarMilliseconds = MeasureMilliseconds([&]() { referenceCount = cullScalar(frustum, bounds, 0, OBJECT_COUNT, referenceIndices.data()); });
+		printf("%-8s %-10s %8u %10.3f %14.0f %10u %8s\n", name, "scalar", 1u, scalarMilliseconds, OBJECT_COUNT / scalarMilliseconds, referenceCount, "-");
+
+		auto matches = [&](uint32_t visibleCount)
+		{
+			return visibleCount == referenceCount && !memcmp(visibleIndices.data(), referenceIndices.data(), visibleCount * sizeof(uint32_t));
+		};
+
+		uint32_t visibleCount = 0;
+		const double simdMilliseconds = MeasureMilliseconds([&]() { visibleCount = cull(frustum, bounds, 0, OBJECT_COUNT, visibleIndices.data()); });
+		PrintRow(name, 0, simdMilliseconds, visibleCount, matches(visibleCount));
+
+		for (uint32_t threadCount : THREAD_COUNTS)
+		{
+			if (threadCount > maxThreadCount)
+			{
+				break;
+			}
+
+			ThreadPool threadPool;
+			threadPool.Init(threadCount);
+			const double parallelMilliseconds = MeasureMilliseconds([&]() { visibleCount = cullParallel(threadPool, frustum, bounds, visibleIndices.data()); });
+			PrintRow(name, threadCount, parallelMilliseconds, visibleCount, matches(visibleCount));
+			threadPool.Free();
+		}
+	}
+}
+
+void RunCullingBenchmark()
+{
+	SphereBoundsArrays spheres;
+	BoxBoundsArrays boxes;
+	FillRandomBounds(OBJECT_COUNT, spheres, boxes);
+
+	// Camera in the middle of the objects, so roughly a tenth of them is visible
+	const Float4x4 viewMatrix = MatrixLookAtLH({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f });
+	const Float4x4 projectionMatrix = MatrixPerspectiveFovLH(ConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	const Frustum frustum = ExtractFrustumPlanes(viewMatrix * projectionMatrix);
+
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+	printf("%u objects, %d per SIMD iteration, %u hardware threads\n", OBJECT_COUNT, SIMD_WIDTH, hardwareThreadCount);
+	printf("%-8s %-10s %8s %10s %14s %10s %8s\n", "bounds", "path", "threads", "ms", "objects/ms", "visible", "matches");
+
+	const uint32_t maxThreadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+	BenchmarkBounds("sphere", frustum, spheres, CullSpheresScalar, CullSpheres, CullSpheresParallel, maxThreadCount);
+	BenchmarkBounds("aabb", frustum, boxes, CullBoxesScalar, CullBoxes, CullBoxesParallel, maxThreadCount);
+}
@@ -0,0 +1,120 @@
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/PrimitiveMeshes.h"
+#include "../Common/ThreadPool.h"
+
+namespace
+{
+	// Slices and rings of each UV sphere, about the triangle counts of icosphere levels 1 to 8
+	const int32_t UV_SEGMENT_COUNTS[] = { 6, 13, 25, 51, 101, 202, 405, 810 };
+
+	// Levels timed serial and in parallel, up to 1.3 million triangles
+	const int32_t TIMED_LEVELS[] = { 5, 6, 7, 8 };
+
+	struct SphereQuality
+	{
+		// Largest distance between the surface and the unit sphere, the error along the silhouette, relative to the radius
+		float SilhouetteError;
+		// Areas of the smallest and the largest triangle
+		float AreaRatio;
+		// Longest edge against the one of an equilateral triangle of the same area, 1 for an equilateral one
+		float MaxAspectRatio;
+	};
+
+	SphereQuality MeasureSphere(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices)
+	{
+		float innerRadius = FLT_MAX;
+		float minArea = FLT_MAX;
+		float maxArea = 0.0f;
+		float maxAspectRatio = 0.0f;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			const Float3& p0 = vertices[indices[i + 0]].Position;
+			const Float3& p1 = vertices[indices[i + 1]].Position;
+			const Float3& p2 = vertices[indices[i + 2]].Position;
+
+			const Float3 normal = Cross(p1 - p0, p2 - p0);
+			const float normalLength = Length(normal);
+			if (normalLength > 0.0f)
+			{
+				const float area = 0.5f * normalLength;
+				const float longestEdge = fmaxf(Length(p1 - p0), fmaxf(Length(p2 - p1), Length(p0 - p2)));
+				innerRadius = fminf(innerRadius, fabsf(Dot(normal, p0)) / normalLength);
+				minArea = fminf(minArea, area);
+				maxArea = fmaxf(maxArea, area);
+				maxAspectRatio = fmaxf(maxAspectRatio, longestEdge / sqrtf(4.0f * area / sqrtf(3.0f)));
+			}
+		}
+		return { 1.0f - innerRadius, minArea / maxArea, maxAspectRatio };
+	}
+
+	void PrintQualityRow(const char* name, int32_t size, const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices)
+	{
+		const SphereQuality quality = MeasureSphere(vertices, indices);
+		printf("%-10s %5d %10zu %10zu %14.3e %16.2f %12.4f %12.2f\n", name, size, indices.size() / 3, vertices.size(), quality.SilhouetteError,
+			quality.SilhouetteError * 1000.0f, quality.AreaRatio, quality.MaxAspectRatio);
+	}
+
+	bool IsSameMesh(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices, const std::vector<VertexData>& referenceVertices,
+		const std::vector<uint32_t>& referenceIndices)
+	{
+		return vertices.size() == referenceVertices.size() && indices == referenceIndices
+			&& !memcmp(vertices.data(), referenceVertices.data(), vertices.size() * sizeof(VertexData));
+	}
+}
+
+void RunIcosphereBenchmark()
+{
+	printf("UV spheres against icospheres of about the same triangle counts, unit radius\n");
+	printf("Error px is the silhouette error of a sphere 1000 pixels in radius, min/max area and aspect show the thin triangles\n");
+	printf("%-10s %5s %10s %10s %14s %16s %12s %12s\n", "mesh", "size", "triangles", "vertices", "silhouette err", "error px @1000", "min/max area",
+		"max aspect");
+
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+	for (int32_t segmentCount : UV_SEGMENT_COUNTS)
+	{
+		GenerateSphere(segmentCount, segmentCount, vertices, indices);
+		PrintQualityRow("uvsphere", segmentCount, vertices, indices);
+	}
+	for (int32_t level = 0; level <= ICOSPHERE_MAX_LEVEL; ++level)
+	{
+		GenerateIcosphere(level, vertices, indices);
+		PrintQualityRow("icosphere", level, vertices, indices);
+	}
+
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const uint32_t threadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+
+	printf("\nIcosphere generation with 32-bit indices, %u hardware threads. Matches compares with the serial path and with WritePrimitive.\n",
+		hardwareThreadCount);
+	printf("%5s %10s %-10s %8s %10s %14s %8s\n", "level", "triangles", "path", "threads", "ms", "Mtriangles/s", "matches");
+
+	ThreadPool threadPool;
+	threadPool.Init(threadCount);
+	for (int32_t level : TIMED_LEVELS)
+	{
+		const PrimitiveShape shape{ PRIMITIVE_TYPE_ICOSPHERE, level, 0 };
+		std::vector<VertexData> referenceVertices(GetPrimitiveVertexCount(shape));
+		std::vector<uint32_t> referenceIndices(GetPrimitiveIndexCount(shape));
+		std::vector<uint64_t> scratch(GetPrimitiveScratchCount(shape));
+		WritePrimitive(shape, referenceVertices.data(), referenceIndices.data(), scratch.data());
+		const double triangleCount = referenceIndices.size() / 3.0;
+
+		const double serialMilliseconds = MeasureMilliseconds([&]() { GenerateIcosphere(level, vertices, indices); });
+		printf("%5d %10.0f %-10s %8u %10.3f %14.1f %8s\n", level, triangleCount, "serial", 1, serialMilliseconds, triangleCount / serialMilliseconds / 1000.0,
+			IsSameMesh(vertices, indices, referenceVertices, referenceIndices) ? "yes" : "NO");
+
+		const double parallelMilliseconds = MeasureMilliseconds([&]() { GenerateIcosphere(level, vertices, indices, &threadPool); });
+		printf("%5d %10.0f %-10s %8u %10.3f %14.1f %8s\n", level, triangleCount, "parallel", threadCount, parallelMilliseconds,
+			triangleCount / parallelMilliseconds / 1000.0, IsSameMesh(vertices, indices, referenceVertices, referenceIndices) ? "yes" : "NO");
+	}
+	threadPool.Free();
+}
@@ -0,0 +1,242 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/MeshImporter.h"
+#include "../Common/ThreadPool.h"
+
+namespace
+{
+	// Slices and rings of each sphere. The largest writes a 680 MB OBJ and a 192 MB .glb.
+	const int32_t IMPORT_SEGMENT_COUNTS[] = { 512, 2048 };
+	const char* IMPORT_BENCHMARK_OBJ_FILE_NAME = "ImportBenchmark.obj";
+	const char* IMPORT_BENCHMARK_GLB_FILE_NAME = "ImportBenchmark.glb";
+	const char* IMPORT_DAMAGED_GLTF_FILE_NAME = "ImportDamaged.gltf";
+	const char* IMPORT_DAMAGED_BIN_FILE_NAME = "ImportDamaged.bin";
+
+	// One triangle, 36 bytes of positions then 6 of 16-bit indices, with one byte offset or length damaged at a time.
+	// Only the intact file may be imported.
+	struct DamagedGltf
+	{
+		const char* Name;
+		const char* AccessorOffset;
+		const char* ViewOffset;
+		const char* BufferLength;
+	};
+	const DamagedGltf DAMAGED_GLTFS[] = {
+		{ "intact", "0", "0", "42" },
+		{ "negative accessor offset", "-1", "0", "42" },
+		{ "fractional accessor offset", "0.5", "0", "42" },
+		{ "huge accessor offset", "1e300", "0", "42" },
+		{ "accessor offset past view", "36", "0", "42" },
+		{ "negative view offset", "0", "-4", "42" },
+		{ "negative buffer length", "0", "0", "-1" },
+	};
+
+	// One mesh with one primitive, positions, normals and 32-bit indices one after another in the binary chunk
+	bool WriteGlb(const char* fileName, const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices)
+	{
+		const size_t vertexCount = vertices.size();
+		std::vector<Float3> streams(vertexCount * 2);
+		Float3 minimum = vertices[0].Position;
+		Float3 maximum = vertices[0].Position;
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			const Float3 position{ vertices[i].Position.x, vertices[i].Position.y, -vertices[i].Position.z };
+			streams[i] = position;
+			streams[vertexCount + i] = Float3{ vertices[i].Normal.x, vertices[i].Normal.y, -vertices[i].Normal.z };
+			minimum = Float3{ fminf(minimum.x, position.x), fminf(minimum.y, position.y), fminf(minimum.z, position.z) };
+			maximum = Float3{ fmaxf(maximum.x, position.x), fmaxf(maximum.y, position.y), fmaxf(maximum.z, position.z) };
+		}
+		const size_t streamSize = vertexCount * sizeof(Float3);
+		const size_t indexSize = indices.size() * sizeof(uint32_t);
+		const size_t binarySize = streamSize * 2 + indexSize;
+		std::vector<uint32_t> reversedIndices(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			reversedIndices[i] = indices[i];
+			reversedIndices[i + 1] = indices[i + 2];
+			reversedIndices[i + 2] = indices[i + 1];
+		}
+
+		char json[2048];
+		int jsonLength = snprintf(json, sizeof(json),
+			"{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+			"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1},\"indices\":2}]}],"
+			"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC3\",\"min\":[%.9g,%.9g,%.9g],\"max\":[%.9g,%.9g,%.9g]},"
+			"{\"bufferView\":1,\"componentType\":5126,\"count\":%zu,\"type\":\"VEC3\"},"
+			"{\"bufferView\":2,\"componentType\":5125,\"count\":%zu,\"type\":\"SCALAR\"}],"
+			"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%zu},{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu},"
+			"{\"buffer\":0,\"byteOffset\":%zu,\"byteLength\":%zu}],\"buffers\":[{\"byteLength\":%zu}]}",
+			vertexCount, minimum.x, minimum.y, minimum.z, maximum.x, maximum.y, maximum.z, vertexCount, indices.size(),
+			streamSize, streamSize, streamSize, streamSize * 2, indexSize, binarySize);
+		while (jsonLength % 4)
+		{
+			json[jsonLength++] = ' ';
+		}
+
+		FILE* file = fopen(fileName, "wb");
+		if (!file)
+		{
+			return false;
+		}
+
+		const uint32_t header[5]{ 0x46546C67, 2, (uint32_t)(12 + 8 + jsonLength + 8 + binarySize), (uint32_t)jsonLength, 0x4E4F534A };
+		const uint32_t binaryHeader[2]{ (uint32_t)binarySize, 0x004E4942 };
+		const bool bWritten = fwrite(header, sizeof(header), 1, file) == 1 && fwrite(json, jsonLength, 1, file) == 1
+			&& fwrite(binaryHeader, sizeof(binaryHeader), 1, file) == 1 && fwrite(streams.data(), streamSize * 2, 1, file) == 1
+			&& fwrite(reversedIndices.data(), indexSize, 1, file) == 1;
+		return fclose(file) == 0 && bWritten;
+	}
+
+	bool WriteDamagedGltf(const DamagedGltf& damage)
+	{
+		char json[1024];
+		const int jsonLength = snprintf(json, sizeof(json),
+			"{\"asset\":{\"version\":\"2.0\"},\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}],"
+			"\"accessors\":[{\"bufferView\":0,\"byteOffset\":%s,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\"},"
+			"{\"bufferView\":1,\"componentType\":5123,\"count\":3,\"type\":\"SCALAR\"}],"
+			"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":%s,\"byteLength\":36},{\"buffer\":0,\"byteOffset\":36,\"byteLength\":6}],"
+			"\"buffers\":[{\"uri\":\"%s\",\"byteLength\":%s}]}",
+			damage.AccessorOffset, damage.ViewOffset, IMPORT_DAMAGED_BIN_FILE_NAME, damage.BufferLength);
+
+		FILE* file = fopen(IMPORT_DAMAGED_GLTF_FILE_NAME, "wb");
+		if (!file)
+		{
+			return false;
+		}
+		const bool bWritten = fwrite(json, jsonLength, 1, file) == 1;
+		return fclose(file) == 0 && bWritten;
+	}
+
+	// Welding renumbers the vertices in the order of first use, so the triangles are compared corner by corner
+	bool IsSameTriangles(const ImportedMesh& mesh, const std::vector<VertexData>& referenceVertices, const std::vector<uint32_t>& referenceIndices)
+	{
+		if (mesh.Vertices.size() != referenceVertices.size() || mesh.Indices.GetCount() != referenceIndices.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < referenceIndices.size(); ++i)
+		{
+			const uint32_t index = mesh.Indices.Format == INDEX_FORMAT_UINT16 ? mesh.Indices.Indices16[i] : mesh.Indices.Indices32[i];
+			if (memcmp(&mesh.Vertices[index], &referenceVertices[referenceIndices[i]], sizeof(VertexData)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+// Z is negated and the triangles reversed on the way out, as the importer does on the way in
+bool WriteBenchmarkObj(const char* fileName, const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices)
+{
+	FILE* file = fopen(fileName, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	static char buffer[1 << 20];
+	setvbuf(file, buffer, _IOFBF, sizeof(buffer));
+	fprintf(file, "# %zu vertices, %zu triangles\n", vertices.size(), indices.size() / 3);
+	for (const VertexData& vertex : vertices)
+	{
+		fprintf(file, "v %.9g %.9g %.9g\n", vertex.Position.x, vertex.Position.y, -vertex.Position.z);
+	}
+	for (const VertexData& vertex : vertices)
+	{
+		fprintf(file, "vn %.9g %.9g %.9g\n", vertex.Normal.x, vertex.Normal.y, -vertex.Normal.z);
+	}
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		fprintf(file, "f %u//%u %u//%u %u//%u\n", indices[i] + 1, indices[i] + 1, indices[i + 2] + 1, indices[i + 2] + 1, indices[i + 1] + 1, indices[i + 1] + 1);
+	}
+	return fclose(file) == 0;
+}
+
+void RunImportBenchmark()
+{
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+
+	printf("Sphere written as OBJ (v, vn, f v//vn) and .glb, then imported, %u hardware threads\n", hardwareThreadCount);
+	printf("Peak is the peak working set of the process so far, mapped file pages included\n");
+	printf("%-6s %9s %10s %8s %10s %10s %10s %10s %10s %10s %8s\n", "format", "segments", "file MB", "threads", "parse ms", "weld ms", "total ms", "MB/s",
+		"vertices", "peak MB", "matches");
+
+	ThreadPool threadPool;
+	threadPool.Init(hardwareThreadCount);
+
+	for (int32_t segmentCount : IMPORT_SEGMENT_COUNTS)
+	{
+		std::vector<VertexData> vertices;
+		std::vector<uint32_t> indices;
+		GenerateSphere(segmentCount, segmentCount, vertices, indices);
+
+		const char* fileNames[]{ IMPORT_BENCHMARK_OBJ_FILE_NAME, IMPORT_BENCHMARK_GLB_FILE_NAME };
+		const bool bWritten[]{ WriteBenchmarkObj(fileNames[0], vertices, indices), WriteGlb(fileNames[1], vertices, indices) };
+		for (uint32_t file = 0; file < 2; ++file)
+		{
+			if (!bWritten[file])
+			{
+				printf("Failed to write %s\n", fileNames[file]);
+				continue;
+			}
+
+			// Serial, then on every hardware thread
+			const uint32_t threadCounts[]{ 1, hardwareThreadCount };
+			for (uint32_t i = 0; i < (hardwareThreadCount > 1 ? 2u : 1u); ++i)
+			{
+				const uint32_t threadCount = threadCounts[i];
+				ImportedMesh mesh;
+				MeshImportStats stats;
+				const bool bImported = ImportMesh(fileNames[file], mesh, threadCount > 1 ? &threadPool : nullptr, &stats);
+				if (!bImported)
+				{
+					printf("Failed to import %s: %s\n", fileNames[file], stats.Error);
+					break;
+				}
+
+				printf("%-6s %9d %10.2f %8u %10.3f %10.3f %10.3f %10.1f %10u %10.1f %8s\n", file == 0 ? "obj" : "glb", segmentCount, stats.FileSize / (1024.0 * 1024.0),
+					stats.ThreadCount, stats.ParseMilliseconds, stats.WeldMilliseconds, stats.TotalMilliseconds, stats.GetThroughput(), stats.VertexCount,
+					stats.PeakMemory / (1024.0 * 1024.0), IsSameTriangles(mesh, vertices, indices) ? "yes" : "NO");
+			}
+			remove(fileNames[file]);
+		}
+	}
+
+	// Byte counts that wrap around, round down or point past the view must not let an accessor read outside its buffer
+	const Float3 positions[3]{ { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+	const uint16_t triangle[3]{ 0, 1, 2 };
+	FILE* binaryFile = fopen(IMPORT_DAMAGED_BIN_FILE_NAME, "wb");
+	const bool bBinaryWritten = binaryFile && fwrite(positions, sizeof(positions), 1, binaryFile) == 1 && fwrite(triangle, sizeof(triangle), 1, binaryFile) == 1;
+	if (!binaryFile || fclose(binaryFile) != 0 || !bBinaryWritten)
+	{
+		printf("Failed to write %s\n", IMPORT_DAMAGED_BIN_FILE_NAME);
+		return;
+	}
+
+	printf("\nDamaged glTF: one triangle with a byte offset or length replaced by a negative, fractional or out-of-range value. Matches checks that only the intact one is imported.\n");
+	printf("%-28s %-50s %8s\n", "file", "result", "matches");
+	for (const DamagedGltf& damage : DAMAGED_GLTFS)
+	{
+		if (!WriteDamagedGltf(damage))
+		{
+			printf("Failed to write %s\n", IMPORT_DAMAGED_GLTF_FILE_NAME);
+			break;
+		}
+
+		ImportedMesh mesh;
+		MeshImportStats stats;
+		const bool bImported = ImportMesh(IMPORT_DAMAGED_GLTF_FILE_NAME, mesh, nullptr, &stats);
+		const bool bIntact = &damage == &DAMAGED_GLTFS[0];
+		printf("%-28s %-50s %8s\n", damage.Name, bImported ? "imported" : stats.Error, bImported == bIntact ? "yes" : "NO");
+	}
+	remove(IMPORT_DAMAGED_GLTF_FILE_NAME);
+	remove(IMPORT_DAMAGED_BIN_FILE_NAME);
+}
@@ -0,0 +1,204 @@
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/FrustumCulling.h"
+#include "../Common/JobSystem.h"
+#include "../Common/LodSelection.h"
+#include "../Common/ObjectTransforms.h"
+#include "../Common/ThreadPool.h"
+
+namespace
+{
+	constexpr uint32_t OBJECT_COUNT = 1000000;
+	constexpr float WORLD_HALF_SIZE = 500.0f;
+	const uint32_t THREAD_COUNTS[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+	// Empty jobs that only show what scheduling one costs
+	constexpr uint32_t EMPTY_JOB_COUNT = 65536;
+
+	// Objects per job of the frame stages, the same as the Lighting sample
+	constexpr uint32_t FRAME_BATCH_SIZE = 4096;
+
+	// Largest projected radii in pixels of every level of detail, most detailed first
+	const float LOD_MAX_RADII[] = { 400.0f, 200.0f, 100.0f, 50.0f, 25.0f, 12.0f, 6.0f };
+	constexpr float PROJECTION_SCALE = 450.0f / 0.41421356f;
+
+	// Update of a scene like the Lighting sample: spinning and culling side by side, then level selection and sorting,
+	// then the matrices of the visible objects
+	struct BenchmarkFrame
+	{
+		TransformArrays Transforms;
+		SphereBoundsArrays Bounds;
+		LodSelector Lods;
+		Frustum ViewFrustum;
+		Float4x4 ViewProjectionMatrix;
+		Float3 CameraPosition;
+
+		std::vector<uint32_t> BatchVisibleCounts;
+		std::vector<uint32_t> VisibleIndices;
+		uint32_t VisibleCount;
+		uint32_t LevelCounts[MAX_LOD_COUNT];
+		TransformArrays VisibleTransforms;
+		std::vector<ObjectMatrices> Matrices;
+	};
+
+	void InitFrame(BenchmarkFrame& frame)
+	{
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<float> position(-WORLD_HALF_SIZE, WORLD_HALF_SIZE);
+		std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+		frame.Transforms.Resize(OBJECT_COUNT);
+		for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+		{
+			frame.Transforms.PositionX[i] = position(random);
+			frame.Transforms.PositionY[i] = position(random);
+			frame.Transforms.PositionZ[i] = position(random);
+			frame.Transforms.ScaleX[i] = frame.Transforms.ScaleY[i] = frame.Transforms.ScaleZ[i] = size(random);
+		}
+		ComputeSphereBounds(frame.Transforms, Float3{ 0.0f, 0.0f, 0.0f }, 1.0f, frame.Bounds);
+		frame.Lods.Init(LOD_MAX_RADII, (uint32_t)(sizeof(LOD_MAX_RADII) / sizeof(LOD_MAX_RADII[0])), OBJECT_COUNT, 0.1f);
+
+		frame.CameraPosition = Float3{ 0.0f, 100.0f, -700.0f };
+		const Float4x4 viewMatrix = MatrixLookAtLH(frame.CameraPosition, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+		const Float4x4 projectionMatrix = MatrixPerspectiveFovLH(ConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+		frame.ViewProjectionMatrix = viewMatrix * projectionMatrix;
+		frame.ViewFrustum = ExtractFrustumPlanes(frame.ViewProjectionMatrix);
+
+		frame.BatchVisibleCounts.resize((OBJECT_COUNT + FRAME_BATCH_SIZE - 1) / FRAME_BATCH_SIZE);
+		frame.VisibleIndices.resize(OBJECT_COUNT);
+		frame.VisibleCount = 0;
+		frame.VisibleTransforms.Resize(OBJECT_COUNT);
+		frame.Matrices.resize(OBJECT_COUNT);
+	}
+
+	// The stages of the Lighting sample, on the data of the frame
+	void BuildFrameGraph(BenchmarkFrame& frame, JobSystem& jobSystem, JobGraph& outGraph)
+	{
+		outGraph.Clear();
+		const uint32_t spin = outGraph.AddJob([&](uint32_t)
+			{
+				jobSystem.ParallelFor(OBJECT_COUNT, FRAME_BATCH_SIZE, [&](uint32_t begin, uint32_t end, uint32_t)
+					{
+						for (uint32_t i = begin; i < end; ++i)
+						{
+							frame.Transforms.RotationY[i] = 0.38268343f;
+							frame.Transforms.RotationW[i] = 0.92387953f;
+						}
+					});
+			});
+		const uint32_t cull = outGraph.AddJob([&](uint32_t)
+			{
+				jobSystem.ParallelFor(OBJECT_COUNT, FRAME_BATCH_SIZE, [&](uint32_t begin, uint32_t end, uint32_t)
+					{
+						frame.BatchVisibleCounts[begin / FRAME_BATCH_SIZE] = CullSpheres(frame.ViewFrustum, frame.Bounds, begin, end, frame.VisibleIndices.data() + begin);
+					});
+
+				frame.VisibleCount = 0;
+				for (uint32_t batch = 0; batch < (uint32_t)frame.BatchVisibleCounts.size(); ++batch)
+				{
+					if (frame.VisibleCount != batch * FRAME_BATCH_SIZE)
+					{
+						memmove(frame.VisibleIndices.data() + frame.VisibleCount, frame.VisibleIndices.data() + batch * FRAME_BATCH_SIZE,
+							frame.BatchVisibleCounts[batch] * sizeof(uint32_t));
+					}
+					frame.VisibleCount += frame.BatchVisibleCounts[batch];
+				}
+			});
+		const uint32_t lods = outGraph.AddJob([&](uint32_t)
+			{
+				jobSystem.ParallelFor(frame.VisibleCount, FRAME_BATCH_SIZE, [&](uint32_t begin, uint32_t end, uint32_t)
+					{
+						frame.Lods.Update(frame.Bounds, frame.VisibleIndices.data() + begin, end - begin, frame.CameraPosition, PROJECTION_SCALE);
+					});
+				frame.Lods.SortByLevel(frame.VisibleIndices.data(), frame.VisibleCount, frame.LevelCounts);
+			});
+		const uint32_t matrices = outGraph.AddJob([&](uint32_t)
+			{
+				jobSystem.ParallelFor(frame.VisibleCount, FRAME_BATCH_SIZE, [&](uint32_t begin, uint32_t end, uint32_t)
+					{
+						GatherTransforms(frame.Transforms, frame.VisibleIndices.data(), begin, end, frame.VisibleTransforms);
+						ComputeObjectMatrices(frame.VisibleTransforms, begin, end, frame.ViewProjectionMatrix, &frame.Matrices[begin], sizeof(ObjectMatrices));
+					});
+			});
+
+		outGraph.AddDependency(lods, cull);
+		outGraph.AddDependency(matrices, spin);
+		outGraph.AddDependency(matrices, lods);
+	}
+
+	bool FramesMatch(const BenchmarkFrame& a, const BenchmarkFrame& b)
+	{
+		return a.VisibleCount == b.VisibleCount && !memcmp(a.VisibleIndices.data(), b.VisibleIndices.data(), a.VisibleCount * sizeof(uint32_t)) &&
+			!memcmp(a.Matrices.data(), b.Matrices.data(), a.VisibleCount * sizeof(ObjectMatrices));
+	}
+}
+
+void RunJobBenchmark()
+{
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const uint32_t maxThreadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+
+	printf("Work stealing job system from 1 to %u threads (%u hardware threads)\n", maxThreadCount, hardwareThreadCount);
+	printf("Empty: %u jobs of nothing through JobSystem::ParallelFor and as many ThreadPool tasks, in millions per second. 1 thread runs both inline.\n",
+		EMPTY_JOB_COUNT);
+	printf("Frame: spin, cull, select levels, sort and compose matrices of %u objects as a job graph, speedup over 1 thread.\n", OBJECT_COUNT);
+	printf("Matches compares the visible objects and their matrices with 1 thread.\n");
+	printf("%8s %10s %10s %10s %12s %10s %9s %10s %12s %8s\n", "threads", "empty ms", "jobs M/s", "pool M/s", "steals", "frame ms", "speedup",
+		"visible", "steals/frame", "matches");
+
+	BenchmarkFrame referenceFrame;
+	InitFrame(referenceFrame);
+	BenchmarkFrame frame;
+	InitFrame(frame);
+
+	double oneThreadMilliseconds = 0.0;
+	for (uint32_t threadCount : THREAD_COUNTS)
+	{
+		if (threadCount > maxThreadCount)
+		{
+			break;
+		}
+
+		JobSystem jobSystem;
+		jobSystem.Init(threadCount);
+		uint32_t emptyRunCount = 0;
+		const double emptyMilliseconds = MeasureMilliseconds([&]()
+			{
+				jobSystem.ParallelFor(EMPTY_JOB_COUNT, 1, [](uint32_t, uint32_t, uint32_t) {});
+				++emptyRunCount;
+			});
+		const uint64_t emptySteals = jobSystem.GetStats().StealCount / emptyRunCount;
+
+		ThreadPool threadPool;
+		threadPool.Init(threadCount);
+		const double poolMilliseconds = MeasureMilliseconds([&]() { threadPool.ParallelFor(EMPTY_JOB_COUNT, [](uint32_t, uint32_t) {}); });
+		threadPool.Free();
+
+		// The first row is the reference, later ones run on their own copy of the frame
+		BenchmarkFrame& runFrame = threadCount == 1 ? referenceFrame : frame;
+		JobGraph graph;
+		BuildFrameGraph(runFrame, jobSystem, graph);
+		jobSystem.ResetStats();
+		uint32_t frameRunCount = 0;
+		const double frameMilliseconds = MeasureMilliseconds([&]()
+			{
+				graph.Run(jobSystem);
+				++frameRunCount;
+			});
+		const uint64_t frameSteals = jobSystem.GetStats().StealCount / frameRunCount;
+		jobSystem.Free();
+
+		if (threadCount == 1)
+		{
+			oneThreadMilliseconds = frameMilliseconds;
+		}
+		printf("%8u %10.3f %10.2f %10.2f %12llu %10.3f %9.2f %10u %12llu %8s\n", threadCount, emptyMilliseconds, EMPTY_JOB_COUNT / 1000.0 / emptyMilliseconds,
+			EMPTY_JOB_COUNT / 1000.0 / poolMilliseconds, (unsigned long long)emptySteals, frameMilliseconds, oneThreadMilliseconds / frameMilliseconds,
+			runFrame.VisibleCount, (unsigned long long)frameSteals, FramesMatch(runFrame, referenceFrame) ? "yes" : "NO");
+	}
+}
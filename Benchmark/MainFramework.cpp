@@ -0,0 +1,95 @@
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Benchmarks.h"
+
+namespace
+{
+	std::atomic<uint64_t> AllocationCount{ 0 };
+}
+
+// Replaces the global allocation functions to count them. The array and nothrow forms and the deletes call these.
+void* operator new(size_t size)
+{
+	AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = malloc(size ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+uint64_t GetAllocationCount()
+{
+	return AllocationCount.load(std::memory_order_relaxed);
+}
+
+struct BenchmarkEntry
+{
+	const char* Name;
+	void (*Run)();
+};
+
+const BenchmarkEntry BENCHMARKS[] =
+{
+	{ "transform", RunTransformBenchmark },
+	{ "culling", RunCullingBenchmark },
+	{ "occlusion", RunOcclusionBenchmark },
+	{ "bvh", RunBvhBenchmark },
+	{ "mesh", RunMeshBenchmark },
+	{ "optimizer", RunMeshOptimizerBenchmark },
+	{ "quantize", RunVertexQuantizationBenchmark },
+	{ "meshcache", RunMeshCacheBenchmark },
+	{ "import", RunImportBenchmark },
+	{ "primitives", RunPrimitiveBenchmark },
+	{ "icosphere", RunIcosphereBenchmark },
+	{ "simplify", RunSimplifyBenchmark },
+	{ "codec", RunCodecBenchmark },
+	{ "tangents", RunTangentBenchmark },
+	{ "jobs", RunJobBenchmark },
+	{ "commands", RunCommandBenchmark },
+	{ "sort", RunSortBenchmark },
+};
+
+int main(int argc, char** argv)
+{
+	const char* benchmarkName = argc > 1 ? argv[1] : "all";
+
+	bool bFound = false;
+	for (const BenchmarkEntry& benchmark : BENCHMARKS)
+	{
+		if (!strcmp(benchmarkName, "all") || !strcmp(benchmarkName, benchmark.Name))
+		{
+			printf("== %s ==\n", benchmark.Name);
+			benchmark.Run();
+			printf("\n");
+			bFound = true;
+		}
+	}
+
+	if (!bFound)
+	{
+		printf("Usage: %s [all", argv[0]);
+		for (const BenchmarkEntry& benchmark : BENCHMARKS)
+		{
+			printf("|%s", benchmark.Name);
+		}
+		printf("]\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MappedFile.h"
+#include "../Common/MeshCache.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/MeshOptimizer.h"
+#include "../Common/ThreadPool.h"
+#include "../Common/VertexQuantization.h"
+
+namespace
+{
+	// Slices and rings of each sphere, up to 33.5 million triangles
+	const int32_t SEGMENT_COUNTS[] = { 64, 256, 1024, 2048, 4096 };
+	const uint32_t THREAD_COUNTS[] = { 1, 2, 4, 8, 16 };
+
+	bool IsSameMesh(const std::vector<VertexData>& vertices, const MeshIndices& indices, const std::vector<VertexData>& referenceVertices, const MeshIndices& referenceIndices)
+	{
+		return vertices.size() == referenceVertices.size() && indices.Format == referenceIndices.Format && indices.GetCount() == referenceIndices.GetCount()
+			&& !memcmp(vertices.data(), referenceVertices.data(), vertices.size() * sizeof(VertexData))
+			&& !memcmp(indices.GetData(), referenceIndices.GetData(), (size_t)indices.GetCount() * indices.GetIndexSize());
+	}
+
+	void PrintRow(int32_t segmentCount, const MeshIndices& indices, const char* path, uint32_t threadCount, double milliseconds, const char* matches)
+	{
+		const double triangleCount = 2.0 * segmentCount * segmentCount;
+		printf("%9d %12.0f %6s %-10s %8u %10.3f %14.1f %8s\n", segmentCount, triangleCount, indices.Format == INDEX_FORMAT_UINT16 ? "16" : "32",
+			path, threadCount, milliseconds, triangleCount / milliseconds / 1000.0, matches);
+	}
+}
+
+void RunMeshBenchmark()
+{
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const uint32_t maxThreadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+
+	printf("UV sphere generation, %u hardware threads\n", hardwareThreadCount);
+	printf("%9s %12s %6s %-10s %8s %10s %14s %8s\n", "segments", "triangles", "index", "path", "threads", "ms", "Mtriangles/s", "matches");
+
+	for (int32_t segmentCount : SEGMENT_COUNTS)
+	{
+		std::vector<VertexData> referenceVertices;
+		MeshIndices referenceIndices;
+		const double serialMilliseconds = MeasureMilliseconds([&]() { GenerateSphere(segmentCount, segmentCount, referenceVertices, referenceIndices); });
+		PrintRow(segmentCount, referenceIndices, "serial", 1, serialMilliseconds, "-");
+
+		std::vector<VertexData> vertices;
+		MeshIndices indices;
+		for (uint32_t threadCount : THREAD_COUNTS)
+		{
+			if (threadCount > maxThreadCount)
+			{
+				break;
+			}
+
+			ThreadPool threadPool;
+			threadPool.Init(threadCount);
+			const double parallelMilliseconds = MeasureMilliseconds([&]() { GenerateSphere(segmentCount, segmentCount, vertices, indices, &threadPool); });
+			PrintRow(segmentCount, indices, "parallel", threadCount, parallelMilliseconds, IsSameMesh(vertices, indices, referenceVertices, referenceIndices) ? "yes" : "NO");
+			threadPool.Free();
+		}
+	}
+}
+
+namespace
+{
+	struct OptimizerBenchmarkMesh
+	{
+		const char* Name;
+		int32_t SegmentCount;
+		bool bShuffle;
+	};
+
+	// Generated spheres come ring by ring, the shuffled one has no locality at all
+	const OptimizerBenchmarkMesh OPTIMIZER_MESHES[] =
+	{
+		{ "sphere", 64, false },
+		{ "sphere", 256, false },
+		{ "sphere", 1024, false },
+		{ "shuffled", 256, true },
+	};
+
+	void PrintOptimizerRow(const OptimizerBenchmarkMesh& mesh, uint32_t triangleCount, const char* pass, double milliseconds, const VertexCacheStats& stats)
+	{
+		printf("%-9s %9d %10u %-9s %10.3f %14.2f %7.3f %7.3f\n", mesh.Name, mesh.SegmentCount, triangleCount, pass, milliseconds,
+			triangleCount / milliseconds / 1000.0, stats.GetAcmr(), stats.GetAtvr());
+	}
+}
+
+void RunMeshOptimizerBenchmark()
+{
+	printf("Every pass runs on the output of the one before, %u-entry FIFO cache\n", VERTEX_CACHE_SIZE);
+	printf("%-9s %9s %10s %-9s %10s %14s %7s %7s\n", "mesh", "segments", "triangles", "pass", "ms", "Mtriangles/s", "ACMR", "ATVR");
+
+	for (const OptimizerBenchmarkMesh& mesh : OPTIMIZER_MESHES)
+	{
+		std::vector<VertexData> vertices;
+		std::vector<uint32_t> indices;
+		GenerateSphere(mesh.SegmentCount, mesh.SegmentCount, vertices, indices);
+
+		const uint32_t vertexCount = (uint32_t)vertices.size();
+		const uint32_t indexCount = (uint32_t)indices.size();
+		const uint32_t triangleCount = indexCount / 3;
+		if (mesh.bShuffle)
+		{
+			std::mt19937 random(12345);
+			for (uint32_t i = triangleCount - 1; i > 0; --i)
+			{
+				const uint32_t j = std::uniform_int_distribution<uint32_t>(0, i)(random);
+				std::swap_ranges(&indices[i * 3], &indices[i * 3 + 3], &indices[j * 3]);
+			}
+		}
+
+		VertexCacheStats stats{};
+		const double analyzeMilliseconds = MeasureMilliseconds([&]() { stats = AnalyzeVertexCache(indices.data(), indexCount, vertexCount); });
+		PrintOptimizerRow(mesh, triangleCount, "analyze", analyzeMilliseconds, stats);
+
+		// Every run starts again from the input of the pass, the copy is small next to the pass itself
+		std::vector<VertexData> inputVertices;
+		std::vector<uint32_t> inputIndices;
+		auto measurePass = [&](const char* pass, auto function)
+		{
+			inputVertices = vertices;
+			inputIndices = indices;
+			const double milliseconds = MeasureMilliseconds([&]()
+				{
+					vertices = inputVertices;
+					indices = inputIndices;
+					function();
+				});
+			PrintOptimizerRow(mesh, triangleCount, pass, milliseconds, AnalyzeVertexCache(indices.data(), indexCount, vertexCount));
+		};
+
+		measurePass("cache", [&]() { OptimizeVertexCache(indices.data(), indexCount, vertexCount); });
+		measurePass("overdraw", [&]() { OptimizeOverdraw(indices.data(), indexCount, vertices.data(), vertexCount, sizeof(VertexData)); });
+		measurePass("fetch", [&]() { OptimizeVertexFetch(vertices.data(), vertexCount, sizeof(VertexData), indices.data(), indexCount); });
+	}
+}
+
+namespace
+{
+	// Spheres of about 4 thousand, 66 thousand and 1 million vertices
+	const int32_t QUANTIZATION_SEGMENT_COUNTS[] = { 64, 256, 1024 };
+}
+
+void RunVertexQuantizationBenchmark()
+{
+	printf("Vertex quantization, %u-byte VertexData to %u-byte QuantizedVertexData\n", (uint32_t)sizeof(VertexData), (uint32_t)sizeof(QuantizedVertexData));
+	printf("%9s %10s %12s %12s %16s %16s %8s %8s %14s %14s\n", "segments", "vertices", "scalar ms", "simd ms", "scalar vert/s", "simd vert/s", "speedup", "matches",
+		"position err", "normal err deg");
+
+	for (int32_t segmentCount : QUANTIZATION_SEGMENT_COUNTS)
+	{
+		std::vector<VertexData> vertices;
+		std::vector<uint32_t> indices;
+		GenerateSphere(segmentCount, segmentCount, vertices, indices);
+
+		const uint32_t vertexCount = (uint32_t)vertices.size();
+		const VertexQuantization quantization = ComputeVertexQuantization(vertices.data(), vertexCount, sizeof(VertexData));
+		std::vector<QuantizedVertexData> scalarOutput(vertexCount);
+		std::vector<QuantizedVertexData> simdOutput(vertexCount);
+
+		const double scalarMilliseconds = MeasureMilliseconds([&]() { QuantizeVerticesScalar(vertices.data(), vertexCount, quantization, scalarOutput.data()); });
+		const double simdMilliseconds = MeasureMilliseconds([&]() { QuantizeVertices(vertices.data(), vertexCount, quantization, simdOutput.data()); });
+		const bool bMatches = !memcmp(scalarOutput.data(), simdOutput.data(), vertexCount * sizeof(QuantizedVertexData));
+		const VertexQuantizationError error = MeasureQuantizationError(vertices.data(), simdOutput.data(), vertexCount, quantization);
+
+		printf("%9d %10u %12.3f %12.3f %16.0f %16.0f %7.2fx %8s %14.3g %14.3g\n", segmentCount, vertexCount, scalarMilliseconds, simdMilliseconds,
+			vertexCount * 1000.0 / scalarMilliseconds, vertexCount * 1000.0 / simdMilliseconds, scalarMilliseconds / simdMilliseconds, bMatches ? "yes" : "NO",
+			error.MaxPositionError, error.MaxNormalAngle);
+	}
+}
+
+namespace
+{
+	struct MeshCacheBenchmarkChain
+	{
+		const char* Name;
+		int32_t SegmentCounts[7];
+	};
+
+	// The Lighting LOD chain, and one with 16 times the triangles at every level
+	const MeshCacheBenchmarkChain MESH_CACHE_CHAINS[] =
+	{
+		{ "lighting", { 256, 128, 64, 32, 16, 8, 4 } },
+		{ "large", { 1024, 512, 256, 128, 64, 32, 16 } },
+	};
+
+	constexpr uint32_t MESH_CACHE_COLD_RUN_COUNT = 5;
+	const char* MESH_CACHE_BENCHMARK_FILE_NAME = "MeshCacheBenchmark.mesh";
+
+	// What CreateBuffer does with the initial data, one copy of the vertices and the indices
+	void CopyBuffers(const MeshCacheView& meshes, std::vector<uint8_t>& outVertexBuffer, std::vector<uint8_t>& outIndexBuffer)
+	{
+		outVertexBuffer.resize((size_t)meshes.VertexCount * sizeof(VertexData));
+		outIndexBuffer.resize((size_t)meshes.IndexCount * meshes.GetIndexSize());
+		memcpy(outVertexBuffer.data(), meshes.Vertices, outVertexBuffer.size());
+		memcpy(outIndexBuffer.data(), meshes.Indices, outIndexBuffer.size());
+	}
+
+	// The last index of the first level names the vertex just past it
+	void DamageIndex(MeshCacheData& meshes)
+	{
+		const MeshLod& lod = meshes.Lods[0];
+		const uint32_t index = lod.StartIndex + lod.IndexCount - 1;
+		if (meshes.Indices.Format == INDEX_FORMAT_UINT16)
+		{
+			meshes.Indices.Indices16[index] = (uint16_t)lod.VertexCount;
+		}
+		else
+		{
+			meshes.Indices.Indices32[index] = lod.VertexCount;
+		}
+	}
+}
+
+void RunMeshCacheBenchmark()
+{
+	printf("Startup to vertex and index data copied into buffers: generate and optimize, or map %s\n", MESH_CACHE_BENCHMARK_FILE_NAME);
+	printf("Cold loads drop the file from the OS file cache first (average of %u), warm loads find it there\n", MESH_CACHE_COLD_RUN_COUNT);
+	printf("Stored as in memory, or compressed (MeshCodec) and decoded by Open\n");
+	printf("Matches compares the buffers with the generated ones, and checks that Open rejects the file with one index past its level\n");
+	printf("%-9s %-7s %10s %10s %12s %10s %10s %10s %10s %10s %8s\n", "chain", "stored", "triangles", "file MB", "generate ms", "cold ms", "warm ms", "cold gain",
+		"warm gain", "bad index", "matches");
+
+	for (const MeshCacheBenchmarkChain& chain : MESH_CACHE_CHAINS)
+	{
+		const uint32_t lodCount = (uint32_t)std::size(chain.SegmentCounts);
+		const uint64_t key = ComputeMeshCacheKey(chain.SegmentCounts, sizeof(chain.SegmentCounts), 1);
+
+		MeshCacheData meshes;
+		std::vector<uint8_t> vertexBuffer;
+		std::vector<uint8_t> indexBuffer;
+		const double generateMilliseconds = MeasureMilliseconds([&]()
+			{
+				GenerateSphereLodMeshes(chain.SegmentCounts, lodCount, false, meshes);
+				CopyBuffers(meshes.GetView(), vertexBuffer, indexBuffer);
+			});
+		const std::vector<uint8_t> referenceVertexBuffer = vertexBuffer;
+		const std::vector<uint8_t> referenceIndexBuffer = indexBuffer;
+		MeshCacheData damagedMeshes = meshes;
+		DamageIndex(damagedMeshes);
+
+		for (bool bCompress : { false, true })
+		{
+			if (!WriteMeshCache(MESH_CACHE_BENCHMARK_FILE_NAME, key, meshes.GetView(), bCompress))
+			{
+				printf("Failed to write %s\n", MESH_CACHE_BENCHMARK_FILE_NAME);
+				return;
+			}
+
+			bool bLoaded = true;
+			uint64_t fileSize = 0;
+			auto load = [&]()
+			{
+				MeshCache cache;
+				if (!cache.Open(MESH_CACHE_BENCHMARK_FILE_NAME, key))
+				{
+					bLoaded = false;
+					return;
+				}
+				fileSize = cache.GetFileSize();
+				CopyBuffers(cache.GetView(), vertexBuffer, indexBuffer);
+			};
+
+			bool bEvicted = true;
+			double coldMilliseconds = 0.0;
+			for (uint32_t run = 0; run < MESH_CACHE_COLD_RUN_COUNT; ++run)
+			{
+				bEvicted = MappedFile::EvictFromFileCache(MESH_CACHE_BENCHMARK_FILE_NAME) && bEvicted;
+				const uint64_t startTicks = Clock::GetTicks();
+				load();
+				coldMilliseconds += Clock::TicksToMilliseconds(Clock::GetTicks() - startTicks);
+			}
+			coldMilliseconds /= MESH_CACHE_COLD_RUN_COUNT;
+
+			const double warmMilliseconds = MeasureMilliseconds(load);
+
+			MeshCache damagedCache;
+			const bool bDamagedRejected = WriteMeshCache(MESH_CACHE_BENCHMARK_FILE_NAME, key, damagedMeshes.GetView(), bCompress)
+				&& !damagedCache.Open(MESH_CACHE_BENCHMARK_FILE_NAME, key);
+			const bool bMatches = bLoaded && vertexBuffer == referenceVertexBuffer && indexBuffer == referenceIndexBuffer && bDamagedRejected;
+
+			char coldText[32] = "n/a";
+			char coldGainText[32] = "n/a";
+			if (bEvicted)
+			{
+				snprintf(coldText, sizeof(coldText), "%.3f", coldMilliseconds);
+				snprintf(coldGainText, sizeof(coldGainText), "%.1fx", generateMilliseconds / coldMilliseconds);
+			}
+			printf("%-9s %-7s %10u %10.2f %12.3f %10s %10.3f %10s %9.1fx %10s %8s\n", chain.Name, bCompress ? "codec" : "raw", meshes.Indices.GetCount() / 3,
+				fileSize / (1024.0 * 1024.0), generateMilliseconds, coldText, warmMilliseconds, coldGainText, generateMilliseconds / warmMilliseconds,
+				bDamagedRejected ? "rejected" : "OPENED", bMatches ? "yes" : "NO");
+		}
+	}
+
+	remove(MESH_CACHE_BENCHMARK_FILE_NAME);
+}
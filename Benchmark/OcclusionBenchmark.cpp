@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/OcclusionCulling.h"
+#include "../Common/PrimitiveMeshes.h"
+
+namespace
+{
+	// The view of the samples: 1600x900 into a buffer 320 pixels wide, looking down +Z from the origin
+	constexpr int32_t BUFFER_WIDTH = 320;
+	constexpr int32_t BUFFER_HEIGHT = 180;
+	constexpr float FOV = ConvertToRadians(60.0f);
+	constexpr float NEAR_Z = 0.1f;
+	constexpr float FAR_Z = 1000.0f;
+
+	// Same tessellation as the occluder of the Lighting sample
+	constexpr int32_t OCCLUDER_SLICE_COUNT = 8;
+	constexpr int32_t OCCLUDER_RING_COUNT = 6;
+
+	// Occluders and boxes placed by hand. The first HiddenCount boxes are entirely behind the occluders and must be
+	// rejected, the others are in front of them or beside them and must be kept.
+	struct OcclusionTestScene
+	{
+		const char* Name;
+		OccluderMesh Mesh;
+		TransformArrays Occluders;
+		BoxBoundsArrays Boxes;
+		uint32_t HiddenCount;
+	};
+
+	void AddOccluder(OcclusionTestScene& scene, const Float3& position, float scale)
+	{
+		const uint32_t index = scene.Occluders.GetCount();
+		scene.Occluders.Resize(index + 1);
+		scene.Occluders.PositionX[index] = position.x;
+		scene.Occluders.PositionY[index] = position.y;
+		scene.Occluders.PositionZ[index] = position.z;
+		scene.Occluders.ScaleX[index] = scene.Occluders.ScaleY[index] = scene.Occluders.ScaleZ[index] = scale;
+	}
+
+	void AddBox(OcclusionTestScene& scene, const Float3& center, float extent)
+	{
+		BoxBoundsArrays& boxes = scene.Boxes;
+		boxes.CenterX.push_back(center.x);
+		boxes.CenterY.push_back(center.y);
+		boxes.CenterZ.push_back(center.z);
+		boxes.ExtentX.push_back(extent);
+		boxes.ExtentY.push_back(extent);
+		boxes.ExtentZ.push_back(extent);
+	}
+
+	OccluderMesh MakeSphereOccluder()
+	{
+		std::vector<VertexData> vertices;
+		MeshIndices indices;
+		GetPrimitiveMesh(PrimitiveShape{ PRIMITIVE_TYPE_UV_SPHERE, OCCLUDER_SLICE_COUNT, OCCLUDER_RING_COUNT }, vertices, indices);
+
+		OccluderMesh mesh;
+		mesh.Indices = std::move(indices.Indices16);
+		for (const VertexData& vertex : vertices)
+		{
+			mesh.Positions.push_back(vertex.Position);
+		}
+		return mesh;
+	}
+
+	// A quad of two triangles over the whole view, with a grid of boxes behind it and a few in front
+	void BuildQuadScene(OcclusionTestScene& outScene)
+	{
+		outScene.Name = "quad";
+		outScene.Mesh.Positions = { { -1.0f, -1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { -1.0f, 1.0f, 0.0f } };
+		outScene.Mesh.Indices = { 0, 2, 1, 0, 3, 2 };
+		AddOccluder(outScene, Float3{ 0.0f, 0.0f, 5.0f }, 20.0f);
+
+		for (int32_t y = -4; y <= 4; ++y)
+		{
+			for (int32_t x = -8; x <= 8; ++x)
+			{
+				AddBox(outScene, Float3{ x * 2.25f, y * 2.25f, 20.0f }, 0.5f);
+			}
+		}
+		outScene.HiddenCount = (uint32_t)outScene.Boxes.CenterX.size();
+
+		AddBox(outScene, Float3{ 0.0f, 0.0f, 3.0f }, 0.5f);
+		AddBox(outScene, Float3{ -2.0f, 1.0f, 4.0f }, 0.25f);
+	}
+
+	// One tessellated sphere, made of nothing but edges shared by two triangles, with boxes behind its middle and beside it
+	void BuildSphereScene(OcclusionTestScene& outScene)
+	{
+		outScene.Name = "sphere";
+		outScene.Mesh = MakeSphereOccluder();
+		AddOccluder(outScene, Float3{ 0.0f, 0.0f, 20.0f }, 4.0f);
+
+		for (int32_t y = -2; y <= 2; ++y)
+		{
+			for (int32_t x = -2; x <= 2; ++x)
+			{
+				AddBox(outScene, Float3{ x * 2.0f, y * 2.0f, 60.0f }, 0.5f);
+			}
+		}
+		outScene.HiddenCount = (uint32_t)outScene.Boxes.CenterX.size();
+
+		AddBox(outScene, Float3{ -40.0f, 0.0f, 60.0f }, 0.5f);
+		AddBox(outScene, Float3{ 40.0f, 0.0f, 60.0f }, 0.5f);
+		AddBox(outScene, Float3{ 0.0f, 0.0f, 10.0f }, 0.5f);
+	}
+
+	// Overlapping spheres in a wall like the grid of the Lighting sample, with boxes behind it and above it
+	void BuildWallScene(OcclusionTestScene& outScene)
+	{
+		outScene.Name = "wall";
+		outScene.Mesh = MakeSphereOccluder();
+		for (int32_t y = -2; y <= 2; ++y)
+		{
+			for (int32_t x = -4; x <= 4; ++x)
+			{
+				AddOccluder(outScene, Float3{ x * 2.0f, y * 2.0f, 15.0f }, 1.7f);
+			}
+		}
+
+		for (int32_t y = -1; y <= 1; ++y)
+		{
+			for (int32_t x = -2; x <= 2; ++x)
+			{
+				AddBox(outScene, Float3{ x * 6.0f, y * 4.0f, 40.0f }, 0.5f);
+			}
+		}
+		outScene.HiddenCount = (uint32_t)outScene.Boxes.CenterX.size();
+
+		AddBox(outScene, Float3{ 0.0f, 16.0f, 40.0f }, 0.5f);
+		AddBox(outScene, Float3{ 0.0f, 0.0f, 12.0f }, 0.5f);
+	}
+
+	// Subtiles with a reference depth in front of the far plane
+	uint32_t CountCoveredSubtiles(const OcclusionCuller& culler)
+	{
+		uint32_t coveredCount = 0;
+		for (int32_t y = 0; y < culler.GetHeight(); y += OcclusionCuller::SUBTILE_HEIGHT)
+		{
+			for (int32_t x = 0; x < culler.GetWidth(); x += OcclusionCuller::SUBTILE_WIDTH)
+			{
+				coveredCount += culler.GetDepth(x, y) < 1.0f ? 1 : 0;
+			}
+		}
+		return coveredCount;
+	}
+}
+
+void RunOcclusionBenchmark()
+{
+	OcclusionCuller culler;
+	if (!culler.Init(BUFFER_WIDTH, BUFFER_HEIGHT, 1))
+	{
+		printf("Failed to initialize the occlusion culler\n");
+		return;
+	}
+
+	const Float4x4 viewProjectionMatrix = MatrixLookAtLH(Float3{ 0.0f, 0.0f, 0.0f }, Float3{ 0.0f, 0.0f, 1.0f }, Float3{ 0.0f, 1.0f, 0.0f }) *
+		MatrixPerspectiveFovLH(FOV, 16.0f / 9.0f, NEAR_Z, FAR_Z);
+	const uint32_t subtileCount = (uint32_t)((culler.GetWidth() / OcclusionCuller::SUBTILE_WIDTH) * (culler.GetHeight() / OcclusionCuller::SUBTILE_HEIGHT));
+
+	OcclusionTestScene scenes[3];
+	BuildQuadScene(scenes[0]);
+	BuildSphereScene(scenes[1]);
+	BuildWallScene(scenes[2]);
+
+	printf("Occlusion: occluders and boxes placed by hand in a %dx%d buffer on 1 thread\n", culler.GetWidth(), culler.GetHeight());
+	printf("Matches checks that every box behind the occluders is rejected and every box in front of or beside them is kept.\n");
+	printf("%-8s %10s %10s %10s %10s %10s %8s\n", "scene", "triangles", "covered", "hidden", "kept", "frame ms", "matches");
+
+	for (const OcclusionTestScene& scene : scenes)
+	{
+		const uint32_t occluderCount = scene.Occluders.GetCount();
+		const uint32_t boxCount = (uint32_t)scene.Boxes.CenterX.size();
+		std::vector<uint32_t> occluderIndices(occluderCount);
+		for (uint32_t i = 0; i < occluderCount; ++i)
+		{
+			occluderIndices[i] = i;
+		}
+
+		std::vector<uint32_t> boxIndices(boxCount);
+		uint32_t keptCount = 0;
+		const double frameMilliseconds = MeasureMilliseconds([&]()
+			{
+				culler.BeginFrame(viewProjectionMatrix);
+				culler.RasterizeClosestOccluders(scene.Mesh, scene.Occluders, occluderIndices.data(), occluderCount, Float3{ 0.0f, 0.0f, 0.0f }, occluderCount);
+				for (uint32_t i = 0; i < boxCount; ++i)
+				{
+					boxIndices[i] = i;
+				}
+				keptCount = culler.CullBoxes(scene.Boxes, boxIndices.data(), boxCount);
+			});
+
+		// Kept indices stay in order, so the hidden ones come first
+		uint32_t keptHiddenCount = 0;
+		for (uint32_t i = 0; i < keptCount; ++i)
+		{
+			keptHiddenCount += boxIndices[i] < scene.HiddenCount ? 1 : 0;
+		}
+		const uint32_t shownCount = boxCount - scene.HiddenCount;
+		const bool bMatches = keptHiddenCount == 0 && keptCount - keptHiddenCount == shownCount;
+
+		char hidden[32];
+		char kept[32];
+		snprintf(hidden, sizeof(hidden), "%u/%u", scene.HiddenCount - keptHiddenCount, scene.HiddenCount);
+		snprintf(kept, sizeof(kept), "%u/%u", keptCount - keptHiddenCount, shownCount);
+		printf("%-8s %10u %9.1f%% %10s %10s %10.3f %8s\n", scene.Name, culler.GetStats().OccluderTriangleCount,
+			100.0 * CountCoveredSubtiles(culler) / subtileCount, hidden, kept, frameMilliseconds, bMatches ? "yes" : "NO");
+	}
+
+	culler.Free();
+}
@@ -0,0 +1,151 @@
+#include <iterator>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/PrimitiveMeshes.h"
+
+namespace
+{
+	struct PrimitiveEntry
+	{
+		const char* Name;
+		PrimitiveShape Shape;
+	};
+
+	// Every baked shape, then a few past the baked sizes that are always generated
+	const PrimitiveEntry PRIMITIVES[] =
+	{
+		{ "box", { PRIMITIVE_TYPE_BOX, 1, 0 } },
+		{ "box", { PRIMITIVE_TYPE_BOX, 8, 0 } },
+		{ "uvsphere", { PRIMITIVE_TYPE_UV_SPHERE, 4, 4 } },
+		{ "uvsphere", { PRIMITIVE_TYPE_UV_SPHERE, 8, 6 } },
+		{ "uvsphere", { PRIMITIVE_TYPE_UV_SPHERE, 8, 8 } },
+		{ "uvsphere", { PRIMITIVE_TYPE_UV_SPHERE, 16, 16 } },
+		{ "uvsphere", { PRIMITIVE_TYPE_UV_SPHERE, 32, 32 } },
+		{ "icosphere", { PRIMITIVE_TYPE_ICOSPHERE, 0, 0 } },
+		{ "icosphere", { PRIMITIVE_TYPE_ICOSPHERE, 1, 0 } },
+		{ "icosphere", { PRIMITIVE_TYPE_ICOSPHERE, 2, 0 } },
+		{ "icosphere", { PRIMITIVE_TYPE_ICOSPHERE, 3, 0 } },
+		{ "cylinder", { PRIMITIVE_TYPE_CYLINDER, 32, 1 } },
+		{ "plane", { PRIMITIVE_TYPE_PLANE, 1, 1 } },
+		{ "plane", { PRIMITIVE_TYPE_PLANE, 16, 16 } },
+		{ "torus", { PRIMITIVE_TYPE_TORUS, 32, 16 } },
+		{ "uvsphere", { PRIMITIVE_TYPE_UV_SPHERE, 64, 64 } },
+		{ "icosphere", { PRIMITIVE_TYPE_ICOSPHERE, 5, 0 } },
+		{ "torus", { PRIMITIVE_TYPE_TORUS, 128, 64 } },
+	};
+
+	// Same chain as the Lighting sample
+	const int32_t LOD_SEGMENT_COUNTS[] = { 256, 128, 64, 32, 16, 8, 4 };
+
+	bool IsSameMesh(const std::vector<VertexData>& vertices, const MeshIndices& indices, const std::vector<VertexData>& referenceVertices, const MeshIndices& referenceIndices)
+	{
+		return vertices.size() == referenceVertices.size() && indices.Format == referenceIndices.Format && indices.GetCount() == referenceIndices.GetCount()
+			&& !memcmp(vertices.data(), referenceVertices.data(), vertices.size() * sizeof(VertexData))
+			&& !memcmp(indices.GetData(), referenceIndices.GetData(), (size_t)indices.GetCount() * indices.GetIndexSize());
+	}
+
+	// Allocations of one call into empty containers, the way startup calls it
+	template <typename Function>
+	uint64_t CountAllocations(Function function)
+	{
+		const uint64_t startCount = GetAllocationCount();
+		function();
+		return GetAllocationCount() - startCount;
+	}
+
+	// The chain as it was built before the small levels were baked, every level generated and appended
+	void GenerateRuntimeLodChain(std::vector<VertexData>& outVertices, MeshIndices& outIndices)
+	{
+		outVertices.clear();
+		outIndices.Format = INDEX_FORMAT_UINT32;
+		outIndices.Indices16.clear();
+		outIndices.Indices32.clear();
+
+		std::vector<VertexData> vertices;
+		std::vector<uint32_t> indices;
+		for (int32_t segmentCount : LOD_SEGMENT_COUNTS)
+		{
+			GenerateSphere(segmentCount, segmentCount, vertices, indices);
+			outVertices.insert(outVertices.end(), vertices.begin(), vertices.end());
+			outIndices.Indices32.insert(outIndices.Indices32.end(), indices.begin(), indices.end());
+		}
+	}
+}
+
+void RunPrimitiveBenchmark()
+{
+	printf("Primitive meshes generated at runtime against copies of the meshes baked at compile time, one thread\n");
+	printf("Allocations are calls of operator new for one mesh written into empty vectors\n");
+	printf("%-10s %5s %5s %9s %9s %6s %12s %8s %12s %8s %8s\n", "primitive", "x", "y", "vertices", "indices", "baked", "runtime ms", "allocs",
+		"baked ms", "allocs", "matches");
+
+	for (const PrimitiveEntry& entry : PRIMITIVES)
+	{
+		std::vector<VertexData> referenceVertices;
+		MeshIndices referenceIndices;
+		const double runtimeMilliseconds = MeasureMilliseconds([&]() { GeneratePrimitive(entry.Shape, referenceVertices, referenceIndices); });
+		const uint64_t runtimeAllocationCount = CountAllocations([&]()
+		{
+			std::vector<VertexData> vertices;
+			MeshIndices indices;
+			GeneratePrimitive(entry.Shape, vertices, indices);
+		});
+
+		PrimitiveMeshView view;
+		const bool bBaked = FindBakedPrimitive(entry.Shape, view);
+
+		std::vector<VertexData> vertices;
+		MeshIndices indices;
+		const double bakedMilliseconds = MeasureMilliseconds([&]() { GetPrimitiveMesh(entry.Shape, vertices, indices); });
+		const uint64_t bakedAllocationCount = CountAllocations([&]()
+		{
+			std::vector<VertexData> emptyVertices;
+			MeshIndices emptyIndices;
+			GetPrimitiveMesh(entry.Shape, emptyVertices, emptyIndices);
+		});
+
+		printf("%-10s %5d %5d %9zu %9u %6s %12.4f %8llu %12.4f %8llu %8s\n", entry.Name, entry.Shape.TessellationX, entry.Shape.TessellationY,
+			referenceVertices.size(), referenceIndices.GetCount(), bBaked ? "yes" : "no", runtimeMilliseconds, (unsigned long long)runtimeAllocationCount,
+			bakedMilliseconds, (unsigned long long)bakedAllocationCount, IsSameMesh(vertices, indices, referenceVertices, referenceIndices) ? "yes" : "NO");
+	}
+
+	printf("\nLighting LOD chain (");
+	for (size_t i = 0; i < std::size(LOD_SEGMENT_COUNTS); ++i)
+	{
+		printf(i ? ", %d" : "%d", LOD_SEGMENT_COUNTS[i]);
+	}
+	printf(" segments) before mesh optimization\n");
+	printf("%-24s %12s %8s %8s\n", "path", "ms", "allocs", "matches");
+
+	std::vector<VertexData> referenceVertices;
+	MeshIndices referenceIndices;
+	const double runtimeMilliseconds = MeasureMilliseconds([&]() { GenerateRuntimeLodChain(referenceVertices, referenceIndices); });
+	const uint64_t runtimeAllocationCount = CountAllocations([&]()
+	{
+		std::vector<VertexData> vertices;
+		MeshIndices indices;
+		GenerateRuntimeLodChain(vertices, indices);
+	});
+	printf("%-24s %12.3f %8llu %8s\n", "every level generated", runtimeMilliseconds, (unsigned long long)runtimeAllocationCount, "-");
+
+	std::vector<VertexData> vertices;
+	MeshIndices indices;
+	std::vector<MeshLod> lods;
+	const double bakedMilliseconds = MeasureMilliseconds([&]()
+	{
+		GenerateSphereLodChain(LOD_SEGMENT_COUNTS, (uint32_t)std::size(LOD_SEGMENT_COUNTS), vertices, indices, lods);
+	});
+	const uint64_t bakedAllocationCount = CountAllocations([&]()
+	{
+		std::vector<VertexData> emptyVertices;
+		MeshIndices emptyIndices;
+		std::vector<MeshLod> emptyLods;
+		GenerateSphereLodChain(LOD_SEGMENT_COUNTS, (uint32_t)std::size(LOD_SEGMENT_COUNTS), emptyVertices, emptyIndices, emptyLods);
+	});
+	printf("%-24s %12.3f %8llu %8s\n", "small levels baked", bakedMilliseconds, (unsigned long long)bakedAllocationCount,
+		IsSameMesh(vertices, indices, referenceVertices, referenceIndices) ? "yes" : "NO");
+}
@@ -0,0 +1,128 @@
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/MeshSimplifier.h"
+#include "../Common/ThreadPool.h"
+
+namespace
+{
+	// Fractions of the source triangles kept
+	const float TRIANGLE_RATIOS[] = { 0.25f, 0.01f };
+
+	// Closest point of the triangle to the origin, from Ericson, "Real-Time Collision Detection" 5.1.5
+	float GetDistanceToOrigin(const Float3& a, const Float3& b, const Float3& c)
+	{
+		const Float3 ab = b - a;
+		const Float3 ac = c - a;
+		const float d1 = -Dot(ab, a);
+		const float d2 = -Dot(ac, a);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+		{
+			return Length(a);
+		}
+
+		const float d3 = -Dot(ab, b);
+		const float d4 = -Dot(ac, b);
+		if (d3 >= 0.0f && d4 <= d3)
+		{
+			return Length(b);
+		}
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		{
+			return Length(a + ab * (d1 / (d1 - d3)));
+		}
+
+		const float d5 = -Dot(ab, c);
+		const float d6 = -Dot(ac, c);
+		if (d6 >= 0.0f && d5 <= d6)
+		{
+			return Length(c);
+		}
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		{
+			return Length(a + ac * (d2 / (d2 - d6)));
+		}
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+		{
+			return Length(b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+		}
+
+		const float denominator = 1.0f / (va + vb + vc);
+		return Length(a + ab * (vb * denominator) + ac * (vc * denominator));
+	}
+
+	// Largest distance between the surface and the unit sphere, the error along the silhouette
+	float MeasureSilhouetteError(const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices)
+	{
+		float innerRadius = FLT_MAX;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			innerRadius = fminf(innerRadius, GetDistanceToOrigin(vertices[indices[i]].Position, vertices[indices[i + 1]].Position,
+				vertices[indices[i + 2]].Position));
+		}
+		return indices.empty() ? 0.0f : 1.0f - innerRadius;
+	}
+
+	void RunSimplifyRows(const char* name, const std::vector<VertexData>& vertices, const std::vector<uint32_t>& indices, ThreadPool& threadPool)
+	{
+		std::vector<uint32_t> serialIndices;
+		std::vector<uint32_t> parallelIndices;
+		for (float triangleRatio : TRIANGLE_RATIOS)
+		{
+			const uint32_t targetIndexCount = (uint32_t)(indices.size() / 3 * triangleRatio) * 3;
+
+			// Every run takes seconds on the larger meshes, so each path is timed once from its stats
+			MeshSimplificationStats serialStats;
+			SimplifyMesh(vertices.data(), (uint32_t)vertices.size(), sizeof(VertexData), indices.data(), (uint32_t)indices.size(), targetIndexCount,
+				serialIndices, VERTEX_DATA_SIMPLIFY_ATTRIBUTES, FLT_MAX, nullptr, &serialStats);
+			MeshSimplificationStats parallelStats;
+			SimplifyMesh(vertices.data(), (uint32_t)vertices.size(), sizeof(VertexData), indices.data(), (uint32_t)indices.size(), targetIndexCount,
+				parallelIndices, VERTEX_DATA_SIMPLIFY_ATTRIBUTES, FLT_MAX, &threadPool, &parallelStats);
+
+			const float silhouetteError = MeasureSilhouetteError(vertices, parallelIndices);
+			printf("%-12s %10u %7.2f%% %10u %6u %12.3e %12.3e %10.3f %10.3f %10.3f %10.3f %8.2f %8.2f %8s\n", name, serialStats.SourceTriangleCount,
+				triangleRatio * 100.0f, parallelStats.TriangleCount, parallelStats.PassCount, parallelStats.Error, silhouetteError,
+				serialStats.QuadricMilliseconds, parallelStats.QuadricMilliseconds, serialStats.TotalMilliseconds, parallelStats.TotalMilliseconds,
+				serialStats.GetTrianglesPerSecond() / 1000000.0, parallelStats.GetTrianglesPerSecond() / 1000000.0,
+				serialIndices == parallelIndices ? "yes" : "NO");
+		}
+	}
+}
+
+void RunSimplifyBenchmark()
+{
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const uint32_t threadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+
+	printf("Quadric error simplification of unit spheres with the normal as attribute, serial against %u threads (%u hardware threads)\n",
+		threadCount, hardwareThreadCount);
+	printf("Error is the one the simplifier reports, silhouette is the largest distance between the result and the unit sphere.\n");
+	printf("Matches compares the parallel result with the serial one.\n");
+	printf("%-12s %10s %8s %10s %6s %12s %12s %10s %10s %10s %10s %8s %8s %8s\n", "mesh", "triangles", "target", "result", "passes", "error",
+		"silhouette", "quad ms 1", "quad ms N", "total ms 1", "total ms N", "Mtri/s 1", "Mtri/s N", "matches");
+
+	ThreadPool threadPool;
+	threadPool.Init(threadCount);
+
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+	GenerateIcosphere(7, vertices, indices, &threadPool);
+	RunSimplifyRows("icosphere7", vertices, indices, threadPool);
+	GenerateSphere(512, 512, vertices, indices, &threadPool);
+	RunSimplifyRows("uvsphere512", vertices, indices, threadPool);
+	GenerateSphere(1024, 1024, vertices, indices, &threadPool);
+	RunSimplifyRows("uvsphere1024", vertices, indices, threadPool);
+
+	threadPool.Free();
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/DrawSortKey.h"
+#include "../Common/JobSystem.h"
+#include "../Common/RadixSort.h"
+
+namespace
+{
+	constexpr uint32_t DRAW_COUNT = 1024 * 1024;
+	const uint32_t THREAD_COUNTS[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+	// Draws of a scene with a handful of shaders and states over many meshes, one in eight of them transparent
+	constexpr uint32_t SHADER_COUNT = 8;
+	constexpr uint32_t STATE_COUNT = 16;
+	constexpr uint32_t MESH_COUNT = 256;
+	constexpr uint32_t TRANSPARENT_FRACTION = 8;
+	constexpr float MAX_DISTANCE = 1000.0f;
+
+	void FillRandomDrawKeys(uint32_t count, std::vector<uint64_t>& outKeys, std::vector<uint32_t>& outDraws)
+	{
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<float> distance(0.0f, MAX_DISTANCE);
+
+		outKeys.resize(count);
+		outDraws.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const DRAW_PASS pass = random() % TRANSPARENT_FRACTION ? DRAW_PASS_OPAQUE : DRAW_PASS_TRANSPARENT;
+			const uint32_t shader = random() % SHADER_COUNT;
+			const uint32_t state = random() % STATE_COUNT;
+			const uint32_t mesh = random() % MESH_COUNT;
+			const float drawDistance = distance(random);
+			outKeys[i] = MakeDrawKey(pass, shader, state, mesh, QuantizeDrawDepth(drawDistance * drawDistance));
+			outDraws[i] = i;
+		}
+	}
+}
+
+void RunSortBenchmark()
+{
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const uint32_t maxThreadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+
+	std::vector<uint64_t> keys;
+	std::vector<uint32_t> draws;
+	FillRandomDrawKeys(DRAW_COUNT, keys, draws);
+
+	// Every run sorts a fresh copy of the keys, the copy alone is measured to tell it apart
+	std::vector<uint64_t> sortedKeys(DRAW_COUNT);
+	std::vector<uint32_t> sortedDraws(DRAW_COUNT);
+	const double copyMilliseconds = MeasureMilliseconds([&]()
+		{
+			memcpy(sortedKeys.data(), keys.data(), DRAW_COUNT * sizeof(uint64_t));
+			memcpy(sortedDraws.data(), draws.data(), DRAW_COUNT * sizeof(uint32_t));
+		});
+
+	// std::stable_sort of the pairs by key, the reference for the radix sort
+	std::vector<std::pair<uint64_t, uint32_t>> pairs(DRAW_COUNT);
+	std::vector<std::pair<uint64_t, uint32_t>> referencePairs(DRAW_COUNT);
+	for (uint32_t i = 0; i < DRAW_COUNT; ++i)
+	{
+		pairs[i] = { keys[i], draws[i] };
+	}
+	const double referenceMilliseconds = MeasureMilliseconds([&]()
+		{
+			referencePairs = pairs;
+			std::stable_sort(referencePairs.begin(), referencePairs.end(),
+				[](const std::pair<uint64_t, uint32_t>& a, const std::pair<uint64_t, uint32_t>& b) { return a.first < b.first; });
+		});
+
+	std::vector<uint64_t> referenceKeys(DRAW_COUNT);
+	for (uint32_t i = 0; i < DRAW_COUNT; ++i)
+	{
+		referenceKeys[i] = referencePairs[i].first;
+	}
+
+	printf("Draw sort: %u draws with 64-bit keys (%u shaders, %u states, %u meshes, 1 in %u transparent), radix sorted by 1 to %u threads (%u hardware threads)\n",
+		DRAW_COUNT, SHADER_COUNT, STATE_COUNT, MESH_COUNT, TRANSPARENT_FRACTION, maxThreadCount, hardwareThreadCount);
+	printf("std::stable_sort: %.3f ms. Every time includes a %.3f ms copy of the unsorted keys.\n", referenceMilliseconds, copyMilliseconds);
+	printf("State changes between neighboring draws: %u unsorted, %u sorted.\n", CountDrawStateChanges(keys.data(), DRAW_COUNT),
+		CountDrawStateChanges(referenceKeys.data(), DRAW_COUNT));
+	printf("Matches compares the sorted keys and draws with std::stable_sort.\n");
+	printf("%8s %10s %12s %14s %9s %12s %8s\n", "threads", "sort ms", "M keys/s", "vs stable_sort", "speedup", "passes", "matches");
+
+	RadixSorter sorter;
+	sorter.Reserve(DRAW_COUNT);
+	double oneThreadMilliseconds = 0.0;
+	for (uint32_t threadCount : THREAD_COUNTS)
+	{
+		if (threadCount > maxThreadCount)
+		{
+			break;
+		}
+
+		JobSystem jobSystem;
+		jobSystem.Init(threadCount);
+		const double sortMilliseconds = MeasureMilliseconds([&]()
+			{
+				memcpy(sortedKeys.data(), keys.data(), DRAW_COUNT * sizeof(uint64_t));
+				memcpy(sortedDraws.data(), draws.data(), DRAW_COUNT * sizeof(uint32_t));
+				sorter.Sort(sortedKeys.data(), sortedDraws.data(), DRAW_COUNT, &jobSystem);
+			});
+		jobSystem.Free();
+
+		bool bMatches = true;
+		for (uint32_t i = 0; i < DRAW_COUNT && bMatches; ++i)
+		{
+			bMatches = sortedKeys[i] == referencePairs[i].first && sortedDraws[i] == referencePairs[i].second;
+		}
+
+		if (threadCount == 1)
+		{
+			oneThreadMilliseconds = sortMilliseconds;
+		}
+		const RadixSortStats& stats = sorter.GetStats();
+		char passes[32];
+		snprintf(passes, sizeof(passes), "%u (%u skip)", stats.PassCount, stats.SkippedPassCount);
+		printf("%8u %10.3f %12.2f %14.2f %9.2f %12s %8s\n", threadCount, sortMilliseconds, DRAW_COUNT / 1000.0 / sortMilliseconds,
+			referenceMilliseconds / sortMilliseconds, oneThreadMilliseconds / sortMilliseconds, passes, bMatches ? "yes" : "NO");
+	}
+}
@@ -0,0 +1,160 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/MeshImporter.h"
+#include "../Common/MeshTangents.h"
+#include "../Common/PrimitiveMeshes.h"
+#include "../Common/ThreadPool.h"
+
+namespace
+{
+	struct TangentBenchmarkMesh
+	{
+		const char* Name;
+		PrimitiveShape Shape;
+	};
+
+	// Every shape turns around the Y axis, and the torus mirrors the latitude on the inside of its tube
+	const TangentBenchmarkMesh TANGENT_MESHES[] =
+	{
+		{ "uvsphere1024", { PRIMITIVE_TYPE_UV_SPHERE, 1024, 1024 } },
+		{ "uvsphere2048", { PRIMITIVE_TYPE_UV_SPHERE, 2048, 2048 } },
+		{ "icosphere8", { PRIMITIVE_TYPE_ICOSPHERE, 8, 0 } },
+		{ "torus", { PRIMITIVE_TYPE_TORUS, 2048, 512 } },
+	};
+
+	// Sphere written as OBJ and imported, welded and numbered the way the importer does it
+	constexpr int32_t IMPORTED_SEGMENT_COUNT = 1024;
+	const char* TANGENT_BENCHMARK_OBJ_FILE_NAME = "TangentBenchmark.obj";
+
+	// Vertices closer than this to the Y axis have no longitude to compare with
+	constexpr float MIN_AXIS_DISTANCE = 0.05f;
+
+	constexpr double RADIANS_TO_DEGREES = 180.0 / 3.14159265358979323846;
+
+	double GetAngleDegrees(const Float3& a, const Float3& b)
+	{
+		return atan2(Length(Cross(a, b)), Dot(a, b)) * RADIANS_TO_DEGREES;
+	}
+
+	// Largest angle between the tangents and the direction of increasing longitude around the Y axis
+	double MeasureLongitudeError(const std::vector<VertexData>& vertices, const std::vector<Float4>& tangents)
+	{
+		double maxAngle = 0.0;
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const Float3& position = vertices[i].Position;
+			if (sqrtf(position.x * position.x + position.z * position.z) >= MIN_AXIS_DISTANCE)
+			{
+				maxAngle = fmax(maxAngle, GetAngleDegrees(ToFloat3(tangents[i]), Float3{ -position.z, 0.0f, position.x }));
+			}
+		}
+		return maxAngle;
+	}
+
+	// Largest angle of the unpacked normals and tangents, and the vertices whose bitangent sign changed
+	void MeasureQTangentError(const std::vector<VertexData>& vertices, const std::vector<Float4>& tangents, const std::vector<QTangent>& qTangents,
+		double& outMaxAngle, uint32_t& outSignErrorCount)
+	{
+		outMaxAngle = 0.0;
+		outSignErrorCount = 0;
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			Float3 normal;
+			Float4 tangent;
+			UnpackQTangent(qTangents[i], normal, tangent);
+			outMaxAngle = fmax(outMaxAngle, fmax(GetAngleDegrees(normal, vertices[i].Normal), GetAngleDegrees(ToFloat3(tangent), ToFloat3(tangents[i]))));
+			outSignErrorCount += tangent.w != tangents[i].w;
+		}
+	}
+
+	template <typename Index>
+	void RunTangentRow(const char* name, const std::vector<VertexData>& vertices, const std::vector<Index>& indices, ThreadPool& threadPool)
+	{
+		const uint32_t vertexCount = (uint32_t)vertices.size();
+		const uint32_t indexCount = (uint32_t)indices.size();
+		std::vector<Float4> serialTangents;
+		std::vector<Float4> parallelTangents;
+		TangentGenerationStats stats{};
+		const double serialMilliseconds = MeasureMilliseconds([&]()
+			{
+				GenerateTangents(vertices.data(), vertexCount, nullptr, indices.data(), indexCount, serialTangents);
+			});
+		const double parallelMilliseconds = MeasureMilliseconds([&]()
+			{
+				GenerateTangents(vertices.data(), vertexCount, nullptr, indices.data(), indexCount, parallelTangents, &threadPool, &stats);
+			});
+
+		std::vector<QTangent> qTangents(vertexCount);
+		const double packMilliseconds = MeasureMilliseconds([&]() { PackQTangents(vertices.data(), parallelTangents.data(), vertexCount, qTangents.data()); });
+		double qTangentError = 0.0;
+		uint32_t signErrorCount = 0;
+		MeasureQTangentError(vertices, parallelTangents, qTangents, qTangentError, signErrorCount);
+
+		const bool bMatches = !memcmp(serialTangents.data(), parallelTangents.data(), vertexCount * sizeof(Float4));
+		printf("%-13s %10u %10.3f %10.3f %9.2f %9.2f %9.2f %9u %9u %10.4f %10.4f %7u %8s\n", name, vertexCount, serialMilliseconds, parallelMilliseconds,
+			vertexCount / 1000.0 / serialMilliseconds, vertexCount / 1000.0 / parallelMilliseconds, vertexCount / 1000.0 / packMilliseconds,
+			stats.FallbackVertexCount, stats.MirroredVertexCount, MeasureLongitudeError(vertices, parallelTangents), qTangentError, signErrorCount,
+			bMatches ? "yes" : "NO");
+	}
+}
+
+void RunTangentBenchmark()
+{
+	const uint32_t hardwareThreadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	const uint32_t threadCount = hardwareThreadCount > 1 ? hardwareThreadCount : 2;
+
+	printf("Tangents from longitude and latitude texture coordinates, serial against %u threads (%u hardware threads), and packing into QTangents\n",
+		threadCount, hardwareThreadCount);
+	printf("Longitude is the largest angle to the direction of increasing longitude in degrees, qtangent the largest angle after packing.\n");
+	printf("Matches compares the parallel tangents with the serial ones.\n");
+	printf("%-13s %10s %10s %10s %9s %9s %9s %9s %9s %10s %10s %7s %8s\n", "mesh", "vertices", "ms 1", "ms N", "Mvert/s 1", "Mvert/s N", "pack Mv/s",
+		"fallback", "mirrored", "longitude", "qtangent", "signs", "matches");
+
+	ThreadPool threadPool;
+	threadPool.Init(threadCount);
+
+	for (const TangentBenchmarkMesh& mesh : TANGENT_MESHES)
+	{
+		std::vector<VertexData> vertices;
+		MeshIndices indices;
+		GeneratePrimitive(mesh.Shape, vertices, indices, &threadPool);
+		if (indices.Format == INDEX_FORMAT_UINT16)
+		{
+			RunTangentRow(mesh.Name, vertices, indices.Indices16, threadPool);
+		}
+		else
+		{
+			RunTangentRow(mesh.Name, vertices, indices.Indices32, threadPool);
+		}
+	}
+
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+	GenerateSphere(IMPORTED_SEGMENT_COUNT, IMPORTED_SEGMENT_COUNT, vertices, indices, &threadPool);
+	ImportedMesh mesh;
+	MeshImportStats importStats;
+	if (WriteBenchmarkObj(TANGENT_BENCHMARK_OBJ_FILE_NAME, vertices, indices) && ImportMesh(TANGENT_BENCHMARK_OBJ_FILE_NAME, mesh, &threadPool, &importStats))
+	{
+		if (mesh.Indices.Format == INDEX_FORMAT_UINT16)
+		{
+			RunTangentRow("imported", mesh.Vertices, mesh.Indices.Indices16, threadPool);
+		}
+		else
+		{
+			RunTangentRow("imported", mesh.Vertices, mesh.Indices.Indices32, threadPool);
+		}
+	}
+	else
+	{
+		printf("Failed to write or import %s\n", TANGENT_BENCHMARK_OBJ_FILE_NAME);
+	}
+	remove(TANGENT_BENCHMARK_OBJ_FILE_NAME);
+
+	threadPool.Free();
+}
@@ -0,0 +1,88 @@
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "Benchmarks.h"
+#include "../Common/ObjectTransforms.h"
+#include "../Common/Simd.h"
+
+namespace
+{
+	const uint32_t OBJECT_COUNTS[] = { 1000, 100000, 1000000 };
+
+	void FillRandomTransforms(uint32_t count, TransformArrays& outTransforms)
+	{
+		std::mt19937 random(12345);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+		outTransforms.Resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			outTransforms.PositionX[i] = position(random);
+			outTransforms.PositionY[i] = position(random);
+			outTransforms.PositionZ[i] = position(random);
+
+			float x = unit(random);
+			float y = unit(random);
+			float z = unit(random);
+			float w = unit(random);
+			const float inverseLength = 1.0f / sqrtf(x * x + y * y + z * z + w * w + 1e-6f);
+			outTransforms.RotationX[i] = x * inverseLength;
+			outTransforms.RotationY[i] = y * inverseLength;
+			outTransforms.RotationZ[i] = z * inverseLength;
+			outTransforms.RotationW[i] = w * inverseLength;
+
+			outTransforms.ScaleX[i] = scale(random);
+			outTransforms.ScaleY[i] = scale(random);
+			outTransforms.ScaleZ[i] = scale(random);
+		}
+	}
+
+	float MaxDifference(const std::vector<ObjectMatrices>& a, const std::vector<ObjectMatrices>& b)
+	{
+		float maxDifference = 0.0f;
+		const float* pa = &a[0].WorldViewProjection[0].x;
+		const float* pb = &b[0].WorldViewProjection[0].x;
+		const size_t floatCount = a.size() * sizeof(ObjectMatrices) / sizeof(float);
+		for (size_t i = 0; i < floatCount; ++i)
+		{
+			maxDifference = fmaxf(maxDifference, fabsf(pa[i] - pb[i]));
+		}
+		return maxDifference;
+	}
+}
+
+void RunTransformBenchmark()
+{
+	const Float4x4 viewMatrix = MatrixLookAtLH({ 0.0f, 50.0f, -200.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+	const Float4x4 projectionMatrix = MatrixPerspectiveFovLH(ConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	const Float4x4 viewProjectionMatrix = viewMatrix * projectionMatrix;
+
+	printf("ObjectMatrices (WorldViewProjection, World, Normal), %d objects per SIMD iteration\n", SIMD_WIDTH);
+	printf("%10s %12s %12s %16s %16s %8s %12s\n", "objects", "scalar ms", "simd ms", "scalar mat/s", "simd mat/s", "speedup", "max diff");
+
+	for (uint32_t objectCount : OBJECT_COUNTS)
+	{
+		TransformArrays transforms;
+		FillRandomTransforms(objectCount, transforms);
+
+		std::vector<ObjectMatrices> scalarOutput(objectCount);
+		std::vector<ObjectMatrices> simdOutput(objectCount);
+
+		const double scalarMilliseconds = MeasureMilliseconds([&]()
+			{
+				ComputeObjectMatricesScalar(transforms, 0, objectCount, viewProjectionMatrix, scalarOutput.data(), sizeof(ObjectMatrices));
+			});
+		const double simdMilliseconds = MeasureMilliseconds([&]()
+			{
+				ComputeObjectMatrices(transforms, 0, objectCount, viewProjectionMatrix, simdOutput.data(), sizeof(ObjectMatrices));
+			});
+
+		printf("%10u %12.3f %12.3f %16.0f %16.0f %7.2fx %12.3g\n", objectCount, scalarMilliseconds, simdMilliseconds,
+			objectCount * 1000.0 / scalarMilliseconds, objectCount * 1000.0 / simdMilliseconds, scalarMilliseconds / simdMilliseconds,
+			MaxDifference(scalarOutput, simdOutput));
+	}
+}
@@ -0,0 +1,398 @@
+#include "BoxScene.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "../Common/InstanceGrid.h"
+
+namespace
+{
+	constexpr float CLEAR_COLOR[]{ 0.0f, 0.125f, 0.3f, 1.0f };
+
+	constexpr float OBJECT_ROTATION_SPEED = 45.0f;
+	constexpr float INSTANCE_SPACING = 4.0f;
+	constexpr uint32_t OBJECT_CONSTANT_RING_BUFFER_SIZE = 4 * 1024 * 1024;
+
+	// Below this many instances a linear pass over the bounds is cheaper than keeping a BVH
+	constexpr uint32_t BVH_MIN_OBJECT_COUNT = 1024;
+	constexpr float BVH_REBUILD_COST_RATIO = 1.5f;
+
+	constexpr int32_t OCCLUSION_BUFFER_WIDTH = 320;
+
+	constexpr float FOV = ConvertToRadians(45.0f);
+	constexpr float NEAR_Z = 0.1f;
+	constexpr float FAR_Z = 1000.0f;
+}
+
+bool BoxScene::Init(RenderDevice* device, int32_t width, int32_t height)
+{
+	Device = device;
+	Width = width;
+	Height = height;
+
+	// Cube, reordered for the vertex cache like every other mesh
+	ColorVertexData vertices[]
+	{
+		{ Float3{ -1.0f, +1.0f, -1.0f }, Float4{ 1.0f, 0.0f, 0.0f, 1.0f } },
+		{ Float3{ -1.0f, +1.0f, +1.0f }, Float4{ 0.0f, 1.0f, 0.0f, 1.0f } },
+		{ Float3{ +1.0f, +1.0f, +1.0f }, Float4{ 0.0f, 0.0f, 1.0f, 1.0f } },
+		{ Float3{ +1.0f, +1.0f, -1.0f }, Float4{ 1.0f, 1.0f, 0.0f, 1.0f } },
+		{ Float3{ -1.0f, -1.0f, -1.0f }, Float4{ 1.0f, 0.0f, 1.0f, 1.0f } },
+		{ Float3{ -1.0f, -1.0f, +1.0f }, Float4{ 0.0f, 1.0f, 1.0f, 1.0f } },
+		{ Float3{ +1.0f, -1.0f, +1.0f }, Float4{ 1.0f, 1.0f, 1.0f, 1.0f } },
+		{ Float3{ +1.0f, -1.0f, -1.0f }, Float4{ 0.0f, 0.0f, 0.0f, 1.0f } },
+	};
+
+	uint16_t indices[]
+	{
+		0, 1, 2,
+		0, 2, 3,
+
+		5, 4, 7,
+		5, 7, 6,
+
+		4, 0, 3,
+		4, 3, 7,
+
+		6, 2, 1,
+		6, 1, 5,
+
+		7, 3, 2,
+		7, 2, 6,
+
+		5, 1, 0,
+		5, 0, 4
+	};
+
+	OptimizeMesh(vertices, (uint32_t)std::size(vertices), sizeof(ColorVertexData), indices, (uint32_t)std::size(indices), &MeshStats);
+
+	// Create vertex buffer
+	const VertexQuantization quantization = ComputeVertexQuantization(vertices, (uint32_t)std::size(vertices), sizeof(ColorVertexData));
+	QuantizedColorVertexData quantizedVertices[std::size(vertices)];
+	if (bQuantizedVertices)
+	{
+		QuantizeVertices(vertices, (uint32_t)std::size(vertices), quantization, quantizedVertices);
+		QuantizationError = MeasureQuantizationError(vertices, quantizedVertices, (uint32_t)std::size(vertices), quantization);
+	}
+
+	VertexBuffer = Device->CreateBuffer({ BUFFER_TYPE_VERTEX, BUFFER_USAGE_DEFAULT, GetVertexSize() * (uint32_t)std::size(vertices) },
+		bQuantizedVertices ? (const void*)quantizedVertices : (const void*)vertices);
+	if (!VertexBuffer.IsValid())
+	{
+		return false;
+	}
+
+	if (bQuantizedVertices)
+	{
+		MeshConstantBuffer = Device->CreateBuffer({ BUFFER_TYPE_CONSTANT, BUFFER_USAGE_DEFAULT, sizeof(VertexQuantization) }, &quantization);
+		if (!MeshConstantBuffer.IsValid())
+		{
+			return false;
+		}
+	}
+
+	// Create index buffer
+	IndexBuffer = Device->CreateBuffer({ BUFFER_TYPE_INDEX, BUFFER_USAGE_DEFAULT, sizeof(indices) }, indices);
+	if (!IndexBuffer.IsValid())
+	{
+		return false;
+	}
+	IndexCount = (uint32_t)std::size(indices);
+
+	// Place the boxes
+	std::vector<Float3> instancePositions;
+	std::vector<Float4> instanceColors;
+	GenerateInstanceGrid(InstanceCount, INSTANCE_SPACING, instancePositions, instanceColors);
+
+	Transforms.Resize(InstanceCount);
+	for (uint32_t i = 0; i < InstanceCount; ++i)
+	{
+		Transforms.PositionX[i] = instancePositions[i].x;
+		Transforms.PositionY[i] = instancePositions[i].y;
+		Transforms.PositionZ[i] = instancePositions[i].z;
+	}
+
+	ProjectionMatrix = MatrixPerspectiveFovLH(FOV, Width / (float)Height, NEAR_Z, FAR_Z);
+
+	Colors = instanceColors;
+	VisibleIndices.resize(InstanceCount);
+
+	// Create occlusion buffer, the cube is its own occluder
+	if (OccluderBudget > 0)
+	{
+		Occluder.Positions.resize(std::size(vertices));
+		for (size_t i = 0; i < std::size(vertices); ++i)
+		{
+			Occluder.Positions[i] = vertices[i].Position;
+		}
+		Occluder.Indices.assign(std::begin(indices), std::end(indices));
+
+		if (!Occlusion.Init(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_WIDTH * Height / Width, 0))
+		{
+			return false;
+		}
+	}
+
+	// Create instance buffer, or the object constants without instancing
+	if (bInstancing)
+	{
+		uint32_t instanceBufferSize = 0;
+		if (!ComputeBufferByteWidth(sizeof(InstanceData), InstanceCount, instanceBufferSize))
+		{
+			return false;
+		}
+
+		Instances.resize(InstanceCount);
+		InstanceBuffer = Device->CreateBuffer({ BUFFER_TYPE_VERTEX, BUFFER_USAGE_DYNAMIC, instanceBufferSize }, nullptr);
+		if (!InstanceBuffer.IsValid())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		ObjectConstants.resize(InstanceCount);
+		if (!ObjectConstantRingBuffer.Init(Device, BUFFER_TYPE_CONSTANT, OBJECT_CONSTANT_RING_BUFFER_SIZE))
+		{
+			return false;
+		}
+	}
+
+	// Create vertex shaders
+	constexpr char vertexShaderData[] =
+		"cbuffer ObjectConstants : register(b0)\
+		{\
+			float4x4 WorldViewProjection;\
+			float4x3 World;\
+			float3x3 NormalMatrix;\
+			float4 ObjectColor;\
+		}\
+		cbuffer MeshConstants : register(b1)\
+		{\
+			float4 PositionScale;\
+			float4 PositionBias;\
+		}\
+		struct VS_INPUT\
+		{\
+			float4 Position : POSITION;\
+			float4 Color : COLOR0;\
+			float4 WorldViewProjection0 : WORLDVIEWPROJECTION0;\
+			float4 WorldViewProjection1 : WORLDVIEWPROJECTION1;\
+			float4 WorldViewProjection2 : WORLDVIEWPROJECTION2;\
+			float4 WorldViewProjection3 : WORLDVIEWPROJECTION3;\
+			float4 InstanceColor : COLOR1;\
+		};\
+		struct VS_OUTPUT\
+		{\
+			float4 Position : SV_Position;\
+			float4 Color : COLOR;\
+		};\
+		float4 DecodePosition(float4 position)\
+		{\
+			return float4(position.xyz * PositionScale.xyz + PositionBias.xyz, 1.0f);\
+		}\
+		VS_OUTPUT VS(VS_INPUT input)\
+		{\
+			float4x4 worldViewProjection = float4x4(input.WorldViewProjection0, input.WorldViewProjection1, input.WorldViewProjection2, input.WorldViewProjection3);\
+			VS_OUTPUT output;\
+			output.Position = mul(worldViewProjection, input.Position);\
+			output.Color = input.Color * input.InstanceColor;\
+			return output;\
+		}\
+		VS_OUTPUT VSPerObject(float4 position : POSITION, float4 color : COLOR0)\
+		{\
+			VS_OUTPUT output;\
+			output.Position = mul(position, WorldViewProjection);\
+			output.Color = color * ObjectColor;\
+			return output;\
+		}\
+		VS_OUTPUT VSQuantized(VS_INPUT input)\
+		{\
+			input.Position = DecodePosition(input.Position);\
+			return VS(input);\
+		}\
+		VS_OUTPUT VSQuantizedPerObject(float4 position : POSITION, float4 color : COLOR0)\
+		{\
+			return VSPerObject(DecodePosition(position), color);\
+		}";
+
+	VertexShader = Device->CreateVertexShader({ nullptr, vertexShaderData, bQuantizedVertices ? "VSQuantized" : "VS", "vs_4_1" });
+	if (!VertexShader.IsValid())
+	{
+		return false;
+	}
+
+	PerObjectVertexShader = Device->CreateVertexShader({ nullptr, vertexShaderData, bQuantizedVertices ? "VSQuantizedPerObject" : "VSPerObject", "vs_4_1" });
+	if (!PerObjectVertexShader.IsValid())
+	{
+		return false;
+	}
+
+	// Create input layouts
+	InputElementDesc elements[]
+	{
+		{ "POSITION", 0, VERTEX_FORMAT_FLOAT3, 0, 0 },
+		{ "COLOR", 0, VERTEX_FORMAT_FLOAT4, 0, 12 },
+		{ "WORLDVIEWPROJECTION", 0, VERTEX_FORMAT_FLOAT4, 1, 0, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLDVIEWPROJECTION", 1, VERTEX_FORMAT_FLOAT4, 1, 16, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLDVIEWPROJECTION", 2, VERTEX_FORMAT_FLOAT4, 1, 32, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLDVIEWPROJECTION", 3, VERTEX_FORMAT_FLOAT4, 1, 48, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "COLOR", 1, VERTEX_FORMAT_FLOAT4, 1, 160, INPUT_CLASSIFICATION_PER_INSTANCE, 1 }
+	};
+	constexpr uint32_t numElements = (uint32_t)std::size(elements);
+
+	if (bQuantizedVertices)
+	{
+		elements[0] = { "POSITION", 0, VERTEX_FORMAT_SHORT4_SNORM, 0, 0 };
+		elements[1] = { "COLOR", 0, VERTEX_FORMAT_UBYTE4_UNORM, 0, 8 };
+	}
+
+	InputLayout = Device->CreateInputLayout(elements, numElements, VertexShader);
+	if (!InputLayout.IsValid())
+	{
+		return false;
+	}
+
+	// Only the per-vertex elements
+	PerObjectInputLayout = Device->CreateInputLayout(elements, 2, PerObjectVertexShader);
+	if (!PerObjectInputLayout.IsValid())
+	{
+		return false;
+	}
+
+	// Create pixel shader
+	constexpr char pixelShaderData[] =
+		"float4 PS(float4 position : SV_Position, float4 color : COLOR) : SV_Target\
+		{\
+			return color;\
+		}";
+
+	PixelShader = Device->CreatePixelShader({ nullptr, pixelShaderData, "PS", "ps_4_1" });
+	if (!PixelShader.IsValid())
+	{
+		return false;
+	}
+
+	Device->SetInputLayout(bInstancing ? InputLayout : PerObjectInputLayout);
+	Device->SetVertexBuffer(0, VertexBuffer, GetVertexSize(), 0);
+	Device->SetVertexBuffer(1, InstanceBuffer, sizeof(InstanceData), 0);
+	Device->SetIndexBuffer(IndexBuffer, INDEX_FORMAT_UINT16, 0);
+	Device->SetVertexShader(bInstancing ? VertexShader : PerObjectVertexShader);
+	if (bQuantizedVertices)
+	{
+		Device->SetVertexConstantBuffer(1, MeshConstantBuffer);
+	}
+	Device->SetPixelShader(PixelShader);
+
+	return true;
+}
+
+void BoxScene::Update(float deltaTime, const InputState& input)
+{
+	SceneCamera.Update(deltaTime, input);
+
+	ObjectRotationAngle += OBJECT_ROTATION_SPEED * deltaTime;
+
+	// Every box spins in place around Y
+	const float halfAngle = 0.5f * ConvertToRadians(ObjectRotationAngle);
+	std::fill(Transforms.RotationY.begin(), Transforms.RotationY.end(), sinf(halfAngle));
+	std::fill(Transforms.RotationW.begin(), Transforms.RotationW.end(), cosf(halfAngle));
+
+	// Only objects inside the view frustum and not hidden behind the closest ones are submitted
+	const Float4x4 viewProjectionMatrix = SceneCamera.GetViewMatrix() * ProjectionMatrix;
+	const Frustum frustum = ExtractFrustumPlanes(viewProjectionMatrix);
+	ComputeBoxBounds(Transforms, Float3{ 0.0f, 0.0f, 0.0f }, Float3{ 1.0f, 1.0f, 1.0f }, Bounds);
+	if (InstanceCount >= BVH_MIN_OBJECT_COUNT)
+	{
+		// Refit follows the spinning boxes and a rebuild restores the tree once refitting made it too loose
+		ObjectBvh.Refit(Bounds);
+		if (ObjectBvh.GetCostRatio() > BVH_REBUILD_COST_RATIO)
+		{
+			ObjectBvh.Build(Bounds);
+		}
+		VisibleCount = ObjectBvh.CullFrustum(frustum, VisibleIndices.data());
+	}
+	else
+	{
+		VisibleCount = CullBoxes(frustum, Bounds, 0, InstanceCount, VisibleIndices.data());
+	}
+	if (OccluderBudget > 0)
+	{
+		Occlusion.BeginFrame(viewProjectionMatrix);
+		Occlusion.RasterizeClosestOccluders(Occluder, Transforms, VisibleIndices.data(), VisibleCount, SceneCamera.Position, OccluderBudget);
+		VisibleCount = Occlusion.CullBoxes(Bounds, VisibleIndices.data(), VisibleCount);
+	}
+	GatherTransforms(Transforms, VisibleIndices.data(), VisibleCount, VisibleTransforms);
+
+	// Matrices are written straight into the instance stream or the object constants
+	if (bInstancing)
+	{
+		for (uint32_t i = 0; i < VisibleCount; ++i)
+		{
+			Instances[i].Color = Colors[VisibleIndices[i]];
+		}
+		ComputeObjectMatrices(VisibleTransforms, 0, VisibleCount, viewProjectionMatrix, &Instances[0].Matrices, sizeof(InstanceData));
+	}
+	else
+	{
+		for (uint32_t i = 0; i < VisibleCount; ++i)
+		{
+			ObjectConstants[i].Color = Colors[VisibleIndices[i]];
+		}
+		ComputeObjectMatrices(VisibleTransforms, 0, VisibleCount, viewProjectionMatrix, &ObjectConstants[0].Matrices, sizeof(ObjectConstantBufferData));
+	}
+}
+
+void BoxScene::Render()
+{
+	Device->Clear(CLEAR_COLOR, 1.0f);
+
+	if (bInstancing)
+	{
+		RenderInstanced();
+	}
+	else
+	{
+		RenderPerObject();
+	}
+
+	Device->Present();
+}
+
+void BoxScene::RenderInstanced()
+{
+	if (VisibleCount == 0)
+	{
+		return;
+	}
+
+	// One upload and one draw for every visible instance
+	Device->UpdateBuffer(InstanceBuffer, Instances.data(), (uint32_t)(sizeof(InstanceData) * VisibleCount));
+
+	Device->DrawIndexedInstanced(IndexCount, VisibleCount, 0, 0, 0);
+}
+
+void BoxScene::RenderPerObject()
+{
+	// Object constants go to the ring buffer in as few writes as fit, then every draw binds its own range
+	const uint32_t objectsPerWrite = ObjectConstantRingBuffer.GetSize() / sizeof(ObjectConstantBufferData);
+	for (uint32_t first = 0; first < VisibleCount; first += objectsPerWrite)
+	{
+		const uint32_t objectCount = VisibleCount - first < objectsPerWrite ? VisibleCount - first : objectsPerWrite;
+		const uint32_t offset = ObjectConstantRingBuffer.Write(&ObjectConstants[first], objectCount * sizeof(ObjectConstantBufferData), CONSTANT_BUFFER_ALIGNMENT);
+
+		for (uint32_t i = 0; i < objectCount; ++i)
+		{
+			Device->SetVertexConstantBufferRange(0, ObjectConstantRingBuffer.GetBuffer(), offset + i * sizeof(ObjectConstantBufferData), sizeof(ObjectConstantBufferData));
+			Device->DrawIndexed(IndexCount, 0, 0);
+		}
+	}
+}
+
+void BoxScene::Free()
+{
+	Occlusion.Free();
+
+	// Resources are owned by the device
+	Device = nullptr;
+}
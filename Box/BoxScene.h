@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "../Common/Bvh.h"
+#include "../Common/Camera.h"
+#include "../Common/DynamicRingBuffer.h"
+#include "../Common/FrustumCulling.h"
+#include "../Common/MathTypes.h"
+#include "../Common/MeshOptimizer.h"
+#include "../Common/ObjectTransforms.h"
+#include "../Common/OcclusionCulling.h"
+#include "../Common/Scene.h"
+#include "../Common/VertexQuantization.h"
+#include "../Common/VertexTypes.h"
+
+// How BoxScene draws its cubes. The members are described with the scene below.
+struct BoxSceneOptions
+{
+	uint32_t InstanceCount = 1;
+	bool bInstancing = true;
+
+	// Occluders drawn per frame. Off by default: from the default camera the grid shows the tops of the objects behind the
+	// closest ones, so they hide nothing and would only cost their rasterization.
+	uint32_t OccluderBudget = 0;
+	bool bQuantizedVertices = false;
+};
+
+// Vertex colored cubes with the shaders compiled from inline source.
+// Instances are culled against their world AABBs, through a BVH once there are many of them, then against the closest cubes
+// in an OcclusionCuller, and drawn the same way as in LightingScene. The view and projection only reach the shaders
+// through the precomputed WorldViewProjection matrices, so there are no view constants.
+// With bQuantizedVertices the cube is uploaded as 12-byte QuantizedColorVertexData and decoded by VSQuantized.
+class BoxScene : public Scene
+{
+public:
+	explicit BoxScene(const BoxSceneOptions& options = BoxSceneOptions{})
+		: InstanceCount(options.InstanceCount), bInstancing(options.bInstancing), OccluderBudget(options.OccluderBudget),
+		bQuantizedVertices(options.bQuantizedVertices) {}
+
+	const char* GetName() const override { return "Box"; }
+
+	bool Init(RenderDevice* device, int32_t width, int32_t height) override;
+	void Update(float deltaTime, const InputState& input) override;
+	void Render() override;
+	void Free() override;
+
+	const Camera& GetCamera() const { return SceneCamera; }
+	const OcclusionStats& GetOcclusionStats() const { return Occlusion.GetStats(); }
+	const MeshOptimizationStats& GetMeshOptimizationStats() const { return MeshStats; }
+
+	// Bytes of every vertex in the vertex buffer, and the precision lost to quantization (all zero without bQuantizedVertices)
+	uint32_t GetVertexSize() const { return bQuantizedVertices ? sizeof(QuantizedColorVertexData) : sizeof(ColorVertexData); }
+	const VertexQuantizationError& GetVertexQuantizationError() const { return QuantizationError; }
+
+private:
+	// Padded to one constant buffer range
+	struct ObjectConstantBufferData
+	{
+		ObjectMatrices Matrices;
+		Float4 Color;
+		Float4 Padding[5];
+	};
+	static_assert(sizeof(ObjectConstantBufferData) == CONSTANT_BUFFER_ALIGNMENT, "ObjectConstantBufferData must fill one range");
+
+	void RenderInstanced();
+	void RenderPerObject();
+
+	RenderDevice* Device = nullptr;
+	int32_t Width = 0;
+	int32_t Height = 0;
+
+	BufferHandle VertexBuffer;
+	BufferHandle IndexBuffer;
+	BufferHandle InstanceBuffer;
+	BufferHandle MeshConstantBuffer;
+	DynamicRingBuffer ObjectConstantRingBuffer;
+	InputLayoutHandle InputLayout;
+	InputLayoutHandle PerObjectInputLayout;
+	VertexShaderHandle VertexShader;
+	VertexShaderHandle PerObjectVertexShader;
+	PixelShaderHandle PixelShader;
+	uint32_t IndexCount = 0;
+	MeshOptimizationStats MeshStats{};
+
+	uint32_t InstanceCount;
+	bool bInstancing;
+	TransformArrays Transforms;
+	std::vector<Float4> Colors;
+	BoxBoundsArrays Bounds;
+	Bvh ObjectBvh;
+
+	// The closest visible objects are drawn as occluders into a small CPU depth buffer, and objects behind them are dropped
+	uint32_t OccluderBudget;
+	OccluderMesh Occluder;
+	OcclusionCuller Occlusion;
+
+	bool bQuantizedVertices;
+	VertexQuantizationError QuantizationError{};
+
+	// Objects that intersect the view frustum and are not occluded this frame. Instances or ObjectConstants hold only these, in the same order.
+	std::vector<uint32_t> VisibleIndices;
+	uint32_t VisibleCount = 0;
+	TransformArrays VisibleTransforms;
+	std::vector<InstanceData> Instances;
+	std::vector<ObjectConstantBufferData> ObjectConstants;
+
+	float ObjectRotationAngle = 0.0f;
+
+	Camera SceneCamera;
+	Float4x4 ProjectionMatrix = MatrixIdentity();
+};
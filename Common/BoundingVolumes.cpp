@@ -0,0 +1,92 @@
+#include "BoundingVolumes.h"
+
+#include <math.h>
+
+namespace
+{
+	// Rows of the rotation matrix of a unit quaternion, as in ComputeObjectMatrices
+	void QuaternionToRotationRows(float x, float y, float z, float w, float outRows[3][3])
+	{
+		const float xx = 2.0f * x * x;
+		const float yy = 2.0f * y * y;
+		const float zz = 2.0f * z * z;
+		const float xy = 2.0f * x * y;
+		const float xz = 2.0f * x * z;
+		const float yz = 2.0f * y * z;
+		const float xw = 2.0f * w * x;
+		const float yw = 2.0f * w * y;
+		const float zw = 2.0f * w * z;
+
+		outRows[0][0] = 1.0f - yy - zz;
+		outRows[0][1] = xy + zw;
+		outRows[0][2] = xz - yw;
+		outRows[1][0] = xy - zw;
+		outRows[1][1] = 1.0f - xx - zz;
+		outRows[1][2] = yz + xw;
+		outRows[2][0] = xz + yw;
+		outRows[2][1] = yz - xw;
+		outRows[2][2] = 1.0f - xx - yy;
+	}
+}
+
+void SphereBoundsArrays::Resize(uint32_t count)
+{
+	CenterX.resize(count, 0.0f);
+	CenterY.resize(count, 0.0f);
+	CenterZ.resize(count, 0.0f);
+	Radius.resize(count, 0.0f);
+}
+
+void BoxBoundsArrays::Resize(uint32_t count)
+{
+	CenterX.resize(count, 0.0f);
+	CenterY.resize(count, 0.0f);
+	CenterZ.resize(count, 0.0f);
+	ExtentX.resize(count, 0.0f);
+	ExtentY.resize(count, 0.0f);
+	ExtentZ.resize(count, 0.0f);
+}
+
+void ComputeSphereBounds(const TransformArrays& transforms, const Float3& localCenter, float localRadius, SphereBoundsArrays& outBounds)
+{
+	const uint32_t count = transforms.GetCount();
+	outBounds.Resize(count);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		float rotation[3][3];
+		QuaternionToRotationRows(transforms.RotationX[i], transforms.RotationY[i], transforms.RotationZ[i], transforms.RotationW[i], rotation);
+
+		// World position of the local center, (center * S) * R + T
+		const float center[3]{ localCenter.x * transforms.ScaleX[i], localCenter.y * transforms.ScaleY[i], localCenter.z * transforms.ScaleZ[i] };
+		outBounds.CenterX[i] = center[0] * rotation[0][0] + center[1] * rotation[1][0] + center[2] * rotation[2][0] + transforms.PositionX[i];
+		outBounds.CenterY[i] = center[0] * rotation[0][1] + center[1] * rotation[1][1] + center[2] * rotation[2][1] + transforms.PositionY[i];
+		outBounds.CenterZ[i] = center[0] * rotation[0][2] + center[1] * rotation[1][2] + center[2] * rotation[2][2] + transforms.PositionZ[i];
+
+		const float maxScale = fmaxf(fabsf(transforms.ScaleX[i]), fmaxf(fabsf(transforms.ScaleY[i]), fabsf(transforms.ScaleZ[i])));
+		outBounds.Radius[i] = localRadius * maxScale;
+	}
+}
+
+void ComputeBoxBounds(const TransformArrays& transforms, const Float3& localCenter, const Float3& localExtent, BoxBoundsArrays& outBounds)
+{
+	const uint32_t count = transforms.GetCount();
+	outBounds.Resize(count);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		float rotation[3][3];
+		QuaternionToRotationRows(transforms.RotationX[i], transforms.RotationY[i], transforms.RotationZ[i], transforms.RotationW[i], rotation);
+
+		const float center[3]{ localCenter.x * transforms.ScaleX[i], localCenter.y * transforms.ScaleY[i], localCenter.z * transforms.ScaleZ[i] };
+		const float extent[3]{ fabsf(localExtent.x * transforms.ScaleX[i]), fabsf(localExtent.y * transforms.ScaleY[i]), fabsf(localExtent.z * transforms.ScaleZ[i]) };
+		outBounds.CenterX[i] = center[0] * rotation[0][0] + center[1] * rotation[1][0] + center[2] * rotation[2][0] + transforms.PositionX[i];
+		outBounds.CenterY[i] = center[0] * rotation[0][1] + center[1] * rotation[1][1] + center[2] * rotation[2][1] + transforms.PositionY[i];
+		outBounds.CenterZ[i] = center[0] * rotation[0][2] + center[1] * rotation[1][2] + center[2] * rotation[2][2] + transforms.PositionZ[i];
+
+		// Each world axis collects the local extents through the absolute rotation
+		outBounds.ExtentX[i] = extent[0] * fabsf(rotation[0][0]) + extent[1] * fabsf(rotation[1][0]) + extent[2] * fabsf(rotation[2][0]);
+		outBounds.ExtentY[i] = extent[0] * fabsf(rotation[0][1]) + extent[1] * fabsf(rotation[1][1]) + extent[2] * fabsf(rotation[2][1]);
+		outBounds.ExtentZ[i] = extent[0] * fabsf(rotation[0][2]) + extent[1] * fabsf(rotation[1][2]) + extent[2] * fabsf(rotation[2][2]);
+	}
+}
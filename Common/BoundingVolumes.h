@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "MathTypes.h"
+#include "ObjectTransforms.h"
+
+// World space bounding spheres as a structure of arrays
+struct SphereBoundsArrays
+{
+	std::vector<float> CenterX;
+	std::vector<float> CenterY;
+	std::vector<float> CenterZ;
+	std::vector<float> Radius;
+
+	void Resize(uint32_t count);
+	uint32_t GetCount() const { return (uint32_t)CenterX.size(); }
+};
+
+// World space axis-aligned boxes as center and half extent, as a structure of arrays
+struct BoxBoundsArrays
+{
+	std::vector<float> CenterX;
+	std::vector<float> CenterY;
+	std::vector<float> CenterZ;
+	std::vector<float> ExtentX;
+	std::vector<float> ExtentY;
+	std::vector<float> ExtentZ;
+
+	void Resize(uint32_t count);
+	uint32_t GetCount() const { return (uint32_t)CenterX.size(); }
+};
+
+// Bounds of a mesh with the given local sphere or box placed by every transform.
+// The sphere grows with the largest scale, the box is the world AABB of the rotated local box.
+void ComputeSphereBounds(const TransformArrays& transforms, const Float3& localCenter, float localRadius, SphereBoundsArrays& outBounds);
+void ComputeBoxBounds(const TransformArrays& transforms, const Float3& localCenter, const Float3& localExtent, BoxBoundsArrays& outBounds);
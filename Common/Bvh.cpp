@@ -0,0 +1,694 @@
+#include "Bvh.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <immintrin.h>
+
+namespace
+{
+	// SAH weights of visiting a node and of testing one object
+	constexpr float TRAVERSAL_COST = 1.0f;
+	constexpr float INTERSECTION_COST = 1.0f;
+
+	// Below this depth every split halves its range, which bounds the depth of the tree
+	constexpr uint32_t MEDIAN_SPLIT_DEPTH = BVH_MAX_DEPTH / 2;
+
+	// Children still to visit, at most BVH_WIDTH - 1 per level plus the children of the current node
+	constexpr uint32_t TRAVERSAL_STACK_SIZE = BVH_MAX_DEPTH * BVH_WIDTH;
+
+	float HalfSurfaceArea(const float minimum[3], const float maximum[3])
+	{
+		const float x = maximum[0] - minimum[0];
+		const float y = maximum[1] - minimum[1];
+		const float z = maximum[2] - minimum[2];
+		return x * y + y * z + z * x;
+	}
+
+	// Build bounds in the xyz lanes of SSE registers. The w lanes hold whatever follows Min and Max in BuildPrimitive
+	// and are never read back.
+	struct Bounds4
+	{
+		__m128 Min;
+		__m128 Max;
+	};
+
+	Bounds4 EmptyBounds4()
+	{
+		return Bounds4{ _mm_set1_ps(FLT_MAX), _mm_set1_ps(-FLT_MAX) };
+	}
+
+	float HalfSurfaceArea4(const Bounds4& bounds)
+	{
+		alignas(16) float extent[4];
+		_mm_store_ps(extent, _mm_sub_ps(bounds.Max, bounds.Min));
+		return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+	}
+
+	// Bits of the first count lanes
+	int32_t CountMask(uint32_t count)
+	{
+		return (1 << (count < BVH_WIDTH ? count : BVH_WIDTH)) - 1;
+	}
+
+	int32_t CountMask4(const uint32_t counts[BVH_WIDTH])
+	{
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)counts), _mm_setzero_si128())));
+	}
+
+	struct FrustumPlanes4
+	{
+		__m128 Normal[FRUSTUM_PLANE_COUNT][3];
+		__m128 AbsoluteNormal[FRUSTUM_PLANE_COUNT][3];
+		__m128 Distance[FRUSTUM_PLANE_COUNT];
+	};
+
+	// Same test as CullBoxes on four center/extent boxes: outIntersect has the boxes not entirely behind any plane,
+	// outInside the boxes entirely in front of all of them
+	void TestFrustum4(const FrustumPlanes4& planes, __m128 centerX, __m128 centerY, __m128 centerZ, __m128 extentX, __m128 extentY, __m128 extentZ,
+		int32_t& outIntersect, int32_t& outInside)
+	{
+		__m128 intersect = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 inside = intersect;
+		for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+		{
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(centerX, planes.Normal[planeIndex][0]), _mm_mul_ps(centerY, planes.Normal[planeIndex][1])),
+				_mm_mul_ps(centerZ, planes.Normal[planeIndex][2])), planes.Distance[planeIndex]);
+			const __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, planes.AbsoluteNormal[planeIndex][0]), _mm_mul_ps(extentY, planes.AbsoluteNormal[planeIndex][1])),
+				_mm_mul_ps(extentZ, planes.AbsoluteNormal[planeIndex][2]));
+			intersect = _mm_and_ps(intersect, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_sub_ps(distance, radius), _mm_setzero_ps()));
+		}
+		outIntersect = _mm_movemask_ps(intersect);
+		outInside = _mm_movemask_ps(inside);
+	}
+
+	// Slab test of four boxes. Returns the hit lanes and their entry distances.
+	int32_t TestRay4(const __m128 origin[3], const __m128 inverseDirection[3], __m128 maxDistance, const __m128 minimum[3], const __m128 maximum[3],
+		__m128& outDistance)
+	{
+		__m128 nearDistance = _mm_setzero_ps();
+		__m128 farDistance = maxDistance;
+		for (int32_t axis = 0; axis < 3; ++axis)
+		{
+			const __m128 t0 = _mm_mul_ps(_mm_sub_ps(minimum[axis], origin[axis]), inverseDirection[axis]);
+			const __m128 t1 = _mm_mul_ps(_mm_sub_ps(maximum[axis], origin[axis]), inverseDirection[axis]);
+			nearDistance = _mm_max_ps(nearDistance, _mm_min_ps(t0, t1));
+			farDistance = _mm_min_ps(farDistance, _mm_max_ps(t0, t1));
+		}
+		outDistance = nearDistance;
+		return _mm_movemask_ps(_mm_cmple_ps(nearDistance, farDistance));
+	}
+
+	// Appends the object indices of the lanes set in mask to output and returns how many
+	uint32_t AppendLanes(const uint32_t* objectIndices, uint32_t laneCount, int32_t mask, uint32_t* output)
+	{
+		uint32_t count = 0;
+		for (uint32_t lane = 0; lane < laneCount; ++lane)
+		{
+			output[count] = objectIndices[lane];
+			count += (mask >> lane) & 1;
+		}
+		return count;
+	}
+}
+
+void Bvh::Build(const BoxBoundsArrays& bounds)
+{
+	const uint32_t count = bounds.GetCount();
+	Nodes.clear();
+	ObjectIndices.resize(count);
+
+	if (count == 0)
+	{
+		ObjectBounds.Resize(0);
+		Cost = 0.0f;
+		BuildCost = 0.0f;
+		return;
+	}
+
+	// Splits move the primitives around, which keeps every range contiguous in memory
+	BuildPrimitives.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		BuildPrimitive& primitive = BuildPrimitives[i];
+		primitive.Min[0] = bounds.CenterX[i] - bounds.ExtentX[i];
+		primitive.Min[1] = bounds.CenterY[i] - bounds.ExtentY[i];
+		primitive.Min[2] = bounds.CenterZ[i] - bounds.ExtentZ[i];
+		primitive.Index = i;
+		primitive.Max[0] = bounds.CenterX[i] + bounds.ExtentX[i];
+		primitive.Max[1] = bounds.CenterY[i] + bounds.ExtentY[i];
+		primitive.Max[2] = bounds.CenterZ[i] + bounds.ExtentZ[i];
+		primitive.Padding = 0.0f;
+	}
+
+	Nodes.reserve(count / 2 + 1);
+	BuildNode(0, count, ComputeRangeArea(0, count), 0);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		ObjectIndices[i] = BuildPrimitives[i].Index;
+	}
+
+	UpdateBounds(bounds);
+	BuildCost = Cost;
+}
+
+void Bvh::Refit(const BoxBoundsArrays& bounds)
+{
+	if (Nodes.empty() || bounds.GetCount() != ObjectIndices.size())
+	{
+		Build(bounds);
+		return;
+	}
+
+	UpdateBounds(bounds);
+}
+
+// Starts from one child holding the whole range and keeps splitting the child with the largest surface area
+// until there are BVH_WIDTH children or all of them fit in a leaf
+uint32_t Bvh::BuildNode(uint32_t first, uint32_t count, float area, uint32_t depth)
+{
+	const uint32_t nodeIndex = (uint32_t)Nodes.size();
+	Nodes.emplace_back();
+
+	uint32_t childFirst[BVH_WIDTH]{ first };
+	uint32_t childCount[BVH_WIDTH]{ count };
+	float childArea[BVH_WIDTH]{ area };
+	uint32_t usedChildCount = 1;
+
+	while (usedChildCount < BVH_WIDTH)
+	{
+		int32_t largestChild = -1;
+		for (uint32_t child = 0; child < usedChildCount; ++child)
+		{
+			if (childCount[child] > BVH_MAX_LEAF_SIZE && (largestChild < 0 || childArea[child] > childArea[largestChild]))
+			{
+				largestChild = (int32_t)child;
+			}
+		}
+		if (largestChild < 0)
+		{
+			break;
+		}
+
+		const uint32_t splitFirst = childFirst[largestChild];
+		const uint32_t splitCount = childCount[largestChild];
+		const uint32_t leftCount = depth < MEDIAN_SPLIT_DEPTH
+			? SplitRangeSah(splitFirst, splitCount, childArea[largestChild], childArea[usedChildCount])
+			: SplitRangeMedian(splitFirst, splitCount, childArea[largestChild], childArea[usedChildCount]);
+
+		childCount[largestChild] = leftCount;
+		childFirst[usedChildCount] = splitFirst + leftCount;
+		childCount[usedChildCount] = splitCount - leftCount;
+		++usedChildCount;
+	}
+
+	// Bounds are filled in by UpdateBounds
+	for (uint32_t child = 0; child < BVH_WIDTH; ++child)
+	{
+		int32_t childNode = BVH_LEAF;
+		if (child < usedChildCount && childCount[child] > BVH_MAX_LEAF_SIZE)
+		{
+			childNode = (int32_t)BuildNode(childFirst[child], childCount[child], childArea[child], depth + 1);
+		}
+
+		BvhNode& node = Nodes[nodeIndex];
+		node.Child[child] = childNode;
+		node.First[child] = child < usedChildCount ? childFirst[child] : 0;
+		node.Count[child] = child < usedChildCount ? childCount[child] : 0;
+	}
+
+	return nodeIndex;
+}
+
+// Bins the centroids along all three axes in one pass and takes the bin boundary with the lowest SAH cost.
+// Returns the size of the left part, which is moved to the front of the range, and the areas of both parts.
+uint32_t Bvh::SplitRangeSah(uint32_t first, uint32_t count, float& outLeftArea, float& outRightArea)
+{
+	BuildPrimitive* primitives = BuildPrimitives.data() + first;
+
+	// Centroids are kept doubled (Min + Max), which does not change the split
+	Bounds4 centroidBounds = EmptyBounds4();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const __m128 centroid = _mm_add_ps(_mm_load_ps(primitives[i].Min), _mm_load_ps(primitives[i].Max));
+		centroidBounds.Min = _mm_min_ps(centroidBounds.Min, centroid);
+		centroidBounds.Max = _mm_max_ps(centroidBounds.Max, centroid);
+	}
+
+	const __m128 centroidExtent = _mm_sub_ps(centroidBounds.Max, centroidBounds.Min);
+	const __m128 binScale = _mm_and_ps(_mm_div_ps(_mm_set1_ps(BVH_BIN_COUNT * 0.99999f), centroidExtent), _mm_cmpgt_ps(centroidExtent, _mm_setzero_ps()));
+	const __m128 lastBin = _mm_set1_ps(BVH_BIN_COUNT - 1.0f);
+
+	Bounds4 binBounds[3][BVH_BIN_COUNT];
+	uint32_t binCounts[3][BVH_BIN_COUNT]{};
+	for (int32_t axis = 0; axis < 3; ++axis)
+	{
+		for (Bounds4& bounds : binBounds[axis])
+		{
+			bounds = EmptyBounds4();
+		}
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const __m128 minimum = _mm_load_ps(primitives[i].Min);
+		const __m128 maximum = _mm_load_ps(primitives[i].Max);
+		const __m128i binIndex = _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_add_ps(minimum, maximum), centroidBounds.Min), binScale), lastBin));
+
+		alignas(16) int32_t binIndices[4];
+		_mm_store_si128((__m128i*)binIndices, binIndex);
+		for (int32_t axis = 0; axis < 3; ++axis)
+		{
+			Bounds4& bounds = binBounds[axis][binIndices[axis]];
+			bounds.Min = _mm_min_ps(bounds.Min, minimum);
+			bounds.Max = _mm_max_ps(bounds.Max, maximum);
+			++binCounts[axis][binIndices[axis]];
+		}
+	}
+
+	alignas(16) float binScales[4];
+	alignas(16) float centroidMin[4];
+	_mm_store_ps(binScales, binScale);
+	_mm_store_ps(centroidMin, centroidBounds.Min);
+
+	float bestCost = FLT_MAX;
+	int32_t bestAxis = -1;
+	uint32_t bestSplit = 0;
+	for (int32_t axis = 0; axis < 3; ++axis)
+	{
+		if (binScales[axis] == 0.0f)
+		{
+			continue;
+		}
+
+		// Area of the right side of every boundary, then sweep from the left
+		float rightAreas[BVH_BIN_COUNT];
+		uint32_t rightCounts[BVH_BIN_COUNT];
+		Bounds4 sweepBounds = EmptyBounds4();
+		uint32_t sweepCount = 0;
+		for (uint32_t binIndex = BVH_BIN_COUNT - 1; binIndex > 0; --binIndex)
+		{
+			sweepBounds.Min = _mm_min_ps(sweepBounds.Min, binBounds[axis][binIndex].Min);
+			sweepBounds.Max = _mm_max_ps(sweepBounds.Max, binBounds[axis][binIndex].Max);
+			sweepCount += binCounts[axis][binIndex];
+			rightAreas[binIndex] = HalfSurfaceArea4(sweepBounds);
+			rightCounts[binIndex] = sweepCount;
+		}
+
+		sweepBounds = EmptyBounds4();
+		sweepCount = 0;
+		for (uint32_t binIndex = 0; binIndex + 1 < BVH_BIN_COUNT; ++binIndex)
+		{
+			sweepBounds.Min = _mm_min_ps(sweepBounds.Min, binBounds[axis][binIndex].Min);
+			sweepBounds.Max = _mm_max_ps(sweepBounds.Max, binBounds[axis][binIndex].Max);
+			sweepCount += binCounts[axis][binIndex];
+			if (sweepCount == 0 || sweepCount == count)
+			{
+				continue;
+			}
+
+			const float leftArea = HalfSurfaceArea4(sweepBounds);
+			const float cost = leftArea * sweepCount + rightAreas[binIndex + 1] * rightCounts[binIndex + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = binIndex;
+				outLeftArea = leftArea;
+				outRightArea = rightAreas[binIndex + 1];
+			}
+		}
+	}
+
+	// All centroids in one place
+	if (bestAxis < 0)
+	{
+		outLeftArea = ComputeRangeArea(first, count / 2);
+		outRightArea = ComputeRangeArea(first + count / 2, count - count / 2);
+		return count / 2;
+	}
+
+	const float axisMin = centroidMin[bestAxis];
+	const float axisScale = binScales[bestAxis];
+	const BuildPrimitive* middle = std::partition(primitives, primitives + count, [&](const BuildPrimitive& primitive)
+		{
+			const float centroid = primitive.Min[bestAxis] + primitive.Max[bestAxis];
+			return std::min((uint32_t)((centroid - axisMin) * axisScale), BVH_BIN_COUNT - 1) <= bestSplit;
+		});
+	return (uint32_t)(middle - primitives);
+}
+
+// Object median along the longest centroid axis
+uint32_t Bvh::SplitRangeMedian(uint32_t first, uint32_t count, float& outLeftArea, float& outRightArea)
+{
+	BuildPrimitive* primitives = BuildPrimitives.data() + first;
+
+	Bounds4 centroidBounds = EmptyBounds4();
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const __m128 centroid = _mm_add_ps(_mm_load_ps(primitives[i].Min), _mm_load_ps(primitives[i].Max));
+		centroidBounds.Min = _mm_min_ps(centroidBounds.Min, centroid);
+		centroidBounds.Max = _mm_max_ps(centroidBounds.Max, centroid);
+	}
+
+	alignas(16) float centroidExtent[4];
+	_mm_store_ps(centroidExtent, _mm_sub_ps(centroidBounds.Max, centroidBounds.Min));
+	int32_t axis = 0;
+	for (int32_t otherAxis = 1; otherAxis < 3; ++otherAxis)
+	{
+		if (centroidExtent[otherAxis] > centroidExtent[axis])
+		{
+			axis = otherAxis;
+		}
+	}
+
+	std::nth_element(primitives, primitives + count / 2, primitives + count, [axis](const BuildPrimitive& a, const BuildPrimitive& b)
+		{
+			return a.Min[axis] + a.Max[axis] < b.Min[axis] + b.Max[axis];
+		});
+
+	outLeftArea = ComputeRangeArea(first, count / 2);
+	outRightArea = ComputeRangeArea(first + count / 2, count - count / 2);
+	return count / 2;
+}
+
+float Bvh::ComputeRangeArea(uint32_t first, uint32_t count) const
+{
+	Bounds4 bounds = EmptyBounds4();
+	for (uint32_t i = first; i < first + count; ++i)
+	{
+		bounds.Min = _mm_min_ps(bounds.Min, _mm_load_ps(BuildPrimitives[i].Min));
+		bounds.Max = _mm_max_ps(bounds.Max, _mm_load_ps(BuildPrimitives[i].Max));
+	}
+	return HalfSurfaceArea4(bounds);
+}
+
+// Children always come after their parent, so walking the nodes backwards visits every child first
+void Bvh::UpdateBounds(const BoxBoundsArrays& bounds)
+{
+	const uint32_t objectCount = (uint32_t)ObjectIndices.size();
+	ObjectBounds.Resize(objectCount + BVH_WIDTH - 1);
+	for (uint32_t i = 0; i < objectCount; ++i)
+	{
+		const uint32_t index = ObjectIndices[i];
+		ObjectBounds.CenterX[i] = bounds.CenterX[index];
+		ObjectBounds.CenterY[i] = bounds.CenterY[index];
+		ObjectBounds.CenterZ[i] = bounds.CenterZ[index];
+		ObjectBounds.ExtentX[i] = bounds.ExtentX[index];
+		ObjectBounds.ExtentY[i] = bounds.ExtentY[index];
+		ObjectBounds.ExtentZ[i] = bounds.ExtentZ[index];
+	}
+
+	float cost = 0.0f;
+	for (uint32_t nodeIndex = (uint32_t)Nodes.size(); nodeIndex-- > 0;)
+	{
+		BvhNode& node = Nodes[nodeIndex];
+		for (uint32_t child = 0; child < BVH_WIDTH; ++child)
+		{
+			float minimum[3]{ FLT_MAX, FLT_MAX, FLT_MAX };
+			float maximum[3]{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			if (node.Child[child] != BVH_LEAF)
+			{
+				const BvhNode& childNode = Nodes[node.Child[child]];
+				for (uint32_t grandchild = 0; grandchild < BVH_WIDTH; ++grandchild)
+				{
+					minimum[0] = fminf(minimum[0], childNode.MinX[grandchild]);
+					minimum[1] = fminf(minimum[1], childNode.MinY[grandchild]);
+					minimum[2] = fminf(minimum[2], childNode.MinZ[grandchild]);
+					maximum[0] = fmaxf(maximum[0], childNode.MaxX[grandchild]);
+					maximum[1] = fmaxf(maximum[1], childNode.MaxY[grandchild]);
+					maximum[2] = fmaxf(maximum[2], childNode.MaxZ[grandchild]);
+				}
+				cost += HalfSurfaceArea(minimum, maximum) * TRAVERSAL_COST;
+			}
+			else if (node.Count[child])
+			{
+				for (uint32_t i = node.First[child]; i < node.First[child] + node.Count[child]; ++i)
+				{
+					minimum[0] = fminf(minimum[0], ObjectBounds.CenterX[i] - ObjectBounds.ExtentX[i]);
+					minimum[1] = fminf(minimum[1], ObjectBounds.CenterY[i] - ObjectBounds.ExtentY[i]);
+					minimum[2] = fminf(minimum[2], ObjectBounds.CenterZ[i] - ObjectBounds.ExtentZ[i]);
+					maximum[0] = fmaxf(maximum[0], ObjectBounds.CenterX[i] + ObjectBounds.ExtentX[i]);
+					maximum[1] = fmaxf(maximum[1], ObjectBounds.CenterY[i] + ObjectBounds.ExtentY[i]);
+					maximum[2] = fmaxf(maximum[2], ObjectBounds.CenterZ[i] + ObjectBounds.ExtentZ[i]);
+				}
+				cost += HalfSurfaceArea(minimum, maximum) * INTERSECTION_COST * node.Count[child];
+			}
+
+			// Unused slots keep empty bounds that no query can hit
+			node.MinX[child] = minimum[0];
+			node.MinY[child] = minimum[1];
+			node.MinZ[child] = minimum[2];
+			node.MaxX[child] = maximum[0];
+			node.MaxY[child] = maximum[1];
+			node.MaxZ[child] = maximum[2];
+		}
+	}
+
+	// Relative to the bounds of the whole scene
+	const BvhNode& root = Nodes[0];
+	const float rootMin[3]{ *std::min_element(root.MinX, root.MinX + BVH_WIDTH), *std::min_element(root.MinY, root.MinY + BVH_WIDTH), *std::min_element(root.MinZ, root.MinZ + BVH_WIDTH) };
+	const float rootMax[3]{ *std::max_element(root.MaxX, root.MaxX + BVH_WIDTH), *std::max_element(root.MaxY, root.MaxY + BVH_WIDTH), *std::max_element(root.MaxZ, root.MaxZ + BVH_WIDTH) };
+	const float rootArea = HalfSurfaceArea(rootMin, rootMax);
+	Cost = rootArea > 0.0f ? cost / rootArea : cost;
+}
+
+uint32_t Bvh::CullFrustum(const Frustum& frustum, uint32_t* outVisibleIndices) const
+{
+	if (Nodes.empty())
+	{
+		return 0;
+	}
+
+	FrustumPlanes4 planes;
+	for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+	{
+		const Float4& plane = frustum.Planes[planeIndex];
+		planes.Normal[planeIndex][0] = _mm_set1_ps(plane.x);
+		planes.Normal[planeIndex][1] = _mm_set1_ps(plane.y);
+		planes.Normal[planeIndex][2] = _mm_set1_ps(plane.z);
+		planes.AbsoluteNormal[planeIndex][0] = _mm_set1_ps(fabsf(plane.x));
+		planes.AbsoluteNormal[planeIndex][1] = _mm_set1_ps(fabsf(plane.y));
+		planes.AbsoluteNormal[planeIndex][2] = _mm_set1_ps(fabsf(plane.z));
+		planes.Distance[planeIndex] = _mm_set1_ps(plane.w);
+	}
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	uint32_t stack[TRAVERSAL_STACK_SIZE];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	uint32_t visibleCount = 0;
+	while (stackSize)
+	{
+		const BvhNode& node = Nodes[stack[--stackSize]];
+
+		const __m128 minX = _mm_load_ps(node.MinX);
+		const __m128 minY = _mm_load_ps(node.MinY);
+		const __m128 minZ = _mm_load_ps(node.MinZ);
+		const __m128 maxX = _mm_load_ps(node.MaxX);
+		const __m128 maxY = _mm_load_ps(node.MaxY);
+		const __m128 maxZ = _mm_load_ps(node.MaxZ);
+
+		int32_t intersect;
+		int32_t inside;
+		TestFrustum4(planes, _mm_mul_ps(_mm_add_ps(minX, maxX), half), _mm_mul_ps(_mm_add_ps(minY, maxY), half), _mm_mul_ps(_mm_add_ps(minZ, maxZ), half),
+			_mm_mul_ps(_mm_sub_ps(maxX, minX), half), _mm_mul_ps(_mm_sub_ps(maxY, minY), half), _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half), intersect, inside);
+		intersect &= CountMask4(node.Count);
+
+		for (uint32_t child = 0; child < BVH_WIDTH; ++child)
+		{
+			if (!(intersect & (1 << child)))
+			{
+				continue;
+			}
+
+			if (inside & (1 << child))
+			{
+				// The whole subtree is visible
+				memcpy(outVisibleIndices + visibleCount, &ObjectIndices[node.First[child]], node.Count[child] * sizeof(uint32_t));
+				visibleCount += node.Count[child];
+			}
+			else if (node.Child[child] != BVH_LEAF)
+			{
+				stack[stackSize++] = (uint32_t)node.Child[child];
+			}
+			else
+			{
+				const uint32_t first = node.First[child];
+				int32_t objectIntersect;
+				int32_t objectInside;
+				TestFrustum4(planes, _mm_loadu_ps(&ObjectBounds.CenterX[first]), _mm_loadu_ps(&ObjectBounds.CenterY[first]), _mm_loadu_ps(&ObjectBounds.CenterZ[first]),
+					_mm_loadu_ps(&ObjectBounds.ExtentX[first]), _mm_loadu_ps(&ObjectBounds.ExtentY[first]), _mm_loadu_ps(&ObjectBounds.ExtentZ[first]),
+					objectIntersect, objectInside);
+				visibleCount += AppendLanes(&ObjectIndices[first], node.Count[child], objectIntersect, outVisibleIndices + visibleCount);
+			}
+		}
+	}
+
+	return visibleCount;
+}
+
+bool Bvh::RayCast(const Float3& origin, const Float3& direction, float maxDistance, BvhRayHit& outHit) const
+{
+	if (Nodes.empty())
+	{
+		return false;
+	}
+
+	const __m128 rayOrigin[3]{ _mm_set1_ps(origin.x), _mm_set1_ps(origin.y), _mm_set1_ps(origin.z) };
+	const __m128 inverseDirection[3]{ _mm_set1_ps(1.0f / direction.x), _mm_set1_ps(1.0f / direction.y), _mm_set1_ps(1.0f / direction.z) };
+
+	float closestDistance = maxDistance;
+	uint32_t closestObject = 0;
+	bool bHit = false;
+
+	uint32_t stack[TRAVERSAL_STACK_SIZE];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		const BvhNode& node = Nodes[stack[--stackSize]];
+
+		const __m128 minimum[3]{ _mm_load_ps(node.MinX), _mm_load_ps(node.MinY), _mm_load_ps(node.MinZ) };
+		const __m128 maximum[3]{ _mm_load_ps(node.MaxX), _mm_load_ps(node.MaxY), _mm_load_ps(node.MaxZ) };
+		__m128 entryDistances;
+		const int32_t hits = TestRay4(rayOrigin, inverseDirection, _mm_set1_ps(closestDistance), minimum, maximum, entryDistances) & CountMask4(node.Count);
+		if (!hits)
+		{
+			continue;
+		}
+
+		float distances[BVH_WIDTH];
+		_mm_storeu_ps(distances, entryDistances);
+
+		// Leaves are tested right away, inner children are pushed furthest first so the nearest is visited next
+		uint32_t innerChildren[BVH_WIDTH];
+		uint32_t innerChildCount = 0;
+		for (uint32_t child = 0; child < BVH_WIDTH; ++child)
+		{
+			if (!(hits & (1 << child)))
+			{
+				continue;
+			}
+
+			if (node.Child[child] != BVH_LEAF)
+			{
+				innerChildren[innerChildCount++] = child;
+				continue;
+			}
+
+			const uint32_t first = node.First[child];
+			const __m128 center[3]{ _mm_loadu_ps(&ObjectBounds.CenterX[first]), _mm_loadu_ps(&ObjectBounds.CenterY[first]), _mm_loadu_ps(&ObjectBounds.CenterZ[first]) };
+			const __m128 extent[3]{ _mm_loadu_ps(&ObjectBounds.ExtentX[first]), _mm_loadu_ps(&ObjectBounds.ExtentY[first]), _mm_loadu_ps(&ObjectBounds.ExtentZ[first]) };
+			const __m128 objectMinimum[3]{ _mm_sub_ps(center[0], extent[0]), _mm_sub_ps(center[1], extent[1]), _mm_sub_ps(center[2], extent[2]) };
+			const __m128 objectMaximum[3]{ _mm_add_ps(center[0], extent[0]), _mm_add_ps(center[1], extent[1]), _mm_add_ps(center[2], extent[2]) };
+
+			__m128 objectDistances;
+			const int32_t objectHits = TestRay4(rayOrigin, inverseDirection, _mm_set1_ps(closestDistance), objectMinimum, objectMaximum, objectDistances) &
+				CountMask(node.Count[child]);
+
+			float objectDistance[BVH_WIDTH];
+			_mm_storeu_ps(objectDistance, objectDistances);
+			for (uint32_t lane = 0; lane < BVH_WIDTH; ++lane)
+			{
+				if ((objectHits & (1 << lane)) && objectDistance[lane] <= closestDistance)
+				{
+					closestDistance = objectDistance[lane];
+					closestObject = ObjectIndices[first + lane];
+					bHit = true;
+				}
+			}
+		}
+
+		for (uint32_t i = 1; i < innerChildCount; ++i)
+		{
+			for (uint32_t j = i; j > 0 && distances[innerChildren[j - 1]] < distances[innerChildren[j]]; --j)
+			{
+				std::swap(innerChildren[j - 1], innerChildren[j]);
+			}
+		}
+		for (uint32_t i = 0; i < innerChildCount; ++i)
+		{
+			stack[stackSize++] = (uint32_t)node.Child[innerChildren[i]];
+		}
+	}
+
+	if (bHit)
+	{
+		outHit.ObjectIndex = closestObject;
+		outHit.Distance = closestDistance;
+	}
+	return bHit;
+}
+
+uint32_t Bvh::QueryBox(const Float3& minimum, const Float3& maximum, uint32_t* outIndices) const
+{
+	if (Nodes.empty())
+	{
+		return 0;
+	}
+
+	const __m128 queryMin[3]{ _mm_set1_ps(minimum.x), _mm_set1_ps(minimum.y), _mm_set1_ps(minimum.z) };
+	const __m128 queryMax[3]{ _mm_set1_ps(maximum.x), _mm_set1_ps(maximum.y), _mm_set1_ps(maximum.z) };
+
+	uint32_t stack[TRAVERSAL_STACK_SIZE];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	uint32_t resultCount = 0;
+	while (stackSize)
+	{
+		const BvhNode& node = Nodes[stack[--stackSize]];
+
+		const __m128 childMin[3]{ _mm_load_ps(node.MinX), _mm_load_ps(node.MinY), _mm_load_ps(node.MinZ) };
+		const __m128 childMax[3]{ _mm_load_ps(node.MaxX), _mm_load_ps(node.MaxY), _mm_load_ps(node.MaxZ) };
+		__m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 contained = overlap;
+		for (int32_t axis = 0; axis < 3; ++axis)
+		{
+			overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(childMin[axis], queryMax[axis]), _mm_cmpge_ps(childMax[axis], queryMin[axis])));
+			contained = _mm_and_ps(contained, _mm_and_ps(_mm_cmpge_ps(childMin[axis], queryMin[axis]), _mm_cmple_ps(childMax[axis], queryMax[axis])));
+		}
+		const int32_t overlapMask = _mm_movemask_ps(overlap) & CountMask4(node.Count);
+		const int32_t containedMask = _mm_movemask_ps(contained);
+
+		for (uint32_t child = 0; child < BVH_WIDTH; ++child)
+		{
+			if (!(overlapMask & (1 << child)))
+			{
+				continue;
+			}
+
+			if (containedMask & (1 << child))
+			{
+				memcpy(outIndices + resultCount, &ObjectIndices[node.First[child]], node.Count[child] * sizeof(uint32_t));
+				resultCount += node.Count[child];
+			}
+			else if (node.Child[child] != BVH_LEAF)
+			{
+				stack[stackSize++] = (uint32_t)node.Child[child];
+			}
+			else
+			{
+				const uint32_t first = node.First[child];
+				const __m128 center[3]{ _mm_loadu_ps(&ObjectBounds.CenterX[first]), _mm_loadu_ps(&ObjectBounds.CenterY[first]), _mm_loadu_ps(&ObjectBounds.CenterZ[first]) };
+				const __m128 extent[3]{ _mm_loadu_ps(&ObjectBounds.ExtentX[first]), _mm_loadu_ps(&ObjectBounds.ExtentY[first]), _mm_loadu_ps(&ObjectBounds.ExtentZ[first]) };
+				__m128 objectOverlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (int32_t axis = 0; axis < 3; ++axis)
+				{
+					objectOverlap = _mm_and_ps(objectOverlap, _mm_and_ps(_mm_cmple_ps(_mm_sub_ps(center[axis], extent[axis]), queryMax[axis]),
+						_mm_cmpge_ps(_mm_add_ps(center[axis], extent[axis]), queryMin[axis])));
+				}
+				resultCount += AppendLanes(&ObjectIndices[first], node.Count[child], _mm_movemask_ps(objectOverlap), outIndices + resultCount);
+			}
+		}
+	}
+
+	return resultCount;
+}
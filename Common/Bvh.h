@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "BoundingVolumes.h"
+#include "FrustumCulling.h"
+#include "MathTypes.h"
+
+constexpr uint32_t BVH_WIDTH = 4;
+constexpr uint32_t BVH_MAX_LEAF_SIZE = 4;
+constexpr uint32_t BVH_BIN_COUNT = 16;
+constexpr uint32_t BVH_MAX_DEPTH = 64;
+constexpr int32_t BVH_LEAF = -1;
+
+// Node with up to four children whose bounds are stored as a structure of arrays, so that one SSE test
+// checks all of them. A child is an inner node (Child is its node index) or a leaf of at most BVH_MAX_LEAF_SIZE objects.
+// The objects below a child are ObjectIndices[First, First + Count), which lets a child that is entirely
+// inside a query return its whole subtree at once. Count 0 marks an unused slot.
+struct alignas(16) BvhNode
+{
+	float MinX[BVH_WIDTH];
+	float MinY[BVH_WIDTH];
+	float MinZ[BVH_WIDTH];
+	float MaxX[BVH_WIDTH];
+	float MaxY[BVH_WIDTH];
+	float MaxZ[BVH_WIDTH];
+	int32_t Child[BVH_WIDTH];
+	uint32_t First[BVH_WIDTH];
+	uint32_t Count[BVH_WIDTH];
+};
+
+struct BvhRayHit
+{
+	uint32_t ObjectIndex;
+	float Distance;
+};
+
+// Object-level bounding volume hierarchy over world AABBs.
+// Build splits with a binned surface area heuristic and flattens the tree depth first, so every child node comes after
+// its parent. Refit updates the bounds bottom-up after objects moved without changing the tree. The SAH cost rises
+// as the tree gets worse, so rebuild once GetCostRatio() exceeds a threshold.
+class Bvh
+{
+public:
+	void Build(const BoxBoundsArrays& bounds);
+	void Refit(const BoxBoundsArrays& bounds);
+
+	bool IsBuilt() const { return !Nodes.empty(); }
+	uint32_t GetObjectCount() const { return (uint32_t)ObjectIndices.size(); }
+	uint32_t GetNodeCount() const { return (uint32_t)Nodes.size(); }
+
+	// SAH cost of the tree after the last Refit, relative to right after the last Build
+	float GetCostRatio() const { return BuildCost > 0.0f ? Cost / BuildCost : 1.0f; }
+
+	// Indices of the objects that intersect the frustum, the same set as CullBoxes but in tree order.
+	// outVisibleIndices needs room for every object.
+	uint32_t CullFrustum(const Frustum& frustum, uint32_t* outVisibleIndices) const;
+
+	// Closest object whose bounds the ray from origin along direction hits within maxDistance.
+	// Distances are in units of the length of direction.
+	bool RayCast(const Float3& origin, const Float3& direction, float maxDistance, BvhRayHit& outHit) const;
+
+	// Indices of the objects whose bounds overlap the box [minimum, maximum]. outIndices needs room for every object.
+	uint32_t QueryBox(const Float3& minimum, const Float3& maximum, uint32_t* outIndices) const;
+
+private:
+	// Bounds of one object while building, laid out so that Min and Max load as SSE vectors
+	struct alignas(16) BuildPrimitive
+	{
+		float Min[3];
+		uint32_t Index;
+		float Max[3];
+		float Padding;
+	};
+
+	uint32_t BuildNode(uint32_t first, uint32_t count, float area, uint32_t depth);
+	uint32_t SplitRangeSah(uint32_t first, uint32_t count, float& outLeftArea, float& outRightArea);
+	uint32_t SplitRangeMedian(uint32_t first, uint32_t count, float& outLeftArea, float& outRightArea);
+	float ComputeRangeArea(uint32_t first, uint32_t count) const;
+
+	// Copies the object bounds in tree order, recomputes every node from the leaves up and updates Cost
+	void UpdateBounds(const BoxBoundsArrays& bounds);
+
+	std::vector<BvhNode> Nodes;
+	std::vector<uint32_t> ObjectIndices;
+
+	// Bounds of ObjectIndices[i] at i, followed by BVH_WIDTH - 1 unused entries so that leaves load four at once
+	BoxBoundsArrays ObjectBounds;
+
+	// Only used while building, kept to avoid reallocating on every rebuild
+	std::vector<BuildPrimitive> BuildPrimitives;
+
+	float Cost = 0.0f;
+	float BuildCost = 0.0f;
+};
@@ -0,0 +1,97 @@
+#include "Camera.h"
+
+#include "Scene.h"
+
+void Camera::Update(float deltaTime, const InputState& input)
+{
+	if (input.Flags & INPUT_FLAGS_W)
+	{
+		MoveForward(deltaTime);
+	}
+	if (input.Flags & INPUT_FLAGS_S)
+	{
+		MoveForward(-deltaTime);
+	}
+	if (input.Flags & INPUT_FLAGS_D)
+	{
+		MoveRight(deltaTime);
+	}
+	if (input.Flags & INPUT_FLAGS_A)
+	{
+		MoveRight(-deltaTime);
+	}
+	if (input.Flags & INPUT_FLAGS_E)
+	{
+		MoveUp(deltaTime);
+	}
+	if (input.Flags & INPUT_FLAGS_Q)
+	{
+		MoveUp(-deltaTime);
+	}
+
+	if (input.Flags & INPUT_FLAGS_RBUTTON)
+	{
+		const float deltaX = (float)(input.CursorY - PrevCursorY);
+		const float deltaY = (float)(input.CursorX - PrevCursorX);
+		Rotate(deltaX, deltaY);
+	}
+	PrevCursorX = input.CursorX;
+	PrevCursorY = input.CursorY;
+
+	if (input.LeftTrigger)
+	{
+		MoveUp(-input.LeftTrigger * deltaTime);
+	}
+	if (input.RightTrigger)
+	{
+		MoveUp(input.RightTrigger * deltaTime);
+	}
+	if (input.LeftThumbX)
+	{
+		MoveRight(input.LeftThumbX * deltaTime);
+	}
+	if (input.LeftThumbY)
+	{
+		MoveForward(input.LeftThumbY * deltaTime);
+	}
+	if (input.RightThumbX || input.RightThumbY)
+	{
+		const float deltaX = -input.RightThumbY * deltaTime * CONTROLLER_THUMB_SENSITIVITY;
+		const float deltaY = input.RightThumbX * deltaTime * CONTROLLER_THUMB_SENSITIVITY;
+		Rotate(deltaX, deltaY);
+	}
+}
+
+void Camera::MoveForward(float value)
+{
+	Position += Forward * value * CAMERA_MOVEMENT_SPEED;
+}
+
+void Camera::MoveRight(float value)
+{
+	Position += Right * value * CAMERA_MOVEMENT_SPEED;
+}
+
+void Camera::MoveUp(float value)
+{
+	Position += Float3{ 0.0f, 1.0f, 0.0f } * value * CAMERA_MOVEMENT_SPEED;
+}
+
+void Camera::Rotate(float deltaX, float deltaY)
+{
+	const float pitchAngle = deltaX * CAMERA_ROTATION_SPEED;
+	const float yawAngle = deltaY * CAMERA_ROTATION_SPEED;
+
+	const Float4 pitchRotation = QuaternionRotationAxis(Right, pitchAngle);
+	const Float4 yawRotation = QuaternionRotationAxis(Float3{ 0.0f, 1.0f, 0.0f }, yawAngle);
+	const Float4 rotation = QuaternionMultiply(pitchRotation, yawRotation);
+
+	Right = Vector3Rotate(Right, yawRotation);
+	Up = Vector3Rotate(Up, rotation);
+	Forward = Vector3Rotate(Forward, rotation);
+}
+
+Float4x4 Camera::GetViewMatrix() const
+{
+	return MatrixLookAtLH(Position, Position + Forward, Up);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "MathTypes.h"
+
+struct InputState;
+
+constexpr float CAMERA_MOVEMENT_SPEED = 10.0f;
+constexpr float CAMERA_ROTATION_SPEED = 0.002f;
+constexpr float CONTROLLER_THUMB_SENSITIVITY = 1000.0f;
+
+// Free-fly camera of the samples (WASD/QE to move, right mouse button or right thumb stick to look around)
+struct Camera
+{
+	Float3 Right{ 1.0f, 0.0f, 0.0f };
+	Float3 Up{ 0.0f, 1.0f, 0.0f };
+	Float3 Forward{ 0.0f, 0.0f, 1.0f };
+	Float3 Position{ 0.0f, 1.0f, -5.0f };
+
+	int32_t PrevCursorX = 0;
+	int32_t PrevCursorY = 0;
+
+	void Update(float deltaTime, const InputState& input);
+
+	void MoveForward(float value);
+	void MoveRight(float value);
+	void MoveUp(float value);
+	void Rotate(float deltaX, float deltaY);
+
+	Float4x4 GetViewMatrix() const;
+};
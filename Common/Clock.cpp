@@ -0,0 +1,46 @@
+#include "Clock.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <chrono>
+#endif // _WIN32
+
+uint64_t Clock::GetTicks()
+{
+#ifdef _WIN32
+	LARGE_INTEGER currentTime;
+	QueryPerformanceCounter(&currentTime);
+	return (uint64_t)currentTime.QuadPart;
+#else
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif // _WIN32
+}
+
+uint64_t Clock::GetFrequency()
+{
+#ifdef _WIN32
+	static const uint64_t frequency = []
+	{
+		LARGE_INTEGER cpuTick;
+		QueryPerformanceFrequency(&cpuTick);
+		return (uint64_t)cpuTick.QuadPart;
+	}();
+	return frequency;
+#else
+	return 1000000000ull;
+#endif // _WIN32
+}
+
+void Clock::Reset()
+{
+	PrevTicks = GetTicks();
+}
+
+float Clock::Tick()
+{
+	const uint64_t currentTicks = GetTicks();
+	const float deltaTime = (currentTicks - PrevTicks) / (float)GetFrequency();
+	PrevTicks = currentTicks;
+	return deltaTime;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+// Monotonic high resolution clock. QueryPerformanceCounter on Windows, steady_clock elsewhere.
+class Clock
+{
+public:
+	static uint64_t GetTicks();
+	static uint64_t GetFrequency();
+	static double TicksToMilliseconds(uint64_t ticks) { return ticks * 1000.0 / (double)GetFrequency(); }
+
+	void Reset();
+
+	// Seconds since the previous Tick (or Reset)
+	float Tick();
+
+private:
+	uint64_t PrevTicks = 0;
+};
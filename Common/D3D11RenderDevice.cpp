@@ -0,0 +1,995 @@
+#include "D3D11RenderDevice.h"
+
+#ifdef _WIN32
+
+#include <iterator>
+#include <string.h>
+#include <vector>
+
+#include <d3dcompiler.h>
+
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+namespace VendorId
+{
+	constexpr uint32_t INTEL = 0x8086;
+	constexpr uint32_t NVIDIA = 0x10DE;
+	constexpr uint32_t AMD = 0x1002;
+}
+
+namespace
+{
+	HRESULT CompileShader(const ShaderDesc& desc, ID3DBlob** outBlob)
+	{
+		if (!outBlob)
+		{
+			return E_FAIL;
+		}
+
+		uint32_t referenceCount = 0;
+
+		uint32_t shaderFlags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+		shaderFlags |= D3DCOMPILE_DEBUG;
+#endif // _DEBUG
+
+		ID3DBlob* shaderCode = nullptr;
+		ID3DBlob* errorMessage = nullptr;
+		HRESULT hr;
+		if (desc.SourceCode)
+		{
+			hr = D3DCompile(desc.SourceCode, strlen(desc.SourceCode), nullptr, nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, desc.EntryPoint, desc.ShaderModel, shaderFlags, 0, &shaderCode, &errorMessage);
+		}
+		else
+		{
+			const int32_t fileNameLength = MultiByteToWideChar(CP_UTF8, 0, desc.FileName, -1, nullptr, 0);
+			std::vector<WCHAR> fileName(fileNameLength);
+			MultiByteToWideChar(CP_UTF8, 0, desc.FileName, -1, fileName.data(), fileNameLength);
+
+			hr = D3DCompileFromFile(fileName.data(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE, desc.EntryPoint, desc.ShaderModel, shaderFlags, 0, &shaderCode, &errorMessage);
+		}
+
+		if (FAILED(hr))
+		{
+			if (errorMessage)
+			{
+				OutputDebugStringA((char*)errorMessage->GetBufferPointer());
+				referenceCount = errorMessage->Release();
+			}
+		}
+
+		if (shaderCode)
+		{
+			uint32_t disassembleFlags = D3D_DISASM_ENABLE_INSTRUCTION_NUMBERING;
+
+			ID3DBlob* disassembly;
+			if (SUCCEEDED(D3DDisassemble(shaderCode->GetBufferPointer(), shaderCode->GetBufferSize(), disassembleFlags, nullptr, &disassembly)))
+			{
+				OutputDebugStringA((char*)disassembly->GetBufferPointer());
+				referenceCount = disassembly->Release();
+			}
+		}
+
+		*outBlob = shaderCode;
+
+		return hr;
+	}
+
+	DXGI_FORMAT ConvertVertexFormat(VERTEX_FORMAT format)
+	{
+		switch (format)
+		{
+		case VERTEX_FORMAT_FLOAT2: return DXGI_FORMAT_R32G32_FLOAT;
+		case VERTEX_FORMAT_FLOAT3: return DXGI_FORMAT_R32G32B32_FLOAT;
+		case VERTEX_FORMAT_FLOAT4: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+		case VERTEX_FORMAT_SHORT2_SNORM: return DXGI_FORMAT_R16G16_SNORM;
+		case VERTEX_FORMAT_SHORT4_SNORM: return DXGI_FORMAT_R16G16B16A16_SNORM;
+		case VERTEX_FORMAT_UBYTE4_UNORM: return DXGI_FORMAT_R8G8B8A8_UNORM;
+		default: return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+
+	D3D11_BLEND ConvertBlend(BLEND blend)
+	{
+		switch (blend)
+		{
+		case BLEND_ONE: return D3D11_BLEND_ONE;
+		case BLEND_SRC_ALPHA: return D3D11_BLEND_SRC_ALPHA;
+		case BLEND_INV_SRC_ALPHA: return D3D11_BLEND_INV_SRC_ALPHA;
+		default: return D3D11_BLEND_ZERO;
+		}
+	}
+
+	D3D11_BLEND_OP ConvertBlendOp(BLEND_OP blendOp)
+	{
+		switch (blendOp)
+		{
+		case BLEND_OP_SUBTRACT: return D3D11_BLEND_OP_SUBTRACT;
+		case BLEND_OP_MIN: return D3D11_BLEND_OP_MIN;
+		case BLEND_OP_MAX: return D3D11_BLEND_OP_MAX;
+		default: return D3D11_BLEND_OP_ADD;
+		}
+	}
+}
+
+bool D3D11RenderDevice::Init(HWND hWnd, int32_t width, int32_t height)
+{
+	uint32_t referenceCount = 0;
+
+	// Create factory
+	if (FAILED(CreateDXGIFactory(IID_PPV_ARGS(&Factory))))
+	{
+		return false;
+	}
+
+	// Enum adapter
+	IDXGIAdapter* adapter;
+	for (uint32_t adapterIndex = 0; Factory->EnumAdapters(adapterIndex, &adapter) != DXGI_ERROR_NOT_FOUND; ++adapterIndex)
+	{
+		DXGI_ADAPTER_DESC adapterDesc;
+		adapter->GetDesc(&adapterDesc);
+
+		if (adapterDesc.VendorId == VendorId::NVIDIA ||
+			adapterDesc.VendorId == VendorId::AMD ||
+			adapterDesc.VendorId == VendorId::INTEL)
+		{
+			Adapter = adapter;
+			break;
+		}
+
+		referenceCount = adapter->Release();
+	}
+
+	// Create device and device context
+	uint32_t createDeviceFlags = 0;
+#ifdef _DEBUG
+	createDeviceFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif // _DEBUG
+
+	constexpr D3D_FEATURE_LEVEL featureLevels[]
+	{
+		D3D_FEATURE_LEVEL_11_1,
+		D3D_FEATURE_LEVEL_11_0
+	};
+	constexpr uint32_t numFeatureLevels = (uint32_t)std::size(featureLevels);
+
+	D3D_FEATURE_LEVEL maxSupportedFeatureLevel;
+	if (FAILED(D3D11CreateDevice(Adapter, D3D_DRIVER_TYPE_UNKNOWN, nullptr, createDeviceFlags, featureLevels, numFeatureLevels, D3D11_SDK_VERSION, &Device, &maxSupportedFeatureLevel, &ImmediateContext)))
+	{
+		return false;
+	}
+
+	// Constant buffer ranges and NO_OVERWRITE on dynamic constant buffers come with Direct3D 11.1
+	if (FAILED(ImmediateContext->QueryInterface(IID_PPV_ARGS(&ImmediateContext1))))
+	{
+		return false;
+	}
+
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	if (FAILED(Device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) ||
+		!options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer)
+	{
+		return false;
+	}
+
+	// Create swap chain
+	DXGI_SWAP_CHAIN_DESC swapChainDesc{};
+	swapChainDesc.BufferDesc.Width = width;
+	swapChainDesc.BufferDesc.Height = height;
+	swapChainDesc.BufferDesc.RefreshRate.Numerator = 60;
+	swapChainDesc.BufferDesc.RefreshRate.Denominator = 1;
+	swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	swapChainDesc.SampleDesc.Count = 1;
+	swapChainDesc.SampleDesc.Quality = 0;
+	swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	swapChainDesc.BufferCount = 1;
+	swapChainDesc.OutputWindow = hWnd;
+	swapChainDesc.Windowed = true;
+	swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+	swapChainDesc.Flags = 0;
+
+	if (FAILED(Factory->CreateSwapChain(Device, &swapChainDesc, &SwapChain)))
+	{
+		return false;
+	}
+
+	// Create render target view
+	ID3D11Texture2D* BackBuffer;
+	if (FAILED(SwapChain->GetBuffer(0, IID_PPV_ARGS(&BackBuffer))))
+	{
+		return false;
+	}
+
+	HRESULT hr = Device->CreateRenderTargetView(BackBuffer, nullptr, &RenderTargetView);
+	referenceCount = BackBuffer->Release();
+	if (FAILED(hr))
+	{
+		return false;
+	}
+
+	// Create depth stencil view
+	D3D11_TEXTURE2D_DESC depthStencilDesc;
+	depthStencilDesc.Width = width;
+	depthStencilDesc.Height = height;
+	depthStencilDesc.MipLevels = 1;
+	depthStencilDesc.ArraySize = 1;
+	depthStencilDesc.Format = DXGI_FORMAT_D24_UNORM_S8_UINT;
+	depthStencilDesc.SampleDesc.Count = 1;
+	depthStencilDesc.SampleDesc.Quality = 0;
+	depthStencilDesc.Usage = D3D11_USAGE_DEFAULT;
+	depthStencilDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+	depthStencilDesc.CPUAccessFlags = 0;
+	depthStencilDesc.MiscFlags = 0;
+
+	if (FAILED(Device->CreateTexture2D(&depthStencilDesc, nullptr, &DepthStencilBuffer)))
+	{
+		return false;
+	}
+
+	D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc{};
+	depthStencilViewDesc.Format = depthStencilDesc.Format;
+	depthStencilViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+	depthStencilViewDesc.Flags = 0;
+	depthStencilViewDesc.Texture2D.MipSlice = 0;
+
+	if (FAILED(Device->CreateDepthStencilView(DepthStencilBuffer, &depthStencilViewDesc, &DepthStencilView)))
+	{
+		return false;
+	}
+
+	ImmediateContext->OMSetRenderTargets(1, &RenderTargetView, DepthStencilView);
+
+	Viewport.TopLeftX = 0.0f;
+	Viewport.TopLeftY = 0.0f;
+	Viewport.Width = (float)width;
+	Viewport.Height = (float)height;
+	Viewport.MinDepth = 0.0f;
+	Viewport.MaxDepth = 1.0f;
+	ImmediateContext->RSSetViewports(1, &Viewport);
+
+	ImmediateContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	StateFilter.Reset();
+
+	return true;
+}
+
+void D3D11RenderDevice::Free()
+{
+	if (ImmediateContext) { ImmediateContext->ClearState(); }
+	CommandLists.clear();
+
+	uint32_t referenceCount = 0;
+	for (ID3D11BlendState* blendState : BlendStates) { referenceCount = blendState->Release(); }
+	for (ID3D11DepthStencilState* depthStencilState : DepthStencilStates) { referenceCount = depthStencilState->Release(); }
+	for (ID3D11RasterizerState* rasterizerState : RasterizerStates) { referenceCount = rasterizerState->Release(); }
+	for (ID3D11PixelShader* pixelShader : PixelShaders) { referenceCount = pixelShader->Release(); }
+	for (ID3D11InputLayout* inputLayout : InputLayouts) { referenceCount = inputLayout->Release(); }
+	for (VertexShader& vertexShader : VertexShaders) { referenceCount = vertexShader.Code->Release(); referenceCount = vertexShader.Shader->Release(); }
+	for (Buffer& buffer : Buffers) { referenceCount = buffer.Resource->Release(); }
+	BlendStates.clear();
+	DepthStencilStates.clear();
+	RasterizerStates.clear();
+	StateCache.Clear();
+	StateFilter.Reset();
+	PixelShaders.clear();
+	InputLayouts.clear();
+	VertexShaders.clear();
+	Buffers.clear();
+
+	if (DepthStencilView) { referenceCount = DepthStencilView->Release(); DepthStencilView = nullptr; }
+	if (DepthStencilBuffer) { referenceCount = DepthStencilBuffer->Release(); DepthStencilBuffer = nullptr; }
+	if (RenderTargetView) { referenceCount = RenderTargetView->Release(); RenderTargetView = nullptr; }
+	if (SwapChain) { referenceCount = SwapChain->Release(); SwapChain = nullptr; }
+	if (ImmediateContext1) { referenceCount = ImmediateContext1->Release(); ImmediateContext1 = nullptr; }
+	if (ImmediateContext) { referenceCount = ImmediateContext->Release(); ImmediateContext = nullptr; }
+	if (Device) { referenceCount = Device->Release(); Device = nullptr; }
+	if (Adapter) { referenceCount = Adapter->Release(); Adapter = nullptr; }
+	if (Factory) { referenceCount = Factory->Release(); Factory = nullptr; }
+}
+
+BufferHandle D3D11RenderDevice::CreateBuffer(const BufferDesc& desc, const void* initialData)
+{
+	D3D11_BUFFER_DESC bufferDesc{};
+	bufferDesc.ByteWidth = desc.ByteWidth;
+
+	switch (desc.Usage)
+	{
+	case BUFFER_USAGE_IMMUTABLE:
+		bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+		break;
+	case BUFFER_USAGE_DYNAMIC:
+		bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		break;
+	default:
+		bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		break;
+	}
+
+	switch (desc.Type)
+	{
+	case BUFFER_TYPE_VERTEX: bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER; break;
+	case BUFFER_TYPE_INDEX: bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER; break;
+	case BUFFER_TYPE_CONSTANT: bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER; break;
+	}
+
+	D3D11_SUBRESOURCE_DATA bufferData{};
+	bufferData.pSysMem = initialData;
+
+	ID3D11Buffer* buffer;
+	if (FAILED(Device->CreateBuffer(&bufferDesc, initialData ? &bufferData : nullptr, &buffer)))
+	{
+		return {};
+	}
+
+	Buffers.push_back({ buffer, desc.Type, desc.Usage });
+
+	return { (uint32_t)Buffers.size() };
+}
+
+VertexShaderHandle D3D11RenderDevice::CreateVertexShader(const ShaderDesc& desc)
+{
+	uint32_t referenceCount = 0;
+
+	ID3DBlob* vertexShaderBlob;
+	if (FAILED(CompileShader(desc, &vertexShaderBlob)))
+	{
+		return {};
+	}
+
+	ID3D11VertexShader* vertexShader;
+	if (FAILED(Device->CreateVertexShader(vertexShaderBlob->GetBufferPointer(), vertexShaderBlob->GetBufferSize(), nullptr, &vertexShader)))
+	{
+		referenceCount = vertexShaderBlob->Release();
+		return {};
+	}
+
+	// The bytecode is kept for CreateInputLayout
+	VertexShaders.push_back({ vertexShader, vertexShaderBlob });
+
+	return { (uint32_t)VertexShaders.size() };
+}
+
+PixelShaderHandle D3D11RenderDevice::CreatePixelShader(const ShaderDesc& desc)
+{
+	uint32_t referenceCount = 0;
+
+	ID3DBlob* pixelShaderBlob;
+	if (FAILED(CompileShader(desc, &pixelShaderBlob)))
+	{
+		return {};
+	}
+
+	ID3D11PixelShader* pixelShader;
+	HRESULT hr = Device->CreatePixelShader(pixelShaderBlob->GetBufferPointer(), pixelShaderBlob->GetBufferSize(), nullptr, &pixelShader);
+	referenceCount = pixelShaderBlob->Release();
+	if (FAILED(hr))
+	{
+		return {};
+	}
+
+	PixelShaders.push_back(pixelShader);
+
+	return { (uint32_t)PixelShaders.size() };
+}
+
+InputLayoutHandle D3D11RenderDevice::CreateInputLayout(const InputElementDesc* elements, uint32_t elementCount, VertexShaderHandle vertexShader)
+{
+	if (!vertexShader.IsValid())
+	{
+		return {};
+	}
+
+	std::vector<D3D11_INPUT_ELEMENT_DESC> inputElements(elementCount);
+	for (uint32_t i = 0; i < elementCount; ++i)
+	{
+		inputElements[i].SemanticName = elements[i].SemanticName;
+		inputElements[i].SemanticIndex = elements[i].SemanticIndex;
+		inputElements[i].Format = ConvertVertexFormat(elements[i].Format);
+		inputElements[i].InputSlot = elements[i].InputSlot;
+		inputElements[i].AlignedByteOffset = elements[i].AlignedByteOffset;
+		inputElements[i].InputSlotClass = elements[i].InputSlotClass == INPUT_CLASSIFICATION_PER_INSTANCE ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+		inputElements[i].InstanceDataStepRate = elements[i].InstanceDataStepRate;
+	}
+
+	ID3DBlob* vertexShaderBlob = VertexShaders[vertexShader.Id - 1].Code;
+
+	ID3D11InputLayout* inputLayout;
+	if (FAILED(Device->CreateInputLayout(inputElements.data(), elementCount, vertexShaderBlob->GetBufferPointer(), vertexShaderBlob->GetBufferSize(), &inputLayout)))
+	{
+		return {};
+	}
+
+	InputLayouts.push_back(inputLayout);
+
+	return { (uint32_t)InputLayouts.size() };
+}
+
+RasterizerStateHandle D3D11RenderDevice::CreateRasterizerState(const RasterizerDesc& desc)
+{
+	const uint64_t key = ComputeStateKey(desc);
+	if (const uint32_t id = StateCache.Find(key))
+	{
+		return { id };
+	}
+
+	D3D11_RASTERIZER_DESC rasterizerDesc;
+	rasterizerDesc.FillMode = desc.FillMode == FILL_MODE_WIREFRAME ? D3D11_FILL_WIREFRAME : D3D11_FILL_SOLID;
+	rasterizerDesc.CullMode = desc.CullMode == CULL_MODE_FRONT ? D3D11_CULL_FRONT : desc.CullMode == CULL_MODE_BACK ? D3D11_CULL_BACK : D3D11_CULL_NONE;
+	rasterizerDesc.FrontCounterClockwise = desc.bFrontCounterClockwise;
+	rasterizerDesc.DepthBias = D3D11_DEFAULT_DEPTH_BIAS;
+	rasterizerDesc.DepthBiasClamp = D3D11_DEFAULT_DEPTH_BIAS_CLAMP;
+	rasterizerDesc.SlopeScaledDepthBias = D3D11_DEFAULT_SLOPE_SCALED_DEPTH_BIAS;
+	rasterizerDesc.DepthClipEnable = desc.bDepthClipEnable;
+	rasterizerDesc.ScissorEnable = false;
+	rasterizerDesc.MultisampleEnable = false;
+	rasterizerDesc.AntialiasedLineEnable = false;
+
+	ID3D11RasterizerState* rasterizerState;
+	if (FAILED(Device->CreateRasterizerState(&rasterizerDesc, &rasterizerState)))
+	{
+		return {};
+	}
+
+	RasterizerStates.push_back(rasterizerState);
+	StateCache.Add(key, (uint32_t)RasterizerStates.size());
+
+	return { (uint32_t)RasterizerStates.size() };
+}
+
+DepthStencilStateHandle D3D11RenderDevice::CreateDepthStencilState(const DepthStencilDesc& desc)
+{
+	const uint64_t key = ComputeStateKey(desc);
+	if (const uint32_t id = StateCache.Find(key))
+	{
+		return { id };
+	}
+
+	// COMPARISON_FUNC follows D3D11_COMPARISON_FUNC, which starts at 1
+	D3D11_DEPTH_STENCIL_DESC depthStencilDesc{};
+	depthStencilDesc.DepthEnable = desc.bDepthEnable;
+	depthStencilDesc.DepthWriteMask = desc.bDepthWriteEnable ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
+	depthStencilDesc.DepthFunc = (D3D11_COMPARISON_FUNC)(desc.DepthFunc + D3D11_COMPARISON_NEVER);
+	depthStencilDesc.StencilEnable = false;
+
+	ID3D11DepthStencilState* depthStencilState;
+	if (FAILED(Device->CreateDepthStencilState(&depthStencilDesc, &depthStencilState)))
+	{
+		return {};
+	}
+
+	DepthStencilStates.push_back(depthStencilState);
+	StateCache.Add(key, (uint32_t)DepthStencilStates.size());
+
+	return { (uint32_t)DepthStencilStates.size() };
+}
+
+BlendStateHandle D3D11RenderDevice::CreateBlendState(const BlendDesc& desc)
+{
+	const uint64_t key = ComputeStateKey(desc);
+	if (const uint32_t id = StateCache.Find(key))
+	{
+		return { id };
+	}
+
+	D3D11_BLEND_DESC blendDesc{};
+	D3D11_RENDER_TARGET_BLEND_DESC& target = blendDesc.RenderTarget[0];
+	target.BlendEnable = desc.bBlendEnable;
+	target.SrcBlend = target.SrcBlendAlpha = ConvertBlend(desc.SrcBlend);
+	target.DestBlend = target.DestBlendAlpha = ConvertBlend(desc.DestBlend);
+	target.BlendOp = target.BlendOpAlpha = ConvertBlendOp(desc.BlendOp);
+	target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+	ID3D11BlendState* blendState;
+	if (FAILED(Device->CreateBlendState(&blendDesc, &blendState)))
+	{
+		return {};
+	}
+
+	BlendStates.push_back(blendState);
+	StateCache.Add(key, (uint32_t)BlendStates.size());
+
+	return { (uint32_t)BlendStates.size() };
+}
+
+CommandList* D3D11RenderDevice::CreateCommandList()
+{
+	ID3D11DeviceContext* deferredContext;
+	if (FAILED(Device->CreateDeferredContext(0, &deferredContext)))
+	{
+		return nullptr;
+	}
+
+	ID3D11DeviceContext1* deferredContext1;
+	if (FAILED(deferredContext->QueryInterface(IID_PPV_ARGS(&deferredContext1))))
+	{
+		deferredContext->Release();
+		return nullptr;
+	}
+
+	CommandLists.push_back(std::make_unique<D3D11CommandList>(this, deferredContext, deferredContext1));
+
+	return CommandLists.back().get();
+}
+
+void D3D11RenderDevice::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size)
+{
+	if (!buffer.IsValid())
+	{
+		return;
+	}
+
+	const Buffer& target = Buffers[buffer.Id - 1];
+	if (target.Usage == BUFFER_USAGE_DYNAMIC)
+	{
+		D3D11_MAPPED_SUBRESOURCE mappedResource;
+		if (FAILED(ImmediateContext->Map(target.Resource, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+		{
+			return;
+		}
+		memcpy(mappedResource.pData, data, size);
+		ImmediateContext->Unmap(target.Resource, 0);
+	}
+	else
+	{
+		// Only the first size bytes are written, constant buffers can not take a box
+		D3D11_BOX box{ 0, 0, 0, size, 1, 1 };
+		ImmediateContext->UpdateSubresource(target.Resource, 0, target.Type == BUFFER_TYPE_CONSTANT ? nullptr : &box, data, 0, 0);
+	}
+
+	++CurrentStats.BufferUpdateCount;
+	CurrentStats.UploadBytes += size;
+	if (target.Type == BUFFER_TYPE_CONSTANT)
+	{
+		CurrentStats.ConstantUploadBytes += size;
+	}
+}
+
+void D3D11RenderDevice::WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size, MAP_TYPE mapType)
+{
+	if (!buffer.IsValid())
+	{
+		return;
+	}
+
+	const Buffer& target = Buffers[buffer.Id - 1];
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	if (FAILED(ImmediateContext->Map(target.Resource, 0, mapType == MAP_TYPE_WRITE_DISCARD ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource)))
+	{
+		return;
+	}
+	memcpy((uint8_t*)mappedResource.pData + offset, data, size);
+	ImmediateContext->Unmap(target.Resource, 0);
+
+	++CurrentStats.BufferUpdateCount;
+	CurrentStats.UploadBytes += size;
+	if (target.Type == BUFFER_TYPE_CONSTANT)
+	{
+		CurrentStats.ConstantUploadBytes += size;
+	}
+}
+
+void D3D11RenderDevice::SetInputLayout(InputLayoutHandle inputLayout)
+{
+	if (!StateFilter.SetInputLayout(inputLayout))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ImmediateContext->IASetInputLayout(inputLayout.IsValid() ? InputLayouts[inputLayout.Id - 1] : nullptr);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+	if (!StateFilter.SetVertexBuffer(slot, buffer, stride, offset))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* vertexBuffer = GetBuffer(buffer);
+	ImmediateContext->IASetVertexBuffers(slot, 1, &vertexBuffer, &stride, &offset);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset)
+{
+	if (!StateFilter.SetIndexBuffer(buffer, format, offset))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ImmediateContext->IASetIndexBuffer(GetBuffer(buffer), format == INDEX_FORMAT_UINT16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, offset);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetVertexShader(VertexShaderHandle vertexShader)
+{
+	if (!StateFilter.SetVertexShader(vertexShader))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ImmediateContext->VSSetShader(vertexShader.IsValid() ? VertexShaders[vertexShader.Id - 1].Shader : nullptr, nullptr, 0);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetPixelShader(PixelShaderHandle pixelShader)
+{
+	if (!StateFilter.SetPixelShader(pixelShader))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ImmediateContext->PSSetShader(pixelShader.IsValid() ? PixelShaders[pixelShader.Id - 1] : nullptr, nullptr, 0);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, 0, 0))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* constantBuffer = GetBuffer(buffer);
+	ImmediateContext->VSSetConstantBuffers(slot, 1, &constantBuffer);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, 0, 0))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* constantBuffer = GetBuffer(buffer);
+	ImmediateContext->PSSetConstantBuffers(slot, 1, &constantBuffer);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, offset, size))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	// Offsets and sizes are counted in 16-byte constants
+	ID3D11Buffer* constantBuffer = GetBuffer(buffer);
+	const uint32_t firstConstant = offset / 16;
+	const uint32_t constantCount = size / 16;
+	ImmediateContext1->VSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &constantCount);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, offset, size))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* constantBuffer = GetBuffer(buffer);
+	const uint32_t firstConstant = offset / 16;
+	const uint32_t constantCount = size / 16;
+	ImmediateContext1->PSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &constantCount);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetRasterizerState(RasterizerStateHandle rasterizerState)
+{
+	if (!StateFilter.SetRasterizerState(rasterizerState))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ImmediateContext->RSSetState(rasterizerState.IsValid() ? RasterizerStates[rasterizerState.Id - 1] : nullptr);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetDepthStencilState(DepthStencilStateHandle depthStencilState)
+{
+	if (!StateFilter.SetDepthStencilState(depthStencilState))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ImmediateContext->OMSetDepthStencilState(depthStencilState.IsValid() ? DepthStencilStates[depthStencilState.Id - 1] : nullptr, 0);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::SetBlendState(BlendStateHandle blendState)
+{
+	if (!StateFilter.SetBlendState(blendState))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	ImmediateContext->OMSetBlendState(blendState.IsValid() ? BlendStates[blendState.Id - 1] : nullptr, nullptr, 0xFFFFFFFF);
+	++CurrentStats.StateChangeCount;
+}
+
+void D3D11RenderDevice::Clear(const float color[4], float depth)
+{
+	ImmediateContext->ClearRenderTargetView(RenderTargetView, color);
+	ImmediateContext->ClearDepthStencilView(DepthStencilView, D3D11_CLEAR_DEPTH, depth, 0);
+}
+
+void D3D11RenderDevice::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+	ImmediateContext->DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+
+	++CurrentStats.DrawCount;
+	++CurrentStats.InstanceCount;
+	CurrentStats.IndexCount += indexCount;
+}
+
+void D3D11RenderDevice::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	ImmediateContext->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+
+	++CurrentStats.DrawCount;
+	CurrentStats.InstanceCount += instanceCount;
+	CurrentStats.IndexCount += (uint64_t)indexCountPerInstance * instanceCount;
+}
+
+void D3D11RenderDevice::ExecuteCommandList(CommandList* commandList)
+{
+	// Every list comes from CreateCommandList of this device
+	const D3D11CommandList* d3d11CommandList = static_cast<const D3D11CommandList*>(commandList);
+	if (!d3d11CommandList->GetRecordedList())
+	{
+		return;
+	}
+
+	// Keeping the immediate context state saves binding everything again after every list
+	ImmediateContext->ExecuteCommandList(d3d11CommandList->GetRecordedList(), TRUE);
+
+	const RenderDeviceStats& stats = d3d11CommandList->GetStats();
+	CurrentStats.DrawCount += stats.DrawCount;
+	CurrentStats.InstanceCount += stats.InstanceCount;
+	CurrentStats.IndexCount += stats.IndexCount;
+	CurrentStats.StateChangeCount += stats.StateChangeCount;
+	CurrentStats.FilteredStateChangeCount += stats.FilteredStateChangeCount;
+}
+
+void D3D11RenderDevice::Present()
+{
+	SwapChain->Present(0, 0);
+
+	FrameStats = CurrentStats;
+	CurrentStats = RenderDeviceStats{};
+}
+
+D3D11CommandList::~D3D11CommandList()
+{
+	if (RecordedList) { RecordedList->Release(); }
+	DeferredContext1->Release();
+	DeferredContext->Release();
+}
+
+void D3D11CommandList::Begin()
+{
+	if (RecordedList)
+	{
+		RecordedList->Release();
+		RecordedList = nullptr;
+	}
+	CommandCount = 0;
+	StateFilter.Reset();
+	Stats = RenderDeviceStats{};
+
+	DeferredContext->OMSetRenderTargets(1, &Device->RenderTargetView, Device->DepthStencilView);
+	DeferredContext->RSSetViewports(1, &Device->Viewport);
+	DeferredContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+}
+
+// FALSE clears the state of the deferred context, the next recording starts from nothing again
+void D3D11CommandList::End()
+{
+	DeferredContext->FinishCommandList(FALSE, &RecordedList);
+}
+
+void D3D11CommandList::SetInputLayout(InputLayoutHandle inputLayout)
+{
+	if (!StateFilter.SetInputLayout(inputLayout))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	DeferredContext->IASetInputLayout(inputLayout.IsValid() ? Device->InputLayouts[inputLayout.Id - 1] : nullptr);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+	if (!StateFilter.SetVertexBuffer(slot, buffer, stride, offset))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* vertexBuffer = Device->GetBuffer(buffer);
+	DeferredContext->IASetVertexBuffers(slot, 1, &vertexBuffer, &stride, &offset);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset)
+{
+	if (!StateFilter.SetIndexBuffer(buffer, format, offset))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	DeferredContext->IASetIndexBuffer(Device->GetBuffer(buffer), format == INDEX_FORMAT_UINT16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT, offset);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetVertexShader(VertexShaderHandle vertexShader)
+{
+	if (!StateFilter.SetVertexShader(vertexShader))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	DeferredContext->VSSetShader(vertexShader.IsValid() ? Device->VertexShaders[vertexShader.Id - 1].Shader : nullptr, nullptr, 0);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetPixelShader(PixelShaderHandle pixelShader)
+{
+	if (!StateFilter.SetPixelShader(pixelShader))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	DeferredContext->PSSetShader(pixelShader.IsValid() ? Device->PixelShaders[pixelShader.Id - 1] : nullptr, nullptr, 0);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, 0, 0))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* constantBuffer = Device->GetBuffer(buffer);
+	DeferredContext->VSSetConstantBuffers(slot, 1, &constantBuffer);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, 0, 0))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* constantBuffer = Device->GetBuffer(buffer);
+	DeferredContext->PSSetConstantBuffers(slot, 1, &constantBuffer);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, offset, size))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* constantBuffer = Device->GetBuffer(buffer);
+	const uint32_t firstConstant = offset / 16;
+	const uint32_t constantCount = size / 16;
+	DeferredContext1->VSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &constantCount);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, offset, size))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	ID3D11Buffer* constantBuffer = Device->GetBuffer(buffer);
+	const uint32_t firstConstant = offset / 16;
+	const uint32_t constantCount = size / 16;
+	DeferredContext1->PSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &constantCount);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetRasterizerState(RasterizerStateHandle rasterizerState)
+{
+	if (!StateFilter.SetRasterizerState(rasterizerState))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	DeferredContext->RSSetState(rasterizerState.IsValid() ? Device->RasterizerStates[rasterizerState.Id - 1] : nullptr);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetDepthStencilState(DepthStencilStateHandle depthStencilState)
+{
+	if (!StateFilter.SetDepthStencilState(depthStencilState))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	DeferredContext->OMSetDepthStencilState(depthStencilState.IsValid() ? Device->DepthStencilStates[depthStencilState.Id - 1] : nullptr, 0);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::SetBlendState(BlendStateHandle blendState)
+{
+	if (!StateFilter.SetBlendState(blendState))
+	{
+		++Stats.FilteredStateChangeCount;
+		return;
+	}
+
+	DeferredContext->OMSetBlendState(blendState.IsValid() ? Device->BlendStates[blendState.Id - 1] : nullptr, nullptr, 0xFFFFFFFF);
+	++CommandCount;
+	++Stats.StateChangeCount;
+}
+
+void D3D11CommandList::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+	DeferredContext->DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+	++CommandCount;
+
+	++Stats.DrawCount;
+	++Stats.InstanceCount;
+	Stats.IndexCount += indexCount;
+}
+
+void D3D11CommandList::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	DeferredContext->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+	++CommandCount;
+
+	++Stats.DrawCount;
+	Stats.InstanceCount += instanceCount;
+	Stats.IndexCount += (uint64_t)indexCountPerInstance * instanceCount;
+}
+
+#endif // _WIN32
@@ -0,0 +1,155 @@
+#pragma once
+
+#ifdef _WIN32
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include <d3d11_1.h>
+
+#include "RenderDevice.h"
+#include "RenderStateCache.h"
+#include "RenderStateFilter.h"
+
+class D3D11RenderDevice;
+
+// Command list on a deferred context of the device. Begin binds the render targets and viewport of the device again, which
+// every recording starts without, and End finishes the recording into an ID3D11CommandList.
+class D3D11CommandList : public CommandList
+{
+public:
+	D3D11CommandList(const D3D11RenderDevice* device, ID3D11DeviceContext* deferredContext, ID3D11DeviceContext1* deferredContext1)
+		: Device(device), DeferredContext(deferredContext), DeferredContext1(deferredContext1) {}
+	~D3D11CommandList() override;
+
+	void Begin() override;
+	void End() override;
+	uint32_t GetCommandCount() const override { return CommandCount; }
+	uint32_t GetFilteredStateChangeCount() const override { return Stats.FilteredStateChangeCount; }
+
+	void SetInputLayout(InputLayoutHandle inputLayout) override;
+	void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+	void SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset) override;
+	void SetVertexShader(VertexShaderHandle vertexShader) override;
+	void SetPixelShader(PixelShaderHandle pixelShader) override;
+	void SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetRasterizerState(RasterizerStateHandle rasterizerState) override;
+	void SetDepthStencilState(DepthStencilStateHandle depthStencilState) override;
+	void SetBlendState(BlendStateHandle blendState) override;
+
+	void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+	void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+
+	// Null until the first End
+	ID3D11CommandList* GetRecordedList() const { return RecordedList; }
+
+	// Counters of the last recording, added to the frame of the device when it is executed
+	const RenderDeviceStats& GetStats() const { return Stats; }
+
+private:
+	const D3D11RenderDevice* Device;
+	ID3D11DeviceContext* DeferredContext;
+	ID3D11DeviceContext1* DeferredContext1;
+	ID3D11CommandList* RecordedList = nullptr;
+	uint32_t CommandCount = 0;
+	RenderStateFilter StateFilter;
+	RenderDeviceStats Stats{};
+};
+
+// RenderDevice on top of ID3D11Device and its immediate context, rendering into the swap chain of a window.
+// Needs the Direct3D 11.1 runtime for constant buffer ranges and NO_OVERWRITE maps of dynamic constant buffers.
+class D3D11RenderDevice : public RenderDevice
+{
+public:
+	bool Init(HWND hWnd, int32_t width, int32_t height);
+
+	const char* GetName() const override { return "Direct3D 11"; }
+	void Free() override;
+
+	BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData) override;
+	VertexShaderHandle CreateVertexShader(const ShaderDesc& desc) override;
+	PixelShaderHandle CreatePixelShader(const ShaderDesc& desc) override;
+	InputLayoutHandle CreateInputLayout(const InputElementDesc* elements, uint32_t elementCount, VertexShaderHandle vertexShader) override;
+	RasterizerStateHandle CreateRasterizerState(const RasterizerDesc& desc) override;
+	DepthStencilStateHandle CreateDepthStencilState(const DepthStencilDesc& desc) override;
+	BlendStateHandle CreateBlendState(const BlendDesc& desc) override;
+	CommandList* CreateCommandList() override;
+
+	void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) override;
+	void WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size, MAP_TYPE mapType) override;
+	void SetInputLayout(InputLayoutHandle inputLayout) override;
+	void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+	void SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset) override;
+	void SetVertexShader(VertexShaderHandle vertexShader) override;
+	void SetPixelShader(PixelShaderHandle pixelShader) override;
+	void SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetRasterizerState(RasterizerStateHandle rasterizerState) override;
+	void SetDepthStencilState(DepthStencilStateHandle depthStencilState) override;
+	void SetBlendState(BlendStateHandle blendState) override;
+
+	void Clear(const float color[4], float depth) override;
+	void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+	void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+	void ExecuteCommandList(CommandList* commandList) override;
+	void Present() override;
+
+	const RenderDeviceStats& GetFrameStats() const override { return FrameStats; }
+	const StateCacheStats& GetStateCacheStats() const override { return StateCache.GetStats(); }
+
+	ID3D11Device* GetDevice() const { return Device; }
+	ID3D11DeviceContext* GetImmediateContext() const { return ImmediateContext; }
+
+private:
+	friend class D3D11CommandList;
+
+	struct Buffer
+	{
+		ID3D11Buffer* Resource;
+		BUFFER_TYPE Type;
+		BUFFER_USAGE Usage;
+	};
+
+	struct VertexShader
+	{
+		ID3D11VertexShader* Shader;
+		ID3DBlob* Code;
+	};
+
+	ID3D11Buffer* GetBuffer(BufferHandle buffer) const { return buffer.IsValid() ? Buffers[buffer.Id - 1].Resource : nullptr; }
+
+	IDXGIFactory* Factory = nullptr;
+	IDXGIAdapter* Adapter = nullptr;
+	ID3D11Device* Device = nullptr;
+	ID3D11DeviceContext* ImmediateContext = nullptr;
+	ID3D11DeviceContext1* ImmediateContext1 = nullptr;
+	IDXGISwapChain* SwapChain = nullptr;
+	ID3D11RenderTargetView* RenderTargetView = nullptr;
+	ID3D11Texture2D* DepthStencilBuffer = nullptr;
+	ID3D11DepthStencilView* DepthStencilView = nullptr;
+	D3D11_VIEWPORT Viewport{};
+
+	std::vector<Buffer> Buffers;
+	std::vector<VertexShader> VertexShaders;
+	std::vector<ID3D11PixelShader*> PixelShaders;
+	std::vector<ID3D11InputLayout*> InputLayouts;
+	std::vector<ID3D11RasterizerState*> RasterizerStates;
+	std::vector<ID3D11DepthStencilState*> DepthStencilStates;
+	std::vector<ID3D11BlendState*> BlendStates;
+	RenderStateCache StateCache;
+	std::vector<std::unique_ptr<D3D11CommandList>> CommandLists;
+
+	// Calls that would bind what the immediate context has bound already never reach it
+	RenderStateFilter StateFilter;
+
+	RenderDeviceStats CurrentStats{};
+	RenderDeviceStats FrameStats{};
+};
+
+#endif // _WIN32
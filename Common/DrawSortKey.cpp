@@ -0,0 +1,11 @@
+#include "DrawSortKey.h"
+
+uint32_t CountDrawStateChanges(const uint64_t* keys, uint32_t count)
+{
+	uint32_t changeCount = 0;
+	for (uint32_t i = 1; i < count; ++i)
+	{
+		changeCount += (keys[i] ^ keys[i - 1]) >> DRAW_KEY_MESH_SHIFT ? 1 : 0;
+	}
+	return changeCount;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// A 64-bit key per draw, ordered from the most significant field: pass, shader, state, mesh and view depth. Sorting the
+// keys brings draws that share a shader, then a state, then a mesh together, and orders the draws of one mesh by depth.
+constexpr uint32_t DRAW_KEY_PASS_BITS = 4;
+constexpr uint32_t DRAW_KEY_SHADER_BITS = 8;
+constexpr uint32_t DRAW_KEY_STATE_BITS = 12;
+constexpr uint32_t DRAW_KEY_MESH_BITS = 16;
+constexpr uint32_t DRAW_KEY_DEPTH_BITS = 24;
+static_assert(DRAW_KEY_PASS_BITS + DRAW_KEY_SHADER_BITS + DRAW_KEY_STATE_BITS + DRAW_KEY_MESH_BITS + DRAW_KEY_DEPTH_BITS == 64,
+	"The fields must fill the key");
+
+constexpr uint32_t DRAW_KEY_MESH_SHIFT = DRAW_KEY_DEPTH_BITS;
+constexpr uint32_t DRAW_KEY_STATE_SHIFT = DRAW_KEY_MESH_SHIFT + DRAW_KEY_MESH_BITS;
+constexpr uint32_t DRAW_KEY_SHADER_SHIFT = DRAW_KEY_STATE_SHIFT + DRAW_KEY_STATE_BITS;
+constexpr uint32_t DRAW_KEY_PASS_SHIFT = DRAW_KEY_SHADER_SHIFT + DRAW_KEY_SHADER_BITS;
+
+// Passes in the order they are drawn. Opaque draws go front to back, so that the depth test rejects what they hide,
+// transparent ones back to front.
+enum DRAW_PASS : uint32_t
+{
+	DRAW_PASS_OPAQUE,
+	DRAW_PASS_TRANSPARENT
+};
+
+struct DrawSortStats
+{
+	uint32_t KeyCount;
+
+	// Neighboring draws with another shader, state or mesh, in the order the draws were made in and in the sorted order
+	uint32_t UnsortedStateChangeCount;
+	uint32_t StateChangeCount;
+
+	uint32_t PassCount;
+	uint32_t SkippedPassCount;
+
+	// Milliseconds of making the keys, and of sorting them
+	double KeyTime;
+	double SortTime;
+};
+
+// Depth of a draw from its squared distance to the camera, which saves the square root and keeps the order. The bits of a
+// positive float grow with its value, so its top DRAW_KEY_DEPTH_BITS bits below the sign are a coarser float.
+inline uint32_t QuantizeDrawDepth(float distanceSquared)
+{
+	uint32_t bits;
+	memcpy(&bits, &distanceSquared, sizeof(bits));
+	return (bits & 0x7FFFFFFF) >> (31 - DRAW_KEY_DEPTH_BITS);
+}
+
+// Shader, state and mesh are ids that have to fit their fields. The depth of transparent draws is inverted to draw them back to front.
+constexpr uint64_t MakeDrawKey(DRAW_PASS pass, uint32_t shader, uint32_t state, uint32_t mesh, uint32_t depth)
+{
+	return (uint64_t)pass << DRAW_KEY_PASS_SHIFT | (uint64_t)shader << DRAW_KEY_SHADER_SHIFT | (uint64_t)state << DRAW_KEY_STATE_SHIFT |
+		(uint64_t)mesh << DRAW_KEY_MESH_SHIFT | ((pass == DRAW_PASS_TRANSPARENT ? ~depth : depth) & ((1u << DRAW_KEY_DEPTH_BITS) - 1));
+}
+
+constexpr uint32_t GetDrawKeyMesh(uint64_t key)
+{
+	return (uint32_t)(key >> DRAW_KEY_MESH_SHIFT) & ((1u << DRAW_KEY_MESH_BITS) - 1);
+}
+
+// Neighbors of keys[0..count) that differ in more than their depth
+uint32_t CountDrawStateChanges(const uint64_t* keys, uint32_t count);
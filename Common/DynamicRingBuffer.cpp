@@ -0,0 +1,34 @@
+#include "DynamicRingBuffer.h"
+
+bool DynamicRingBuffer::Init(RenderDevice* device, BUFFER_TYPE type, uint32_t size)
+{
+	Device = device;
+	Size = size;
+	Head = 0;
+	DiscardCount = 0;
+	bDiscarded = false;
+
+	Buffer = Device->CreateBuffer({ type, BUFFER_USAGE_DYNAMIC, size }, nullptr);
+
+	return Buffer.IsValid();
+}
+
+uint32_t DynamicRingBuffer::Write(const void* data, uint32_t size, uint32_t alignment)
+{
+	uint64_t offset = (Head + (uint64_t)alignment - 1) / alignment * alignment;
+
+	// The first write and every wrap start over on fresh memory
+	MAP_TYPE mapType = MAP_TYPE_WRITE_NO_OVERWRITE;
+	if (!bDiscarded || offset + size > Size)
+	{
+		offset = 0;
+		mapType = MAP_TYPE_WRITE_DISCARD;
+		bDiscarded = true;
+		++DiscardCount;
+	}
+
+	Device->WriteBuffer(Buffer, (uint32_t)offset, data, size, mapType);
+	Head = (uint32_t)offset + size;
+
+	return (uint32_t)offset;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "RenderDevice.h"
+
+// Suballocates short-lived data from one large DYNAMIC buffer.
+// Writes append with MAP_TYPE_WRITE_NO_OVERWRITE, and once the buffer is full it is discarded and filled again from the start,
+// so the driver renames the memory still in use by the GPU instead of stalling.
+class DynamicRingBuffer
+{
+public:
+	bool Init(RenderDevice* device, BUFFER_TYPE type, uint32_t size);
+
+	// Copies size bytes to the next free range aligned to alignment and returns its offset.
+	// size must not be larger than the buffer.
+	uint32_t Write(const void* data, uint32_t size, uint32_t alignment);
+
+	BufferHandle GetBuffer() const { return Buffer; }
+	uint32_t GetSize() const { return Size; }
+
+	// Number of times the buffer was discarded
+	uint32_t GetDiscardCount() const { return DiscardCount; }
+
+private:
+	RenderDevice* Device = nullptr;
+	BufferHandle Buffer;
+	uint32_t Size = 0;
+	uint32_t Head = 0;
+	uint32_t DiscardCount = 0;
+	bool bDiscarded = false;
+};
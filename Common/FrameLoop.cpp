@@ -0,0 +1,213 @@
+#include "FrameLoop.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+FrameLoop::~FrameLoop()
+{
+	StopSimulation();
+}
+
+void FrameLoop::Reset(float fixedDeltaTime, bool bRecordTimings)
+{
+	FixedDeltaTime = fixedDeltaTime;
+	this->bRecordTimings = bRecordTimings;
+	ElapsedTime = 0.0f;
+	FrameCount = 0;
+	bFrameRateReady = false;
+	Fps = 0.0f;
+	Timings.clear();
+
+	FrameClock.Reset();
+	BeginTicks = Clock::GetTicks();
+	EndTicks = BeginTicks;
+}
+
+void FrameLoop::RunFrame(const UpdateFunction& update, const RenderFunction& render)
+{
+	const float measuredDeltaTime = FrameClock.Tick();
+	const float deltaTime = FixedDeltaTime > 0.0f ? FixedDeltaTime : measuredDeltaTime;
+
+	++FrameCount;
+	ElapsedTime += measuredDeltaTime;
+	if (ElapsedTime >= 1.0f)
+	{
+		Fps = (float)FrameCount;
+		bFrameRateReady = true;
+
+		FrameCount = 0;
+		ElapsedTime = 0.0f;
+	}
+
+	FrameTiming timing;
+	timing.DeltaTime = deltaTime;
+	timing.FrameTime = measuredDeltaTime * 1000.0;
+
+	const uint64_t beginTicks = Clock::GetTicks();
+	update(deltaTime);
+
+	const uint64_t updateTicks = Clock::GetTicks();
+	render();
+
+	const uint64_t endTicks = Clock::GetTicks();
+	timing.UpdateTime = Clock::TicksToMilliseconds(updateTicks - beginTicks);
+	timing.RenderTime = Clock::TicksToMilliseconds(endTicks - updateTicks);
+	EndTicks = endTicks;
+	if (bRecordTimings)
+	{
+		Timings.push_back(timing);
+	}
+}
+
+void FrameLoop::Run(int32_t frameCount, const UpdateFunction& update, const RenderFunction& render)
+{
+	if (bRecordTimings)
+	{
+		Timings.reserve(Timings.size() + frameCount);
+	}
+
+	for (int32_t frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+	{
+		RunFrame(update, render);
+	}
+}
+
+bool FrameLoop::StartSimulation(float step, const SimulateFunction& simulate)
+{
+	StopSimulation();
+	if (step <= 0.0f || !simulate)
+	{
+		return false;
+	}
+
+	SimulationStep = step;
+	Simulate = simulate;
+	SimStats = SimulationStats{};
+	bStopSimulation.store(false, std::memory_order_relaxed);
+	SimulationThread = std::thread(&FrameLoop::SimulationMain, this);
+
+	return true;
+}
+
+void FrameLoop::StopSimulation()
+{
+	if (!SimulationThread.joinable())
+	{
+		return;
+	}
+
+	bStopSimulation.store(true, std::memory_order_release);
+	SimulationThread.join();
+	Simulate = nullptr;
+}
+
+// Steps are due every SimulationStep seconds from the start. The thread sleeps until the next one is due, and runs late ones back to back.
+void FrameLoop::SimulationMain()
+{
+	const uint64_t stepTicks = std::max((uint64_t)(SimulationStep * (double)Clock::GetFrequency()), (uint64_t)1);
+	const uint64_t startTicks = Clock::GetTicks();
+	uint64_t dueTicks = startTicks;
+	uint64_t busyTicks = 0;
+	uint64_t maxStepTicks = 0;
+	while (!bStopSimulation.load(std::memory_order_acquire))
+	{
+		const uint64_t beginTicks = Clock::GetTicks();
+		if (beginTicks < dueTicks)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(Clock::TicksToMilliseconds(dueTicks - beginTicks) * 1000.0)));
+			continue;
+		}
+
+		const uint64_t lateStepCount = (beginTicks - dueTicks) / stepTicks;
+		if (lateStepCount > MAX_SIMULATION_CATCH_UP_STEPS)
+		{
+			SimStats.DroppedStepCount += lateStepCount - MAX_SIMULATION_CATCH_UP_STEPS;
+			dueTicks += (lateStepCount - MAX_SIMULATION_CATCH_UP_STEPS) * stepTicks;
+		}
+
+		Simulate(SimulationStep);
+
+		const uint64_t stepTicksTaken = Clock::GetTicks() - beginTicks;
+		busyTicks += stepTicksTaken;
+		maxStepTicks = std::max(maxStepTicks, stepTicksTaken);
+		++SimStats.StepCount;
+		dueTicks += stepTicks;
+	}
+
+	SimStats.BusyTime = Clock::TicksToMilliseconds(busyTicks);
+	SimStats.MaxStepTime = Clock::TicksToMilliseconds(maxStepTicks);
+	SimStats.ElapsedTime = Clock::TicksToMilliseconds(Clock::GetTicks() - startTicks);
+}
+
+bool FrameLoop::GetFrameRate(float& outFps, float& outMspf)
+{
+	if (!bFrameRateReady)
+	{
+		return false;
+	}
+
+	outFps = Fps;
+	outMspf = 1000.0f / Fps;
+	bFrameRateReady = false;
+
+	return true;
+}
+
+void FrameLoop::PrintSummary(FILE* file) const
+{
+	if (Timings.empty())
+	{
+		return;
+	}
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(Timings.size());
+
+	double updateTime = 0.0;
+	double renderTime = 0.0;
+	double intervalTime = 0.0;
+	double maxIntervalTime = 0.0;
+	for (const FrameTiming& timing : Timings)
+	{
+		frameTimes.push_back(timing.UpdateTime + timing.RenderTime);
+		updateTime += timing.UpdateTime;
+		renderTime += timing.RenderTime;
+		intervalTime += timing.FrameTime;
+		maxIntervalTime = std::max(maxIntervalTime, timing.FrameTime);
+	}
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	const double frameCount = (double)Timings.size();
+	const double averageTime = (updateTime + renderTime) / frameCount;
+	const double p95Time = frameTimes[std::min(frameTimes.size() - 1, (size_t)(frameCount * 0.95))];
+
+	fprintf(file, "frames: %zu    cpu mspf    avg: %.4f    min: %.4f    p95: %.4f    max: %.4f\n",
+		Timings.size(), averageTime, frameTimes.front(), p95Time, frameTimes.back());
+	fprintf(file, "update avg: %.4f ms    render avg: %.4f ms\n", updateTime / frameCount, renderTime / frameCount);
+
+	// Spread of the time between frame starts, what is seen as stutter
+	const double averageInterval = intervalTime / frameCount;
+	double intervalVariance = 0.0;
+	for (const FrameTiming& timing : Timings)
+	{
+		intervalVariance += (timing.FrameTime - averageInterval) * (timing.FrameTime - averageInterval);
+	}
+	intervalVariance /= frameCount;
+	fprintf(file, "frame interval avg: %.4f ms    variance: %.4f ms^2    std dev: %.4f ms    max: %.4f ms\n", averageInterval, intervalVariance,
+		sqrt(intervalVariance), maxIntervalTime);
+
+	const double elapsedTime = Clock::TicksToMilliseconds(EndTicks - BeginTicks);
+	if (elapsedTime > 0.0)
+	{
+		fprintf(file, "frame thread busy: %.1f%% (update %.1f%%, render %.1f%%)", (updateTime + renderTime) * 100.0 / elapsedTime, updateTime * 100.0 / elapsedTime,
+			renderTime * 100.0 / elapsedTime);
+	}
+	if (SimStats.StepCount > 0)
+	{
+		fprintf(file, "    simulation thread busy: %.1f%%    steps: %llu    dropped: %llu    step avg: %.4f ms    max: %.4f ms",
+			SimStats.GetUtilization() * 100.0, (unsigned long long)SimStats.StepCount, (unsigned long long)SimStats.DroppedStepCount,
+			SimStats.BusyTime / (double)SimStats.StepCount, SimStats.MaxStepTime);
+	}
+	fprintf(file, "\n");
+}
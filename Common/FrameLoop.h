@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "Clock.h"
+
+struct FrameTiming
+{
+	// Seconds, the value passed to Update
+	float DeltaTime;
+
+	// Milliseconds since the previous frame started, how long the frame before this one was on screen
+	double FrameTime;
+
+	// Milliseconds of CPU time
+	double UpdateTime;
+	double RenderTime;
+};
+
+// Steps of the simulation thread, in milliseconds of CPU and wall time between StartSimulation and StopSimulation
+struct SimulationStats
+{
+	uint64_t StepCount;
+
+	// Steps dropped after the thread fell more than MAX_SIMULATION_CATCH_UP_STEPS behind
+	uint64_t DroppedStepCount;
+
+	double BusyTime;
+	double MaxStepTime;
+	double ElapsedTime;
+
+	double GetUtilization() const { return ElapsedTime > 0.0 ? BusyTime / ElapsedTime : 0.0; }
+};
+
+// Update/Render driver shared by the windowed samples and the headless runner.
+// With StartSimulation the simulation runs at a fixed step on a thread of its own, and Update and Render of every frame only
+// pick up what it published last, so a long step no longer holds back the frames.
+class FrameLoop
+{
+public:
+	using UpdateFunction = std::function<void(float deltaTime)>;
+	using RenderFunction = std::function<void()>;
+	using SimulateFunction = std::function<void(float deltaTime)>;
+
+	// Steps the simulation thread runs back to back to catch up before it drops the rest
+	static constexpr uint32_t MAX_SIMULATION_CATCH_UP_STEPS = 4;
+
+	FrameLoop() = default;
+	FrameLoop(const FrameLoop&) = delete;
+	FrameLoop& operator=(const FrameLoop&) = delete;
+	~FrameLoop();
+
+	// fixedDeltaTime of 0 uses the measured time between frames.
+	// Per-frame timings are only kept when bRecordTimings is set, so the windowed samples do not grow memory.
+	void Reset(float fixedDeltaTime = 0.0f, bool bRecordTimings = false);
+
+	// One iteration of Update and Render, called from the message loop when there are no messages
+	void RunFrame(const UpdateFunction& update, const RenderFunction& render);
+
+	// Runs frameCount frames back to back, without a window
+	void Run(int32_t frameCount, const UpdateFunction& update, const RenderFunction& render);
+
+	// Calls simulate(step) every step seconds of wall time on a new thread until StopSimulation
+	bool StartSimulation(float step, const SimulateFunction& simulate);
+	void StopSimulation();
+	bool IsSimulationRunning() const { return SimulationThread.joinable(); }
+
+	// Returns true once per second with the frame rate over that second
+	bool GetFrameRate(float& outFps, float& outMspf);
+
+	const std::vector<FrameTiming>& GetTimings() const { return Timings; }
+
+	// Only up to date once StopSimulation returned
+	const SimulationStats& GetSimulationStats() const { return SimStats; }
+
+	// Frame times, their spread, and how busy the frame and simulation threads were
+	void PrintSummary(FILE* file) const;
+
+private:
+	void SimulationMain();
+
+	Clock FrameClock;
+	float FixedDeltaTime = 0.0f;
+	bool bRecordTimings = false;
+
+	// Wall time from Reset to the end of the last frame
+	uint64_t BeginTicks = 0;
+	uint64_t EndTicks = 0;
+
+	float ElapsedTime = 0.0f;
+	int32_t FrameCount = 0;
+	bool bFrameRateReady = false;
+	float Fps = 0.0f;
+
+	std::vector<FrameTiming> Timings;
+
+	float SimulationStep = 0.0f;
+	SimulateFunction Simulate;
+	std::thread SimulationThread;
+	std::atomic<bool> bStopSimulation{ false };
+	SimulationStats SimStats{};
+};
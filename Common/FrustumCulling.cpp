@@ -0,0 +1,200 @@
+#include "FrustumCulling.h"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "Simd.h"
+#include "ThreadPool.h"
+
+namespace
+{
+	// Bounds per ParallelFor task, a multiple of SIMD_WIDTH
+	constexpr uint32_t CULL_CHUNK_SIZE = 16 * 1024;
+
+	Float4 NormalizePlane(const Float4& plane)
+	{
+		const float inverseLength = 1.0f / sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		return { plane.x * inverseLength, plane.y * inverseLength, plane.z * inverseLength, plane.w * inverseLength };
+	}
+
+	// Every chunk is culled into its own part of outVisibleIndices, then the parts are moved together
+	template <typename Bounds, typename CullFunction>
+	uint32_t CullParallel(ThreadPool& threadPool, const Frustum& frustum, const Bounds& bounds, uint32_t* outVisibleIndices, CullFunction cull)
+	{
+		const uint32_t count = bounds.GetCount();
+		const uint32_t chunkCount = (count + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+
+		std::vector<uint32_t> chunkVisibleCounts(chunkCount);
+		threadPool.ParallelFor(chunkCount, [&](uint32_t chunkIndex, uint32_t)
+			{
+				const uint32_t begin = chunkIndex * CULL_CHUNK_SIZE;
+				const uint32_t end = count - begin < CULL_CHUNK_SIZE ? count : begin + CULL_CHUNK_SIZE;
+				chunkVisibleCounts[chunkIndex] = cull(frustum, bounds, begin, end, outVisibleIndices + begin);
+			});
+
+		uint32_t visibleCount = 0;
+		for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+		{
+			if (visibleCount != chunkIndex * CULL_CHUNK_SIZE)
+			{
+				memmove(outVisibleIndices + visibleCount, outVisibleIndices + chunkIndex * CULL_CHUNK_SIZE, chunkVisibleCounts[chunkIndex] * sizeof(uint32_t));
+			}
+			visibleCount += chunkVisibleCounts[chunkIndex];
+		}
+		return visibleCount;
+	}
+}
+
+// Gribb and Hartmann: with clip = v * M, -w <= x is dot(v, column 3 + column 0) >= 0 and so on
+Frustum ExtractFrustumPlanes(const Float4x4& viewProjectionMatrix)
+{
+	const Float4x4& m = viewProjectionMatrix;
+	const Float4 columns[4]
+	{
+		{ m.m[0][0], m.m[1][0], m.m[2][0], m.m[3][0] },
+		{ m.m[0][1], m.m[1][1], m.m[2][1], m.m[3][1] },
+		{ m.m[0][2], m.m[1][2], m.m[2][2], m.m[3][2] },
+		{ m.m[0][3], m.m[1][3], m.m[2][3], m.m[3][3] }
+	};
+
+	Frustum frustum;
+	frustum.Planes[FRUSTUM_PLANE_LEFT] = NormalizePlane({ columns[3].x + columns[0].x, columns[3].y + columns[0].y, columns[3].z + columns[0].z, columns[3].w + columns[0].w });
+	frustum.Planes[FRUSTUM_PLANE_RIGHT] = NormalizePlane({ columns[3].x - columns[0].x, columns[3].y - columns[0].y, columns[3].z - columns[0].z, columns[3].w - columns[0].w });
+	frustum.Planes[FRUSTUM_PLANE_BOTTOM] = NormalizePlane({ columns[3].x + columns[1].x, columns[3].y + columns[1].y, columns[3].z + columns[1].z, columns[3].w + columns[1].w });
+	frustum.Planes[FRUSTUM_PLANE_TOP] = NormalizePlane({ columns[3].x - columns[1].x, columns[3].y - columns[1].y, columns[3].z - columns[1].z, columns[3].w - columns[1].w });
+	frustum.Planes[FRUSTUM_PLANE_NEAR] = NormalizePlane(columns[2]);
+	frustum.Planes[FRUSTUM_PLANE_FAR] = NormalizePlane({ columns[3].x - columns[2].x, columns[3].y - columns[2].y, columns[3].z - columns[2].z, columns[3].w - columns[2].w });
+	return frustum;
+}
+
+// A sphere is outside when its center is further than the radius behind any plane
+uint32_t CullSpheres(const Frustum& frustum, const SphereBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices)
+{
+	SimdFloat planes[FRUSTUM_PLANE_COUNT][4];
+	for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+	{
+		const Float4& plane = frustum.Planes[planeIndex];
+		planes[planeIndex][0] = SimdSet(plane.x);
+		planes[planeIndex][1] = SimdSet(plane.y);
+		planes[planeIndex][2] = SimdSet(plane.z);
+		planes[planeIndex][3] = SimdSet(plane.w);
+	}
+
+	uint32_t visibleCount = 0;
+	uint32_t i = begin;
+	for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		const SimdFloat centerX = SimdLoad(&bounds.CenterX[i]);
+		const SimdFloat centerY = SimdLoad(&bounds.CenterY[i]);
+		const SimdFloat centerZ = SimdLoad(&bounds.CenterZ[i]);
+		const SimdFloat negativeRadius = SimdZero() - SimdLoad(&bounds.Radius[i]);
+
+		SimdFloat inside = SimdCastToFloat(SimdSetInt(-1));
+		for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+		{
+			const SimdFloat distance = centerX * planes[planeIndex][0] + centerY * planes[planeIndex][1] + centerZ * planes[planeIndex][2] + planes[planeIndex][3];
+			inside = inside & (distance >= negativeRadius);
+		}
+
+		visibleCount += SimdStoreCompactIndices(outVisibleIndices + visibleCount, i, SimdMoveMask(inside));
+	}
+
+	return visibleCount + CullSpheresScalar(frustum, bounds, i, end, outVisibleIndices + visibleCount);
+}
+
+// A box is outside when its corner furthest along a plane normal is behind it.
+// That corner is at center + |normal| * extent along the normal.
+uint32_t CullBoxes(const Frustum& frustum, const BoxBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices)
+{
+	SimdFloat planes[FRUSTUM_PLANE_COUNT][4];
+	SimdFloat absoluteNormals[FRUSTUM_PLANE_COUNT][3];
+	for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+	{
+		const Float4& plane = frustum.Planes[planeIndex];
+		planes[planeIndex][0] = SimdSet(plane.x);
+		planes[planeIndex][1] = SimdSet(plane.y);
+		planes[planeIndex][2] = SimdSet(plane.z);
+		planes[planeIndex][3] = SimdSet(plane.w);
+		absoluteNormals[planeIndex][0] = SimdSet(fabsf(plane.x));
+		absoluteNormals[planeIndex][1] = SimdSet(fabsf(plane.y));
+		absoluteNormals[planeIndex][2] = SimdSet(fabsf(plane.z));
+	}
+
+	uint32_t visibleCount = 0;
+	uint32_t i = begin;
+	for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH)
+	{
+		const SimdFloat centerX = SimdLoad(&bounds.CenterX[i]);
+		const SimdFloat centerY = SimdLoad(&bounds.CenterY[i]);
+		const SimdFloat centerZ = SimdLoad(&bounds.CenterZ[i]);
+		const SimdFloat extentX = SimdLoad(&bounds.ExtentX[i]);
+		const SimdFloat extentY = SimdLoad(&bounds.ExtentY[i]);
+		const SimdFloat extentZ = SimdLoad(&bounds.ExtentZ[i]);
+
+		SimdFloat inside = SimdCastToFloat(SimdSetInt(-1));
+		for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+		{
+			const SimdFloat distance = centerX * planes[planeIndex][0] + centerY * planes[planeIndex][1] + centerZ * planes[planeIndex][2] + planes[planeIndex][3];
+			const SimdFloat radius = extentX * absoluteNormals[planeIndex][0] + extentY * absoluteNormals[planeIndex][1] + extentZ * absoluteNormals[planeIndex][2];
+			inside = inside & (distance + radius >= SimdZero());
+		}
+
+		visibleCount += SimdStoreCompactIndices(outVisibleIndices + visibleCount, i, SimdMoveMask(inside));
+	}
+
+	return visibleCount + CullBoxesScalar(frustum, bounds, i, end, outVisibleIndices + visibleCount);
+}
+
+uint32_t CullSpheresScalar(const Frustum& frustum, const SphereBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices)
+{
+	uint32_t visibleCount = 0;
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		const Float4 center{ bounds.CenterX[i], bounds.CenterY[i], bounds.CenterZ[i], 1.0f };
+		const float negativeRadius = 0.0f - bounds.Radius[i];
+
+		bool bInside = true;
+		for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+		{
+			const Float4& plane = frustum.Planes[planeIndex];
+			const float distance = center.x * plane.x + center.y * plane.y + center.z * plane.z + plane.w;
+			bInside = bInside && distance >= negativeRadius;
+		}
+
+		// Branchless append
+		outVisibleIndices[visibleCount] = i;
+		visibleCount += bInside ? 1 : 0;
+	}
+	return visibleCount;
+}
+
+uint32_t CullBoxesScalar(const Frustum& frustum, const BoxBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices)
+{
+	uint32_t visibleCount = 0;
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		bool bInside = true;
+		for (uint32_t planeIndex = 0; planeIndex < FRUSTUM_PLANE_COUNT; ++planeIndex)
+		{
+			const Float4& plane = frustum.Planes[planeIndex];
+			const float distance = bounds.CenterX[i] * plane.x + bounds.CenterY[i] * plane.y + bounds.CenterZ[i] * plane.z + plane.w;
+			const float radius = bounds.ExtentX[i] * fabsf(plane.x) + bounds.ExtentY[i] * fabsf(plane.y) + bounds.ExtentZ[i] * fabsf(plane.z);
+			bInside = bInside && distance + radius >= 0.0f;
+		}
+
+		outVisibleIndices[visibleCount] = i;
+		visibleCount += bInside ? 1 : 0;
+	}
+	return visibleCount;
+}
+
+uint32_t CullSpheresParallel(ThreadPool& threadPool, const Frustum& frustum, const SphereBoundsArrays& bounds, uint32_t* outVisibleIndices)
+{
+	return CullParallel(threadPool, frustum, bounds, outVisibleIndices, CullSpheres);
+}
+
+uint32_t CullBoxesParallel(ThreadPool& threadPool, const Frustum& frustum, const BoxBoundsArrays& bounds, uint32_t* outVisibleIndices)
+{
+	return CullParallel(threadPool, frustum, bounds, outVisibleIndices, CullBoxes);
+}
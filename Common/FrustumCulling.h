@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "BoundingVolumes.h"
+#include "MathTypes.h"
+
+class ThreadPool;
+
+enum FRUSTUM_PLANE : uint32_t
+{
+	FRUSTUM_PLANE_LEFT,
+	FRUSTUM_PLANE_RIGHT,
+	FRUSTUM_PLANE_BOTTOM,
+	FRUSTUM_PLANE_TOP,
+	FRUSTUM_PLANE_NEAR,
+	FRUSTUM_PLANE_FAR,
+	FRUSTUM_PLANE_COUNT
+};
+
+// Planes (a, b, c, d) with unit normals pointing inside: a point is inside when a * x + b * y + c * z + d >= 0
+struct Frustum
+{
+	Float4 Planes[FRUSTUM_PLANE_COUNT];
+};
+
+// World space planes of the clip volume of viewProjectionMatrix (row vectors, 0 <= z <= w as in Direct3D)
+Frustum ExtractFrustumPlanes(const Float4x4& viewProjectionMatrix);
+
+// Write the indices in [begin, end) of the bounds that intersect the frustum to outVisibleIndices in ascending order
+// and return how many. outVisibleIndices needs room for end - begin indices. SIMD_WIDTH bounds are tested per iteration.
+uint32_t CullSpheres(const Frustum& frustum, const SphereBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices);
+uint32_t CullBoxes(const Frustum& frustum, const BoxBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices);
+
+// One bounding volume at a time, used for the remainder and as the reference of the SIMD path
+uint32_t CullSpheresScalar(const Frustum& frustum, const SphereBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices);
+uint32_t CullBoxesScalar(const Frustum& frustum, const BoxBoundsArrays& bounds, uint32_t begin, uint32_t end, uint32_t* outVisibleIndices);
+
+// Cull all bounds in chunks spread over the threads of threadPool. The result is the same as a single CullSpheres/CullBoxes
+// over every bound; outVisibleIndices needs room for all of them.
+uint32_t CullSpheresParallel(ThreadPool& threadPool, const Frustum& frustum, const SphereBoundsArrays& bounds, uint32_t* outVisibleIndices);
+uint32_t CullBoxesParallel(ThreadPool& threadPool, const Frustum& frustum, const BoxBoundsArrays& bounds, uint32_t* outVisibleIndices);
@@ -0,0 +1,37 @@
+#include "InstanceGrid.h"
+
+#include <math.h>
+
+void GenerateInstanceGrid(uint32_t instanceCount, float spacing, std::vector<Float3>& outPositions, std::vector<Float4>& outColors)
+{
+	outPositions.resize(instanceCount);
+	outColors.resize(instanceCount);
+
+	const uint32_t columnCount = (uint32_t)ceilf(sqrtf((float)instanceCount));
+	const uint32_t rowCount = columnCount ? (instanceCount + columnCount - 1) / columnCount : 0;
+	const float originX = -0.5f * (columnCount - 1) * spacing;
+	const float originZ = -0.5f * (rowCount - 1) * spacing;
+
+	for (uint32_t i = 0; i < instanceCount; ++i)
+	{
+		const uint32_t column = i % columnCount;
+		const uint32_t row = i / columnCount;
+		outPositions[i] = { originX + column * spacing, 0.0f, originZ + row * spacing };
+
+		if (instanceCount == 1)
+		{
+			outColors[i] = { 1.0f, 1.0f, 1.0f, 1.0f };
+			continue;
+		}
+
+		// Integer hash of the index, three bytes mapped to [0.25, 1]
+		uint32_t hash = i * 0x9E3779B1u;
+		hash ^= hash >> 15;
+		hash *= 0x85EBCA77u;
+		hash ^= hash >> 13;
+		outColors[i].x = 0.25f + 0.75f * ((hash >> 0) & 0xFF) / 255.0f;
+		outColors[i].y = 0.25f + 0.75f * ((hash >> 8) & 0xFF) / 255.0f;
+		outColors[i].z = 0.25f + 0.75f * ((hash >> 16) & 0xFF) / 255.0f;
+		outColors[i].w = 1.0f;
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "MathTypes.h"
+
+// Places instanceCount objects on a square grid in the XZ plane, centered on the origin and spacing apart.
+// A single instance sits at the origin and is white, otherwise every instance gets its own color.
+void GenerateInstanceGrid(uint32_t instanceCount, float spacing, std::vector<Float3>& outPositions, std::vector<Float4>& outColors);
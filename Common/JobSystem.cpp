@@ -0,0 +1,403 @@
+#include "JobSystem.h"
+
+namespace
+{
+	// Yields of an idle thread before it goes to sleep
+	constexpr uint32_t IDLE_SPIN_COUNT = 64;
+
+	// System and index of the calling thread, set by Init for its caller and by every worker
+	struct JobThread
+	{
+		const JobSystem* System;
+		uint32_t Index;
+	};
+	thread_local JobThread CurrentJobThread{ nullptr, 0 };
+}
+
+// Only the owner writes Bottom, so a push publishes the job with one release store
+bool JobSystem::WorkerQueue::Push(Job* job)
+{
+	const int64_t bottom = Bottom.load(std::memory_order_relaxed);
+	const int64_t top = Top.load(std::memory_order_acquire);
+	if (bottom - top >= (int64_t)QUEUE_CAPACITY)
+	{
+		return false;
+	}
+
+	Jobs[bottom & (QUEUE_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+	Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+// The owner takes the newest job. Only the last one can be contended, and a thief that gets there first wins it.
+Job* JobSystem::WorkerQueue::Pop()
+{
+	const int64_t bottom = Bottom.load(std::memory_order_relaxed) - 1;
+	Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = Top.load(std::memory_order_relaxed);
+	if (top > bottom)
+	{
+		Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = Jobs[bottom & (QUEUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		if (!Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+// Other threads take the oldest job, and give up when another thread took it first
+Job* JobSystem::WorkerQueue::Steal()
+{
+	int64_t top = Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t bottom = Bottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+	{
+		return nullptr;
+	}
+
+	Job* job = Jobs[top & (QUEUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return job;
+}
+
+JobSystem::~JobSystem()
+{
+	Free();
+}
+
+bool JobSystem::Init(uint32_t threadCount)
+{
+	Free();
+
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount == 0)
+	{
+		threadCount = 1;
+	}
+
+	ThreadCount = threadCount;
+	Queues.reset(new WorkerQueue[threadCount]);
+	for (uint32_t threadIndex = 0; threadIndex < threadCount; ++threadIndex)
+	{
+		Queues[threadIndex].RandomState = threadIndex * 2654435761u + 1;
+		Queues[threadIndex].RangeJobs.reset(new Job[RANGE_JOB_CAPACITY]);
+	}
+	CurrentJobThread = JobThread{ this, 0 };
+
+	bQuit.store(false, std::memory_order_relaxed);
+	Workers.reserve(threadCount - 1);
+	for (uint32_t threadIndex = 1; threadIndex < threadCount; ++threadIndex)
+	{
+		Workers.emplace_back(&JobSystem::WorkerMain, this, threadIndex);
+	}
+
+	return true;
+}
+
+void JobSystem::Free()
+{
+	{
+		std::lock_guard<std::mutex> lock(SleepMutex);
+		bQuit.store(true, std::memory_order_release);
+	}
+	WakeCondition.notify_all();
+
+	for (std::thread& worker : Workers)
+	{
+		worker.join();
+	}
+	Workers.clear();
+
+	if (CurrentJobThread.System == this)
+	{
+		CurrentJobThread = JobThread{ nullptr, 0 };
+	}
+	Queues.reset();
+	ThreadCount = 0;
+	QueuedJobCount.store(0, std::memory_order_relaxed);
+}
+
+void JobSystem::Schedule(Job& job)
+{
+	if (job.Counter)
+	{
+		job.Counter->Count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	const uint32_t threadIndex = GetCurrentThreadIndex();
+	if (ThreadCount <= 1)
+	{
+		Execute(job, threadIndex);
+		return;
+	}
+
+	// Counted before it can be stolen, so that the count never drops below the jobs really queued
+	QueuedJobCount.fetch_add(1, std::memory_order_seq_cst);
+	if (!Queues[threadIndex].Push(&job))
+	{
+		QueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+		Execute(job, threadIndex);
+		return;
+	}
+
+	// A sleeping thread counts itself before it checks QueuedJobCount, so one of the two sees the other
+	if (SleepingCount.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> lock(SleepMutex);
+		WakeCondition.notify_one();
+	}
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	const uint32_t threadIndex = GetCurrentThreadIndex();
+	while (!counter.IsDone())
+	{
+		if (Job* job = FindJob(threadIndex))
+		{
+			Execute(*job, threadIndex);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const JobRangeFunction& function)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	batchSize = batchSize > 0 ? batchSize : 1;
+	const uint32_t batchCount = (count - 1) / batchSize + 1;
+	const uint32_t threadIndex = GetCurrentThreadIndex();
+	if (ThreadCount <= 1 || batchCount == 1)
+	{
+		for (uint32_t begin = 0; begin < count; begin += batchSize)
+		{
+			function(begin, count - begin < batchSize ? count : begin + batchSize, threadIndex);
+		}
+		return;
+	}
+
+	// The jobs come from the stack of this thread, so a frame of ParallelFor calls allocates nothing. Batches that do not
+	// fit run here after the first one.
+	WorkerQueue& queue = Queues[threadIndex];
+	const uint32_t firstJob = queue.RangeJobCount;
+	const uint32_t jobCount = batchCount - 1 < RANGE_JOB_CAPACITY - firstJob ? batchCount - 1 : RANGE_JOB_CAPACITY - firstJob;
+	queue.RangeJobCount += jobCount;
+
+	// Pushed last to first, so this thread pops them in order while thieves take the far end
+	JobCounter counter;
+	for (uint32_t batch = jobCount; batch > 0; --batch)
+	{
+		Job& job = queue.RangeJobs[firstJob + batch - 1];
+		job.Range = &function;
+		job.Begin = batch * batchSize;
+		job.End = count - job.Begin < batchSize ? count : job.Begin + batchSize;
+		job.Counter = &counter;
+		Schedule(job);
+	}
+
+	function(0, batchSize, threadIndex);
+	for (uint32_t begin = (jobCount + 1) * batchSize; begin < count; begin += batchSize)
+	{
+		function(begin, count - begin < batchSize ? count : begin + batchSize, threadIndex);
+	}
+	Wait(counter);
+	queue.RangeJobCount = firstJob;
+}
+
+JobSystemStats JobSystem::GetStats() const
+{
+	JobSystemStats stats{};
+	for (uint32_t threadIndex = 0; threadIndex < ThreadCount; ++threadIndex)
+	{
+		stats.JobCount += Queues[threadIndex].JobCount.load(std::memory_order_relaxed);
+		stats.StealCount += Queues[threadIndex].StealCount.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+void JobSystem::ResetStats()
+{
+	for (uint32_t threadIndex = 0; threadIndex < ThreadCount; ++threadIndex)
+	{
+		Queues[threadIndex].JobCount.store(0, std::memory_order_relaxed);
+		Queues[threadIndex].StealCount.store(0, std::memory_order_relaxed);
+	}
+}
+
+void JobSystem::WorkerMain(uint32_t threadIndex)
+{
+	CurrentJobThread = JobThread{ this, threadIndex };
+
+	uint32_t idleCount = 0;
+	while (!bQuit.load(std::memory_order_acquire))
+	{
+		if (Job* job = FindJob(threadIndex))
+		{
+			Execute(*job, threadIndex);
+			idleCount = 0;
+			continue;
+		}
+
+		if (++idleCount < IDLE_SPIN_COUNT)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(SleepMutex);
+		SleepingCount.fetch_add(1, std::memory_order_seq_cst);
+		WakeCondition.wait(lock, [this] { return bQuit.load(std::memory_order_acquire) || QueuedJobCount.load(std::memory_order_seq_cst) > 0; });
+		SleepingCount.fetch_sub(1, std::memory_order_relaxed);
+		idleCount = 0;
+	}
+}
+
+Job* JobSystem::FindJob(uint32_t threadIndex)
+{
+	WorkerQueue& queue = Queues[threadIndex];
+	Job* job = queue.Pop();
+	if (!job && ThreadCount > 1)
+	{
+		// xorshift32
+		uint32_t random = queue.RandomState;
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		queue.RandomState = random;
+
+		const uint32_t firstVictim = random % ThreadCount;
+		for (uint32_t i = 0; i < ThreadCount && !job; ++i)
+		{
+			const uint32_t victim = firstVictim + i < ThreadCount ? firstVictim + i : firstVictim + i - ThreadCount;
+			if (victim != threadIndex)
+			{
+				job = Queues[victim].Steal();
+			}
+		}
+		if (job)
+		{
+			queue.StealCount.store(queue.StealCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	}
+
+	if (job)
+	{
+		QueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+// The job may be gone as soon as its counter is decremented
+void JobSystem::Execute(Job& job, uint32_t threadIndex)
+{
+	JobCounter* counter = job.Counter;
+	if (job.Range)
+	{
+		(*job.Range)(job.Begin, job.End, threadIndex);
+	}
+	else
+	{
+		job.Function(threadIndex);
+	}
+
+	WorkerQueue& queue = Queues[threadIndex];
+	queue.JobCount.store(queue.JobCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	if (counter)
+	{
+		counter->Count.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex() const
+{
+	return CurrentJobThread.System == this ? CurrentJobThread.Index : 0;
+}
+
+uint32_t JobGraph::AddJob(JobFunction function)
+{
+	const uint32_t nodeIndex = (uint32_t)Nodes.size();
+	Nodes.emplace_back();
+	Node& node = Nodes.back();
+	node.Function = std::move(function);
+	node.Work.Function = [this, nodeIndex](uint32_t threadIndex) { RunNode(nodeIndex, threadIndex); };
+	node.Work.Counter = &Counter;
+	return nodeIndex;
+}
+
+bool JobGraph::AddDependency(uint32_t job, uint32_t prerequisite)
+{
+	if (job >= Nodes.size() || prerequisite >= job)
+	{
+		return false;
+	}
+
+	Nodes[prerequisite].Successors.push_back(job);
+	++Nodes[job].DependencyCount;
+	return true;
+}
+
+void JobGraph::Run(JobSystem& jobSystem)
+{
+	if (PendingCounts.size() != Nodes.size())
+	{
+		PendingCounts = std::vector<std::atomic<uint32_t>>(Nodes.size());
+	}
+	for (size_t i = 0; i < Nodes.size(); ++i)
+	{
+		PendingCounts[i].store(Nodes[i].DependencyCount, std::memory_order_relaxed);
+	}
+
+	RunningSystem = &jobSystem;
+	for (Node& node : Nodes)
+	{
+		if (node.DependencyCount == 0)
+		{
+			jobSystem.Schedule(node.Work);
+		}
+	}
+	jobSystem.Wait(Counter);
+	RunningSystem = nullptr;
+}
+
+void JobGraph::Clear()
+{
+	Nodes.clear();
+	PendingCounts.clear();
+}
+
+// Successors are scheduled before the counter of this node goes down, so Run cannot return in between
+void JobGraph::RunNode(uint32_t nodeIndex, uint32_t threadIndex)
+{
+	const Node& node = Nodes[nodeIndex];
+	node.Function(threadIndex);
+	for (uint32_t successor : node.Successors)
+	{
+		if (PendingCounts[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			RunningSystem->Schedule(Nodes[successor].Work);
+		}
+	}
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Jobs counted down by it, Wait returns once it is back at 0. Every Schedule of a job with this counter adds one.
+class JobCounter
+{
+public:
+	bool IsDone() const { return Count.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> Count{ 0 };
+};
+
+using JobFunction = std::function<void(uint32_t threadIndex)>;
+using JobRangeFunction = std::function<void(uint32_t begin, uint32_t end, uint32_t threadIndex)>;
+
+// Runs Function, or Range over [Begin, End) when there is one. Owned by whoever schedules it, and has to stay alive until
+// its counter is done.
+struct Job
+{
+	JobFunction Function;
+	const JobRangeFunction* Range = nullptr;
+	uint32_t Begin = 0;
+	uint32_t End = 0;
+	JobCounter* Counter = nullptr;
+};
+
+struct JobSystemStats
+{
+	uint64_t JobCount;
+
+	// Jobs taken from the queue of another thread
+	uint64_t StealCount;
+};
+
+// Work stealing scheduler over a fixed set of threads. Every thread pushes and pops jobs at the bottom of its own lock-free
+// queue (Chase and Lev, "Dynamic Circular Work-Stealing Deque", with the memory orders of Le et al. 2013) and steals from
+// the top of the others when it runs out, so nested ParallelFor calls and job graphs keep every thread busy without a
+// shared lock. Threads that find nothing spin briefly and then sleep until a job is scheduled.
+// The thread that called Init takes part as thread index 0. Jobs may only be scheduled from it and from inside jobs.
+class JobSystem
+{
+public:
+	JobSystem() = default;
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+	~JobSystem();
+
+	// threadCount includes the calling thread. 0 means one per hardware thread.
+	bool Init(uint32_t threadCount);
+	void Free();
+
+	uint32_t GetThreadCount() const { return ThreadCount; }
+
+	// Queues job on the calling thread, or runs it right away when that queue is full
+	void Schedule(Job& job);
+
+	// Runs queued jobs, stolen ones included, until counter is done
+	void Wait(const JobCounter& counter);
+
+	// Runs function(begin, end, threadIndex) over [0, count) in batches of batchSize and returns when all are done.
+	// The calling thread runs the first batch itself.
+	void ParallelFor(uint32_t count, uint32_t batchSize, const JobRangeFunction& function);
+
+	// Sums over all threads since Init or ResetStats
+	JobSystemStats GetStats() const;
+	void ResetStats();
+
+private:
+	// Power of two, jobs past it run on the thread that schedules them
+	static constexpr uint32_t QUEUE_CAPACITY = 4096;
+
+	// Batch jobs of the ParallelFor calls running on one thread, nested ones included. As with a full queue, batches past it
+	// run on the calling thread.
+	static constexpr uint32_t RANGE_JOB_CAPACITY = QUEUE_CAPACITY;
+
+	struct alignas(64) WorkerQueue
+	{
+		std::atomic<int64_t> Top{ 0 };
+		alignas(64) std::atomic<int64_t> Bottom{ 0 };
+		std::atomic<Job*> Jobs[QUEUE_CAPACITY];
+
+		alignas(64) std::atomic<uint64_t> JobCount{ 0 };
+		std::atomic<uint64_t> StealCount{ 0 };
+		uint32_t RandomState = 1;
+
+		// Only touched by the owner. Every ParallelFor takes its jobs from RangeJobCount up and gives them back before it
+		// returns, so nested calls stack on top of the ones they run inside.
+		std::unique_ptr<Job[]> RangeJobs;
+		uint32_t RangeJobCount = 0;
+
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+	};
+
+	void WorkerMain(uint32_t threadIndex);
+
+	// Own queue first, then the others starting from a random one
+	Job* FindJob(uint32_t threadIndex);
+	void Execute(Job& job, uint32_t threadIndex);
+
+	// Index of the calling thread, which has to belong to this system
+	uint32_t GetCurrentThreadIndex() const;
+
+	uint32_t ThreadCount = 0;
+	std::unique_ptr<WorkerQueue[]> Queues;
+	std::vector<std::thread> Workers;
+
+	// Jobs in any queue, sleeping threads only wake up for these
+	std::atomic<uint32_t> QueuedJobCount{ 0 };
+	std::atomic<uint32_t> SleepingCount{ 0 };
+	std::mutex SleepMutex;
+	std::condition_variable WakeCondition;
+	std::atomic<bool> bQuit{ false };
+};
+
+// Jobs with dependencies between them, built once and run every frame. A job is scheduled when the last of its
+// prerequisites finishes, so independent stages run side by side and every job can still fan out with ParallelFor.
+class JobGraph
+{
+public:
+	// Returns the id to refer to the job by
+	uint32_t AddJob(JobFunction function);
+
+	// job does not start before prerequisite is done. Both are ids from AddJob, and prerequisite has to be added first,
+	// which keeps the graph free of cycles. Returns false otherwise.
+	bool AddDependency(uint32_t job, uint32_t prerequisite);
+
+	// Runs every job once and returns when all of them are done
+	void Run(JobSystem& jobSystem);
+
+	void Clear();
+
+	uint32_t GetJobCount() const { return (uint32_t)Nodes.size(); }
+
+private:
+	struct Node
+	{
+		JobFunction Function;
+		Job Work;
+		std::vector<uint32_t> Successors;
+		uint32_t DependencyCount = 0;
+	};
+
+	void RunNode(uint32_t nodeIndex, uint32_t threadIndex);
+
+	std::vector<Node> Nodes;
+
+	// Prerequisites of every node still running in this Run
+	std::vector<std::atomic<uint32_t>> PendingCounts;
+	JobSystem* RunningSystem = nullptr;
+	JobCounter Counter;
+};
@@ -0,0 +1,249 @@
+#include "JsonDocument.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool JsonDocument::Parse(const char* text, size_t size)
+{
+	Values.clear();
+	Cursor = text;
+	End = text + size;
+
+	// Headers hold about one value per 16 characters
+	Values.reserve(size / 16 + 1);
+
+	if (ParseValue(0) == JSON_NONE)
+	{
+		Values.clear();
+		return false;
+	}
+
+	SkipWhitespace();
+	return Cursor == End;
+}
+
+const JsonValue* JsonDocument::Find(const JsonValue* value, const char* key) const
+{
+	if (!value || value->Type != JSON_TYPE_OBJECT)
+	{
+		return nullptr;
+	}
+
+	const size_t keyLength = strlen(key);
+	for (const JsonValue* child = GetFirstChild(value); child; child = GetNextSibling(child))
+	{
+		if (child->KeyLength == keyLength && !memcmp(child->Key, key, keyLength))
+		{
+			return child;
+		}
+	}
+	return nullptr;
+}
+
+const JsonValue* JsonDocument::At(const JsonValue* value, uint32_t index) const
+{
+	if (!value || value->Type != JSON_TYPE_ARRAY || index >= value->ChildCount)
+	{
+		return nullptr;
+	}
+
+	const JsonValue* child = GetFirstChild(value);
+	for (uint32_t i = 0; i < index; ++i)
+	{
+		child = GetNextSibling(child);
+	}
+	return child;
+}
+
+double JsonDocument::GetNumber(const JsonValue* value, const char* key, double defaultValue) const
+{
+	const JsonValue* member = Find(value, key);
+	return member && member->Type == JSON_TYPE_NUMBER ? member->Number : defaultValue;
+}
+
+uint32_t JsonDocument::GetUint(const JsonValue* value, const char* key, uint32_t defaultValue) const
+{
+	const double number = GetNumber(value, key, -1.0);
+	return number >= 0.0 && number <= UINT32_MAX ? (uint32_t)number : defaultValue;
+}
+
+bool JsonDocument::GetUint64(const JsonValue* value, const char* key, uint64_t defaultValue, uint64_t& outValue) const
+{
+	const JsonValue* member = Find(value, key);
+	if (!member)
+	{
+		outValue = defaultValue;
+		return true;
+	}
+
+	const double number = member->Type == JSON_TYPE_NUMBER ? member->Number : -1.0;
+	if (!(number >= 0.0 && number <= 9007199254740992.0) || floor(number) != number)
+	{
+		return false;
+	}
+	outValue = (uint64_t)number;
+	return true;
+}
+
+bool JsonDocument::IsString(const JsonValue* value, const char* text)
+{
+	const size_t length = strlen(text);
+	return value && value->Type == JSON_TYPE_STRING && value->StringLength == length && !memcmp(value->String, text, length);
+}
+
+// Appends the value at the cursor and its children, returns its index
+uint32_t JsonDocument::ParseValue(uint32_t depth)
+{
+	SkipWhitespace();
+	if (Cursor == End || depth > JSON_MAX_DEPTH)
+	{
+		return JSON_NONE;
+	}
+
+	const uint32_t index = (uint32_t)Values.size();
+	Values.push_back({ JSON_TYPE_NULL, 0, JSON_NONE, JSON_NONE, 0.0, nullptr, 0, nullptr, 0 });
+
+	const char c = *Cursor;
+	if (c == '{' || c == '[')
+	{
+		const bool bObject = c == '{';
+		const char close = bObject ? '}' : ']';
+		Values[index].Type = bObject ? JSON_TYPE_OBJECT : JSON_TYPE_ARRAY;
+		++Cursor;
+
+		SkipWhitespace();
+		if (Cursor < End && *Cursor == close)
+		{
+			++Cursor;
+			return index;
+		}
+
+		uint32_t previous = JSON_NONE;
+		for (;;)
+		{
+			const char* key = nullptr;
+			uint32_t keyLength = 0;
+			if (bObject)
+			{
+				SkipWhitespace();
+				if (!ParseString(key, keyLength))
+				{
+					return JSON_NONE;
+				}
+				SkipWhitespace();
+				if (Cursor == End || *Cursor != ':')
+				{
+					return JSON_NONE;
+				}
+				++Cursor;
+			}
+
+			// Values may move while the child is parsed, so only indices are kept across the call
+			const uint32_t child = ParseValue(depth + 1);
+			if (child == JSON_NONE)
+			{
+				return JSON_NONE;
+			}
+			Values[child].Key = key;
+			Values[child].KeyLength = keyLength;
+			if (previous == JSON_NONE)
+			{
+				Values[index].FirstChild = child;
+			}
+			else
+			{
+				Values[previous].NextSibling = child;
+			}
+			previous = child;
+			++Values[index].ChildCount;
+
+			SkipWhitespace();
+			if (Cursor == End)
+			{
+				return JSON_NONE;
+			}
+			if (*Cursor == ',')
+			{
+				++Cursor;
+				continue;
+			}
+			if (*Cursor != close)
+			{
+				return JSON_NONE;
+			}
+			++Cursor;
+			return index;
+		}
+	}
+
+	if (c == '"')
+	{
+		Values[index].Type = JSON_TYPE_STRING;
+		return ParseString(Values[index].String, Values[index].StringLength) ? index : JSON_NONE;
+	}
+
+	struct Literal
+	{
+		const char* Text;
+		JSON_TYPE Type;
+	};
+	static const Literal LITERALS[]{ { "null", JSON_TYPE_NULL }, { "false", JSON_TYPE_FALSE }, { "true", JSON_TYPE_TRUE } };
+	for (const Literal& literal : LITERALS)
+	{
+		const size_t length = strlen(literal.Text);
+		if ((size_t)(End - Cursor) >= length && !memcmp(Cursor, literal.Text, length))
+		{
+			Values[index].Type = literal.Type;
+			Cursor += length;
+			return index;
+		}
+	}
+
+	// strtod stops at the first character that is not part of the number, the closing text of the document always follows
+	if (c == '-' || (c >= '0' && c <= '9'))
+	{
+		char* numberEnd = nullptr;
+		Values[index].Type = JSON_TYPE_NUMBER;
+		Values[index].Number = strtod(Cursor, &numberEnd);
+		if (numberEnd == Cursor || numberEnd > End)
+		{
+			return JSON_NONE;
+		}
+		Cursor = numberEnd;
+		return index;
+	}
+
+	return JSON_NONE;
+}
+
+bool JsonDocument::ParseString(const char*& outString, uint32_t& outLength)
+{
+	if (Cursor == End || *Cursor != '"')
+	{
+		return false;
+	}
+
+	const char* start = ++Cursor;
+	while (Cursor < End && *Cursor != '"')
+	{
+		Cursor += *Cursor == '\\' ? 2 : 1;
+	}
+	if (Cursor >= End)
+	{
+		return false;
+	}
+
+	outString = start;
+	outLength = (uint32_t)(Cursor - start);
+	++Cursor;
+	return true;
+}
+
+void JsonDocument::SkipWhitespace()
+{
+	while (Cursor < End && (*Cursor == ' ' || *Cursor == '\t' || *Cursor == '\n' || *Cursor == '\r'))
+	{
+		++Cursor;
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+enum JSON_TYPE : uint8_t
+{
+	JSON_TYPE_NULL,
+	JSON_TYPE_FALSE,
+	JSON_TYPE_TRUE,
+	JSON_TYPE_NUMBER,
+	JSON_TYPE_STRING,
+	JSON_TYPE_ARRAY,
+	JSON_TYPE_OBJECT
+};
+
+constexpr uint32_t JSON_NONE = UINT32_MAX;
+
+// One value of a JsonDocument. Children of an array or object are linked through NextSibling, object members carry their key.
+// Strings and keys point into the parsed text without their quotes, escape sequences are left as they are.
+struct JsonValue
+{
+	JSON_TYPE Type;
+	uint32_t ChildCount;
+	uint32_t FirstChild;
+	uint32_t NextSibling;
+	double Number;
+	const char* String;
+	uint32_t StringLength;
+	const char* Key;
+	uint32_t KeyLength;
+};
+
+// Parses JSON text in place into one array of values, without an allocation per value.
+// The text must outlive the document. Only what glTF needs for its headers is kept: numbers are doubles and strings are not unescaped.
+class JsonDocument
+{
+public:
+	// Fails on malformed text and on nesting deeper than JSON_MAX_DEPTH
+	bool Parse(const char* text, size_t size);
+
+	const JsonValue* GetRoot() const { return Values.empty() ? nullptr : &Values[0]; }
+
+	// Member of an object by key, or null when value is not an object or has no such member
+	const JsonValue* Find(const JsonValue* value, const char* key) const;
+
+	// Element of an array, or null past its end
+	const JsonValue* At(const JsonValue* value, uint32_t index) const;
+
+	const JsonValue* GetFirstChild(const JsonValue* value) const { return value->FirstChild == JSON_NONE ? nullptr : &Values[value->FirstChild]; }
+	const JsonValue* GetNextSibling(const JsonValue* value) const { return value->NextSibling == JSON_NONE ? nullptr : &Values[value->NextSibling]; }
+
+	// Number members with a default when they are missing or of another type
+	double GetNumber(const JsonValue* value, const char* key, double defaultValue) const;
+	uint32_t GetUint(const JsonValue* value, const char* key, uint32_t defaultValue) const;
+
+	// Byte offsets and sizes: defaultValue when the member is missing, false when it is not a whole number from 0 to 2^53,
+	// the largest that a double holds exactly
+	bool GetUint64(const JsonValue* value, const char* key, uint64_t defaultValue, uint64_t& outValue) const;
+
+	static bool IsString(const JsonValue* value, const char* text);
+
+private:
+	static constexpr uint32_t JSON_MAX_DEPTH = 64;
+
+	uint32_t ParseValue(uint32_t depth);
+	bool ParseString(const char*& outString, uint32_t& outLength);
+	void SkipWhitespace();
+
+	std::vector<JsonValue> Values;
+	const char* Cursor = nullptr;
+	const char* End = nullptr;
+};
@@ -0,0 +1,76 @@
+#include "LodSelection.h"
+
+#include <math.h>
+#include <string.h>
+
+void LodSelector::Init(const float* maxRadii, uint32_t levelCount, uint32_t objectCount, float hysteresis)
+{
+	LevelCount = levelCount < MAX_LOD_COUNT ? levelCount : MAX_LOD_COUNT;
+	memcpy(MaxRadii, maxRadii, LevelCount * sizeof(float));
+	Hysteresis = hysteresis;
+
+	Levels.assign(objectCount, (uint8_t)(LevelCount - 1));
+	SortedIndices.resize(objectCount);
+}
+
+void LodSelector::Update(const SphereBoundsArrays& bounds, const uint32_t* indices, uint32_t count, const Float3& cameraPosition, float projectionScale)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t index = indices[i];
+		const float dx = bounds.CenterX[index] - cameraPosition.x;
+		const float dy = bounds.CenterY[index] - cameraPosition.y;
+		const float dz = bounds.CenterZ[index] - cameraPosition.z;
+		const float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+
+		// The camera is inside the sphere
+		const float radius = bounds.Radius[index];
+		if (distance <= radius)
+		{
+			Levels[index] = 0;
+			continue;
+		}
+
+		// Stay while the level fits both a slightly larger and a slightly smaller object, otherwise move to the closest one that does
+		const float projectedRadius = radius * projectionScale / distance;
+		const uint32_t finestLevel = SelectLevel(projectedRadius * (1.0f + Hysteresis));
+		const uint32_t coarsestLevel = SelectLevel(projectedRadius * (1.0f - Hysteresis));
+
+		uint32_t level = Levels[index];
+		level = level < finestLevel ? finestLevel : level;
+		level = level > coarsestLevel ? coarsestLevel : level;
+		Levels[index] = (uint8_t)level;
+	}
+}
+
+void LodSelector::SortByLevel(uint32_t* indices, uint32_t count, uint32_t* outLevelCounts)
+{
+	// Counting sort
+	uint32_t levelOffsets[MAX_LOD_COUNT]{};
+	memset(outLevelCounts, 0, LevelCount * sizeof(uint32_t));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		++outLevelCounts[Levels[indices[i]]];
+	}
+
+	for (uint32_t level = 1; level < LevelCount; ++level)
+	{
+		levelOffsets[level] = levelOffsets[level - 1] + outLevelCounts[level - 1];
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		SortedIndices[levelOffsets[Levels[indices[i]]]++] = indices[i];
+	}
+	memcpy(indices, SortedIndices.data(), count * sizeof(uint32_t));
+}
+
+uint32_t LodSelector::SelectLevel(float projectedRadius) const
+{
+	uint32_t level = LevelCount - 1;
+	while (level > 0 && projectedRadius > MaxRadii[level])
+	{
+		--level;
+	}
+	return level;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "BoundingVolumes.h"
+#include "MathTypes.h"
+
+constexpr uint32_t MAX_LOD_COUNT = 8;
+
+// Objects per level of detail and the triangles they add up to, for the frame counters
+struct LodStats
+{
+	uint32_t LevelCount;
+	uint32_t ObjectCounts[MAX_LOD_COUNT];
+	uint64_t TriangleCount;
+};
+
+// Picks a level of detail per object from the projected radius of its bounding sphere. Level 0 is the most detailed.
+// Every object remembers its level, and only moves to another one once its radius is a hysteresis fraction past
+// the threshold between them, so objects near a threshold do not switch back and forth.
+class LodSelector
+{
+public:
+	// maxRadii[i] is the largest projected radius in pixels that level i is detailed enough for, decreasing with i.
+	// Objects start at the coarsest level.
+	void Init(const float* maxRadii, uint32_t levelCount, uint32_t objectCount, float hysteresis);
+
+	// Updates the levels of objects indices[0..count). projectionScale turns radius / distance into pixels,
+	// it is half the viewport height over tan(fovY / 2).
+	void Update(const SphereBoundsArrays& bounds, const uint32_t* indices, uint32_t count, const Float3& cameraPosition, float projectionScale);
+
+	// Reorders indices[0..count) by level, most detailed first and keeping the order inside a level.
+	// outLevelCounts receives the number of objects of every level.
+	void SortByLevel(uint32_t* indices, uint32_t count, uint32_t* outLevelCounts);
+
+	uint32_t GetLevel(uint32_t objectIndex) const { return Levels[objectIndex]; }
+	uint32_t GetLevelCount() const { return LevelCount; }
+
+private:
+	// Coarsest level detailed enough for a projected radius
+	uint32_t SelectLevel(float projectedRadius) const;
+
+	float MaxRadii[MAX_LOD_COUNT]{};
+	uint32_t LevelCount = 0;
+	float Hysteresis = 0.0f;
+
+	std::vector<uint8_t> Levels;
+	std::vector<uint32_t> SortedIndices;
+};
@@ -0,0 +1,150 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char* fileName)
+{
+	Close();
+
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || (uint64_t)fileSize.QuadPart > SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	FileHandle = file;
+	MappingHandle = mapping;
+	Data = (const uint8_t*)data;
+	Size = (uint64_t)fileSize.QuadPart;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data)
+	{
+		UnmapViewOfFile(Data);
+	}
+	if (MappingHandle)
+	{
+		CloseHandle(MappingHandle);
+	}
+	if (FileHandle)
+	{
+		CloseHandle(FileHandle);
+	}
+
+	Data = nullptr;
+	Size = 0;
+	MappingHandle = nullptr;
+	FileHandle = nullptr;
+}
+
+// The cache manager drops the cached pages of a file when it is opened without buffering while no other handle is open
+bool MappedFile::EvictFromFileCache(const char* fileName)
+{
+	HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	CloseHandle(file);
+	return true;
+}
+
+#else
+
+bool MappedFile::Open(const char* fileName)
+{
+	Close();
+
+	const int file = open(fileName, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0 || fileStatus.st_size <= 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file
+	void* data = mmap(nullptr, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+
+	Data = (const uint8_t*)data;
+	Size = (uint64_t)fileStatus.st_size;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (Data)
+	{
+		munmap((void*)Data, (size_t)Size);
+	}
+
+	Data = nullptr;
+	Size = 0;
+}
+
+bool MappedFile::EvictFromFileCache(const char* fileName)
+{
+	const int file = open(fileName, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	const bool bEvicted = posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(file);
+	return bEvicted;
+}
+
+#endif // _WIN32
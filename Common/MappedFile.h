@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+// Read-only view of a whole file mapped into memory (MapViewOfFile on Windows, mmap elsewhere).
+// Pages are read from disk on first access, or shared with the file cache when it already holds them.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	// Fails on missing and empty files
+	bool Open(const char* fileName);
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; }
+	const uint8_t* GetData() const { return Data; }
+	uint64_t GetSize() const { return Size; }
+
+	// Asks the OS to drop the cached pages of a file that nobody has open, so that the next open reads from disk.
+	// Best effort, returns false where it is not supported.
+	static bool EvictFromFileCache(const char* fileName);
+
+private:
+	const uint8_t* Data = nullptr;
+	uint64_t Size = 0;
+
+#ifdef _WIN32
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#endif // _WIN32
+};
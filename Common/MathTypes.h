@@ -0,0 +1,267 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// Portable subset of DirectXMath so that scene code can run without the Windows SDK.
+// Matrices are row-major and vectors are row vectors (v * M), the same convention as XMMATRIX.
+
+constexpr float PI = 3.141592654f;
+constexpr float TWO_PI = 6.283185307f;
+
+constexpr float ConvertToRadians(float degrees) { return degrees * (PI / 180.0f); }
+
+// Double precision sine, cosine and square root that also run at compile time, for meshes baked by PrimitiveMeshes.h.
+// The angle is reduced into [-pi / 2, pi / 2] by a multiple of pi and the Taylor series is summed up to x^23,
+// which leaves an error of about 1e-16 for the angles of a full turn.
+constexpr double ConstexprSin(double x)
+{
+	constexpr double pi = 3.14159265358979323846;
+	const double turns = x / pi;
+	const int64_t halfTurnCount = (int64_t)(turns < 0.0 ? turns - 0.5 : turns + 0.5);
+	const double reduced = x - (double)halfTurnCount * pi;
+	const double squared = reduced * reduced;
+
+	double term = reduced;
+	double sum = reduced;
+	for (int32_t n = 1; n <= 11; ++n)
+	{
+		term *= -squared / (double)((2 * n) * (2 * n + 1));
+		sum += term;
+	}
+	return halfTurnCount & 1 ? -sum : sum;
+}
+
+constexpr double ConstexprCos(double x)
+{
+	constexpr double pi = 3.14159265358979323846;
+	const double turns = x / pi;
+	const int64_t halfTurnCount = (int64_t)(turns < 0.0 ? turns - 0.5 : turns + 0.5);
+	const double reduced = x - (double)halfTurnCount * pi;
+	const double squared = reduced * reduced;
+
+	double term = 1.0;
+	double sum = 1.0;
+	for (int32_t n = 1; n <= 11; ++n)
+	{
+		term *= -squared / (double)((2 * n - 1) * (2 * n));
+		sum += term;
+	}
+	return halfTurnCount & 1 ? -sum : sum;
+}
+
+// Newton iteration from above, which decreases until it reaches the root
+constexpr double ConstexprSqrt(double x)
+{
+	if (!(x > 0.0))
+	{
+		return 0.0;
+	}
+
+	double root = x > 1.0 ? x : 1.0;
+	for (;;)
+	{
+		const double next = 0.5 * (root + x / root);
+		if (!(next < root))
+		{
+			return root;
+		}
+		root = next;
+	}
+}
+
+struct Float2
+{
+	float x;
+	float y;
+};
+
+struct Float3
+{
+	float x;
+	float y;
+	float z;
+};
+
+struct Float4
+{
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+struct Float4x4
+{
+	float m[4][4];
+};
+
+inline Float3 operator+(const Float3& a, const Float3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Float3 operator-(const Float3& a, const Float3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Float3 operator-(const Float3& a) { return { -a.x, -a.y, -a.z }; }
+inline Float3 operator*(const Float3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+inline Float3 operator*(float s, const Float3& a) { return { a.x * s, a.y * s, a.z * s }; }
+inline Float3& operator+=(Float3& a, const Float3& b) { a = a + b; return a; }
+inline Float3& operator-=(Float3& a, const Float3& b) { a = a - b; return a; }
+
+inline float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Float3 Cross(const Float3& a, const Float3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+inline float Length(const Float3& a) { return sqrtf(Dot(a, a)); }
+
+inline Float3 Normalize(const Float3& a)
+{
+	const float length = Length(a);
+	return length > 0.0f ? a * (1.0f / length) : a;
+}
+
+inline float Dot(const Float4& a, const Float4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline Float4 ToFloat4(const Float3& a, float w) { return { a.x, a.y, a.z, w }; }
+inline Float3 ToFloat3(const Float4& a) { return { a.x, a.y, a.z }; }
+
+inline Float4x4 MatrixIdentity()
+{
+	return { { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } } };
+}
+
+inline Float4x4 MatrixMultiply(const Float4x4& a, const Float4x4& b)
+{
+	Float4x4 result;
+	for (int32_t row = 0; row < 4; ++row)
+	{
+		for (int32_t column = 0; column < 4; ++column)
+		{
+			result.m[row][column] =
+				a.m[row][0] * b.m[0][column] +
+				a.m[row][1] * b.m[1][column] +
+				a.m[row][2] * b.m[2][column] +
+				a.m[row][3] * b.m[3][column];
+		}
+	}
+	return result;
+}
+
+inline Float4x4 operator*(const Float4x4& a, const Float4x4& b) { return MatrixMultiply(a, b); }
+
+inline Float4x4 MatrixTranspose(const Float4x4& a)
+{
+	Float4x4 result;
+	for (int32_t row = 0; row < 4; ++row)
+	{
+		for (int32_t column = 0; column < 4; ++column)
+		{
+			result.m[row][column] = a.m[column][row];
+		}
+	}
+	return result;
+}
+
+inline Float4x4 MatrixTranslation(float x, float y, float z)
+{
+	Float4x4 result = MatrixIdentity();
+	result.m[3][0] = x;
+	result.m[3][1] = y;
+	result.m[3][2] = z;
+	return result;
+}
+
+inline Float4x4 MatrixScaling(float x, float y, float z)
+{
+	Float4x4 result = MatrixIdentity();
+	result.m[0][0] = x;
+	result.m[1][1] = y;
+	result.m[2][2] = z;
+	return result;
+}
+
+inline Float4x4 MatrixRotationY(float angle)
+{
+	const float sinAngle = sinf(angle);
+	const float cosAngle = cosf(angle);
+
+	Float4x4 result = MatrixIdentity();
+	result.m[0][0] = cosAngle;
+	result.m[0][2] = -sinAngle;
+	result.m[2][0] = sinAngle;
+	result.m[2][2] = cosAngle;
+	return result;
+}
+
+inline Float4x4 MatrixLookAtLH(const Float3& eyePosition, const Float3& focusPosition, const Float3& upDirection)
+{
+	const Float3 zAxis = Normalize(focusPosition - eyePosition);
+	const Float3 xAxis = Normalize(Cross(upDirection, zAxis));
+	const Float3 yAxis = Cross(zAxis, xAxis);
+
+	return { {
+		{ xAxis.x, yAxis.x, zAxis.x, 0.0f },
+		{ xAxis.y, yAxis.y, zAxis.y, 0.0f },
+		{ xAxis.z, yAxis.z, zAxis.z, 0.0f },
+		{ -Dot(xAxis, eyePosition), -Dot(yAxis, eyePosition), -Dot(zAxis, eyePosition), 1.0f }
+	} };
+}
+
+inline Float4x4 MatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+{
+	const float height = 1.0f / tanf(0.5f * fovAngleY);
+	const float width = height / aspectRatio;
+	const float range = farZ / (farZ - nearZ);
+
+	return { {
+		{ width, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, height, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, range, 1.0f },
+		{ 0.0f, 0.0f, -range * nearZ, 0.0f }
+	} };
+}
+
+inline Float4 TransformFloat4(const Float4& v, const Float4x4& m)
+{
+	return {
+		v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + v.w * m.m[3][0],
+		v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + v.w * m.m[3][1],
+		v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + v.w * m.m[3][2],
+		v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + v.w * m.m[3][3]
+	};
+}
+
+inline Float4 TransformCoord(const Float3& v, const Float4x4& m)
+{
+	return TransformFloat4(ToFloat4(v, 1.0f), m);
+}
+
+// Same as mul(v, (float3x3)m) in HLSL
+inline Float3 TransformNormal(const Float3& v, const Float4x4& m)
+{
+	return {
+		v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
+		v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
+		v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2]
+	};
+}
+
+// Quaternions are stored as Float4 (x, y, z, w)
+inline Float4 QuaternionRotationAxis(const Float3& axis, float angle)
+{
+	const Float3 normal = Normalize(axis);
+	const float sinHalfAngle = sinf(0.5f * angle);
+	const float cosHalfAngle = cosf(0.5f * angle);
+	return { normal.x * sinHalfAngle, normal.y * sinHalfAngle, normal.z * sinHalfAngle, cosHalfAngle };
+}
+
+// Same order as XMQuaternionMultiply: the result rotates by q1 and then by q2
+inline Float4 QuaternionMultiply(const Float4& q1, const Float4& q2)
+{
+	return {
+		q2.w * q1.x + q2.x * q1.w + q2.y * q1.z - q2.z * q1.y,
+		q2.w * q1.y - q2.x * q1.z + q2.y * q1.w + q2.z * q1.x,
+		q2.w * q1.z + q2.x * q1.y - q2.y * q1.x + q2.z * q1.w,
+		q2.w * q1.w - q2.x * q1.x - q2.y * q1.y - q2.z * q1.z
+	};
+}
+
+inline Float3 Vector3Rotate(const Float3& v, const Float4& rotation)
+{
+	const Float4 conjugate{ -rotation.x, -rotation.y, -rotation.z, rotation.w };
+	return ToFloat3(QuaternionMultiply(QuaternionMultiply(conjugate, ToFloat4(v, 0.0f)), rotation));
+}
@@ -0,0 +1,464 @@
+#include "MeshCache.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Clock.h"
+#include "MeshCodec.h"
+#include "PrimitiveMeshes.h"
+
+namespace
+{
+	constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+	constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+	uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+	{
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash = (hash ^ bytes[i]) * FNV_PRIME;
+		}
+		return hash;
+	}
+
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + MESH_CACHE_ALIGNMENT - 1) / MESH_CACHE_ALIGNMENT * MESH_CACHE_ALIGNMENT;
+	}
+
+	// fopen is deprecated under the SDL checks of the windowed samples, which compile this file too
+	FILE* OpenFileForWriting(const char* fileName)
+	{
+#ifdef _WIN32
+		FILE* file = nullptr;
+		return fopen_s(&file, fileName, "wb") == 0 ? file : nullptr;
+#else
+		return fopen(fileName, "wb");
+#endif // _WIN32
+	}
+
+	bool IsSectionInsideFile(const MeshCacheSection& section, uint64_t fileSize)
+	{
+		return section.Offset % MESH_CACHE_ALIGNMENT == 0 && section.Offset >= sizeof(MeshCacheHeader) && section.Offset <= fileSize
+			&& section.Size <= fileSize - section.Offset;
+	}
+
+	bool IsValidSection(const MeshCacheSection& section, uint64_t expectedSize, uint64_t fileSize)
+	{
+		return section.Size == expectedSize && IsSectionInsideFile(section, fileSize);
+	}
+
+	// Encoded sizes are only known from the streams, which checks them while decoding
+	bool IsValidEncodedSection(const MeshCacheSection& section, bool bPresent, uint64_t fileSize)
+	{
+		return (section.Size != 0) == bPresent && IsSectionInsideFile(section, fileSize);
+	}
+
+	// Every index of a level has to name one of its vertices, as the CPU users index arrays of VertexCount with them
+	template <typename Index>
+	bool AreLodIndicesValid(const Index* indices, const MeshLod* lods, uint32_t lodCount)
+	{
+		for (uint32_t level = 0; level < lodCount; ++level)
+		{
+			const MeshLod& lod = lods[level];
+			Index maxIndex = 0;
+			for (uint32_t i = lod.StartIndex; i < lod.StartIndex + lod.IndexCount; ++i)
+			{
+				maxIndex = indices[i] > maxIndex ? indices[i] : maxIndex;
+			}
+			if (lod.IndexCount > 0 && maxIndex >= lod.VertexCount)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Meshlets one level after the other, every one whole triangles inside its level
+	bool AreMeshletsValid(const MeshCacheHeader& header, const MeshLod* lods, const uint32_t* meshletLodCounts, const MeshletRecord* meshlets)
+	{
+		uint32_t meshletIndex = 0;
+		for (uint32_t level = 0; level < header.MeshletLodCount; ++level)
+		{
+			const MeshLod& lod = lods[level];
+			if (meshletLodCounts[level] > header.MeshletCount - meshletIndex)
+			{
+				return false;
+			}
+
+			for (const uint32_t end = meshletIndex + meshletLodCounts[level]; meshletIndex < end; ++meshletIndex)
+			{
+				const MeshletRecord& meshlet = meshlets[meshletIndex];
+				if (meshlet.IndexCount % 3 != 0 || meshlet.StartIndex < lod.StartIndex
+					|| (uint64_t)meshlet.StartIndex + meshlet.IndexCount > (uint64_t)lod.StartIndex + lod.IndexCount)
+				{
+					return false;
+				}
+			}
+		}
+		return meshletIndex == header.MeshletCount;
+	}
+}
+
+MeshCacheView MeshCacheData::GetView() const
+{
+	MeshCacheView view;
+	view.Vertices = Vertices.data();
+	view.QuantizedVertices = QuantizedVertices.empty() ? nullptr : QuantizedVertices.data();
+	view.VertexCount = (uint32_t)Vertices.size();
+	view.Quantization = Quantization;
+	view.QuantizationError = QuantizationError;
+	view.Indices = Indices.GetData();
+	view.IndexFormat = Indices.Format;
+	view.IndexCount = Indices.GetCount();
+	view.Lods = Lods.data();
+	view.LodCount = (uint32_t)Lods.size();
+	view.MeshletIndices = MeshletLodCounts.empty() ? nullptr : MeshletIndices.GetData();
+	view.MeshletLodCounts = MeshletLodCounts.empty() ? nullptr : MeshletLodCounts.data();
+	view.MeshletLodCount = (uint32_t)MeshletLodCounts.size();
+	view.Meshlets = Meshlets.empty() ? nullptr : Meshlets.data();
+	view.MeshletCount = (uint32_t)Meshlets.size();
+	return view;
+}
+
+bool MeshCache::Open(const char* fileName, uint64_t sourceKey)
+{
+	Close();
+
+	if (!File.Open(fileName) || File.GetSize() < sizeof(MeshCacheHeader))
+	{
+		File.Close();
+		return false;
+	}
+
+	// The header, the level table and the indices are read, the vertices are left to the page faults of their users unless they are compressed
+	const MeshCacheHeader* header = (const MeshCacheHeader*)File.GetData();
+	const uint64_t fileSize = File.GetSize();
+	bool bValid = header->Magic == MESH_CACHE_MAGIC && header->Version == MESH_CACHE_VERSION && header->SourceKey == sourceKey
+		&& header->FileSize == fileSize && header->VertexSize == sizeof(VertexData) && header->QuantizedVertexSize == sizeof(QuantizedVertexData)
+		&& header->LodSize == sizeof(MeshLod) && header->MeshletSize == sizeof(MeshletRecord) && header->VertexCount > 0 && header->IndexCount > 0
+		&& (header->IndexFormat == INDEX_FORMAT_UINT16 || header->IndexFormat == INDEX_FORMAT_UINT32) && header->MeshletLodCount <= header->LodCount;
+	if (bValid)
+	{
+		const uint64_t indexSize = header->IndexFormat == INDEX_FORMAT_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		const MeshCacheSection* sections = header->Sections;
+		const bool bQuantized = sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES].Size != 0;
+		const uint64_t quantizedSize = bQuantized ? (uint64_t)header->VertexCount * sizeof(QuantizedVertexData) : 0;
+		const bool bMeshlets = header->MeshletLodCount > 0;
+		if (header->Compression == MESH_CACHE_COMPRESSION_CODEC)
+		{
+			bValid = header->IndexCount % 3 == 0 && IsValidEncodedSection(sections[MESH_CACHE_SECTION_VERTICES], true, fileSize)
+				&& IsValidEncodedSection(sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES], bQuantized, fileSize)
+				&& IsValidEncodedSection(sections[MESH_CACHE_SECTION_INDICES], true, fileSize)
+				&& IsValidEncodedSection(sections[MESH_CACHE_SECTION_MESHLET_INDICES], bMeshlets, fileSize);
+		}
+		else
+		{
+			bValid = header->Compression == MESH_CACHE_COMPRESSION_NONE
+				&& IsValidSection(sections[MESH_CACHE_SECTION_VERTICES], (uint64_t)header->VertexCount * sizeof(VertexData), fileSize)
+				&& IsValidSection(sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES], quantizedSize, fileSize)
+				&& IsValidSection(sections[MESH_CACHE_SECTION_INDICES], header->IndexCount * indexSize, fileSize)
+				&& IsValidSection(sections[MESH_CACHE_SECTION_MESHLET_INDICES], bMeshlets ? header->IndexCount * indexSize : 0, fileSize);
+		}
+		bValid = bValid && IsValidSection(sections[MESH_CACHE_SECTION_LODS], (uint64_t)header->LodCount * sizeof(MeshLod), fileSize)
+			&& IsValidSection(sections[MESH_CACHE_SECTION_MESHLET_LOD_COUNTS], (uint64_t)header->MeshletLodCount * sizeof(uint32_t), fileSize)
+			&& IsValidSection(sections[MESH_CACHE_SECTION_MESHLETS], (uint64_t)header->MeshletCount * sizeof(MeshletRecord), fileSize);
+	}
+	if (bValid)
+	{
+		const MeshLod* lods = (const MeshLod*)(File.GetData() + header->Sections[MESH_CACHE_SECTION_LODS].Offset);
+		for (uint32_t i = 0; i < header->LodCount && bValid; ++i)
+		{
+			bValid = lods[i].BaseVertex >= 0 && (uint64_t)lods[i].BaseVertex + lods[i].VertexCount <= header->VertexCount
+				&& (uint64_t)lods[i].StartIndex + lods[i].IndexCount <= header->IndexCount;
+		}
+		bValid = bValid && AreMeshletsValid(*header, lods, (const uint32_t*)(File.GetData() + header->Sections[MESH_CACHE_SECTION_MESHLET_LOD_COUNTS].Offset),
+			(const MeshletRecord*)(File.GetData() + header->Sections[MESH_CACHE_SECTION_MESHLETS].Offset));
+	}
+
+	if (bValid && header->Compression == MESH_CACHE_COMPRESSION_CODEC)
+	{
+		bValid = Decode(*header);
+	}
+
+	if (bValid)
+	{
+		const MeshLod* lods = (const MeshLod*)(File.GetData() + header->Sections[MESH_CACHE_SECTION_LODS].Offset);
+		const bool bCompressed = header->Compression == MESH_CACHE_COMPRESSION_CODEC;
+		const void* indices = bCompressed ? Decoded.Indices.GetData() : File.GetData() + header->Sections[MESH_CACHE_SECTION_INDICES].Offset;
+		const void* meshletIndices = bCompressed ? Decoded.MeshletIndices.GetData() : File.GetData() + header->Sections[MESH_CACHE_SECTION_MESHLET_INDICES].Offset;
+		bValid = header->IndexFormat == INDEX_FORMAT_UINT16
+			? AreLodIndicesValid((const uint16_t*)indices, lods, header->LodCount) && AreLodIndicesValid((const uint16_t*)meshletIndices, lods, header->MeshletLodCount)
+			: AreLodIndicesValid((const uint32_t*)indices, lods, header->LodCount) && AreLodIndicesValid((const uint32_t*)meshletIndices, lods, header->MeshletLodCount);
+	}
+
+	if (!bValid)
+	{
+		Decoded = MeshCacheData{};
+		File.Close();
+		return false;
+	}
+
+	Header = header;
+	return true;
+}
+
+void MeshCache::Close()
+{
+	Header = nullptr;
+	Decoded = MeshCacheData{};
+	DecodeMilliseconds = 0.0;
+	File.Close();
+}
+
+bool MeshCache::Decode(const MeshCacheHeader& header)
+{
+	const uint64_t startTicks = Clock::GetTicks();
+	const uint8_t* data = File.GetData();
+	const MeshCacheSection* sections = header.Sections;
+
+	Decoded.Vertices.resize(header.VertexCount);
+	bool bDecoded = DecodeVertexBuffer(data + sections[MESH_CACHE_SECTION_VERTICES].Offset, (size_t)sections[MESH_CACHE_SECTION_VERTICES].Size,
+		Decoded.Vertices.data(), header.VertexCount, sizeof(VertexData));
+	if (bDecoded && sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES].Size)
+	{
+		Decoded.QuantizedVertices.resize(header.VertexCount);
+		bDecoded = DecodeVertexBuffer(data + sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES].Offset, (size_t)sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES].Size,
+			Decoded.QuantizedVertices.data(), header.VertexCount, sizeof(QuantizedVertexData));
+	}
+
+	bDecoded = bDecoded && DecodeIndices(header, MESH_CACHE_SECTION_INDICES, Decoded.Indices);
+	if (bDecoded && header.MeshletLodCount > 0)
+	{
+		bDecoded = DecodeIndices(header, MESH_CACHE_SECTION_MESHLET_INDICES, Decoded.MeshletIndices);
+	}
+
+	const MeshLod* lods = (const MeshLod*)(data + sections[MESH_CACHE_SECTION_LODS].Offset);
+	Decoded.Lods.assign(lods, lods + header.LodCount);
+	const uint32_t* meshletLodCounts = (const uint32_t*)(data + sections[MESH_CACHE_SECTION_MESHLET_LOD_COUNTS].Offset);
+	Decoded.MeshletLodCounts.assign(meshletLodCounts, meshletLodCounts + header.MeshletLodCount);
+	const MeshletRecord* meshlets = (const MeshletRecord*)(data + sections[MESH_CACHE_SECTION_MESHLETS].Offset);
+	Decoded.Meshlets.assign(meshlets, meshlets + header.MeshletCount);
+	Decoded.Quantization = header.Quantization;
+	Decoded.QuantizationError = header.QuantizationError;
+	DecodeMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - startTicks);
+	return bDecoded;
+}
+
+bool MeshCache::DecodeIndices(const MeshCacheHeader& header, MESH_CACHE_SECTION section, MeshIndices& outIndices) const
+{
+	const uint8_t* encoded = File.GetData() + header.Sections[section].Offset;
+	const size_t encodedSize = (size_t)header.Sections[section].Size;
+	outIndices.Format = (INDEX_FORMAT)header.IndexFormat;
+	if (outIndices.Format == INDEX_FORMAT_UINT16)
+	{
+		outIndices.Indices16.resize(header.IndexCount);
+		return DecodeIndexBuffer(encoded, encodedSize, outIndices.Indices16.data(), header.IndexCount);
+	}
+
+	outIndices.Indices32.resize(header.IndexCount);
+	return DecodeIndexBuffer(encoded, encodedSize, outIndices.Indices32.data(), header.IndexCount);
+}
+
+MeshCacheView MeshCache::GetView() const
+{
+	if (IsCompressed())
+	{
+		return Decoded.GetView();
+	}
+
+	MeshCacheView view;
+	view.Vertices = (const VertexData*)GetSection(MESH_CACHE_SECTION_VERTICES);
+	view.QuantizedVertices = Header->Sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES].Size ? (const QuantizedVertexData*)GetSection(MESH_CACHE_SECTION_QUANTIZED_VERTICES) : nullptr;
+	view.VertexCount = Header->VertexCount;
+	view.Quantization = Header->Quantization;
+	view.QuantizationError = Header->QuantizationError;
+	view.Indices = GetSection(MESH_CACHE_SECTION_INDICES);
+	view.IndexFormat = (INDEX_FORMAT)Header->IndexFormat;
+	view.IndexCount = Header->IndexCount;
+	view.Lods = (const MeshLod*)GetSection(MESH_CACHE_SECTION_LODS);
+	view.LodCount = Header->LodCount;
+	const bool bMeshlets = Header->MeshletLodCount > 0;
+	view.MeshletIndices = bMeshlets ? GetSection(MESH_CACHE_SECTION_MESHLET_INDICES) : nullptr;
+	view.MeshletLodCounts = bMeshlets ? (const uint32_t*)GetSection(MESH_CACHE_SECTION_MESHLET_LOD_COUNTS) : nullptr;
+	view.MeshletLodCount = Header->MeshletLodCount;
+	view.Meshlets = Header->MeshletCount > 0 ? (const MeshletRecord*)GetSection(MESH_CACHE_SECTION_MESHLETS) : nullptr;
+	view.MeshletCount = Header->MeshletCount;
+	return view;
+}
+
+uint64_t ComputeMeshCacheKey(const void* parameters, size_t size, uint32_t generatorVersion)
+{
+	const uint64_t hash = HashBytes(FNV_OFFSET_BASIS, &generatorVersion, sizeof(generatorVersion));
+	return HashBytes(hash, parameters, size);
+}
+
+bool WriteMeshCache(const char* fileName, uint64_t sourceKey, const MeshCacheView& meshes, bool bCompress)
+{
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.Magic = MESH_CACHE_MAGIC;
+	header.Version = MESH_CACHE_VERSION;
+	header.SourceKey = sourceKey;
+	header.VertexSize = sizeof(VertexData);
+	header.QuantizedVertexSize = sizeof(QuantizedVertexData);
+	header.LodSize = sizeof(MeshLod);
+	header.MeshletSize = sizeof(MeshletRecord);
+	header.VertexCount = meshes.VertexCount;
+	header.IndexFormat = meshes.IndexFormat;
+	header.IndexCount = meshes.IndexCount;
+	header.LodCount = meshes.LodCount;
+	header.Compression = bCompress ? MESH_CACHE_COMPRESSION_CODEC : MESH_CACHE_COMPRESSION_NONE;
+	header.MeshletLodCount = meshes.MeshletLodCount;
+	header.MeshletCount = meshes.MeshletCount;
+	header.Quantization = meshes.Quantization;
+	header.QuantizationError = meshes.QuantizationError;
+
+	// Sphere around the center of the box
+	Float3 minimum{ FLT_MAX, FLT_MAX, FLT_MAX };
+	Float3 maximum{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t i = 0; i < meshes.VertexCount; ++i)
+	{
+		const Float3& position = meshes.Vertices[i].Position;
+		minimum = Float3{ fminf(minimum.x, position.x), fminf(minimum.y, position.y), fminf(minimum.z, position.z) };
+		maximum = Float3{ fmaxf(maximum.x, position.x), fmaxf(maximum.y, position.y), fmaxf(maximum.z, position.z) };
+	}
+	header.BoundsMin = minimum;
+	header.BoundsMax = maximum;
+	header.BoundsCenter = (minimum + maximum) * 0.5f;
+	for (uint32_t i = 0; i < meshes.VertexCount; ++i)
+	{
+		header.BoundsRadius = fmaxf(header.BoundsRadius, Length(meshes.Vertices[i].Position - header.BoundsCenter));
+	}
+
+	const void* sectionData[MESH_CACHE_SECTION_COUNT]{ meshes.Vertices, meshes.QuantizedVertices, meshes.Indices, meshes.Lods, meshes.MeshletIndices,
+		meshes.MeshletLodCounts, meshes.Meshlets };
+	const uint64_t indicesSize = (uint64_t)meshes.IndexCount * meshes.GetIndexSize();
+	header.Sections[MESH_CACHE_SECTION_VERTICES].Size = (uint64_t)meshes.VertexCount * sizeof(VertexData);
+	header.Sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES].Size = meshes.QuantizedVertices ? (uint64_t)meshes.VertexCount * sizeof(QuantizedVertexData) : 0;
+	header.Sections[MESH_CACHE_SECTION_INDICES].Size = indicesSize;
+	header.Sections[MESH_CACHE_SECTION_LODS].Size = (uint64_t)meshes.LodCount * sizeof(MeshLod);
+	header.Sections[MESH_CACHE_SECTION_MESHLET_INDICES].Size = meshes.MeshletLodCount > 0 ? indicesSize : 0;
+	header.Sections[MESH_CACHE_SECTION_MESHLET_LOD_COUNTS].Size = (uint64_t)meshes.MeshletLodCount * sizeof(uint32_t);
+	header.Sections[MESH_CACHE_SECTION_MESHLETS].Size = (uint64_t)meshes.MeshletCount * sizeof(MeshletRecord);
+
+	// Levels and meshlets are small and stay as they are
+	std::vector<uint8_t> encodedSections[MESH_CACHE_SECTION_COUNT];
+	if (bCompress)
+	{
+		EncodeVertexBuffer(meshes.Vertices, meshes.VertexCount, sizeof(VertexData), encodedSections[MESH_CACHE_SECTION_VERTICES]);
+		if (meshes.QuantizedVertices)
+		{
+			EncodeVertexBuffer(meshes.QuantizedVertices, meshes.VertexCount, sizeof(QuantizedVertexData), encodedSections[MESH_CACHE_SECTION_QUANTIZED_VERTICES]);
+		}
+		for (MESH_CACHE_SECTION section : { MESH_CACHE_SECTION_INDICES, MESH_CACHE_SECTION_MESHLET_INDICES })
+		{
+			if (!header.Sections[section].Size)
+			{
+				continue;
+			}
+			if (meshes.IndexFormat == INDEX_FORMAT_UINT16)
+			{
+				EncodeIndexBuffer((const uint16_t*)sectionData[section], meshes.IndexCount, encodedSections[section]);
+			}
+			else
+			{
+				EncodeIndexBuffer((const uint32_t*)sectionData[section], meshes.IndexCount, encodedSections[section]);
+			}
+		}
+
+		for (MESH_CACHE_SECTION section : { MESH_CACHE_SECTION_VERTICES, MESH_CACHE_SECTION_QUANTIZED_VERTICES, MESH_CACHE_SECTION_INDICES,
+			MESH_CACHE_SECTION_MESHLET_INDICES })
+		{
+			sectionData[section] = encodedSections[section].data();
+			header.Sections[section].Size = encodedSections[section].size();
+		}
+	}
+
+	uint64_t offset = sizeof(MeshCacheHeader);
+	for (MeshCacheSection& section : header.Sections)
+	{
+		offset = AlignOffset(offset);
+		section.Offset = offset;
+		offset += section.Size;
+	}
+	header.FileSize = offset;
+
+	FILE* file = OpenFileForWriting(fileName);
+	if (!file)
+	{
+		return false;
+	}
+
+	static const uint8_t padding[MESH_CACHE_ALIGNMENT]{};
+	bool bWritten = fwrite(&header, sizeof(header), 1, file) == 1;
+	offset = sizeof(header);
+	for (uint32_t i = 0; i < MESH_CACHE_SECTION_COUNT && bWritten; ++i)
+	{
+		const MeshCacheSection& section = header.Sections[i];
+		bWritten = fwrite(padding, 1, (size_t)(section.Offset - offset), file) == section.Offset - offset
+			&& (section.Size == 0 || fwrite(sectionData[i], (size_t)section.Size, 1, file) == 1);
+		offset = section.Offset + section.Size;
+	}
+
+	return fclose(file) == 0 && bWritten;
+}
+
+void BuildLodMeshlets(uint32_t lodCount, MeshCacheData& inOutMeshes)
+{
+	MeshCacheData& meshes = inOutMeshes;
+	meshes.MeshletIndices = meshes.Indices;
+	meshes.MeshletLodCounts.clear();
+	meshes.Meshlets.clear();
+
+	MeshIndices& indices = meshes.MeshletIndices;
+	void* indexData = indices.Format == INDEX_FORMAT_UINT16 ? (void*)indices.Indices16.data() : (void*)indices.Indices32.data();
+	MeshletMesh meshlets;
+	for (uint32_t level = 0; level < lodCount && level < meshes.Lods.size(); ++level)
+	{
+		const MeshLod& lod = meshes.Lods[level];
+		BuildMeshlets(&meshes.Vertices[lod.BaseVertex], lod.VertexCount, sizeof(VertexData), indexData, indices.Format, lod.StartIndex, lod.IndexCount, meshlets);
+		meshes.MeshletLodCounts.push_back(meshlets.GetCount());
+		AppendMeshletRecords(meshlets, meshes.Meshlets);
+	}
+}
+
+void GenerateSphereLodMeshes(const int32_t* segmentCounts, uint32_t lodCount, bool bQuantize, MeshCacheData& outMeshes, MeshOptimizationStats* outStats)
+{
+	std::vector<PrimitiveShape> shapes(lodCount);
+	for (uint32_t i = 0; i < lodCount; ++i)
+	{
+		shapes[i] = { PRIMITIVE_TYPE_UV_SPHERE, segmentCounts[i], segmentCounts[i] };
+	}
+	GeneratePrimitiveLodMeshes(shapes.data(), lodCount, bQuantize, outMeshes, outStats);
+}
+
+bool GeneratePrimitiveLodMeshes(const PrimitiveShape* shapes, uint32_t lodCount, bool bQuantize, MeshCacheData& outMeshes, MeshOptimizationStats* outStats)
+{
+	if (!GeneratePrimitiveLodChain(shapes, lodCount, outMeshes.Vertices, outMeshes.Indices, outMeshes.Lods))
+	{
+		return false;
+	}
+
+	// Rings or subdivisions come out one after another, reorder every level for the vertex cache
+	for (const MeshLod& lod : outMeshes.Lods)
+	{
+		OptimizeMesh(&outMeshes.Vertices[lod.BaseVertex], lod.VertexCount, sizeof(VertexData), outMeshes.Indices, lod.StartIndex, lod.IndexCount, outStats);
+	}
+
+	// The whole chain shares one position range, so every level decodes with the same mesh constants
+	const uint32_t vertexCount = (uint32_t)outMeshes.Vertices.size();
+	outMeshes.Quantization = ComputeVertexQuantization(outMeshes.Vertices.data(), vertexCount, sizeof(VertexData));
+	outMeshes.QuantizedVertices.clear();
+	outMeshes.QuantizationError = VertexQuantizationError{};
+	if (bQuantize)
+	{
+		outMeshes.QuantizedVertices.resize(vertexCount);
+		QuantizeVertices(outMeshes.Vertices.data(), vertexCount, outMeshes.Quantization, outMeshes.QuantizedVertices.data());
+		outMeshes.QuantizationError = MeasureQuantizationError(outMeshes.Vertices.data(), outMeshes.QuantizedVertices.data(), vertexCount, outMeshes.Quantization);
+	}
+	return true;
+}
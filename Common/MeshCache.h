@@ -0,0 +1,185 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MathTypes.h"
+#include "MeshGenerator.h"
+#include "MeshOptimizer.h"
+#include "Meshlets.h"
+#include "VertexQuantization.h"
+#include "VertexTypes.h"
+
+struct PrimitiveShape;
+
+// Binary mesh container that is mapped into memory and used in place, without parsing.
+// Layout: MeshCacheHeader, then every section at a multiple of MESH_CACHE_ALIGNMENT from the start of the file.
+// Sections are stored as in memory (little-endian, the structures of VertexTypes.h and MeshGenerator.h), so the vertex and
+// index sections go straight to CreateBuffer. Compressed files hold the vertex and index sections as MeshCodec streams
+// instead, decoded once when the file is opened. Files written by another version or for other meshes are rejected.
+// The meshlet sections are empty in files written without meshlets.
+constexpr uint32_t MESH_CACHE_MAGIC = 0x434D5844; // "DXMC"
+constexpr uint32_t MESH_CACHE_VERSION = 3;
+constexpr uint32_t MESH_CACHE_ALIGNMENT = 64;
+
+enum MESH_CACHE_COMPRESSION : uint32_t
+{
+	MESH_CACHE_COMPRESSION_NONE,
+	// Vertices, quantized vertices, indices and meshlet indices through EncodeVertexBuffer and EncodeIndexBuffer,
+	// levels and meshlets as they are
+	MESH_CACHE_COMPRESSION_CODEC
+};
+
+enum MESH_CACHE_SECTION : uint32_t
+{
+	MESH_CACHE_SECTION_VERTICES,
+	MESH_CACHE_SECTION_QUANTIZED_VERTICES,
+	MESH_CACHE_SECTION_INDICES,
+	MESH_CACHE_SECTION_LODS,
+	MESH_CACHE_SECTION_MESHLET_INDICES,
+	MESH_CACHE_SECTION_MESHLET_LOD_COUNTS,
+	MESH_CACHE_SECTION_MESHLETS,
+	MESH_CACHE_SECTION_COUNT
+};
+
+// Bytes from the start of the file. Empty sections have a Size of 0.
+struct MeshCacheSection
+{
+	uint64_t Offset;
+	uint64_t Size;
+};
+
+struct MeshCacheHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+
+	// Identifies the generator and its parameters, see ComputeMeshCacheKey
+	uint64_t SourceKey;
+	uint64_t FileSize;
+
+	// Sizes of the structures the file was written with
+	uint32_t VertexSize;
+	uint32_t QuantizedVertexSize;
+	uint32_t LodSize;
+	uint32_t MeshletSize;
+
+	uint32_t VertexCount;
+	uint32_t IndexFormat;
+	uint32_t IndexCount;
+	uint32_t LodCount;
+	uint32_t Compression;
+	uint32_t MeshletLodCount;
+	uint32_t MeshletCount;
+
+	// Bounding sphere and box of every vertex
+	Float3 BoundsCenter;
+	float BoundsRadius;
+	Float3 BoundsMin;
+	Float3 BoundsMax;
+
+	// Decodes the quantized vertices, and what they lost
+	VertexQuantization Quantization;
+	VertexQuantizationError QuantizationError;
+
+	MeshCacheSection Sections[MESH_CACHE_SECTION_COUNT];
+};
+
+// Meshes as the scenes use them, wherever they come from. Every pointer stays valid as long as its owner.
+// QuantizedVertices is null when the meshes have no quantized stream.
+struct MeshCacheView
+{
+	const VertexData* Vertices;
+	const QuantizedVertexData* QuantizedVertices;
+	uint32_t VertexCount;
+	VertexQuantization Quantization;
+	VertexQuantizationError QuantizationError;
+
+	const void* Indices;
+	INDEX_FORMAT IndexFormat;
+	uint32_t IndexCount;
+
+	const MeshLod* Lods;
+	uint32_t LodCount;
+
+	// Meshlets of the first MeshletLodCount levels (BuildLodMeshlets), MeshletLodCounts[level] of them per level one level
+	// after the other. They are ranges of MeshletIndices, IndexCount indices again with the triangles of those levels in meshlet
+	// order. Null pointers and counts of 0 without meshlets.
+	const void* MeshletIndices;
+	const uint32_t* MeshletLodCounts;
+	uint32_t MeshletLodCount;
+	const MeshletRecord* Meshlets;
+	uint32_t MeshletCount;
+
+	uint32_t GetIndexSize() const { return IndexFormat == INDEX_FORMAT_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+};
+
+// Meshes built in memory by the generators
+struct MeshCacheData
+{
+	std::vector<VertexData> Vertices;
+	std::vector<QuantizedVertexData> QuantizedVertices;
+	VertexQuantization Quantization{};
+	VertexQuantizationError QuantizationError{};
+	MeshIndices Indices;
+	std::vector<MeshLod> Lods;
+	MeshIndices MeshletIndices;
+	std::vector<uint32_t> MeshletLodCounts;
+	std::vector<MeshletRecord> Meshlets;
+
+	MeshCacheView GetView() const;
+};
+
+// Meshes of a mapped cache file. The views point into the mapping, or into the decoded copy of a compressed file,
+// and stay valid until Close.
+class MeshCache
+{
+public:
+	// Maps fileName and checks the header, that every section, level and meshlet lies inside the file or its level, and that
+	// the indices of every level, in both orders, are below its VertexCount. Compressed sections are decoded right away.
+	// Fails when the file is missing, damaged, or was written by another version or for another sourceKey.
+	bool Open(const char* fileName, uint64_t sourceKey);
+	void Close();
+
+	bool IsOpen() const { return Header != nullptr; }
+	const MeshCacheHeader& GetHeader() const { return *Header; }
+	uint64_t GetFileSize() const { return File.GetSize(); }
+	bool IsCompressed() const { return Header->Compression == MESH_CACHE_COMPRESSION_CODEC; }
+
+	// Time Open spent decoding the compressed sections, 0 for a file stored as in memory
+	double GetDecodeMilliseconds() const { return DecodeMilliseconds; }
+
+	MeshCacheView GetView() const;
+
+private:
+	const void* GetSection(MESH_CACHE_SECTION section) const { return File.GetData() + Header->Sections[section].Offset; }
+	bool Decode(const MeshCacheHeader& header);
+	bool DecodeIndices(const MeshCacheHeader& header, MESH_CACHE_SECTION section, MeshIndices& outIndices) const;
+
+	MappedFile File;
+	const MeshCacheHeader* Header = nullptr;
+	MeshCacheData Decoded;
+	double DecodeMilliseconds = 0.0;
+};
+
+// FNV-1a of the parameters that decide the meshes, together with the version of the code that generates them.
+// Change generatorVersion whenever the generated meshes change, so that older files are not used.
+uint64_t ComputeMeshCacheKey(const void* parameters, size_t size, uint32_t generatorVersion);
+
+// Writes the header, computing the bounds from the vertices, and every section, compressed when bCompress.
+// Returns false when the file cannot be written.
+bool WriteMeshCache(const char* fileName, uint64_t sourceKey, const MeshCacheView& meshes, bool bCompress = false);
+
+// Splits the first lodCount levels into meshlets (BuildMeshlets) on a copy of the indices, stored with the meshes
+void BuildLodMeshlets(uint32_t lodCount, MeshCacheData& inOutMeshes);
+
+// LOD chain of spheres with sliceCount = ringCount = segmentCounts[i] (GenerateSphereLodChain), with every level optimized
+// for the vertex cache (OptimizeMesh) and the quantized stream when bQuantize. The meshes every sample and tool shares.
+void GenerateSphereLodMeshes(const int32_t* segmentCounts, uint32_t lodCount, bool bQuantize, MeshCacheData& outMeshes,
+	MeshOptimizationStats* outStats = nullptr);
+
+// Same with a primitive per level (GeneratePrimitiveLodChain), such as icospheres. Returns false when a shape is not valid.
+bool GeneratePrimitiveLodMeshes(const PrimitiveShape* shapes, uint32_t lodCount, bool bQuantize, MeshCacheData& outMeshes,
+	MeshOptimizationStats* outStats = nullptr);
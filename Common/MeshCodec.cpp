@@ -0,0 +1,561 @@
+#include "MeshCodec.h"
+
+#include <string.h>
+
+#include <immintrin.h>
+
+namespace
+{
+	constexpr uint32_t VERTEX_CODEC_GROUP_SIZE = 16;
+	constexpr uint32_t VERTEX_CODEC_MAX_WORD_COUNT = 64;
+
+	// Bytes of a packed group for every selector: all zero, 2, 4 and 8 bits per byte
+	constexpr uint32_t GROUP_PACKED_SIZES[4] = { 0, 4, 8, 16 };
+
+	// The edges of the last triangle and a bit, so that an edge and its rotation fit the 15 codes of a nibble
+	constexpr uint32_t EDGE_FIFO_SIZE = 5;
+	constexpr uint32_t VERTEX_FIFO_SIZE = 14;
+
+	// Rings the FIFOs live in, a power of two so that wrapping around is a mask
+	constexpr uint32_t EDGE_RING_SIZE = 8;
+	constexpr uint32_t VERTEX_RING_SIZE = 16;
+
+	// Corner after every corner of a triangle
+	constexpr uint32_t NEXT_CORNERS[3] = { 1, 2, 0 };
+
+	constexpr uint32_t EDGE_CODE_NONE = 15;
+	constexpr uint32_t VERTEX_CODE_NEXT = 0;
+	constexpr uint32_t VERTEX_CODE_EXPLICIT = 15;
+
+	// Largest varint of a 32-bit value
+	constexpr uint32_t MAX_VARINT_SIZE = 5;
+
+	uint32_t Zigzag(uint32_t value)
+	{
+		return (value << 1) ^ (uint32_t)((int32_t)value >> 31);
+	}
+
+	uint32_t Unzigzag(uint32_t value)
+	{
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	uint32_t GetGroupCount(uint32_t vertexCount)
+	{
+		return (vertexCount + VERTEX_CODEC_GROUP_SIZE - 1) / VERTEX_CODEC_GROUP_SIZE;
+	}
+
+	// Selectors of every group, 4 to a byte, then the groups packed at the smallest width that holds their largest byte
+	void EncodePlane(const uint8_t* bytes, uint32_t groupCount, std::vector<uint8_t>& outBuffer)
+	{
+		const size_t selectorOffset = outBuffer.size();
+		outBuffer.resize(selectorOffset + (groupCount + 3) / 4, 0);
+		for (uint32_t group = 0; group < groupCount; ++group)
+		{
+			const uint8_t* values = bytes + group * VERTEX_CODEC_GROUP_SIZE;
+			uint8_t bits = 0;
+			for (uint32_t i = 0; i < VERTEX_CODEC_GROUP_SIZE; ++i)
+			{
+				bits |= values[i];
+			}
+
+			const uint32_t selector = bits == 0 ? 0 : bits < 4 ? 1 : bits < 16 ? 2 : 3;
+			outBuffer[selectorOffset + group / 4] |= (uint8_t)(selector << (group % 4 * 2));
+
+			uint8_t packed[VERTEX_CODEC_GROUP_SIZE]{};
+			for (uint32_t i = 0; i < VERTEX_CODEC_GROUP_SIZE; ++i)
+			{
+				if (selector == 1)
+				{
+					packed[i / 4] |= (uint8_t)(values[i] << (i % 4 * 2));
+				}
+				else if (selector == 2)
+				{
+					packed[i / 2] |= (uint8_t)(values[i] << (i % 2 * 4));
+				}
+				else
+				{
+					packed[i] = values[i];
+				}
+			}
+			outBuffer.insert(outBuffer.end(), packed, packed + GROUP_PACKED_SIZES[selector]);
+		}
+	}
+
+	// Checks that the selectors and every packed group lie inside the buffer, and returns the start of the groups
+	const uint8_t* ReadPlaneSelectors(const uint8_t* data, const uint8_t* end, uint32_t groupCount, const uint8_t*& outSelectors)
+	{
+		const uint32_t selectorSize = (groupCount + 3) / 4;
+		if ((size_t)(end - data) < selectorSize)
+		{
+			return nullptr;
+		}
+
+		size_t packedSize = 0;
+		for (uint32_t group = 0; group < groupCount; ++group)
+		{
+			packedSize += GROUP_PACKED_SIZES[(data[group / 4] >> (group % 4 * 2)) & 3];
+		}
+		if ((size_t)(end - data) - selectorSize < packedSize)
+		{
+			return nullptr;
+		}
+
+		outSelectors = data;
+		return data + selectorSize;
+	}
+
+	// Unpacks the 16 bytes of a group. Lane i of the 2-bit case starts as byte i / 4 and keeps the 2 bits at i % 4,
+	// lane i of the 4-bit case takes the low or high half of byte i / 2.
+	__m128i DecodeGroup(uint32_t selector, const uint8_t* data)
+	{
+		switch (selector)
+		{
+		case 0:
+			return _mm_setzero_si128();
+		case 1:
+		{
+			uint32_t packed;
+			memcpy(&packed, data, sizeof(packed));
+			__m128i bytes = _mm_cvtsi32_si128((int32_t)packed);
+			bytes = _mm_unpacklo_epi8(bytes, bytes);
+			bytes = _mm_unpacklo_epi16(bytes, bytes);
+			const __m128i shift0 = _mm_and_si128(bytes, _mm_set1_epi32(0x000000FF));
+			const __m128i shift2 = _mm_and_si128(_mm_srli_epi16(bytes, 2), _mm_set1_epi32(0x0000FF00));
+			const __m128i shift4 = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi32(0x00FF0000));
+			const __m128i shift6 = _mm_and_si128(_mm_srli_epi16(bytes, 6), _mm_set1_epi32((int32_t)0xFF000000));
+			return _mm_and_si128(_mm_or_si128(_mm_or_si128(shift0, shift2), _mm_or_si128(shift4, shift6)), _mm_set1_epi8(3));
+		}
+		case 2:
+		{
+			const __m128i bytes = _mm_loadl_epi64((const __m128i*)data);
+			const __m128i low = _mm_and_si128(bytes, _mm_set1_epi8(15));
+			const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(15));
+			return _mm_unpacklo_epi8(low, high);
+		}
+		default:
+			return _mm_loadu_si128((const __m128i*)data);
+		}
+	}
+
+	const uint8_t* DecodePlane(const uint8_t* data, const uint8_t* end, uint32_t groupCount, uint8_t* outBytes)
+	{
+		const uint8_t* selectors = nullptr;
+		data = ReadPlaneSelectors(data, end, groupCount, selectors);
+		if (!data)
+		{
+			return nullptr;
+		}
+
+		for (uint32_t group = 0; group < groupCount; ++group)
+		{
+			const uint32_t selector = (selectors[group / 4] >> (group % 4 * 2)) & 3;
+			_mm_store_si128((__m128i*)(outBytes + group * VERTEX_CODEC_GROUP_SIZE), DecodeGroup(selector, data));
+			data += GROUP_PACKED_SIZES[selector];
+		}
+		return data;
+	}
+
+	const uint8_t* DecodePlaneScalar(const uint8_t* data, const uint8_t* end, uint32_t groupCount, uint8_t* outBytes)
+	{
+		const uint8_t* selectors = nullptr;
+		data = ReadPlaneSelectors(data, end, groupCount, selectors);
+		if (!data)
+		{
+			return nullptr;
+		}
+
+		for (uint32_t group = 0; group < groupCount; ++group)
+		{
+			const uint32_t selector = (selectors[group / 4] >> (group % 4 * 2)) & 3;
+			uint8_t* bytes = outBytes + group * VERTEX_CODEC_GROUP_SIZE;
+			for (uint32_t i = 0; i < VERTEX_CODEC_GROUP_SIZE; ++i)
+			{
+				bytes[i] = selector == 0 ? 0 : selector == 1 ? (data[i / 4] >> (i % 4 * 2)) & 3 : selector == 2 ? (data[i / 2] >> (i % 2 * 4)) & 15 : data[i];
+			}
+			data += GROUP_PACKED_SIZES[selector];
+		}
+		return data;
+	}
+
+	// Joins the byte planes of valueCount words, a multiple of 16, and adds up the differences from last
+	void DecodeWords(const uint8_t (*planes)[VERTEX_CODEC_BLOCK_SIZE], uint32_t valueCount, uint32_t& last, uint32_t* outValues)
+	{
+		__m128i previous = _mm_set1_epi32((int32_t)last);
+		for (uint32_t i = 0; i < valueCount; i += VERTEX_CODEC_GROUP_SIZE)
+		{
+			const __m128i plane0 = _mm_load_si128((const __m128i*)(planes[0] + i));
+			const __m128i plane1 = _mm_load_si128((const __m128i*)(planes[1] + i));
+			const __m128i plane2 = _mm_load_si128((const __m128i*)(planes[2] + i));
+			const __m128i plane3 = _mm_load_si128((const __m128i*)(planes[3] + i));
+			const __m128i low01 = _mm_unpacklo_epi8(plane0, plane1);
+			const __m128i high01 = _mm_unpackhi_epi8(plane0, plane1);
+			const __m128i low23 = _mm_unpacklo_epi8(plane2, plane3);
+			const __m128i high23 = _mm_unpackhi_epi8(plane2, plane3);
+			const __m128i words[4]
+			{
+				_mm_unpacklo_epi16(low01, low23),
+				_mm_unpackhi_epi16(low01, low23),
+				_mm_unpacklo_epi16(high01, high23),
+				_mm_unpackhi_epi16(high01, high23)
+			};
+
+			for (uint32_t k = 0; k < 4; ++k)
+			{
+				// Prefix sum of 4 lanes in two shifted adds, on top of the last word of the 4 before
+				const __m128i zigzag = words[k];
+				__m128i value = _mm_xor_si128(_mm_srli_epi32(zigzag, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(zigzag, _mm_set1_epi32(1))));
+				value = _mm_add_epi32(value, _mm_slli_si128(value, 4));
+				value = _mm_add_epi32(value, _mm_slli_si128(value, 8));
+				value = _mm_add_epi32(value, previous);
+				_mm_storeu_si128((__m128i*)(outValues + i + k * 4), value);
+				previous = _mm_shuffle_epi32(value, _MM_SHUFFLE(3, 3, 3, 3));
+			}
+		}
+		last = (uint32_t)_mm_cvtsi128_si32(previous);
+	}
+
+	void DecodeWordsScalar(const uint8_t (*planes)[VERTEX_CODEC_BLOCK_SIZE], uint32_t valueCount, uint32_t& last, uint32_t* outValues)
+	{
+		for (uint32_t i = 0; i < valueCount; ++i)
+		{
+			const uint32_t zigzag = planes[0][i] | (uint32_t)planes[1][i] << 8 | (uint32_t)planes[2][i] << 16 | (uint32_t)planes[3][i] << 24;
+			last += Unzigzag(zigzag);
+			outValues[i] = last;
+		}
+	}
+
+	template <bool bSimd>
+	bool DecodeVertices(const void* buffer, size_t bufferSize, void* outVertices, uint32_t vertexCount, uint32_t vertexSize)
+	{
+		const uint8_t* data = (const uint8_t*)buffer;
+		const uint8_t* end = data + bufferSize;
+		const uint32_t wordCount = vertexSize / 4;
+		if (vertexSize % 4 != 0 || wordCount > VERTEX_CODEC_MAX_WORD_COUNT || bufferSize < 1 || data[0] != VERTEX_CODEC_VERSION)
+		{
+			return false;
+		}
+		++data;
+
+		alignas(16) uint8_t planes[4][VERTEX_CODEC_BLOCK_SIZE];
+		alignas(16) uint32_t values[VERTEX_CODEC_BLOCK_SIZE];
+		uint32_t lastWords[VERTEX_CODEC_MAX_WORD_COUNT]{};
+		uint8_t* output = (uint8_t*)outVertices;
+		for (uint32_t start = 0; start < vertexCount; start += VERTEX_CODEC_BLOCK_SIZE)
+		{
+			const uint32_t blockVertexCount = vertexCount - start < VERTEX_CODEC_BLOCK_SIZE ? vertexCount - start : VERTEX_CODEC_BLOCK_SIZE;
+			const uint32_t groupCount = GetGroupCount(blockVertexCount);
+			for (uint32_t word = 0; word < wordCount; ++word)
+			{
+				for (uint32_t plane = 0; plane < 4 && data; ++plane)
+				{
+					data = bSimd ? DecodePlane(data, end, groupCount, planes[plane]) : DecodePlaneScalar(data, end, groupCount, planes[plane]);
+				}
+				if (!data)
+				{
+					return false;
+				}
+
+				if (bSimd)
+				{
+					DecodeWords(planes, groupCount * VERTEX_CODEC_GROUP_SIZE, lastWords[word], values);
+				}
+				else
+				{
+					DecodeWordsScalar(planes, groupCount * VERTEX_CODEC_GROUP_SIZE, lastWords[word], values);
+				}
+
+				uint8_t* vertexWord = output + (size_t)start * vertexSize + word * sizeof(uint32_t);
+				for (uint32_t i = 0; i < blockVertexCount; ++i)
+				{
+					memcpy(vertexWord + (size_t)i * vertexSize, &values[i], sizeof(uint32_t));
+				}
+			}
+		}
+		return data == end;
+	}
+
+	// Recent edges and vertices, kept the same way by the encoder and the decoder. Entry 0 is the newest.
+	struct IndexCodecState
+	{
+		uint32_t Edges[EDGE_RING_SIZE][2];
+		uint32_t EdgeOffset;
+		uint32_t Vertices[VERTEX_RING_SIZE];
+		uint32_t VertexOffset;
+
+		// Next vertex that no triangle has used yet, and the last vertex coded as a difference
+		uint32_t Next;
+		uint32_t Last;
+
+		IndexCodecState()
+			: EdgeOffset(0), VertexOffset(0), Next(0), Last(0)
+		{
+			memset(Edges, 0xFF, sizeof(Edges));
+			memset(Vertices, 0xFF, sizeof(Vertices));
+		}
+
+		const uint32_t* GetEdge(uint32_t i) const { return Edges[(EdgeOffset + i) & (EDGE_RING_SIZE - 1)]; }
+		uint32_t GetVertex(uint32_t i) const { return Vertices[(VertexOffset + i) & (VERTEX_RING_SIZE - 1)]; }
+
+		void PushEdge(uint32_t a, uint32_t b)
+		{
+			EdgeOffset = (EdgeOffset - 1) & (EDGE_RING_SIZE - 1);
+			Edges[EdgeOffset][0] = a;
+			Edges[EdgeOffset][1] = b;
+		}
+
+		void PushVertex(uint32_t vertex)
+		{
+			VertexOffset = (VertexOffset - 1) & (VERTEX_RING_SIZE - 1);
+			Vertices[VertexOffset] = vertex;
+		}
+
+		// A neighbor across edge a -> b has it the other way around
+		void PushTriangle(uint32_t a, uint32_t b, uint32_t c)
+		{
+			PushEdge(b, a);
+			PushEdge(c, b);
+			PushEdge(a, c);
+		}
+	};
+
+	void WriteVarint(uint32_t value, std::vector<uint8_t>& outBuffer)
+	{
+		while (value >= 0x80)
+		{
+			outBuffer.push_back((uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+		outBuffer.push_back((uint8_t)value);
+	}
+
+	bool ReadVarint(const uint8_t*& data, const uint8_t* end, uint32_t& outValue)
+	{
+		outValue = 0;
+		for (uint32_t i = 0; i < MAX_VARINT_SIZE && data < end; ++i)
+		{
+			const uint8_t byte = *data++;
+			outValue |= (uint32_t)(byte & 0x7F) << (i * 7);
+			if (byte < 0x80)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	uint32_t EncodeVertex(IndexCodecState& state, uint32_t vertex, std::vector<uint8_t>& outBuffer)
+	{
+		if (vertex == state.Next)
+		{
+			++state.Next;
+			state.PushVertex(vertex);
+			return VERTEX_CODE_NEXT;
+		}
+		for (uint32_t i = 0; i < VERTEX_FIFO_SIZE; ++i)
+		{
+			if (state.GetVertex(i) == vertex)
+			{
+				return i + 1;
+			}
+		}
+
+		WriteVarint(Zigzag(vertex - state.Last), outBuffer);
+		state.Last = vertex;
+		state.PushVertex(vertex);
+		return VERTEX_CODE_EXPLICIT;
+	}
+
+	bool DecodeVertex(IndexCodecState& state, uint32_t code, const uint8_t*& data, const uint8_t* end, uint32_t& outVertex)
+	{
+		if (code == VERTEX_CODE_NEXT)
+		{
+			outVertex = state.Next++;
+			state.PushVertex(outVertex);
+			return true;
+		}
+		if (code != VERTEX_CODE_EXPLICIT)
+		{
+			outVertex = state.GetVertex(code - 1);
+			return true;
+		}
+
+		uint32_t difference;
+		if (!ReadVarint(data, end, difference))
+		{
+			return false;
+		}
+		outVertex = state.Last + Unzigzag(difference);
+		state.Last = outVertex;
+		state.PushVertex(outVertex);
+		return true;
+	}
+}
+
+size_t GetVertexBufferEncodeBound(uint32_t vertexCount, uint32_t vertexSize)
+{
+	const size_t blockCount = (vertexCount + VERTEX_CODEC_BLOCK_SIZE - 1) / VERTEX_CODEC_BLOCK_SIZE;
+	const size_t groupCount = VERTEX_CODEC_BLOCK_SIZE / VERTEX_CODEC_GROUP_SIZE;
+	return 1 + blockCount * (vertexSize / 4) * 4 * ((groupCount + 3) / 4 + VERTEX_CODEC_BLOCK_SIZE);
+}
+
+size_t GetIndexBufferEncodeBound(uint32_t indexCount)
+{
+	return 1 + (size_t)indexCount / 3 * (2 + 3 * MAX_VARINT_SIZE);
+}
+
+void EncodeVertexBuffer(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, std::vector<uint8_t>& outBuffer)
+{
+	outBuffer.clear();
+	outBuffer.reserve(GetVertexBufferEncodeBound(vertexCount, vertexSize));
+	outBuffer.push_back(VERTEX_CODEC_VERSION);
+
+	const uint8_t* input = (const uint8_t*)vertices;
+	const uint32_t wordCount = vertexSize / 4;
+	uint8_t planes[4][VERTEX_CODEC_BLOCK_SIZE];
+	std::vector<uint32_t> lastWords(wordCount, 0);
+	for (uint32_t start = 0; start < vertexCount; start += VERTEX_CODEC_BLOCK_SIZE)
+	{
+		const uint32_t blockVertexCount = vertexCount - start < VERTEX_CODEC_BLOCK_SIZE ? vertexCount - start : VERTEX_CODEC_BLOCK_SIZE;
+		const uint32_t groupCount = GetGroupCount(blockVertexCount);
+		for (uint32_t word = 0; word < wordCount; ++word)
+		{
+			// The padding of the last group is a difference of zero
+			memset(planes, 0, sizeof(planes));
+			for (uint32_t i = 0; i < blockVertexCount; ++i)
+			{
+				uint32_t value;
+				memcpy(&value, input + (size_t)(start + i) * vertexSize + word * sizeof(uint32_t), sizeof(value));
+				const uint32_t zigzag = Zigzag(value - lastWords[word]);
+				lastWords[word] = value;
+				for (uint32_t plane = 0; plane < 4; ++plane)
+				{
+					planes[plane][i] = (uint8_t)(zigzag >> (plane * 8));
+				}
+			}
+
+			for (uint32_t plane = 0; plane < 4; ++plane)
+			{
+				EncodePlane(planes[plane], groupCount, outBuffer);
+			}
+		}
+	}
+}
+
+bool DecodeVertexBuffer(const void* buffer, size_t bufferSize, void* outVertices, uint32_t vertexCount, uint32_t vertexSize)
+{
+	return DecodeVertices<true>(buffer, bufferSize, outVertices, vertexCount, vertexSize);
+}
+
+bool DecodeVertexBufferScalar(const void* buffer, size_t bufferSize, void* outVertices, uint32_t vertexCount, uint32_t vertexSize)
+{
+	return DecodeVertices<false>(buffer, bufferSize, outVertices, vertexCount, vertexSize);
+}
+
+template <typename Index>
+void EncodeIndexBuffer(const Index* indices, uint32_t indexCount, std::vector<uint8_t>& outBuffer)
+{
+	outBuffer.clear();
+	outBuffer.reserve(GetIndexBufferEncodeBound(indexCount));
+	outBuffer.push_back(INDEX_CODEC_VERSION);
+
+	IndexCodecState state;
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const uint32_t triangle[3]{ indices[i], indices[i + 1], indices[i + 2] };
+
+		// Edge code is the FIFO entry times 3 plus the corner the edge starts at
+		uint32_t edgeCode = EDGE_CODE_NONE;
+		for (uint32_t entry = 0; entry < EDGE_FIFO_SIZE && edgeCode == EDGE_CODE_NONE; ++entry)
+		{
+			const uint32_t* edge = state.GetEdge(entry);
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				if (edge[0] == triangle[corner] && edge[1] == triangle[NEXT_CORNERS[corner]])
+				{
+					edgeCode = entry * 3 + corner;
+					break;
+				}
+			}
+		}
+
+		// Codes are written before the varints of the vertices they describe
+		const size_t codeOffset = outBuffer.size();
+		outBuffer.push_back(0);
+		if (edgeCode != EDGE_CODE_NONE)
+		{
+			const uint32_t vertexCode = EncodeVertex(state, triangle[NEXT_CORNERS[NEXT_CORNERS[edgeCode % 3]]], outBuffer);
+			outBuffer[codeOffset] = (uint8_t)(edgeCode << 4 | vertexCode);
+		}
+		else
+		{
+			outBuffer[codeOffset] = (uint8_t)(EDGE_CODE_NONE << 4 | EncodeVertex(state, triangle[0], outBuffer));
+			const size_t secondCodeOffset = outBuffer.size();
+			outBuffer.push_back(0);
+			const uint32_t vertexCode1 = EncodeVertex(state, triangle[1], outBuffer);
+			const uint32_t vertexCode2 = EncodeVertex(state, triangle[2], outBuffer);
+			outBuffer[secondCodeOffset] = (uint8_t)(vertexCode1 << 4 | vertexCode2);
+		}
+		state.PushTriangle(triangle[0], triangle[1], triangle[2]);
+	}
+}
+
+template <typename Index>
+bool DecodeIndexBuffer(const void* buffer, size_t bufferSize, Index* outIndices, uint32_t indexCount)
+{
+	const uint8_t* data = (const uint8_t*)buffer;
+	const uint8_t* end = data + bufferSize;
+	if (indexCount % 3 != 0 || bufferSize < 1 || data[0] != INDEX_CODEC_VERSION)
+	{
+		return false;
+	}
+	++data;
+
+	IndexCodecState state;
+	for (uint32_t i = 0; i < indexCount; i += 3)
+	{
+		if (data == end)
+		{
+			return false;
+		}
+		const uint32_t code = *data++;
+		const uint32_t edgeCode = code >> 4;
+
+		uint32_t triangle[3];
+		if (edgeCode != EDGE_CODE_NONE)
+		{
+			const uint32_t* edge = state.GetEdge(edgeCode / 3);
+			const uint32_t corner = edgeCode % 3;
+			const uint32_t nextCorner = NEXT_CORNERS[corner];
+			triangle[corner] = edge[0];
+			triangle[nextCorner] = edge[1];
+			if (!DecodeVertex(state, code & 15, data, end, triangle[NEXT_CORNERS[nextCorner]]))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			if (!DecodeVertex(state, code & 15, data, end, triangle[0]) || data == end)
+			{
+				return false;
+			}
+			const uint32_t secondCode = *data++;
+			if (!DecodeVertex(state, secondCode >> 4, data, end, triangle[1]) || !DecodeVertex(state, secondCode & 15, data, end, triangle[2]))
+			{
+				return false;
+			}
+		}
+
+		outIndices[i] = (Index)triangle[0];
+		outIndices[i + 1] = (Index)triangle[1];
+		outIndices[i + 2] = (Index)triangle[2];
+		state.PushTriangle(triangle[0], triangle[1], triangle[2]);
+	}
+	return data == end;
+}
+
+template void EncodeIndexBuffer<uint16_t>(const uint16_t* indices, uint32_t indexCount, std::vector<uint8_t>& outBuffer);
+template void EncodeIndexBuffer<uint32_t>(const uint32_t* indices, uint32_t indexCount, std::vector<uint8_t>& outBuffer);
+template bool DecodeIndexBuffer<uint16_t>(const void* buffer, size_t bufferSize, uint16_t* outIndices, uint32_t indexCount);
+template bool DecodeIndexBuffer<uint32_t>(const void* buffer, size_t bufferSize, uint32_t* outIndices, uint32_t indexCount);
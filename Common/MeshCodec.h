@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Lossless compression of vertex and index buffers for files, decoded straight into the memory handed to CreateBuffer.
+//
+// Vertices are split into 32-bit words and blocks of VERTEX_CODEC_BLOCK_SIZE vertices. Every word is stored as the
+// difference to the same word of the vertex before, zigzag encoded so that small negative differences stay small, and
+// the four bytes of those differences go to four byte planes. Every plane is packed in groups of 16 bytes at 0, 2, 4 or
+// 8 bits each, with a 2-bit selector per group. Neighboring vertices of an optimized mesh are close together, so the
+// high planes of positions and normals are mostly zero. Decoding unpacks 16 bytes and adds up 4 words at a time with SSE2.
+//
+// Indices are coded a triangle at a time against the last edges and vertices. A triangle that shares an edge with one of
+// the last two triangles costs one byte: which edge, and whether the third vertex is the next vertex never used before,
+// one of the recent vertices, or a varint difference to the last vertex coded that way. Triangle order and rotation are
+// kept, so the decoded indices are the same bit for bit. Vertices numbered in the order of first use (OptimizeVertexFetch)
+// are mostly the next vertex.
+constexpr uint8_t VERTEX_CODEC_VERSION = 1;
+constexpr uint8_t INDEX_CODEC_VERSION = 1;
+constexpr uint32_t VERTEX_CODEC_BLOCK_SIZE = 256;
+
+// Worst case sizes of the encoded buffers
+size_t GetVertexBufferEncodeBound(uint32_t vertexCount, uint32_t vertexSize);
+size_t GetIndexBufferEncodeBound(uint32_t indexCount);
+
+// vertexSize has to be a multiple of 4 bytes
+void EncodeVertexBuffer(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, std::vector<uint8_t>& outBuffer);
+
+// Returns false when the buffer is damaged or was encoded with another version, count or size
+bool DecodeVertexBuffer(const void* buffer, size_t bufferSize, void* outVertices, uint32_t vertexCount, uint32_t vertexSize);
+
+// Same a byte and a word at a time, the reference for DecodeVertexBuffer
+bool DecodeVertexBufferScalar(const void* buffer, size_t bufferSize, void* outVertices, uint32_t vertexCount, uint32_t vertexSize);
+
+// Index is uint16_t or uint32_t, indexCount a multiple of 3
+template <typename Index>
+void EncodeIndexBuffer(const Index* indices, uint32_t indexCount, std::vector<uint8_t>& outBuffer);
+
+template <typename Index>
+bool DecodeIndexBuffer(const void* buffer, size_t bufferSize, Index* outIndices, uint32_t indexCount);
@@ -0,0 +1,355 @@
+#include "MeshGenerator.h"
+
+#include <atomic>
+#include <float.h>
+#include <memory>
+
+#include "PrimitiveMeshes.h"
+#include "ThreadPool.h"
+
+namespace
+{
+	// Rings per ParallelFor task
+	constexpr int32_t SPHERE_RINGS_PER_TASK = 32;
+
+	// Triangles of the level being split per ParallelFor task
+	constexpr uint32_t ICOSPHERE_TRIANGLES_PER_TASK = 4096;
+
+	void RunTasks(ThreadPool* threadPool, uint32_t taskCount, const ThreadPool::TaskFunction& task)
+	{
+		if (threadPool && taskCount > 1)
+		{
+			threadPool->ParallelFor(taskCount, task);
+		}
+		else
+		{
+			for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+			{
+				task(taskIndex, 0);
+			}
+		}
+	}
+
+	uint32_t FindIcosphereMidpoint(const std::atomic<uint64_t>* table, uint32_t tableMask, uint32_t shift, uint32_t a, uint32_t b)
+	{
+		const uint32_t lower = a < b ? a : b;
+		const uint32_t higher = a < b ? b : a;
+		const uint64_t key = PackIcosphereEdge(lower, higher);
+		uint32_t slot = (uint32_t)(HashIcosphereEdge(lower, higher) >> shift);
+		for (;;)
+		{
+			const uint64_t entry = table[slot].load(std::memory_order_relaxed);
+			if ((entry & ~ICOSPHERE_EDGE_VERTEX_MASK) == key)
+			{
+				return (uint32_t)(entry & ICOSPHERE_EDGE_VERTEX_MASK);
+			}
+			slot = (slot + 1) & tableMask;
+		}
+	}
+
+	// Vertices of rings [ringBegin, ringEnd) and the two triangles per slice of the bands from each of those rings to the next one
+	template <typename Index>
+	void GenerateSphereRings(int32_t sliceCount, int32_t ringCount, const float* sinTheta, const float* cosTheta, const float* sinPhi, const float* cosPhi,
+		int32_t ringBegin, int32_t ringEnd, VertexData* vertices, Index* indices)
+	{
+		for (int32_t ringIndex = ringBegin; ringIndex < ringEnd; ++ringIndex)
+		{
+			for (int32_t sliceIndex = 0; sliceIndex < sliceCount; ++sliceIndex)
+			{
+				const Float3 position{ sinTheta[ringIndex] * cosPhi[sliceIndex], cosTheta[ringIndex], sinTheta[ringIndex] * sinPhi[sliceIndex] };
+
+				VertexData& vertex = vertices[(size_t)ringIndex * sliceCount + sliceIndex + 1];
+				vertex.Position = position;
+				vertex.Normal = position;
+			}
+		}
+
+		// Bands come after the top cap, the last ring has none
+		const int32_t bandEnd = ringEnd < ringCount - 1 ? ringEnd : ringCount - 1;
+		size_t index = (size_t)sliceCount * 3 + (size_t)ringBegin * sliceCount * 6;
+		for (int32_t i = ringBegin; i < bandEnd; ++i)
+		{
+			for (int32_t j = 1; j <= sliceCount; ++j)
+			{
+				const int32_t nextJ = j % sliceCount + 1;
+
+				indices[index++] = (Index)(sliceCount * i + j);
+				indices[index++] = (Index)(sliceCount * (i + 1) + nextJ);
+				indices[index++] = (Index)(sliceCount * (i + 1) + j);
+
+				indices[index++] = (Index)(sliceCount * i + j);
+				indices[index++] = (Index)(sliceCount * i + nextJ);
+				indices[index++] = (Index)(sliceCount * (i + 1) + nextJ);
+			}
+		}
+	}
+}
+
+template <typename Index>
+void GenerateSphere(int32_t sliceCount, int32_t ringCount, std::vector<VertexData>& outVertices, std::vector<Index>& outIndices, ThreadPool* threadPool)
+{
+	std::vector<VertexData>& vertices = outVertices;
+	vertices.resize((size_t)sliceCount * ringCount + 2);
+
+	// Top
+	vertices.front() = { Float3{ 0.0f, 1.0f, 0.0f }, Float3{ 0.0f, 1.0f, 0.0f } };
+
+	// Bottom
+	vertices.back() = { Float3{ 0.0f, -1.0f, 0.0f }, Float3{ 0.0f, -1.0f, 0.0f } };
+
+	// Angles are accumulated one step at a time as before, so every ring gets the same values no matter which task builds it.
+	// Their sines come from the same functions as the spheres baked by PrimitiveMeshes.cpp, which then match these bit for bit.
+	const float deltaThetaAngle = PI / (float)(ringCount + 1);
+	const float deltaPhiAngle = TWO_PI / (float)sliceCount;
+
+	std::vector<float> sinTheta(ringCount);
+	std::vector<float> cosTheta(ringCount);
+	float theta = 0.0f;
+	for (int32_t ringIndex = 0; ringIndex < ringCount; ++ringIndex)
+	{
+		theta += deltaThetaAngle;
+		sinTheta[ringIndex] = (float)ConstexprSin((double)theta);
+		cosTheta[ringIndex] = (float)ConstexprCos((double)theta);
+	}
+
+	std::vector<float> sinPhi(sliceCount);
+	std::vector<float> cosPhi(sliceCount);
+	float phi = 0.0f;
+	for (int32_t sliceIndex = 0; sliceIndex < sliceCount; ++sliceIndex)
+	{
+		sinPhi[sliceIndex] = (float)ConstexprSin((double)phi);
+		cosPhi[sliceIndex] = (float)ConstexprCos((double)phi);
+		phi += deltaPhiAngle;
+	}
+
+	std::vector<Index>& indices = outIndices;
+	indices.resize((size_t)sliceCount * ringCount * 6);
+
+	// Top
+	size_t index = 0;
+	for (int32_t i = 1; i <= sliceCount; ++i)
+	{
+		indices[index++] = 0;
+		indices[index++] = (Index)(i % sliceCount + 1);
+		indices[index++] = (Index)i;
+	}
+
+	// Rings and the bands between them
+	const uint32_t taskCount = (uint32_t)((ringCount + SPHERE_RINGS_PER_TASK - 1) / SPHERE_RINGS_PER_TASK);
+	auto generateRings = [&](uint32_t taskIndex, uint32_t)
+	{
+		const int32_t ringBegin = (int32_t)taskIndex * SPHERE_RINGS_PER_TASK;
+		const int32_t ringEnd = ringCount - ringBegin < SPHERE_RINGS_PER_TASK ? ringCount : ringBegin + SPHERE_RINGS_PER_TASK;
+		GenerateSphereRings(sliceCount, ringCount, sinTheta.data(), cosTheta.data(), sinPhi.data(), cosPhi.data(), ringBegin, ringEnd, vertices.data(), indices.data());
+	};
+
+	RunTasks(threadPool, taskCount, generateRings);
+
+	// Bottom
+	index = indices.size() - (size_t)sliceCount * 3;
+	for (int32_t i = 1; i <= sliceCount; ++i)
+	{
+		const int32_t baseIndex = sliceCount * (ringCount - 1);
+
+		indices[index++] = (Index)(baseIndex + i);
+		indices[index++] = (Index)(baseIndex + i % sliceCount + 1);
+		indices[index++] = (Index)(sliceCount * ringCount + 1);
+	}
+}
+
+template void GenerateSphere<uint16_t>(int32_t sliceCount, int32_t ringCount, std::vector<VertexData>& outVertices, std::vector<uint16_t>& outIndices,
+	ThreadPool* threadPool);
+template void GenerateSphere<uint32_t>(int32_t sliceCount, int32_t ringCount, std::vector<VertexData>& outVertices, std::vector<uint32_t>& outIndices,
+	ThreadPool* threadPool);
+
+void GenerateSphere(int32_t sliceCount, int32_t ringCount, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool)
+{
+	outIndices.Format = SelectIndexFormat((uint64_t)sliceCount * ringCount + 2);
+	if (outIndices.Format == INDEX_FORMAT_UINT16)
+	{
+		GenerateSphere(sliceCount, ringCount, outVertices, outIndices.Indices16, threadPool);
+		outIndices.Indices32.clear();
+	}
+	else
+	{
+		GenerateSphere(sliceCount, ringCount, outVertices, outIndices.Indices32, threadPool);
+		outIndices.Indices16.clear();
+	}
+}
+
+template <typename Index>
+void GenerateIcosphere(int32_t level, std::vector<VertexData>& outVertices, std::vector<Index>& outIndices, ThreadPool* threadPool)
+{
+	const PrimitiveShape shape{ PRIMITIVE_TYPE_ICOSPHERE, level, 0 };
+	std::vector<VertexData>& vertices = outVertices;
+	std::vector<Index>& indices = outIndices;
+	vertices.resize(GetPrimitiveVertexCount(shape));
+	indices.resize(GetPrimitiveIndexCount(shape));
+
+	// The icosahedron needs no table
+	WriteIcosphere(0, vertices.data(), indices.data(), (uint64_t*)nullptr);
+	if (level == 0)
+	{
+		return;
+	}
+
+	// Every subdivision reads the triangles of one buffer and writes their children into the other one
+	std::vector<Index> splitIndices(indices.size());
+	Index* sourceIndices = indices.data();
+	Index* splitTriangles = splitIndices.data();
+
+	const uint32_t maxTableSize = GetIcosphereMidpointTableSize(level - 1);
+	std::unique_ptr<std::atomic<uint64_t>[]> table(new std::atomic<uint64_t>[maxTableSize]);
+	std::vector<uint32_t> taskFirstVertices((GetPrimitiveIndexCount(shape) / 12 + ICOSPHERE_TRIANGLES_PER_TASK - 1) / ICOSPHERE_TRIANGLES_PER_TASK);
+
+	uint32_t vertexCount = 12;
+	uint32_t triangleCount = 20;
+	for (int32_t subdivision = 0; subdivision < level; ++subdivision)
+	{
+		const uint32_t tableSize = GetIcosphereMidpointTableSize(subdivision);
+		uint32_t shift = 64;
+		for (uint32_t size = tableSize; size > 1; size /= 2)
+		{
+			--shift;
+		}
+		for (uint32_t i = 0; i < tableSize; ++i)
+		{
+			table[i].store(0, std::memory_order_relaxed);
+		}
+
+		const uint32_t taskCount = (triangleCount + ICOSPHERE_TRIANGLES_PER_TASK - 1) / ICOSPHERE_TRIANGLES_PER_TASK;
+		auto getCornerEnd = [&](uint32_t taskIndex)
+		{
+			return taskIndex + 1 < taskCount ? (taskIndex + 1) * ICOSPHERE_TRIANGLES_PER_TASK * 3 : triangleCount * 3;
+		};
+
+		// Midpoints are numbered in the order of the half-edges from the lower to the higher vertex, so each task first counts its own
+		RunTasks(threadPool, taskCount, [&](uint32_t taskIndex, uint32_t)
+		{
+			uint32_t ownedEdgeCount = 0;
+			for (uint32_t i = taskIndex * ICOSPHERE_TRIANGLES_PER_TASK * 3; i < getCornerEnd(taskIndex); ++i)
+			{
+				ownedEdgeCount += sourceIndices[i] < sourceIndices[i % 3 == 2 ? i - 2 : i + 1];
+			}
+			taskFirstVertices[taskIndex] = ownedEdgeCount;
+		});
+
+		uint32_t firstVertex = vertexCount;
+		for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+		{
+			const uint32_t ownedEdgeCount = taskFirstVertices[taskIndex];
+			taskFirstVertices[taskIndex] = firstVertex;
+			firstVertex += ownedEdgeCount;
+		}
+
+		RunTasks(threadPool, taskCount, [&](uint32_t taskIndex, uint32_t)
+		{
+			uint32_t vertex = taskFirstVertices[taskIndex];
+			for (uint32_t i = taskIndex * ICOSPHERE_TRIANGLES_PER_TASK * 3; i < getCornerEnd(taskIndex); ++i)
+			{
+				const uint32_t a = sourceIndices[i];
+				const uint32_t b = sourceIndices[i % 3 == 2 ? i - 2 : i + 1];
+				if (a < b)
+				{
+					uint32_t slot = (uint32_t)(HashIcosphereEdge(a, b) >> shift);
+					uint64_t empty = 0;
+					while (!table[slot].compare_exchange_strong(empty, PackIcosphereEdge(a, b) | vertex, std::memory_order_relaxed))
+					{
+						empty = 0;
+						slot = (slot + 1) & (tableSize - 1);
+					}
+					const Float3 position = GetIcosphereMidpoint(vertices[a].Position, vertices[b].Position);
+					vertices[vertex++] = { position, position };
+				}
+			}
+		});
+
+		// Every midpoint is in the table once the previous pass has returned
+		RunTasks(threadPool, taskCount, [&](uint32_t taskIndex, uint32_t)
+		{
+			for (uint32_t triangle = taskIndex * ICOSPHERE_TRIANGLES_PER_TASK; triangle < getCornerEnd(taskIndex) / 3; ++triangle)
+			{
+				const uint32_t corners[3]{ sourceIndices[triangle * 3], sourceIndices[triangle * 3 + 1], sourceIndices[triangle * 3 + 2] };
+				const uint32_t midpoints[3]
+				{
+					FindIcosphereMidpoint(table.get(), tableSize - 1, shift, corners[0], corners[1]),
+					FindIcosphereMidpoint(table.get(), tableSize - 1, shift, corners[1], corners[2]),
+					FindIcosphereMidpoint(table.get(), tableSize - 1, shift, corners[2], corners[0])
+				};
+
+				Index* children = &splitTriangles[(size_t)triangle * 12];
+				children[0] = (Index)corners[0];
+				children[1] = (Index)midpoints[0];
+				children[2] = (Index)midpoints[2];
+				children[3] = (Index)midpoints[0];
+				children[4] = (Index)corners[1];
+				children[5] = (Index)midpoints[1];
+				children[6] = (Index)midpoints[2];
+				children[7] = (Index)midpoints[1];
+				children[8] = (Index)corners[2];
+				children[9] = (Index)midpoints[0];
+				children[10] = (Index)midpoints[1];
+				children[11] = (Index)midpoints[2];
+			}
+		});
+
+		Index* const previousIndices = sourceIndices;
+		sourceIndices = splitTriangles;
+		splitTriangles = previousIndices;
+		vertexCount = firstVertex;
+		triangleCount *= 4;
+	}
+
+	if (sourceIndices != indices.data())
+	{
+		indices.swap(splitIndices);
+	}
+}
+
+template void GenerateIcosphere<uint16_t>(int32_t level, std::vector<VertexData>& outVertices, std::vector<uint16_t>& outIndices, ThreadPool* threadPool);
+template void GenerateIcosphere<uint32_t>(int32_t level, std::vector<VertexData>& outVertices, std::vector<uint32_t>& outIndices, ThreadPool* threadPool);
+
+void GenerateIcosphere(int32_t level, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool)
+{
+	outIndices.Format = SelectIndexFormat(GetPrimitiveVertexCount(PrimitiveShape{ PRIMITIVE_TYPE_ICOSPHERE, level, 0 }));
+	if (outIndices.Format == INDEX_FORMAT_UINT16)
+	{
+		GenerateIcosphere(level, outVertices, outIndices.Indices16, threadPool);
+		outIndices.Indices32.clear();
+	}
+	else
+	{
+		GenerateIcosphere(level, outVertices, outIndices.Indices32, threadPool);
+		outIndices.Indices16.clear();
+	}
+}
+
+void GenerateSphereLodChain(const int32_t* segmentCounts, uint32_t lodCount, std::vector<VertexData>& outVertices, MeshIndices& outIndices,
+	std::vector<MeshLod>& outLods, ThreadPool* threadPool)
+{
+	std::vector<PrimitiveShape> shapes(lodCount);
+	for (uint32_t i = 0; i < lodCount; ++i)
+	{
+		shapes[i] = { PRIMITIVE_TYPE_UV_SPHERE, segmentCounts[i], segmentCounts[i] };
+	}
+	GeneratePrimitiveLodChain(shapes.data(), lodCount, outVertices, outIndices, outLods, threadPool);
+}
+
+float ComputeInnerRadius(const VertexData* vertices, const uint16_t* indices, uint32_t indexCount)
+{
+	float innerRadius = FLT_MAX;
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const Float3& p0 = vertices[indices[i + 0]].Position;
+		const Float3& p1 = vertices[indices[i + 1]].Position;
+		const Float3& p2 = vertices[indices[i + 2]].Position;
+
+		const Float3 normal = Cross(p1 - p0, p2 - p0);
+		const float normalLength = Length(normal);
+		if (normalLength > 0.0f)
+		{
+			innerRadius = fminf(innerRadius, fabsf(Dot(normal, p0)) / normalLength);
+		}
+	}
+	return innerRadius;
+}
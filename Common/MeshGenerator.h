@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "VertexTypes.h"
+
+class ThreadPool;
+
+// Index buffer contents in the smallest format that addresses every vertex. Only the vector of Format is used.
+struct MeshIndices
+{
+	INDEX_FORMAT Format = INDEX_FORMAT_UINT16;
+	std::vector<uint16_t> Indices16;
+	std::vector<uint32_t> Indices32;
+
+	uint32_t GetCount() const { return (uint32_t)(Format == INDEX_FORMAT_UINT16 ? Indices16.size() : Indices32.size()); }
+	uint32_t GetIndexSize() const { return Format == INDEX_FORMAT_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+	const void* GetData() const { return Format == INDEX_FORMAT_UINT16 ? (const void*)Indices16.data() : (const void*)Indices32.data(); }
+};
+
+// 16-bit indices when they address every vertex of a draw, 32-bit otherwise
+inline INDEX_FORMAT SelectIndexFormat(uint64_t vertexCount)
+{
+	return vertexCount <= 65536 ? INDEX_FORMAT_UINT16 : INDEX_FORMAT_UINT32;
+}
+
+// UV sphere of radius 1 with a single vertex at each pole.
+// Vertex count is sliceCount * ringCount + 2 and index count is sliceCount * ringCount * 6.
+// With a threadPool the rings are generated in parallel, with the same result.
+// Index is uint16_t or uint32_t; 16-bit indices need at most 65536 vertices.
+template <typename Index>
+void GenerateSphere(int32_t sliceCount, int32_t ringCount, std::vector<VertexData>& outVertices, std::vector<Index>& outIndices,
+	ThreadPool* threadPool = nullptr);
+
+// Same sphere with the index format picked by SelectIndexFormat
+void GenerateSphere(int32_t sliceCount, int32_t ringCount, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool = nullptr);
+
+constexpr int32_t ICOSPHERE_MAX_LEVEL = 8;
+
+// Icosahedron of radius 1 with every triangle split in four level times, from 0 to ICOSPHERE_MAX_LEVEL, and the new vertices pushed
+// out onto the sphere. Unlike the UV sphere its triangles are all about the same size, without the thin fans around the poles.
+// Vertex count is 10 * 4^level + 2 and index count is 60 * 4^level.
+// The two triangles of an edge share its midpoint through a flat open addressing table keyed by the edge. With a threadPool
+// every subdivision is split over ranges of triangles, with the same result as serially and as PRIMITIVE_TYPE_ICOSPHERE.
+// Index is uint16_t or uint32_t; 16-bit indices go up to level 6.
+template <typename Index>
+void GenerateIcosphere(int32_t level, std::vector<VertexData>& outVertices, std::vector<Index>& outIndices, ThreadPool* threadPool = nullptr);
+
+// Same icosphere with the index format picked by SelectIndexFormat
+void GenerateIcosphere(int32_t level, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool = nullptr);
+
+// One level of detail inside vertex and index buffers shared by the whole chain, as DrawIndexed arguments
+struct MeshLod
+{
+	uint32_t StartIndex;
+	uint32_t IndexCount;
+	int32_t BaseVertex;
+	uint32_t VertexCount;
+};
+
+// Spheres with sliceCount = ringCount = segmentCounts[i] for every level, appended one after another.
+// Indices of a level are relative to its BaseVertex, so the index format only depends on the largest level.
+void GenerateSphereLodChain(const int32_t* segmentCounts, uint32_t lodCount, std::vector<VertexData>& outVertices, MeshIndices& outIndices,
+	std::vector<MeshLod>& outLods, ThreadPool* threadPool = nullptr);
+
+// Distance from the origin to the closest triangle plane. For a convex mesh around the origin, such as the sphere above,
+// it is the radius of the largest sphere at the origin that fits inside.
+float ComputeInnerRadius(const VertexData* vertices, const uint16_t* indices, uint32_t indexCount);
@@ -0,0 +1,1376 @@
+#include "MeshImporter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include <immintrin.h>
+
+#include "Clock.h"
+#include "JsonDocument.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "ThreadPool.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif // _WIN32
+
+namespace
+{
+	// Bytes of OBJ text per parse task, cut at the next line end
+	constexpr uint64_t OBJ_CHUNK_SIZE = 1 << 20;
+
+	// Vertices or triangles of a glTF accessor per task
+	constexpr uint32_t GLTF_ELEMENTS_PER_TASK = 1 << 16;
+
+	// Vertices between hashing one and inserting it, a power of two
+	constexpr uint32_t WELD_PREFETCH_DISTANCE = 16;
+
+	// Normal index of OBJ corners without a normal
+	constexpr uint32_t OBJ_NO_NORMAL = UINT32_MAX;
+
+	constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+	constexpr uint32_t GLB_VERSION = 2;
+	constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+	constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+	constexpr uint32_t GLTF_COMPONENT_UNSIGNED_BYTE = 5121;
+	constexpr uint32_t GLTF_COMPONENT_UNSIGNED_SHORT = 5123;
+	constexpr uint32_t GLTF_COMPONENT_UNSIGNED_INT = 5125;
+	constexpr uint32_t GLTF_COMPONENT_FLOAT = 5126;
+	constexpr uint32_t GLTF_MODE_TRIANGLES = 4;
+	constexpr uint32_t GLTF_MAX_NODE_DEPTH = 64;
+
+	// Every power of ten that a double holds exactly
+	constexpr double POWERS_OF_TEN[]{ 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+		1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	constexpr int32_t MAX_EXACT_POWER_OF_TEN = 22;
+
+	void RunTasks(ThreadPool* threadPool, uint32_t taskCount, const ThreadPool::TaskFunction& task)
+	{
+		if (threadPool && taskCount > 1)
+		{
+			threadPool->ParallelFor(taskCount, task);
+		}
+		else
+		{
+			for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+			{
+				task(taskIndex, 0);
+			}
+		}
+	}
+
+	bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+	bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+	const char* SkipSpaces(const char* cursor, const char* end)
+	{
+		while (cursor < end && IsSpace(*cursor))
+		{
+			++cursor;
+		}
+		return cursor;
+	}
+
+	const char* FindLineEnd(const char* cursor, const char* end)
+	{
+		const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+		return lineEnd ? lineEnd : end;
+	}
+
+	// Decimal number as strtof reads it, without locale, allocation or a terminating zero. Digits past the 19th only move
+	// the exponent; the result is within an ulp of the exact value for the lengths mesh files use.
+	bool ParseFloat(const char*& cursor, const char* end, float& outValue)
+	{
+		const char* p = cursor;
+		bool bNegative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			bNegative = *p == '-';
+			++p;
+		}
+
+		uint64_t mantissa = 0;
+		uint32_t mantissaDigitCount = 0;
+		int32_t exponent = 0;
+		bool bDigits = false;
+		for (; p < end && IsDigit(*p); ++p)
+		{
+			bDigits = true;
+			if (mantissaDigitCount < 19)
+			{
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				mantissaDigitCount += mantissa != 0;
+			}
+			else
+			{
+				++exponent;
+			}
+		}
+		if (p < end && *p == '.')
+		{
+			for (++p; p < end && IsDigit(*p); ++p)
+			{
+				bDigits = true;
+				if (mantissaDigitCount < 19)
+				{
+					mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+					mantissaDigitCount += mantissa != 0;
+					--exponent;
+				}
+			}
+		}
+		if (!bDigits)
+		{
+			return false;
+		}
+
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			const char* exponentCursor = p + 1;
+			bool bNegativeExponent = false;
+			if (exponentCursor < end && (*exponentCursor == '-' || *exponentCursor == '+'))
+			{
+				bNegativeExponent = *exponentCursor == '-';
+				++exponentCursor;
+			}
+			if (exponentCursor < end && IsDigit(*exponentCursor))
+			{
+				int32_t explicitExponent = 0;
+				for (; exponentCursor < end && IsDigit(*exponentCursor); ++exponentCursor)
+				{
+					// Far past the range of a float either way
+					if (explicitExponent < 1000)
+					{
+						explicitExponent = explicitExponent * 10 + (*exponentCursor - '0');
+					}
+				}
+				exponent += bNegativeExponent ? -explicitExponent : explicitExponent;
+				p = exponentCursor;
+			}
+		}
+
+		double value = (double)mantissa;
+		if (mantissa != 0)
+		{
+			for (; exponent > MAX_EXACT_POWER_OF_TEN; exponent -= MAX_EXACT_POWER_OF_TEN)
+			{
+				value *= POWERS_OF_TEN[MAX_EXACT_POWER_OF_TEN];
+			}
+			for (; exponent < -MAX_EXACT_POWER_OF_TEN; exponent += MAX_EXACT_POWER_OF_TEN)
+			{
+				value /= POWERS_OF_TEN[MAX_EXACT_POWER_OF_TEN];
+			}
+			value = exponent >= 0 ? value * POWERS_OF_TEN[exponent] : value / POWERS_OF_TEN[-exponent];
+		}
+
+		outValue = (float)(bNegative ? -value : value);
+		cursor = p;
+		return true;
+	}
+
+	bool ParseInteger(const char*& cursor, const char* end, int64_t& outValue)
+	{
+		const char* p = cursor;
+		const bool bNegative = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			++p;
+		}
+
+		// Longer numbers would overflow, and no index gets close
+		const char* digits = p;
+		int64_t value = 0;
+		for (; p < end && IsDigit(*p); ++p)
+		{
+			if (p - digits == 18)
+			{
+				return false;
+			}
+			value = value * 10 + (*p - '0');
+		}
+		if (p == digits)
+		{
+			return false;
+		}
+
+		outValue = bNegative ? -value : value;
+		cursor = p;
+		return true;
+	}
+
+	// Three floats, with Z negated into the left-handed convention of the samples. Anything after them (w, colors) is ignored.
+	bool ParseFloat3(const char* cursor, const char* end, Float3& outValue)
+	{
+		float values[3];
+		for (float& value : values)
+		{
+			cursor = SkipSpaces(cursor, end);
+			if (!ParseFloat(cursor, end, value) || (cursor < end && !IsSpace(*cursor)))
+			{
+				return false;
+			}
+		}
+
+		outValue = Float3{ values[0], values[1], -values[2] };
+		return true;
+	}
+
+	uint64_t MixHash(uint64_t x)
+	{
+		x ^= x >> 33;
+		x *= 0xFF51AFD7ED558CCDull;
+		x ^= x >> 33;
+		x *= 0xC4CEB9FE1A85EC53ull;
+		x ^= x >> 33;
+		return x;
+	}
+
+	uint64_t HashVertex(const VertexData& vertex)
+	{
+		uint64_t words[3];
+		static_assert(sizeof(words) == sizeof(VertexData), "VertexData is hashed as three 64-bit words");
+		memcpy(words, &vertex, sizeof(words));
+		return MixHash(MixHash(MixHash(words[0]) ^ words[1]) ^ words[2]);
+	}
+
+	// Open addressing map from vertex keys to vertex indices, grown to stay at most half full.
+	// Slots only hold indices, the keys stay with the caller, which hashes and compares them through callbacks.
+	// The slot is taken from the high bits of the hash, so a hash that grows with the key keeps neighbouring keys in neighbouring slots.
+	class WeldTable
+	{
+	public:
+		explicit WeldTable(uint64_t expectedCount)
+		{
+			uint64_t capacity = 1024;
+			Shift = 54;
+			while (capacity < expectedCount * 2)
+			{
+				capacity *= 2;
+				--Shift;
+			}
+			Slots.assign(capacity, EMPTY_SLOT);
+		}
+
+		// Index of the vertex that isEqual matches, or newIndex after adding it
+		template <typename HashOf, typename IsEqual>
+		uint32_t Insert(uint64_t hash, uint32_t newIndex, const HashOf& hashOf, const IsEqual& isEqual)
+		{
+			// Grown before the probe, while every index in the table still has a key to hash
+			if ((Count + 1) * 2 > Slots.size())
+			{
+				Grow(hashOf);
+			}
+
+			const uint64_t mask = Slots.size() - 1;
+			for (uint64_t slot = hash >> Shift;; slot = (slot + 1) & mask)
+			{
+				if (Slots[slot] == EMPTY_SLOT)
+				{
+					Slots[slot] = newIndex;
+					++Count;
+					return newIndex;
+				}
+				if (isEqual(Slots[slot]))
+				{
+					return Slots[slot];
+				}
+			}
+		}
+
+		// Starts loading the slot of a hash that is inserted a few vertices later
+		void Prefetch(uint64_t hash) const
+		{
+			_mm_prefetch((const char*)&Slots[hash >> Shift], _MM_HINT_T0);
+		}
+
+	private:
+		template <typename HashOf>
+		void Grow(const HashOf& hashOf)
+		{
+			std::vector<uint32_t> oldSlots(Slots.size() * 2, EMPTY_SLOT);
+			oldSlots.swap(Slots);
+			--Shift;
+
+			const uint64_t mask = Slots.size() - 1;
+			for (uint32_t index : oldSlots)
+			{
+				if (index != EMPTY_SLOT)
+				{
+					uint64_t slot = hashOf(index) >> Shift;
+					while (Slots[slot] != EMPTY_SLOT)
+					{
+						slot = (slot + 1) & mask;
+					}
+					Slots[slot] = index;
+				}
+			}
+		}
+
+		static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+		std::vector<uint32_t> Slots;
+		uint32_t Shift;
+		uint64_t Count = 0;
+	};
+
+	// Area weighted average of the triangle normals for every vertex flagged in missingNormals. Returns how many there were.
+	uint32_t GenerateMissingNormals(std::vector<VertexData>& vertices, const std::vector<uint8_t>& missingNormals, const std::vector<uint32_t>& indices)
+	{
+		uint32_t missingCount = 0;
+		for (uint8_t bMissing : missingNormals)
+		{
+			missingCount += bMissing;
+		}
+		if (missingCount == 0)
+		{
+			return 0;
+		}
+
+		// Clockwise triangles, so the cross product of the edges points out of the front face
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			const uint32_t triangle[3]{ indices[i], indices[i + 1], indices[i + 2] };
+			const Float3 normal = Cross(vertices[triangle[1]].Position - vertices[triangle[0]].Position, vertices[triangle[2]].Position - vertices[triangle[0]].Position);
+			for (uint32_t index : triangle)
+			{
+				if (missingNormals[index])
+				{
+					vertices[index].Normal += normal;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			if (missingNormals[i])
+			{
+				const float length = Length(vertices[i].Normal);
+				vertices[i].Normal = length > 0.0f ? vertices[i].Normal * (1.0f / length) : Float3{ 0.0f, 1.0f, 0.0f };
+			}
+		}
+		return missingCount;
+	}
+
+	void StoreIndices(std::vector<uint32_t>& indices, uint32_t vertexCount, MeshIndices& outIndices)
+	{
+		outIndices.Format = SelectIndexFormat(vertexCount);
+		outIndices.Indices16.clear();
+		outIndices.Indices32.clear();
+		if (outIndices.Format == INDEX_FORMAT_UINT16)
+		{
+			outIndices.Indices16.assign(indices.begin(), indices.end());
+		}
+		else
+		{
+			outIndices.Indices32.swap(indices);
+		}
+	}
+
+	struct ObjCorner
+	{
+		uint32_t Position;
+		uint32_t Normal;
+	};
+
+	// Whole lines of the file. The counts are taken by a first pass so that every chunk knows its first position and normal.
+	struct ObjChunk
+	{
+		const char* Begin;
+		const char* End;
+		uint64_t PositionCount;
+		uint64_t NormalCount;
+		uint64_t PositionBase;
+		uint64_t NormalBase;
+
+		// Three per triangle
+		std::vector<ObjCorner> Corners;
+
+		const char* Error;
+	};
+
+	// Keyword at the start of a line, such as "v" or "vn", followed by a space
+	bool IsObjKeyword(const char* cursor, const char* lineEnd, const char* keyword, size_t keywordLength)
+	{
+		return (size_t)(lineEnd - cursor) > keywordLength && !memcmp(cursor, keyword, keywordLength) && IsSpace(cursor[keywordLength]);
+	}
+
+	void CountObjElements(ObjChunk& chunk)
+	{
+		for (const char* line = chunk.Begin; line < chunk.End;)
+		{
+			const char* lineEnd = FindLineEnd(line, chunk.End);
+			const char* cursor = SkipSpaces(line, lineEnd);
+			chunk.PositionCount += IsObjKeyword(cursor, lineEnd, "v", 1);
+			chunk.NormalCount += IsObjKeyword(cursor, lineEnd, "vn", 2);
+			line = lineEnd < chunk.End ? lineEnd + 1 : chunk.End;
+		}
+	}
+
+	// 1-based index, or negative from the last element defined before the line
+	bool ParseObjIndex(const char*& cursor, const char* end, uint64_t definedCount, uint64_t totalCount, uint32_t& outIndex)
+	{
+		int64_t index;
+		if (!ParseInteger(cursor, end, index) || index == 0)
+		{
+			return false;
+		}
+
+		const int64_t resolvedIndex = index > 0 ? index - 1 : (int64_t)definedCount + index;
+		if (resolvedIndex < 0 || (uint64_t)resolvedIndex >= totalCount)
+		{
+			return false;
+		}
+		outIndex = (uint32_t)resolvedIndex;
+		return true;
+	}
+
+	// Corners of one "f" line, fanned into clockwise triangles. Corners are v, v/vt, v//vn or v/vt/vn.
+	bool ParseObjFace(const char* cursor, const char* lineEnd, uint64_t positionBase, uint64_t positionCount, uint64_t normalBase, uint64_t normalCount,
+		std::vector<ObjCorner>& outCorners)
+	{
+		ObjCorner first{};
+		ObjCorner previous{};
+		uint32_t cornerCount = 0;
+		for (;;)
+		{
+			cursor = SkipSpaces(cursor, lineEnd);
+			if (cursor == lineEnd)
+			{
+				break;
+			}
+
+			ObjCorner corner{ 0, OBJ_NO_NORMAL };
+			if (!ParseObjIndex(cursor, lineEnd, positionBase, positionCount, corner.Position))
+			{
+				return false;
+			}
+			if (cursor < lineEnd && *cursor == '/')
+			{
+				int64_t textureIndex;
+				++cursor;
+				if (cursor < lineEnd && *cursor != '/' && !ParseInteger(cursor, lineEnd, textureIndex))
+				{
+					return false;
+				}
+				if (cursor < lineEnd && *cursor == '/')
+				{
+					++cursor;
+					if (!ParseObjIndex(cursor, lineEnd, normalBase, normalCount, corner.Normal))
+					{
+						return false;
+					}
+				}
+			}
+			if (cursor < lineEnd && !IsSpace(*cursor))
+			{
+				return false;
+			}
+
+			if (cornerCount == 0)
+			{
+				first = corner;
+			}
+			else if (cornerCount >= 2)
+			{
+				outCorners.push_back(first);
+				outCorners.push_back(corner);
+				outCorners.push_back(previous);
+			}
+			previous = corner;
+			++cornerCount;
+		}
+		return cornerCount >= 3;
+	}
+
+	void ParseObjChunk(ObjChunk& chunk, Float3* positions, uint64_t positionCount, Float3* normals, uint64_t normalCount)
+	{
+		// About one triangle per 32 bytes in files with normals
+		chunk.Corners.reserve((chunk.End - chunk.Begin) / 32 * 3);
+
+		uint64_t positionIndex = chunk.PositionBase;
+		uint64_t normalIndex = chunk.NormalBase;
+		for (const char* line = chunk.Begin; line < chunk.End;)
+		{
+			const char* lineEnd = FindLineEnd(line, chunk.End);
+			const char* cursor = SkipSpaces(line, lineEnd);
+			if (IsObjKeyword(cursor, lineEnd, "v", 1))
+			{
+				if (!ParseFloat3(cursor + 2, lineEnd, positions[positionIndex++]))
+				{
+					chunk.Error = "invalid vertex position";
+					return;
+				}
+			}
+			else if (IsObjKeyword(cursor, lineEnd, "vn", 2))
+			{
+				if (!ParseFloat3(cursor + 3, lineEnd, normals[normalIndex++]))
+				{
+					chunk.Error = "invalid vertex normal";
+					return;
+				}
+			}
+			else if (IsObjKeyword(cursor, lineEnd, "f", 1))
+			{
+				if (!ParseObjFace(cursor + 2, lineEnd, positionIndex, positionCount, normalIndex, normalCount, chunk.Corners))
+				{
+					chunk.Error = "invalid face";
+					return;
+				}
+			}
+			// Everything else (comments, texture coordinates, groups, materials, lines, points) is skipped
+			line = lineEnd < chunk.End ? lineEnd + 1 : chunk.End;
+		}
+	}
+
+	bool ImportObj(const MappedFile& file, ImportedMesh& outMesh, ThreadPool* threadPool, MeshImportStats& stats)
+	{
+		const char* text = (const char*)file.GetData();
+		const char* textEnd = text + file.GetSize();
+		const uint64_t parseTicks = Clock::GetTicks();
+
+		// Chunks of about OBJ_CHUNK_SIZE that end on a line end
+		std::vector<ObjChunk> chunks;
+		for (const char* begin = text; begin < textEnd;)
+		{
+			const char* end = (uint64_t)(textEnd - begin) > OBJ_CHUNK_SIZE ? FindLineEnd(begin + OBJ_CHUNK_SIZE, textEnd) : textEnd;
+			end = end < textEnd ? end + 1 : textEnd;
+			chunks.push_back(ObjChunk{ begin, end, 0, 0, 0, 0, {}, nullptr });
+			begin = end;
+		}
+		const uint32_t chunkCount = (uint32_t)chunks.size();
+		stats.TaskCount = chunkCount;
+
+		RunTasks(threadPool, chunkCount, [&](uint32_t chunkIndex, uint32_t)
+			{
+				CountObjElements(chunks[chunkIndex]);
+			});
+
+		uint64_t positionCount = 0;
+		uint64_t normalCount = 0;
+		for (ObjChunk& chunk : chunks)
+		{
+			chunk.PositionBase = positionCount;
+			chunk.NormalBase = normalCount;
+			positionCount += chunk.PositionCount;
+			normalCount += chunk.NormalCount;
+		}
+		if (positionCount >= UINT32_MAX || normalCount >= UINT32_MAX)
+		{
+			stats.Error = "too many vertices";
+			return false;
+		}
+
+		// Every chunk writes its positions and normals in place
+		std::vector<Float3> positions(positionCount);
+		std::vector<Float3> normals(normalCount);
+		RunTasks(threadPool, chunkCount, [&](uint32_t chunkIndex, uint32_t)
+			{
+				ParseObjChunk(chunks[chunkIndex], positions.data(), positionCount, normals.data(), normalCount);
+			});
+
+		uint64_t cornerCount = 0;
+		for (const ObjChunk& chunk : chunks)
+		{
+			if (chunk.Error)
+			{
+				stats.Error = chunk.Error;
+				return false;
+			}
+			cornerCount += chunk.Corners.size();
+		}
+		stats.SourceVertexCount = positionCount;
+		stats.CornerCount = cornerCount;
+		stats.ParseMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - parseTicks);
+		if (cornerCount == 0)
+		{
+			stats.Error = "no triangles";
+			return false;
+		}
+
+		// A vertex for every distinct pair of position and normal index, in the order of their first use
+		const uint64_t weldTicks = Clock::GetTicks();
+		std::vector<uint64_t> keys;
+		keys.reserve(positionCount);
+		std::vector<uint32_t> indices;
+		indices.reserve(cornerCount);
+		WeldTable table(positionCount);
+		// Hashed by position alone and in order: faces mostly use nearby positions, so they probe nearby slots instead of
+		// missing the cache on every corner. Normals of the same position are told apart by the comparison.
+		const uint64_t positionScale = UINT64_MAX / positionCount;
+		const auto hashOf = [&](uint32_t index) { return (keys[index] >> 32) * positionScale; };
+		for (ObjChunk& chunk : chunks)
+		{
+			for (const ObjCorner& corner : chunk.Corners)
+			{
+				const uint64_t key = (uint64_t)corner.Position << 32 | corner.Normal;
+				const uint32_t newIndex = (uint32_t)keys.size();
+				const uint32_t index = table.Insert(corner.Position * positionScale, newIndex, hashOf, [&](uint32_t other) { return keys[other] == key; });
+				if (index == newIndex)
+				{
+					keys.push_back(key);
+				}
+				indices.push_back(index);
+			}
+
+			// Release the corners as they are consumed, they are the largest allocation
+			std::vector<ObjCorner>().swap(chunk.Corners);
+		}
+
+		const uint32_t vertexCount = (uint32_t)keys.size();
+		outMesh.Vertices.resize(vertexCount);
+		std::vector<uint8_t> missingNormals(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			const uint32_t normal = (uint32_t)keys[i];
+			outMesh.Vertices[i].Position = positions[keys[i] >> 32];
+			outMesh.Vertices[i].Normal = normal == OBJ_NO_NORMAL ? Float3{ 0.0f, 0.0f, 0.0f } : normals[normal];
+			missingNormals[i] = normal == OBJ_NO_NORMAL;
+		}
+
+		stats.GeneratedNormalCount = GenerateMissingNormals(outMesh.Vertices, missingNormals, indices);
+		StoreIndices(indices, vertexCount, outMesh.Indices);
+		stats.WeldMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - weldTicks);
+		return true;
+	}
+
+	struct GltfBuffer
+	{
+		const uint8_t* Data;
+		uint64_t Size;
+	};
+
+	// Elements of an accessor, Stride bytes apart
+	struct GltfAccessor
+	{
+		const uint8_t* Data;
+		uint32_t Count;
+		uint32_t Stride;
+		uint32_t ComponentType;
+	};
+
+	// One triangle list primitive of a mesh instance, with its range in the concatenated vertices and indices
+	struct GltfDraw
+	{
+		GltfAccessor Positions;
+		GltfAccessor Normals;
+		GltfAccessor Indices;
+		uint32_t TriangleCount;
+		Float4x4 World;
+		Float3 NormalMatrix[3];
+		bool bIdentity;
+		bool bMirrored;
+		uint32_t VertexBase;
+		uint64_t IndexBase;
+	};
+
+	struct GltfTask
+	{
+		uint32_t Draw;
+		bool bIndices;
+		uint32_t Begin;
+		uint32_t End;
+	};
+
+	uint32_t GetComponentSize(uint32_t componentType)
+	{
+		switch (componentType)
+		{
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return 1;
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+			return 2;
+		default:
+			return 4;
+		}
+	}
+
+	// Position or normal accessors (VEC3 of FLOAT) when bIndices is false, index accessors (SCALAR of unsigned integers) otherwise.
+	// Checks that every element lies inside its buffer view and buffer.
+	const char* GetGltfAccessor(const JsonDocument& document, const std::vector<GltfBuffer>& buffers, uint32_t accessorIndex, bool bIndices, GltfAccessor& outAccessor)
+	{
+		const JsonValue* root = document.GetRoot();
+		const JsonValue* accessor = document.At(document.Find(root, "accessors"), accessorIndex);
+		if (!accessor)
+		{
+			return "missing accessor";
+		}
+		if (document.Find(accessor, "sparse"))
+		{
+			return "sparse accessors are not supported";
+		}
+
+		const uint32_t componentType = document.GetUint(accessor, "componentType", 0);
+		const bool bValidType = bIndices
+			? (componentType == GLTF_COMPONENT_UNSIGNED_BYTE || componentType == GLTF_COMPONENT_UNSIGNED_SHORT || componentType == GLTF_COMPONENT_UNSIGNED_INT)
+				&& JsonDocument::IsString(document.Find(accessor, "type"), "SCALAR")
+			: componentType == GLTF_COMPONENT_FLOAT && JsonDocument::IsString(document.Find(accessor, "type"), "VEC3");
+		if (!bValidType)
+		{
+			return bIndices ? "indices are not unsigned integer scalars" : "positions or normals are not float vectors";
+		}
+
+		const JsonValue* view = document.At(document.Find(root, "bufferViews"), document.GetUint(accessor, "bufferView", UINT32_MAX));
+		const uint32_t bufferIndex = document.GetUint(view, "buffer", UINT32_MAX);
+		if (!view || bufferIndex >= buffers.size())
+		{
+			return "accessor without buffer view";
+		}
+
+		const uint32_t elementSize = GetComponentSize(componentType) * (bIndices ? 1 : 3);
+		uint64_t viewOffset = 0;
+		uint64_t viewSize = 0;
+		uint64_t offset = 0;
+		if (!document.GetUint64(view, "byteOffset", 0, viewOffset) || !document.GetUint64(view, "byteLength", 0, viewSize)
+			|| !document.GetUint64(accessor, "byteOffset", 0, offset))
+		{
+			return "byte offset or length is not a whole number";
+		}
+
+		// Every subtraction is from a value known to be larger, so that no sum of file values can wrap around
+		const uint32_t stride = document.GetUint(view, "byteStride", elementSize);
+		const uint32_t count = document.GetUint(accessor, "count", 0);
+		const GltfBuffer& buffer = buffers[bufferIndex];
+		if (viewOffset > buffer.Size || viewSize > buffer.Size - viewOffset || stride < elementSize
+			|| offset > viewSize || elementSize > viewSize - offset
+			|| (count > 0 && (uint64_t)stride * (count - 1) > viewSize - offset - elementSize))
+		{
+			return "accessor outside of its buffer";
+		}
+
+		outAccessor = GltfAccessor{ buffer.Data + viewOffset + offset, count, stride, componentType };
+		return nullptr;
+	}
+
+	Float3 ReadFloat3(const GltfAccessor& accessor, uint32_t index)
+	{
+		Float3 value;
+		memcpy(&value, accessor.Data + (uint64_t)index * accessor.Stride, sizeof(value));
+		return value;
+	}
+
+	uint32_t ReadIndex(const GltfAccessor& accessor, uint32_t index)
+	{
+		const uint8_t* data = accessor.Data + (uint64_t)index * accessor.Stride;
+		switch (accessor.ComponentType)
+		{
+		case GLTF_COMPONENT_UNSIGNED_BYTE:
+			return *data;
+		case GLTF_COMPONENT_UNSIGNED_SHORT:
+		{
+			uint16_t value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+		default:
+		{
+			uint32_t value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+		}
+	}
+
+	bool ReadNumbers(const JsonDocument& document, const JsonValue* array, float* outValues, uint32_t count)
+	{
+		if (!array || array->Type != JSON_TYPE_ARRAY || array->ChildCount != count)
+		{
+			return false;
+		}
+
+		uint32_t i = 0;
+		for (const JsonValue* value = document.GetFirstChild(array); value; value = document.GetNextSibling(value))
+		{
+			if (value->Type != JSON_TYPE_NUMBER)
+			{
+				return false;
+			}
+			outValues[i++] = (float)value->Number;
+		}
+		return true;
+	}
+
+	// Local transform of a node, from its matrix or its translation, rotation and scale.
+	// glTF stores column-major matrices for column vectors, which is the same memory as the row vectors of MathTypes.
+	Float4x4 GetGltfNodeTransform(const JsonDocument& document, const JsonValue* node)
+	{
+		Float4x4 matrix;
+		if (ReadNumbers(document, document.Find(node, "matrix"), &matrix.m[0][0], 16))
+		{
+			return matrix;
+		}
+
+		float translation[3]{ 0.0f, 0.0f, 0.0f };
+		Float4 rotation{ 0.0f, 0.0f, 0.0f, 1.0f };
+		float scale[3]{ 1.0f, 1.0f, 1.0f };
+		ReadNumbers(document, document.Find(node, "translation"), translation, 3);
+		ReadNumbers(document, document.Find(node, "rotation"), &rotation.x, 4);
+		ReadNumbers(document, document.Find(node, "scale"), scale, 3);
+
+		// Scale, then rotate, then translate; the rows of the rotation are the rotated axes
+		matrix = MatrixIdentity();
+		const Float3 axes[3]{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		for (int32_t row = 0; row < 3; ++row)
+		{
+			const Float3 axis = Vector3Rotate(axes[row], rotation) * scale[row];
+			matrix.m[row][0] = axis.x;
+			matrix.m[row][1] = axis.y;
+			matrix.m[row][2] = axis.z;
+			matrix.m[3][row] = translation[row];
+		}
+		return matrix;
+	}
+
+	struct GltfInstance
+	{
+		uint32_t Mesh;
+		Float4x4 World;
+	};
+
+	void CollectGltfInstances(const JsonDocument& document, uint32_t nodeIndex, const Float4x4& parentWorld, uint32_t depth, std::vector<GltfInstance>& outInstances)
+	{
+		const JsonValue* node = document.At(document.Find(document.GetRoot(), "nodes"), nodeIndex);
+		if (!node || depth > GLTF_MAX_NODE_DEPTH)
+		{
+			return;
+		}
+
+		const Float4x4 world = GetGltfNodeTransform(document, node) * parentWorld;
+		const uint32_t mesh = document.GetUint(node, "mesh", UINT32_MAX);
+		if (mesh != UINT32_MAX)
+		{
+			outInstances.push_back(GltfInstance{ mesh, world });
+		}
+
+		const JsonValue* children = document.Find(node, "children");
+		for (const JsonValue* child = children ? document.GetFirstChild(children) : nullptr; child; child = document.GetNextSibling(child))
+		{
+			if (child->Type == JSON_TYPE_NUMBER)
+			{
+				CollectGltfInstances(document, (uint32_t)child->Number, world, depth + 1, outInstances);
+			}
+		}
+	}
+
+	int32_t DecodeBase64Character(char c)
+	{
+		if (c >= 'A' && c <= 'Z') return c - 'A';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if (c >= '0' && c <= '9') return c - '0' + 52;
+		if (c == '+') return 62;
+		if (c == '/') return 63;
+		return -1;
+	}
+
+	bool DecodeBase64(const char* text, size_t length, std::vector<uint8_t>& outData)
+	{
+		outData.clear();
+		outData.reserve(length / 4 * 3);
+
+		uint32_t bits = 0;
+		uint32_t bitCount = 0;
+		for (size_t i = 0; i < length && text[i] != '='; ++i)
+		{
+			const int32_t value = DecodeBase64Character(text[i]);
+			if (value < 0)
+			{
+				return false;
+			}
+			bits = bits << 6 | (uint32_t)value;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				outData.push_back((uint8_t)(bits >> bitCount));
+			}
+		}
+		return true;
+	}
+
+	// Path of a relative URI next to the glTF file, with percent escapes decoded
+	std::string ResolveGltfUri(const char* fileName, const JsonValue* uri)
+	{
+		const char* directoryEnd = fileName;
+		for (const char* c = fileName; *c; ++c)
+		{
+			if (*c == '/' || *c == '\\')
+			{
+				directoryEnd = c + 1;
+			}
+		}
+
+		std::string path(fileName, directoryEnd);
+		for (uint32_t i = 0; i < uri->StringLength; ++i)
+		{
+			const char* c = uri->String + i;
+			if (*c == '%' && i + 2 < uri->StringLength)
+			{
+				const char hex[3]{ c[1], c[2], 0 };
+				path += (char)strtol(hex, nullptr, 16);
+				i += 2;
+			}
+			else
+			{
+				path += *c;
+			}
+		}
+		return path;
+	}
+
+	// Everything a glTF import keeps alive until the vertices are copied out
+	struct GltfSources
+	{
+		std::vector<GltfBuffer> Buffers;
+		std::vector<std::unique_ptr<MappedFile>> Files;
+		std::vector<std::vector<uint8_t>> DecodedBuffers;
+	};
+
+	const char* OpenGltfBuffers(const JsonDocument& document, const char* fileName, const GltfBuffer& binaryChunk, GltfSources& outSources, uint64_t& inOutFileSize)
+	{
+		const JsonValue* buffers = document.Find(document.GetRoot(), "buffers");
+		for (const JsonValue* buffer = buffers ? document.GetFirstChild(buffers) : nullptr; buffer; buffer = document.GetNextSibling(buffer))
+		{
+			const JsonValue* uri = document.Find(buffer, "uri");
+			GltfBuffer source{ nullptr, 0 };
+			if (!uri)
+			{
+				// The binary chunk of a .glb
+				source = binaryChunk;
+			}
+			else if (uri->Type == JSON_TYPE_STRING && uri->StringLength > 5 && !memcmp(uri->String, "data:", 5))
+			{
+				const char* marker = ";base64,";
+				const char* dataEnd = uri->String + uri->StringLength;
+				const char* data = std::search(uri->String, dataEnd, marker, marker + strlen(marker));
+				outSources.DecodedBuffers.emplace_back();
+				if (data == dataEnd || !DecodeBase64(data + strlen(marker), dataEnd - data - strlen(marker), outSources.DecodedBuffers.back()))
+				{
+					return "invalid data URI";
+				}
+				source = GltfBuffer{ outSources.DecodedBuffers.back().data(), outSources.DecodedBuffers.back().size() };
+			}
+			else if (uri->Type == JSON_TYPE_STRING)
+			{
+				outSources.Files.push_back(std::make_unique<MappedFile>());
+				MappedFile& file = *outSources.Files.back();
+				if (!file.Open(ResolveGltfUri(fileName, uri).c_str()))
+				{
+					return "cannot open a buffer file";
+				}
+				source = GltfBuffer{ file.GetData(), file.GetSize() };
+				inOutFileSize += file.GetSize();
+			}
+
+			uint64_t byteLength = 0;
+			if (!document.GetUint64(buffer, "byteLength", 0, byteLength))
+			{
+				return "buffer byteLength is not a whole number";
+			}
+			if (!source.Data || byteLength > source.Size)
+			{
+				return "buffer shorter than its byteLength";
+			}
+			outSources.Buffers.push_back(GltfBuffer{ source.Data, byteLength });
+		}
+		return nullptr;
+	}
+
+	// Triangle list primitives of every mesh instance of the default scene, or of every mesh once when there is no scene
+	const char* CollectGltfDraws(const JsonDocument& document, const std::vector<GltfBuffer>& buffers, std::vector<GltfDraw>& outDraws)
+	{
+		const JsonValue* root = document.GetRoot();
+		const JsonValue* meshes = document.Find(root, "meshes");
+		std::vector<GltfInstance> instances;
+		const JsonValue* scene = document.At(document.Find(root, "scenes"), document.GetUint(root, "scene", 0));
+		if (scene)
+		{
+			const JsonValue* nodes = document.Find(scene, "nodes");
+			for (const JsonValue* node = nodes ? document.GetFirstChild(nodes) : nullptr; node; node = document.GetNextSibling(node))
+			{
+				if (node->Type == JSON_TYPE_NUMBER)
+				{
+					CollectGltfInstances(document, (uint32_t)node->Number, MatrixIdentity(), 0, instances);
+				}
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; meshes && i < meshes->ChildCount; ++i)
+			{
+				instances.push_back(GltfInstance{ i, MatrixIdentity() });
+			}
+		}
+
+		for (const GltfInstance& instance : instances)
+		{
+			const JsonValue* primitives = document.Find(document.At(meshes, instance.Mesh), "primitives");
+			for (const JsonValue* primitive = primitives ? document.GetFirstChild(primitives) : nullptr; primitive; primitive = document.GetNextSibling(primitive))
+			{
+				const JsonValue* attributes = document.Find(primitive, "attributes");
+				const uint32_t positions = document.GetUint(attributes, "POSITION", UINT32_MAX);
+				if (document.GetUint(primitive, "mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES || positions == UINT32_MAX)
+				{
+					continue;
+				}
+
+				GltfDraw draw{};
+				const char* error = GetGltfAccessor(document, buffers, positions, false, draw.Positions);
+				const uint32_t normals = document.GetUint(attributes, "NORMAL", UINT32_MAX);
+				if (!error && normals != UINT32_MAX)
+				{
+					error = GetGltfAccessor(document, buffers, normals, false, draw.Normals);
+					if (!error && draw.Normals.Count != draw.Positions.Count)
+					{
+						error = "normal and position counts differ";
+					}
+				}
+				const uint32_t indices = document.GetUint(primitive, "indices", UINT32_MAX);
+				if (!error && indices != UINT32_MAX)
+				{
+					error = GetGltfAccessor(document, buffers, indices, true, draw.Indices);
+				}
+				if (error)
+				{
+					return error;
+				}
+
+				draw.TriangleCount = (draw.Indices.Data ? draw.Indices.Count : draw.Positions.Count) / 3;
+				draw.World = instance.World;
+				const Float4x4 identity = MatrixIdentity();
+				draw.bIdentity = !memcmp(&instance.World, &identity, sizeof(identity));
+
+				// Inverse transpose of the upper 3x3 up to its scale, which the normalization removes, but not its sign
+				const Float4x4& world = instance.World;
+				const Float3 rows[3]{ { world.m[0][0], world.m[0][1], world.m[0][2] }, { world.m[1][0], world.m[1][1], world.m[1][2] },
+					{ world.m[2][0], world.m[2][1], world.m[2][2] } };
+				const float determinant = Dot(rows[0], Cross(rows[1], rows[2]));
+				const float sign = determinant < 0.0f ? -1.0f : 1.0f;
+				draw.NormalMatrix[0] = Cross(rows[1], rows[2]) * sign;
+				draw.NormalMatrix[1] = Cross(rows[2], rows[0]) * sign;
+				draw.NormalMatrix[2] = Cross(rows[0], rows[1]) * sign;
+				draw.bMirrored = determinant < 0.0f;
+				outDraws.push_back(draw);
+			}
+		}
+		return nullptr;
+	}
+
+	bool ImportGltf(const MappedFile& file, const char* fileName, bool bBinary, ImportedMesh& outMesh, ThreadPool* threadPool, MeshImportStats& stats)
+	{
+		const uint64_t parseTicks = Clock::GetTicks();
+		const uint8_t* data = file.GetData();
+		const uint64_t size = file.GetSize();
+
+		// .glb: a 12-byte header, then chunks of length, type and data, the JSON first and an optional binary chunk
+		const char* json = (const char*)data;
+		uint64_t jsonSize = size;
+		GltfBuffer binaryChunk{ nullptr, 0 };
+		if (bBinary)
+		{
+			uint32_t header[3];
+			uint32_t chunkHeader[2];
+			if (size < sizeof(header) + sizeof(chunkHeader))
+			{
+				stats.Error = "truncated .glb header";
+				return false;
+			}
+			memcpy(header, data, sizeof(header));
+			memcpy(chunkHeader, data + sizeof(header), sizeof(chunkHeader));
+			const uint64_t jsonOffset = sizeof(header) + sizeof(chunkHeader);
+			if (header[0] != GLB_MAGIC || header[1] != GLB_VERSION || header[2] > size || chunkHeader[1] != GLB_CHUNK_JSON || chunkHeader[0] > header[2] - jsonOffset)
+			{
+				stats.Error = "invalid .glb header";
+				return false;
+			}
+			json = (const char*)data + jsonOffset;
+			jsonSize = chunkHeader[0];
+
+			const uint64_t binaryOffset = jsonOffset + (jsonSize + 3) / 4 * 4;
+			if (binaryOffset + sizeof(chunkHeader) <= header[2])
+			{
+				memcpy(chunkHeader, data + binaryOffset, sizeof(chunkHeader));
+				if (chunkHeader[1] == GLB_CHUNK_BIN && chunkHeader[0] <= header[2] - binaryOffset - sizeof(chunkHeader))
+				{
+					binaryChunk = GltfBuffer{ data + binaryOffset + sizeof(chunkHeader), chunkHeader[0] };
+				}
+			}
+		}
+		// UTF-8 byte order mark
+		if (jsonSize >= 3 && !memcmp(json, "\xEF\xBB\xBF", 3))
+		{
+			json += 3;
+			jsonSize -= 3;
+		}
+
+		JsonDocument document;
+		if (!document.Parse(json, (size_t)jsonSize) || document.GetRoot()->Type != JSON_TYPE_OBJECT)
+		{
+			stats.Error = "invalid JSON";
+			return false;
+		}
+
+		// External buffers are mapped too, their time counts as mapping
+		const uint64_t mapTicks = Clock::GetTicks();
+		GltfSources sources;
+		stats.Error = OpenGltfBuffers(document, fileName, binaryChunk, sources, stats.FileSize);
+		const double mapMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - mapTicks);
+		stats.MapMilliseconds += mapMilliseconds;
+
+		std::vector<GltfDraw> draws;
+		if (!stats.Error)
+		{
+			stats.Error = CollectGltfDraws(document, sources.Buffers, draws);
+		}
+		if (stats.Error)
+		{
+			return false;
+		}
+
+		// Every draw gets its own range of the concatenated vertices and indices, split into tasks
+		uint64_t vertexCount = 0;
+		uint64_t indexCount = 0;
+		std::vector<GltfTask> tasks;
+		for (uint32_t i = 0; i < (uint32_t)draws.size(); ++i)
+		{
+			GltfDraw& draw = draws[i];
+			if (vertexCount + draw.Positions.Count >= UINT32_MAX)
+			{
+				stats.Error = "too many vertices";
+				return false;
+			}
+			draw.VertexBase = (uint32_t)vertexCount;
+			draw.IndexBase = indexCount;
+			vertexCount += draw.Positions.Count;
+			indexCount += (uint64_t)draw.TriangleCount * 3;
+
+			for (uint32_t begin = 0; begin < draw.Positions.Count; begin += GLTF_ELEMENTS_PER_TASK)
+			{
+				tasks.push_back(GltfTask{ i, false, begin, begin + (draw.Positions.Count - begin < GLTF_ELEMENTS_PER_TASK ? draw.Positions.Count - begin : GLTF_ELEMENTS_PER_TASK) });
+			}
+			for (uint32_t begin = 0; begin < draw.TriangleCount; begin += GLTF_ELEMENTS_PER_TASK)
+			{
+				tasks.push_back(GltfTask{ i, true, begin, begin + (draw.TriangleCount - begin < GLTF_ELEMENTS_PER_TASK ? draw.TriangleCount - begin : GLTF_ELEMENTS_PER_TASK) });
+			}
+		}
+		stats.TaskCount = (uint32_t)tasks.size();
+		stats.SourceVertexCount = vertexCount;
+		stats.CornerCount = indexCount;
+		if (indexCount == 0)
+		{
+			stats.Error = "no triangles";
+			return false;
+		}
+
+		std::vector<VertexData> vertices(vertexCount);
+		std::vector<uint8_t> missingNormals(vertexCount);
+		std::vector<uint32_t> indices(indexCount);
+		std::atomic<bool> bIndexOutOfRange{ false };
+		RunTasks(threadPool, (uint32_t)tasks.size(), [&](uint32_t taskIndex, uint32_t)
+			{
+				const GltfTask& task = tasks[taskIndex];
+				const GltfDraw& draw = draws[task.Draw];
+				if (!task.bIndices)
+				{
+					for (uint32_t i = task.Begin; i < task.End; ++i)
+					{
+						// Untransformed vertices keep the exact values of the file
+						VertexData& vertex = vertices[draw.VertexBase + i];
+						vertex.Position = ReadFloat3(draw.Positions, i);
+						vertex.Normal = draw.Normals.Data ? ReadFloat3(draw.Normals, i) : Float3{ 0.0f, 0.0f, 0.0f };
+						missingNormals[draw.VertexBase + i] = draw.Normals.Data == nullptr;
+						if (!draw.bIdentity)
+						{
+							vertex.Position = ToFloat3(TransformCoord(vertex.Position, draw.World));
+							const Float3 normal = draw.NormalMatrix[0] * vertex.Normal.x + draw.NormalMatrix[1] * vertex.Normal.y + draw.NormalMatrix[2] * vertex.Normal.z;
+							const float length = Length(normal);
+							vertex.Normal = length > 0.0f ? normal * (1.0f / length) : normal;
+						}
+						vertex.Position.z = -vertex.Position.z;
+						vertex.Normal.z = -vertex.Normal.z;
+					}
+					return;
+				}
+
+				for (uint32_t triangle = task.Begin; triangle < task.End; ++triangle)
+				{
+					uint32_t corners[3];
+					for (uint32_t k = 0; k < 3; ++k)
+					{
+						corners[k] = draw.Indices.Data ? ReadIndex(draw.Indices, triangle * 3 + k) : triangle * 3 + k;
+						if (corners[k] >= draw.Positions.Count)
+						{
+							bIndexOutOfRange = true;
+							corners[k] = 0;
+						}
+					}
+					// Counter-clockwise to clockwise, unless the node mirrors the mesh
+					if (!draw.bMirrored)
+					{
+						const uint32_t swap = corners[1];
+						corners[1] = corners[2];
+						corners[2] = swap;
+					}
+
+					uint32_t* outCorners = &indices[draw.IndexBase + (uint64_t)triangle * 3];
+					for (uint32_t k = 0; k < 3; ++k)
+					{
+						outCorners[k] = draw.VertexBase + corners[k];
+					}
+				}
+			});
+		stats.ParseMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - parseTicks) - mapMilliseconds;
+		if (bIndexOutOfRange)
+		{
+			stats.Error = "index outside of its primitive";
+			return false;
+		}
+
+		// glTF vertices are already indexed, welding merges the copies that exporters split between primitives and instances
+		const uint64_t weldTicks = Clock::GetTicks();
+		std::vector<uint32_t> remap(vertexCount);
+		outMesh.Vertices.clear();
+		outMesh.Vertices.reserve(vertexCount);
+		std::vector<uint8_t> weldedMissingNormals;
+		weldedMissingNormals.reserve(vertexCount);
+		WeldTable table(vertexCount);
+		const auto hashOf = [&](uint32_t index) { return HashVertex(outMesh.Vertices[index]); };
+		// The vertices come in file order, unrelated to their hashes, so every slot would be a cache miss without the prefetch
+		uint64_t hashes[WELD_PREFETCH_DISTANCE];
+		for (uint32_t i = 0; i < WELD_PREFETCH_DISTANCE && i < vertexCount; ++i)
+		{
+			hashes[i] = HashVertex(vertices[i]);
+			table.Prefetch(hashes[i]);
+		}
+		for (uint32_t i = 0; i < (uint32_t)vertexCount; ++i)
+		{
+			const VertexData& vertex = vertices[i];
+			const uint64_t hash = hashes[i % WELD_PREFETCH_DISTANCE];
+			if (i + WELD_PREFETCH_DISTANCE < vertexCount)
+			{
+				hashes[i % WELD_PREFETCH_DISTANCE] = HashVertex(vertices[i + WELD_PREFETCH_DISTANCE]);
+				table.Prefetch(hashes[i % WELD_PREFETCH_DISTANCE]);
+			}
+
+			const uint32_t newIndex = (uint32_t)outMesh.Vertices.size();
+			remap[i] = table.Insert(hash, newIndex, hashOf,
+				[&](uint32_t other) { return !memcmp(&outMesh.Vertices[other], &vertex, sizeof(VertexData)) && weldedMissingNormals[other] == missingNormals[i]; });
+			if (remap[i] == newIndex)
+			{
+				outMesh.Vertices.push_back(vertex);
+				weldedMissingNormals.push_back(missingNormals[i]);
+			}
+		}
+		for (uint32_t& index : indices)
+		{
+			index = remap[index];
+		}
+
+		const uint32_t weldedCount = (uint32_t)outMesh.Vertices.size();
+		stats.GeneratedNormalCount = GenerateMissingNormals(outMesh.Vertices, weldedMissingNormals, indices);
+		StoreIndices(indices, weldedCount, outMesh.Indices);
+		stats.WeldMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - weldTicks);
+		return true;
+	}
+}
+
+MESH_FILE_FORMAT GetMeshFileFormat(const char* fileName)
+{
+	const char* extension = strrchr(fileName, '.');
+	if (!extension)
+	{
+		return MESH_FILE_FORMAT_UNKNOWN;
+	}
+
+	struct Extension
+	{
+		const char* Text;
+		MESH_FILE_FORMAT Format;
+	};
+	static const Extension EXTENSIONS[]{ { ".obj", MESH_FILE_FORMAT_OBJ }, { ".gltf", MESH_FILE_FORMAT_GLTF }, { ".glb", MESH_FILE_FORMAT_GLB } };
+	for (const Extension& candidate : EXTENSIONS)
+	{
+		size_t i = 0;
+		while (candidate.Text[i] && (extension[i] | 0x20) == candidate.Text[i])
+		{
+			++i;
+		}
+		if (!candidate.Text[i] && !extension[i])
+		{
+			return candidate.Format;
+		}
+	}
+	return MESH_FILE_FORMAT_UNKNOWN;
+}
+
+bool ImportMesh(const char* fileName, ImportedMesh& outMesh, ThreadPool* threadPool, MeshImportStats* outStats)
+{
+	MeshImportStats stats;
+	memset(&stats, 0, sizeof(stats));
+	stats.ThreadCount = threadPool ? threadPool->GetThreadCount() : 1;
+	outMesh.Vertices.clear();
+	outMesh.Indices = MeshIndices{};
+
+	const uint64_t startTicks = Clock::GetTicks();
+	const MESH_FILE_FORMAT format = GetMeshFileFormat(fileName);
+	MappedFile file;
+	bool bImported = false;
+	if (format == MESH_FILE_FORMAT_UNKNOWN)
+	{
+		stats.Error = "unknown file extension";
+	}
+	else if (!file.Open(fileName))
+	{
+		stats.Error = "cannot open the file";
+	}
+	else
+	{
+		stats.FileSize = file.GetSize();
+		stats.MapMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - startTicks);
+		bImported = format == MESH_FILE_FORMAT_OBJ ? ImportObj(file, outMesh, threadPool, stats)
+			: ImportGltf(file, fileName, format == MESH_FILE_FORMAT_GLB, outMesh, threadPool, stats);
+	}
+
+	if (bImported)
+	{
+		stats.VertexCount = (uint32_t)outMesh.Vertices.size();
+		stats.TriangleCount = outMesh.Indices.GetCount() / 3;
+	}
+	else
+	{
+		outMesh.Vertices.clear();
+		outMesh.Indices = MeshIndices{};
+	}
+	stats.TotalMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - startTicks);
+	stats.PeakMemory = GetPeakMemoryUsage();
+
+	if (outStats)
+	{
+		*outStats = stats;
+	}
+	return bImported;
+}
+
+uint64_t ComputeImportedMeshCacheKey(const char* fileName)
+{
+	return ComputeMeshCacheKey(fileName, strlen(fileName), MESH_IMPORTER_VERSION);
+}
+
+uint64_t GetPeakMemoryUsage()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+	// Kilobytes on Linux
+	rusage usage;
+	return getrusage(RUSAGE_SELF, &usage) == 0 ? (uint64_t)usage.ru_maxrss * 1024 : 0;
+#endif // _WIN32
+}
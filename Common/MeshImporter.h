@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "MeshGenerator.h"
+#include "VertexTypes.h"
+
+class ThreadPool;
+
+// Change whenever imported meshes change, so that caches of older imports are not used (see ComputeImportedMeshCacheKey)
+constexpr uint32_t MESH_IMPORTER_VERSION = 1;
+
+enum MESH_FILE_FORMAT
+{
+	MESH_FILE_FORMAT_UNKNOWN,
+	MESH_FILE_FORMAT_OBJ,
+	MESH_FILE_FORMAT_GLTF,
+	MESH_FILE_FORMAT_GLB
+};
+
+// Format from the extension of fileName (.obj, .gltf, .glb), ignoring case
+MESH_FILE_FORMAT GetMeshFileFormat(const char* fileName);
+
+// One triangle list in the layout of the Lighting sample, with the index format picked by SelectIndexFormat
+struct ImportedMesh
+{
+	std::vector<VertexData> Vertices;
+	MeshIndices Indices;
+};
+
+struct MeshImportStats
+{
+	// Reason of the failure, null after a successful import
+	const char* Error;
+
+	// Every byte read, external glTF buffers included
+	uint64_t FileSize;
+
+	uint32_t ThreadCount;
+	uint32_t TaskCount;
+
+	// Source vertices and triangle corners before welding, and the vertices they welded into
+	uint64_t SourceVertexCount;
+	uint64_t CornerCount;
+	uint32_t VertexCount;
+	uint32_t TriangleCount;
+
+	// Vertices without a normal in the file, which get the average normal of their triangles
+	uint32_t GeneratedNormalCount;
+
+	double MapMilliseconds;
+	double ParseMilliseconds;
+	double WeldMilliseconds;
+	double TotalMilliseconds;
+
+	// GetPeakMemoryUsage at the end of the import
+	uint64_t PeakMemory;
+
+	// Megabytes of file per second of the whole import
+	double GetThroughput() const { return TotalMilliseconds > 0.0 ? FileSize / (1024.0 * 1024.0) / (TotalMilliseconds / 1000.0) : 0.0; }
+};
+
+// Imports every triangle of a Wavefront OBJ or glTF 2.0 (.gltf with external or data: buffers, .glb) file into one mesh.
+// The file is mapped rather than read, numbers are parsed in place and the work is split over threadPool when given:
+// OBJ in chunks of lines, glTF in ranges of accessor elements. Identical vertices are then welded through a hash map.
+// OBJ keeps positions and normals only (texture coordinates, groups and materials are skipped) and triangulates polygons
+// as fans. glTF flattens the node hierarchy of its default scene into world space and skips primitives that are not
+// triangle lists. Both formats are right-handed with counter-clockwise front faces, so Z is negated and the corners of
+// every triangle are reversed to reach the left-handed, clockwise convention of the samples.
+// Returns false and sets outStats->Error when the file cannot be read, is malformed or holds no triangle.
+bool ImportMesh(const char* fileName, ImportedMesh& outMesh, ThreadPool* threadPool = nullptr, MeshImportStats* outStats = nullptr);
+
+// Source key of a mesh cache written from an import, from the file name and MESH_IMPORTER_VERSION
+uint64_t ComputeImportedMeshCacheKey(const char* fileName);
+
+// Peak working set of the process in bytes (PeakWorkingSetSize on Windows, ru_maxrss elsewhere), 0 where unknown.
+// Pages of mapped files count once they have been touched.
+uint64_t GetPeakMemoryUsage();
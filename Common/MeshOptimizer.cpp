@@ -0,0 +1,436 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+	// Forsyth's scoring, with the LRU cache he tuned it for
+	constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+	constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+	constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+	constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+	constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+	constexpr uint32_t FORSYTH_MAX_VALENCE = 64;
+
+	constexpr uint32_t NO_TRIANGLE = UINT32_MAX;
+
+	// Vertex scores by cache position and by remaining triangle count, computed once
+	struct ForsythScoreTables
+	{
+		float Cache[FORSYTH_CACHE_SIZE];
+		float Valence[FORSYTH_MAX_VALENCE];
+
+		ForsythScoreTables()
+		{
+			for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; ++i)
+			{
+				// The vertices of the last triangle get a fixed score so that the next triangle does not just reuse two of them
+				Cache[i] = i < 3 ? FORSYTH_LAST_TRIANGLE_SCORE : powf(1.0f - (i - 3) / (float)(FORSYTH_CACHE_SIZE - 3), FORSYTH_CACHE_DECAY_POWER);
+			}
+
+			// Vertices with few triangles left are finished first so that they do not leave lone triangles behind
+			Valence[0] = 0.0f;
+			for (uint32_t i = 1; i < FORSYTH_MAX_VALENCE; ++i)
+			{
+				Valence[i] = FORSYTH_VALENCE_BOOST_SCALE * powf((float)i, -FORSYTH_VALENCE_BOOST_POWER);
+			}
+		}
+
+		float ComputeScore(uint32_t cachePosition, uint32_t remainingTriangleCount) const
+		{
+			if (remainingTriangleCount == 0)
+			{
+				return -1.0f;
+			}
+
+			const float cacheScore = cachePosition < FORSYTH_CACHE_SIZE ? Cache[cachePosition] : 0.0f;
+			return cacheScore + Valence[remainingTriangleCount < FORSYTH_MAX_VALENCE ? remainingTriangleCount : FORSYTH_MAX_VALENCE - 1];
+		}
+	};
+
+	// FIFO cache as a timestamp per vertex. A vertex is cached while fewer than Size misses happened since it was loaded.
+	struct FifoCache
+	{
+		std::vector<uint32_t> Timestamps;
+		uint32_t Time;
+		uint32_t Size;
+
+		FifoCache(uint32_t vertexCount, uint32_t size) : Timestamps(vertexCount, 0), Time(size + 1), Size(size) {}
+
+		void Reset() { Time += Size + 1; }
+
+		// 1 on a miss
+		uint32_t Access(uint32_t vertex)
+		{
+			if (Time - Timestamps[vertex] > Size)
+			{
+				Timestamps[vertex] = Time++;
+				return 1;
+			}
+			return 0;
+		}
+
+		uint32_t AccessTriangle(uint32_t a, uint32_t b, uint32_t c) { return Access(a) + Access(b) + Access(c); }
+	};
+
+	const Float3& GetPosition(const void* positions, uint32_t vertexStride, uint32_t vertex)
+	{
+		return *(const Float3*)((const uint8_t*)positions + (size_t)vertex * vertexStride);
+	}
+}
+
+template <typename Index>
+VertexCacheStats AnalyzeVertexCache(const Index* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStats stats{};
+	stats.TriangleCount = indexCount / 3;
+
+	FifoCache cache(vertexCount, cacheSize);
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		stats.TransformedVertexCount += cache.Access(indices[i]);
+	}
+
+	for (uint32_t timestamp : cache.Timestamps)
+	{
+		stats.VertexCount += timestamp != 0 ? 1 : 0;
+	}
+
+	return stats;
+}
+
+template <typename Index>
+void OptimizeVertexCache(Index* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+	static const ForsythScoreTables scoreTables;
+
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Triangles of every vertex. The first RemainingTriangleCounts[v] of them are not emitted yet.
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		++triangleOffsets[indices[i] + 1];
+	}
+	for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+	}
+
+	std::vector<uint32_t> remainingTriangleCounts(vertexCount, 0);
+	std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		const uint32_t vertex = indices[i];
+		vertexTriangles[triangleOffsets[vertex] + remainingTriangleCounts[vertex]++] = i / 3;
+	}
+
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		vertexScores[vertex] = scoreTables.ComputeScore(FORSYTH_CACHE_SIZE, remainingTriangleCounts[vertex]);
+	}
+
+	auto computeTriangleScore = [&](uint32_t triangle)
+	{
+		return vertexScores[indices[triangle * 3 + 0]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+	};
+
+	uint32_t bestTriangle = 0;
+	float bestScore = computeTriangleScore(0);
+	for (uint32_t triangle = 1; triangle < triangleCount; ++triangle)
+	{
+		const float score = computeTriangleScore(triangle);
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTriangle = triangle;
+		}
+	}
+
+	std::vector<uint8_t> emitted(triangleCount, 0);
+
+	uint32_t cache[FORSYTH_CACHE_SIZE];
+	uint32_t cacheCount = 0;
+
+	std::vector<Index> output(triangleCount * 3);
+	uint32_t nextUnemittedTriangle = 0;
+	for (uint32_t outputTriangle = 0; outputTriangle < triangleCount; ++outputTriangle)
+	{
+		// Nothing left around the cached vertices, start over at the first triangle not emitted yet
+		if (bestTriangle == NO_TRIANGLE)
+		{
+			while (emitted[nextUnemittedTriangle])
+			{
+				++nextUnemittedTriangle;
+			}
+			bestTriangle = nextUnemittedTriangle;
+		}
+
+		const Index* triangleIndices = indices + bestTriangle * 3;
+		memcpy(&output[outputTriangle * 3], triangleIndices, 3 * sizeof(Index));
+		emitted[bestTriangle] = 1;
+
+		// The vertices of the triangle go to the front of the cache and push the others back, up to three of them out
+		uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+		uint32_t newCacheCount = 0;
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			const uint32_t vertex = triangleIndices[corner];
+
+			uint32_t* triangles = &vertexTriangles[triangleOffsets[vertex]];
+			uint32_t& remainingTriangleCount = remainingTriangleCounts[vertex];
+			for (uint32_t i = 0; i < remainingTriangleCount; ++i)
+			{
+				if (triangles[i] == bestTriangle)
+				{
+					triangles[i] = triangles[--remainingTriangleCount];
+					triangles[remainingTriangleCount] = bestTriangle;
+					break;
+				}
+			}
+
+			if (std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount)
+			{
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+
+		const uint32_t triangleVertexCount = newCacheCount;
+		for (uint32_t i = 0; i < cacheCount; ++i)
+		{
+			const uint32_t vertex = cache[i];
+			if (std::find(newCache, newCache + triangleVertexCount, vertex) == newCache + triangleVertexCount)
+			{
+				newCache[newCacheCount++] = vertex;
+			}
+		}
+
+		// Rescore every vertex that moved, including the ones that fell out
+		for (uint32_t i = 0; i < newCacheCount; ++i)
+		{
+			const uint32_t vertex = newCache[i];
+			vertexScores[vertex] = scoreTables.ComputeScore(i, remainingTriangleCounts[vertex]);
+		}
+
+		// Triangles around the vertices that fell out lost score but cannot be the best one
+		bestTriangle = NO_TRIANGLE;
+		bestScore = -1.0f;
+		const uint32_t cachedCount = newCacheCount < FORSYTH_CACHE_SIZE ? newCacheCount : FORSYTH_CACHE_SIZE;
+		for (uint32_t i = 0; i < cachedCount; ++i)
+		{
+			const uint32_t vertex = newCache[i];
+			const uint32_t* triangles = &vertexTriangles[triangleOffsets[vertex]];
+			for (uint32_t j = 0; j < remainingTriangleCounts[vertex]; ++j)
+			{
+				const uint32_t triangle = triangles[j];
+				const float score = computeTriangleScore(triangle);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = triangle;
+				}
+			}
+		}
+
+		cacheCount = cachedCount;
+		memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(Index));
+}
+
+template <typename Index>
+void OptimizeOverdraw(Index* indices, uint32_t indexCount, const void* positions, uint32_t vertexCount, uint32_t vertexStride, float acmrThreshold)
+{
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// A triangle that reuses no cached vertex is where the cache optimizer started over, which makes a hard boundary
+	std::vector<uint32_t> hardBoundaries;
+	FifoCache cache(vertexCount, VERTEX_CACHE_SIZE);
+	for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+	{
+		if (cache.AccessTriangle(indices[triangle * 3 + 0], indices[triangle * 3 + 1], indices[triangle * 3 + 2]) == 3)
+		{
+			hardBoundaries.push_back(triangle);
+		}
+	}
+	hardBoundaries.push_back(triangleCount);
+
+	// Cut every hard cluster again as soon as the part since the last cut is within the threshold of the ACMR of the whole cluster
+	std::vector<uint32_t> clusterBoundaries;
+	for (size_t hardCluster = 0; hardCluster + 1 < hardBoundaries.size(); ++hardCluster)
+	{
+		const uint32_t begin = hardBoundaries[hardCluster];
+		const uint32_t end = hardBoundaries[hardCluster + 1];
+
+		cache.Reset();
+		uint32_t clusterMissCount = 0;
+		for (uint32_t triangle = begin; triangle < end; ++triangle)
+		{
+			clusterMissCount += cache.AccessTriangle(indices[triangle * 3 + 0], indices[triangle * 3 + 1], indices[triangle * 3 + 2]);
+		}
+		const float missThreshold = acmrThreshold * clusterMissCount / (float)(end - begin);
+
+		const size_t firstBoundary = clusterBoundaries.size();
+		clusterBoundaries.push_back(begin);
+
+		cache.Reset();
+		uint32_t missCount = 0;
+		uint32_t clusterTriangleCount = 0;
+		for (uint32_t triangle = begin; triangle < end; ++triangle)
+		{
+			missCount += cache.AccessTriangle(indices[triangle * 3 + 0], indices[triangle * 3 + 1], indices[triangle * 3 + 2]);
+			++clusterTriangleCount;
+
+			if (missCount <= missThreshold * clusterTriangleCount && triangle + 1 < end)
+			{
+				clusterBoundaries.push_back(triangle + 1);
+				cache.Reset();
+				missCount = 0;
+				clusterTriangleCount = 0;
+			}
+		}
+
+		// The tail never reached the threshold, so it joins the cluster before it
+		if (clusterTriangleCount > 0 && missCount > missThreshold * clusterTriangleCount && clusterBoundaries.size() > firstBoundary + 1)
+		{
+			clusterBoundaries.pop_back();
+		}
+	}
+	clusterBoundaries.push_back(triangleCount);
+
+	// Clusters that face away from the center of the mesh are on the outside and go first
+	Float3 meshCenter{ 0.0f, 0.0f, 0.0f };
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		meshCenter = meshCenter + GetPosition(positions, vertexStride, indices[i]);
+	}
+	meshCenter = meshCenter * (1.0f / (triangleCount * 3));
+
+	const uint32_t clusterCount = (uint32_t)clusterBoundaries.size() - 1;
+	std::vector<float> clusterKeys(clusterCount);
+	std::vector<uint32_t> clusterOrder(clusterCount);
+	for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+	{
+		Float3 centroid{ 0.0f, 0.0f, 0.0f };
+		Float3 normal{ 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+		for (uint32_t triangle = clusterBoundaries[cluster]; triangle < clusterBoundaries[cluster + 1]; ++triangle)
+		{
+			const Float3& p0 = GetPosition(positions, vertexStride, indices[triangle * 3 + 0]);
+			const Float3& p1 = GetPosition(positions, vertexStride, indices[triangle * 3 + 1]);
+			const Float3& p2 = GetPosition(positions, vertexStride, indices[triangle * 3 + 2]);
+
+			// Twice the area weighted normal
+			const Float3 triangleNormal = Cross(p1 - p0, p2 - p0);
+			const float triangleArea = Length(triangleNormal);
+
+			centroid = centroid + (p0 + p1 + p2) * (triangleArea / 3.0f);
+			normal = normal + triangleNormal;
+			area += triangleArea;
+		}
+
+		const float normalLength = Length(normal);
+		clusterKeys[cluster] = area > 0.0f && normalLength > 0.0f ? Dot(centroid * (1.0f / area) - meshCenter, normal * (1.0f / normalLength)) : 0.0f;
+		clusterOrder[cluster] = cluster;
+	}
+
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return clusterKeys[a] > clusterKeys[b]; });
+
+	std::vector<Index> output;
+	output.reserve(triangleCount * 3);
+	for (uint32_t cluster : clusterOrder)
+	{
+		output.insert(output.end(), indices + clusterBoundaries[cluster] * 3, indices + clusterBoundaries[cluster + 1] * 3);
+	}
+	memcpy(indices, output.data(), output.size() * sizeof(Index));
+}
+
+template <typename Index>
+uint32_t OptimizeVertexFetch(void* vertices, uint32_t vertexCount, uint32_t vertexSize, Index* indices, uint32_t indexCount)
+{
+	std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+	uint32_t usedVertexCount = 0;
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		uint32_t& newIndex = remap[indices[i]];
+		if (newIndex == UINT32_MAX)
+		{
+			newIndex = usedVertexCount++;
+		}
+		indices[i] = (Index)newIndex;
+	}
+
+	uint32_t nextIndex = usedVertexCount;
+	for (uint32_t& newIndex : remap)
+	{
+		if (newIndex == UINT32_MAX)
+		{
+			newIndex = nextIndex++;
+		}
+	}
+
+	std::vector<uint8_t> reordered((size_t)vertexCount * vertexSize);
+	for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		memcpy(&reordered[(size_t)remap[vertex] * vertexSize], (const uint8_t*)vertices + (size_t)vertex * vertexSize, vertexSize);
+	}
+	memcpy(vertices, reordered.data(), reordered.size());
+
+	return usedVertexCount;
+}
+
+template VertexCacheStats AnalyzeVertexCache<uint16_t>(const uint16_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize);
+template VertexCacheStats AnalyzeVertexCache<uint32_t>(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize);
+template void OptimizeVertexCache<uint16_t>(uint16_t* indices, uint32_t indexCount, uint32_t vertexCount);
+template void OptimizeVertexCache<uint32_t>(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+template void OptimizeOverdraw<uint16_t>(uint16_t* indices, uint32_t indexCount, const void* positions, uint32_t vertexCount, uint32_t vertexStride, float acmrThreshold);
+template void OptimizeOverdraw<uint32_t>(uint32_t* indices, uint32_t indexCount, const void* positions, uint32_t vertexCount, uint32_t vertexStride, float acmrThreshold);
+template uint32_t OptimizeVertexFetch<uint16_t>(void* vertices, uint32_t vertexCount, uint32_t vertexSize, uint16_t* indices, uint32_t indexCount);
+template uint32_t OptimizeVertexFetch<uint32_t>(void* vertices, uint32_t vertexCount, uint32_t vertexSize, uint32_t* indices, uint32_t indexCount);
+
+template <typename Index>
+void OptimizeMesh(void* vertices, uint32_t vertexCount, uint32_t vertexSize, Index* indices, uint32_t indexCount, MeshOptimizationStats* outStats)
+{
+	if (outStats)
+	{
+		outStats->Before.Add(AnalyzeVertexCache(indices, indexCount, vertexCount));
+	}
+
+	OptimizeVertexCache(indices, indexCount, vertexCount);
+	OptimizeOverdraw(indices, indexCount, vertices, vertexCount, vertexSize);
+	OptimizeVertexFetch(vertices, vertexCount, vertexSize, indices, indexCount);
+
+	if (outStats)
+	{
+		outStats->After.Add(AnalyzeVertexCache(indices, indexCount, vertexCount));
+	}
+}
+
+template void OptimizeMesh<uint16_t>(void* vertices, uint32_t vertexCount, uint32_t vertexSize, uint16_t* indices, uint32_t indexCount, MeshOptimizationStats* outStats);
+template void OptimizeMesh<uint32_t>(void* vertices, uint32_t vertexCount, uint32_t vertexSize, uint32_t* indices, uint32_t indexCount, MeshOptimizationStats* outStats);
+
+void OptimizeMesh(void* vertices, uint32_t vertexCount, uint32_t vertexSize, MeshIndices& indices, uint32_t startIndex, uint32_t indexCount,
+	MeshOptimizationStats* outStats)
+{
+	if (indices.Format == INDEX_FORMAT_UINT16)
+	{
+		OptimizeMesh(vertices, vertexCount, vertexSize, indices.Indices16.data() + startIndex, indexCount, outStats);
+	}
+	else
+	{
+		OptimizeMesh(vertices, vertexCount, vertexSize, indices.Indices32.data() + startIndex, indexCount, outStats);
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "MeshGenerator.h"
+
+// Entries of the FIFO post-transform cache that AnalyzeVertexCache simulates
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+// Clusters may get this much worse ACMR than the cache-optimized order to give OptimizeOverdraw finer clusters to sort
+constexpr float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+
+// Post-transform vertex cache behavior of an index buffer
+struct VertexCacheStats
+{
+	uint64_t TriangleCount;
+	uint64_t VertexCount;
+	uint64_t TransformedVertexCount;
+
+	// Average cache miss ratio, vertex shader runs per triangle. 3 without any reuse, about 0.5 for a large regular grid at best.
+	double GetAcmr() const { return TriangleCount ? (double)TransformedVertexCount / TriangleCount : 0.0; }
+
+	// Average transform to vertex ratio, vertex shader runs per referenced vertex. 1 at best.
+	double GetAtvr() const { return VertexCount ? (double)TransformedVertexCount / VertexCount : 0.0; }
+
+	void Add(const VertexCacheStats& other)
+	{
+		TriangleCount += other.TriangleCount;
+		VertexCount += other.VertexCount;
+		TransformedVertexCount += other.TransformedVertexCount;
+	}
+};
+
+// Vertex cache behavior of the meshes of a scene as generated and after OptimizeMesh
+struct MeshOptimizationStats
+{
+	VertexCacheStats Before;
+	VertexCacheStats After;
+};
+
+// In every function below indices[0..indexCount) is a triangle list over vertices [0, vertexCount). Index is uint16_t or uint32_t.
+
+// Runs indices through a FIFO cache of cacheSize vertices and counts the misses
+template <typename Index>
+VertexCacheStats AnalyzeVertexCache(const Index* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorders the triangles for the post-transform cache with Tom Forsyth's linear-speed algorithm. Every vertex is scored
+// from its position in a simulated LRU cache and the number of triangles it still has, and the next triangle is the best
+// scoring one around the vertices in the cache.
+template <typename Index>
+void OptimizeVertexCache(Index* indices, uint32_t indexCount, uint32_t vertexCount);
+
+// Reorders the triangles so that the outer surfaces are drawn first and hide the rest behind them in the depth test,
+// as in Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+// The cache-optimized order is cut into clusters whose ACMR stays within acmrThreshold of the whole, then the clusters
+// are sorted by how far out they face. positions is the Float3 at the start of every vertexStride bytes.
+template <typename Index>
+void OptimizeOverdraw(Index* indices, uint32_t indexCount, const void* positions, uint32_t vertexCount, uint32_t vertexStride,
+	float acmrThreshold = OVERDRAW_ACMR_THRESHOLD);
+
+// Renumbers the vertices in the order the indices first use them, so that vertex fetch walks the buffer forward.
+// Vertices no index uses are moved behind the others, keeping their order. Returns the number of used vertices.
+template <typename Index>
+uint32_t OptimizeVertexFetch(void* vertices, uint32_t vertexCount, uint32_t vertexSize, Index* indices, uint32_t indexCount);
+
+// OptimizeVertexCache, OptimizeOverdraw and OptimizeVertexFetch in a row. Every vertex has to start with its Float3 position.
+// The vertex count never changes, so vertices of other draws that follow stay in place.
+// The stats of the mesh before and after are added to outStats when it is not null.
+template <typename Index>
+void OptimizeMesh(void* vertices, uint32_t vertexCount, uint32_t vertexSize, Index* indices, uint32_t indexCount, MeshOptimizationStats* outStats = nullptr);
+
+// Same on the draw range indices [startIndex, startIndex + indexCount) of a MeshIndices
+void OptimizeMesh(void* vertices, uint32_t vertexCount, uint32_t vertexSize, MeshIndices& indices, uint32_t startIndex, uint32_t indexCount,
+	MeshOptimizationStats* outStats = nullptr);
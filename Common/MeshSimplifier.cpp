@@ -0,0 +1,726 @@
+#include "MeshSimplifier.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "Clock.h"
+#include "ThreadPool.h"
+
+namespace
+{
+	// Vertices and triangles per ParallelFor task
+	constexpr uint32_t SIMPLIFY_VERTICES_PER_TASK = 16384;
+	constexpr uint32_t SIMPLIFY_TRIANGLES_PER_TASK = 16384;
+
+	// Planes along border edges count this much more than triangles of the same area
+	constexpr float BORDER_PLANE_WEIGHT = 10.0f;
+
+	// A collapse is skipped when it turns a triangle by more than about 75 degrees, which also keeps it from folding into a sliver
+	constexpr float FLIP_MIN_COSINE = 0.25f;
+
+	// Every pass stops at this many times the error of the cheapest collapses that would reach the target on their own.
+	// Vertices next to a collapse wait for the next pass, so without the limit a pass would go on to far worse collapses.
+	constexpr float PASS_ERROR_GOAL_SCALE = 1.5f;
+
+	// Every pass still makes at least this fraction of the collapses left, as cheap collapses that all wait on one vertex,
+	// such as the ring around a pole, would otherwise take a pass each. Once the collapses left are fewer than this
+	// fraction of the candidates, a pass makes all of them, rather than closing in on the target over many short passes.
+	constexpr uint32_t PASS_MIN_COLLAPSE_DIVISOR = 8;
+
+	// Squared errors below this are rounding noise of flat areas, a distance of 1e-5 of the extent
+	constexpr float PASS_MIN_ERROR_GOAL = 1e-10f;
+
+	constexpr uint32_t RADIX_BITS = 11;
+
+	constexpr uint32_t NO_VERTEX = UINT32_MAX;
+
+	enum VERTEX_KIND : uint8_t
+	{
+		VERTEX_KIND_INTERIOR,
+		VERTEX_KIND_BORDER,
+		VERTEX_KIND_LOCKED
+	};
+
+	// Sum of weighted squared distances to planes, the upper half of a symmetric 4x4 matrix.
+	// Weight is the area of the triangles alone, to turn the sum into a mean.
+	struct Quadric
+	{
+		float XX, XY, XZ, XW, YY, YZ, YW, ZZ, ZW, WW;
+		float Weight;
+	};
+
+	// Area weighted attributes of every vertex merged into one. Their squared distance to the attributes a of the vertex
+	// kept is Weight * |a|^2 - 2 * Sum . a + SquaredSum.
+	struct AttributeQuadric
+	{
+		float Weight;
+		float SquaredSum;
+		float Sum[MAX_SIMPLIFY_ATTRIBUTE_COUNT];
+	};
+
+	// Cheapest collapse of a vertex, Error includes the attributes
+	struct Collapse
+	{
+		uint32_t Source;
+		uint32_t Target;
+		float Error;
+		float PositionError;
+	};
+
+	// Triangles around every position, Triangles[Offsets[p], Offsets[p + 1]) for position p
+	struct TriangleAdjacency
+	{
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Triangles;
+
+		void Build(const uint32_t* indices, uint32_t triangleCount, const uint32_t* positionIds, uint32_t vertexCount)
+		{
+			Offsets.assign(vertexCount + 1, 0);
+			for (uint32_t i = 0; i < triangleCount * 3; ++i)
+			{
+				++Offsets[positionIds[indices[i]]];
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t position = 0; position < vertexCount; ++position)
+			{
+				const uint32_t count = Offsets[position];
+				Offsets[position] = offset;
+				offset += count;
+			}
+
+			// Offsets[p] ends up at the end of p, and is shifted back to the start afterwards
+			Triangles.resize(offset);
+			for (uint32_t i = 0; i < triangleCount * 3; ++i)
+			{
+				Triangles[Offsets[positionIds[indices[i]]]++] = i / 3;
+			}
+			for (uint32_t position = vertexCount; position > 0; --position)
+			{
+				Offsets[position] = Offsets[position - 1];
+			}
+			Offsets[0] = 0;
+		}
+	};
+
+	void RunTasks(ThreadPool* threadPool, uint32_t taskCount, const ThreadPool::TaskFunction& task)
+	{
+		if (threadPool && taskCount > 1)
+		{
+			threadPool->ParallelFor(taskCount, task);
+		}
+		else
+		{
+			for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+			{
+				task(taskIndex, 0);
+			}
+		}
+	}
+
+	void AddPlane(Quadric& quadric, const Float3& normal, float distance, float weight)
+	{
+		quadric.XX += weight * normal.x * normal.x;
+		quadric.XY += weight * normal.x * normal.y;
+		quadric.XZ += weight * normal.x * normal.z;
+		quadric.XW += weight * normal.x * distance;
+		quadric.YY += weight * normal.y * normal.y;
+		quadric.YZ += weight * normal.y * normal.z;
+		quadric.YW += weight * normal.y * distance;
+		quadric.ZZ += weight * normal.z * normal.z;
+		quadric.ZW += weight * normal.z * distance;
+		quadric.WW += weight * distance * distance;
+	}
+
+	void AddQuadric(Quadric& quadric, const Quadric& other)
+	{
+		quadric.XX += other.XX;
+		quadric.XY += other.XY;
+		quadric.XZ += other.XZ;
+		quadric.XW += other.XW;
+		quadric.YY += other.YY;
+		quadric.YZ += other.YZ;
+		quadric.YW += other.YW;
+		quadric.ZZ += other.ZZ;
+		quadric.ZW += other.ZW;
+		quadric.WW += other.WW;
+		quadric.Weight += other.Weight;
+	}
+
+	// Rounding can take the sum slightly below zero
+	float EvaluateQuadric(const Quadric& quadric, const Float3& p)
+	{
+		const float error = p.x * (quadric.XX * p.x + 2.0f * (quadric.XY * p.y + quadric.XZ * p.z + quadric.XW))
+			+ p.y * (quadric.YY * p.y + 2.0f * (quadric.YZ * p.z + quadric.YW))
+			+ p.z * (quadric.ZZ * p.z + 2.0f * quadric.ZW)
+			+ quadric.WW;
+		return error > 0.0f ? error : 0.0f;
+	}
+
+	void AddAttributeQuadric(AttributeQuadric& quadric, const AttributeQuadric& other, uint32_t attributeCount)
+	{
+		quadric.Weight += other.Weight;
+		quadric.SquaredSum += other.SquaredSum;
+		for (uint32_t i = 0; i < attributeCount; ++i)
+		{
+			quadric.Sum[i] += other.Sum[i];
+		}
+	}
+
+	float EvaluateAttributeQuadric(const AttributeQuadric& quadric, const float* attributes, uint32_t attributeCount)
+	{
+		float error = quadric.SquaredSum;
+		for (uint32_t i = 0; i < attributeCount; ++i)
+		{
+			error += attributes[i] * (quadric.Weight * attributes[i] - 2.0f * quadric.Sum[i]);
+		}
+		return error > 0.0f ? error : 0.0f;
+	}
+
+	uint64_t HashPosition(const Float3& position)
+	{
+		uint32_t words[3];
+		memcpy(words, &position, sizeof(words));
+		uint64_t hash = ((uint64_t)words[0] * 0x9E3779B97F4A7C15ull ^ words[1]) * 0xBF58476D1CE4E5B9ull;
+		return (hash ^ words[2]) * 0x94D049BB133111EBull;
+	}
+
+	// Numbers every vertex by the first vertex of its position. Vertices that share a position are seams and are locked.
+	void WeldPositions(const std::vector<Float3>& positions, std::vector<uint32_t>& outPositionIds, std::vector<uint8_t>& outKinds)
+	{
+		const uint32_t vertexCount = (uint32_t)positions.size();
+		uint32_t tableSize = 1;
+		uint32_t shift = 64;
+		while (tableSize < vertexCount * 2)
+		{
+			tableSize *= 2;
+			--shift;
+		}
+		std::vector<uint32_t> table(tableSize, NO_VERTEX);
+
+		for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			uint32_t slot = (uint32_t)(HashPosition(positions[vertex]) >> shift) & (tableSize - 1);
+			while (table[slot] != NO_VERTEX && memcmp(&positions[table[slot]], &positions[vertex], sizeof(Float3)))
+			{
+				slot = (slot + 1) & (tableSize - 1);
+			}
+
+			if (table[slot] == NO_VERTEX)
+			{
+				table[slot] = vertex;
+				outPositionIds[vertex] = vertex;
+			}
+			else
+			{
+				outPositionIds[vertex] = table[slot];
+				outKinds[vertex] = VERTEX_KIND_LOCKED;
+				outKinds[table[slot]] = VERTEX_KIND_LOCKED;
+			}
+		}
+	}
+
+	// True when a triangle around position from has the half-edge from -> to
+	bool HasHalfEdge(const TriangleAdjacency& adjacency, const uint32_t* indices, const uint32_t* positionIds, uint32_t from, uint32_t to)
+	{
+		for (uint32_t i = adjacency.Offsets[from]; i < adjacency.Offsets[from + 1]; ++i)
+		{
+			const uint32_t* triangle = &indices[adjacency.Triangles[i] * 3];
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				if (positionIds[triangle[k]] == from && positionIds[triangle[(k + 1) % 3]] == to)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// Corner of a triangle at position
+	uint32_t FindCorner(const uint32_t* triangle, const uint32_t* positionIds, uint32_t position)
+	{
+		return positionIds[triangle[0]] == position ? 0 : positionIds[triangle[1]] == position ? 1 : 2;
+	}
+
+	// Positions next to both a and b, counted with marks that hold mark for the neighbors of a
+	uint32_t SharedNeighborCount(const TriangleAdjacency& adjacency, const uint32_t* indices, const uint32_t* positionIds, uint32_t a, uint32_t b,
+		std::vector<uint32_t>& marks, uint32_t mark)
+	{
+		for (uint32_t i = adjacency.Offsets[a]; i < adjacency.Offsets[a + 1]; ++i)
+		{
+			const uint32_t* triangle = &indices[adjacency.Triangles[i] * 3];
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				marks[positionIds[triangle[k]]] = mark;
+			}
+		}
+		marks[a] = 0;
+
+		uint32_t count = 0;
+		for (uint32_t i = adjacency.Offsets[b]; i < adjacency.Offsets[b + 1]; ++i)
+		{
+			const uint32_t* triangle = &indices[adjacency.Triangles[i] * 3];
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				const uint32_t position = positionIds[triangle[k]];
+				if (position != b && marks[position] == mark)
+				{
+					marks[position] = 0;
+					++count;
+				}
+			}
+		}
+		return count;
+	}
+
+	// Orders the collapses by error without a heap: non-negative floats sort like their bits, in three 11-bit counting passes
+	void SortCollapses(const std::vector<Collapse>& collapses, std::vector<uint32_t>& outOrder, std::vector<uint32_t>& scratch)
+	{
+		const uint32_t count = (uint32_t)collapses.size();
+		outOrder.resize(count);
+		scratch.resize(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			outOrder[i] = i;
+		}
+
+		for (uint32_t shift = 0; shift < 32; shift += RADIX_BITS)
+		{
+			uint32_t histogram[1 << RADIX_BITS]{};
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint32_t bits;
+				memcpy(&bits, &collapses[outOrder[i]].Error, sizeof(bits));
+				++histogram[(bits >> shift) & ((1 << RADIX_BITS) - 1)];
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t& bucket : histogram)
+			{
+				const uint32_t bucketCount = bucket;
+				bucket = offset;
+				offset += bucketCount;
+			}
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint32_t bits;
+				memcpy(&bits, &collapses[outOrder[i]].Error, sizeof(bits));
+				scratch[histogram[(bits >> shift) & ((1 << RADIX_BITS) - 1)]++] = outOrder[i];
+			}
+			outOrder.swap(scratch);
+		}
+	}
+}
+
+template <typename Index>
+void SimplifyMesh(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, const Index* indices, uint32_t indexCount, uint32_t targetIndexCount,
+	std::vector<Index>& outIndices, const SimplifyAttributes& attributes, float maxError, ThreadPool* threadPool, MeshSimplificationStats* outStats)
+{
+	const uint64_t startTicks = Clock::GetTicks();
+	MeshSimplificationStats stats{};
+	stats.SourceTriangleCount = indexCount / 3;
+
+	// Positions are scaled by the largest side of the bounding box, so that errors are relative to the size of the mesh
+	const uint8_t* vertexBytes = (const uint8_t*)vertices;
+	std::vector<Float3> positions(vertexCount);
+	Float3 minimum{ FLT_MAX, FLT_MAX, FLT_MAX };
+	Float3 maximum{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		memcpy(&positions[i], vertexBytes + (size_t)i * vertexSize, sizeof(Float3));
+		minimum = Float3{ fminf(minimum.x, positions[i].x), fminf(minimum.y, positions[i].y), fminf(minimum.z, positions[i].z) };
+		maximum = Float3{ fmaxf(maximum.x, positions[i].x), fmaxf(maximum.y, positions[i].y), fmaxf(maximum.z, positions[i].z) };
+	}
+	const float extent = vertexCount ? fmaxf(maximum.x - minimum.x, fmaxf(maximum.y - minimum.y, maximum.z - minimum.z)) : 0.0f;
+	const float scale = extent > 0.0f ? 1.0f / extent : 0.0f;
+
+	// Seams are found on the positions as they are, before rounding in the scale can merge or split them
+	std::vector<uint32_t> positionIds(vertexCount);
+	std::vector<uint8_t> kinds(vertexCount, VERTEX_KIND_INTERIOR);
+	WeldPositions(positions, positionIds, kinds);
+	for (Float3& position : positions)
+	{
+		position = (position - minimum) * scale;
+	}
+
+	// Attributes are scaled by their weight, so that their squared differences add straight to the squared distances
+	const uint32_t attributeCount = attributes.Count < MAX_SIMPLIFY_ATTRIBUTE_COUNT ? attributes.Count : MAX_SIMPLIFY_ATTRIBUTE_COUNT;
+	std::vector<float> attributeValues((size_t)vertexCount * attributeCount);
+	for (uint32_t i = 0; i < vertexCount && attributeCount; ++i)
+	{
+		memcpy(&attributeValues[(size_t)i * attributeCount], vertexBytes + (size_t)i * vertexSize + attributes.Offset, attributeCount * sizeof(float));
+		for (uint32_t k = 0; k < attributeCount; ++k)
+		{
+			attributeValues[(size_t)i * attributeCount + k] *= attributes.Weight;
+		}
+	}
+
+	// Triangles with two corners at one position have no area to keep
+	std::vector<uint32_t> workIndices;
+	workIndices.reserve(indexCount);
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const uint32_t a = positionIds[indices[i]];
+		const uint32_t b = positionIds[indices[i + 1]];
+		const uint32_t c = positionIds[indices[i + 2]];
+		if (a != b && b != c && c != a)
+		{
+			workIndices.insert(workIndices.end(), { (uint32_t)indices[i], (uint32_t)indices[i + 1], (uint32_t)indices[i + 2] });
+		}
+	}
+	uint32_t triangleCount = (uint32_t)workIndices.size() / 3;
+
+	TriangleAdjacency adjacency;
+	adjacency.Build(workIndices.data(), triangleCount, positionIds.data(), vertexCount);
+
+	// Plane and area of every triangle
+	std::vector<Float4> planes(triangleCount);
+	std::vector<float> areas(triangleCount);
+	RunTasks(threadPool, (triangleCount + SIMPLIFY_TRIANGLES_PER_TASK - 1) / SIMPLIFY_TRIANGLES_PER_TASK, [&](uint32_t taskIndex, uint32_t)
+	{
+		const uint32_t end = (taskIndex + 1) * SIMPLIFY_TRIANGLES_PER_TASK < triangleCount ? (taskIndex + 1) * SIMPLIFY_TRIANGLES_PER_TASK : triangleCount;
+		for (uint32_t triangle = taskIndex * SIMPLIFY_TRIANGLES_PER_TASK; triangle < end; ++triangle)
+		{
+			const Float3& p0 = positions[workIndices[triangle * 3]];
+			const Float3 normal = Cross(positions[workIndices[triangle * 3 + 1]] - p0, positions[workIndices[triangle * 3 + 2]] - p0);
+			const float length = Length(normal);
+			const Float3 unitNormal = length > 0.0f ? normal * (1.0f / length) : normal;
+			planes[triangle] = ToFloat4(unitNormal, -Dot(unitNormal, p0));
+			areas[triangle] = 0.5f * length;
+		}
+	});
+
+	// Every position gathers the planes of its own triangles and border edges, so the tasks never write to the same vertex.
+	// Twins of a seam position are only touched by the task of that position.
+	std::vector<Quadric> quadrics(vertexCount, Quadric{});
+	std::vector<Float3> surfaceNormals(vertexCount, Float3{});
+	std::vector<AttributeQuadric> attributeQuadrics(attributeCount ? vertexCount : 0, AttributeQuadric{});
+	RunTasks(threadPool, (vertexCount + SIMPLIFY_VERTICES_PER_TASK - 1) / SIMPLIFY_VERTICES_PER_TASK, [&](uint32_t taskIndex, uint32_t)
+	{
+		const uint32_t end = (taskIndex + 1) * SIMPLIFY_VERTICES_PER_TASK < vertexCount ? (taskIndex + 1) * SIMPLIFY_VERTICES_PER_TASK : vertexCount;
+		for (uint32_t vertex = taskIndex * SIMPLIFY_VERTICES_PER_TASK; vertex < end; ++vertex)
+		{
+			if (positionIds[vertex] != vertex)
+			{
+				continue;
+			}
+
+			Quadric& quadric = quadrics[vertex];
+			uint32_t borderEdgeCount = 0;
+			for (uint32_t i = adjacency.Offsets[vertex]; i < adjacency.Offsets[vertex + 1]; ++i)
+			{
+				const uint32_t triangle = adjacency.Triangles[i];
+				const uint32_t* corners = &workIndices[triangle * 3];
+				const uint32_t corner = FindCorner(corners, positionIds.data(), vertex);
+				const Float4& plane = planes[triangle];
+				AddPlane(quadric, ToFloat3(plane), plane.w, areas[triangle]);
+				quadric.Weight += areas[triangle];
+				surfaceNormals[vertex] = surfaceNormals[vertex] + ToFloat3(plane) * areas[triangle];
+				if (attributeCount)
+				{
+					attributeQuadrics[corners[corner]].Weight += areas[triangle] / 3.0f;
+				}
+
+				// The edge to the next corner is a border when no triangle has it the other way around, and so is the one from the previous corner
+				const uint32_t next = positionIds[corners[(corner + 1) % 3]];
+				const uint32_t previous = positionIds[corners[(corner + 2) % 3]];
+				const uint32_t borderEnds[2][2]{ { vertex, next }, { previous, vertex } };
+				for (const uint32_t* ends : borderEnds)
+				{
+					if (!HasHalfEdge(adjacency, workIndices.data(), positionIds.data(), ends[1], ends[0]))
+					{
+						const Float3 edge = positions[ends[1]] - positions[ends[0]];
+						const Float3 normal = Normalize(Cross(edge, ToFloat3(plane)));
+						AddPlane(quadric, normal, -Dot(normal, positions[vertex]), BORDER_PLANE_WEIGHT * Dot(edge, edge));
+						++borderEdgeCount;
+					}
+				}
+			}
+
+			if (kinds[vertex] != VERTEX_KIND_LOCKED && borderEdgeCount > 0)
+			{
+				kinds[vertex] = borderEdgeCount == 2 ? VERTEX_KIND_BORDER : VERTEX_KIND_LOCKED;
+			}
+		}
+	});
+
+	for (uint32_t vertex = 0; vertex < (uint32_t)attributeQuadrics.size(); ++vertex)
+	{
+		AttributeQuadric& quadric = attributeQuadrics[vertex];
+		const float* values = &attributeValues[(size_t)vertex * attributeCount];
+		for (uint32_t k = 0; k < attributeCount; ++k)
+		{
+			quadric.Sum[k] = quadric.Weight * values[k];
+			quadric.SquaredSum += quadric.Weight * values[k] * values[k];
+		}
+	}
+
+	for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		stats.BorderVertexCount += kinds[vertex] == VERTEX_KIND_BORDER;
+		stats.LockedVertexCount += kinds[vertex] == VERTEX_KIND_LOCKED;
+	}
+	const uint64_t collapseTicks = Clock::GetTicks();
+	stats.QuadricMilliseconds = Clock::TicksToMilliseconds(collapseTicks - startTicks);
+
+	// Mean squared distance of target to the planes of both vertices, and mean squared attribute difference
+	const auto computeError = [&](uint32_t source, uint32_t target, float& outPositionError)
+	{
+		// Both sums are linear in the quadrics, so the two vertices are evaluated apart instead of merged first
+		const Quadric& targetQuadric = quadrics[positionIds[target]];
+		outPositionError = (EvaluateQuadric(quadrics[source], positions[target]) + EvaluateQuadric(targetQuadric, positions[target]))
+			/ fmaxf(quadrics[source].Weight + targetQuadric.Weight, FLT_MIN);
+		if (!attributeCount)
+		{
+			return outPositionError;
+		}
+
+		const float* values = &attributeValues[(size_t)target * attributeCount];
+		return outPositionError + (EvaluateAttributeQuadric(attributeQuadrics[source], values, attributeCount)
+			+ EvaluateAttributeQuadric(attributeQuadrics[target], values, attributeCount))
+			/ fmaxf(attributeQuadrics[source].Weight + attributeQuadrics[target].Weight, FLT_MIN);
+	};
+
+	const uint32_t targetTriangleCount = targetIndexCount / 3;
+	const float maxSquaredError = maxError < sqrtf(FLT_MAX) ? maxError * maxError : FLT_MAX;
+	float maxPositionError = 0.0f;
+	std::vector<Collapse> bestCollapses(vertexCount);
+	std::vector<Collapse> collapses;
+	collapses.reserve(vertexCount);
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> orderScratch;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<uint8_t> bTouched(vertexCount);
+	std::vector<uint8_t> bDirty(vertexCount, 1);
+	std::vector<uint32_t> neighborMarks(vertexCount, 0);
+	uint32_t neighborMark = 0;
+	while (triangleCount > targetTriangleCount)
+	{
+		if (stats.PassCount > 0)
+		{
+			adjacency.Build(workIndices.data(), triangleCount, positionIds.data(), vertexCount);
+		}
+		++stats.PassCount;
+
+		// Cheapest collapse of every vertex that may move, onto a neighbor, along the border for border vertices.
+		// Only vertices next to a collapse of the last pass have new costs. Around an interior vertex every neighbor
+		// follows it in one of its triangles, border vertices also look at the ones before them.
+		RunTasks(threadPool, (vertexCount + SIMPLIFY_VERTICES_PER_TASK - 1) / SIMPLIFY_VERTICES_PER_TASK, [&](uint32_t taskIndex, uint32_t)
+		{
+			const uint32_t end = (taskIndex + 1) * SIMPLIFY_VERTICES_PER_TASK < vertexCount ? (taskIndex + 1) * SIMPLIFY_VERTICES_PER_TASK : vertexCount;
+			for (uint32_t vertex = taskIndex * SIMPLIFY_VERTICES_PER_TASK; vertex < end; ++vertex)
+			{
+				if (!bDirty[vertex])
+				{
+					continue;
+				}
+				Collapse& best = bestCollapses[vertex];
+				best = Collapse{ vertex, NO_VERTEX, FLT_MAX, 0.0f };
+				if (kinds[vertex] == VERTEX_KIND_LOCKED)
+				{
+					continue;
+				}
+
+				for (uint32_t i = adjacency.Offsets[vertex]; i < adjacency.Offsets[vertex + 1]; ++i)
+				{
+					const uint32_t* corners = &workIndices[adjacency.Triangles[i] * 3];
+					const uint32_t corner = FindCorner(corners, positionIds.data(), vertex);
+					const uint32_t next = corners[(corner + 1) % 3];
+					const uint32_t previous = corners[(corner + 2) % 3];
+					const bool bBorder = kinds[vertex] == VERTEX_KIND_BORDER;
+					if (!bBorder || !HasHalfEdge(adjacency, workIndices.data(), positionIds.data(), positionIds[next], vertex))
+					{
+						float positionError;
+						const float error = computeError(vertex, next, positionError);
+						if (error < best.Error)
+						{
+							best = Collapse{ vertex, next, error, positionError };
+						}
+					}
+					if (bBorder && !HasHalfEdge(adjacency, workIndices.data(), positionIds.data(), vertex, positionIds[previous]))
+					{
+						float positionError;
+						const float error = computeError(vertex, previous, positionError);
+						if (error < best.Error)
+						{
+							best = Collapse{ vertex, previous, error, positionError };
+						}
+					}
+				}
+			}
+		});
+
+		collapses.clear();
+		for (const Collapse& collapse : bestCollapses)
+		{
+			if (collapse.Target != NO_VERTEX && collapse.Error <= maxSquaredError)
+			{
+				collapses.push_back(collapse);
+			}
+		}
+		if (collapses.empty())
+		{
+			break;
+		}
+		SortCollapses(collapses, order, orderScratch);
+
+		// An interior collapse removes two triangles
+		const uint32_t triangleGoal = triangleCount - targetTriangleCount;
+		const uint32_t collapseGoal = triangleGoal / 2;
+		const uint32_t minPassCollapseCount = (size_t)collapseGoal * PASS_MIN_COLLAPSE_DIVISOR < collapses.size()
+			? collapseGoal : collapseGoal / PASS_MIN_COLLAPSE_DIVISOR;
+		const float errorGoal = collapseGoal < collapses.size()
+			? fmaxf(PASS_ERROR_GOAL_SCALE * collapses[order[collapseGoal]].Error, PASS_MIN_ERROR_GOAL) : FLT_MAX;
+
+		for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			remap[vertex] = vertex;
+		}
+		memset(bTouched.data(), 0, vertexCount);
+		memset(bDirty.data(), 0, vertexCount);
+
+		uint32_t removedTriangleCount = 0;
+		uint32_t passCollapseCount = 0;
+		for (uint32_t collapseIndex : order)
+		{
+			const Collapse& collapse = collapses[collapseIndex];
+			if (removedTriangleCount >= triangleGoal || (collapse.Error > errorGoal && passCollapseCount >= minPassCollapseCount))
+			{
+				break;
+			}
+
+			const uint32_t source = collapse.Source;
+			const uint32_t target = positionIds[collapse.Target];
+			if (bTouched[source] || bTouched[target])
+			{
+				continue;
+			}
+
+			// Triangles on the edge go away, the others must not flip. A triangle that reaches the target position
+			// through a seam twin would lose its attributes. Any neighbor shared by both ends past the corners of those
+			// triangles would pinch the surface into a fold of two triangles back to back.
+			uint32_t edgeTriangleCount = 0;
+			bool bValid = true;
+			for (uint32_t i = adjacency.Offsets[source]; i < adjacency.Offsets[source + 1] && bValid; ++i)
+			{
+				const uint32_t* corners = &workIndices[adjacency.Triangles[i] * 3];
+				const uint32_t corner = FindCorner(corners, positionIds.data(), source);
+				const uint32_t next = corners[(corner + 1) % 3];
+				const uint32_t previous = corners[(corner + 2) % 3];
+				if (positionIds[next] == target || positionIds[previous] == target)
+				{
+					bValid = next == collapse.Target || previous == collapse.Target;
+					++edgeTriangleCount;
+					continue;
+				}
+
+				const Float3 oldNormal = Cross(positions[next] - positions[source], positions[previous] - positions[source]);
+				const Float3 newNormal = Cross(positions[next] - positions[collapse.Target], positions[previous] - positions[collapse.Target]);
+				const Float3 surfaceNormal = surfaceNormals[target] + surfaceNormals[positionIds[next]] + surfaceNormals[positionIds[previous]];
+				bValid = Dot(oldNormal, newNormal) > FLIP_MIN_COSINE * Length(oldNormal) * Length(newNormal) && Dot(surfaceNormal, newNormal) > 0.0f;
+			}
+			if (!bValid || SharedNeighborCount(adjacency, workIndices.data(), positionIds.data(), source, target, neighborMarks, ++neighborMark)
+				!= edgeTriangleCount)
+			{
+				// Retried once a collapse next to it changes the neighborhood
+				bestCollapses[source].Target = NO_VERTEX;
+				continue;
+			}
+
+			// Costs of the vertices around stay valid until the next pass as long as none of them moves or takes this one
+			remap[source] = collapse.Target;
+			AddQuadric(quadrics[target], quadrics[source]);
+			surfaceNormals[target] = surfaceNormals[target] + surfaceNormals[source];
+			if (attributeCount)
+			{
+				AddAttributeQuadric(attributeQuadrics[collapse.Target], attributeQuadrics[source], attributeCount);
+			}
+			for (uint32_t i = adjacency.Offsets[source]; i < adjacency.Offsets[source + 1]; ++i)
+			{
+				const uint32_t* corners = &workIndices[adjacency.Triangles[i] * 3];
+				bTouched[positionIds[corners[0]]] = 1;
+				bTouched[positionIds[corners[1]]] = 1;
+				bTouched[positionIds[corners[2]]] = 1;
+			}
+			for (uint32_t i = adjacency.Offsets[target]; i < adjacency.Offsets[target + 1]; ++i)
+			{
+				const uint32_t* corners = &workIndices[adjacency.Triangles[i] * 3];
+				bDirty[positionIds[corners[0]]] = 1;
+				bDirty[positionIds[corners[1]]] = 1;
+				bDirty[positionIds[corners[2]]] = 1;
+			}
+
+			removedTriangleCount += edgeTriangleCount;
+			maxPositionError = fmaxf(maxPositionError, collapse.PositionError);
+			++passCollapseCount;
+		}
+		if (passCollapseCount == 0)
+		{
+			break;
+		}
+		stats.CollapseCount += passCollapseCount;
+		for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			bDirty[vertex] |= bTouched[vertex];
+		}
+
+		uint32_t writeIndex = 0;
+		for (uint32_t i = 0; i < triangleCount * 3; i += 3)
+		{
+			const uint32_t a = remap[workIndices[i]];
+			const uint32_t b = remap[workIndices[i + 1]];
+			const uint32_t c = remap[workIndices[i + 2]];
+			if (positionIds[a] != positionIds[b] && positionIds[b] != positionIds[c] && positionIds[c] != positionIds[a])
+			{
+				workIndices[writeIndex++] = a;
+				workIndices[writeIndex++] = b;
+				workIndices[writeIndex++] = c;
+			}
+		}
+		triangleCount = writeIndex / 3;
+	}
+
+	outIndices.resize((size_t)triangleCount * 3);
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		outIndices[i] = (Index)workIndices[i];
+	}
+
+	if (outStats)
+	{
+		stats.TriangleCount = triangleCount;
+		stats.Error = sqrtf(maxPositionError) * extent;
+		const uint64_t endTicks = Clock::GetTicks();
+		stats.CollapseMilliseconds = Clock::TicksToMilliseconds(endTicks - collapseTicks);
+		stats.TotalMilliseconds = Clock::TicksToMilliseconds(endTicks - startTicks);
+		*outStats = stats;
+	}
+}
+
+template void SimplifyMesh<uint16_t>(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, const uint16_t* indices, uint32_t indexCount,
+	uint32_t targetIndexCount, std::vector<uint16_t>& outIndices, const SimplifyAttributes& attributes, float maxError, ThreadPool* threadPool,
+	MeshSimplificationStats* outStats);
+template void SimplifyMesh<uint32_t>(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, const uint32_t* indices, uint32_t indexCount,
+	uint32_t targetIndexCount, std::vector<uint32_t>& outIndices, const SimplifyAttributes& attributes, float maxError, ThreadPool* threadPool,
+	MeshSimplificationStats* outStats);
+
+void SimplifyMesh(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, const MeshIndices& indices, uint32_t startIndex, uint32_t indexCount,
+	uint32_t targetIndexCount, MeshIndices& outIndices, const SimplifyAttributes& attributes, float maxError, ThreadPool* threadPool,
+	MeshSimplificationStats* outStats)
+{
+	outIndices.Format = indices.Format;
+	if (indices.Format == INDEX_FORMAT_UINT16)
+	{
+		SimplifyMesh(vertices, vertexCount, vertexSize, indices.Indices16.data() + startIndex, indexCount, targetIndexCount, outIndices.Indices16, attributes,
+			maxError, threadPool, outStats);
+		outIndices.Indices32.clear();
+	}
+	else
+	{
+		SimplifyMesh(vertices, vertexCount, vertexSize, indices.Indices32.data() + startIndex, indexCount, targetIndexCount, outIndices.Indices32, attributes,
+			maxError, threadPool, outStats);
+		outIndices.Indices16.clear();
+	}
+}
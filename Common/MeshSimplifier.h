@@ -0,0 +1,77 @@
+#pragma once
+
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "MeshGenerator.h"
+#include "VertexTypes.h"
+
+class ThreadPool;
+
+constexpr uint32_t MAX_SIMPLIFY_ATTRIBUTE_COUNT = 4;
+
+// Floats of every vertex that the simplifier keeps next to the position, such as its normal or its color.
+// An attribute difference of 1 costs as much as a distance of Weight times the extent of the mesh.
+struct SimplifyAttributes
+{
+	// Bytes from the start of the vertex
+	uint32_t Offset;
+	// Floats, up to MAX_SIMPLIFY_ATTRIBUTE_COUNT
+	uint32_t Count;
+	float Weight;
+};
+
+constexpr SimplifyAttributes NO_SIMPLIFY_ATTRIBUTES{ 0, 0, 0.0f };
+constexpr SimplifyAttributes VERTEX_DATA_SIMPLIFY_ATTRIBUTES{ (uint32_t)offsetof(VertexData, Normal), 3, 0.1f };
+constexpr SimplifyAttributes COLOR_VERTEX_DATA_SIMPLIFY_ATTRIBUTES{ (uint32_t)offsetof(ColorVertexData, Color), 4, 0.1f };
+
+struct MeshSimplificationStats
+{
+	uint32_t SourceTriangleCount;
+	uint32_t TriangleCount;
+
+	// Each pass collapses a set of edges that do not touch each other, cheapest first
+	uint32_t PassCount;
+	uint32_t CollapseCount;
+
+	// Vertices that may only slide along the border, and vertices that never move: seams (vertices of the same position
+	// with other attributes) and vertices where more than two border edges meet
+	uint32_t BorderVertexCount;
+	uint32_t LockedVertexCount;
+
+	// Largest root mean square distance between a kept vertex and the planes of the source triangles merged into it,
+	// in the units of the positions
+	float Error;
+
+	// Welding, adjacency and quadrics, then the collapse passes
+	double QuadricMilliseconds;
+	double CollapseMilliseconds;
+	double TotalMilliseconds;
+
+	double GetTrianglesPerSecond() const { return TotalMilliseconds > 0.0 ? SourceTriangleCount / (TotalMilliseconds / 1000.0) : 0.0; }
+};
+
+// Simplifies the triangle list indices[0..indexCount) over vertices [0, vertexCount) down to about targetIndexCount indices
+// with quadric error metrics (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics").
+// Every collapse moves a vertex onto a neighbor, so the result indexes a subset of the same vertices and several levels
+// can share one vertex buffer. The cost of a collapse is the squared distance of the kept vertex to the planes of every
+// triangle merged into it, area weighted, plus the squared difference between its attributes and the ones of every vertex
+// merged into it. Border edges add planes at right angles to their triangle so that the outline keeps its shape, border
+// vertices only collapse along the border, and seams and non-manifold vertices never move. Collapses that would flip a
+// triangle or pinch the surface are skipped.
+// Vertices are welded by position and the quadrics are accumulated per vertex from its triangles, in parallel over
+// threadPool when given. Each pass then picks the cheapest collapse of every vertex, orders the candidates with a radix
+// sort of their errors rather than a heap, and applies them in order while they touch no vertex changed in the same pass.
+// Stops early when no collapse is left under maxError, relative to the extent of the mesh.
+// Every vertex has to start with its Float3 position. Index is uint16_t or uint32_t.
+template <typename Index>
+void SimplifyMesh(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, const Index* indices, uint32_t indexCount, uint32_t targetIndexCount,
+	std::vector<Index>& outIndices, const SimplifyAttributes& attributes = NO_SIMPLIFY_ATTRIBUTES, float maxError = FLT_MAX,
+	ThreadPool* threadPool = nullptr, MeshSimplificationStats* outStats = nullptr);
+
+// Same on the draw range indices [startIndex, startIndex + indexCount) of a MeshIndices, into indices of the same format
+void SimplifyMesh(const void* vertices, uint32_t vertexCount, uint32_t vertexSize, const MeshIndices& indices, uint32_t startIndex, uint32_t indexCount,
+	uint32_t targetIndexCount, MeshIndices& outIndices, const SimplifyAttributes& attributes = NO_SIMPLIFY_ATTRIBUTES, float maxError = FLT_MAX,
+	ThreadPool* threadPool = nullptr, MeshSimplificationStats* outStats = nullptr);
@@ -0,0 +1,311 @@
+#include "MeshTangents.h"
+
+#include <float.h>
+#include <math.h>
+#include <atomic>
+
+#include "Clock.h"
+#include "ThreadPool.h"
+#include "VertexQuantization.h"
+
+namespace
+{
+	// Triangles and vertices per ParallelFor task
+	constexpr uint32_t TANGENT_TRIANGLES_PER_TASK = 16384;
+	constexpr uint32_t TANGENT_VERTICES_PER_TASK = 16384;
+
+	// Every corner adds at most pi, so 32 fraction bits leave room for far more corners on a vertex than any mesh has
+	constexpr float FIXED_POINT_SCALE = 4294967296.0f;
+	constexpr float INVERSE_TWO_PI = 1.0f / TWO_PI;
+	constexpr float INVERSE_PI = 1.0f / PI;
+
+	void RunTasks(ThreadPool* threadPool, uint32_t taskCount, const ThreadPool::TaskFunction& task)
+	{
+		if (threadPool && taskCount > 1)
+		{
+			threadPool->ParallelFor(taskCount, task);
+		}
+		else
+		{
+			for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+			{
+				task(taskIndex, 0);
+			}
+		}
+	}
+
+	// A locked add costs several times a plain one, which a single task does without
+	void AddFixedPoint(std::atomic<int64_t>& sum, float value, bool bConcurrent)
+	{
+		const int64_t fixedPoint = llrintf(value * FIXED_POINT_SCALE);
+		if (bConcurrent)
+		{
+			sum.fetch_add(fixedPoint, std::memory_order_relaxed);
+		}
+		else
+		{
+			sum.store(sum.load(std::memory_order_relaxed) + fixedPoint, std::memory_order_relaxed);
+		}
+	}
+
+	// Longitude and latitude around center, both in [0, 1]
+	void ComputeSphericalTexCoords(const VertexData* vertices, uint32_t vertexCount, ThreadPool* threadPool, std::vector<Float2>& outTexCoords)
+	{
+		Float3 minimum{ FLT_MAX, FLT_MAX, FLT_MAX };
+		Float3 maximum{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			const Float3& position = vertices[i].Position;
+			minimum = Float3{ fminf(minimum.x, position.x), fminf(minimum.y, position.y), fminf(minimum.z, position.z) };
+			maximum = Float3{ fmaxf(maximum.x, position.x), fmaxf(maximum.y, position.y), fmaxf(maximum.z, position.z) };
+		}
+		const Float3 center = (minimum + maximum) * 0.5f;
+
+		outTexCoords.resize(vertexCount);
+		RunTasks(threadPool, (vertexCount + TANGENT_VERTICES_PER_TASK - 1) / TANGENT_VERTICES_PER_TASK, [&](uint32_t taskIndex, uint32_t)
+		{
+			const uint32_t end = (taskIndex + 1) * TANGENT_VERTICES_PER_TASK < vertexCount ? (taskIndex + 1) * TANGENT_VERTICES_PER_TASK : vertexCount;
+			for (uint32_t i = taskIndex * TANGENT_VERTICES_PER_TASK; i < end; ++i)
+			{
+				const Float3 direction = vertices[i].Position - center;
+				const float length = Length(direction);
+				const float y = length > 0.0f ? fmaxf(-1.0f, fminf(1.0f, direction.y / length)) : 1.0f;
+				outTexCoords[i] = Float2{ atan2f(direction.z, direction.x) * INVERSE_TWO_PI + 0.5f, acosf(y) * INVERSE_PI };
+			}
+		});
+	}
+
+	// Within 7e-5 of acos, Abramowitz and Stegun 4.4.45. The weights need nowhere near the precision of acosf, which
+	// would take most of the time of a triangle.
+	float FastAcos(float x)
+	{
+		const float a = fabsf(x);
+		const float angle = sqrtf(1.0f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f - a * 0.0187293f)));
+		return x >= 0.0f ? angle : PI - angle;
+	}
+
+	// Angle between the edges of a corner, both projected onto the plane of its normal
+	float ComputeCornerAngle(const Float3& normal, const Float3& edge0, const Float3& edge1)
+	{
+		const Float3 projected0 = edge0 - normal * Dot(normal, edge0);
+		const Float3 projected1 = edge1 - normal * Dot(normal, edge1);
+		const float squaredLengths = Dot(projected0, projected0) * Dot(projected1, projected1);
+		return squaredLengths > FLT_MIN ? FastAcos(fmaxf(-1.0f, fminf(1.0f, Dot(projected0, projected1) / sqrtf(squaredLengths)))) : 0.0f;
+	}
+
+	Float3 GetPerpendicular(const Float3& normal)
+	{
+		const Float3 axis = fabsf(normal.x) < 0.9f ? Float3{ 1.0f, 0.0f, 0.0f } : Float3{ 0.0f, 1.0f, 0.0f };
+		return Normalize(axis - normal * Dot(normal, axis));
+	}
+
+	// Rotation with the columns tangent, bitangent and normal (Shoemake, "Quaternion Calculus and Fast Animation")
+	Float4 GetFrameQuaternion(const Float3& tangent, const Float3& bitangent, const Float3& normal)
+	{
+		const float trace = tangent.x + bitangent.y + normal.z;
+		if (trace > 0.0f)
+		{
+			const float s = 0.5f / sqrtf(trace + 1.0f);
+			return { (bitangent.z - normal.y) * s, (normal.x - tangent.z) * s, (tangent.y - bitangent.x) * s, 0.25f / s };
+		}
+		if (tangent.x > bitangent.y && tangent.x > normal.z)
+		{
+			const float s = 2.0f * sqrtf(1.0f + tangent.x - bitangent.y - normal.z);
+			return { 0.25f * s, (bitangent.x + tangent.y) / s, (normal.x + tangent.z) / s, (bitangent.z - normal.y) / s };
+		}
+		if (bitangent.y > normal.z)
+		{
+			const float s = 2.0f * sqrtf(1.0f + bitangent.y - tangent.x - normal.z);
+			return { (bitangent.x + tangent.y) / s, 0.25f * s, (normal.y + bitangent.z) / s, (normal.x - tangent.z) / s };
+		}
+		const float s = 2.0f * sqrtf(1.0f + normal.z - tangent.x - bitangent.y);
+		return { (normal.x + tangent.z) / s, (normal.y + bitangent.z) / s, 0.25f * s, (tangent.y - bitangent.x) / s };
+	}
+
+	int16_t EncodeSnorm16(float value)
+	{
+		value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return (int16_t)lrintf(value * SNORM16_MAX);
+	}
+}
+
+template <typename Index>
+void GenerateTangents(const VertexData* vertices, uint32_t vertexCount, const Float2* texCoords, const Index* indices, uint32_t indexCount,
+	std::vector<Float4>& outTangents, ThreadPool* threadPool, TangentGenerationStats* outStats)
+{
+	const uint64_t startTicks = Clock::GetTicks();
+	const uint32_t triangleCount = indexCount / 3;
+
+	// Generated longitudes wrap around at the seam, which every triangle crossing it undoes
+	std::vector<Float2> sphericalTexCoords;
+	const bool bWrapU = texCoords == nullptr;
+	if (bWrapU)
+	{
+		ComputeSphericalTexCoords(vertices, vertexCount, threadPool, sphericalTexCoords);
+		texCoords = sphericalTexCoords.data();
+	}
+
+	// Tangent xyz and signed weight w of every vertex. Integer adds give the same sums in any order.
+	std::vector<std::atomic<int64_t>> sums((size_t)vertexCount * 4);
+	std::atomic<uint32_t> degenerateCount{ 0 };
+	const uint32_t triangleTaskCount = (triangleCount + TANGENT_TRIANGLES_PER_TASK - 1) / TANGENT_TRIANGLES_PER_TASK;
+	const bool bConcurrent = threadPool && triangleTaskCount > 1;
+	RunTasks(threadPool, triangleTaskCount, [&](uint32_t taskIndex, uint32_t)
+	{
+		uint32_t taskDegenerateCount = 0;
+		const uint32_t end = (taskIndex + 1) * TANGENT_TRIANGLES_PER_TASK < triangleCount ? (taskIndex + 1) * TANGENT_TRIANGLES_PER_TASK : triangleCount;
+		for (uint32_t triangle = taskIndex * TANGENT_TRIANGLES_PER_TASK; triangle < end; ++triangle)
+		{
+			const uint32_t corners[3]{ indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2] };
+			const Float3 positions[3]{ vertices[corners[0]].Position, vertices[corners[1]].Position, vertices[corners[2]].Position };
+			const Float3 edge1 = positions[1] - positions[0];
+			const Float3 edge2 = positions[2] - positions[0];
+			float du1 = texCoords[corners[1]].x - texCoords[corners[0]].x;
+			float du2 = texCoords[corners[2]].x - texCoords[corners[0]].x;
+			if (bWrapU)
+			{
+				du1 -= floorf(du1 + 0.5f);
+				du2 -= floorf(du2 + 0.5f);
+			}
+			const float dv1 = texCoords[corners[1]].y - texCoords[corners[0]].y;
+			const float dv2 = texCoords[corners[2]].y - texCoords[corners[0]].y;
+
+			// Twice the signed area in texture space, and the directions of increasing u and v scaled by it
+			const float textureArea = du1 * dv2 - du2 * dv1;
+			const Float3 faceNormal = Cross(edge1, edge2);
+			if (fabsf(textureArea) <= FLT_MIN || Dot(faceNormal, faceNormal) <= FLT_MIN)
+			{
+				++taskDegenerateCount;
+				continue;
+			}
+			const float areaSign = textureArea > 0.0f ? 1.0f : -1.0f;
+			const Float3 tangent = (edge1 * dv2 - edge2 * dv1) * areaSign;
+			const Float3 bitangent = (edge2 * du1 - edge1 * du2) * areaSign;
+			const float handedness = Dot(Cross(faceNormal, tangent), bitangent) >= 0.0f ? 1.0f : -1.0f;
+
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				const Float3& normal = vertices[corners[corner]].Normal;
+				const Float3 projected = tangent - normal * Dot(normal, tangent);
+				const float length = Length(projected);
+				const float angle = ComputeCornerAngle(normal, positions[(corner + 1) % 3] - positions[corner], positions[(corner + 2) % 3] - positions[corner]);
+				if (length <= FLT_MIN || angle <= 0.0f)
+				{
+					continue;
+				}
+
+				const float weight = angle / length;
+				std::atomic<int64_t>* sum = &sums[(size_t)corners[corner] * 4];
+				AddFixedPoint(sum[0], projected.x * weight, bConcurrent);
+				AddFixedPoint(sum[1], projected.y * weight, bConcurrent);
+				AddFixedPoint(sum[2], projected.z * weight, bConcurrent);
+				AddFixedPoint(sum[3], handedness * angle, bConcurrent);
+			}
+		}
+		degenerateCount.fetch_add(taskDegenerateCount, std::memory_order_relaxed);
+	});
+
+	outTangents.resize(vertexCount);
+	std::atomic<uint32_t> fallbackCount{ 0 };
+	std::atomic<uint32_t> mirroredCount{ 0 };
+	RunTasks(threadPool, (vertexCount + TANGENT_VERTICES_PER_TASK - 1) / TANGENT_VERTICES_PER_TASK, [&](uint32_t taskIndex, uint32_t)
+	{
+		uint32_t taskFallbackCount = 0;
+		uint32_t taskMirroredCount = 0;
+		const uint32_t end = (taskIndex + 1) * TANGENT_VERTICES_PER_TASK < vertexCount ? (taskIndex + 1) * TANGENT_VERTICES_PER_TASK : vertexCount;
+		for (uint32_t i = taskIndex * TANGENT_VERTICES_PER_TASK; i < end; ++i)
+		{
+			const std::atomic<int64_t>* sum = &sums[(size_t)i * 4];
+			const Float3 direction{ (float)sum[0].load(std::memory_order_relaxed), (float)sum[1].load(std::memory_order_relaxed),
+				(float)sum[2].load(std::memory_order_relaxed) };
+
+			// Corners were projected onto the same normal, the sum only drifts off it by rounding. Still in fixed point, which
+			// normalizing takes out.
+			const Float3& normal = vertices[i].Normal;
+			Float3 tangent = direction - normal * Dot(normal, direction);
+			const float length = Length(tangent);
+			if (length > 1e-6f * FIXED_POINT_SCALE)
+			{
+				tangent = tangent * (1.0f / length);
+			}
+			else
+			{
+				tangent = GetPerpendicular(normal);
+				++taskFallbackCount;
+			}
+
+			const float handedness = sum[3].load(std::memory_order_relaxed) >= 0 ? 1.0f : -1.0f;
+			taskMirroredCount += handedness < 0.0f;
+			outTangents[i] = ToFloat4(tangent, handedness);
+		}
+		fallbackCount.fetch_add(taskFallbackCount, std::memory_order_relaxed);
+		mirroredCount.fetch_add(taskMirroredCount, std::memory_order_relaxed);
+	});
+
+	if (outStats)
+	{
+		outStats->VertexCount = vertexCount;
+		outStats->TriangleCount = triangleCount;
+		outStats->DegenerateTriangleCount = degenerateCount.load();
+		outStats->FallbackVertexCount = fallbackCount.load();
+		outStats->MirroredVertexCount = mirroredCount.load();
+		outStats->TotalMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - startTicks);
+	}
+}
+
+void GenerateTangents(const VertexData* vertices, uint32_t vertexCount, const Float2* texCoords, const MeshIndices& indices, uint32_t startIndex,
+	uint32_t indexCount, std::vector<Float4>& outTangents, ThreadPool* threadPool, TangentGenerationStats* outStats)
+{
+	if (indices.Format == INDEX_FORMAT_UINT16)
+	{
+		GenerateTangents(vertices, vertexCount, texCoords, indices.Indices16.data() + startIndex, indexCount, outTangents, threadPool, outStats);
+	}
+	else
+	{
+		GenerateTangents(vertices, vertexCount, texCoords, indices.Indices32.data() + startIndex, indexCount, outTangents, threadPool, outStats);
+	}
+}
+
+void PackQTangents(const VertexData* vertices, const Float4* tangents, uint32_t vertexCount, QTangent* outQTangents)
+{
+	// w of at least one step of SNORM16, so that its sign survives the rounding
+	const float minW = 1.0f / SNORM16_MAX;
+	const float maxXyzLength = sqrtf(1.0f - minW * minW);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		const Float3 normal = Normalize(vertices[i].Normal);
+		const Float3 tangent = Normalize(ToFloat3(tangents[i]));
+		Float4 q = GetFrameQuaternion(tangent, Cross(normal, tangent), normal);
+
+		// q and -q are the same rotation, which leaves the sign of w free for the bitangent
+		const float length = sqrtf(Dot(q, q));
+		const float scale = (q.w < 0.0f ? -1.0f : 1.0f) / length;
+		q = Float4{ q.x * scale, q.y * scale, q.z * scale, q.w * scale };
+		if (q.w < minW)
+		{
+			const float xyzLength = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z);
+			const float xyzScale = xyzLength > 0.0f ? maxXyzLength / xyzLength : 0.0f;
+			q = Float4{ q.x * xyzScale, q.y * xyzScale, q.z * xyzScale, minW };
+		}
+		if (tangents[i].w < 0.0f)
+		{
+			q = Float4{ -q.x, -q.y, -q.z, -q.w };
+		}
+
+		outQTangents[i] = QTangent{ { EncodeSnorm16(q.x), EncodeSnorm16(q.y), EncodeSnorm16(q.z), EncodeSnorm16(q.w) } };
+	}
+}
+
+void UnpackQTangent(const QTangent& qTangent, Float3& outNormal, Float4& outTangent)
+{
+	Float4 q{ DecodeSnorm16(qTangent.Value[0]), DecodeSnorm16(qTangent.Value[1]), DecodeSnorm16(qTangent.Value[2]), DecodeSnorm16(qTangent.Value[3]) };
+	const float inverseLength = 1.0f / sqrtf(Dot(q, q));
+	q = Float4{ q.x * inverseLength, q.y * inverseLength, q.z * inverseLength, q.w * inverseLength };
+	outNormal = Vector3Rotate(Float3{ 0.0f, 0.0f, 1.0f }, q);
+	outTangent = ToFloat4(Vector3Rotate(Float3{ 1.0f, 0.0f, 0.0f }, q), q.w < 0.0f ? -1.0f : 1.0f);
+}
+
+template void GenerateTangents<uint16_t>(const VertexData* vertices, uint32_t vertexCount, const Float2* texCoords, const uint16_t* indices, uint32_t indexCount,
+	std::vector<Float4>& outTangents, ThreadPool* threadPool, TangentGenerationStats* outStats);
+template void GenerateTangents<uint32_t>(const VertexData* vertices, uint32_t vertexCount, const Float2* texCoords, const uint32_t* indices, uint32_t indexCount,
+	std::vector<Float4>& outTangents, ThreadPool* threadPool, TangentGenerationStats* outStats);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "MathTypes.h"
+#include "MeshGenerator.h"
+#include "VertexTypes.h"
+
+class ThreadPool;
+
+// Tangent frame as one quaternion, SHORT4_SNORM. The quaternion rotates (1, 0, 0) onto the tangent and (0, 0, 1) onto the
+// normal, and the sign of w is the sign of the bitangent, so w is never 0.
+struct QTangent
+{
+	int16_t Value[4];
+};
+
+struct TangentGenerationStats
+{
+	uint32_t VertexCount;
+	uint32_t TriangleCount;
+
+	// Triangles without area in position or texture space add nothing
+	uint32_t DegenerateTriangleCount;
+
+	// Vertices whose triangles gave no tangent, and got one at right angles to the normal instead
+	uint32_t FallbackVertexCount;
+
+	// Vertices with the bitangent against cross(normal, tangent), where the texture is mirrored
+	uint32_t MirroredVertexCount;
+
+	double TotalMilliseconds;
+
+	double GetVerticesPerSecond() const { return TotalMilliseconds > 0.0 ? VertexCount / (TotalMilliseconds / 1000.0) : 0.0; }
+};
+
+// Per vertex tangents for normal mapping, built the way MikkTSpace builds them: every corner of a triangle takes the direction
+// of increasing u of the triangle, projected onto the plane of the vertex normal and normalized, weighted by the angle of the
+// corner. xyz of outTangents[i] is the normalized sum at vertex i, at right angles to its normal, and w is +1 or -1 so that
+// the bitangent is w * cross(normal, tangent). Unlike MikkTSpace, vertices are not split where their corners disagree: the
+// corners that are not mirrored in texture space, by weight, decide the sign.
+// Triangles are spread over threadPool when given. Every corner is added into fixed point sums of its vertex with atomic
+// adds, which do not depend on the order, so the result is the same on any number of threads.
+// texCoords holds a Float2 per vertex. Without it, u and v are the longitude and latitude of every vertex around the center
+// of the bounds, with u taken the short way around on every triangle, which suits closed and roughly round meshes such as
+// the spheres and most imported models without texture coordinates. Index is uint16_t or uint32_t.
+template <typename Index>
+void GenerateTangents(const VertexData* vertices, uint32_t vertexCount, const Float2* texCoords, const Index* indices, uint32_t indexCount,
+	std::vector<Float4>& outTangents, ThreadPool* threadPool = nullptr, TangentGenerationStats* outStats = nullptr);
+
+// Same on the draw range indices [startIndex, startIndex + indexCount) of a MeshIndices
+void GenerateTangents(const VertexData* vertices, uint32_t vertexCount, const Float2* texCoords, const MeshIndices& indices, uint32_t startIndex,
+	uint32_t indexCount, std::vector<Float4>& outTangents, ThreadPool* threadPool = nullptr, TangentGenerationStats* outStats = nullptr);
+
+// Packs every normal and tangent into 8 bytes instead of the 28 of a Float3 normal and Float4 tangent
+void PackQTangents(const VertexData* vertices, const Float4* tangents, uint32_t vertexCount, QTangent* outQTangents);
+
+// What a vertex shader decodes, the normal and the tangent with the sign of the bitangent in w
+void UnpackQTangent(const QTangent& qTangent, Float3& outNormal, Float4& outTangent);
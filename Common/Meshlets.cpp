@@ -0,0 +1,403 @@
+#include "Meshlets.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "Clock.h"
+
+namespace
+{
+	constexpr uint32_t NO_MESHLET = UINT32_MAX;
+	constexpr uint32_t NO_TRIANGLE = UINT32_MAX;
+
+	// Weights of the cost of adding a triangle to a meshlet, next to the count of vertices it adds: how far its normal turns
+	// from the axis of the meshlet, and how far it lies from the center of the meshlet in radii of a typical meshlet, which
+	// spans about MESHLET_RADIUS_IN_EDGES mean edge lengths
+	constexpr float MESHLET_CONE_WEIGHT = 2.0f;
+	constexpr float MESHLET_RADIUS_IN_EDGES = 4.0f;
+
+	const Float3& GetPosition(const void* positions, uint32_t vertexStride, uint32_t index)
+	{
+		return *(const Float3*)((const uint8_t*)positions + (size_t)index * vertexStride);
+	}
+
+	// Bounding sphere around the center of the box of the vertices, and the normal cone of the triangles
+	template <typename Index>
+	void AddMeshlet(const void* positions, uint32_t vertexStride, const Index* indices, const Meshlet& meshlet, MeshletMesh& outMesh)
+	{
+		Float3 minimum{ FLT_MAX, FLT_MAX, FLT_MAX };
+		Float3 maximum{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (uint32_t i = meshlet.StartIndex; i < meshlet.StartIndex + meshlet.IndexCount; ++i)
+		{
+			const Float3& position = GetPosition(positions, vertexStride, indices[i]);
+			minimum = Float3{ fminf(minimum.x, position.x), fminf(minimum.y, position.y), fminf(minimum.z, position.z) };
+			maximum = Float3{ fmaxf(maximum.x, position.x), fmaxf(maximum.y, position.y), fmaxf(maximum.z, position.z) };
+		}
+
+		const Float3 center = (minimum + maximum) * 0.5f;
+		float radius = 0.0f;
+		for (uint32_t i = meshlet.StartIndex; i < meshlet.StartIndex + meshlet.IndexCount; ++i)
+		{
+			radius = fmaxf(radius, Length(GetPosition(positions, vertexStride, indices[i]) - center));
+		}
+
+		// Every triangle counts the same whatever its area, the axis is the mean of their unit normals
+		Float3 normals[MESHLET_MAX_TRIANGLE_COUNT];
+		uint32_t normalCount = 0;
+		Float3 axis{ 0.0f, 0.0f, 0.0f };
+		for (uint32_t i = meshlet.StartIndex; i < meshlet.StartIndex + meshlet.IndexCount; i += 3)
+		{
+			const Float3& p0 = GetPosition(positions, vertexStride, indices[i + 0]);
+			const Float3& p1 = GetPosition(positions, vertexStride, indices[i + 1]);
+			const Float3& p2 = GetPosition(positions, vertexStride, indices[i + 2]);
+			const Float3 normal = Cross(p1 - p0, p2 - p0);
+			const float length = Length(normal);
+			if (length > 0.0f)
+			{
+				normals[normalCount] = normal * (1.0f / length);
+				axis += normals[normalCount++];
+			}
+		}
+
+		// The cone has to hold the normal farthest from the axis. Past 90 degrees no camera sees only back faces.
+		float cutoff = 1.0f;
+		const float axisLength = Length(axis);
+		if (axisLength > 0.0f)
+		{
+			axis = axis * (1.0f / axisLength);
+			float minimumDot = 1.0f;
+			for (uint32_t i = 0; i < normalCount; ++i)
+			{
+				minimumDot = fminf(minimumDot, Dot(axis, normals[i]));
+			}
+			cutoff = minimumDot > 0.0f ? sqrtf(1.0f - minimumDot * minimumDot) : 1.0f;
+		}
+
+		outMesh.Meshlets.push_back(meshlet);
+		outMesh.Bounds.CenterX.push_back(center.x);
+		outMesh.Bounds.CenterY.push_back(center.y);
+		outMesh.Bounds.CenterZ.push_back(center.z);
+		outMesh.Bounds.Radius.push_back(radius);
+		outMesh.ConeAxisX.push_back(axis.x);
+		outMesh.ConeAxisY.push_back(axis.y);
+		outMesh.ConeAxisZ.push_back(axis.z);
+		outMesh.ConeCutoff.push_back(cutoff);
+	}
+
+	bool IsBackfacing(const MeshletMesh& mesh, uint32_t meshletIndex, const Float3& cameraPosition)
+	{
+		const Float3 offset{
+			mesh.Bounds.CenterX[meshletIndex] - cameraPosition.x,
+			mesh.Bounds.CenterY[meshletIndex] - cameraPosition.y,
+			mesh.Bounds.CenterZ[meshletIndex] - cameraPosition.z
+		};
+		const Float3 axis{ mesh.ConeAxisX[meshletIndex], mesh.ConeAxisY[meshletIndex], mesh.ConeAxisZ[meshletIndex] };
+		const float radius = mesh.Bounds.Radius[meshletIndex];
+		const float cutoff = mesh.ConeCutoff[meshletIndex];
+
+		return cutoff < 1.0f && Dot(offset, axis) >= cutoff * (Length(offset) + radius) + radius;
+	}
+}
+
+template <typename Index>
+void BuildMeshlets(const void* positions, uint32_t vertexCount, uint32_t vertexStride, Index* indices, uint32_t startIndex, uint32_t indexCount,
+	MeshletMesh& outMesh)
+{
+	outMesh = MeshletMesh{};
+	const uint32_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// The triangles are read from a copy while they are written back in meshlet order
+	const std::vector<Index> triangles(indices + startIndex, indices + startIndex + triangleCount * 3);
+
+	// Triangles of every vertex, packed one vertex after the other
+	std::vector<uint32_t> vertexTriangleOffsets(vertexCount + 1, 0);
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		++vertexTriangleOffsets[triangles[i] + 1];
+	}
+	for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		vertexTriangleOffsets[vertex + 1] += vertexTriangleOffsets[vertex];
+	}
+	std::vector<uint32_t> vertexTriangles(triangleCount * 3);
+	std::vector<uint32_t> vertexTriangleCounts(vertexCount, 0);
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		const uint32_t vertex = triangles[i];
+		vertexTriangles[vertexTriangleOffsets[vertex] + vertexTriangleCounts[vertex]++] = i / 3;
+	}
+
+	// Centroid and unit normal of every triangle, and the mean edge length that scales distances to the size of a meshlet
+	std::vector<Float3> centroids(triangleCount);
+	std::vector<Float3> normals(triangleCount);
+	float edgeLengthSum = 0.0f;
+	for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+	{
+		const Float3& p0 = GetPosition(positions, vertexStride, triangles[triangle * 3 + 0]);
+		const Float3& p1 = GetPosition(positions, vertexStride, triangles[triangle * 3 + 1]);
+		const Float3& p2 = GetPosition(positions, vertexStride, triangles[triangle * 3 + 2]);
+		const Float3 normal = Cross(p1 - p0, p2 - p0);
+		const float length = Length(normal);
+		centroids[triangle] = (p0 + p1 + p2) * (1.0f / 3.0f);
+		normals[triangle] = length > 0.0f ? normal * (1.0f / length) : Float3{ 0.0f, 0.0f, 0.0f };
+		edgeLengthSum += Length(p1 - p0) + Length(p2 - p1) + Length(p0 - p2);
+	}
+	const float meshletRadius = edgeLengthSum / (triangleCount * 3) * MESHLET_RADIUS_IN_EDGES;
+	const float inverseMeshletRadius = meshletRadius > 0.0f ? 1.0f / meshletRadius : 0.0f;
+
+	// Meshlet that last took each vertex, so that shared vertices are only counted once per meshlet, and meshlet that last
+	// listed each triangle as a candidate
+	std::vector<uint32_t> vertexMeshlets(vertexCount, NO_MESHLET);
+	std::vector<uint32_t> candidateMeshlets(triangleCount, NO_MESHLET);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<uint32_t> candidates;
+	uint32_t emittedCount = 0;
+	uint32_t nextSeed = 0;
+	uint32_t writeIndex = startIndex;
+	while (emittedCount < triangleCount)
+	{
+		// The next meshlet starts next to the last one, on a triangle it left as a candidate, or else on the first triangle left
+		uint32_t triangle = NO_TRIANGLE;
+		for (uint32_t candidate : candidates)
+		{
+			if (!emitted[candidate])
+			{
+				triangle = candidate;
+				break;
+			}
+		}
+		if (triangle == NO_TRIANGLE)
+		{
+			while (emitted[nextSeed])
+			{
+				++nextSeed;
+			}
+			triangle = nextSeed;
+		}
+		candidates.clear();
+
+		const uint32_t meshletIndex = outMesh.GetCount();
+		Meshlet meshlet{ writeIndex, 0, 0 };
+		Float3 normalSum{ 0.0f, 0.0f, 0.0f };
+		Float3 centroidSum{ 0.0f, 0.0f, 0.0f };
+		while (triangle != NO_TRIANGLE)
+		{
+			emitted[triangle] = 1;
+			++emittedCount;
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				const uint32_t vertex = triangles[triangle * 3 + k];
+				indices[writeIndex++] = (Index)vertex;
+				if (vertexMeshlets[vertex] == meshletIndex)
+				{
+					continue;
+				}
+
+				// A new vertex brings the triangles around it in reach
+				vertexMeshlets[vertex] = meshletIndex;
+				++meshlet.VertexCount;
+				for (uint32_t i = vertexTriangleOffsets[vertex]; i < vertexTriangleOffsets[vertex + 1]; ++i)
+				{
+					const uint32_t neighbor = vertexTriangles[i];
+					if (!emitted[neighbor] && candidateMeshlets[neighbor] != meshletIndex)
+					{
+						candidateMeshlets[neighbor] = meshletIndex;
+						candidates.push_back(neighbor);
+					}
+				}
+			}
+			meshlet.IndexCount += 3;
+			normalSum += normals[triangle];
+			centroidSum += centroids[triangle];
+			if (meshlet.IndexCount == MESHLET_MAX_TRIANGLE_COUNT * 3)
+			{
+				break;
+			}
+
+			// The candidate that adds the fewest vertices, then faces most like the meshlet and lies closest to its center.
+			// Emitted candidates are dropped on the way.
+			const float normalLength = Length(normalSum);
+			const Float3 axis = normalLength > 0.0f ? normalSum * (1.0f / normalLength) : Float3{ 0.0f, 0.0f, 0.0f };
+			const Float3 center = centroidSum * (3.0f / meshlet.IndexCount);
+			triangle = NO_TRIANGLE;
+			float bestCost = FLT_MAX;
+			size_t keptCount = 0;
+			for (size_t i = 0; i < candidates.size(); ++i)
+			{
+				const uint32_t candidate = candidates[i];
+				if (emitted[candidate])
+				{
+					continue;
+				}
+				candidates[keptCount++] = candidate;
+
+				const uint32_t a = triangles[candidate * 3 + 0];
+				const uint32_t b = triangles[candidate * 3 + 1];
+				const uint32_t c = triangles[candidate * 3 + 2];
+				const uint32_t newVertexCount = (vertexMeshlets[a] != meshletIndex) + (vertexMeshlets[b] != meshletIndex && b != a) +
+					(vertexMeshlets[c] != meshletIndex && c != a && c != b);
+				if (meshlet.VertexCount + newVertexCount > MESHLET_MAX_VERTEX_COUNT)
+				{
+					continue;
+				}
+
+				const float cost = newVertexCount + MESHLET_CONE_WEIGHT * (1.0f - Dot(normals[candidate], axis)) +
+					Length(centroids[candidate] - center) * inverseMeshletRadius;
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					triangle = candidate;
+				}
+			}
+			candidates.resize(keptCount);
+		}
+
+		AddMeshlet(positions, vertexStride, indices, meshlet, outMesh);
+	}
+}
+
+template void BuildMeshlets<uint16_t>(const void* positions, uint32_t vertexCount, uint32_t vertexStride, uint16_t* indices, uint32_t startIndex,
+	uint32_t indexCount, MeshletMesh& outMesh);
+template void BuildMeshlets<uint32_t>(const void* positions, uint32_t vertexCount, uint32_t vertexStride, uint32_t* indices, uint32_t startIndex,
+	uint32_t indexCount, MeshletMesh& outMesh);
+
+void BuildMeshlets(const void* positions, uint32_t vertexCount, uint32_t vertexStride, void* indices, INDEX_FORMAT indexFormat, uint32_t startIndex,
+	uint32_t indexCount, MeshletMesh& outMesh)
+{
+	if (indexFormat == INDEX_FORMAT_UINT16)
+	{
+		BuildMeshlets(positions, vertexCount, vertexStride, (uint16_t*)indices, startIndex, indexCount, outMesh);
+	}
+	else
+	{
+		BuildMeshlets(positions, vertexCount, vertexStride, (uint32_t*)indices, startIndex, indexCount, outMesh);
+	}
+}
+
+void AppendMeshletRecords(const MeshletMesh& mesh, std::vector<MeshletRecord>& outRecords)
+{
+	for (uint32_t i = 0; i < mesh.GetCount(); ++i)
+	{
+		const Meshlet& meshlet = mesh.Meshlets[i];
+		outRecords.push_back(MeshletRecord{ meshlet.StartIndex, meshlet.IndexCount, meshlet.VertexCount,
+			Float3{ mesh.Bounds.CenterX[i], mesh.Bounds.CenterY[i], mesh.Bounds.CenterZ[i] }, mesh.Bounds.Radius[i],
+			Float3{ mesh.ConeAxisX[i], mesh.ConeAxisY[i], mesh.ConeAxisZ[i] }, mesh.ConeCutoff[i] });
+	}
+}
+
+void LoadMeshletRecords(const MeshletRecord* records, uint32_t count, MeshletMesh& outMesh)
+{
+	outMesh = MeshletMesh{};
+	outMesh.Meshlets.resize(count);
+	outMesh.Bounds.Resize(count);
+	outMesh.ConeAxisX.resize(count);
+	outMesh.ConeAxisY.resize(count);
+	outMesh.ConeAxisZ.resize(count);
+	outMesh.ConeCutoff.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const MeshletRecord& record = records[i];
+		outMesh.Meshlets[i] = Meshlet{ record.StartIndex, record.IndexCount, record.VertexCount };
+		outMesh.Bounds.CenterX[i] = record.Center.x;
+		outMesh.Bounds.CenterY[i] = record.Center.y;
+		outMesh.Bounds.CenterZ[i] = record.Center.z;
+		outMesh.Bounds.Radius[i] = record.Radius;
+		outMesh.ConeAxisX[i] = record.ConeAxis.x;
+		outMesh.ConeAxisY[i] = record.ConeAxis.y;
+		outMesh.ConeAxisZ[i] = record.ConeAxis.z;
+		outMesh.ConeCutoff[i] = record.ConeCutoff;
+	}
+}
+
+void MeshletCuller::BeginFrame(uint32_t indexSize)
+{
+	IndexSize = indexSize;
+	Indices.clear();
+	Stats = MeshletStats{};
+}
+
+MeshletDraw MeshletCuller::CullObject(const MeshletMesh& mesh, const void* indices, const TransformArrays& transforms, uint32_t objectIndex,
+	const Frustum& frustum, const Float3& cameraPosition)
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+
+	// The inverse transform moves back, rotates by the conjugate and divides by the scale
+	const Float3 position{ transforms.PositionX[objectIndex], transforms.PositionY[objectIndex], transforms.PositionZ[objectIndex] };
+	const Float4 inverseRotation{ -transforms.RotationX[objectIndex], -transforms.RotationY[objectIndex], -transforms.RotationZ[objectIndex], transforms.RotationW[objectIndex] };
+	const Float3 scale{ transforms.ScaleX[objectIndex], transforms.ScaleY[objectIndex], transforms.ScaleZ[objectIndex] };
+
+	const Float3 rotatedCamera = Vector3Rotate(cameraPosition - position, inverseRotation);
+	const Float3 objectCamera{ rotatedCamera.x / scale.x, rotatedCamera.y / scale.y, rotatedCamera.z / scale.z };
+
+	// With world = R * S * object + T, a plane (n, d) becomes (S * R^T * n, d + dot(n, T)), normalized again for the sphere test
+	Frustum objectFrustum;
+	for (uint32_t i = 0; i < FRUSTUM_PLANE_COUNT; ++i)
+	{
+		const Float4& plane = frustum.Planes[i];
+		const Float3 normal = ToFloat3(plane);
+		const Float3 rotatedNormal = Vector3Rotate(normal, inverseRotation);
+		const Float3 objectNormal{ rotatedNormal.x * scale.x, rotatedNormal.y * scale.y, rotatedNormal.z * scale.z };
+		const float inverseLength = 1.0f / Length(objectNormal);
+		objectFrustum.Planes[i] = ToFloat4(objectNormal * inverseLength, (plane.w + Dot(normal, position)) * inverseLength);
+	}
+
+	const uint32_t meshletCount = mesh.GetCount();
+	VisibleMeshlets.resize(meshletCount);
+	const uint32_t visibleCount = CullSpheres(objectFrustum, mesh.Bounds, 0, meshletCount, VisibleMeshlets.data());
+
+	// Neighbouring meshlets are neighbouring index ranges, and are copied together
+	const bool bConeCulling = scale.x == scale.y && scale.y == scale.z;
+	const uint8_t* indexBytes = (const uint8_t*)indices;
+	MeshletDraw draw{ (uint32_t)(Indices.size() / IndexSize), 0 };
+	uint32_t runStart = 0;
+	uint32_t runCount = 0;
+	for (uint32_t i = 0; i <= visibleCount; ++i)
+	{
+		const Meshlet* meshlet = nullptr;
+		if (i < visibleCount)
+		{
+			if (bConeCulling && IsBackfacing(mesh, VisibleMeshlets[i], objectCamera))
+			{
+				++Stats.BackfaceCulledCount;
+				continue;
+			}
+			meshlet = &mesh.Meshlets[VisibleMeshlets[i]];
+		}
+
+		if (meshlet && meshlet->StartIndex == runStart + runCount)
+		{
+			runCount += meshlet->IndexCount;
+			continue;
+		}
+
+		if (runCount > 0)
+		{
+			const size_t offset = Indices.size();
+			Indices.resize(offset + (size_t)runCount * IndexSize);
+			memcpy(Indices.data() + offset, indexBytes + (size_t)runStart * IndexSize, (size_t)runCount * IndexSize);
+			draw.IndexCount += runCount;
+		}
+
+		if (meshlet)
+		{
+			runStart = meshlet->StartIndex;
+			runCount = meshlet->IndexCount;
+		}
+	}
+
+	// Meshlets cover one index range, from the first to the last
+	const uint32_t triangleCount = meshletCount ? (mesh.Meshlets.back().StartIndex + mesh.Meshlets.back().IndexCount - mesh.Meshlets[0].StartIndex) / 3 : 0;
+	++Stats.ObjectCount;
+	Stats.MeshletCount += meshletCount;
+	Stats.FrustumCulledCount += meshletCount - visibleCount;
+	Stats.TriangleCount += triangleCount;
+	Stats.CulledTriangleCount += triangleCount - draw.IndexCount / 3;
+	Stats.CullTime += Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+
+	return draw;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "BoundingVolumes.h"
+#include "FrustumCulling.h"
+#include "MathTypes.h"
+#include "MeshGenerator.h"
+#include "ObjectTransforms.h"
+
+// Size limits of a meshlet, the ones recommended for mesh shaders
+constexpr uint32_t MESHLET_MAX_VERTEX_COUNT = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLE_COUNT = 124;
+
+// Consecutive triangles of an index buffer, the indices [StartIndex, StartIndex + IndexCount)
+struct Meshlet
+{
+	uint32_t StartIndex;
+	uint32_t IndexCount;
+	uint32_t VertexCount;
+};
+
+// Meshlets of one mesh with their bounds in the space of the mesh, as structures of arrays.
+// Every triangle of a meshlet is within the cone around ConeAxis whose sine of the half angle is ConeCutoff, so all of them
+// face away from a camera at c when dot(center - c, axis) >= cutoff * (length(center - c) + radius) + radius.
+// A ConeCutoff of 1 or more never passes, the meshlet faces too many ways to be culled as a whole.
+struct MeshletMesh
+{
+	std::vector<Meshlet> Meshlets;
+	SphereBoundsArrays Bounds;
+	std::vector<float> ConeAxisX;
+	std::vector<float> ConeAxisY;
+	std::vector<float> ConeAxisZ;
+	std::vector<float> ConeCutoff;
+
+	uint32_t GetCount() const { return (uint32_t)Meshlets.size(); }
+};
+
+// Splits the triangles of indices[startIndex, startIndex + indexCount) into meshlets of at most MESHLET_MAX_VERTEX_COUNT vertices
+// and MESHLET_MAX_TRIANGLE_COUNT triangles, and writes them back in place one meshlet after the other so that every meshlet is one
+// index range. A meshlet grows from a seed triangle by the neighbor that adds the fewest vertices, then faces most like it and
+// lies closest to its center, which keeps it round with a narrow normal cone; the next one starts next to it. Inside a meshlet
+// triangles stay in the order they were added, from one neighbor to the next, which the vertex cache handles well.
+// positions is the Float3 at the start of every vertexStride bytes, indexed by indices. Front faces are clockwise, as in
+// Direct3D, which makes Cross(p1 - p0, p2 - p0) the normal on the front side in a left-handed space.
+template <typename Index>
+void BuildMeshlets(const void* positions, uint32_t vertexCount, uint32_t vertexStride, Index* indices, uint32_t startIndex, uint32_t indexCount,
+	MeshletMesh& outMesh);
+
+// Same on indices of indexFormat
+void BuildMeshlets(const void* positions, uint32_t vertexCount, uint32_t vertexStride, void* indices, INDEX_FORMAT indexFormat, uint32_t startIndex,
+	uint32_t indexCount, MeshletMesh& outMesh);
+
+// One meshlet with its bounds and cone, the way mesh caches store them
+struct MeshletRecord
+{
+	uint32_t StartIndex;
+	uint32_t IndexCount;
+	uint32_t VertexCount;
+	Float3 Center;
+	float Radius;
+	Float3 ConeAxis;
+	float ConeCutoff;
+};
+
+// Appends the meshlets of mesh to outRecords, and replaces outMesh with count records
+void AppendMeshletRecords(const MeshletMesh& mesh, std::vector<MeshletRecord>& outRecords);
+void LoadMeshletRecords(const MeshletRecord* records, uint32_t count, MeshletMesh& outMesh);
+
+struct MeshletStats
+{
+	uint32_t ObjectCount;
+	uint32_t MeshletCount;
+	uint32_t FrustumCulledCount;
+	uint32_t BackfaceCulledCount;
+	uint64_t TriangleCount;
+	uint64_t CulledTriangleCount;
+
+	// Milliseconds
+	double CullTime;
+};
+
+// Indices of one object in the compacted index data of a MeshletCuller
+struct MeshletDraw
+{
+	uint32_t StartIndex;
+	uint32_t IndexCount;
+};
+
+// Culls the meshlets of objects one at a time and packs the indices of the meshlets that are left into one array,
+// to be uploaded once and drawn with one DrawIndexed per object.
+// Meshlets are tested in the space of the object: the frustum planes and the camera are moved there with the inverse of its transform.
+// The frustum test runs on SIMD_WIDTH meshlets at a time (CullSpheres), the cone test on the meshlets that pass it.
+// Cones are only tested on objects with a uniform scale, the only ones that keep the angles of their normals.
+class MeshletCuller
+{
+public:
+	// Clears the compacted indices and resets the stats. indexSize is 2 or 4, as in the index buffer the meshlets were built on.
+	void BeginFrame(uint32_t indexSize);
+
+	// Culls the meshlets of mesh placed by transforms[objectIndex] against the world space frustum and camera position,
+	// appends the indices of the remaining meshlets, read from indices, and returns where they are
+	MeshletDraw CullObject(const MeshletMesh& mesh, const void* indices, const TransformArrays& transforms, uint32_t objectIndex,
+		const Frustum& frustum, const Float3& cameraPosition);
+
+	const void* GetIndexData() const { return Indices.data(); }
+	uint32_t GetIndexDataSize() const { return (uint32_t)Indices.size(); }
+
+	const MeshletStats& GetStats() const { return Stats; }
+
+private:
+	uint32_t IndexSize = sizeof(uint16_t);
+	std::vector<uint8_t> Indices;
+	std::vector<uint32_t> VisibleMeshlets;
+	MeshletStats Stats{};
+};
@@ -0,0 +1,1000 @@
+#include "NullRenderDevice.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+	constexpr size_t MAX_VALIDATION_MESSAGES = 64;
+
+	uint32_t GetFormatSize(VERTEX_FORMAT format)
+	{
+		switch (format)
+		{
+		case VERTEX_FORMAT_FLOAT2: return 8;
+		case VERTEX_FORMAT_FLOAT3: return 12;
+		case VERTEX_FORMAT_FLOAT4: return 16;
+		case VERTEX_FORMAT_SHORT2_SNORM: return 4;
+		case VERTEX_FORMAT_SHORT4_SNORM: return 8;
+		case VERTEX_FORMAT_UBYTE4_UNORM: return 4;
+		default: return 0;
+		}
+	}
+
+	bool IsValidShaderDesc(const ShaderDesc& desc)
+	{
+		return (desc.FileName || desc.SourceCode) && desc.EntryPoint && desc.ShaderModel;
+	}
+}
+
+bool NullRenderDevice::Init(bool bRecordCommands)
+{
+	Free();
+
+	this->bRecordCommands = bRecordCommands;
+
+	return true;
+}
+
+void NullRenderDevice::Free()
+{
+	Buffers.clear();
+	VertexShaders.clear();
+	PixelShaders.clear();
+	InputLayouts.clear();
+	RasterizerStates.clear();
+	DepthStencilStates.clear();
+	BlendStates.clear();
+	StateCache.Clear();
+	CommandLists.clear();
+
+	StateFilter.Reset();
+	State = PipelineState{};
+	Commands.clear();
+	CurrentStats = RenderDeviceStats{};
+	FrameStats = RenderDeviceStats{};
+	ValidationErrorCount = 0;
+	ValidationMessages.clear();
+}
+
+BufferHandle NullRenderDevice::CreateBuffer(const BufferDesc& desc, const void* initialData)
+{
+	if (desc.ByteWidth == 0)
+	{
+		ReportError("CreateBuffer: ByteWidth is 0");
+		return {};
+	}
+	if (desc.Type == BUFFER_TYPE_CONSTANT && desc.ByteWidth % 16 != 0)
+	{
+		ReportError("CreateBuffer: constant buffer ByteWidth %u is not a multiple of 16", desc.ByteWidth);
+		return {};
+	}
+	if (desc.Usage == BUFFER_USAGE_IMMUTABLE && !initialData)
+	{
+		ReportError("CreateBuffer: immutable buffer without initial data");
+		return {};
+	}
+
+	Buffer buffer;
+	buffer.Desc = desc;
+	buffer.Data.resize(desc.ByteWidth);
+	if (initialData)
+	{
+		memcpy(buffer.Data.data(), initialData, desc.ByteWidth);
+	}
+	Buffers.push_back(std::move(buffer));
+
+	return { (uint32_t)Buffers.size() };
+}
+
+VertexShaderHandle NullRenderDevice::CreateVertexShader(const ShaderDesc& desc)
+{
+	if (!IsValidShaderDesc(desc))
+	{
+		ReportError("CreateVertexShader: incomplete shader desc");
+		return {};
+	}
+
+	VertexShaders.push_back({ desc.FileName ? desc.FileName : "", desc.EntryPoint, desc.ShaderModel });
+
+	return { (uint32_t)VertexShaders.size() };
+}
+
+PixelShaderHandle NullRenderDevice::CreatePixelShader(const ShaderDesc& desc)
+{
+	if (!IsValidShaderDesc(desc))
+	{
+		ReportError("CreatePixelShader: incomplete shader desc");
+		return {};
+	}
+
+	PixelShaders.push_back({ desc.FileName ? desc.FileName : "", desc.EntryPoint, desc.ShaderModel });
+
+	return { (uint32_t)PixelShaders.size() };
+}
+
+InputLayoutHandle NullRenderDevice::CreateInputLayout(const InputElementDesc* elements, uint32_t elementCount, VertexShaderHandle vertexShader)
+{
+	if (!vertexShader.IsValid() || vertexShader.Id > VertexShaders.size())
+	{
+		ReportError("CreateInputLayout: invalid vertex shader");
+		return {};
+	}
+
+	InputLayout inputLayout;
+	for (uint32_t i = 0; i < elementCount; ++i)
+	{
+		if (!elements[i].SemanticName || elements[i].InputSlot >= MAX_VERTEX_BUFFER_SLOTS || elements[i].AlignedByteOffset % 4 != 0)
+		{
+			ReportError("CreateInputLayout: invalid element %u", i);
+			return {};
+		}
+		if (elements[i].InputSlotClass == INPUT_CLASSIFICATION_PER_VERTEX && elements[i].InstanceDataStepRate != 0)
+		{
+			ReportError("CreateInputLayout: per-vertex element %u has an instance data step rate", i);
+			return {};
+		}
+
+		inputLayout.Elements.push_back(elements[i]);
+		inputLayout.SemanticNames.push_back(elements[i].SemanticName);
+	}
+
+	// Keep the semantic names alive after the caller's strings go away
+	for (uint32_t i = 0; i < elementCount; ++i)
+	{
+		inputLayout.Elements[i].SemanticName = nullptr;
+	}
+	InputLayouts.push_back(std::move(inputLayout));
+
+	return { (uint32_t)InputLayouts.size() };
+}
+
+RasterizerStateHandle NullRenderDevice::CreateRasterizerState(const RasterizerDesc& desc)
+{
+	if (desc.FillMode > FILL_MODE_WIREFRAME || desc.CullMode > CULL_MODE_BACK)
+	{
+		ReportError("CreateRasterizerState: invalid fill mode %u or cull mode %u", desc.FillMode, desc.CullMode);
+		return {};
+	}
+
+	const uint64_t key = ComputeStateKey(desc);
+	if (const uint32_t id = StateCache.Find(key))
+	{
+		return { id };
+	}
+
+	RasterizerStates.push_back(desc);
+	StateCache.Add(key, (uint32_t)RasterizerStates.size());
+
+	return { (uint32_t)RasterizerStates.size() };
+}
+
+DepthStencilStateHandle NullRenderDevice::CreateDepthStencilState(const DepthStencilDesc& desc)
+{
+	if (desc.DepthFunc > COMPARISON_FUNC_ALWAYS)
+	{
+		ReportError("CreateDepthStencilState: invalid depth function %u", desc.DepthFunc);
+		return {};
+	}
+
+	const uint64_t key = ComputeStateKey(desc);
+	if (const uint32_t id = StateCache.Find(key))
+	{
+		return { id };
+	}
+
+	DepthStencilStates.push_back(desc);
+	StateCache.Add(key, (uint32_t)DepthStencilStates.size());
+
+	return { (uint32_t)DepthStencilStates.size() };
+}
+
+BlendStateHandle NullRenderDevice::CreateBlendState(const BlendDesc& desc)
+{
+	if (desc.SrcBlend > BLEND_INV_SRC_ALPHA || desc.DestBlend > BLEND_INV_SRC_ALPHA || desc.BlendOp > BLEND_OP_MAX)
+	{
+		ReportError("CreateBlendState: invalid blend %u, %u or blend op %u", desc.SrcBlend, desc.DestBlend, desc.BlendOp);
+		return {};
+	}
+
+	const uint64_t key = ComputeStateKey(desc);
+	if (const uint32_t id = StateCache.Find(key))
+	{
+		return { id };
+	}
+
+	BlendStates.push_back(desc);
+	StateCache.Add(key, (uint32_t)BlendStates.size());
+
+	return { (uint32_t)BlendStates.size() };
+}
+
+CommandList* NullRenderDevice::CreateCommandList()
+{
+	CommandLists.push_back(std::make_unique<NullCommandList>());
+
+	return CommandLists.back().get();
+}
+
+void NullRenderDevice::UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size)
+{
+	Record(COMMAND_TYPE_UPDATE_BUFFER, buffer.Id, size);
+
+	if (!buffer.IsValid() || buffer.Id > Buffers.size())
+	{
+		ReportError("UpdateBuffer: invalid buffer %u", buffer.Id);
+		return;
+	}
+
+	Buffer& target = Buffers[buffer.Id - 1];
+	if (target.Desc.Usage == BUFFER_USAGE_IMMUTABLE)
+	{
+		ReportError("UpdateBuffer: buffer %u is BUFFER_USAGE_IMMUTABLE", buffer.Id);
+		return;
+	}
+	if (target.Desc.Type == BUFFER_TYPE_CONSTANT ? size != target.Desc.ByteWidth : size > target.Desc.ByteWidth)
+	{
+		ReportError("UpdateBuffer: %u bytes into buffer %u of %u bytes", size, buffer.Id, target.Desc.ByteWidth);
+		return;
+	}
+
+	memcpy(target.Data.data(), data, size);
+
+	// DYNAMIC buffers are written with discard
+	if (target.Desc.Usage == BUFFER_USAGE_DYNAMIC)
+	{
+		target.UsedBegin = 0;
+		target.UsedEnd = 0;
+	}
+
+	++CurrentStats.BufferUpdateCount;
+	CurrentStats.UploadBytes += size;
+	if (target.Desc.Type == BUFFER_TYPE_CONSTANT)
+	{
+		CurrentStats.ConstantUploadBytes += size;
+	}
+}
+
+void NullRenderDevice::WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size, MAP_TYPE mapType)
+{
+	Record(COMMAND_TYPE_WRITE_BUFFER, buffer.Id, offset, size, mapType);
+
+	if (!buffer.IsValid() || buffer.Id > Buffers.size())
+	{
+		ReportError("WriteBuffer: invalid buffer %u", buffer.Id);
+		return;
+	}
+
+	Buffer& target = Buffers[buffer.Id - 1];
+	if (target.Desc.Usage != BUFFER_USAGE_DYNAMIC)
+	{
+		ReportError("WriteBuffer: buffer %u is not BUFFER_USAGE_DYNAMIC", buffer.Id);
+		return;
+	}
+	if ((uint64_t)offset + size > target.Desc.ByteWidth)
+	{
+		ReportError("WriteBuffer: bytes [%u, %llu) run past buffer %u of %u bytes", offset, (unsigned long long)offset + size, buffer.Id, target.Desc.ByteWidth);
+		return;
+	}
+
+	if (mapType == MAP_TYPE_WRITE_DISCARD)
+	{
+		target.UsedBegin = 0;
+		target.UsedEnd = 0;
+	}
+	else if (offset < target.UsedEnd && target.UsedBegin < offset + size)
+	{
+		ReportError("WriteBuffer: NO_OVERWRITE bytes [%u, %u) of buffer %u are still read by a draw", offset, offset + size, buffer.Id);
+		return;
+	}
+
+	memcpy(target.Data.data() + offset, data, size);
+
+	++CurrentStats.BufferUpdateCount;
+	CurrentStats.UploadBytes += size;
+	if (target.Desc.Type == BUFFER_TYPE_CONSTANT)
+	{
+		CurrentStats.ConstantUploadBytes += size;
+	}
+}
+
+void NullRenderDevice::SetInputLayout(InputLayoutHandle inputLayout)
+{
+	if (!StateFilter.SetInputLayout(inputLayout))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_INPUT_LAYOUT, inputLayout.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (inputLayout.Id > InputLayouts.size())
+	{
+		StateFilter.Invalidate();
+		ReportError("SetInputLayout: invalid input layout %u", inputLayout.Id);
+		return;
+	}
+
+	State.InputLayout = inputLayout;
+}
+
+void NullRenderDevice::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+	if (!StateFilter.SetVertexBuffer(slot, buffer, stride, offset))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_VERTEX_BUFFER, slot, buffer.Id, stride, offset);
+	++CurrentStats.StateChangeCount;
+
+	const Buffer* vertexBuffer = FindBuffer(buffer);
+	if (slot >= MAX_VERTEX_BUFFER_SLOTS || (buffer.IsValid() && (!vertexBuffer || vertexBuffer->Desc.Type != BUFFER_TYPE_VERTEX)))
+	{
+		StateFilter.Invalidate();
+		ReportError("SetVertexBuffer: invalid vertex buffer %u in slot %u", buffer.Id, slot);
+		return;
+	}
+
+	State.VertexBuffers[slot] = { buffer, stride, offset };
+}
+
+void NullRenderDevice::SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset)
+{
+	if (!StateFilter.SetIndexBuffer(buffer, format, offset))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_INDEX_BUFFER, buffer.Id, format, offset);
+	++CurrentStats.StateChangeCount;
+
+	const Buffer* indexBuffer = FindBuffer(buffer);
+	if (buffer.IsValid() && (!indexBuffer || indexBuffer->Desc.Type != BUFFER_TYPE_INDEX))
+	{
+		StateFilter.Invalidate();
+		ReportError("SetIndexBuffer: invalid index buffer %u", buffer.Id);
+		return;
+	}
+
+	State.IndexBuffer = buffer;
+	State.IndexFormat = format;
+	State.IndexBufferOffset = offset;
+}
+
+void NullRenderDevice::SetVertexShader(VertexShaderHandle vertexShader)
+{
+	if (!StateFilter.SetVertexShader(vertexShader))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_VERTEX_SHADER, vertexShader.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (vertexShader.Id > VertexShaders.size())
+	{
+		StateFilter.Invalidate();
+		ReportError("SetVertexShader: invalid vertex shader %u", vertexShader.Id);
+		return;
+	}
+
+	State.VertexShader = vertexShader;
+}
+
+void NullRenderDevice::SetPixelShader(PixelShaderHandle pixelShader)
+{
+	if (!StateFilter.SetPixelShader(pixelShader))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_PIXEL_SHADER, pixelShader.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (pixelShader.Id > PixelShaders.size())
+	{
+		StateFilter.Invalidate();
+		ReportError("SetPixelShader: invalid pixel shader %u", pixelShader.Id);
+		return;
+	}
+
+	State.PixelShader = pixelShader;
+}
+
+void NullRenderDevice::SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, 0, 0))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_VERTEX_CONSTANT_BUFFER, slot, buffer.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (!ValidateConstantBufferRange("SetVertexConstantBuffer", slot, buffer, 0, 0))
+	{
+		StateFilter.Invalidate();
+		return;
+	}
+
+	State.VertexConstantBuffers[slot] = { buffer, 0, 0 };
+}
+
+void NullRenderDevice::SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, 0, 0))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_PIXEL_CONSTANT_BUFFER, slot, buffer.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (!ValidateConstantBufferRange("SetPixelConstantBuffer", slot, buffer, 0, 0))
+	{
+		StateFilter.Invalidate();
+		return;
+	}
+
+	State.PixelConstantBuffers[slot] = { buffer, 0, 0 };
+}
+
+void NullRenderDevice::SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, offset, size))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_VERTEX_CONSTANT_BUFFER, slot, buffer.Id, offset, size);
+	++CurrentStats.StateChangeCount;
+
+	if (!ValidateConstantBufferRange("SetVertexConstantBufferRange", slot, buffer, offset, size))
+	{
+		StateFilter.Invalidate();
+		return;
+	}
+
+	State.VertexConstantBuffers[slot] = { buffer, offset, size };
+}
+
+void NullRenderDevice::SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, offset, size))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_PIXEL_CONSTANT_BUFFER, slot, buffer.Id, offset, size);
+	++CurrentStats.StateChangeCount;
+
+	if (!ValidateConstantBufferRange("SetPixelConstantBufferRange", slot, buffer, offset, size))
+	{
+		StateFilter.Invalidate();
+		return;
+	}
+
+	State.PixelConstantBuffers[slot] = { buffer, offset, size };
+}
+
+void NullRenderDevice::SetRasterizerState(RasterizerStateHandle rasterizerState)
+{
+	if (!StateFilter.SetRasterizerState(rasterizerState))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_RASTERIZER_STATE, rasterizerState.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (rasterizerState.Id > RasterizerStates.size())
+	{
+		StateFilter.Invalidate();
+		ReportError("SetRasterizerState: invalid rasterizer state %u", rasterizerState.Id);
+		return;
+	}
+
+	State.RasterizerState = rasterizerState;
+}
+
+void NullRenderDevice::SetDepthStencilState(DepthStencilStateHandle depthStencilState)
+{
+	if (!StateFilter.SetDepthStencilState(depthStencilState))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_DEPTH_STENCIL_STATE, depthStencilState.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (depthStencilState.Id > DepthStencilStates.size())
+	{
+		StateFilter.Invalidate();
+		ReportError("SetDepthStencilState: invalid depth stencil state %u", depthStencilState.Id);
+		return;
+	}
+
+	State.DepthStencilState = depthStencilState;
+}
+
+void NullRenderDevice::SetBlendState(BlendStateHandle blendState)
+{
+	if (!StateFilter.SetBlendState(blendState))
+	{
+		++CurrentStats.FilteredStateChangeCount;
+		return;
+	}
+
+	Record(COMMAND_TYPE_SET_BLEND_STATE, blendState.Id);
+	++CurrentStats.StateChangeCount;
+
+	if (blendState.Id > BlendStates.size())
+	{
+		StateFilter.Invalidate();
+		ReportError("SetBlendState: invalid blend state %u", blendState.Id);
+		return;
+	}
+
+	State.BlendState = blendState;
+}
+
+void NullRenderDevice::Clear(const float color[4], float depth)
+{
+	// The color is recorded bit for bit
+	uint32_t colorBits[4];
+	memcpy(colorBits, color, sizeof(colorBits));
+	Record(COMMAND_TYPE_CLEAR, colorBits[0], colorBits[1], colorBits[2], colorBits[3]);
+
+	if (depth < 0.0f || depth > 1.0f)
+	{
+		ReportError("Clear: depth %f is outside [0, 1]", depth);
+	}
+}
+
+void NullRenderDevice::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+	Record(COMMAND_TYPE_DRAW_INDEXED, indexCount, startIndexLocation, (uint32_t)baseVertexLocation);
+
+	SubmitDraw(indexCount, 1, startIndexLocation, baseVertexLocation, 0);
+}
+
+void NullRenderDevice::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	Record(COMMAND_TYPE_DRAW_INDEXED_INSTANCED, indexCountPerInstance, instanceCount, startIndexLocation, (uint32_t)baseVertexLocation, startInstanceLocation);
+
+	SubmitDraw(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+// Runs the recorded calls on cleared state, as a deferred context would, and puts the state of the immediate context back afterwards
+void NullRenderDevice::ExecuteCommandList(CommandList* commandList)
+{
+	const NullCommandList* nullCommandList = nullptr;
+	for (const std::unique_ptr<NullCommandList>& ownCommandList : CommandLists)
+	{
+		if (ownCommandList.get() == commandList)
+		{
+			nullCommandList = ownCommandList.get();
+			break;
+		}
+	}
+
+	Record(COMMAND_TYPE_EXECUTE_COMMAND_LIST, nullCommandList ? nullCommandList->GetCommandCount() : 0);
+	if (!nullCommandList)
+	{
+		ReportError("ExecuteCommandList: the command list was not created by this device");
+		return;
+	}
+	if (nullCommandList->IsRecording())
+	{
+		ReportError("ExecuteCommandList: the command list is still recording");
+		return;
+	}
+
+	const RenderStateFilter immediateFilter = StateFilter;
+	const PipelineState immediateState = State;
+	StateFilter.Reset();
+	State = PipelineState{};
+	for (const RecordedCommand& command : nullCommandList->GetCommands())
+	{
+		const uint32_t* arguments = command.Arguments;
+		switch (command.Type)
+		{
+		case COMMAND_TYPE_SET_INPUT_LAYOUT: SetInputLayout({ arguments[0] }); break;
+		case COMMAND_TYPE_SET_VERTEX_BUFFER: SetVertexBuffer(arguments[0], { arguments[1] }, arguments[2], arguments[3]); break;
+		case COMMAND_TYPE_SET_INDEX_BUFFER: SetIndexBuffer({ arguments[0] }, (INDEX_FORMAT)arguments[1], arguments[2]); break;
+		case COMMAND_TYPE_SET_VERTEX_SHADER: SetVertexShader({ arguments[0] }); break;
+		case COMMAND_TYPE_SET_PIXEL_SHADER: SetPixelShader({ arguments[0] }); break;
+		case COMMAND_TYPE_SET_VERTEX_CONSTANT_BUFFER:
+			if (arguments[2] || arguments[3])
+			{
+				SetVertexConstantBufferRange(arguments[0], { arguments[1] }, arguments[2], arguments[3]);
+			}
+			else
+			{
+				SetVertexConstantBuffer(arguments[0], { arguments[1] });
+			}
+			break;
+		case COMMAND_TYPE_SET_PIXEL_CONSTANT_BUFFER:
+			if (arguments[2] || arguments[3])
+			{
+				SetPixelConstantBufferRange(arguments[0], { arguments[1] }, arguments[2], arguments[3]);
+			}
+			else
+			{
+				SetPixelConstantBuffer(arguments[0], { arguments[1] });
+			}
+			break;
+		case COMMAND_TYPE_SET_RASTERIZER_STATE: SetRasterizerState({ arguments[0] }); break;
+		case COMMAND_TYPE_SET_DEPTH_STENCIL_STATE: SetDepthStencilState({ arguments[0] }); break;
+		case COMMAND_TYPE_SET_BLEND_STATE: SetBlendState({ arguments[0] }); break;
+		case COMMAND_TYPE_DRAW_INDEXED: DrawIndexed(arguments[0], arguments[1], (int32_t)arguments[2]); break;
+		case COMMAND_TYPE_DRAW_INDEXED_INSTANCED: DrawIndexedInstanced(arguments[0], arguments[1], arguments[2], (int32_t)arguments[3], arguments[4]); break;
+		default:
+			ReportError("ExecuteCommandList: command %u can not be recorded", (uint32_t)command.Type);
+			break;
+		}
+	}
+	StateFilter = immediateFilter;
+	State = immediateState;
+	CurrentStats.FilteredStateChangeCount += nullCommandList->GetFilteredStateChangeCount();
+}
+
+void NullRenderDevice::Present()
+{
+	Record(COMMAND_TYPE_PRESENT);
+
+	FrameStats = CurrentStats;
+	CurrentStats = RenderDeviceStats{};
+	Commands.clear();
+}
+
+bool NullRenderDevice::SubmitDraw(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	if (!ValidateDraw(indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation))
+	{
+		return false;
+	}
+
+	MarkConstantBuffersUsed(State.VertexConstantBuffers);
+	MarkConstantBuffersUsed(State.PixelConstantBuffers);
+
+	++CurrentStats.DrawCount;
+	CurrentStats.InstanceCount += instanceCount;
+	CurrentStats.IndexCount += (uint64_t)indexCount * instanceCount;
+
+	return true;
+}
+
+bool NullRenderDevice::ValidateDraw(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	if (!State.VertexShader.IsValid() || !State.PixelShader.IsValid())
+	{
+		ReportError("Draw: vertex or pixel shader is not bound");
+		return false;
+	}
+	if (!State.InputLayout.IsValid())
+	{
+		ReportError("Draw: input layout is not bound");
+		return false;
+	}
+
+	const Buffer* indexBuffer = FindBuffer(State.IndexBuffer);
+	if (!indexBuffer)
+	{
+		ReportError("Draw: index buffer is not bound");
+		return false;
+	}
+
+	const uint32_t indexSize = State.IndexFormat == INDEX_FORMAT_UINT16 ? 2 : 4;
+	const uint64_t indexEnd = State.IndexBufferOffset + ((uint64_t)startIndexLocation + indexCount) * indexSize;
+	if (indexEnd > indexBuffer->Desc.ByteWidth)
+	{
+		ReportError("Draw: indices [%u, %u) run past the index buffer", startIndexLocation, startIndexLocation + indexCount);
+		return false;
+	}
+
+	// Every per-vertex slot that the input layout reads must hold enough vertices for the largest index,
+	// and every per-instance slot enough elements for the last instance
+	uint64_t vertexCount = UINT64_MAX;
+	const InputLayout& inputLayout = InputLayouts[State.InputLayout.Id - 1];
+	for (size_t i = 0; i < inputLayout.Elements.size(); ++i)
+	{
+		const InputElementDesc& element = inputLayout.Elements[i];
+		const VertexBufferBinding& binding = State.VertexBuffers[element.InputSlot];
+		const Buffer* vertexBuffer = FindBuffer(binding.Buffer);
+		if (!vertexBuffer)
+		{
+			ReportError("Draw: %s needs a vertex buffer in slot %u", inputLayout.SemanticNames[i].c_str(), element.InputSlot);
+			return false;
+		}
+		if (element.AlignedByteOffset + GetFormatSize(element.Format) > binding.Stride)
+		{
+			ReportError("Draw: %s does not fit in stride %u", inputLayout.SemanticNames[i].c_str(), binding.Stride);
+			return false;
+		}
+
+		const uint64_t slotElementCount = binding.Offset < vertexBuffer->Desc.ByteWidth ? (vertexBuffer->Desc.ByteWidth - binding.Offset) / binding.Stride : 0;
+		if (element.InputSlotClass == INPUT_CLASSIFICATION_PER_INSTANCE)
+		{
+			const uint64_t lastInstance = startInstanceLocation + (element.InstanceDataStepRate && instanceCount ? (instanceCount - 1) / element.InstanceDataStepRate : 0);
+			if (lastInstance >= slotElementCount)
+			{
+				ReportError("Draw: %s reads instance %llu of the %llu in slot %u", inputLayout.SemanticNames[i].c_str(), (unsigned long long)lastInstance, (unsigned long long)slotElementCount, element.InputSlot);
+				return false;
+			}
+			continue;
+		}
+
+		vertexCount = slotElementCount < vertexCount ? slotElementCount : vertexCount;
+	}
+
+	const uint8_t* indexData = indexBuffer->Data.data() + State.IndexBufferOffset;
+	for (uint32_t i = startIndexLocation; i < startIndexLocation + indexCount; ++i)
+	{
+		const uint32_t index = State.IndexFormat == INDEX_FORMAT_UINT16 ? ((const uint16_t*)indexData)[i] : ((const uint32_t*)indexData)[i];
+		const int64_t vertexIndex = (int64_t)index + baseVertexLocation;
+		if (vertexIndex < 0 || (uint64_t)vertexIndex >= vertexCount)
+		{
+			ReportError("Draw: index %u + base vertex %d is outside the %llu bound vertices", index, baseVertexLocation, (unsigned long long)vertexCount);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool NullRenderDevice::ValidateConstantBufferRange(const char* functionName, uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	const Buffer* constantBuffer = FindBuffer(buffer);
+	if (slot >= MAX_CONSTANT_BUFFER_SLOTS || (buffer.IsValid() && (!constantBuffer || constantBuffer->Desc.Type != BUFFER_TYPE_CONSTANT)))
+	{
+		ReportError("%s: invalid constant buffer %u in slot %u", functionName, buffer.Id, slot);
+		return false;
+	}
+	if (!constantBuffer || (offset == 0 && size == 0))
+	{
+		return true;
+	}
+
+	if (offset % CONSTANT_BUFFER_ALIGNMENT != 0 || size % CONSTANT_BUFFER_ALIGNMENT != 0 || size == 0 || size > MAX_CONSTANT_BUFFER_RANGE_SIZE)
+	{
+		ReportError("%s: range [%u, %u) is not aligned to %u bytes", functionName, offset, offset + size, CONSTANT_BUFFER_ALIGNMENT);
+		return false;
+	}
+	if ((uint64_t)offset + size > constantBuffer->Desc.ByteWidth)
+	{
+		ReportError("%s: range [%u, %u) runs past constant buffer %u of %u bytes", functionName, offset, offset + size, buffer.Id, constantBuffer->Desc.ByteWidth);
+		return false;
+	}
+
+	return true;
+}
+
+void NullRenderDevice::MarkConstantBuffersUsed(const ConstantBufferBinding* bindings)
+{
+	for (uint32_t slot = 0; slot < MAX_CONSTANT_BUFFER_SLOTS; ++slot)
+	{
+		const ConstantBufferBinding& binding = bindings[slot];
+		if (!binding.Buffer.IsValid())
+		{
+			continue;
+		}
+
+		Buffer& buffer = Buffers[binding.Buffer.Id - 1];
+		if (buffer.Desc.Usage != BUFFER_USAGE_DYNAMIC)
+		{
+			continue;
+		}
+
+		const uint32_t end = binding.Size ? binding.Offset + binding.Size : buffer.Desc.ByteWidth;
+		if (buffer.UsedBegin == buffer.UsedEnd)
+		{
+			buffer.UsedBegin = binding.Offset;
+			buffer.UsedEnd = end;
+		}
+		else
+		{
+			buffer.UsedBegin = binding.Offset < buffer.UsedBegin ? binding.Offset : buffer.UsedBegin;
+			buffer.UsedEnd = end > buffer.UsedEnd ? end : buffer.UsedEnd;
+		}
+	}
+}
+
+void NullRenderDevice::Record(COMMAND_TYPE type, uint32_t argument0, uint32_t argument1, uint32_t argument2, uint32_t argument3, uint32_t argument4)
+{
+	if (bRecordCommands)
+	{
+		Commands.push_back({ type, { argument0, argument1, argument2, argument3, argument4 } });
+	}
+}
+
+void NullRenderDevice::ReportError(const char* format, ...)
+{
+	++ValidationErrorCount;
+	if (ValidationMessages.size() >= MAX_VALIDATION_MESSAGES)
+	{
+		return;
+	}
+
+	char message[512];
+	va_list arguments;
+	va_start(arguments, format);
+	vsnprintf(message, sizeof(message), format, arguments);
+	va_end(arguments);
+
+	ValidationMessages.push_back(message);
+}
+
+const NullRenderDevice::Buffer* NullRenderDevice::FindBuffer(BufferHandle buffer) const
+{
+	if (!buffer.IsValid() || buffer.Id > Buffers.size())
+	{
+		return nullptr;
+	}
+
+	return &Buffers[buffer.Id - 1];
+}
+
+void NullCommandList::Begin()
+{
+	Commands.clear();
+	StateFilter.Reset();
+	FilteredStateChangeCount = 0;
+	bRecording = true;
+}
+
+void NullCommandList::SetInputLayout(InputLayoutHandle inputLayout)
+{
+	if (!StateFilter.SetInputLayout(inputLayout))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_INPUT_LAYOUT, { inputLayout.Id } });
+}
+
+void NullCommandList::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+	if (!StateFilter.SetVertexBuffer(slot, buffer, stride, offset))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_VERTEX_BUFFER, { slot, buffer.Id, stride, offset } });
+}
+
+void NullCommandList::SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset)
+{
+	if (!StateFilter.SetIndexBuffer(buffer, format, offset))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_INDEX_BUFFER, { buffer.Id, format, offset } });
+}
+
+void NullCommandList::SetVertexShader(VertexShaderHandle vertexShader)
+{
+	if (!StateFilter.SetVertexShader(vertexShader))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_VERTEX_SHADER, { vertexShader.Id } });
+}
+
+void NullCommandList::SetPixelShader(PixelShaderHandle pixelShader)
+{
+	if (!StateFilter.SetPixelShader(pixelShader))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_PIXEL_SHADER, { pixelShader.Id } });
+}
+
+// The whole buffer is bound as the range [0, 0), the same as the device records it
+void NullCommandList::SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, 0, 0))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_VERTEX_CONSTANT_BUFFER, { slot, buffer.Id } });
+}
+
+void NullCommandList::SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, 0, 0))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_PIXEL_CONSTANT_BUFFER, { slot, buffer.Id } });
+}
+
+void NullCommandList::SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetVertexConstantBuffer(slot, buffer, offset, size))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_VERTEX_CONSTANT_BUFFER, { slot, buffer.Id, offset, size } });
+}
+
+void NullCommandList::SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	if (!StateFilter.SetPixelConstantBuffer(slot, buffer, offset, size))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_PIXEL_CONSTANT_BUFFER, { slot, buffer.Id, offset, size } });
+}
+
+void NullCommandList::SetRasterizerState(RasterizerStateHandle rasterizerState)
+{
+	if (!StateFilter.SetRasterizerState(rasterizerState))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_RASTERIZER_STATE, { rasterizerState.Id } });
+}
+
+void NullCommandList::SetDepthStencilState(DepthStencilStateHandle depthStencilState)
+{
+	if (!StateFilter.SetDepthStencilState(depthStencilState))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_DEPTH_STENCIL_STATE, { depthStencilState.Id } });
+}
+
+void NullCommandList::SetBlendState(BlendStateHandle blendState)
+{
+	if (!StateFilter.SetBlendState(blendState))
+	{
+		++FilteredStateChangeCount;
+		return;
+	}
+
+	Commands.push_back({ COMMAND_TYPE_SET_BLEND_STATE, { blendState.Id } });
+}
+
+void NullCommandList::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+	Commands.push_back({ COMMAND_TYPE_DRAW_INDEXED, { indexCount, startIndexLocation, (uint32_t)baseVertexLocation } });
+}
+
+void NullCommandList::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	Commands.push_back({ COMMAND_TYPE_DRAW_INDEXED_INSTANCED, { indexCountPerInstance, instanceCount, startIndexLocation, (uint32_t)baseVertexLocation, startInstanceLocation } });
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "RenderStateCache.h"
+#include "RenderStateFilter.h"
+
+enum COMMAND_TYPE : uint32_t
+{
+	COMMAND_TYPE_UPDATE_BUFFER,
+	COMMAND_TYPE_WRITE_BUFFER,
+	COMMAND_TYPE_SET_INPUT_LAYOUT,
+	COMMAND_TYPE_SET_VERTEX_BUFFER,
+	COMMAND_TYPE_SET_INDEX_BUFFER,
+	COMMAND_TYPE_SET_VERTEX_SHADER,
+	COMMAND_TYPE_SET_PIXEL_SHADER,
+	COMMAND_TYPE_SET_VERTEX_CONSTANT_BUFFER,
+	COMMAND_TYPE_SET_PIXEL_CONSTANT_BUFFER,
+	COMMAND_TYPE_SET_RASTERIZER_STATE,
+	COMMAND_TYPE_SET_DEPTH_STENCIL_STATE,
+	COMMAND_TYPE_SET_BLEND_STATE,
+	COMMAND_TYPE_CLEAR,
+	COMMAND_TYPE_DRAW_INDEXED,
+	COMMAND_TYPE_DRAW_INDEXED_INSTANCED,
+	COMMAND_TYPE_EXECUTE_COMMAND_LIST,
+	COMMAND_TYPE_PRESENT
+};
+
+struct RecordedCommand
+{
+	COMMAND_TYPE Type;
+	uint32_t Arguments[5];
+};
+
+// Command list of NullRenderDevice. Recording only stores the calls with their arguments that get past the state filter
+// of the list, which ExecuteCommandList validates and runs through the device one after another.
+class NullCommandList : public CommandList
+{
+public:
+	void Begin() override;
+	void End() override { bRecording = false; }
+	uint32_t GetCommandCount() const override { return (uint32_t)Commands.size(); }
+	uint32_t GetFilteredStateChangeCount() const override { return FilteredStateChangeCount; }
+
+	void SetInputLayout(InputLayoutHandle inputLayout) override;
+	void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+	void SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset) override;
+	void SetVertexShader(VertexShaderHandle vertexShader) override;
+	void SetPixelShader(PixelShaderHandle pixelShader) override;
+	void SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetRasterizerState(RasterizerStateHandle rasterizerState) override;
+	void SetDepthStencilState(DepthStencilStateHandle depthStencilState) override;
+	void SetBlendState(BlendStateHandle blendState) override;
+
+	void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+	void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+
+	bool IsRecording() const { return bRecording; }
+	const std::vector<RecordedCommand>& GetCommands() const { return Commands; }
+
+private:
+	std::vector<RecordedCommand> Commands;
+	RenderStateFilter StateFilter;
+	uint32_t FilteredStateChangeCount = 0;
+	bool bRecording = false;
+};
+
+// Device without a GPU. Keeps CPU copies of every resource, validates each call against
+// the rules the D3D11 debug layer would enforce and optionally records the command stream.
+class NullRenderDevice : public RenderDevice
+{
+public:
+	static constexpr uint32_t MAX_VERTEX_BUFFER_SLOTS = 16;
+	static constexpr uint32_t MAX_CONSTANT_BUFFER_SLOTS = 14;
+
+	bool Init(bool bRecordCommands);
+
+	const char* GetName() const override { return "Null"; }
+	void Free() override;
+
+	BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData) override;
+	VertexShaderHandle CreateVertexShader(const ShaderDesc& desc) override;
+	PixelShaderHandle CreatePixelShader(const ShaderDesc& desc) override;
+	InputLayoutHandle CreateInputLayout(const InputElementDesc* elements, uint32_t elementCount, VertexShaderHandle vertexShader) override;
+	RasterizerStateHandle CreateRasterizerState(const RasterizerDesc& desc) override;
+	DepthStencilStateHandle CreateDepthStencilState(const DepthStencilDesc& desc) override;
+	BlendStateHandle CreateBlendState(const BlendDesc& desc) override;
+	CommandList* CreateCommandList() override;
+
+	void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) override;
+	void WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size, MAP_TYPE mapType) override;
+	void SetInputLayout(InputLayoutHandle inputLayout) override;
+	void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) override;
+	void SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset) override;
+	void SetVertexShader(VertexShaderHandle vertexShader) override;
+	void SetPixelShader(PixelShaderHandle pixelShader) override;
+	void SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer) override;
+	void SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) override;
+	void SetRasterizerState(RasterizerStateHandle rasterizerState) override;
+	void SetDepthStencilState(DepthStencilStateHandle depthStencilState) override;
+	void SetBlendState(BlendStateHandle blendState) override;
+
+	void Clear(const float color[4], float depth) override;
+	void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+	void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+	void ExecuteCommandList(CommandList* commandList) override;
+	void Present() override;
+
+	const RenderDeviceStats& GetFrameStats() const override { return FrameStats; }
+	const StateCacheStats& GetStateCacheStats() const override { return StateCache.GetStats(); }
+
+	// Commands since the last Present, empty unless recording is enabled
+	const std::vector<RecordedCommand>& GetCommands() const { return Commands; }
+
+	uint32_t GetValidationErrorCount() const { return ValidationErrorCount; }
+	const std::vector<std::string>& GetValidationMessages() const { return ValidationMessages; }
+
+protected:
+	struct Buffer
+	{
+		BufferDesc Desc;
+		std::vector<uint8_t> Data;
+
+		// Bytes read by draws since the last discard, which a NO_OVERWRITE write must not touch
+		uint32_t UsedBegin = 0;
+		uint32_t UsedEnd = 0;
+	};
+
+	struct Shader
+	{
+		std::string FileName;
+		std::string EntryPoint;
+		std::string ShaderModel;
+	};
+
+	struct InputLayout
+	{
+		std::vector<InputElementDesc> Elements;
+		std::vector<std::string> SemanticNames;
+	};
+
+	struct VertexBufferBinding
+	{
+		BufferHandle Buffer;
+		uint32_t Stride;
+		uint32_t Offset;
+	};
+
+	// Size 0 binds the whole buffer
+	struct ConstantBufferBinding
+	{
+		BufferHandle Buffer;
+		uint32_t Offset;
+		uint32_t Size;
+	};
+
+	struct PipelineState
+	{
+		InputLayoutHandle InputLayout;
+		VertexBufferBinding VertexBuffers[MAX_VERTEX_BUFFER_SLOTS];
+		BufferHandle IndexBuffer;
+		INDEX_FORMAT IndexFormat;
+		uint32_t IndexBufferOffset;
+		VertexShaderHandle VertexShader;
+		PixelShaderHandle PixelShader;
+		ConstantBufferBinding VertexConstantBuffers[MAX_CONSTANT_BUFFER_SLOTS];
+		ConstantBufferBinding PixelConstantBuffers[MAX_CONSTANT_BUFFER_SLOTS];
+		RasterizerStateHandle RasterizerState;
+		DepthStencilStateHandle DepthStencilState;
+		BlendStateHandle BlendState;
+	};
+
+	// Validates the draw and counts it. Returns false and reports an error when the draw would be invalid.
+	bool SubmitDraw(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation);
+	bool ValidateDraw(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation);
+	bool ValidateConstantBufferRange(const char* functionName, uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size);
+	void MarkConstantBuffersUsed(const ConstantBufferBinding* bindings);
+
+	void Record(COMMAND_TYPE type, uint32_t argument0 = 0, uint32_t argument1 = 0, uint32_t argument2 = 0, uint32_t argument3 = 0, uint32_t argument4 = 0);
+	void ReportError(const char* format, ...);
+
+	const Buffer* FindBuffer(BufferHandle buffer) const;
+
+	std::vector<Buffer> Buffers;
+	std::vector<Shader> VertexShaders;
+	std::vector<Shader> PixelShaders;
+	std::vector<InputLayout> InputLayouts;
+	std::vector<RasterizerDesc> RasterizerStates;
+	std::vector<DepthStencilDesc> DepthStencilStates;
+	std::vector<BlendDesc> BlendStates;
+	RenderStateCache StateCache;
+	std::vector<std::unique_ptr<NullCommandList>> CommandLists;
+
+	// Filtered calls are neither validated nor recorded
+	RenderStateFilter StateFilter;
+	PipelineState State{};
+
+	bool bRecordCommands = false;
+	std::vector<RecordedCommand> Commands;
+
+	RenderDeviceStats CurrentStats{};
+	RenderDeviceStats FrameStats{};
+
+	uint32_t ValidationErrorCount = 0;
+	std::vector<std::string> ValidationMessages;
+};
@@ -0,0 +1,202 @@
+#include "ObjectTransforms.h"
+
+#include "Simd.h"
+
+void TransformArrays::Resize(uint32_t count)
+{
+	PositionX.resize(count, 0.0f);
+	PositionY.resize(count, 0.0f);
+	PositionZ.resize(count, 0.0f);
+	RotationX.resize(count, 0.0f);
+	RotationY.resize(count, 0.0f);
+	RotationZ.resize(count, 0.0f);
+	RotationW.resize(count, 1.0f);
+	ScaleX.resize(count, 1.0f);
+	ScaleY.resize(count, 1.0f);
+	ScaleZ.resize(count, 1.0f);
+}
+
+void GatherTransforms(const TransformArrays& transforms, const uint32_t* indices, uint32_t count, TransformArrays& outTransforms)
+{
+	outTransforms.Resize(count);
+	GatherTransforms(transforms, indices, 0, count, outTransforms);
+}
+
+void GatherTransforms(const TransformArrays& transforms, const uint32_t* indices, uint32_t begin, uint32_t end, TransformArrays& outTransforms)
+{
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		const uint32_t index = indices[i];
+		outTransforms.PositionX[i] = transforms.PositionX[index];
+		outTransforms.PositionY[i] = transforms.PositionY[index];
+		outTransforms.PositionZ[i] = transforms.PositionZ[index];
+		outTransforms.RotationX[i] = transforms.RotationX[index];
+		outTransforms.RotationY[i] = transforms.RotationY[index];
+		outTransforms.RotationZ[i] = transforms.RotationZ[index];
+		outTransforms.RotationW[i] = transforms.RotationW[index];
+		outTransforms.ScaleX[i] = transforms.ScaleX[index];
+		outTransforms.ScaleY[i] = transforms.ScaleY[index];
+		outTransforms.ScaleZ[i] = transforms.ScaleZ[index];
+	}
+}
+
+// World = S * R * T with row vectors. The rows of R come from the quaternion as in XMMatrixRotationQuaternion,
+// World rows are R rows times the scale and the normal matrix rows are R rows divided by it.
+// WorldViewProjection = World * ViewProjection is stored by columns, as are World and Normal.
+void ComputeObjectMatrices(const TransformArrays& transforms, uint32_t begin, uint32_t end, const Float4x4& viewProjectionMatrix,
+	void* output, size_t outputStride)
+{
+	const Float4x4& vp = viewProjectionMatrix;
+	const SimdFloat one = SimdSet(1.0f);
+	const SimdFloat two = SimdSet(2.0f);
+	const SimdFloat zero = SimdZero();
+
+	uint8_t* outputBytes = (uint8_t*)output;
+	uint32_t i = begin;
+	for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH, outputBytes += SIMD_WIDTH * outputStride)
+	{
+		const SimdFloat x = SimdLoad(&transforms.RotationX[i]);
+		const SimdFloat y = SimdLoad(&transforms.RotationY[i]);
+		const SimdFloat z = SimdLoad(&transforms.RotationZ[i]);
+		const SimdFloat w = SimdLoad(&transforms.RotationW[i]);
+
+		const SimdFloat x2 = x * two;
+		const SimdFloat y2 = y * two;
+		const SimdFloat z2 = z * two;
+		const SimdFloat xx = x * x2;
+		const SimdFloat yy = y * y2;
+		const SimdFloat zz = z * z2;
+		const SimdFloat xy = x * y2;
+		const SimdFloat xz = x * z2;
+		const SimdFloat yz = y * z2;
+		const SimdFloat xw = w * x2;
+		const SimdFloat yw = w * y2;
+		const SimdFloat zw = w * z2;
+
+		const SimdFloat rotation[3][3]
+		{
+			{ one - yy - zz, xy + zw, xz - yw },
+			{ xy - zw, one - xx - zz, yz + xw },
+			{ xz + yw, yz - xw, one - xx - yy }
+		};
+
+		const SimdFloat scale[3]{ SimdLoad(&transforms.ScaleX[i]), SimdLoad(&transforms.ScaleY[i]), SimdLoad(&transforms.ScaleZ[i]) };
+		const SimdFloat translation[3]{ SimdLoad(&transforms.PositionX[i]), SimdLoad(&transforms.PositionY[i]), SimdLoad(&transforms.PositionZ[i]) };
+
+		SimdFloat world[3][3];
+		SimdFloat normal[3][3];
+		for (int32_t row = 0; row < 3; ++row)
+		{
+			const SimdFloat inverseScale = one / scale[row];
+			for (int32_t column = 0; column < 3; ++column)
+			{
+				world[row][column] = rotation[row][column] * scale[row];
+				normal[row][column] = rotation[row][column] * inverseScale;
+			}
+		}
+
+		// Every column of WorldViewProjection holds the four rows of the lanes' matrices
+		for (int32_t column = 0; column < 4; ++column)
+		{
+			const SimdFloat vp0 = SimdSet(vp.m[0][column]);
+			const SimdFloat vp1 = SimdSet(vp.m[1][column]);
+			const SimdFloat vp2 = SimdSet(vp.m[2][column]);
+			const SimdFloat vp3 = SimdSet(vp.m[3][column]);
+
+			SimdFloat rows[4];
+			for (int32_t row = 0; row < 3; ++row)
+			{
+				rows[row] = world[row][0] * vp0 + world[row][1] * vp1 + world[row][2] * vp2;
+			}
+			rows[3] = translation[0] * vp0 + translation[1] * vp1 + translation[2] * vp2 + vp3;
+
+			SimdStoreTransposed4((float*)(outputBytes + offsetof(ObjectMatrices, WorldViewProjection) + column * sizeof(Float4)), outputStride, rows[0], rows[1], rows[2], rows[3]);
+		}
+
+		for (int32_t column = 0; column < 3; ++column)
+		{
+			SimdStoreTransposed4((float*)(outputBytes + offsetof(ObjectMatrices, World) + column * sizeof(Float4)), outputStride,
+				world[0][column], world[1][column], world[2][column], translation[column]);
+			SimdStoreTransposed4((float*)(outputBytes + offsetof(ObjectMatrices, Normal) + column * sizeof(Float4)), outputStride,
+				normal[0][column], normal[1][column], normal[2][column], zero);
+		}
+	}
+
+	ComputeObjectMatricesScalar(transforms, i, end, viewProjectionMatrix, outputBytes, outputStride);
+}
+
+void ComputeObjectMatricesScalar(const TransformArrays& transforms, uint32_t begin, uint32_t end, const Float4x4& viewProjectionMatrix,
+	void* output, size_t outputStride)
+{
+	uint8_t* outputBytes = (uint8_t*)output;
+	for (uint32_t i = begin; i < end; ++i, outputBytes += outputStride)
+	{
+		const float x = transforms.RotationX[i];
+		const float y = transforms.RotationY[i];
+		const float z = transforms.RotationZ[i];
+		const float w = transforms.RotationW[i];
+
+		const float x2 = x * 2.0f;
+		const float y2 = y * 2.0f;
+		const float z2 = z * 2.0f;
+		const float xx = x * x2;
+		const float yy = y * y2;
+		const float zz = z * z2;
+		const float xy = x * y2;
+		const float xz = x * z2;
+		const float yz = y * z2;
+		const float xw = w * x2;
+		const float yw = w * y2;
+		const float zw = w * z2;
+
+		const float rotation[3][3]
+		{
+			{ 1.0f - yy - zz, xy + zw, xz - yw },
+			{ xy - zw, 1.0f - xx - zz, yz + xw },
+			{ xz + yw, yz - xw, 1.0f - xx - yy }
+		};
+
+		const float scale[3]{ transforms.ScaleX[i], transforms.ScaleY[i], transforms.ScaleZ[i] };
+
+		Float4x4 world;
+		Float4x4 normal;
+		for (int32_t row = 0; row < 3; ++row)
+		{
+			const float inverseScale = 1.0f / scale[row];
+			for (int32_t column = 0; column < 3; ++column)
+			{
+				world.m[row][column] = rotation[row][column] * scale[row];
+				normal.m[row][column] = rotation[row][column] * inverseScale;
+			}
+			world.m[row][3] = 0.0f;
+			normal.m[row][3] = 0.0f;
+		}
+		world.m[3][0] = transforms.PositionX[i];
+		world.m[3][1] = transforms.PositionY[i];
+		world.m[3][2] = transforms.PositionZ[i];
+		world.m[3][3] = 1.0f;
+
+		// Same operation order as the SIMD path
+		Float4x4 worldViewProjection;
+		for (int32_t column = 0; column < 4; ++column)
+		{
+			const float* vp = &viewProjectionMatrix.m[0][column];
+			for (int32_t row = 0; row < 3; ++row)
+			{
+				worldViewProjection.m[row][column] = world.m[row][0] * vp[0] + world.m[row][1] * vp[4] + world.m[row][2] * vp[8];
+			}
+			worldViewProjection.m[3][column] = world.m[3][0] * vp[0] + world.m[3][1] * vp[4] + world.m[3][2] * vp[8] + vp[12];
+		}
+
+		ObjectMatrices& matrices = *(ObjectMatrices*)outputBytes;
+		for (int32_t column = 0; column < 4; ++column)
+		{
+			matrices.WorldViewProjection[column] = { worldViewProjection.m[0][column], worldViewProjection.m[1][column], worldViewProjection.m[2][column], worldViewProjection.m[3][column] };
+		}
+		for (int32_t column = 0; column < 3; ++column)
+		{
+			matrices.World[column] = { world.m[0][column], world.m[1][column], world.m[2][column], world.m[3][column] };
+			matrices.Normal[column] = { normal.m[0][column], normal.m[1][column], normal.m[2][column], 0.0f };
+		}
+	}
+}
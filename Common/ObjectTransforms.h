@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "MathTypes.h"
+#include "VertexTypes.h"
+
+// Object transforms as a structure of arrays. Each object is scaled, rotated by a unit quaternion and then translated.
+struct TransformArrays
+{
+	std::vector<float> PositionX;
+	std::vector<float> PositionY;
+	std::vector<float> PositionZ;
+	std::vector<float> RotationX;
+	std::vector<float> RotationY;
+	std::vector<float> RotationZ;
+	std::vector<float> RotationW;
+	std::vector<float> ScaleX;
+	std::vector<float> ScaleY;
+	std::vector<float> ScaleZ;
+
+	// New objects sit at the origin without rotation or scale
+	void Resize(uint32_t count);
+	uint32_t GetCount() const { return (uint32_t)PositionX.size(); }
+};
+
+// Copies the transforms of objects indices[0..count) to the first count objects of outTransforms
+void GatherTransforms(const TransformArrays& transforms, const uint32_t* indices, uint32_t count, TransformArrays& outTransforms);
+
+// Copies the transforms of objects indices[begin..end) to objects [begin, end) of outTransforms, which already holds at least end
+// objects, so that ranges can be gathered side by side
+void GatherTransforms(const TransformArrays& transforms, const uint32_t* indices, uint32_t begin, uint32_t end, TransformArrays& outTransforms);
+
+// Writes the ObjectMatrices of objects [begin, end) to output + (i - begin) * outputStride bytes, so they can be
+// written straight into instance data or constant buffer ranges. SIMD_WIDTH objects are composed per iteration.
+void ComputeObjectMatrices(const TransformArrays& transforms, uint32_t begin, uint32_t end, const Float4x4& viewProjectionMatrix,
+	void* output, size_t outputStride);
+
+// One object at a time, used for the remainder and as the reference of the SIMD path
+void ComputeObjectMatricesScalar(const TransformArrays& transforms, uint32_t begin, uint32_t end, const Float4x4& viewProjectionMatrix,
+	void* output, size_t outputStride);
@@ -0,0 +1,523 @@
+#include "OcclusionCulling.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#include "Clock.h"
+#include "JobSystem.h"
+#include "Simd.h"
+
+namespace
+{
+	constexpr uint32_t FULL_SUBTILE_MASK = 0xFFFFFFFFu;
+	static_assert(OcclusionCuller::SUBTILE_WIDTH * OcclusionCuller::SUBTILE_HEIGHT == 32, "Subtile coverage must fit in a uint32_t mask");
+	static_assert(OcclusionCuller::SUBTILE_WIDTH % SIMD_WIDTH == 0, "Subtile rows must be whole SIMD registers");
+	static_assert(OcclusionCuller::TILE_WIDTH % OcclusionCuller::SUBTILE_WIDTH == 0 && OcclusionCuller::TILE_HEIGHT % OcclusionCuller::SUBTILE_HEIGHT == 0,
+		"Tiles must be whole subtiles");
+
+	// Outside the view frustum, used for trivial rejection
+	uint32_t ComputeFrustumFlags(const Float4& position)
+	{
+		uint32_t flags = 0;
+		flags |= position.x < -position.w ? 1 << 0 : 0;
+		flags |= position.x > position.w ? 1 << 1 : 0;
+		flags |= position.y < -position.w ? 1 << 2 : 0;
+		flags |= position.y > position.w ? 1 << 3 : 0;
+		flags |= position.z > position.w ? 1 << 4 : 0;
+		return flags;
+	}
+}
+
+bool OcclusionCuller::Init(int32_t width, int32_t height, uint32_t threadCount)
+{
+	Jobs = nullptr;
+	return InitBuffers(width, height) && Workers.Init(threadCount);
+}
+
+bool OcclusionCuller::Init(int32_t width, int32_t height, JobSystem& jobSystem)
+{
+	Workers.Free();
+	Jobs = &jobSystem;
+	return InitBuffers(width, height);
+}
+
+uint32_t OcclusionCuller::GetThreadCount() const
+{
+	return Jobs ? Jobs->GetThreadCount() : Workers.GetThreadCount();
+}
+
+bool OcclusionCuller::InitBuffers(int32_t width, int32_t height)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	SubtileCountX = (width + SUBTILE_WIDTH - 1) / SUBTILE_WIDTH;
+	SubtileCountY = (height + SUBTILE_HEIGHT - 1) / SUBTILE_HEIGHT;
+	Width = SubtileCountX * SUBTILE_WIDTH;
+	Height = SubtileCountY * SUBTILE_HEIGHT;
+	TileCountX = (Width + TILE_WIDTH - 1) / TILE_WIDTH;
+	TileCountY = (Height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+
+	const size_t subtileCount = (size_t)SubtileCountX * SubtileCountY;
+	SubtileZMax0.assign(subtileCount, 1.0f);
+	SubtileZMax1.assign(subtileCount, 0.0f);
+	SubtileMask.assign(subtileCount, 0);
+	TileZMax.assign((size_t)TileCountX * TileCountY, 1.0f);
+	TileBins.resize((size_t)TileCountX * TileCountY);
+
+	Stats = OcclusionStats{};
+
+	return true;
+}
+
+void OcclusionCuller::Free()
+{
+	Workers.Free();
+	Jobs = nullptr;
+
+	SubtileZMax0.clear();
+	SubtileZMax1.clear();
+	SubtileMask.clear();
+	TileZMax.clear();
+	ClipPositions.clear();
+	Triangles.clear();
+	TileBins.clear();
+}
+
+void OcclusionCuller::BeginFrame(const Float4x4& viewProjectionMatrix)
+{
+	ViewProjectionMatrix = viewProjectionMatrix;
+
+	std::fill(SubtileZMax0.begin(), SubtileZMax0.end(), 1.0f);
+	std::fill(SubtileZMax1.begin(), SubtileZMax1.end(), 0.0f);
+	std::fill(SubtileMask.begin(), SubtileMask.end(), 0);
+	std::fill(TileZMax.begin(), TileZMax.end(), 1.0f);
+
+	Triangles.clear();
+	for (std::vector<uint32_t>& bin : TileBins)
+	{
+		bin.clear();
+	}
+
+	Stats = OcclusionStats{};
+}
+
+void OcclusionCuller::AddOccluder(const Float3* positions, uint32_t vertexCount, const uint16_t* indices, uint32_t indexCount, const Float4 worldViewProjection[4])
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+
+	ClipPositions.resize(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		const Float4 position = ToFloat4(positions[i], 1.0f);
+		ClipPositions[i] = { Dot(position, worldViewProjection[0]), Dot(position, worldViewProjection[1]), Dot(position, worldViewProjection[2]), Dot(position, worldViewProjection[3]) };
+	}
+
+	const uint32_t firstTriangle = (uint32_t)Triangles.size();
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const Float4& v0 = ClipPositions[indices[i + 0]];
+		const Float4& v1 = ClipPositions[indices[i + 1]];
+		const Float4& v2 = ClipPositions[indices[i + 2]];
+
+		// Not clipped, so anything in front of the near plane is left out
+		if (v0.z < 0.0f || v1.z < 0.0f || v2.z < 0.0f)
+		{
+			continue;
+		}
+		if (ComputeFrustumFlags(v0) & ComputeFrustumFlags(v1) & ComputeFrustumFlags(v2))
+		{
+			continue;
+		}
+
+		SetupTriangle(v0, v1, v2);
+	}
+
+	++Stats.OccluderCount;
+	Stats.OccluderTriangleCount += (uint32_t)Triangles.size() - firstTriangle;
+	Stats.SetupTime += Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+}
+
+void OcclusionCuller::SetupTriangle(const Float4& v0, const Float4& v1, const Float4& v2)
+{
+	const Float4* vertices[3]{ &v0, &v1, &v2 };
+
+	float screenX[3], screenY[3], depth[3];
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		const Float4& vertex = *vertices[i];
+		const float invW = 1.0f / vertex.w;
+		screenX[i] = (vertex.x * invW * 0.5f + 0.5f) * Width;
+		screenY[i] = (0.5f - vertex.y * invW * 0.5f) * Height;
+		depth[i] = vertex.z * invW;
+	}
+
+	OccluderTriangle triangle;
+
+	// Edge i is opposite to vertex i, as in SoftwareRasterizer
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		const int32_t a = (i + 1) % 3;
+		const int32_t b = (i + 2) % 3;
+		triangle.EdgeA[i] = screenY[a] - screenY[b];
+		triangle.EdgeB[i] = screenX[b] - screenX[a];
+		triangle.EdgeC[i] = screenX[a] * screenY[b] - screenY[a] * screenX[b];
+	}
+
+	float area = triangle.EdgeA[0] * screenX[0] + triangle.EdgeB[0] * screenY[0] + triangle.EdgeC[0];
+	if (area == 0.0f)
+	{
+		return;
+	}
+
+	// Both windings occlude
+	if (area < 0.0f)
+	{
+		area = -area;
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			triangle.EdgeA[i] = -triangle.EdgeA[i];
+			triangle.EdgeB[i] = -triangle.EdgeB[i];
+			triangle.EdgeC[i] = -triangle.EdgeC[i];
+		}
+	}
+
+	const float invArea = 1.0f / area;
+	triangle.DepthDx = (depth[0] * triangle.EdgeA[0] + depth[1] * triangle.EdgeA[1] + depth[2] * triangle.EdgeA[2]) * invArea;
+	triangle.DepthDy = (depth[0] * triangle.EdgeB[0] + depth[1] * triangle.EdgeB[1] + depth[2] * triangle.EdgeB[2]) * invArea;
+	triangle.DepthC = (depth[0] * triangle.EdgeC[0] + depth[1] * triangle.EdgeC[1] + depth[2] * triangle.EdgeC[2]) * invArea;
+	triangle.MinDepth = std::min({ depth[0], depth[1], depth[2] });
+	triangle.MaxDepth = std::max({ depth[0], depth[1], depth[2] });
+
+	// With y down and the inside on the positive side, a left edge faces +x and a top edge is flat and faces +y.
+	// The edge functions of a shared edge are exact negatives of each other, so only one of its triangles takes a center on it.
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		triangle.bTopLeft[i] = triangle.EdgeA[i] > 0.0f || (triangle.EdgeA[i] == 0.0f && triangle.EdgeB[i] > 0.0f);
+	}
+
+	const float minScreenX = std::min({ screenX[0], screenX[1], screenX[2] });
+	const float maxScreenX = std::max({ screenX[0], screenX[1], screenX[2] });
+	const float minScreenY = std::min({ screenY[0], screenY[1], screenY[2] });
+	const float maxScreenY = std::max({ screenY[0], screenY[1], screenY[2] });
+	// Pixels whose centers are inside the bounds
+	triangle.MinX = std::max((int32_t)ceilf(minScreenX - 0.5f), 0);
+	triangle.MaxX = std::min((int32_t)floorf(maxScreenX - 0.5f), Width - 1);
+	triangle.MinY = std::max((int32_t)ceilf(minScreenY - 0.5f), 0);
+	triangle.MaxY = std::min((int32_t)floorf(maxScreenY - 0.5f), Height - 1);
+	if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+	{
+		return;
+	}
+
+	const uint32_t triangleIndex = (uint32_t)Triangles.size();
+	Triangles.push_back(triangle);
+
+	for (int32_t tileY = triangle.MinY / TILE_HEIGHT; tileY <= triangle.MaxY / TILE_HEIGHT; ++tileY)
+	{
+		for (int32_t tileX = triangle.MinX / TILE_WIDTH; tileX <= triangle.MaxX / TILE_WIDTH; ++tileX)
+		{
+			TileBins[tileY * TileCountX + tileX].push_back(triangleIndex);
+		}
+	}
+}
+
+void OcclusionCuller::RasterizeOccluders()
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+
+	// Tiles share no subtiles, so every task owns its part of the buffer
+	const uint32_t tileCount = (uint32_t)(TileCountX * TileCountY);
+	if (Jobs)
+	{
+		Jobs->ParallelFor(tileCount, 1, [this](uint32_t begin, uint32_t end, uint32_t)
+			{
+				for (uint32_t tileIndex = begin; tileIndex < end; ++tileIndex)
+				{
+					RasterizeTile(tileIndex);
+				}
+			});
+	}
+	else
+	{
+		Workers.ParallelFor(tileCount, [&](uint32_t tileIndex, uint32_t)
+			{
+				RasterizeTile(tileIndex);
+			});
+	}
+
+	Stats.RasterTime += Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+}
+
+void OcclusionCuller::RasterizeClosestOccluders(const OccluderMesh& mesh, const TransformArrays& transforms, const uint32_t* indices, uint32_t count,
+	const Float3& cameraPosition, uint32_t budget)
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+
+	// Squared distance in the high bits, non-negative floats sort like their bit patterns
+	OccluderKeys.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t index = indices[i];
+		const Float3 offset{ transforms.PositionX[index] - cameraPosition.x, transforms.PositionY[index] - cameraPosition.y, transforms.PositionZ[index] - cameraPosition.z };
+		const float distanceSquared = Dot(offset, offset);
+		uint32_t distanceBits;
+		memcpy(&distanceBits, &distanceSquared, sizeof(distanceBits));
+		OccluderKeys[i] = (uint64_t)distanceBits << 32 | index;
+	}
+
+	const uint32_t occluderCount = std::min(budget, count);
+	std::partial_sort(OccluderKeys.begin(), OccluderKeys.begin() + occluderCount, OccluderKeys.end());
+
+	OccluderIndices.resize(occluderCount);
+	for (uint32_t i = 0; i < occluderCount; ++i)
+	{
+		OccluderIndices[i] = (uint32_t)OccluderKeys[i];
+	}
+
+	GatherTransforms(transforms, OccluderIndices.data(), occluderCount, OccluderTransforms);
+	OccluderMatrices.resize(occluderCount);
+	ComputeObjectMatrices(OccluderTransforms, 0, occluderCount, ViewProjectionMatrix, OccluderMatrices.data(), sizeof(ObjectMatrices));
+
+	Stats.SetupTime += Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+
+	for (uint32_t i = 0; i < occluderCount; ++i)
+	{
+		AddOccluder(mesh.Positions.data(), (uint32_t)mesh.Positions.size(), mesh.Indices.data(), (uint32_t)mesh.Indices.size(), OccluderMatrices[i].WorldViewProjection);
+	}
+
+	RasterizeOccluders();
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tileIndex)
+{
+	const int32_t tileMinX = (int32_t)(tileIndex % TileCountX) * TILE_WIDTH;
+	const int32_t tileMinY = (int32_t)(tileIndex / TileCountX) * TILE_HEIGHT;
+	const int32_t tileMaxX = std::min(tileMinX + TILE_WIDTH, Width) - 1;
+	const int32_t tileMaxY = std::min(tileMinY + TILE_HEIGHT, Height) - 1;
+
+	for (uint32_t triangleIndex : TileBins[tileIndex])
+	{
+		RasterizeTriangle(Triangles[triangleIndex], tileMinX, tileMinY, tileMaxX, tileMaxY);
+	}
+
+	float tileZMax = 0.0f;
+	for (int32_t subtileY = tileMinY / SUBTILE_HEIGHT; subtileY <= tileMaxY / SUBTILE_HEIGHT; ++subtileY)
+	{
+		for (int32_t subtileX = tileMinX / SUBTILE_WIDTH; subtileX <= tileMaxX / SUBTILE_WIDTH; ++subtileX)
+		{
+			tileZMax = std::max(tileZMax, SubtileZMax0[subtileY * SubtileCountX + subtileX]);
+		}
+	}
+	TileZMax[tileIndex] = tileZMax;
+}
+
+void OcclusionCuller::RasterizeTriangle(const OccluderTriangle& triangle, int32_t tileMinX, int32_t tileMinY, int32_t tileMaxX, int32_t tileMaxY)
+{
+	const int32_t minX = std::max(triangle.MinX, tileMinX);
+	const int32_t maxX = std::min(triangle.MaxX, tileMaxX);
+	const int32_t minY = std::max(triangle.MinY, tileMinY);
+	const int32_t maxY = std::min(triangle.MaxY, tileMaxY);
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+
+	const SimdFloat ramp = SimdRamp();
+	const SimdFloat zero = SimdZero();
+	const SimdFloat edgeA0 = SimdSet(triangle.EdgeA[0]);
+	const SimdFloat edgeA1 = SimdSet(triangle.EdgeA[1]);
+	const SimdFloat edgeA2 = SimdSet(triangle.EdgeA[2]);
+
+	// All ones for the edges that also take the centers on them
+	const SimdFloat allOnes = zero >= zero;
+	const SimdFloat onEdge0 = triangle.bTopLeft[0] ? allOnes : zero;
+	const SimdFloat onEdge1 = triangle.bTopLeft[1] ? allOnes : zero;
+	const SimdFloat onEdge2 = triangle.bTopLeft[2] ? allOnes : zero;
+
+	for (int32_t subtileY = minY / SUBTILE_HEIGHT; subtileY <= maxY / SUBTILE_HEIGHT; ++subtileY)
+	{
+		const float subtileTop = (float)(subtileY * SUBTILE_HEIGHT);
+		const float subtileBottom = subtileTop + SUBTILE_HEIGHT;
+
+		for (int32_t subtileX = minX / SUBTILE_WIDTH; subtileX <= maxX / SUBTILE_WIDTH; ++subtileX)
+		{
+			const float subtileLeft = (float)(subtileX * SUBTILE_WIDTH);
+			const float subtileRight = subtileLeft + SUBTILE_WIDTH;
+			const int32_t subtileIndex = subtileY * SubtileCountX + subtileX;
+
+			// Depth range of the triangle plane over the subtile, limited to the depths of its vertices
+			const float nearDepth = std::max(triangle.MinDepth, triangle.DepthC
+				+ triangle.DepthDx * (triangle.DepthDx > 0.0f ? subtileLeft : subtileRight)
+				+ triangle.DepthDy * (triangle.DepthDy > 0.0f ? subtileTop : subtileBottom));
+			if (nearDepth >= SubtileZMax0[subtileIndex])
+			{
+				continue;
+			}
+			const float farDepth = std::min(triangle.MaxDepth, triangle.DepthC
+				+ triangle.DepthDx * (triangle.DepthDx > 0.0f ? subtileRight : subtileLeft)
+				+ triangle.DepthDy * (triangle.DepthDy > 0.0f ? subtileBottom : subtileTop));
+
+			// Coverage of the subtile, one bit per pixel in row order
+			uint32_t coverage = 0;
+			for (int32_t row = 0; row < SUBTILE_HEIGHT; ++row)
+			{
+				const float centerY = subtileTop + row + 0.5f;
+				const SimdFloat edgeRow0 = SimdSet(triangle.EdgeB[0] * centerY + triangle.EdgeC[0]);
+				const SimdFloat edgeRow1 = SimdSet(triangle.EdgeB[1] * centerY + triangle.EdgeC[1]);
+				const SimdFloat edgeRow2 = SimdSet(triangle.EdgeB[2] * centerY + triangle.EdgeC[2]);
+
+				for (int32_t column = 0; column < SUBTILE_WIDTH; column += SIMD_WIDTH)
+				{
+					const SimdFloat centerX = SimdSet(subtileLeft + column + 0.5f) + ramp;
+					const SimdFloat edge0 = edgeA0 * centerX + edgeRow0;
+					const SimdFloat edge1 = edgeA1 * centerX + edgeRow1;
+					const SimdFloat edge2 = edgeA2 * centerX + edgeRow2;
+					const SimdFloat mask = ((edge0 > zero) | ((edge0 >= zero) & onEdge0)) & ((edge1 > zero) | ((edge1 >= zero) & onEdge1)) &
+						((edge2 > zero) | ((edge2 >= zero) & onEdge2));
+					coverage |= (uint32_t)SimdMoveMask(mask) << (row * SUBTILE_WIDTH + column);
+				}
+			}
+			if (!coverage)
+			{
+				continue;
+			}
+
+			// Drop the working layer when the new triangle is much closer than it, since merging would push
+			// the layer back towards the far reference
+			float zMax1 = SubtileZMax1[subtileIndex];
+			uint32_t mask = SubtileMask[subtileIndex];
+			if (mask && zMax1 - farDepth > SubtileZMax0[subtileIndex] - zMax1)
+			{
+				zMax1 = 0.0f;
+				mask = 0;
+			}
+
+			zMax1 = std::max(zMax1, farDepth);
+			mask |= coverage;
+
+			if (mask == FULL_SUBTILE_MASK)
+			{
+				SubtileZMax0[subtileIndex] = std::min(SubtileZMax0[subtileIndex], zMax1);
+				zMax1 = 0.0f;
+				mask = 0;
+			}
+
+			SubtileZMax1[subtileIndex] = zMax1;
+			SubtileMask[subtileIndex] = mask;
+		}
+	}
+}
+
+bool OcclusionCuller::IsBoxVisible(const Float3& center, const Float3& extent) const
+{
+	// Screen rectangle and nearest depth of the eight corners
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	float nearDepth = FLT_MAX;
+	for (int32_t corner = 0; corner < 8; ++corner)
+	{
+		const Float3 position{
+			center.x + (corner & 1 ? extent.x : -extent.x),
+			center.y + (corner & 2 ? extent.y : -extent.y),
+			center.z + (corner & 4 ? extent.z : -extent.z)
+		};
+		const Float4 clipPosition = TransformCoord(position, ViewProjectionMatrix);
+		if (clipPosition.z < 0.0f)
+		{
+			return true;
+		}
+
+		const float invW = 1.0f / clipPosition.w;
+		const float screenX = (clipPosition.x * invW * 0.5f + 0.5f) * Width;
+		const float screenY = (0.5f - clipPosition.y * invW * 0.5f) * Height;
+		minX = std::min(minX, screenX);
+		maxX = std::max(maxX, screenX);
+		minY = std::min(minY, screenY);
+		maxY = std::max(maxY, screenY);
+		nearDepth = std::min(nearDepth, clipPosition.z * invW);
+	}
+
+	// Every pixel the rectangle touches
+	const int32_t pixelMinX = std::max((int32_t)floorf(minX), 0);
+	const int32_t pixelMaxX = std::min((int32_t)floorf(maxX), Width - 1);
+	const int32_t pixelMinY = std::max((int32_t)floorf(minY), 0);
+	const int32_t pixelMaxY = std::min((int32_t)floorf(maxY), Height - 1);
+	if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY)
+	{
+		return false;
+	}
+
+	for (int32_t tileY = pixelMinY / TILE_HEIGHT; tileY <= pixelMaxY / TILE_HEIGHT; ++tileY)
+	{
+		for (int32_t tileX = pixelMinX / TILE_WIDTH; tileX <= pixelMaxX / TILE_WIDTH; ++tileX)
+		{
+			// The whole tile is closer than the box
+			if (nearDepth > TileZMax[tileY * TileCountX + tileX])
+			{
+				continue;
+			}
+
+			const int32_t subtileMinX = std::max(pixelMinX, tileX * TILE_WIDTH) / SUBTILE_WIDTH;
+			const int32_t subtileMaxX = std::min(pixelMaxX, tileX * TILE_WIDTH + TILE_WIDTH - 1) / SUBTILE_WIDTH;
+			const int32_t subtileMinY = std::max(pixelMinY, tileY * TILE_HEIGHT) / SUBTILE_HEIGHT;
+			const int32_t subtileMaxY = std::min(pixelMaxY, tileY * TILE_HEIGHT + TILE_HEIGHT - 1) / SUBTILE_HEIGHT;
+			for (int32_t subtileY = subtileMinY; subtileY <= subtileMaxY; ++subtileY)
+			{
+				for (int32_t subtileX = subtileMinX; subtileX <= subtileMaxX; ++subtileX)
+				{
+					if (nearDepth <= SubtileZMax0[subtileY * SubtileCountX + subtileX])
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+uint32_t OcclusionCuller::CullBoxes(const BoxBoundsArrays& bounds, uint32_t* indices, uint32_t count)
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+
+	uint32_t visibleCount = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t index = indices[i];
+		const Float3 center{ bounds.CenterX[index], bounds.CenterY[index], bounds.CenterZ[index] };
+		const Float3 extent{ bounds.ExtentX[index], bounds.ExtentY[index], bounds.ExtentZ[index] };
+		indices[visibleCount] = index;
+		visibleCount += IsBoxVisible(center, extent) ? 1 : 0;
+	}
+
+	Stats.TestedCount += count;
+	Stats.RejectedCount += count - visibleCount;
+	Stats.TestTime += Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+	return visibleCount;
+}
+
+uint32_t OcclusionCuller::CullSpheres(const SphereBoundsArrays& bounds, uint32_t* indices, uint32_t count)
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+
+	// Tested through the box around the sphere
+	uint32_t visibleCount = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t index = indices[i];
+		const Float3 center{ bounds.CenterX[index], bounds.CenterY[index], bounds.CenterZ[index] };
+		const float radius = bounds.Radius[index];
+		indices[visibleCount] = index;
+		visibleCount += IsBoxVisible(center, Float3{ radius, radius, radius }) ? 1 : 0;
+	}
+
+	Stats.TestedCount += count;
+	Stats.RejectedCount += count - visibleCount;
+	Stats.TestTime += Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+	return visibleCount;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "BoundingVolumes.h"
+#include "MathTypes.h"
+#include "ObjectTransforms.h"
+#include "ThreadPool.h"
+#include "VertexTypes.h"
+
+class JobSystem;
+
+// Simplified mesh rasterized in place of an object, positions only. It has to fit inside the object it stands for.
+struct OccluderMesh
+{
+	std::vector<Float3> Positions;
+	std::vector<uint16_t> Indices;
+};
+
+struct OcclusionStats
+{
+	uint32_t OccluderCount;
+	uint32_t OccluderTriangleCount;
+	uint32_t TestedCount;
+	uint32_t RejectedCount;
+
+	// Milliseconds
+	double SetupTime;
+	double RasterTime;
+	double TestTime;
+};
+
+// Masked software occlusion culling on the CPU.
+// Occluder triangles are rasterized into a low resolution buffer made of SUBTILE_WIDTH x SUBTILE_HEIGHT subtiles.
+// Every subtile keeps a coverage mask with the farthest depth of the covered pixels (working layer) and the farthest depth
+// over the whole subtile (reference layer); when the mask fills up the working layer becomes the reference layer.
+// Tiles of TILE_WIDTH x TILE_HEIGHT pixels are rasterized in parallel, one task per tile, and also keep the farthest
+// reference depth of their subtiles so that tests can skip whole tiles.
+// A pixel is covered when the triangle contains its center, with the top-left rule of Direct3D for centers on an edge, so that
+// triangles sharing an edge cover every pixel along it exactly once and a mesh covers its whole silhouette without gaps.
+// The tests stay conservative through depth: a subtile only counts as occluded at the farthest depth of its occluders.
+// Depth is z / w of Direct3D, smaller is closer.
+class OcclusionCuller
+{
+public:
+	static constexpr int32_t SUBTILE_WIDTH = 8;
+	static constexpr int32_t SUBTILE_HEIGHT = 4;
+	static constexpr int32_t TILE_WIDTH = 64;
+	static constexpr int32_t TILE_HEIGHT = 32;
+
+	OcclusionCuller() = default;
+	OcclusionCuller(const OcclusionCuller&) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+	// Buffer size is rounded up to whole subtiles. threadCount includes the calling thread. 0 means one per hardware thread.
+	bool Init(int32_t width, int32_t height, uint32_t threadCount);
+
+	// Rasterizes the tiles on the threads of jobSystem instead of threads of its own, for scenes that cull inside its jobs.
+	// jobSystem has to outlive the culler.
+	bool Init(int32_t width, int32_t height, JobSystem& jobSystem);
+	void Free();
+
+	// Clears the buffer and the occluders and resets the stats
+	void BeginFrame(const Float4x4& viewProjectionMatrix);
+
+	// Transforms, sets up and bins the triangles of one occluder. worldViewProjection holds the columns of the matrix,
+	// as in ObjectMatrices. Triangles crossing the near plane are dropped, which only makes the culling less aggressive.
+	void AddOccluder(const Float3* positions, uint32_t vertexCount, const uint16_t* indices, uint32_t indexCount, const Float4 worldViewProjection[4]);
+
+	// Rasterizes every occluder added since BeginFrame
+	void RasterizeOccluders();
+
+	// Adds the budget objects of indices[0..count) closest to cameraPosition, nearest first, with mesh as their occluder
+	// and rasterizes them
+	void RasterizeClosestOccluders(const OccluderMesh& mesh, const TransformArrays& transforms, const uint32_t* indices, uint32_t count,
+		const Float3& cameraPosition, uint32_t budget);
+
+	// False when the world AABB is entirely behind the occluders
+	bool IsBoxVisible(const Float3& center, const Float3& extent) const;
+
+	// Keep the indices whose bounds may be visible, in the same order, and return how many are left
+	uint32_t CullBoxes(const BoxBoundsArrays& bounds, uint32_t* indices, uint32_t count);
+	uint32_t CullSpheres(const SphereBoundsArrays& bounds, uint32_t* indices, uint32_t count);
+
+	const OcclusionStats& GetStats() const { return Stats; }
+
+	int32_t GetWidth() const { return Width; }
+	int32_t GetHeight() const { return Height; }
+	uint32_t GetThreadCount() const;
+
+	// Reference depth of the subtile that holds pixel (x, y), for debugging views
+	float GetDepth(int32_t x, int32_t y) const { return SubtileZMax0[(y / SUBTILE_HEIGHT) * SubtileCountX + x / SUBTILE_WIDTH]; }
+
+private:
+	struct OccluderTriangle
+	{
+		// Edge functions, positive inside. Centers on a top or left edge are inside too.
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		bool bTopLeft[3];
+
+		// Depth plane and the depth range of the vertices
+		float DepthDx;
+		float DepthDy;
+		float DepthC;
+		float MinDepth;
+		float MaxDepth;
+
+		int32_t MinX;
+		int32_t MinY;
+		int32_t MaxX;
+		int32_t MaxY;
+	};
+
+	bool InitBuffers(int32_t width, int32_t height);
+	void SetupTriangle(const Float4& v0, const Float4& v1, const Float4& v2);
+	void RasterizeTile(uint32_t tileIndex);
+	void RasterizeTriangle(const OccluderTriangle& triangle, int32_t tileMinX, int32_t tileMinY, int32_t tileMaxX, int32_t tileMaxY);
+
+	int32_t Width = 0;
+	int32_t Height = 0;
+	int32_t SubtileCountX = 0;
+	int32_t SubtileCountY = 0;
+	int32_t TileCountX = 0;
+	int32_t TileCountY = 0;
+
+	// Per subtile
+	std::vector<float> SubtileZMax0;
+	std::vector<float> SubtileZMax1;
+	std::vector<uint32_t> SubtileMask;
+
+	// Per tile, the farthest SubtileZMax0 inside
+	std::vector<float> TileZMax;
+
+	// Occluder selection of RasterizeClosestOccluders
+	std::vector<uint64_t> OccluderKeys;
+	std::vector<uint32_t> OccluderIndices;
+	TransformArrays OccluderTransforms;
+	std::vector<ObjectMatrices> OccluderMatrices;
+
+	std::vector<Float4> ClipPositions;
+	std::vector<OccluderTriangle> Triangles;
+	std::vector<std::vector<uint32_t>> TileBins;
+
+	Float4x4 ViewProjectionMatrix = MatrixIdentity();
+
+	// Tiles run on Jobs when there is one, on Workers otherwise
+	ThreadPool Workers;
+	JobSystem* Jobs = nullptr;
+	OcclusionStats Stats{};
+};
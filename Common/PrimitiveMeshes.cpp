@@ -0,0 +1,206 @@
+#include "PrimitiveMeshes.h"
+
+namespace
+{
+	// Every level of the Lighting LOD chain up to 32 segments and the occluder spheres, plus one or more small sizes of
+	// every other primitive. Each one is about a thousand vertices at most, past that runtime generation is cheap next to
+	// the rest of startup and the constant evaluation becomes slow to compile.
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_BOX, 1> BOX_1 = BakePrimitive<PRIMITIVE_TYPE_BOX, 1>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_BOX, 8> BOX_8 = BakePrimitive<PRIMITIVE_TYPE_BOX, 8>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_UV_SPHERE, 4, 4> UV_SPHERE_4 = BakePrimitive<PRIMITIVE_TYPE_UV_SPHERE, 4, 4>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_UV_SPHERE, 8, 6> UV_SPHERE_8_6 = BakePrimitive<PRIMITIVE_TYPE_UV_SPHERE, 8, 6>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_UV_SPHERE, 8, 8> UV_SPHERE_8 = BakePrimitive<PRIMITIVE_TYPE_UV_SPHERE, 8, 8>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_UV_SPHERE, 16, 16> UV_SPHERE_16 = BakePrimitive<PRIMITIVE_TYPE_UV_SPHERE, 16, 16>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_UV_SPHERE, 32, 32> UV_SPHERE_32 = BakePrimitive<PRIMITIVE_TYPE_UV_SPHERE, 32, 32>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_ICOSPHERE, 0> ICOSPHERE_0 = BakePrimitive<PRIMITIVE_TYPE_ICOSPHERE, 0>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_ICOSPHERE, 1> ICOSPHERE_1 = BakePrimitive<PRIMITIVE_TYPE_ICOSPHERE, 1>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_ICOSPHERE, 2> ICOSPHERE_2 = BakePrimitive<PRIMITIVE_TYPE_ICOSPHERE, 2>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_ICOSPHERE, 3> ICOSPHERE_3 = BakePrimitive<PRIMITIVE_TYPE_ICOSPHERE, 3>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_CYLINDER, 32, 1> CYLINDER_32 = BakePrimitive<PRIMITIVE_TYPE_CYLINDER, 32, 1>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_PLANE, 1, 1> PLANE_1 = BakePrimitive<PRIMITIVE_TYPE_PLANE, 1, 1>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_PLANE, 16, 16> PLANE_16 = BakePrimitive<PRIMITIVE_TYPE_PLANE, 16, 16>();
+	constexpr StaticPrimitive<PRIMITIVE_TYPE_TORUS, 32, 16> TORUS_32 = BakePrimitive<PRIMITIVE_TYPE_TORUS, 32, 16>();
+
+	template <typename Primitive>
+	constexpr PrimitiveMeshView MakeView(const Primitive& primitive)
+	{
+		return { primitive.Vertices, Primitive::VertexCount, primitive.Indices,
+			sizeof(typename Primitive::Index) == sizeof(uint16_t) ? INDEX_FORMAT_UINT16 : INDEX_FORMAT_UINT32, Primitive::IndexCount };
+	}
+
+	struct BakedPrimitive
+	{
+		PrimitiveShape Shape;
+		PrimitiveMeshView View;
+	};
+
+	const BakedPrimitive BAKED_PRIMITIVES[]
+	{
+		{ BOX_1.Shape, MakeView(BOX_1) },
+		{ BOX_8.Shape, MakeView(BOX_8) },
+		{ UV_SPHERE_4.Shape, MakeView(UV_SPHERE_4) },
+		{ UV_SPHERE_8_6.Shape, MakeView(UV_SPHERE_8_6) },
+		{ UV_SPHERE_8.Shape, MakeView(UV_SPHERE_8) },
+		{ UV_SPHERE_16.Shape, MakeView(UV_SPHERE_16) },
+		{ UV_SPHERE_32.Shape, MakeView(UV_SPHERE_32) },
+		{ ICOSPHERE_0.Shape, MakeView(ICOSPHERE_0) },
+		{ ICOSPHERE_1.Shape, MakeView(ICOSPHERE_1) },
+		{ ICOSPHERE_2.Shape, MakeView(ICOSPHERE_2) },
+		{ ICOSPHERE_3.Shape, MakeView(ICOSPHERE_3) },
+		{ CYLINDER_32.Shape, MakeView(CYLINDER_32) },
+		{ PLANE_1.Shape, MakeView(PLANE_1) },
+		{ PLANE_16.Shape, MakeView(PLANE_16) },
+		{ TORUS_32.Shape, MakeView(TORUS_32) },
+	};
+
+	// Only the tessellations that the type reads take part, the others may hold anything
+	bool IsSameShape(const PrimitiveShape& a, const PrimitiveShape& b)
+	{
+		const bool bUsesY = a.Type != PRIMITIVE_TYPE_BOX && a.Type != PRIMITIVE_TYPE_ICOSPHERE;
+		return a.Type == b.Type && a.TessellationX == b.TessellationX && (!bUsesY || a.TessellationY == b.TessellationY);
+	}
+
+	template <typename Index>
+	void AppendIndices(const void* indices, INDEX_FORMAT format, uint32_t indexCount, std::vector<Index>& outIndices)
+	{
+		if (format == INDEX_FORMAT_UINT16)
+		{
+			outIndices.insert(outIndices.end(), (const uint16_t*)indices, (const uint16_t*)indices + indexCount);
+		}
+		else
+		{
+			outIndices.insert(outIndices.end(), (const uint32_t*)indices, (const uint32_t*)indices + indexCount);
+		}
+	}
+
+	template <typename Index>
+	void AppendLods(const PrimitiveShape* shapes, uint32_t lodCount, std::vector<VertexData>& outVertices, std::vector<Index>& outIndices,
+		std::vector<MeshLod>& outLods, ThreadPool* threadPool)
+	{
+		std::vector<VertexData> vertices;
+		MeshIndices indices;
+		for (uint32_t i = 0; i < lodCount; ++i)
+		{
+			PrimitiveMeshView view;
+			if (!FindBakedPrimitive(shapes[i], view))
+			{
+				GeneratePrimitive(shapes[i], vertices, indices, threadPool);
+				view = { vertices.data(), (uint32_t)vertices.size(), indices.GetData(), indices.Format, indices.GetCount() };
+			}
+
+			outLods[i] = { (uint32_t)outIndices.size(), view.IndexCount, (int32_t)outVertices.size(), view.VertexCount };
+			outVertices.insert(outVertices.end(), view.Vertices, view.Vertices + view.VertexCount);
+			AppendIndices(view.Indices, view.IndexFormat, view.IndexCount, outIndices);
+		}
+	}
+
+	template <typename Index>
+	void WritePrimitiveVectors(const PrimitiveShape& shape, std::vector<VertexData>& outVertices, std::vector<Index>& outIndices)
+	{
+		std::vector<uint64_t> scratch(GetPrimitiveScratchCount(shape));
+		outVertices.resize(GetPrimitiveVertexCount(shape));
+		outIndices.resize(GetPrimitiveIndexCount(shape));
+		WritePrimitive(shape, outVertices.data(), outIndices.data(), scratch.data());
+	}
+}
+
+bool FindBakedPrimitive(const PrimitiveShape& shape, PrimitiveMeshView& outView)
+{
+	for (const BakedPrimitive& baked : BAKED_PRIMITIVES)
+	{
+		if (IsSameShape(shape, baked.Shape))
+		{
+			outView = baked.View;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool GeneratePrimitive(const PrimitiveShape& shape, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool)
+{
+	if (!IsValidPrimitiveShape(shape))
+	{
+		return false;
+	}
+
+	if (shape.Type == PRIMITIVE_TYPE_UV_SPHERE)
+	{
+		GenerateSphere(shape.TessellationX, shape.TessellationY, outVertices, outIndices, threadPool);
+		return true;
+	}
+	if (shape.Type == PRIMITIVE_TYPE_ICOSPHERE)
+	{
+		GenerateIcosphere(shape.TessellationX, outVertices, outIndices, threadPool);
+		return true;
+	}
+
+	outIndices.Format = SelectIndexFormat(GetPrimitiveVertexCount(shape));
+	if (outIndices.Format == INDEX_FORMAT_UINT16)
+	{
+		WritePrimitiveVectors(shape, outVertices, outIndices.Indices16);
+		outIndices.Indices32.clear();
+	}
+	else
+	{
+		WritePrimitiveVectors(shape, outVertices, outIndices.Indices32);
+		outIndices.Indices16.clear();
+	}
+	return true;
+}
+
+bool GetPrimitiveMesh(const PrimitiveShape& shape, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool)
+{
+	PrimitiveMeshView view;
+	if (!FindBakedPrimitive(shape, view))
+	{
+		return GeneratePrimitive(shape, outVertices, outIndices, threadPool);
+	}
+
+	outVertices.assign(view.Vertices, view.Vertices + view.VertexCount);
+	outIndices.Format = view.IndexFormat;
+	if (view.IndexFormat == INDEX_FORMAT_UINT16)
+	{
+		const uint16_t* indices = (const uint16_t*)view.Indices;
+		outIndices.Indices16.assign(indices, indices + view.IndexCount);
+		outIndices.Indices32.clear();
+	}
+	else
+	{
+		const uint32_t* indices = (const uint32_t*)view.Indices;
+		outIndices.Indices32.assign(indices, indices + view.IndexCount);
+		outIndices.Indices16.clear();
+	}
+	return true;
+}
+
+bool GeneratePrimitiveLodChain(const PrimitiveShape* shapes, uint32_t lodCount, std::vector<VertexData>& outVertices, MeshIndices& outIndices,
+	std::vector<MeshLod>& outLods, ThreadPool* threadPool)
+{
+	uint32_t maxVertexCount = 0;
+	for (uint32_t i = 0; i < lodCount; ++i)
+	{
+		if (!IsValidPrimitiveShape(shapes[i]))
+		{
+			return false;
+		}
+		const uint32_t vertexCount = GetPrimitiveVertexCount(shapes[i]);
+		maxVertexCount = vertexCount > maxVertexCount ? vertexCount : maxVertexCount;
+	}
+
+	outVertices.clear();
+	outIndices.Format = SelectIndexFormat(maxVertexCount);
+	outIndices.Indices16.clear();
+	outIndices.Indices32.clear();
+	outLods.resize(lodCount);
+
+	if (outIndices.Format == INDEX_FORMAT_UINT16)
+	{
+		AppendLods(shapes, lodCount, outVertices, outIndices.Indices16, outLods, threadPool);
+	}
+	else
+	{
+		AppendLods(shapes, lodCount, outVertices, outIndices.Indices32, outLods, threadPool);
+	}
+	return true;
+}
@@ -0,0 +1,568 @@
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+#include "MeshGenerator.h"
+#include "VertexTypes.h"
+
+class ThreadPool;
+
+// Primitive meshes that can be generated at compile time. All of them are centered on the origin, fit in [-1, 1] on
+// every axis and have clockwise front faces like the rest of the samples. Small ones are baked into read-only data by
+// PrimitiveMeshes.cpp, so that startup copies them instead of generating them (see GetPrimitiveMesh).
+enum PRIMITIVE_TYPE
+{
+	// Cube of side 2 with TessellationX x TessellationX cells on each face and a vertex copy per face for the flat normals
+	PRIMITIVE_TYPE_BOX,
+
+	// Same sphere as GenerateSphere with TessellationX slices and TessellationY rings
+	PRIMITIVE_TYPE_UV_SPHERE,
+
+	// Icosahedron of radius 1 with every triangle split in four TessellationX times (0 to ICOSPHERE_MAX_LEVEL)
+	PRIMITIVE_TYPE_ICOSPHERE,
+
+	// Radius 1 and height 2 along y with TessellationX slices and TessellationY stacks, capped by triangle fans
+	PRIMITIVE_TYPE_CYLINDER,
+
+	// Square of side 2 in the xz plane facing +y with TessellationX x TessellationY cells
+	PRIMITIVE_TYPE_PLANE,
+
+	// Ring around y with TessellationX segments along the ring and TessellationY around the tube
+	PRIMITIVE_TYPE_TORUS,
+
+	PRIMITIVE_TYPE_COUNT
+};
+
+struct PrimitiveShape
+{
+	PRIMITIVE_TYPE Type;
+	int32_t TessellationX;
+	int32_t TessellationY;
+};
+
+// Radius of the tube of the torus, whose ring has radius 1 - TORUS_TUBE_RADIUS
+constexpr double TORUS_TUBE_RADIUS = 0.25;
+
+constexpr bool IsValidPrimitiveShape(const PrimitiveShape& shape)
+{
+	switch (shape.Type)
+	{
+	case PRIMITIVE_TYPE_BOX:
+		return shape.TessellationX >= 1 && shape.TessellationX <= 4096;
+	case PRIMITIVE_TYPE_UV_SPHERE:
+		return shape.TessellationX >= 3 && shape.TessellationY >= 1 && (int64_t)shape.TessellationX * shape.TessellationY <= (1 << 28);
+	case PRIMITIVE_TYPE_ICOSPHERE:
+		return shape.TessellationX >= 0 && shape.TessellationX <= ICOSPHERE_MAX_LEVEL;
+	case PRIMITIVE_TYPE_CYLINDER:
+	case PRIMITIVE_TYPE_TORUS:
+		return shape.TessellationX >= 3 && shape.TessellationY >= (shape.Type == PRIMITIVE_TYPE_TORUS ? 3 : 1)
+			&& (int64_t)shape.TessellationX * shape.TessellationY <= (1 << 28);
+	case PRIMITIVE_TYPE_PLANE:
+		return shape.TessellationX >= 1 && shape.TessellationY >= 1 && (int64_t)shape.TessellationX * shape.TessellationY <= (1 << 28);
+	default:
+		return false;
+	}
+}
+
+// 0 for shapes that are not valid
+constexpr uint32_t GetPrimitiveVertexCount(const PrimitiveShape& shape)
+{
+	if (!IsValidPrimitiveShape(shape))
+	{
+		return 0;
+	}
+
+	const uint32_t x = (uint32_t)shape.TessellationX;
+	const uint32_t y = (uint32_t)shape.TessellationY;
+	switch (shape.Type)
+	{
+	case PRIMITIVE_TYPE_BOX:
+		return 6 * (x + 1) * (x + 1);
+	case PRIMITIVE_TYPE_UV_SPHERE:
+		return x * y + 2;
+	case PRIMITIVE_TYPE_ICOSPHERE:
+		return 10 * (1u << (2 * x)) + 2;
+	case PRIMITIVE_TYPE_CYLINDER:
+		return (y + 1) * x + 2 * (x + 1);
+	case PRIMITIVE_TYPE_PLANE:
+		return (x + 1) * (y + 1);
+	default:
+		return x * y;
+	}
+}
+
+constexpr uint32_t GetPrimitiveIndexCount(const PrimitiveShape& shape)
+{
+	if (!IsValidPrimitiveShape(shape))
+	{
+		return 0;
+	}
+
+	const uint32_t x = (uint32_t)shape.TessellationX;
+	const uint32_t y = (uint32_t)shape.TessellationY;
+	switch (shape.Type)
+	{
+	case PRIMITIVE_TYPE_BOX:
+		return 6 * x * x * 6;
+	case PRIMITIVE_TYPE_ICOSPHERE:
+		return 20 * (1u << (2 * x)) * 3;
+	case PRIMITIVE_TYPE_CYLINDER:
+		return x * y * 6 + x * 6;
+	default:
+		return x * y * 6;
+	}
+}
+
+// Capacity of the edge midpoint table of the last icosphere subdivision, a power of two at least twice its edge count
+constexpr uint32_t GetIcosphereMidpointTableSize(int32_t level)
+{
+	const uint32_t edgeCount = 30u << (2 * level);
+	uint32_t size = 1;
+	while (size < 2 * edgeCount)
+	{
+		size *= 2;
+	}
+	return size;
+}
+
+// Entries of the scratch buffer WritePrimitive needs for shape
+constexpr uint32_t GetPrimitiveScratchCount(const PrimitiveShape& shape)
+{
+	return shape.Type == PRIMITIVE_TYPE_ICOSPHERE && shape.TessellationX > 0 && IsValidPrimitiveShape(shape)
+		? GetIcosphereMidpointTableSize(shape.TessellationX - 1) : 0;
+}
+
+// Two triangles per cell of a vertex grid, rows of rowLength vertices. Cell (i, j) spans vertices i to i + 1 along a row
+// and rows j to j + 1, which must turn clockwise seen from the front: cross(row step, vertex step) points out of the mesh.
+template <typename Index>
+constexpr void WritePrimitiveGridCells(uint32_t firstVertex, uint32_t rowLength, uint32_t cellCountI, uint32_t cellCountJ, uint32_t wrapI,
+	Index* indices, uint32_t& index)
+{
+	for (uint32_t j = 0; j < cellCountJ; ++j)
+	{
+		for (uint32_t i = 0; i < cellCountI; ++i)
+		{
+			const uint32_t nextI = wrapI && i + 1 == wrapI ? 0 : i + 1;
+			const uint32_t a = firstVertex + j * rowLength + i;
+			const uint32_t b = firstVertex + (j + 1) * rowLength + i;
+			const uint32_t c = firstVertex + (j + 1) * rowLength + nextI;
+			const uint32_t d = firstVertex + j * rowLength + nextI;
+
+			indices[index++] = (Index)a;
+			indices[index++] = (Index)b;
+			indices[index++] = (Index)c;
+
+			indices[index++] = (Index)a;
+			indices[index++] = (Index)c;
+			indices[index++] = (Index)d;
+		}
+	}
+}
+
+template <typename Index>
+constexpr void WriteBox(int32_t cellCount, VertexData* vertices, Index* indices)
+{
+	// Normal, then the axes along a row and across rows, with cross(across, along) = normal
+	constexpr int32_t FACES[6][3][3]
+	{
+		{ { 1, 0, 0 }, { 0, 0, 1 }, { 0, 1, 0 } },
+		{ { -1, 0, 0 }, { 0, 0, -1 }, { 0, 1, 0 } },
+		{ { 0, 1, 0 }, { 1, 0, 0 }, { 0, 0, 1 } },
+		{ { 0, -1, 0 }, { 1, 0, 0 }, { 0, 0, -1 } },
+		{ { 0, 0, 1 }, { -1, 0, 0 }, { 0, 1, 0 } },
+		{ { 0, 0, -1 }, { 1, 0, 0 }, { 0, 1, 0 } }
+	};
+
+	const uint32_t rowLength = (uint32_t)cellCount + 1;
+	uint32_t vertex = 0;
+	uint32_t index = 0;
+	for (const auto& face : FACES)
+	{
+		const Float3 normal{ (float)face[0][0], (float)face[0][1], (float)face[0][2] };
+		WritePrimitiveGridCells(vertex, rowLength, (uint32_t)cellCount, (uint32_t)cellCount, 0, indices, index);
+		for (uint32_t j = 0; j < rowLength; ++j)
+		{
+			const double v = -1.0 + 2.0 * j / cellCount;
+			for (uint32_t i = 0; i < rowLength; ++i)
+			{
+				const double u = -1.0 + 2.0 * i / cellCount;
+				vertices[vertex++] = {
+					Float3{ (float)(face[0][0] + u * face[1][0] + v * face[2][0]), (float)(face[0][1] + u * face[1][1] + v * face[2][1]),
+						(float)(face[0][2] + u * face[1][2] + v * face[2][2]) },
+					normal
+				};
+			}
+		}
+	}
+}
+
+// Same arithmetic as GenerateSphere, so that both give the same bits
+template <typename Index>
+constexpr void WriteUvSphere(int32_t sliceCount, int32_t ringCount, VertexData* vertices, Index* indices)
+{
+	vertices[0] = { Float3{ 0.0f, 1.0f, 0.0f }, Float3{ 0.0f, 1.0f, 0.0f } };
+	vertices[sliceCount * ringCount + 1] = { Float3{ 0.0f, -1.0f, 0.0f }, Float3{ 0.0f, -1.0f, 0.0f } };
+
+	const float deltaThetaAngle = PI / (float)(ringCount + 1);
+	const float deltaPhiAngle = TWO_PI / (float)sliceCount;
+	float theta = 0.0f;
+	for (int32_t ringIndex = 0; ringIndex < ringCount; ++ringIndex)
+	{
+		theta += deltaThetaAngle;
+		const float sinTheta = (float)ConstexprSin((double)theta);
+		const float cosTheta = (float)ConstexprCos((double)theta);
+
+		float phi = 0.0f;
+		for (int32_t sliceIndex = 0; sliceIndex < sliceCount; ++sliceIndex)
+		{
+			const Float3 position{ sinTheta * (float)ConstexprCos((double)phi), cosTheta, sinTheta * (float)ConstexprSin((double)phi) };
+			vertices[ringIndex * sliceCount + sliceIndex + 1] = { position, position };
+			phi += deltaPhiAngle;
+		}
+	}
+
+	// Top, bands and bottom
+	uint32_t index = 0;
+	for (int32_t i = 1; i <= sliceCount; ++i)
+	{
+		indices[index++] = 0;
+		indices[index++] = (Index)(i % sliceCount + 1);
+		indices[index++] = (Index)i;
+	}
+	for (int32_t i = 0; i < ringCount - 1; ++i)
+	{
+		for (int32_t j = 1; j <= sliceCount; ++j)
+		{
+			const int32_t nextJ = j % sliceCount + 1;
+
+			indices[index++] = (Index)(sliceCount * i + j);
+			indices[index++] = (Index)(sliceCount * (i + 1) + nextJ);
+			indices[index++] = (Index)(sliceCount * (i + 1) + j);
+
+			indices[index++] = (Index)(sliceCount * i + j);
+			indices[index++] = (Index)(sliceCount * i + nextJ);
+			indices[index++] = (Index)(sliceCount * (i + 1) + nextJ);
+		}
+	}
+	for (int32_t i = 1; i <= sliceCount; ++i)
+	{
+		const int32_t baseIndex = sliceCount * (ringCount - 1);
+
+		indices[index++] = (Index)(baseIndex + i);
+		indices[index++] = (Index)(baseIndex + i % sliceCount + 1);
+		indices[index++] = (Index)(sliceCount * ringCount + 1);
+	}
+}
+
+// Entry of the icosphere midpoint table: the edge from its lower to its higher vertex and the midpoint vertex, 0 is empty
+constexpr uint32_t ICOSPHERE_EDGE_VERTEX_BITS = 21;
+constexpr uint64_t ICOSPHERE_EDGE_VERTEX_MASK = (1ull << ICOSPHERE_EDGE_VERTEX_BITS) - 1;
+
+constexpr uint64_t PackIcosphereEdge(uint32_t lower, uint32_t higher)
+{
+	return (uint64_t)lower << (2 * ICOSPHERE_EDGE_VERTEX_BITS) | (uint64_t)higher << ICOSPHERE_EDGE_VERTEX_BITS;
+}
+
+// The table slot is taken from the high bits
+constexpr uint64_t HashIcosphereEdge(uint32_t lower, uint32_t higher)
+{
+	return ((uint64_t)lower * 0x9E3779B97F4A7C15ull ^ higher) * 0xBF58476D1CE4E5B9ull;
+}
+
+// Midpoint of an edge pushed out to the unit sphere, normalized in double precision
+constexpr Float3 GetIcosphereMidpoint(const Float3& a, const Float3& b)
+{
+	const double x = (double)a.x + b.x;
+	const double y = (double)a.y + b.y;
+	const double z = (double)a.z + b.z;
+	const double length = ConstexprSqrt(x * x + y * y + z * z);
+	return Float3{ (float)(x / length), (float)(y / length), (float)(z / length) };
+}
+
+// Each subdivision numbers the new vertex of every edge in the order its half-edge from the lower to the higher index
+// comes up in the triangles, and keeps the numbers in an open addressing table of scratch (PackIcosphereEdge, never 0 as
+// no edge starts and ends at vertex 0). Triangles are then split in place from the last one, whose four children land
+// past every triangle that is still to be split. GenerateIcosphere does the same in parallel.
+template <typename Index>
+constexpr void WriteIcosphere(int32_t level, VertexData* vertices, Index* indices, uint64_t* scratch)
+{
+	constexpr double GOLDEN_RATIO = 1.61803398874989484820;
+	constexpr int8_t ICOSAHEDRON_VERTICES[12][3]
+	{
+		{ -1, 1, 0 }, { 1, 1, 0 }, { -1, -1, 0 }, { 1, -1, 0 },
+		{ 0, -1, 1 }, { 0, 1, 1 }, { 0, -1, -1 }, { 0, 1, -1 },
+		{ 1, 0, -1 }, { 1, 0, 1 }, { -1, 0, -1 }, { -1, 0, 1 }
+	};
+	constexpr uint8_t ICOSAHEDRON_TRIANGLES[20][3]
+	{
+		{ 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+		{ 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+		{ 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+		{ 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 }
+	};
+
+	// (+-1, +-golden ratio, 0) and its cyclic permutations
+	const double length = ConstexprSqrt(1.0 + GOLDEN_RATIO * GOLDEN_RATIO);
+	for (uint32_t i = 0; i < 12; ++i)
+	{
+		const int8_t* corner = ICOSAHEDRON_VERTICES[i];
+		const double x = corner[0] * (corner[1] == 0 ? GOLDEN_RATIO : 1.0);
+		const double y = corner[1] * (corner[2] == 0 ? GOLDEN_RATIO : 1.0);
+		const double z = corner[2] * (corner[0] == 0 ? GOLDEN_RATIO : 1.0);
+		const Float3 position{ (float)(x / length), (float)(y / length), (float)(z / length) };
+		vertices[i] = { position, position };
+	}
+	for (uint32_t i = 0; i < 60; ++i)
+	{
+		indices[i] = (Index)ICOSAHEDRON_TRIANGLES[i / 3][i % 3];
+	}
+
+	uint32_t vertexCount = 12;
+	uint32_t triangleCount = 20;
+	for (int32_t subdivision = 0; subdivision < level; ++subdivision)
+	{
+		const uint32_t tableSize = GetIcosphereMidpointTableSize(subdivision);
+		uint32_t shift = 64;
+		for (uint32_t size = tableSize; size > 1; size /= 2)
+		{
+			--shift;
+		}
+		for (uint32_t i = 0; i < tableSize; ++i)
+		{
+			scratch[i] = 0;
+		}
+
+		for (uint32_t i = 0; i < triangleCount * 3; ++i)
+		{
+			const uint32_t a = indices[i];
+			const uint32_t b = indices[i % 3 == 2 ? i - 2 : i + 1];
+			if (a < b)
+			{
+				uint32_t slot = (uint32_t)(HashIcosphereEdge(a, b) >> shift);
+				while (scratch[slot])
+				{
+					slot = (slot + 1) & (tableSize - 1);
+				}
+				scratch[slot] = PackIcosphereEdge(a, b) | vertexCount;
+				const Float3 position = GetIcosphereMidpoint(vertices[a].Position, vertices[b].Position);
+				vertices[vertexCount++] = { position, position };
+			}
+		}
+
+		for (uint32_t triangle = triangleCount; triangle-- > 0;)
+		{
+			uint32_t corners[3]{ indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2] };
+			uint32_t midpoints[3]{};
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				const uint32_t a = corners[k] < corners[(k + 1) % 3] ? corners[k] : corners[(k + 1) % 3];
+				const uint32_t b = corners[k] < corners[(k + 1) % 3] ? corners[(k + 1) % 3] : corners[k];
+				uint32_t slot = (uint32_t)(HashIcosphereEdge(a, b) >> shift);
+				while ((scratch[slot] & ~ICOSPHERE_EDGE_VERTEX_MASK) != PackIcosphereEdge(a, b))
+				{
+					slot = (slot + 1) & (tableSize - 1);
+				}
+				midpoints[k] = (uint32_t)(scratch[slot] & ICOSPHERE_EDGE_VERTEX_MASK);
+			}
+
+			const uint32_t children[12]
+			{
+				corners[0], midpoints[0], midpoints[2],
+				midpoints[0], corners[1], midpoints[1],
+				midpoints[2], midpoints[1], corners[2],
+				midpoints[0], midpoints[1], midpoints[2]
+			};
+			for (uint32_t k = 0; k < 12; ++k)
+			{
+				indices[triangle * 12 + k] = (Index)children[k];
+			}
+		}
+		triangleCount *= 4;
+	}
+}
+
+template <typename Index>
+constexpr void WriteCylinder(int32_t sliceCount, int32_t stackCount, VertexData* vertices, Index* indices)
+{
+	// Sides, a ring of sliceCount vertices per stack boundary from the bottom up
+	uint32_t vertex = 0;
+	uint32_t index = 0;
+	WritePrimitiveGridCells(0, (uint32_t)sliceCount, (uint32_t)sliceCount, (uint32_t)stackCount, (uint32_t)sliceCount, indices, index);
+	for (int32_t j = 0; j <= stackCount; ++j)
+	{
+		const float y = (float)(-1.0 + 2.0 * j / stackCount);
+		for (int32_t i = 0; i < sliceCount; ++i)
+		{
+			const double angle = 2.0 * 3.14159265358979323846 * i / sliceCount;
+			const float x = (float)ConstexprCos(angle);
+			const float z = (float)ConstexprSin(angle);
+			vertices[vertex++] = { Float3{ x, y, z }, Float3{ x, 0.0f, z } };
+		}
+	}
+
+	// Top and bottom caps, a center followed by its ring
+	for (int32_t cap = 0; cap < 2; ++cap)
+	{
+		const float y = cap == 0 ? 1.0f : -1.0f;
+		const uint32_t center = vertex;
+		vertices[vertex++] = { Float3{ 0.0f, y, 0.0f }, Float3{ 0.0f, y, 0.0f } };
+		for (int32_t i = 0; i < sliceCount; ++i)
+		{
+			const double angle = 2.0 * 3.14159265358979323846 * i / sliceCount;
+			vertices[vertex++] = { Float3{ (float)ConstexprCos(angle), y, (float)ConstexprSin(angle) }, Float3{ 0.0f, y, 0.0f } };
+
+			const uint32_t current = center + 1 + (uint32_t)i;
+			const uint32_t next = center + 1 + (uint32_t)((i + 1) % sliceCount);
+			indices[index++] = (Index)center;
+			indices[index++] = (Index)(cap == 0 ? next : current);
+			indices[index++] = (Index)(cap == 0 ? current : next);
+		}
+	}
+}
+
+template <typename Index>
+constexpr void WritePlane(int32_t cellCountX, int32_t cellCountZ, VertexData* vertices, Index* indices)
+{
+	uint32_t vertex = 0;
+	uint32_t index = 0;
+	WritePrimitiveGridCells(0, (uint32_t)cellCountX + 1, (uint32_t)cellCountX, (uint32_t)cellCountZ, 0, indices, index);
+	for (int32_t j = 0; j <= cellCountZ; ++j)
+	{
+		for (int32_t i = 0; i <= cellCountX; ++i)
+		{
+			vertices[vertex++] = { Float3{ (float)(-1.0 + 2.0 * i / cellCountX), 0.0f, (float)(-1.0 + 2.0 * j / cellCountZ) }, Float3{ 0.0f, 1.0f, 0.0f } };
+		}
+	}
+}
+
+// A row of vertices around the tube per segment of the ring, wrapping around in both directions
+template <typename Index>
+constexpr void WriteTorus(int32_t ringSegmentCount, int32_t tubeSegmentCount, VertexData* vertices, Index* indices)
+{
+	uint32_t vertex = 0;
+	uint32_t index = 0;
+	for (int32_t i = 0; i < ringSegmentCount; ++i)
+	{
+		const double ringAngle = 2.0 * 3.14159265358979323846 * i / ringSegmentCount;
+		const double ringX = ConstexprCos(ringAngle);
+		const double ringZ = ConstexprSin(ringAngle);
+		for (int32_t j = 0; j < tubeSegmentCount; ++j)
+		{
+			const double tubeAngle = 2.0 * 3.14159265358979323846 * j / tubeSegmentCount;
+			const double outward = ConstexprCos(tubeAngle);
+			const double up = ConstexprSin(tubeAngle);
+			const double radius = 1.0 - TORUS_TUBE_RADIUS + TORUS_TUBE_RADIUS * outward;
+			vertices[vertex++] = {
+				Float3{ (float)(ringX * radius), (float)(TORUS_TUBE_RADIUS * up), (float)(ringZ * radius) },
+				Float3{ (float)(ringX * outward), (float)up, (float)(ringZ * outward) }
+			};
+		}
+	}
+
+	// Each cell turns from its step around the tube to its step along the ring, which is clockwise seen from outside
+	for (uint32_t i = 0; i < (uint32_t)ringSegmentCount; ++i)
+	{
+		const uint32_t nextI = (i + 1) % (uint32_t)ringSegmentCount;
+		for (uint32_t j = 0; j < (uint32_t)tubeSegmentCount; ++j)
+		{
+			const uint32_t nextJ = (j + 1) % (uint32_t)tubeSegmentCount;
+			const uint32_t a = i * tubeSegmentCount + j;
+			const uint32_t b = i * tubeSegmentCount + nextJ;
+			const uint32_t c = nextI * tubeSegmentCount + nextJ;
+			const uint32_t d = nextI * tubeSegmentCount + j;
+
+			indices[index++] = (Index)a;
+			indices[index++] = (Index)b;
+			indices[index++] = (Index)c;
+
+			indices[index++] = (Index)a;
+			indices[index++] = (Index)c;
+			indices[index++] = (Index)d;
+		}
+	}
+}
+
+// Writes GetPrimitiveVertexCount(shape) vertices and GetPrimitiveIndexCount(shape) indices of a valid shape.
+// scratch holds GetPrimitiveScratchCount(shape) entries. Runs at compile time for BakePrimitive and at runtime for GeneratePrimitive.
+template <typename Index>
+constexpr void WritePrimitive(const PrimitiveShape& shape, VertexData* vertices, Index* indices, uint64_t* scratch)
+{
+	switch (shape.Type)
+	{
+	case PRIMITIVE_TYPE_BOX:
+		WriteBox(shape.TessellationX, vertices, indices);
+		break;
+	case PRIMITIVE_TYPE_UV_SPHERE:
+		WriteUvSphere(shape.TessellationX, shape.TessellationY, vertices, indices);
+		break;
+	case PRIMITIVE_TYPE_ICOSPHERE:
+		WriteIcosphere(shape.TessellationX, vertices, indices, scratch);
+		break;
+	case PRIMITIVE_TYPE_CYLINDER:
+		WriteCylinder(shape.TessellationX, shape.TessellationY, vertices, indices);
+		break;
+	case PRIMITIVE_TYPE_PLANE:
+		WritePlane(shape.TessellationX, shape.TessellationY, vertices, indices);
+		break;
+	default:
+		WriteTorus(shape.TessellationX, shape.TessellationY, vertices, indices);
+		break;
+	}
+}
+
+// Mesh with its size fixed by the template arguments, 16-bit indices whenever they address every vertex
+template <PRIMITIVE_TYPE Type, int32_t TessellationX, int32_t TessellationY = 0>
+struct StaticPrimitive
+{
+	static constexpr PrimitiveShape Shape{ Type, TessellationX, TessellationY };
+	static constexpr uint32_t VertexCount = GetPrimitiveVertexCount(Shape);
+	static constexpr uint32_t IndexCount = GetPrimitiveIndexCount(Shape);
+	static_assert(VertexCount > 0, "Tessellation is out of range for this primitive type");
+
+	using Index = std::conditional_t<VertexCount <= 65536, uint16_t, uint32_t>;
+
+	VertexData Vertices[VertexCount];
+	Index Indices[IndexCount];
+};
+
+// Generates a primitive at compile time when it initializes a constexpr variable:
+// constexpr StaticPrimitive<PRIMITIVE_TYPE_TORUS, 32, 16> TORUS = BakePrimitive<PRIMITIVE_TYPE_TORUS, 32, 16>();
+// Compilers cap the work of a constant evaluation, so this is meant for meshes of about a thousand vertices.
+template <PRIMITIVE_TYPE Type, int32_t TessellationX, int32_t TessellationY = 0>
+constexpr StaticPrimitive<Type, TessellationX, TessellationY> BakePrimitive()
+{
+	using Primitive = StaticPrimitive<Type, TessellationX, TessellationY>;
+
+	Primitive primitive{};
+	uint64_t scratch[GetPrimitiveScratchCount(Primitive::Shape) + 1]{};
+	WritePrimitive(Primitive::Shape, primitive.Vertices, primitive.Indices, scratch);
+	return primitive;
+}
+
+// Baked or generated mesh data that the caller does not own
+struct PrimitiveMeshView
+{
+	const VertexData* Vertices;
+	uint32_t VertexCount;
+	const void* Indices;
+	INDEX_FORMAT IndexFormat;
+	uint32_t IndexCount;
+};
+
+// Read-only data of shape when PrimitiveMeshes.cpp bakes it, which covers the small shapes the samples use.
+// Returns false for every other shape.
+bool FindBakedPrimitive(const PrimitiveShape& shape, PrimitiveMeshView& outView);
+
+// Generates shape at runtime with the index format picked by SelectIndexFormat, whether it is baked or not.
+// UV spheres and icospheres go through GenerateSphere and GenerateIcosphere and their threadPool. Returns false when the shape is not valid.
+bool GeneratePrimitive(const PrimitiveShape& shape, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool = nullptr);
+
+// Copies the baked data of shape when there is some and generates it otherwise
+bool GetPrimitiveMesh(const PrimitiveShape& shape, std::vector<VertexData>& outVertices, MeshIndices& outIndices, ThreadPool* threadPool = nullptr);
+
+// Every shape as one level of detail, appended one after another like GenerateSphereLodChain. Baked levels are copied.
+// Returns false when a shape is not valid.
+bool GeneratePrimitiveLodChain(const PrimitiveShape* shapes, uint32_t lodCount, std::vector<VertexData>& outVertices, MeshIndices& outIndices,
+	std::vector<MeshLod>& outLods, ThreadPool* threadPool = nullptr);
@@ -0,0 +1,147 @@
+#include "RadixSort.h"
+
+#include <string.h>
+#include <utility>
+
+#include "Clock.h"
+#include "JobSystem.h"
+
+namespace
+{
+	constexpr uint32_t RADIX_BITS = 8;
+	constexpr uint32_t RADIX_SIZE = 1 << RADIX_BITS;
+	constexpr uint32_t KEY_BITS = 64;
+
+	// Keys per block, small enough to spread 1M keys over 64 threads and large enough that the counts stay cheap to add up
+	constexpr uint32_t RADIX_BLOCK_SIZE = 16384;
+
+	// Runs function(begin, end) over the blocks of [0, count), on the threads of jobSystem when there is one
+	template <typename Function>
+	void ForEachBlock(JobSystem* jobSystem, uint32_t count, const Function& function)
+	{
+		if (jobSystem)
+		{
+			jobSystem->ParallelFor(count, RADIX_BLOCK_SIZE, [&function](uint32_t begin, uint32_t end, uint32_t) { function(begin, end); });
+			return;
+		}
+
+		for (uint32_t begin = 0; begin < count; begin += RADIX_BLOCK_SIZE)
+		{
+			function(begin, count - begin < RADIX_BLOCK_SIZE ? count : begin + RADIX_BLOCK_SIZE);
+		}
+	}
+}
+
+void RadixSorter::Reserve(uint32_t count)
+{
+	const uint32_t blockCount = (count + RADIX_BLOCK_SIZE - 1) / RADIX_BLOCK_SIZE;
+	if (ScratchKeys.size() < count)
+	{
+		ScratchKeys.resize(count);
+		ScratchValues.resize(count);
+	}
+	if (BlockAndBits.size() < blockCount)
+	{
+		BlockAndBits.resize(blockCount);
+		BlockOrBits.resize(blockCount);
+		BlockOffsets.resize(blockCount * RADIX_SIZE);
+	}
+}
+
+void RadixSorter::Sort(uint64_t* keys, uint32_t* values, uint32_t count, JobSystem* jobSystem)
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+	Reserve(count);
+	Stats = RadixSortStats{};
+	Stats.KeyCount = count;
+	if (count < 2)
+	{
+		return;
+	}
+
+	// Bytes that no two keys disagree on would leave the order as it is
+	ForEachBlock(jobSystem, count, [&](uint32_t begin, uint32_t end)
+	{
+		uint64_t andBits = ~0ull;
+		uint64_t orBits = 0;
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			andBits &= keys[i];
+			orBits |= keys[i];
+		}
+		BlockAndBits[begin / RADIX_BLOCK_SIZE] = andBits;
+		BlockOrBits[begin / RADIX_BLOCK_SIZE] = orBits;
+	});
+
+	const uint32_t blockCount = (count + RADIX_BLOCK_SIZE - 1) / RADIX_BLOCK_SIZE;
+	uint64_t andBits = ~0ull;
+	uint64_t orBits = 0;
+	for (uint32_t block = 0; block < blockCount; ++block)
+	{
+		andBits &= BlockAndBits[block];
+		orBits |= BlockOrBits[block];
+	}
+	const uint64_t varyingBits = andBits ^ orBits;
+
+	uint64_t* sourceKeys = keys;
+	uint32_t* sourceValues = values;
+	uint64_t* destKeys = ScratchKeys.data();
+	uint32_t* destValues = ScratchValues.data();
+	for (uint32_t shift = 0; shift < KEY_BITS; shift += RADIX_BITS)
+	{
+		if (!(varyingBits >> shift & (RADIX_SIZE - 1)))
+		{
+			++Stats.SkippedPassCount;
+			continue;
+		}
+
+		ForEachBlock(jobSystem, count, [&](uint32_t begin, uint32_t end)
+		{
+			uint32_t* counts = &BlockOffsets[begin / RADIX_BLOCK_SIZE * RADIX_SIZE];
+			memset(counts, 0, RADIX_SIZE * sizeof(uint32_t));
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				++counts[sourceKeys[i] >> shift & (RADIX_SIZE - 1)];
+			}
+		});
+
+		// Digit by digit, and inside a digit block by block, which keeps equal keys in order
+		uint32_t offset = 0;
+		for (uint32_t digit = 0; digit < RADIX_SIZE; ++digit)
+		{
+			for (uint32_t block = 0; block < blockCount; ++block)
+			{
+				const uint32_t digitCount = BlockOffsets[block * RADIX_SIZE + digit];
+				BlockOffsets[block * RADIX_SIZE + digit] = offset;
+				offset += digitCount;
+			}
+		}
+
+		ForEachBlock(jobSystem, count, [&](uint32_t begin, uint32_t end)
+		{
+			uint32_t* offsets = &BlockOffsets[begin / RADIX_BLOCK_SIZE * RADIX_SIZE];
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const uint32_t position = offsets[sourceKeys[i] >> shift & (RADIX_SIZE - 1)]++;
+				destKeys[position] = sourceKeys[i];
+				destValues[position] = sourceValues[i];
+			}
+		});
+
+		std::swap(sourceKeys, destKeys);
+		std::swap(sourceValues, destValues);
+		++Stats.PassCount;
+	}
+
+	// After an odd number of passes the keys ended up in the scratch arrays
+	if (sourceKeys != keys)
+	{
+		ForEachBlock(jobSystem, count, [&](uint32_t begin, uint32_t end)
+		{
+			memcpy(keys + begin, sourceKeys + begin, (end - begin) * sizeof(uint64_t));
+			memcpy(values + begin, sourceValues + begin, (end - begin) * sizeof(uint32_t));
+		});
+	}
+
+	Stats.SortTime = Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+}
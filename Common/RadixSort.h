@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class JobSystem;
+
+struct RadixSortStats
+{
+	uint32_t KeyCount;
+
+	// Passes that moved the keys, and passes left out because every key has the same byte there
+	uint32_t PassCount;
+	uint32_t SkippedPassCount;
+
+	// Milliseconds of the last Sort
+	double SortTime;
+};
+
+// Stable LSD radix sort of 64-bit keys with a 32-bit value each, one byte per pass from the lowest. The keys are cut into
+// blocks of a fixed size: every pass counts the digits of each block in parallel, turns the counts into where every block
+// writes each digit, and scatters the blocks in parallel. Since the blocks never depend on the thread count, neither does
+// the result. Bytes that are the same in every key are found up front and never get a pass.
+class RadixSorter
+{
+public:
+	// Grows the scratch arrays for up to count keys, so that sorting that many allocates nothing
+	void Reserve(uint32_t count);
+
+	// Sorts keys[0..count) ascending and moves values[0..count) along with them, equal keys keep their order.
+	// Runs on the threads of jobSystem when there is one, which may be called from inside one of its jobs.
+	void Sort(uint64_t* keys, uint32_t* values, uint32_t count, JobSystem* jobSystem = nullptr);
+
+	const RadixSortStats& GetStats() const { return Stats; }
+
+private:
+	std::vector<uint64_t> ScratchKeys;
+	std::vector<uint32_t> ScratchValues;
+
+	// Bits every key of a block has, and bits any key of it has
+	std::vector<uint64_t> BlockAndBits;
+	std::vector<uint64_t> BlockOrBits;
+
+	// Digit counts of every block, 256 per block, and then the positions each block writes its digits to
+	std::vector<uint32_t> BlockOffsets;
+
+	RadixSortStats Stats{};
+};
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <stdint.h>
+
+// Backend-neutral subset of the Direct3D 11 device and immediate context used by the samples.
+// Resources are owned by the device and released together in Free.
+
+// Constant buffer ranges are bound in units of 16 constants (Direct3D 11.1 constant buffer offsetting)
+constexpr uint32_t CONSTANT_BUFFER_ALIGNMENT = 256;
+constexpr uint32_t MAX_CONSTANT_BUFFER_RANGE_SIZE = 65536;
+
+enum BUFFER_TYPE : uint32_t
+{
+	BUFFER_TYPE_VERTEX,
+	BUFFER_TYPE_INDEX,
+	BUFFER_TYPE_CONSTANT
+};
+
+enum BUFFER_USAGE : uint32_t
+{
+	BUFFER_USAGE_DEFAULT,
+	BUFFER_USAGE_IMMUTABLE,
+	BUFFER_USAGE_DYNAMIC
+};
+
+// DISCARD hands back fresh memory, NO_OVERWRITE promises not to touch data used by draws since the last discard
+enum MAP_TYPE : uint32_t
+{
+	MAP_TYPE_WRITE_DISCARD,
+	MAP_TYPE_WRITE_NO_OVERWRITE
+};
+
+enum INDEX_FORMAT : uint32_t
+{
+	INDEX_FORMAT_UINT16,
+	INDEX_FORMAT_UINT32
+};
+
+enum VERTEX_FORMAT : uint32_t
+{
+	VERTEX_FORMAT_FLOAT2,
+	VERTEX_FORMAT_FLOAT3,
+	VERTEX_FORMAT_FLOAT4,
+
+	// Normalized integers, read by the shaders as floats in [-1, 1] (SNORM) or [0, 1] (UNORM)
+	VERTEX_FORMAT_SHORT2_SNORM,
+	VERTEX_FORMAT_SHORT4_SNORM,
+	VERTEX_FORMAT_UBYTE4_UNORM
+};
+
+enum INPUT_CLASSIFICATION : uint32_t
+{
+	INPUT_CLASSIFICATION_PER_VERTEX,
+	INPUT_CLASSIFICATION_PER_INSTANCE
+};
+
+enum FILL_MODE : uint32_t
+{
+	FILL_MODE_SOLID,
+	FILL_MODE_WIREFRAME
+};
+
+enum CULL_MODE : uint32_t
+{
+	CULL_MODE_NONE,
+	CULL_MODE_FRONT,
+	CULL_MODE_BACK
+};
+
+enum COMPARISON_FUNC : uint32_t
+{
+	COMPARISON_FUNC_NEVER,
+	COMPARISON_FUNC_LESS,
+	COMPARISON_FUNC_EQUAL,
+	COMPARISON_FUNC_LESS_EQUAL,
+	COMPARISON_FUNC_GREATER,
+	COMPARISON_FUNC_NOT_EQUAL,
+	COMPARISON_FUNC_GREATER_EQUAL,
+	COMPARISON_FUNC_ALWAYS
+};
+
+enum BLEND : uint32_t
+{
+	BLEND_ZERO,
+	BLEND_ONE,
+	BLEND_SRC_ALPHA,
+	BLEND_INV_SRC_ALPHA
+};
+
+enum BLEND_OP : uint32_t
+{
+	BLEND_OP_ADD,
+	BLEND_OP_SUBTRACT,
+	BLEND_OP_MIN,
+	BLEND_OP_MAX
+};
+
+struct BufferHandle { uint32_t Id = 0; bool IsValid() const { return Id != 0; } };
+struct VertexShaderHandle { uint32_t Id = 0; bool IsValid() const { return Id != 0; } };
+struct PixelShaderHandle { uint32_t Id = 0; bool IsValid() const { return Id != 0; } };
+struct InputLayoutHandle { uint32_t Id = 0; bool IsValid() const { return Id != 0; } };
+struct RasterizerStateHandle { uint32_t Id = 0; bool IsValid() const { return Id != 0; } };
+struct DepthStencilStateHandle { uint32_t Id = 0; bool IsValid() const { return Id != 0; } };
+struct BlendStateHandle { uint32_t Id = 0; bool IsValid() const { return Id != 0; } };
+
+struct BufferDesc
+{
+	BUFFER_TYPE Type;
+	BUFFER_USAGE Usage;
+	uint32_t ByteWidth;
+};
+
+// ByteWidth of count elements of elementSize bytes without overflowing. False when the buffer would not fit in a BufferDesc.
+inline bool ComputeBufferByteWidth(uint64_t elementSize, uint64_t count, uint32_t& outByteWidth)
+{
+	if (elementSize == 0 || count > UINT32_MAX / elementSize)
+	{
+		return false;
+	}
+
+	outByteWidth = (uint32_t)(elementSize * count);
+	return true;
+}
+
+// Either FileName or SourceCode (null-terminated HLSL) is set
+struct ShaderDesc
+{
+	const char* FileName;
+	const char* SourceCode;
+	const char* EntryPoint;
+	const char* ShaderModel;
+};
+
+// Per-instance elements advance once every InstanceDataStepRate instances
+struct InputElementDesc
+{
+	const char* SemanticName;
+	uint32_t SemanticIndex;
+	VERTEX_FORMAT Format;
+	uint32_t InputSlot;
+	uint32_t AlignedByteOffset;
+	INPUT_CLASSIFICATION InputSlotClass = INPUT_CLASSIFICATION_PER_VERTEX;
+	uint32_t InstanceDataStepRate = 0;
+};
+
+struct RasterizerDesc
+{
+	FILL_MODE FillMode;
+	CULL_MODE CullMode;
+	bool bFrontCounterClockwise;
+	bool bDepthClipEnable;
+};
+
+// Stencil is always disabled
+struct DepthStencilDesc
+{
+	bool bDepthEnable;
+	bool bDepthWriteEnable;
+	COMPARISON_FUNC DepthFunc;
+};
+
+// One blend for color and alpha of the only render target, which is always written whole
+struct BlendDesc
+{
+	bool bBlendEnable;
+	BLEND SrcBlend;
+	BLEND DestBlend;
+	BLEND_OP BlendOp;
+};
+
+// Counters of the last presented frame
+struct RenderDeviceStats
+{
+	uint32_t DrawCount;
+	uint64_t InstanceCount;
+	uint64_t IndexCount;
+	// Binds issued to the context, and binds dropped because they would not have changed the bound state
+	uint32_t StateChangeCount;
+	uint32_t FilteredStateChangeCount;
+	uint32_t BufferUpdateCount;
+	uint64_t UploadBytes;
+	uint64_t ConstantUploadBytes;
+};
+
+// State objects asked for since the device was created, either created or handed back from the state cache
+struct StateCacheStats
+{
+	uint32_t CreatedCount;
+	uint32_t ReusedCount;
+};
+
+// State and draw calls of a device context, either the immediate one of a RenderDevice or a CommandList.
+// Primitive topology is always a triangle list. Invalid state handles bind the default state of Direct3D 11: solid fill
+// with back faces culled, depth test LESS with writes and no blending.
+// Every context drops the binds of values that are already bound before they reach the backend (see RenderStateFilter.h).
+class RenderContext
+{
+public:
+	virtual ~RenderContext() = default;
+
+	virtual void SetInputLayout(InputLayoutHandle inputLayout) = 0;
+	virtual void SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset) = 0;
+	virtual void SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset) = 0;
+	virtual void SetVertexShader(VertexShaderHandle vertexShader) = 0;
+	virtual void SetPixelShader(PixelShaderHandle pixelShader) = 0;
+	virtual void SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer) = 0;
+	virtual void SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer) = 0;
+	// Binds size bytes at offset, both multiples of CONSTANT_BUFFER_ALIGNMENT
+	virtual void SetVertexConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) = 0;
+	virtual void SetPixelConstantBufferRange(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size) = 0;
+	virtual void SetRasterizerState(RasterizerStateHandle rasterizerState) = 0;
+	virtual void SetDepthStencilState(DepthStencilStateHandle depthStencilState) = 0;
+	virtual void SetBlendState(BlendStateHandle blendState) = 0;
+
+	virtual void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) = 0;
+	virtual void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) = 0;
+};
+
+// Calls recorded apart from the immediate context and run by RenderDevice::ExecuteCommandList, a deferred context on Direct3D 11.
+// Lists can be recorded on any thread, but only by one thread at a time. Every recording starts from cleared state with nothing
+// bound, and executing a list leaves the state of the immediate context as it was. Buffers are only written by the immediate context.
+class CommandList : public RenderContext
+{
+public:
+	// Drops the calls of the previous recording
+	virtual void Begin() = 0;
+	virtual void End() = 0;
+
+	// Calls of the last recording, without the binds its state filter dropped
+	virtual uint32_t GetCommandCount() const = 0;
+	virtual uint32_t GetFilteredStateChangeCount() const = 0;
+};
+
+// Command lists of a frame, with the milliseconds spent recording all of them (on any number of threads) and executing them
+struct CommandListStats
+{
+	uint32_t ListCount;
+	uint64_t CommandCount;
+	double RecordTime;
+	double ExecuteTime;
+};
+
+class RenderDevice : public RenderContext
+{
+public:
+	virtual const char* GetName() const = 0;
+	virtual void Free() = 0;
+
+	// Resource creation. An invalid handle is returned on failure.
+	virtual BufferHandle CreateBuffer(const BufferDesc& desc, const void* initialData) = 0;
+	virtual VertexShaderHandle CreateVertexShader(const ShaderDesc& desc) = 0;
+	virtual PixelShaderHandle CreatePixelShader(const ShaderDesc& desc) = 0;
+	virtual InputLayoutHandle CreateInputLayout(const InputElementDesc* elements, uint32_t elementCount, VertexShaderHandle vertexShader) = 0;
+	// State objects are cached by descriptor, asking for a state equal to an existing one returns the same handle
+	virtual RasterizerStateHandle CreateRasterizerState(const RasterizerDesc& desc) = 0;
+	virtual DepthStencilStateHandle CreateDepthStencilState(const DepthStencilDesc& desc) = 0;
+	virtual BlendStateHandle CreateBlendState(const BlendDesc& desc) = 0;
+
+	// Owned by the device like the resources, nullptr on failure
+	virtual CommandList* CreateCommandList() = 0;
+
+	// Immediate context, with the state and draw calls of RenderContext.
+	// UpdateBuffer writes from the start of the buffer: DEFAULT buffers are updated in place and DYNAMIC buffers are
+	// mapped with discard. Constant buffers are always written whole.
+	virtual void UpdateBuffer(BufferHandle buffer, const void* data, uint32_t size) = 0;
+	// Writes size bytes at offset of a DYNAMIC buffer through a map of the given type
+	virtual void WriteBuffer(BufferHandle buffer, uint32_t offset, const void* data, uint32_t size, MAP_TYPE mapType) = 0;
+
+	virtual void Clear(const float color[4], float depth) = 0;
+	// Runs the last recording of commandList after everything submitted so far
+	virtual void ExecuteCommandList(CommandList* commandList) = 0;
+	virtual void Present() = 0;
+
+	virtual const RenderDeviceStats& GetFrameStats() const = 0;
+	virtual const StateCacheStats& GetStateCacheStats() const = 0;
+};
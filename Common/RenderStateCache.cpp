@@ -0,0 +1,55 @@
+#include "RenderStateCache.h"
+
+namespace
+{
+	enum STATE_KIND : uint64_t
+	{
+		STATE_KIND_RASTERIZER = 1,
+		STATE_KIND_DEPTH_STENCIL,
+		STATE_KIND_BLEND
+	};
+
+	constexpr uint32_t STATE_KIND_SHIFT = 56;
+}
+
+uint64_t ComputeStateKey(const RasterizerDesc& desc)
+{
+	return (uint64_t)STATE_KIND_RASTERIZER << STATE_KIND_SHIFT | (uint64_t)(desc.FillMode & 0xFF) | (uint64_t)(desc.CullMode & 0xFF) << 8 |
+		(uint64_t)desc.bFrontCounterClockwise << 16 | (uint64_t)desc.bDepthClipEnable << 17;
+}
+
+uint64_t ComputeStateKey(const DepthStencilDesc& desc)
+{
+	return (uint64_t)STATE_KIND_DEPTH_STENCIL << STATE_KIND_SHIFT | (uint64_t)desc.bDepthEnable | (uint64_t)desc.bDepthWriteEnable << 1 |
+		(uint64_t)(desc.DepthFunc & 0xFF) << 8;
+}
+
+uint64_t ComputeStateKey(const BlendDesc& desc)
+{
+	return (uint64_t)STATE_KIND_BLEND << STATE_KIND_SHIFT | (uint64_t)desc.bBlendEnable | (uint64_t)(desc.SrcBlend & 0xFF) << 8 |
+		(uint64_t)(desc.DestBlend & 0xFF) << 16 | (uint64_t)(desc.BlendOp & 0xFF) << 24;
+}
+
+uint32_t RenderStateCache::Find(uint64_t key)
+{
+	const auto found = Ids.find(key);
+	if (found == Ids.end())
+	{
+		return 0;
+	}
+
+	++Stats.ReusedCount;
+	return found->second;
+}
+
+void RenderStateCache::Add(uint64_t key, uint32_t id)
+{
+	Ids[key] = id;
+	++Stats.CreatedCount;
+}
+
+void RenderStateCache::Clear()
+{
+	Ids.clear();
+	Stats = StateCacheStats{};
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+
+#include "RenderDevice.h"
+
+// Every field of a state descriptor packed into one key, with the kind of state in the top byte. Enumerations take a byte
+// each, which holds every value they define, so equal keys mean equal descriptors.
+uint64_t ComputeStateKey(const RasterizerDesc& desc);
+uint64_t ComputeStateKey(const DepthStencilDesc& desc);
+uint64_t ComputeStateKey(const BlendDesc& desc);
+
+// Ids of the state objects of a device by key, so that creating a state equal to an existing one hands back that object
+// instead of a new one. Rasterizer, depth-stencil and blend states share one hash table.
+class RenderStateCache
+{
+public:
+	// Id of the object created for the key, 0 when there is none yet. A hit counts as a reuse.
+	uint32_t Find(uint64_t key);
+	void Add(uint64_t key, uint32_t id);
+	void Clear();
+
+	const StateCacheStats& GetStats() const { return Stats; }
+
+private:
+	// The keys are mostly zero bits, mixed so that every bit reaches the buckets
+	struct KeyHash
+	{
+		size_t operator()(uint64_t key) const { return (size_t)((key ^ key >> 29) * 0xBF58476D1CE4E5B9ull >> 32); }
+	};
+
+	std::unordered_map<uint64_t, uint32_t, KeyHash> Ids;
+	StateCacheStats Stats{};
+};
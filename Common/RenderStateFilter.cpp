@@ -0,0 +1,86 @@
+#include "RenderStateFilter.h"
+
+#include <string.h>
+
+// Nothing bound is handle 0, and no handle is ever UINT32_MAX
+void RenderStateFilter::Reset()
+{
+	memset(&State, 0, sizeof(State));
+}
+
+void RenderStateFilter::Invalidate()
+{
+	memset(&State, 0xFF, sizeof(State));
+}
+
+bool RenderStateFilter::SetInputLayout(InputLayoutHandle inputLayout)
+{
+	return Update(State.InputLayout, inputLayout.Id);
+}
+
+bool RenderStateFilter::SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset)
+{
+	return slot >= MAX_VERTEX_BUFFER_SLOTS || Update(State.VertexBuffers[slot], buffer.Id, stride, offset);
+}
+
+bool RenderStateFilter::SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset)
+{
+	return Update(State.IndexBuffer, buffer.Id, format, offset);
+}
+
+bool RenderStateFilter::SetVertexShader(VertexShaderHandle vertexShader)
+{
+	return Update(State.VertexShader, vertexShader.Id);
+}
+
+bool RenderStateFilter::SetPixelShader(PixelShaderHandle pixelShader)
+{
+	return Update(State.PixelShader, pixelShader.Id);
+}
+
+bool RenderStateFilter::SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	return slot >= MAX_CONSTANT_BUFFER_SLOTS || Update(State.VertexConstantBuffers[slot], buffer.Id, offset, size);
+}
+
+bool RenderStateFilter::SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size)
+{
+	return slot >= MAX_CONSTANT_BUFFER_SLOTS || Update(State.PixelConstantBuffers[slot], buffer.Id, offset, size);
+}
+
+bool RenderStateFilter::SetRasterizerState(RasterizerStateHandle rasterizerState)
+{
+	return Update(State.RasterizerState, rasterizerState.Id);
+}
+
+bool RenderStateFilter::SetDepthStencilState(DepthStencilStateHandle depthStencilState)
+{
+	return Update(State.DepthStencilState, depthStencilState.Id);
+}
+
+bool RenderStateFilter::SetBlendState(BlendStateHandle blendState)
+{
+	return Update(State.BlendState, blendState.Id);
+}
+
+bool RenderStateFilter::Update(Binding& binding, uint32_t id, uint32_t first, uint32_t second)
+{
+	if (binding.Id == id && binding.First == first && binding.Second == second)
+	{
+		return false;
+	}
+
+	binding = Binding{ id, first, second };
+	return true;
+}
+
+bool RenderStateFilter::Update(uint32_t& boundId, uint32_t id)
+{
+	if (boundId == id)
+	{
+		return false;
+	}
+
+	boundId = id;
+	return true;
+}
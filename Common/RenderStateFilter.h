@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "RenderDevice.h"
+
+// Copy of the state bound to one context (IA, VS, PS, RS and OM), kept in front of its calls to drop the binds that would
+// not change anything. Every Set stores the value and returns true when the call has to reach the context, false when the
+// value is bound already. Reset matches a cleared context with nothing bound, Invalidate forgets what is bound so that
+// every next call goes through. Slots past the limits of the context are never filtered.
+class RenderStateFilter
+{
+public:
+	static constexpr uint32_t MAX_VERTEX_BUFFER_SLOTS = 16;
+	static constexpr uint32_t MAX_CONSTANT_BUFFER_SLOTS = 14;
+
+	RenderStateFilter() { Reset(); }
+
+	void Reset();
+	void Invalidate();
+
+	bool SetInputLayout(InputLayoutHandle inputLayout);
+	bool SetVertexBuffer(uint32_t slot, BufferHandle buffer, uint32_t stride, uint32_t offset);
+	bool SetIndexBuffer(BufferHandle buffer, INDEX_FORMAT format, uint32_t offset);
+	bool SetVertexShader(VertexShaderHandle vertexShader);
+	bool SetPixelShader(PixelShaderHandle pixelShader);
+	// Size 0 binds the whole buffer
+	bool SetVertexConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size);
+	bool SetPixelConstantBuffer(uint32_t slot, BufferHandle buffer, uint32_t offset, uint32_t size);
+	bool SetRasterizerState(RasterizerStateHandle rasterizerState);
+	bool SetDepthStencilState(DepthStencilStateHandle depthStencilState);
+	bool SetBlendState(BlendStateHandle blendState);
+
+private:
+	// A buffer with two more values: stride and offset of a vertex buffer, format and offset of the index buffer,
+	// offset and size of a constant buffer
+	struct Binding
+	{
+		uint32_t Id;
+		uint32_t First;
+		uint32_t Second;
+	};
+
+	static bool Update(Binding& binding, uint32_t id, uint32_t first, uint32_t second);
+	static bool Update(uint32_t& boundId, uint32_t id);
+
+	// Every field is a plain uint32_t, so that Reset and Invalidate fill the whole state at once
+	struct BoundState
+	{
+		uint32_t InputLayout;
+		Binding VertexBuffers[MAX_VERTEX_BUFFER_SLOTS];
+		Binding IndexBuffer;
+		uint32_t VertexShader;
+		uint32_t PixelShader;
+		Binding VertexConstantBuffers[MAX_CONSTANT_BUFFER_SLOTS];
+		Binding PixelConstantBuffers[MAX_CONSTANT_BUFFER_SLOTS];
+		uint32_t RasterizerState;
+		uint32_t DepthStencilState;
+		uint32_t BlendState;
+	};
+
+	BoundState State;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "RenderDevice.h"
+
+enum INPUT_FLAGS : uint32_t
+{
+	INPUT_FLAGS_NONE = 0,
+	INPUT_FLAGS_1 = 1 << 0,
+	INPUT_FLAGS_2 = 1 << 1,
+	INPUT_FLAGS_A = 1 << 2,
+	INPUT_FLAGS_D = 1 << 3,
+	INPUT_FLAGS_E = 1 << 4,
+	INPUT_FLAGS_Q = 1 << 5,
+	INPUT_FLAGS_S = 1 << 6,
+	INPUT_FLAGS_W = 1 << 7,
+	INPUT_FLAGS_RBUTTON = 1 << 8
+};
+
+// Input gathered by the window (or scripted by the headless runner)
+struct InputState
+{
+	uint32_t Flags;
+	int32_t CursorX;
+	int32_t CursorY;
+
+	// Gamepad after the dead zone is applied. Triggers are in [0, 1] and thumb sticks in [-1, 1].
+	float LeftTrigger;
+	float RightTrigger;
+	float LeftThumbX;
+	float LeftThumbY;
+	float RightThumbX;
+	float RightThumbY;
+};
+
+// Platform-independent part of a sample: resources, Update and Render through a RenderDevice
+class Scene
+{
+public:
+	virtual ~Scene() = default;
+
+	virtual const char* GetName() const = 0;
+
+	virtual bool Init(RenderDevice* device, int32_t width, int32_t height) = 0;
+	virtual void Update(float deltaTime, const InputState& input) = 0;
+	virtual void Render() = 0;
+	virtual void Free() = 0;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <immintrin.h>
+
+// Thin wrapper over SSE2 / AVX2 registers so kernels can be written once for either width.
+// Build with /arch:AVX2 (MSVC) or -mavx2 (GCC, Clang) to get the 8-wide path.
+
+#if defined(__AVX2__)
+
+constexpr int32_t SIMD_WIDTH = 8;
+
+struct SimdFloat { __m256 v; };
+struct SimdInt { __m256i v; };
+
+inline SimdFloat SimdSet(float value) { return { _mm256_set1_ps(value) }; }
+inline SimdFloat SimdZero() { return { _mm256_setzero_ps() }; }
+inline SimdFloat SimdRamp() { return { _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f) }; }
+inline SimdFloat SimdLoad(const float* p) { return { _mm256_loadu_ps(p) }; }
+inline void SimdStore(float* p, SimdFloat a) { _mm256_storeu_ps(p, a.v); }
+
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return { _mm256_add_ps(a.v, b.v) }; }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return { _mm256_sub_ps(a.v, b.v) }; }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return { _mm256_mul_ps(a.v, b.v) }; }
+inline SimdFloat operator/(SimdFloat a, SimdFloat b) { return { _mm256_div_ps(a.v, b.v) }; }
+inline SimdFloat operator&(SimdFloat a, SimdFloat b) { return { _mm256_and_ps(a.v, b.v) }; }
+inline SimdFloat operator|(SimdFloat a, SimdFloat b) { return { _mm256_or_ps(a.v, b.v) }; }
+inline SimdFloat operator<(SimdFloat a, SimdFloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+inline SimdFloat operator<=(SimdFloat a, SimdFloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+inline SimdFloat operator>(SimdFloat a, SimdFloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+inline SimdFloat operator>=(SimdFloat a, SimdFloat b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { return { _mm256_min_ps(a.v, b.v) }; }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return { _mm256_max_ps(a.v, b.v) }; }
+inline SimdFloat SimdSqrt(SimdFloat a) { return { _mm256_sqrt_ps(a.v) }; }
+inline SimdFloat SimdAndNot(SimdFloat mask, SimdFloat a) { return { _mm256_andnot_ps(mask.v, a.v) }; }
+inline SimdFloat SimdSelect(SimdFloat mask, SimdFloat a, SimdFloat b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+inline int32_t SimdMoveMask(SimdFloat mask) { return _mm256_movemask_ps(mask.v); }
+
+inline SimdInt SimdSetInt(int32_t value) { return { _mm256_set1_epi32(value) }; }
+inline SimdInt SimdLoadInt(const void* p) { return { _mm256_loadu_si256((const __m256i*)p) }; }
+inline void SimdStoreInt(void* p, SimdInt a) { _mm256_storeu_si256((__m256i*)p, a.v); }
+inline SimdInt SimdConvertToInt(SimdFloat a) { return { _mm256_cvtps_epi32(a.v) }; }
+inline SimdInt SimdCastToInt(SimdFloat a) { return { _mm256_castps_si256(a.v) }; }
+inline SimdFloat SimdCastToFloat(SimdInt a) { return { _mm256_castsi256_ps(a.v) }; }
+inline SimdInt operator|(SimdInt a, SimdInt b) { return { _mm256_or_si256(a.v, b.v) }; }
+inline SimdInt SimdShiftLeft(SimdInt a, int32_t count) { return { _mm256_slli_epi32(a.v, count) }; }
+
+// Stores lane i of a, b, c and d as four consecutive floats at output + i * stride bytes
+inline void SimdStoreTransposed4(float* output, size_t stride, SimdFloat a, SimdFloat b, SimdFloat c, SimdFloat d)
+{
+	const __m256 ab0 = _mm256_unpacklo_ps(a.v, b.v);
+	const __m256 ab1 = _mm256_unpackhi_ps(a.v, b.v);
+	const __m256 cd0 = _mm256_unpacklo_ps(c.v, d.v);
+	const __m256 cd1 = _mm256_unpackhi_ps(c.v, d.v);
+	const __m256 lanes[4]
+	{
+		_mm256_shuffle_ps(ab0, cd0, _MM_SHUFFLE(1, 0, 1, 0)),
+		_mm256_shuffle_ps(ab0, cd0, _MM_SHUFFLE(3, 2, 3, 2)),
+		_mm256_shuffle_ps(ab1, cd1, _MM_SHUFFLE(1, 0, 1, 0)),
+		_mm256_shuffle_ps(ab1, cd1, _MM_SHUFFLE(3, 2, 3, 2))
+	};
+
+	uint8_t* bytes = (uint8_t*)output;
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		_mm_storeu_ps((float*)(bytes + i * stride), _mm256_castps256_ps128(lanes[i]));
+		_mm_storeu_ps((float*)(bytes + (i + 4) * stride), _mm256_extractf128_ps(lanes[i], 1));
+	}
+}
+
+#else
+
+constexpr int32_t SIMD_WIDTH = 4;
+
+struct SimdFloat { __m128 v; };
+struct SimdInt { __m128i v; };
+
+inline SimdFloat SimdSet(float value) { return { _mm_set1_ps(value) }; }
+inline SimdFloat SimdZero() { return { _mm_setzero_ps() }; }
+inline SimdFloat SimdRamp() { return { _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f) }; }
+inline SimdFloat SimdLoad(const float* p) { return { _mm_loadu_ps(p) }; }
+inline void SimdStore(float* p, SimdFloat a) { _mm_storeu_ps(p, a.v); }
+
+inline SimdFloat operator+(SimdFloat a, SimdFloat b) { return { _mm_add_ps(a.v, b.v) }; }
+inline SimdFloat operator-(SimdFloat a, SimdFloat b) { return { _mm_sub_ps(a.v, b.v) }; }
+inline SimdFloat operator*(SimdFloat a, SimdFloat b) { return { _mm_mul_ps(a.v, b.v) }; }
+inline SimdFloat operator/(SimdFloat a, SimdFloat b) { return { _mm_div_ps(a.v, b.v) }; }
+inline SimdFloat operator&(SimdFloat a, SimdFloat b) { return { _mm_and_ps(a.v, b.v) }; }
+inline SimdFloat operator|(SimdFloat a, SimdFloat b) { return { _mm_or_ps(a.v, b.v) }; }
+inline SimdFloat operator<(SimdFloat a, SimdFloat b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline SimdFloat operator<=(SimdFloat a, SimdFloat b) { return { _mm_cmple_ps(a.v, b.v) }; }
+inline SimdFloat operator>(SimdFloat a, SimdFloat b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+inline SimdFloat operator>=(SimdFloat a, SimdFloat b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+
+inline SimdFloat SimdMin(SimdFloat a, SimdFloat b) { return { _mm_min_ps(a.v, b.v) }; }
+inline SimdFloat SimdMax(SimdFloat a, SimdFloat b) { return { _mm_max_ps(a.v, b.v) }; }
+inline SimdFloat SimdSqrt(SimdFloat a) { return { _mm_sqrt_ps(a.v) }; }
+inline SimdFloat SimdAndNot(SimdFloat mask, SimdFloat a) { return { _mm_andnot_ps(mask.v, a.v) }; }
+inline SimdFloat SimdSelect(SimdFloat mask, SimdFloat a, SimdFloat b) { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+inline int32_t SimdMoveMask(SimdFloat mask) { return _mm_movemask_ps(mask.v); }
+
+inline SimdInt SimdSetInt(int32_t value) { return { _mm_set1_epi32(value) }; }
+inline SimdInt SimdLoadInt(const void* p) { return { _mm_loadu_si128((const __m128i*)p) }; }
+inline void SimdStoreInt(void* p, SimdInt a) { _mm_storeu_si128((__m128i*)p, a.v); }
+inline SimdInt SimdConvertToInt(SimdFloat a) { return { _mm_cvtps_epi32(a.v) }; }
+inline SimdInt SimdCastToInt(SimdFloat a) { return { _mm_castps_si128(a.v) }; }
+inline SimdFloat SimdCastToFloat(SimdInt a) { return { _mm_castsi128_ps(a.v) }; }
+inline SimdInt operator|(SimdInt a, SimdInt b) { return { _mm_or_si128(a.v, b.v) }; }
+inline SimdInt SimdShiftLeft(SimdInt a, int32_t count) { return { _mm_slli_epi32(a.v, count) }; }
+
+// Stores lane i of a, b, c and d as four consecutive floats at output + i * stride bytes
+inline void SimdStoreTransposed4(float* output, size_t stride, SimdFloat a, SimdFloat b, SimdFloat c, SimdFloat d)
+{
+	__m128 lanes[4]{ a.v, b.v, c.v, d.v };
+	_MM_TRANSPOSE4_PS(lanes[0], lanes[1], lanes[2], lanes[3]);
+
+	uint8_t* bytes = (uint8_t*)output;
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		_mm_storeu_ps((float*)(bytes + i * stride), lanes[i]);
+	}
+}
+
+#endif
+
+inline SimdFloat SimdSaturate(SimdFloat a) { return SimdMin(SimdMax(a, SimdZero()), SimdSet(1.0f)); }
+
+// Lane numbers of the set bits of every SIMD_WIDTH-bit mask, in ascending order, and their count
+struct SimdCompactTable
+{
+	uint8_t Lanes[1 << SIMD_WIDTH][8];
+	uint8_t Counts[1 << SIMD_WIDTH];
+
+	constexpr SimdCompactTable()
+		: Lanes(), Counts()
+	{
+		for (int32_t mask = 0; mask < (1 << SIMD_WIDTH); ++mask)
+		{
+			for (int32_t lane = 0; lane < SIMD_WIDTH; ++lane)
+			{
+				if (mask & (1 << lane))
+				{
+					Lanes[mask][Counts[mask]++] = (uint8_t)lane;
+				}
+			}
+		}
+	}
+};
+
+inline constexpr SimdCompactTable SIMD_COMPACT_TABLE{};
+
+// Writes firstIndex + lane for every lane set in mask to consecutive entries of output and returns how many.
+// Always stores SIMD_WIDTH entries, so output needs room for that many.
+inline int32_t SimdStoreCompactIndices(uint32_t* output, uint32_t firstIndex, int32_t mask)
+{
+	const SimdCompactTable& table = SIMD_COMPACT_TABLE;
+#if defined(__AVX2__)
+	const __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)table.Lanes[mask]));
+	_mm256_storeu_si256((__m256i*)output, _mm256_add_epi32(lanes, _mm256_set1_epi32((int32_t)firstIndex)));
+#else
+	const __m128i lanes = _mm_setr_epi32(table.Lanes[mask][0], table.Lanes[mask][1], table.Lanes[mask][2], table.Lanes[mask][3]);
+	_mm_storeu_si128((__m128i*)output, _mm_add_epi32(lanes, _mm_set1_epi32((int32_t)firstIndex)));
+#endif
+	return table.Counts[mask];
+}
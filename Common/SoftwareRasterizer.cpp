@@ -0,0 +1,689 @@
+#include "SoftwareRasterizer.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <bitset>
+#include <iterator>
+#include <chrono>
+
+#include "Simd.h"
+
+namespace
+{
+	constexpr uint32_t VERTEX_CHUNK_SIZE = 1024;
+	constexpr uint32_t TRIANGLE_CHUNK_SIZE = 256;
+	constexpr uint32_t MAX_BATCH_VERTEX_COUNT = 1 << 16;
+
+	// Clip space extent kept before triangles are clipped against the side planes
+	constexpr float GUARD_BAND = 4.0f;
+
+	enum CLIP_FLAGS : uint32_t
+	{
+		CLIP_FLAGS_NONE = 0,
+		CLIP_FLAGS_NEAR = 1 << 0,
+		CLIP_FLAGS_LEFT = 1 << 1,
+		CLIP_FLAGS_RIGHT = 1 << 2,
+		CLIP_FLAGS_BOTTOM = 1 << 3,
+		CLIP_FLAGS_TOP = 1 << 4
+	};
+
+	constexpr Float4 CLIP_PLANES[]
+	{
+		{ 0.0f, 0.0f, 1.0f, 0.0f },
+		{ 1.0f, 0.0f, 0.0f, GUARD_BAND },
+		{ -1.0f, 0.0f, 0.0f, GUARD_BAND },
+		{ 0.0f, 1.0f, 0.0f, GUARD_BAND },
+		{ 0.0f, -1.0f, 0.0f, GUARD_BAND }
+	};
+	constexpr int32_t MAX_CLIP_VERTICES = 3 + (int32_t)std::size(CLIP_PLANES);
+
+	using ShadedVertex = SoftwareRasterizer::ShadedVertex;
+
+	double GetElapsedMilliseconds(std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	uint32_t ReadIndex(const void* indices, uint32_t indexSize, size_t i)
+	{
+		return indexSize == sizeof(uint16_t) ? ((const uint16_t*)indices)[i] : ((const uint32_t*)indices)[i];
+	}
+
+	uint32_t PackColor(float r, float g, float b, float a)
+	{
+		const auto toUnorm = [](float value) { return (uint32_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); };
+		return toUnorm(r) | (toUnorm(g) << 8) | (toUnorm(b) << 16) | (toUnorm(a) << 24);
+	}
+
+	float PlaneDistance(const Float4& position, const Float4& plane)
+	{
+		return position.x * plane.x + position.y * plane.y + position.z * plane.z + position.w * plane.w;
+	}
+
+	uint32_t ComputeClipFlags(const Float4& position)
+	{
+		uint32_t flags = CLIP_FLAGS_NONE;
+		for (int32_t planeIndex = 0; planeIndex < (int32_t)std::size(CLIP_PLANES); ++planeIndex)
+		{
+			if (PlaneDistance(position, CLIP_PLANES[planeIndex]) < 0.0f)
+			{
+				flags |= 1 << planeIndex;
+			}
+		}
+		return flags;
+	}
+
+	// Outside the view frustum (not the guard band), used for trivial rejection
+	uint32_t ComputeFrustumFlags(const Float4& position)
+	{
+		uint32_t flags = 0;
+		flags |= position.x < -position.w ? 1 << 0 : 0;
+		flags |= position.x > position.w ? 1 << 1 : 0;
+		flags |= position.y < -position.w ? 1 << 2 : 0;
+		flags |= position.y > position.w ? 1 << 3 : 0;
+		flags |= position.z < 0.0f ? 1 << 4 : 0;
+		flags |= position.z > position.w ? 1 << 5 : 0;
+		return flags;
+	}
+
+	Float3 Lerp(const Float3& a, const Float3& b, float t)
+	{
+		return a + (b - a) * t;
+	}
+
+	ShadedVertex Lerp(const ShadedVertex& a, const ShadedVertex& b, float t)
+	{
+		ShadedVertex result;
+		result.Position.x = a.Position.x + (b.Position.x - a.Position.x) * t;
+		result.Position.y = a.Position.y + (b.Position.y - a.Position.y) * t;
+		result.Position.z = a.Position.z + (b.Position.z - a.Position.z) * t;
+		result.Position.w = a.Position.w + (b.Position.w - a.Position.w) * t;
+		result.Normal = Lerp(a.Normal, b.Normal, t);
+		result.LightDirection = Lerp(a.LightDirection, b.LightDirection, t);
+		result.ViewDirection = Lerp(a.ViewDirection, b.ViewDirection, t);
+		return result;
+	}
+
+	// Sutherland-Hodgman against a single plane, keeps the side where PlaneDistance >= 0
+	int32_t ClipPolygon(const ShadedVertex* input, int32_t inputCount, const Float4& plane, ShadedVertex* output)
+	{
+		int32_t outputCount = 0;
+		for (int32_t i = 0; i < inputCount; ++i)
+		{
+			const ShadedVertex& current = input[i];
+			const ShadedVertex& next = input[(i + 1) % inputCount];
+			const float currentDistance = PlaneDistance(current.Position, plane);
+			const float nextDistance = PlaneDistance(next.Position, plane);
+
+			if (currentDistance >= 0.0f)
+			{
+				output[outputCount++] = current;
+			}
+			if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+			{
+				output[outputCount++] = Lerp(current, next, currentDistance / (currentDistance - nextDistance));
+			}
+		}
+		return outputCount;
+	}
+}
+
+bool SoftwareRasterizer::Init(int32_t width, int32_t height, uint32_t threadCount)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	Width = width;
+	Height = height;
+	TileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	TileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+	// Rows are padded to whole tiles so SIMD loads never run past the end of a row
+	Stride = TileCountX * TILE_SIZE;
+	ColorBuffer.assign((size_t)Stride * TileCountY * TILE_SIZE, 0);
+	DepthBuffer.assign((size_t)Stride * TileCountY * TILE_SIZE, 1.0f);
+
+	if (!Workers.Init(threadCount))
+	{
+		return false;
+	}
+	Counters.resize(Workers.GetThreadCount());
+
+	ResetStats();
+
+	return true;
+}
+
+void SoftwareRasterizer::Free()
+{
+	Workers.Free();
+
+	ColorBuffer.clear();
+	DepthBuffer.clear();
+	ShadedVertices.clear();
+	ChunkTriangles.clear();
+	ChunkBins.clear();
+	Counters.clear();
+}
+
+void SoftwareRasterizer::ResetStats()
+{
+	Stats = RasterizerStats{};
+	for (ThreadCounters& counters : Counters)
+	{
+		counters.ShadedPixelCount = 0;
+	}
+}
+
+void SoftwareRasterizer::Clear(const float color[4], float depth)
+{
+	const auto beginTime = std::chrono::steady_clock::now();
+
+	const uint32_t packedColor = PackColor(color[0], color[1], color[2], color[3]);
+
+	Workers.ParallelFor((uint32_t)TileCountY, [&](uint32_t tileY, uint32_t)
+	{
+		const size_t begin = (size_t)tileY * TILE_SIZE * Stride;
+		const size_t end = begin + (size_t)TILE_SIZE * Stride;
+		std::fill(ColorBuffer.begin() + begin, ColorBuffer.begin() + end, packedColor);
+		std::fill(DepthBuffer.begin() + begin, DepthBuffer.begin() + end, depth);
+	});
+
+	Stats.ClearTime += GetElapsedMilliseconds(beginTime);
+}
+
+void SoftwareRasterizer::DrawIndexedInstanced(const VertexData* vertices, uint32_t vertexCount, const void* indices, uint32_t indexSize, uint32_t indexCount,
+	const InstanceData* instances, uint32_t instanceCount, const LightingConstants& constants)
+{
+	Draw({ vertices, nullptr, VertexQuantization{}, vertexCount }, indices, indexSize, indexCount, instances, instanceCount, constants);
+}
+
+void SoftwareRasterizer::DrawIndexedInstanced(const QuantizedVertexData* vertices, const VertexQuantization& quantization, uint32_t vertexCount, const void* indices,
+	uint32_t indexSize, uint32_t indexCount, const InstanceData* instances, uint32_t instanceCount, const LightingConstants& constants)
+{
+	Draw({ nullptr, vertices, quantization, vertexCount }, indices, indexSize, indexCount, instances, instanceCount, constants);
+}
+
+void SoftwareRasterizer::Draw(const VertexInput& vertices, const void* indices, uint32_t indexSize, uint32_t indexCount, const InstanceData* instances, uint32_t instanceCount,
+	const LightingConstants& constants)
+{
+	const uint32_t vertexCount = vertices.Count;
+	const uint32_t triangleCount = indexCount / 3;
+	if (vertexCount == 0 || triangleCount == 0 || instanceCount == 0)
+	{
+		return;
+	}
+
+	++Stats.DrawCount;
+	Stats.InstanceCount += instanceCount;
+	Stats.VertexCount += (uint64_t)vertexCount * instanceCount;
+	Stats.TriangleCount += (uint64_t)triangleCount * instanceCount;
+
+	// Instances are shaded and binned in batches so the shaded vertices stay bounded
+	const uint32_t batchSize = std::max(MAX_BATCH_VERTEX_COUNT / vertexCount, 1u);
+	for (uint32_t firstInstance = 0; firstInstance < instanceCount; firstInstance += batchSize)
+	{
+		DrawBatch(vertices, indices, indexSize, triangleCount, instances + firstInstance, std::min(batchSize, instanceCount - firstInstance), constants);
+	}
+}
+
+void SoftwareRasterizer::DrawBatch(const VertexInput& vertices, const void* indices, uint32_t indexSize, uint32_t triangleCount,
+	const InstanceData* instances, uint32_t instanceCount, const LightingConstants& constants)
+{
+	const uint32_t vertexCount = vertices.Count;
+
+	// Vertex shader
+	auto beginTime = std::chrono::steady_clock::now();
+
+	const uint32_t batchVertexCount = vertexCount * instanceCount;
+	ShadedVertices.resize(batchVertexCount);
+
+	const uint32_t vertexChunkCount = (batchVertexCount + VERTEX_CHUNK_SIZE - 1) / VERTEX_CHUNK_SIZE;
+	Workers.ParallelFor(vertexChunkCount, [&](uint32_t chunkIndex, uint32_t)
+	{
+		const uint32_t begin = chunkIndex * VERTEX_CHUNK_SIZE;
+		ShadeVertices(vertices, instances, begin, std::min(begin + VERTEX_CHUNK_SIZE, batchVertexCount), constants);
+	});
+
+	Stats.VertexTime += GetElapsedMilliseconds(beginTime);
+
+	// Clipping, triangle setup and binning
+	beginTime = std::chrono::steady_clock::now();
+
+	const uint32_t batchTriangleCount = triangleCount * instanceCount;
+	const uint32_t tileCount = (uint32_t)(TileCountX * TileCountY);
+	const uint32_t triangleChunkCount = (batchTriangleCount + TRIANGLE_CHUNK_SIZE - 1) / TRIANGLE_CHUNK_SIZE;
+	if (ChunkTriangles.size() < triangleChunkCount)
+	{
+		ChunkTriangles.resize(triangleChunkCount);
+		ChunkBins.resize((size_t)triangleChunkCount * tileCount);
+	}
+
+	Workers.ParallelFor(triangleChunkCount, [&](uint32_t chunkIndex, uint32_t)
+	{
+		const uint32_t begin = chunkIndex * TRIANGLE_CHUNK_SIZE;
+		SetupTriangles(indices, indexSize, triangleCount, vertexCount, instances, chunkIndex, begin, std::min(begin + TRIANGLE_CHUNK_SIZE, batchTriangleCount));
+	});
+
+	for (uint32_t chunkIndex = 0; chunkIndex < triangleChunkCount; ++chunkIndex)
+	{
+		Stats.BinnedTriangleCount += ChunkTriangles[chunkIndex].size();
+	}
+
+	Stats.SetupTime += GetElapsedMilliseconds(beginTime);
+
+	// Rasterization and pixel shader, one task per tile
+	beginTime = std::chrono::steady_clock::now();
+
+	Workers.ParallelFor(tileCount, [&](uint32_t tileIndex, uint32_t threadIndex)
+	{
+		RasterizeTile(tileIndex, triangleChunkCount, threadIndex);
+	});
+
+	Stats.ShadedPixelCount = 0;
+	for (const ThreadCounters& counters : Counters)
+	{
+		Stats.ShadedPixelCount += counters.ShadedPixelCount;
+	}
+
+	Stats.RasterTime += GetElapsedMilliseconds(beginTime);
+}
+
+void SoftwareRasterizer::ShadeVertices(const VertexInput& vertices, const InstanceData* instances, uint32_t begin, uint32_t end, const LightingConstants& constants)
+{
+	const Float3 lightPosition = ToFloat3(constants.WorldLightPosition);
+	const Float3 cameraPosition = ToFloat3(constants.WorldCameraPosition);
+	const uint32_t vertexCount = vertices.Count;
+
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		const uint32_t vertexIndex = i % vertexCount;
+		const ObjectMatrices& matrices = instances[i / vertexCount].Matrices;
+		Float4 position;
+		Float4 normal;
+		if (vertices.QuantizedVertices)
+		{
+			const QuantizedVertexData& vertex = vertices.QuantizedVertices[vertexIndex];
+			position = ToFloat4(DecodePosition(vertex.Position, vertices.Quantization), 1.0f);
+			normal = ToFloat4(DecodeOctahedralNormal(vertex.Normal), 0.0f);
+		}
+		else
+		{
+			position = ToFloat4(vertices.Vertices[vertexIndex].Position, 1.0f);
+			normal = ToFloat4(vertices.Vertices[vertexIndex].Normal, 0.0f);
+		}
+
+		// Matrices are stored by columns, as in the shader
+		const Float3 worldPosition{ Dot(position, matrices.World[0]), Dot(position, matrices.World[1]), Dot(position, matrices.World[2]) };
+
+		ShadedVertex& output = ShadedVertices[i];
+		output.LightDirection = Normalize(worldPosition - lightPosition);
+		output.ViewDirection = Normalize(worldPosition - cameraPosition);
+		output.Position = {
+			Dot(position, matrices.WorldViewProjection[0]),
+			Dot(position, matrices.WorldViewProjection[1]),
+			Dot(position, matrices.WorldViewProjection[2]),
+			Dot(position, matrices.WorldViewProjection[3])
+		};
+		output.Normal = Normalize(Float3{ Dot(normal, matrices.Normal[0]), Dot(normal, matrices.Normal[1]), Dot(normal, matrices.Normal[2]) });
+	}
+}
+
+void SoftwareRasterizer::SetupTriangles(const void* indices, uint32_t indexSize, uint32_t triangleCount, uint32_t vertexCount, const InstanceData* instances,
+	uint32_t chunkIndex, uint32_t triangleBegin, uint32_t triangleEnd)
+{
+	const uint32_t tileCount = (uint32_t)(TileCountX * TileCountY);
+
+	ChunkTriangles[chunkIndex].clear();
+	for (uint32_t tileIndex = 0; tileIndex < tileCount; ++tileIndex)
+	{
+		ChunkBins[(size_t)chunkIndex * tileCount + tileIndex].clear();
+	}
+
+	for (uint32_t batchTriangleIndex = triangleBegin; batchTriangleIndex < triangleEnd; ++batchTriangleIndex)
+	{
+		const uint32_t instanceIndex = batchTriangleIndex / triangleCount;
+		const uint32_t triangleIndex = batchTriangleIndex - instanceIndex * triangleCount;
+		const ShadedVertex* instanceVertices = ShadedVertices.data() + (size_t)instanceIndex * vertexCount;
+		const Float4& color = instances[instanceIndex].Color;
+
+		const size_t firstIndex = (size_t)triangleIndex * 3;
+		const ShadedVertex& v0 = instanceVertices[ReadIndex(indices, indexSize, firstIndex + 0)];
+		const ShadedVertex& v1 = instanceVertices[ReadIndex(indices, indexSize, firstIndex + 1)];
+		const ShadedVertex& v2 = instanceVertices[ReadIndex(indices, indexSize, firstIndex + 2)];
+
+		if (ComputeFrustumFlags(v0.Position) & ComputeFrustumFlags(v1.Position) & ComputeFrustumFlags(v2.Position))
+		{
+			continue;
+		}
+
+		const uint32_t clipFlags = ComputeClipFlags(v0.Position) | ComputeClipFlags(v1.Position) | ComputeClipFlags(v2.Position);
+		if (clipFlags == CLIP_FLAGS_NONE)
+		{
+			SetupTriangle(v0, v1, v2, color, chunkIndex);
+			continue;
+		}
+
+		ShadedVertex polygons[2][MAX_CLIP_VERTICES];
+		polygons[0][0] = v0;
+		polygons[0][1] = v1;
+		polygons[0][2] = v2;
+
+		int32_t vertexCount = 3;
+		int32_t current = 0;
+		for (int32_t planeIndex = 0; planeIndex < (int32_t)std::size(CLIP_PLANES) && vertexCount >= 3; ++planeIndex)
+		{
+			if (clipFlags & (1 << planeIndex))
+			{
+				vertexCount = ClipPolygon(polygons[current], vertexCount, CLIP_PLANES[planeIndex], polygons[current ^ 1]);
+				current ^= 1;
+			}
+		}
+
+		for (int32_t i = 2; i < vertexCount; ++i)
+		{
+			SetupTriangle(polygons[current][0], polygons[current][i - 1], polygons[current][i], color, chunkIndex);
+		}
+	}
+}
+
+void SoftwareRasterizer::SetupTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, const Float4& color, uint32_t chunkIndex)
+{
+	const ShadedVertex* vertices[3]{ &v0, &v1, &v2 };
+
+	float screenX[3], screenY[3];
+	float values[PLANE_COUNT][3];
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		const ShadedVertex& vertex = *vertices[i];
+		const float invW = 1.0f / vertex.Position.w;
+
+		screenX[i] = (vertex.Position.x * invW * 0.5f + 0.5f) * Width;
+		screenY[i] = (0.5f - vertex.Position.y * invW * 0.5f) * Height;
+
+		values[0][i] = vertex.Position.z * invW;
+		values[1][i] = invW;
+		values[2][i] = vertex.Normal.x * invW;
+		values[3][i] = vertex.Normal.y * invW;
+		values[4][i] = vertex.Normal.z * invW;
+		values[5][i] = vertex.LightDirection.x * invW;
+		values[6][i] = vertex.LightDirection.y * invW;
+		values[7][i] = vertex.LightDirection.z * invW;
+		values[8][i] = vertex.ViewDirection.x * invW;
+		values[9][i] = vertex.ViewDirection.y * invW;
+		values[10][i] = vertex.ViewDirection.z * invW;
+	}
+
+	RasterTriangle triangle;
+
+	// Edge i is opposite to vertex i, so the normalized edge functions are the barycentric coordinates
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		const int32_t a = (i + 1) % 3;
+		const int32_t b = (i + 2) % 3;
+		triangle.EdgeA[i] = screenY[a] - screenY[b];
+		triangle.EdgeB[i] = screenX[b] - screenX[a];
+		triangle.EdgeC[i] = screenX[a] * screenY[b] - screenY[a] * screenX[b];
+	}
+
+	float area = triangle.EdgeA[0] * screenX[0] + triangle.EdgeB[0] * screenY[0] + triangle.EdgeC[0];
+	if (area == 0.0f)
+	{
+		return;
+	}
+
+	// CULL_NONE, so both windings are rasterized
+	if (area < 0.0f)
+	{
+		area = -area;
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			triangle.EdgeA[i] = -triangle.EdgeA[i];
+			triangle.EdgeB[i] = -triangle.EdgeB[i];
+			triangle.EdgeC[i] = -triangle.EdgeC[i];
+		}
+	}
+
+	// Pixel x is covered when its center x + 0.5 lies inside the triangle
+	const float minScreenX = std::min({ screenX[0], screenX[1], screenX[2] });
+	const float maxScreenX = std::max({ screenX[0], screenX[1], screenX[2] });
+	const float minScreenY = std::min({ screenY[0], screenY[1], screenY[2] });
+	const float maxScreenY = std::max({ screenY[0], screenY[1], screenY[2] });
+	triangle.MinX = std::max((int32_t)ceilf(minScreenX - 0.5f), 0);
+	triangle.MaxX = std::min((int32_t)floorf(maxScreenX - 0.5f), Width - 1);
+	triangle.MinY = std::max((int32_t)ceilf(minScreenY - 0.5f), 0);
+	triangle.MaxY = std::min((int32_t)floorf(maxScreenY - 0.5f), Height - 1);
+	if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+	{
+		return;
+	}
+
+	const float invArea = 1.0f / area;
+	for (int32_t plane = 0; plane < PLANE_COUNT; ++plane)
+	{
+		const float* value = values[plane];
+		triangle.PlaneDx[plane] = (value[0] * triangle.EdgeA[0] + value[1] * triangle.EdgeA[1] + value[2] * triangle.EdgeA[2]) * invArea;
+		triangle.PlaneDy[plane] = (value[0] * triangle.EdgeB[0] + value[1] * triangle.EdgeB[1] + value[2] * triangle.EdgeB[2]) * invArea;
+		triangle.PlaneC[plane] = (value[0] * triangle.EdgeC[0] + value[1] * triangle.EdgeC[1] + value[2] * triangle.EdgeC[2]) * invArea;
+	}
+
+	triangle.Color[0] = color.x;
+	triangle.Color[1] = color.y;
+	triangle.Color[2] = color.z;
+
+	std::vector<RasterTriangle>& triangles = ChunkTriangles[chunkIndex];
+	const uint32_t triangleIndex = (uint32_t)triangles.size();
+	triangles.push_back(triangle);
+
+	// Bin into every tile that the triangle can touch
+	const uint32_t tileCount = (uint32_t)(TileCountX * TileCountY);
+	const int32_t minTileX = triangle.MinX / TILE_SIZE;
+	const int32_t maxTileX = triangle.MaxX / TILE_SIZE;
+	const int32_t minTileY = triangle.MinY / TILE_SIZE;
+	const int32_t maxTileY = triangle.MaxY / TILE_SIZE;
+	for (int32_t tileY = minTileY; tileY <= maxTileY; ++tileY)
+	{
+		for (int32_t tileX = minTileX; tileX <= maxTileX; ++tileX)
+		{
+			const float tileMinX = tileX * TILE_SIZE + 0.5f;
+			const float tileMaxX = tileMinX + TILE_SIZE - 1.0f;
+			const float tileMinY = tileY * TILE_SIZE + 0.5f;
+			const float tileMaxY = tileMinY + TILE_SIZE - 1.0f;
+
+			bool bOverlaps = true;
+			for (int32_t i = 0; i < 3 && bOverlaps; ++i)
+			{
+				const float x = triangle.EdgeA[i] > 0.0f ? tileMaxX : tileMinX;
+				const float y = triangle.EdgeB[i] > 0.0f ? tileMaxY : tileMinY;
+				bOverlaps = triangle.EdgeA[i] * x + triangle.EdgeB[i] * y + triangle.EdgeC[i] >= 0.0f;
+			}
+
+			if (bOverlaps)
+			{
+				ChunkBins[(size_t)chunkIndex * tileCount + tileY * TileCountX + tileX].push_back(triangleIndex);
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::RasterizeTile(uint32_t tileIndex, uint32_t chunkCount, uint32_t threadIndex)
+{
+	const uint32_t tileCount = (uint32_t)(TileCountX * TileCountY);
+	const int32_t tileMinX = (int32_t)(tileIndex % TileCountX) * TILE_SIZE;
+	const int32_t tileMinY = (int32_t)(tileIndex / TileCountX) * TILE_SIZE;
+	const int32_t tileMaxX = std::min(tileMinX + TILE_SIZE, Width) - 1;
+	const int32_t tileMaxY = std::min(tileMinY + TILE_SIZE, Height) - 1;
+
+	// Chunks are visited in submission order so primitive order is preserved inside a tile
+	for (uint32_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+	{
+		const std::vector<RasterTriangle>& triangles = ChunkTriangles[chunkIndex];
+		for (uint32_t triangleIndex : ChunkBins[(size_t)chunkIndex * tileCount + tileIndex])
+		{
+			RasterizeTriangle(triangles[triangleIndex], tileMinX, tileMinY, tileMaxX, tileMaxY, threadIndex);
+		}
+	}
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const RasterTriangle& triangle, int32_t tileMinX, int32_t tileMinY, int32_t tileMaxX, int32_t tileMaxY, uint32_t threadIndex)
+{
+	const int32_t minX = std::max(triangle.MinX, tileMinX);
+	const int32_t maxX = std::min(triangle.MaxX, tileMaxX);
+	const int32_t minY = std::max(triangle.MinY, tileMinY);
+	const int32_t maxY = std::min(triangle.MaxY, tileMaxY);
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+
+	// Tiles start on a multiple of SIMD_WIDTH, so blocks never straddle two tiles
+	const int32_t startX = tileMinX + ((minX - tileMinX) & ~(SIMD_WIDTH - 1));
+
+	const SimdFloat ramp = SimdRamp();
+	const SimdFloat zero = SimdZero();
+	const SimdFloat one = SimdSet(1.0f);
+	const SimdFloat two = SimdSet(2.0f);
+	const SimdFloat ambient = SimdSet(0.03f);
+	const SimdFloat unormScale = SimdSet(255.0f);
+	const SimdFloat width = SimdSet((float)Width);
+	const SimdInt alpha = SimdSetInt((int32_t)0xFF000000);
+	const SimdFloat colorR = SimdSet(triangle.Color[0]);
+	const SimdFloat colorG = SimdSet(triangle.Color[1]);
+	const SimdFloat colorB = SimdSet(triangle.Color[2]);
+
+	const SimdFloat edgeA0 = SimdSet(triangle.EdgeA[0]);
+	const SimdFloat edgeA1 = SimdSet(triangle.EdgeA[1]);
+	const SimdFloat edgeA2 = SimdSet(triangle.EdgeA[2]);
+
+	uint64_t shadedPixelCount = 0;
+
+	for (int32_t y = minY; y <= maxY; ++y)
+	{
+		const float centerY = y + 0.5f;
+		const SimdFloat edgeRow0 = SimdSet(triangle.EdgeB[0] * centerY + triangle.EdgeC[0]);
+		const SimdFloat edgeRow1 = SimdSet(triangle.EdgeB[1] * centerY + triangle.EdgeC[1]);
+		const SimdFloat edgeRow2 = SimdSet(triangle.EdgeB[2] * centerY + triangle.EdgeC[2]);
+
+		float* depthRow = DepthBuffer.data() + (size_t)y * Stride;
+		uint32_t* colorRow = ColorBuffer.data() + (size_t)y * Stride;
+
+		for (int32_t x = startX; x <= maxX; x += SIMD_WIDTH)
+		{
+			const SimdFloat centerX = SimdSet(x + 0.5f) + ramp;
+
+			const SimdFloat edge0 = edgeA0 * centerX + edgeRow0;
+			const SimdFloat edge1 = edgeA1 * centerX + edgeRow1;
+			const SimdFloat edge2 = edgeA2 * centerX + edgeRow2;
+			SimdFloat mask = (edge0 >= zero) & (edge1 >= zero) & (edge2 >= zero) & (centerX < width);
+			if (!SimdMoveMask(mask))
+			{
+				continue;
+			}
+
+			const auto plane = [&](int32_t index)
+			{
+				return SimdSet(triangle.PlaneDx[index]) * centerX + SimdSet(triangle.PlaneDy[index] * centerY + triangle.PlaneC[index]);
+			};
+
+			// Depth clip and depth test (D3D11_COMPARISON_LESS)
+			const SimdFloat depth = plane(0);
+			const SimdFloat storedDepth = SimdLoad(depthRow + x);
+			mask = mask & (depth >= zero) & (depth <= one) & (depth < storedDepth);
+
+			const int32_t laneMask = SimdMoveMask(mask);
+			if (!laneMask)
+			{
+				continue;
+			}
+			shadedPixelCount += std::bitset<32>((uint32_t)laneMask).count();
+
+			// Perspective-correct attributes
+			const SimdFloat w = one / plane(1);
+			const SimdFloat normalX = plane(2) * w;
+			const SimdFloat normalY = plane(3) * w;
+			const SimdFloat normalZ = plane(4) * w;
+			const SimdFloat lightX = plane(5) * w;
+			const SimdFloat lightY = plane(6) * w;
+			const SimdFloat lightZ = plane(7) * w;
+			SimdFloat viewX = plane(8) * w;
+			SimdFloat viewY = plane(9) * w;
+			SimdFloat viewZ = plane(10) * w;
+
+			// PS of Lighting.hlsl
+			const SimdFloat normalDotLight = normalX * lightX + normalY * lightY + normalZ * lightZ;
+			const SimdFloat diffuse = SimdSaturate(zero - normalDotLight);
+
+			const SimdFloat reflectionX = lightX - two * normalDotLight * normalX;
+			const SimdFloat reflectionY = lightY - two * normalDotLight * normalY;
+			const SimdFloat reflectionZ = lightZ - two * normalDotLight * normalZ;
+
+			const SimdFloat invViewLength = one / SimdSqrt(viewX * viewX + viewY * viewY + viewZ * viewZ);
+			viewX = viewX * invViewLength;
+			viewY = viewY * invViewLength;
+			viewZ = viewZ * invViewLength;
+
+			const SimdFloat specularBase = SimdSaturate(zero - (reflectionX * viewX + reflectionY * viewY + reflectionZ * viewZ));
+			const SimdFloat specular2 = specularBase * specularBase;
+			const SimdFloat specular4 = specular2 * specular2;
+			const SimdFloat specular16 = specular4 * specular4 * specular4 * specular4;
+			const SimdFloat specular = SimdSelect(diffuse > zero, specular16 * specular4, zero);
+
+			const SimdInt red = SimdConvertToInt(SimdSaturate(diffuse * colorR + specular + ambient * colorR) * unormScale);
+			const SimdInt green = SimdConvertToInt(SimdSaturate(diffuse * colorG + specular + ambient * colorG) * unormScale);
+			const SimdInt blue = SimdConvertToInt(SimdSaturate(diffuse * colorB + specular + ambient * colorB) * unormScale);
+			const SimdInt packedColor = red | SimdShiftLeft(green, 8) | SimdShiftLeft(blue, 16) | alpha;
+
+			SimdStore(depthRow + x, SimdSelect(mask, depth, storedDepth));
+
+			const SimdFloat storedColor = SimdCastToFloat(SimdLoadInt(colorRow + x));
+			SimdStoreInt(colorRow + x, SimdCastToInt(SimdSelect(mask, SimdCastToFloat(packedColor), storedColor)));
+		}
+	}
+
+	Counters[threadIndex].ShadedPixelCount += shadedPixelCount;
+}
+
+uint64_t SoftwareRasterizer::ComputeChecksum() const
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (int32_t y = 0; y < Height; ++y)
+	{
+		const uint8_t* row = (const uint8_t*)(ColorBuffer.data() + (size_t)y * Stride);
+		for (int32_t i = 0; i < Width * 4; ++i)
+		{
+			hash = (hash ^ row[i]) * 0x100000001B3ull;
+		}
+	}
+	return hash;
+}
+
+bool SoftwareRasterizer::SaveImage(const char* fileName) const
+{
+	FILE* file = fopen(fileName, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "P6\n%d %d\n255\n", Width, Height);
+
+	std::vector<uint8_t> row(Width * 3);
+	bool bSucceeded = true;
+	for (int32_t y = 0; y < Height && bSucceeded; ++y)
+	{
+		for (int32_t x = 0; x < Width; ++x)
+		{
+			const uint32_t pixel = GetPixel(x, y);
+			row[x * 3 + 0] = (uint8_t)(pixel & 0xFF);
+			row[x * 3 + 1] = (uint8_t)((pixel >> 8) & 0xFF);
+			row[x * 3 + 2] = (uint8_t)((pixel >> 16) & 0xFF);
+		}
+		bSucceeded = fwrite(row.data(), 1, row.size(), file) == row.size();
+	}
+
+	fclose(file);
+
+	return bSucceeded;
+}
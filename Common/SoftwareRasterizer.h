@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "MathTypes.h"
+#include "ThreadPool.h"
+#include "VertexQuantization.h"
+#include "VertexTypes.h"
+
+// Scene constants of Lighting.hlsl, the matrices come with each instance
+struct LightingConstants
+{
+	Float4 WorldLightPosition;
+	Float4 WorldCameraPosition;
+};
+
+struct RasterizerStats
+{
+	uint32_t DrawCount;
+	uint64_t InstanceCount;
+	uint64_t VertexCount;
+	uint64_t TriangleCount;
+	uint64_t BinnedTriangleCount;
+	uint64_t ShadedPixelCount;
+
+	// Milliseconds
+	double ClearTime;
+	double VertexTime;
+	double SetupTime;
+	double RasterTime;
+};
+
+// Headless CPU implementation of the Lighting sample pipeline.
+// Draws go through three parallel phases: vertex shading, triangle setup and binning into
+// TILE_SIZE x TILE_SIZE screen tiles, and per-tile rasterization with SIMD edge functions, depth test (LESS) and
+// the pixel shader of Lighting.hlsl. Render target is R8G8B8A8_UNORM and depth is a 32-bit float buffer.
+class SoftwareRasterizer
+{
+public:
+	static constexpr int32_t TILE_SIZE = 64;
+
+	SoftwareRasterizer() = default;
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	// threadCount includes the calling thread. 0 means one per hardware thread.
+	bool Init(int32_t width, int32_t height, uint32_t threadCount);
+	void Free();
+
+	void Clear(const float color[4], float depth);
+
+	// Draws instanceCount copies of the mesh. Each instance supplies the world matrix and the albedo of Lighting.hlsl.
+	// indexSize is 2 for 16-bit and 4 for 32-bit indices.
+	void DrawIndexedInstanced(const VertexData* vertices, uint32_t vertexCount, const void* indices, uint32_t indexSize, uint32_t indexCount,
+		const InstanceData* instances, uint32_t instanceCount, const LightingConstants& constants);
+
+	// Same with QuantizedVertexData, decoded with quantization as VSQuantized does
+	void DrawIndexedInstanced(const QuantizedVertexData* vertices, const VertexQuantization& quantization, uint32_t vertexCount, const void* indices,
+		uint32_t indexSize, uint32_t indexCount, const InstanceData* instances, uint32_t instanceCount, const LightingConstants& constants);
+
+	void ResetStats();
+	const RasterizerStats& GetStats() const { return Stats; }
+
+	int32_t GetWidth() const { return Width; }
+	int32_t GetHeight() const { return Height; }
+	uint32_t GetThreadCount() const { return Workers.GetThreadCount(); }
+	uint32_t GetPixel(int32_t x, int32_t y) const { return ColorBuffer[y * Stride + x]; }
+	float GetDepth(int32_t x, int32_t y) const { return DepthBuffer[y * Stride + x]; }
+
+	// FNV-1a over the visible pixels, for image comparisons between runs
+	uint64_t ComputeChecksum() const;
+
+	// Binary PPM (P6)
+	bool SaveImage(const char* fileName) const;
+
+	// VS_OUTPUT of Lighting.hlsl
+	struct ShadedVertex
+	{
+		Float4 Position;
+		Float3 Normal;
+		Float3 LightDirection;
+		Float3 ViewDirection;
+	};
+
+	// Screen space Z, 1/W, and the nine perspective-divided attributes of ShadedVertex
+	static constexpr int32_t PLANE_COUNT = 11;
+
+	struct RasterTriangle
+	{
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+		float PlaneDx[PLANE_COUNT];
+		float PlaneDy[PLANE_COUNT];
+		float PlaneC[PLANE_COUNT];
+		int32_t MinX;
+		int32_t MinY;
+		int32_t MaxX;
+		int32_t MaxY;
+		float Color[3];
+	};
+
+private:
+	struct alignas(64) ThreadCounters
+	{
+		uint64_t ShadedPixelCount;
+	};
+
+	// Vertices of a draw, QuantizedVertices when they are set
+	struct VertexInput
+	{
+		const VertexData* Vertices;
+		const QuantizedVertexData* QuantizedVertices;
+		VertexQuantization Quantization;
+		uint32_t Count;
+	};
+
+	void Draw(const VertexInput& vertices, const void* indices, uint32_t indexSize, uint32_t indexCount, const InstanceData* instances, uint32_t instanceCount,
+		const LightingConstants& constants);
+	void DrawBatch(const VertexInput& vertices, const void* indices, uint32_t indexSize, uint32_t triangleCount,
+		const InstanceData* instances, uint32_t instanceCount, const LightingConstants& constants);
+
+	// Vertex and triangle ranges index the concatenated instances of a batch
+	void ShadeVertices(const VertexInput& vertices, const InstanceData* instances, uint32_t begin, uint32_t end, const LightingConstants& constants);
+	void SetupTriangles(const void* indices, uint32_t indexSize, uint32_t triangleCount, uint32_t vertexCount, const InstanceData* instances,
+		uint32_t chunkIndex, uint32_t triangleBegin, uint32_t triangleEnd);
+	void SetupTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, const Float4& color, uint32_t chunkIndex);
+	void RasterizeTile(uint32_t tileIndex, uint32_t chunkCount, uint32_t threadIndex);
+	void RasterizeTriangle(const RasterTriangle& triangle, int32_t tileMinX, int32_t tileMinY, int32_t tileMaxX, int32_t tileMaxY, uint32_t threadIndex);
+
+	int32_t Width = 0;
+	int32_t Height = 0;
+	int32_t Stride = 0;
+	int32_t TileCountX = 0;
+	int32_t TileCountY = 0;
+
+	std::vector<uint32_t> ColorBuffer;
+	std::vector<float> DepthBuffer;
+
+	std::vector<ShadedVertex> ShadedVertices;
+	std::vector<std::vector<RasterTriangle>> ChunkTriangles;
+	std::vector<std::vector<uint32_t>> ChunkBins;
+	std::vector<ThreadCounters> Counters;
+
+	ThreadPool Workers;
+	RasterizerStats Stats{};
+};
@@ -0,0 +1,220 @@
+#include "SoftwareRenderDevice.h"
+
+#include <string.h>
+
+namespace
+{
+	constexpr char LIGHTING_SHADER_FILE_NAME[] = "Lighting.hlsl";
+
+	// Constant buffers of Lighting.hlsl
+	struct LightingFrameConstants
+	{
+		Float4 WorldLightPosition;
+	};
+
+	struct LightingViewConstants
+	{
+		Float4 WorldCameraPosition;
+	};
+
+	struct LightingObjectConstants
+	{
+		ObjectMatrices Matrices;
+		Float4 Color;
+	};
+
+	bool EndsWith(const std::string& text, const char* suffix)
+	{
+		const size_t suffixLength = strlen(suffix);
+		return text.size() >= suffixLength && text.compare(text.size() - suffixLength, suffixLength, suffix) == 0;
+	}
+}
+
+bool SoftwareRenderDevice::Init(int32_t width, int32_t height, uint32_t threadCount)
+{
+	if (!NullRenderDevice::Init(false))
+	{
+		return false;
+	}
+
+	return Rasterizer.Init(width, height, threadCount);
+}
+
+void SoftwareRenderDevice::Free()
+{
+	Rasterizer.Free();
+	NullRenderDevice::Free();
+}
+
+void SoftwareRenderDevice::Clear(const float color[4], float depth)
+{
+	NullRenderDevice::Clear(color, depth);
+
+	Rasterizer.Clear(color, depth);
+}
+
+void SoftwareRenderDevice::DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+{
+	Record(COMMAND_TYPE_DRAW_INDEXED, indexCount, startIndexLocation, (uint32_t)baseVertexLocation);
+
+	Draw(indexCount, 1, startIndexLocation, baseVertexLocation, 0);
+}
+
+void SoftwareRenderDevice::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	Record(COMMAND_TYPE_DRAW_INDEXED_INSTANCED, indexCountPerInstance, instanceCount, startIndexLocation, (uint32_t)baseVertexLocation, startInstanceLocation);
+
+	Draw(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
+}
+
+void SoftwareRenderDevice::Draw(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+	if (!SubmitDraw(indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation))
+	{
+		return;
+	}
+
+	// Valid draw the rasterizer has no shader for
+	const LIGHTING_PROGRAM program = FindLightingProgram();
+	if (program == LIGHTING_PROGRAM_NONE)
+	{
+		++SkippedDrawCount;
+		return;
+	}
+
+	const bool bQuantized = program == LIGHTING_PROGRAM_QUANTIZED_INSTANCED || program == LIGHTING_PROGRAM_QUANTIZED_PER_OBJECT;
+	const bool bPerObject = program == LIGHTING_PROGRAM_PER_OBJECT || program == LIGHTING_PROGRAM_QUANTIZED_PER_OBJECT;
+	const uint32_t vertexSize = bQuantized ? sizeof(QuantizedVertexData) : sizeof(VertexData);
+
+	const VertexBufferBinding& vertexBinding = State.VertexBuffers[0];
+	const Buffer* vertexBuffer = FindBuffer(vertexBinding.Buffer);
+	const Buffer* indexBuffer = FindBuffer(State.IndexBuffer);
+	if (vertexBinding.Stride != vertexSize || baseVertexLocation < 0)
+	{
+		ReportError("Draw: the software backend needs %s vertices and a non-negative base vertex", bQuantized ? "QuantizedVertexData" : "VertexData");
+		return;
+	}
+
+	const VertexQuantization* quantization = nullptr;
+	if (bQuantized)
+	{
+		quantization = (const VertexQuantization*)FindConstants(State.VertexConstantBuffers[3], sizeof(VertexQuantization));
+		if (!quantization)
+		{
+			ReportError("Draw: constant buffer 3 does not hold the Lighting.hlsl mesh constants");
+			return;
+		}
+	}
+
+	const LightingFrameConstants* frameConstants = (const LightingFrameConstants*)FindConstants(State.VertexConstantBuffers[0], sizeof(LightingFrameConstants));
+	const LightingViewConstants* viewConstants = (const LightingViewConstants*)FindConstants(State.VertexConstantBuffers[1], sizeof(LightingViewConstants));
+	if (!frameConstants || !viewConstants)
+	{
+		ReportError("Draw: constant buffers 0 and 1 do not hold the Lighting.hlsl frame and view constants");
+		return;
+	}
+
+	LightingConstants constants;
+	constants.WorldLightPosition = frameConstants->WorldLightPosition;
+	constants.WorldCameraPosition = viewConstants->WorldCameraPosition;
+
+	// Per-object draws take the instance from constant buffer 2
+	InstanceData objectInstance;
+	const InstanceData* instances = nullptr;
+	if (bPerObject)
+	{
+		const LightingObjectConstants* objectConstants = (const LightingObjectConstants*)FindConstants(State.VertexConstantBuffers[2], sizeof(LightingObjectConstants));
+		if (!objectConstants || instanceCount != 1)
+		{
+			ReportError("Draw: VSPerObject and VSQuantizedPerObject draw one instance with the object constants in constant buffer 2");
+			return;
+		}
+
+		objectInstance.Matrices = objectConstants->Matrices;
+		objectInstance.Color = objectConstants->Color;
+		instances = &objectInstance;
+	}
+	else
+	{
+		const VertexBufferBinding& instanceBinding = State.VertexBuffers[1];
+		const Buffer* instanceBuffer = FindBuffer(instanceBinding.Buffer);
+		if (!instanceBuffer || instanceBinding.Stride != sizeof(InstanceData))
+		{
+			ReportError("Draw: the software backend needs InstanceData instances in slot 1");
+			return;
+		}
+
+		instances = (const InstanceData*)(instanceBuffer->Data.data() + instanceBinding.Offset) + startInstanceLocation;
+	}
+
+	const uint8_t* vertices = vertexBuffer->Data.data() + vertexBinding.Offset + (size_t)baseVertexLocation * vertexSize;
+	const uint32_t vertexCount = (vertexBuffer->Desc.ByteWidth - vertexBinding.Offset) / vertexSize - (uint32_t)baseVertexLocation;
+	const uint32_t indexSize = State.IndexFormat == INDEX_FORMAT_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	const uint8_t* indices = indexBuffer->Data.data() + State.IndexBufferOffset + (size_t)startIndexLocation * indexSize;
+
+	if (bQuantized)
+	{
+		Rasterizer.DrawIndexedInstanced((const QuantizedVertexData*)vertices, *quantization, vertexCount, indices, indexSize, indexCount, instances, instanceCount, constants);
+	}
+	else
+	{
+		Rasterizer.DrawIndexedInstanced((const VertexData*)vertices, vertexCount, indices, indexSize, indexCount, instances, instanceCount, constants);
+	}
+}
+
+void SoftwareRenderDevice::Present()
+{
+	NullRenderDevice::Present();
+
+	RasterizerFrameStats = Rasterizer.GetStats();
+	Rasterizer.ResetStats();
+
+	SkippedDrawFrameCount = SkippedDrawCount;
+	SkippedDrawCount = 0;
+}
+
+SoftwareRenderDevice::LIGHTING_PROGRAM SoftwareRenderDevice::FindLightingProgram() const
+{
+	const Shader& vertexShader = VertexShaders[State.VertexShader.Id - 1];
+	const Shader& pixelShader = PixelShaders[State.PixelShader.Id - 1];
+	if (!EndsWith(vertexShader.FileName, LIGHTING_SHADER_FILE_NAME) || !EndsWith(pixelShader.FileName, LIGHTING_SHADER_FILE_NAME) || pixelShader.EntryPoint != "PS")
+	{
+		return LIGHTING_PROGRAM_NONE;
+	}
+
+	if (vertexShader.EntryPoint == "VS")
+	{
+		return LIGHTING_PROGRAM_INSTANCED;
+	}
+	if (vertexShader.EntryPoint == "VSPerObject")
+	{
+		return LIGHTING_PROGRAM_PER_OBJECT;
+	}
+	if (vertexShader.EntryPoint == "VSQuantized")
+	{
+		return LIGHTING_PROGRAM_QUANTIZED_INSTANCED;
+	}
+	if (vertexShader.EntryPoint == "VSQuantizedPerObject")
+	{
+		return LIGHTING_PROGRAM_QUANTIZED_PER_OBJECT;
+	}
+
+	return LIGHTING_PROGRAM_NONE;
+}
+
+const void* SoftwareRenderDevice::FindConstants(const ConstantBufferBinding& binding, uint32_t size) const
+{
+	const Buffer* constantBuffer = FindBuffer(binding.Buffer);
+	if (!constantBuffer)
+	{
+		return nullptr;
+	}
+
+	const uint32_t rangeSize = binding.Size ? binding.Size : constantBuffer->Desc.ByteWidth;
+	if (rangeSize < size)
+	{
+		return nullptr;
+	}
+
+	return constantBuffer->Data.data() + binding.Offset;
+}
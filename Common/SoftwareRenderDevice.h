@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "NullRenderDevice.h"
+#include "SoftwareRasterizer.h"
+
+// NullRenderDevice that also executes draws on the SoftwareRasterizer.
+// Only the programs of Lighting.hlsl are implemented, with VertexData in slot 0 and either InstanceData in slot 1 (VS)
+// or the object constants in constant buffer 2 (VSPerObject). VSQuantized and VSQuantizedPerObject read QuantizedVertexData
+// instead, with the VertexQuantization in constant buffer 3.
+// Draws with other shaders are validated, counted and skipped.
+// Rasterizer, depth-stencil and blend states are tracked, but draws are rendered solid with the depth test LESS, depth writes
+// and no blending whatever the states say.
+class SoftwareRenderDevice : public NullRenderDevice
+{
+public:
+	bool Init(int32_t width, int32_t height, uint32_t threadCount);
+
+	const char* GetName() const override { return "Software"; }
+	void Free() override;
+
+	void Clear(const float color[4], float depth) override;
+	void DrawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation) override;
+	void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+	void Present() override;
+
+	SoftwareRasterizer& GetRasterizer() { return Rasterizer; }
+
+	// Rasterizer counters of the last presented frame
+	const RasterizerStats& GetRasterizerStats() const { return RasterizerFrameStats; }
+
+	// Draws of the last presented frame that were not rasterized because of their shaders
+	uint32_t GetSkippedDrawCount() const { return SkippedDrawFrameCount; }
+
+private:
+	enum LIGHTING_PROGRAM : uint32_t
+	{
+		LIGHTING_PROGRAM_NONE,
+		LIGHTING_PROGRAM_INSTANCED,
+		LIGHTING_PROGRAM_PER_OBJECT,
+		LIGHTING_PROGRAM_QUANTIZED_INSTANCED,
+		LIGHTING_PROGRAM_QUANTIZED_PER_OBJECT
+	};
+
+	void Draw(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation);
+	LIGHTING_PROGRAM FindLightingProgram() const;
+
+	// Bound range of a constant buffer if it holds at least size bytes, otherwise nullptr
+	const void* FindConstants(const ConstantBufferBinding& binding, uint32_t size) const;
+
+	SoftwareRasterizer Rasterizer;
+	RasterizerStats RasterizerFrameStats{};
+
+	uint32_t SkippedDrawCount = 0;
+	uint32_t SkippedDrawFrameCount = 0;
+};
@@ -0,0 +1,113 @@
+#include "ThreadPool.h"
+
+ThreadPool::~ThreadPool()
+{
+	Free();
+}
+
+bool ThreadPool::Init(uint32_t threadCount)
+{
+	Free();
+
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount == 0)
+	{
+		threadCount = 1;
+	}
+
+	bQuit = false;
+	Workers.reserve(threadCount - 1);
+	for (uint32_t threadIndex = 1; threadIndex < threadCount; ++threadIndex)
+	{
+		Workers.emplace_back(&ThreadPool::WorkerMain, this, threadIndex);
+	}
+
+	return true;
+}
+
+void ThreadPool::Free()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		bQuit = true;
+	}
+	WakeCondition.notify_all();
+
+	for (std::thread& worker : Workers)
+	{
+		worker.join();
+	}
+	Workers.clear();
+}
+
+void ThreadPool::ParallelFor(uint32_t taskCount, const TaskFunction& task)
+{
+	if (taskCount == 0)
+	{
+		return;
+	}
+
+	if (Workers.empty() || taskCount == 1)
+	{
+		for (uint32_t taskIndex = 0; taskIndex < taskCount; ++taskIndex)
+		{
+			task(taskIndex, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		CurrentTask = &task;
+		TaskCount = taskCount;
+		NextTaskIndex.store(0, std::memory_order_relaxed);
+		ActiveWorkerCount = (uint32_t)Workers.size();
+		++Generation;
+	}
+	WakeCondition.notify_all();
+
+	RunTasks(0);
+
+	std::unique_lock<std::mutex> lock(Mutex);
+	DoneCondition.wait(lock, [this] { return ActiveWorkerCount == 0; });
+	CurrentTask = nullptr;
+}
+
+void ThreadPool::WorkerMain(uint32_t threadIndex)
+{
+	uint64_t seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(Mutex);
+			WakeCondition.wait(lock, [this, seenGeneration] { return bQuit || Generation != seenGeneration; });
+			if (bQuit)
+			{
+				return;
+			}
+			seenGeneration = Generation;
+		}
+
+		RunTasks(threadIndex);
+
+		std::lock_guard<std::mutex> lock(Mutex);
+		if (--ActiveWorkerCount == 0)
+		{
+			DoneCondition.notify_one();
+		}
+	}
+}
+
+void ThreadPool::RunTasks(uint32_t threadIndex)
+{
+	const TaskFunction& task = *CurrentTask;
+
+	for (uint32_t taskIndex = NextTaskIndex.fetch_add(1, std::memory_order_relaxed); taskIndex < TaskCount; taskIndex = NextTaskIndex.fetch_add(1, std::memory_order_relaxed))
+	{
+		task(taskIndex, threadIndex);
+	}
+}
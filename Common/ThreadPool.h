@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that execute ParallelFor tasks.
+// The calling thread takes part in the work as thread index 0.
+class ThreadPool
+{
+public:
+	using TaskFunction = std::function<void(uint32_t taskIndex, uint32_t threadIndex)>;
+
+	ThreadPool() = default;
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	// threadCount includes the calling thread. 0 means one per hardware thread.
+	bool Init(uint32_t threadCount);
+	void Free();
+
+	uint32_t GetThreadCount() const { return (uint32_t)Workers.size() + 1; }
+
+	// Runs task(taskIndex, threadIndex) for every taskIndex in [0, taskCount) and returns when all are done.
+	void ParallelFor(uint32_t taskCount, const TaskFunction& task);
+
+private:
+	void WorkerMain(uint32_t threadIndex);
+	void RunTasks(uint32_t threadIndex);
+
+	std::vector<std::thread> Workers;
+	std::mutex Mutex;
+	std::condition_variable WakeCondition;
+	std::condition_variable DoneCondition;
+
+	const TaskFunction* CurrentTask = nullptr;
+	uint32_t TaskCount = 0;
+	std::atomic<uint32_t> NextTaskIndex{ 0 };
+	uint64_t Generation = 0;
+	uint32_t ActiveWorkerCount = 0;
+	bool bQuit = false;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// Hands the newest of a stream of values from one writer thread to one reader thread over three slots, without locks and
+// without either side ever waiting for the other. The writer fills GetWriteSlot and publishes it, the reader acquires the
+// newest published value and reads it from GetReadSlot until its next Acquire. Values published in between are skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+	T& GetWriteSlot() { return Slots[WriteIndex].Value; }
+
+	// Swaps the written slot with the shared one and marks it fresh, the writer goes on with the slot it got back
+	void Publish()
+	{
+		WriteIndex = SharedIndex.exchange(WriteIndex | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Swaps the read slot with the shared one when that holds a value newer than the read slot, returns false otherwise
+	bool Acquire()
+	{
+		if (!(SharedIndex.load(std::memory_order_relaxed) & FRESH_BIT))
+		{
+			return false;
+		}
+
+		ReadIndex = SharedIndex.exchange(ReadIndex, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+
+	const T& GetReadSlot() const { return Slots[ReadIndex].Value; }
+
+private:
+	static constexpr uint32_t INDEX_MASK = 3;
+	static constexpr uint32_t FRESH_BIT = 4;
+
+	// Every slot and index on cache lines of its own, so that the two threads only ever share SharedIndex
+	struct alignas(64) Slot
+	{
+		T Value{};
+	};
+
+	Slot Slots[3];
+	alignas(64) uint32_t WriteIndex = 0;
+	alignas(64) uint32_t ReadIndex = 1;
+	alignas(64) std::atomic<uint32_t> SharedIndex{ 2 };
+};
@@ -0,0 +1,266 @@
+#include "VertexQuantization.h"
+
+#include <float.h>
+#include <math.h>
+
+#include "Simd.h"
+
+namespace
+{
+	constexpr double RADIANS_TO_DEGREES = 180.0 / 3.14159265358979323846;
+
+	// Position = (quantized - bias) / scale, 0 on axes where the mesh is flat
+	struct PositionEncoding
+	{
+		Float3 Bias;
+		Float3 InverseScale;
+	};
+
+	PositionEncoding GetPositionEncoding(const VertexQuantization& quantization)
+	{
+		const Float4& scale = quantization.PositionScale;
+		return {
+			ToFloat3(quantization.PositionBias),
+			Float3{ scale.x > 0.0f ? 1.0f / scale.x : 0.0f, scale.y > 0.0f ? 1.0f / scale.y : 0.0f, scale.z > 0.0f ? 1.0f / scale.z : 0.0f }
+		};
+	}
+
+	// Rounds to nearest even like SimdConvertToInt
+	int16_t EncodeSnorm16(float value)
+	{
+		value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return (int16_t)lrintf(value * SNORM16_MAX);
+	}
+
+	uint8_t EncodeUnorm8(float value)
+	{
+		value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+		return (uint8_t)lrintf(value * UNORM8_MAX);
+	}
+
+	void EncodePosition(const Float3& position, const PositionEncoding& encoding, int16_t outPosition[4])
+	{
+		outPosition[0] = EncodeSnorm16((position.x - encoding.Bias.x) * encoding.InverseScale.x);
+		outPosition[1] = EncodeSnorm16((position.y - encoding.Bias.y) * encoding.InverseScale.y);
+		outPosition[2] = EncodeSnorm16((position.z - encoding.Bias.z) * encoding.InverseScale.z);
+		outPosition[3] = 0;
+	}
+
+	// Projects onto the octahedron |x| + |y| + |z| = 1, then the lower half is unfolded around the upper one in the XY square
+	void EncodeOctahedralNormal(const Float3& normal, int16_t outNormal[2])
+	{
+		const float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+		const float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+		float x = normal.x * inverseLength;
+		float y = normal.y * inverseLength;
+		if (normal.z < 0.0f)
+		{
+			const float foldedX = copysignf(1.0f - fabsf(y), x);
+			y = copysignf(1.0f - fabsf(x), y);
+			x = foldedX;
+		}
+
+		outNormal[0] = EncodeSnorm16(x);
+		outNormal[1] = EncodeSnorm16(y);
+	}
+
+	SimdFloat SimdAbs(SimdFloat value) { return SimdAndNot(SimdSet(-0.0f), value); }
+
+	// Magnitude of magnitude with the sign of sign
+	SimdFloat SimdCopySign(SimdFloat magnitude, SimdFloat sign) { return SimdAbs(magnitude) | (sign & SimdSet(-0.0f)); }
+
+	SimdInt SimdEncodeSnorm16(SimdFloat value) { return SimdConvertToInt(SimdMin(SimdMax(value, SimdSet(-1.0f)), SimdSet(1.0f)) * SimdSet(SNORM16_MAX)); }
+	SimdInt SimdEncodeUnorm8(SimdFloat value) { return SimdConvertToInt(SimdSaturate(value) * SimdSet(UNORM8_MAX)); }
+
+	// SIMD_WIDTH positions read from AoS vertices into one register per axis, encoded and written as lanes of outPositions
+	void SimdEncodePositions(const uint8_t* vertices, size_t vertexStride, const PositionEncoding& encoding, int32_t outPositions[3][SIMD_WIDTH])
+	{
+		alignas(32) float components[3][SIMD_WIDTH];
+		for (int32_t lane = 0; lane < SIMD_WIDTH; ++lane)
+		{
+			const Float3& position = *(const Float3*)(vertices + lane * vertexStride);
+			components[0][lane] = position.x;
+			components[1][lane] = position.y;
+			components[2][lane] = position.z;
+		}
+
+		SimdStoreInt(outPositions[0], SimdEncodeSnorm16((SimdLoad(components[0]) - SimdSet(encoding.Bias.x)) * SimdSet(encoding.InverseScale.x)));
+		SimdStoreInt(outPositions[1], SimdEncodeSnorm16((SimdLoad(components[1]) - SimdSet(encoding.Bias.y)) * SimdSet(encoding.InverseScale.y)));
+		SimdStoreInt(outPositions[2], SimdEncodeSnorm16((SimdLoad(components[2]) - SimdSet(encoding.Bias.z)) * SimdSet(encoding.InverseScale.z)));
+	}
+
+	// Angle between two vectors, through atan2 which stays accurate for the tiny angles of quantization
+	double ComputeAngleDegrees(const Float3& a, const Float3& b)
+	{
+		const double crossX = (double)a.y * b.z - (double)a.z * b.y;
+		const double crossY = (double)a.z * b.x - (double)a.x * b.z;
+		const double crossZ = (double)a.x * b.y - (double)a.y * b.x;
+		const double dot = (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z;
+		return atan2(sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), dot) * RADIANS_TO_DEGREES;
+	}
+
+	float ComputePositionError(const Float3& position, const int16_t quantizedPosition[4], const VertexQuantization& quantization)
+	{
+		return Length(DecodePosition(quantizedPosition, quantization) - position);
+	}
+}
+
+VertexQuantization ComputeVertexQuantization(const void* positions, uint32_t vertexCount, uint32_t vertexStride)
+{
+	if (vertexCount == 0)
+	{
+		return { Float4{ 1.0f, 1.0f, 1.0f, 0.0f }, Float4{ 0.0f, 0.0f, 0.0f, 0.0f } };
+	}
+
+	Float3 minimum{ FLT_MAX, FLT_MAX, FLT_MAX };
+	Float3 maximum{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		const Float3& position = *(const Float3*)((const uint8_t*)positions + (size_t)i * vertexStride);
+		minimum = Float3{ fminf(minimum.x, position.x), fminf(minimum.y, position.y), fminf(minimum.z, position.z) };
+		maximum = Float3{ fmaxf(maximum.x, position.x), fmaxf(maximum.y, position.y), fmaxf(maximum.z, position.z) };
+	}
+
+	const Float3 center = (minimum + maximum) * 0.5f;
+	const Float3 extent = (maximum - minimum) * 0.5f;
+	return { ToFloat4(extent, 0.0f), ToFloat4(center, 0.0f) };
+}
+
+void QuantizeVertices(const VertexData* vertices, uint32_t vertexCount, const VertexQuantization& quantization, QuantizedVertexData* outVertices)
+{
+	const PositionEncoding encoding = GetPositionEncoding(quantization);
+
+	uint32_t first = 0;
+	for (; first + SIMD_WIDTH <= vertexCount; first += SIMD_WIDTH)
+	{
+		alignas(32) int32_t positions[3][SIMD_WIDTH];
+		SimdEncodePositions((const uint8_t*)(vertices + first), sizeof(VertexData), encoding, positions);
+
+		alignas(32) float normalComponents[3][SIMD_WIDTH];
+		for (int32_t lane = 0; lane < SIMD_WIDTH; ++lane)
+		{
+			const Float3& normal = vertices[first + lane].Normal;
+			normalComponents[0][lane] = normal.x;
+			normalComponents[1][lane] = normal.y;
+			normalComponents[2][lane] = normal.z;
+		}
+
+		// Same steps as EncodeOctahedralNormal, with the fold selected per lane
+		const SimdFloat normalX = SimdLoad(normalComponents[0]);
+		const SimdFloat normalY = SimdLoad(normalComponents[1]);
+		const SimdFloat normalZ = SimdLoad(normalComponents[2]);
+		const SimdFloat length = SimdAbs(normalX) + SimdAbs(normalY) + SimdAbs(normalZ);
+		const SimdFloat inverseLength = SimdSelect(length > SimdZero(), SimdSet(1.0f) / length, SimdZero());
+		const SimdFloat x = normalX * inverseLength;
+		const SimdFloat y = normalY * inverseLength;
+		const SimdFloat foldMask = normalZ < SimdZero();
+		const SimdFloat one = SimdSet(1.0f);
+
+		alignas(32) int32_t normals[2][SIMD_WIDTH];
+		SimdStoreInt(normals[0], SimdEncodeSnorm16(SimdSelect(foldMask, SimdCopySign(one - SimdAbs(y), x), x)));
+		SimdStoreInt(normals[1], SimdEncodeSnorm16(SimdSelect(foldMask, SimdCopySign(one - SimdAbs(x), y), y)));
+
+		for (int32_t lane = 0; lane < SIMD_WIDTH; ++lane)
+		{
+			QuantizedVertexData& output = outVertices[first + lane];
+			output.Position[0] = (int16_t)positions[0][lane];
+			output.Position[1] = (int16_t)positions[1][lane];
+			output.Position[2] = (int16_t)positions[2][lane];
+			output.Position[3] = 0;
+			output.Normal[0] = (int16_t)normals[0][lane];
+			output.Normal[1] = (int16_t)normals[1][lane];
+		}
+	}
+
+	QuantizeVerticesScalar(vertices + first, vertexCount - first, quantization, outVertices + first);
+}
+
+void QuantizeVerticesScalar(const VertexData* vertices, uint32_t vertexCount, const VertexQuantization& quantization, QuantizedVertexData* outVertices)
+{
+	const PositionEncoding encoding = GetPositionEncoding(quantization);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		EncodePosition(vertices[i].Position, encoding, outVertices[i].Position);
+		EncodeOctahedralNormal(vertices[i].Normal, outVertices[i].Normal);
+	}
+}
+
+void QuantizeVertices(const ColorVertexData* vertices, uint32_t vertexCount, const VertexQuantization& quantization, QuantizedColorVertexData* outVertices)
+{
+	const PositionEncoding encoding = GetPositionEncoding(quantization);
+
+	uint32_t first = 0;
+	for (; first + SIMD_WIDTH <= vertexCount; first += SIMD_WIDTH)
+	{
+		alignas(32) int32_t positions[3][SIMD_WIDTH];
+		SimdEncodePositions((const uint8_t*)(vertices + first), sizeof(ColorVertexData), encoding, positions);
+
+		alignas(32) float colorComponents[4][SIMD_WIDTH];
+		for (int32_t lane = 0; lane < SIMD_WIDTH; ++lane)
+		{
+			const Float4& color = vertices[first + lane].Color;
+			colorComponents[0][lane] = color.x;
+			colorComponents[1][lane] = color.y;
+			colorComponents[2][lane] = color.z;
+			colorComponents[3][lane] = color.w;
+		}
+
+		alignas(32) int32_t colors[4][SIMD_WIDTH];
+		for (int32_t channel = 0; channel < 4; ++channel)
+		{
+			SimdStoreInt(colors[channel], SimdEncodeUnorm8(SimdLoad(colorComponents[channel])));
+		}
+
+		for (int32_t lane = 0; lane < SIMD_WIDTH; ++lane)
+		{
+			QuantizedColorVertexData& output = outVertices[first + lane];
+			output.Position[0] = (int16_t)positions[0][lane];
+			output.Position[1] = (int16_t)positions[1][lane];
+			output.Position[2] = (int16_t)positions[2][lane];
+			output.Position[3] = 0;
+			for (int32_t channel = 0; channel < 4; ++channel)
+			{
+				output.Color[channel] = (uint8_t)colors[channel][lane];
+			}
+		}
+	}
+
+	for (uint32_t i = first; i < vertexCount; ++i)
+	{
+		const Float4& color = vertices[i].Color;
+		EncodePosition(vertices[i].Position, encoding, outVertices[i].Position);
+		outVertices[i].Color[0] = EncodeUnorm8(color.x);
+		outVertices[i].Color[1] = EncodeUnorm8(color.y);
+		outVertices[i].Color[2] = EncodeUnorm8(color.z);
+		outVertices[i].Color[3] = EncodeUnorm8(color.w);
+	}
+}
+
+VertexQuantizationError MeasureQuantizationError(const VertexData* vertices, const QuantizedVertexData* quantizedVertices, uint32_t vertexCount,
+	const VertexQuantization& quantization)
+{
+	VertexQuantizationError error{ vertexCount, 0.0f, 0.0f, 0.0f };
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		error.MaxPositionError = fmaxf(error.MaxPositionError, ComputePositionError(vertices[i].Position, quantizedVertices[i].Position, quantization));
+		error.MaxNormalAngle = fmaxf(error.MaxNormalAngle, (float)ComputeAngleDegrees(vertices[i].Normal, DecodeOctahedralNormal(quantizedVertices[i].Normal)));
+	}
+	return error;
+}
+
+VertexQuantizationError MeasureQuantizationError(const ColorVertexData* vertices, const QuantizedColorVertexData* quantizedVertices, uint32_t vertexCount,
+	const VertexQuantization& quantization)
+{
+	VertexQuantizationError error{ vertexCount, 0.0f, 0.0f, 0.0f };
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		error.MaxPositionError = fmaxf(error.MaxPositionError, ComputePositionError(vertices[i].Position, quantizedVertices[i].Position, quantization));
+
+		const float color[4]{ vertices[i].Color.x, vertices[i].Color.y, vertices[i].Color.z, vertices[i].Color.w };
+		for (int32_t channel = 0; channel < 4; ++channel)
+		{
+			error.MaxColorError = fmaxf(error.MaxColorError, fabsf(quantizedVertices[i].Color[channel] / UNORM8_MAX - color[channel]));
+		}
+	}
+	return error;
+}
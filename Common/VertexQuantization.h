@@ -0,0 +1,79 @@
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+#include "MathTypes.h"
+#include "VertexTypes.h"
+
+constexpr float SNORM16_MAX = 32767.0f;
+constexpr float UNORM8_MAX = 255.0f;
+
+// Maps the positions of a mesh into the SNORM16 range, position = quantized * PositionScale + PositionBias.
+// Laid out as the MeshConstants of the shaders, w of both is unused.
+struct VertexQuantization
+{
+	Float4 PositionScale;
+	Float4 PositionBias;
+};
+
+// Largest differences between the vertices of a mesh and their quantized and decoded copies
+struct VertexQuantizationError
+{
+	uint32_t VertexCount;
+
+	// Distance in the units of the mesh
+	float MaxPositionError;
+
+	// Degrees between the normals
+	float MaxNormalAngle;
+
+	// Per channel, in [0, 1]
+	float MaxColorError;
+};
+
+// Centers the bounding box of the Float3 at the start of every vertexStride bytes on the origin of the SNORM16 range,
+// and scales every axis on its own so that the box fills the whole range
+VertexQuantization ComputeVertexQuantization(const void* positions, uint32_t vertexCount, uint32_t vertexStride);
+
+// Positions are mapped with quantization and normals are projected onto an octahedron and unfolded into a square.
+// SIMD_WIDTH vertices are encoded at a time, the Scalar version gives the same vertices.
+void QuantizeVertices(const VertexData* vertices, uint32_t vertexCount, const VertexQuantization& quantization, QuantizedVertexData* outVertices);
+void QuantizeVerticesScalar(const VertexData* vertices, uint32_t vertexCount, const VertexQuantization& quantization, QuantizedVertexData* outVertices);
+
+// Colors are clamped to [0, 1] and rounded to 8 bits per channel
+void QuantizeVertices(const ColorVertexData* vertices, uint32_t vertexCount, const VertexQuantization& quantization, QuantizedColorVertexData* outVertices);
+
+VertexQuantizationError MeasureQuantizationError(const VertexData* vertices, const QuantizedVertexData* quantizedVertices, uint32_t vertexCount,
+	const VertexQuantization& quantization);
+VertexQuantizationError MeasureQuantizationError(const ColorVertexData* vertices, const QuantizedColorVertexData* quantizedVertices, uint32_t vertexCount,
+	const VertexQuantization& quantization);
+
+// Decoding follows the input assembler and the shaders, so the software backend renders what the GPU does
+
+inline float DecodeSnorm16(int16_t value)
+{
+	const float decoded = value / SNORM16_MAX;
+	return decoded < -1.0f ? -1.0f : decoded;
+}
+
+inline Float3 DecodePosition(const int16_t position[4], const VertexQuantization& quantization)
+{
+	return {
+		DecodeSnorm16(position[0]) * quantization.PositionScale.x + quantization.PositionBias.x,
+		DecodeSnorm16(position[1]) * quantization.PositionScale.y + quantization.PositionBias.y,
+		DecodeSnorm16(position[2]) * quantization.PositionScale.z + quantization.PositionBias.z
+	};
+}
+
+// Folds the lower half of the octahedron back under the square and projects onto the unit sphere
+inline Float3 DecodeOctahedralNormal(const int16_t normal[2])
+{
+	Float3 decoded{ DecodeSnorm16(normal[0]), DecodeSnorm16(normal[1]), 0.0f };
+	decoded.z = 1.0f - fabsf(decoded.x) - fabsf(decoded.y);
+
+	const float fold = decoded.z < 0.0f ? -decoded.z : 0.0f;
+	decoded.x += decoded.x >= 0.0f ? -fold : fold;
+	decoded.y += decoded.y >= 0.0f ? -fold : fold;
+	return Normalize(decoded);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "MathTypes.h"
+
+// Vertex layout of the Lighting sample (POSITION, NORMAL)
+struct VertexData
+{
+	Float3 Position;
+	Float3 Normal;
+};
+
+// Vertex layout of the Box sample (POSITION, COLOR)
+struct ColorVertexData
+{
+	Float3 Position;
+	Float4 Color;
+};
+
+// Compact vertex layout of the Lighting sample, 12 bytes (POSITION as SHORT4_SNORM, NORMAL as SHORT2_SNORM).
+// Position is mapped into [-1, 1] by the VertexQuantization of its mesh, w is unused. Normal is octahedral encoded.
+struct QuantizedVertexData
+{
+	int16_t Position[4];
+	int16_t Normal[2];
+};
+
+// Compact vertex layout of the Box sample, 12 bytes (POSITION as SHORT4_SNORM, COLOR as UBYTE4_UNORM)
+struct QuantizedColorVertexData
+{
+	int16_t Position[4];
+	uint8_t Color[4];
+};
+
+// Matrices of one object as the vertex shaders read them, computed by ComputeObjectMatrices.
+// Every matrix is stored transposed, so each Float4 is one column and a transform is a dot product per component.
+struct ObjectMatrices
+{
+	Float4 WorldViewProjection[4];
+
+	// Affine, the fourth column is always (0, 0, 0, 1)
+	Float4 World[3];
+
+	// Inverse transpose of the upper 3x3 of World, w is 0
+	Float4 Normal[3];
+};
+
+// Per-instance stream of the instanced samples (WORLDVIEWPROJECTION0-3, WORLD0-2, NORMALMATRIX0-2, COLOR)
+struct InstanceData
+{
+	ObjectMatrices Matrices;
+	Float4 Color;
+};
@@ -0,0 +1,408 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../Box/BoxScene.h"
+#include "../Common/Clock.h"
+#include "../Common/FrameLoop.h"
+#include "../Common/NullRenderDevice.h"
+#include "../Common/SoftwareRenderDevice.h"
+#include "../Lighting/LightingScene.h"
+
+// Same back buffer size as the windowed samples
+constexpr int32_t WIN_WIDTH = 1600;
+constexpr int32_t WIN_HEIGHT = 900;
+
+// Fixed time step so that every run renders the same frames
+constexpr float FRAME_DELTA_TIME = 1.0f / 60.0f;
+
+// --simulation-spike adds its busy time to every this many simulation steps
+constexpr uint32_t SIMULATION_SPIKE_INTERVAL = 10;
+
+struct CommandLineOptions
+{
+	const char* SceneName = "lighting";
+	const char* DeviceName = "software";
+	int32_t FrameCount = 100;
+	uint32_t ThreadCount = 0;
+	uint32_t UpdateThreadCount = 0;
+	uint32_t InstanceCount = 1;
+	bool bInstancing = true;
+	uint32_t OccluderBudget = 0;
+	bool bQuantizedVertices = false;
+	bool bMeshletCulling = true;
+	const char* MeshCacheFileName = LIGHTING_MESH_CACHE_FILE_NAME;
+	bool bIcosphere = false;
+	bool bSimulationThread = false;
+	bool bCommandLists = false;
+	double SimulationSpikeTime = 0.0;
+	float FixedDeltaTime = FRAME_DELTA_TIME;
+	const char* OutputFileName = nullptr;
+	bool bPrintFrames = false;
+};
+
+bool ParseCommandLine(int argc, char** argv, CommandLineOptions& outOptions);
+void PrintLodStats(const LodStats& lodStats);
+void SpinMilliseconds(double milliseconds);
+
+int main(int argc, char** argv)
+{
+	CommandLineOptions options;
+	if (!ParseCommandLine(argc, argv, options))
+	{
+		printf("Usage: %s [--scene lighting|box] [--device null|software] [--frames N] [--threads N] [--update-threads N] [--instances N] [--per-object-draws] [--occluders N] [--quantized-vertices] [--no-meshlet-culling] [--mesh-cache file.mesh] [--icosphere] [--simulation-thread] [--simulation-spike ms] [--command-lists] [--fixed-dt seconds] [--output image.ppm] [--per-frame]\n", argv[0]);
+		return 1;
+	}
+
+	NullRenderDevice nullDevice;
+	SoftwareRenderDevice softwareDevice;
+	NullRenderDevice* device = nullptr;
+	if (!strcmp(options.DeviceName, "software"))
+	{
+		if (!softwareDevice.Init(WIN_WIDTH, WIN_HEIGHT, options.ThreadCount))
+		{
+			printf("Failed to initialize the software device\n");
+			return 1;
+		}
+		device = &softwareDevice;
+	}
+	else
+	{
+		nullDevice.Init(false);
+		device = &nullDevice;
+	}
+
+	LightingSceneOptions lightingOptions;
+	lightingOptions.InstanceCount = options.InstanceCount;
+	lightingOptions.bInstancing = options.bInstancing;
+	lightingOptions.OccluderBudget = options.OccluderBudget;
+	lightingOptions.bQuantizedVertices = options.bQuantizedVertices;
+	lightingOptions.bMeshletCulling = options.bMeshletCulling;
+	lightingOptions.MeshCacheFileName = options.MeshCacheFileName;
+	lightingOptions.bIcosphere = options.bIcosphere;
+	lightingOptions.UpdateThreadCount = options.UpdateThreadCount;
+	lightingOptions.bSimulationThread = options.bSimulationThread;
+	lightingOptions.bCommandLists = options.bCommandLists;
+	LightingScene lightingScene(lightingOptions);
+
+	BoxSceneOptions boxOptions;
+	boxOptions.InstanceCount = options.InstanceCount;
+	boxOptions.bInstancing = options.bInstancing;
+	boxOptions.OccluderBudget = options.OccluderBudget;
+	boxOptions.bQuantizedVertices = options.bQuantizedVertices;
+	BoxScene boxScene(boxOptions);
+	Scene* scene = !strcmp(options.SceneName, "box") ? (Scene*)&boxScene : (Scene*)&lightingScene;
+	const OcclusionStats& occlusionStats = scene == &boxScene ? boxScene.GetOcclusionStats() : lightingScene.GetOcclusionStats();
+	const LodStats* lodStats = scene == &lightingScene ? &lightingScene.GetLodStats() : nullptr;
+	const MeshletStats* meshletStats = scene == &lightingScene && options.bMeshletCulling ? &lightingScene.GetMeshletStats() : nullptr;
+	const CommandListStats* commandListStats = options.bCommandLists ? &lightingScene.GetCommandListStats() : nullptr;
+	const DrawSortStats* drawSortStats = scene == &lightingScene ? &lightingScene.GetDrawSortStats() : nullptr;
+	const MeshOptimizationStats& meshStats = scene == &boxScene ? boxScene.GetMeshOptimizationStats() : lightingScene.GetMeshOptimizationStats();
+	const uint32_t vertexSize = scene == &boxScene ? boxScene.GetVertexSize() : lightingScene.GetVertexSize();
+	const VertexQuantizationError& quantizationError = scene == &boxScene ? boxScene.GetVertexQuantizationError() : lightingScene.GetVertexQuantizationError();
+	const uint64_t initTicks = Clock::GetTicks();
+	if (!scene->Init(device, WIN_WIDTH, WIN_HEIGHT))
+	{
+		printf("Failed to initialize the %s scene on the %s device\n", scene->GetName(), device->GetName());
+		return 1;
+	}
+	const double initMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - initTicks);
+
+	printf("Scene: %s    device: %s    %dx%d    %d frames    %u instances (%s)    %u occluders", scene->GetName(), device->GetName(), WIN_WIDTH, WIN_HEIGHT, options.FrameCount,
+		options.InstanceCount, options.bInstancing ? "instanced" : "per-object draws", options.OccluderBudget);
+	if (device == &softwareDevice)
+	{
+		printf("    %u threads", softwareDevice.GetRasterizer().GetThreadCount());
+	}
+	if (scene == &lightingScene)
+	{
+		printf("    %u update threads", lightingScene.GetUpdateThreadCount());
+	}
+	if (options.bSimulationThread)
+	{
+		printf("    simulation thread");
+	}
+	if (options.bCommandLists)
+	{
+		printf("    command lists");
+	}
+	if (options.SimulationSpikeTime > 0.0)
+	{
+		printf("    %.3f ms spike every %u steps", options.SimulationSpikeTime, SIMULATION_SPIKE_INTERVAL);
+	}
+	printf("\n");
+	if (scene == &lightingScene && lightingScene.IsMeshCacheLoaded())
+	{
+		printf("Meshes: mapped from %s    init: %.3f ms\n", options.MeshCacheFileName, initMilliseconds);
+	}
+	else
+	{
+		printf("Meshes: %llu triangles    ACMR: %.3f -> %.3f    ATVR: %.3f -> %.3f (%u-entry FIFO cache)    init: %.3f ms\n", (unsigned long long)meshStats.After.TriangleCount,
+			meshStats.Before.GetAcmr(), meshStats.After.GetAcmr(), meshStats.Before.GetAtvr(), meshStats.After.GetAtvr(), VERTEX_CACHE_SIZE, initMilliseconds);
+	}
+	printf("Vertices: %u bytes", vertexSize);
+	if (options.bQuantizedVertices)
+	{
+		printf(" (quantized)    max position error: %g    max normal error: %g degrees    max color error: %g", quantizationError.MaxPositionError,
+			quantizationError.MaxNormalAngle, quantizationError.MaxColorError);
+	}
+	printf("\n");
+
+	// No window, so the input never changes
+	const InputState input{};
+
+	FrameLoop loop;
+	loop.Reset(options.FixedDeltaTime, true);
+
+	// Stands in for a physics or AI step that takes longer every now and then
+	uint32_t simulationStepIndex = 0;
+	const auto simulationSpike = [&]()
+	{
+		if (options.SimulationSpikeTime > 0.0 && ++simulationStepIndex % SIMULATION_SPIKE_INTERVAL == 0)
+		{
+			SpinMilliseconds(options.SimulationSpikeTime);
+		}
+	};
+
+	// The simulation thread steps at the fixed time step in real time, and the frames go on as fast as they can
+	if (options.bSimulationThread)
+	{
+		loop.StartSimulation(options.FixedDeltaTime > 0.0f ? options.FixedDeltaTime : FRAME_DELTA_TIME, [&](float deltaTime)
+			{
+				lightingScene.Simulate(deltaTime);
+				simulationSpike();
+			});
+	}
+
+	int32_t frameIndex = 0;
+	loop.Run(options.FrameCount,
+		[&](float deltaTime)
+		{
+			scene->Update(deltaTime, input);
+			if (!options.bSimulationThread)
+			{
+				simulationSpike();
+			}
+		},
+		[&]()
+		{
+			scene->Render();
+
+			if (options.bPrintFrames)
+			{
+				const RenderDeviceStats& stats = device->GetFrameStats();
+				printf("frame %4d    draws: %u    instances: %llu    triangles: %llu    state changes: %u (filtered: %u)    upload: %llu bytes (constants: %llu)",
+					frameIndex, stats.DrawCount, (unsigned long long)stats.InstanceCount, (unsigned long long)(stats.IndexCount / 3), stats.StateChangeCount, stats.FilteredStateChangeCount,
+					(unsigned long long)stats.UploadBytes, (unsigned long long)stats.ConstantUploadBytes);
+				if (lodStats)
+				{
+					PrintLodStats(*lodStats);
+				}
+				if (meshletStats)
+				{
+					printf("    clusters culled: %u/%u    triangles culled: %llu/%llu", meshletStats->FrustumCulledCount + meshletStats->BackfaceCulledCount,
+						meshletStats->MeshletCount, (unsigned long long)meshletStats->CulledTriangleCount, (unsigned long long)meshletStats->TriangleCount);
+				}
+				if (device == &softwareDevice)
+				{
+					const RasterizerStats& rasterizerStats = softwareDevice.GetRasterizerStats();
+					printf("    clear: %6.3f    vertex: %6.3f    setup: %6.3f    raster: %7.3f    pixels: %llu",
+						rasterizerStats.ClearTime, rasterizerStats.VertexTime, rasterizerStats.SetupTime, rasterizerStats.RasterTime,
+						(unsigned long long)rasterizerStats.ShadedPixelCount);
+				}
+				if (options.OccluderBudget > 0)
+				{
+					printf("    occluded: %u/%u    occlusion: %6.3f", occlusionStats.RejectedCount, occlusionStats.TestedCount,
+						occlusionStats.SetupTime + occlusionStats.RasterTime + occlusionStats.TestTime);
+				}
+				printf("\n");
+			}
+			++frameIndex;
+		});
+	loop.StopSimulation();
+
+	loop.PrintSummary(stdout);
+
+	const RenderDeviceStats& stats = device->GetFrameStats();
+	printf("last frame    draws: %u    instances: %llu    indices: %llu    state changes: %u (filtered: %u)    buffer updates: %u    upload: %llu bytes (constants: %llu)\n",
+		stats.DrawCount, (unsigned long long)stats.InstanceCount, (unsigned long long)stats.IndexCount, stats.StateChangeCount, stats.FilteredStateChangeCount,
+		stats.BufferUpdateCount, (unsigned long long)stats.UploadBytes, (unsigned long long)stats.ConstantUploadBytes);
+	const StateCacheStats& stateCacheStats = device->GetStateCacheStats();
+	printf("state objects    created: %u    reused: %u\n", stateCacheStats.CreatedCount, stateCacheStats.ReusedCount);
+
+	if (lodStats)
+	{
+		printf("last frame    triangles: %llu", (unsigned long long)lodStats->TriangleCount);
+		PrintLodStats(*lodStats);
+		printf("\n");
+	}
+
+	if (meshletStats)
+	{
+		printf("last frame    meshlet objects: %u    clusters: %u    frustum culled: %u    backface culled: %u    triangles: %llu    culled: %llu    cull: %.3f ms\n",
+			meshletStats->ObjectCount, meshletStats->MeshletCount, meshletStats->FrustumCulledCount, meshletStats->BackfaceCulledCount,
+			(unsigned long long)meshletStats->TriangleCount, (unsigned long long)meshletStats->CulledTriangleCount, meshletStats->CullTime);
+	}
+
+	if (drawSortStats)
+	{
+		printf("last frame    draw keys: %u    radix passes: %u (skipped: %u)    keys: %.3f ms    sort: %.3f ms    state changes: %u (unsorted: %u)\n",
+			drawSortStats->KeyCount, drawSortStats->PassCount, drawSortStats->SkippedPassCount, drawSortStats->KeyTime, drawSortStats->SortTime,
+			drawSortStats->StateChangeCount, drawSortStats->UnsortedStateChangeCount);
+	}
+
+	if (commandListStats)
+	{
+		const double recordSeconds = commandListStats->RecordTime / 1000.0;
+		printf("last frame    command lists: %u    commands: %llu    record: %.3f ms (%.2f M commands/s over %u threads)    execute: %.3f ms\n", commandListStats->ListCount,
+			(unsigned long long)commandListStats->CommandCount, commandListStats->RecordTime,
+			recordSeconds > 0.0 ? commandListStats->CommandCount / recordSeconds / 1000000.0 : 0.0, lightingScene.GetUpdateThreadCount(), commandListStats->ExecuteTime);
+	}
+
+	if (options.OccluderBudget > 0)
+	{
+		printf("last frame    occluders: %u    occluder triangles: %u    tested: %u    rejected: %u    setup: %.3f ms    raster: %.3f ms    test: %.3f ms\n",
+			occlusionStats.OccluderCount, occlusionStats.OccluderTriangleCount, occlusionStats.TestedCount, occlusionStats.RejectedCount,
+			occlusionStats.SetupTime, occlusionStats.RasterTime, occlusionStats.TestTime);
+	}
+
+	printf("validation errors: %u\n", device->GetValidationErrorCount());
+	for (const std::string& message : device->GetValidationMessages())
+	{
+		printf("    %s\n", message.c_str());
+	}
+
+	int32_t result = device->GetValidationErrorCount() ? 1 : 0;
+	if (device == &softwareDevice)
+	{
+		if (softwareDevice.GetSkippedDrawCount())
+		{
+			printf("%u draws per frame skipped, the software device only implements Lighting.hlsl\n", softwareDevice.GetSkippedDrawCount());
+		}
+		printf("Checksum: %016llx\n", (unsigned long long)softwareDevice.GetRasterizer().ComputeChecksum());
+
+		if (options.OutputFileName && !softwareDevice.GetRasterizer().SaveImage(options.OutputFileName))
+		{
+			printf("Failed to write %s\n", options.OutputFileName);
+			result = 1;
+		}
+	}
+
+	scene->Free();
+	device->Free();
+
+	return result;
+}
+
+bool ParseCommandLine(int argc, char** argv, CommandLineOptions& outOptions)
+{
+	for (int32_t i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+		if (!strcmp(argv[i], "--scene") && bHasValue)
+		{
+			outOptions.SceneName = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--device") && bHasValue)
+		{
+			outOptions.DeviceName = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--frames") && bHasValue)
+		{
+			outOptions.FrameCount = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--threads") && bHasValue)
+		{
+			outOptions.ThreadCount = (uint32_t)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--update-threads") && bHasValue)
+		{
+			outOptions.UpdateThreadCount = (uint32_t)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--instances") && bHasValue)
+		{
+			outOptions.InstanceCount = (uint32_t)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--per-object-draws"))
+		{
+			outOptions.bInstancing = false;
+		}
+		else if (!strcmp(argv[i], "--occluders") && bHasValue)
+		{
+			outOptions.OccluderBudget = (uint32_t)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--quantized-vertices"))
+		{
+			outOptions.bQuantizedVertices = true;
+		}
+		else if (!strcmp(argv[i], "--no-meshlet-culling"))
+		{
+			outOptions.bMeshletCulling = false;
+		}
+		else if (!strcmp(argv[i], "--mesh-cache") && bHasValue)
+		{
+			outOptions.MeshCacheFileName = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--icosphere"))
+		{
+			outOptions.bIcosphere = true;
+		}
+		else if (!strcmp(argv[i], "--simulation-thread"))
+		{
+			outOptions.bSimulationThread = true;
+		}
+		else if (!strcmp(argv[i], "--simulation-spike") && bHasValue)
+		{
+			outOptions.SimulationSpikeTime = atof(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--command-lists"))
+		{
+			outOptions.bCommandLists = true;
+		}
+		else if (!strcmp(argv[i], "--fixed-dt") && bHasValue)
+		{
+			outOptions.FixedDeltaTime = (float)atof(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--output") && bHasValue)
+		{
+			outOptions.OutputFileName = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--per-frame"))
+		{
+			outOptions.bPrintFrames = true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	const bool bValidScene = !strcmp(outOptions.SceneName, "lighting") || !strcmp(outOptions.SceneName, "box");
+	const bool bValidDevice = !strcmp(outOptions.DeviceName, "null") || !strcmp(outOptions.DeviceName, "software");
+
+	// Only Lighting splits its simulation from the frame, and records its per-object draws into command lists
+	const bool bValidSimulation = !outOptions.bSimulationThread || !strcmp(outOptions.SceneName, "lighting");
+	const bool bValidCommandLists = !outOptions.bCommandLists || (!strcmp(outOptions.SceneName, "lighting") && !outOptions.bInstancing);
+
+	return bValidScene && bValidDevice && bValidSimulation && bValidCommandLists && outOptions.FrameCount > 0 && outOptions.InstanceCount > 0 && outOptions.FixedDeltaTime >= 0.0f;
+}
+
+// Objects per level of detail, most detailed first
+void PrintLodStats(const LodStats& lodStats)
+{
+	printf("    lods:");
+	for (uint32_t level = 0; level < lodStats.LevelCount; ++level)
+	{
+		printf(level ? "/%u" : " %u", lodStats.ObjectCounts[level]);
+	}
+}
+
+// Busy rather than asleep, so that it takes the CPU like real work would
+void SpinMilliseconds(double milliseconds)
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+	while (Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks) < milliseconds)
+	{
+	}
+}
@@ -1,44 +1,134 @@
-cbuffer ConstantBuffer : register(b0)
+// Constants are split by how often they change
+cbuffer FrameConstants : register(b0)
 {
-    float4x4 WorldMatrix;
-    float4x4 ViewMatrix;
-    float4x4 ProjectionMatrix;
     float4 WorldLightPosition;
+}
+
+cbuffer ViewConstants : register(b1)
+{
     float4 WorldCameraPosition;
 }
 
-struct VS_INPUT
+// Bound per draw from the dynamic ring buffer, only read by VSPerObject and VSQuantizedPerObject.
+// The matrices are written transposed, which is the default column_major packing.
+cbuffer ObjectConstants : register(b2)
+{
+    float4x4 WorldViewProjection;
+    float4x3 World;
+    float3x3 NormalMatrix;
+    float4 ObjectColor;
+}
+
+// Only read by VSQuantized and VSQuantizedPerObject, position = quantized position * PositionScale + PositionBias
+cbuffer MeshConstants : register(b3)
+{
+    float4 PositionScale;
+    float4 PositionBias;
+}
+
+struct VS_VERTEX_INPUT
 {
     float4 Position : POSITION;
     float3 Normal : NORMAL;
 };
 
+// QuantizedVertexData, the position in SNORM16 and the normal octahedral encoded in two SNORM16
+struct VS_QUANTIZED_VERTEX_INPUT
+{
+    float4 Position : POSITION;
+    float2 Normal : NORMAL;
+};
+
+// Per instance, every matrix by columns
+struct VS_INSTANCE_INPUT
+{
+    float4 WorldViewProjection0 : WORLDVIEWPROJECTION0;
+    float4 WorldViewProjection1 : WORLDVIEWPROJECTION1;
+    float4 WorldViewProjection2 : WORLDVIEWPROJECTION2;
+    float4 WorldViewProjection3 : WORLDVIEWPROJECTION3;
+    float4 World0 : WORLD0;
+    float4 World1 : WORLD1;
+    float4 World2 : WORLD2;
+    float4 NormalMatrix0 : NORMALMATRIX0;
+    float4 NormalMatrix1 : NORMALMATRIX1;
+    float4 NormalMatrix2 : NORMALMATRIX2;
+    float4 Color : COLOR;
+};
+
 struct VS_OUTPUT
 {
     float4 Position : SV_Position;
     float3 Normal : TEXCOORD0;
     float3 LightDirection : TEXCOORD1;
     float3 ViewDirection : TEXCOORD2;
+    nointerpolation float3 Color : COLOR;
 };
 
-VS_OUTPUT VS(VS_INPUT input)
+VS_OUTPUT ShadeVertex(float4 position, float3 worldPosition, float3 worldNormal, float3 color)
 {
     VS_OUTPUT output;
-    output.Position = mul(input.Position, WorldMatrix);
+    output.Position = position;
     
-    output.LightDirection = normalize(output.Position.xyz - WorldLightPosition.xyz);
+    output.LightDirection = normalize(worldPosition - WorldLightPosition.xyz);
     
-    output.ViewDirection = normalize(output.Position.xyz - WorldCameraPosition.xyz);
+    output.ViewDirection = normalize(worldPosition - WorldCameraPosition.xyz);
     
-    output.Position = mul(output.Position, ViewMatrix);
-    output.Position = mul(output.Position, ProjectionMatrix);
+    output.Normal = normalize(worldNormal);
     
-    output.Normal = mul(input.Normal, (float3x3) WorldMatrix);
-    output.Normal = normalize(output.Normal);
+    output.Color = color;
     
     return output;
 }
 
+VS_OUTPUT ShadeInstance(float4 position, float3 normal, VS_INSTANCE_INPUT instance)
+{
+    // Rows built from the columns, so the vectors go on the right
+    float4x4 worldViewProjection = float4x4(instance.WorldViewProjection0, instance.WorldViewProjection1, instance.WorldViewProjection2, instance.WorldViewProjection3);
+    float3x4 world = float3x4(instance.World0, instance.World1, instance.World2);
+    float3x3 normalMatrix = float3x3(instance.NormalMatrix0.xyz, instance.NormalMatrix1.xyz, instance.NormalMatrix2.xyz);
+    
+    return ShadeVertex(mul(worldViewProjection, position), mul(world, position), mul(normalMatrix, normal), instance.Color.rgb);
+}
+
+VS_OUTPUT ShadeObject(float4 position, float3 normal)
+{
+    return ShadeVertex(mul(position, WorldViewProjection), mul(position, World), mul(normal, NormalMatrix), ObjectColor.rgb);
+}
+
+float4 DecodePosition(float4 position)
+{
+    return float4(position.xyz * PositionScale.xyz + PositionBias.xyz, 1.0f);
+}
+
+// Folds the lower half of the octahedron back under the square
+float3 DecodeOctahedralNormal(float2 normal)
+{
+    float3 decoded = float3(normal, 1.0f - abs(normal.x) - abs(normal.y));
+    float fold = saturate(-decoded.z);
+    decoded.xy += decoded.xy >= 0.0f ? -fold : fold;
+    return normalize(decoded);
+}
+
+VS_OUTPUT VS(VS_VERTEX_INPUT input, VS_INSTANCE_INPUT instance)
+{
+    return ShadeInstance(input.Position, input.Normal, instance);
+}
+
+VS_OUTPUT VSPerObject(VS_VERTEX_INPUT input)
+{
+    return ShadeObject(input.Position, input.Normal);
+}
+
+VS_OUTPUT VSQuantized(VS_QUANTIZED_VERTEX_INPUT input, VS_INSTANCE_INPUT instance)
+{
+    return ShadeInstance(DecodePosition(input.Position), DecodeOctahedralNormal(input.Normal), instance);
+}
+
+VS_OUTPUT VSQuantizedPerObject(VS_QUANTIZED_VERTEX_INPUT input)
+{
+    return ShadeObject(DecodePosition(input.Position), DecodeOctahedralNormal(input.Normal));
+}
+
 float4 PS(VS_OUTPUT input) : SV_Target
 {
     float3 diffuse = saturate(dot(-input.LightDirection, input.Normal));
@@ -55,5 +145,5 @@ float4 PS(VS_OUTPUT input) : SV_Target
     
     float3 ambient = float3(0.03f, 0.03f, 0.03f);
     
-    return float4(diffuse + specular + ambient, 1.0f);
+    return float4(diffuse * input.Color + specular + ambient * input.Color, 1.0f);
 }
@@ -0,0 +1,896 @@
+#include "LightingScene.h"
+
+#include <algorithm>
+#include <iterator>
+#include <math.h>
+#include <string.h>
+#include <utility>
+#include <vector>
+
+#include "../Common/Clock.h"
+#include "../Common/InstanceGrid.h"
+#include "../Common/PrimitiveMeshes.h"
+#include "../Common/Simd.h"
+
+namespace
+{
+	constexpr float CLEAR_COLOR[]{ 0.0f, 0.125f, 0.3f, 1.0f };
+
+	constexpr float OBJECT_ROTATION_SPEED = 45.0f;
+	constexpr float SPHERE_RADIUS = 1.0f;
+	constexpr float INSTANCE_SPACING = 3.0f;
+	constexpr uint32_t OBJECT_CONSTANT_RING_BUFFER_SIZE = 4 * 1024 * 1024;
+
+	// Slices and rings of every level of detail, most detailed first. The first one takes 32-bit indices.
+	constexpr int32_t LOD_SEGMENT_COUNTS[]{ 256, 128, 64, 32, 16, 8, 4 };
+	constexpr uint32_t LOD_COUNT = (uint32_t)std::size(LOD_SEGMENT_COUNTS);
+
+	// Subdivisions of every level with bIcosphere, from 81920 triangles down to the icosahedron. All of them take 16-bit indices.
+	constexpr int32_t ICOSPHERE_LOD_LEVELS[]{ 6, 5, 4, 3, 2, 1, 0 };
+	static_assert(std::size(ICOSPHERE_LOD_LEVELS) == LOD_COUNT, "Both chains must have the same number of levels");
+
+	// Angle between the centers of two neighboring icosahedron vertices, atan(2). Every subdivision halves the edges.
+	constexpr float ICOSAHEDRON_EDGE_ANGLE = 1.10714872f;
+
+	// Bump when GenerateMeshes makes other meshes for the same LOD_SEGMENT_COUNTS, so that older cache files are regenerated
+	constexpr uint32_t MESH_GENERATOR_VERSION = 2;
+
+	// A level is detailed enough while its edges along the silhouette are at most this long on screen
+	constexpr float LOD_EDGE_PIXELS = 10.0f;
+	constexpr float LOD_HYSTERESIS = 0.1f;
+
+	// Low LOD sphere for the occlusion buffer, shrunk to fit inside the levels up to OCCLUDER_MAX_LOD.
+	// Spheres drawn at coarser levels are too small on screen to be worth it.
+	constexpr int32_t OCCLUDER_SLICE_COUNT = 8;
+	constexpr int32_t OCCLUDER_RING_COUNT = 6;
+	constexpr uint32_t OCCLUDER_MAX_LOD = 4;
+	constexpr int32_t OCCLUSION_BUFFER_WIDTH = 320;
+
+	// The three most detailed levels (8 thousand triangles and more, or 5 thousand with icospheres) are culled per meshlet, coarser ones have too few meshlets to gain from it.
+	// Objects past what fits into the ring buffer in one frame are drawn whole.
+	constexpr uint32_t MESHLET_MAX_LOD = 2;
+	constexpr uint32_t MESHLET_INDEX_RING_BUFFER_SIZE = 8 * 1024 * 1024;
+
+	// Visible objects per command list with bCommandLists, a few thousand calls each
+	constexpr uint32_t COMMAND_LIST_OBJECT_COUNT = 1024;
+
+	// Objects per job of the parallel update stages. Every batch but the last starts and ends on a SIMD_WIDTH boundary, so the
+	// SIMD kernels take the same path as in a single pass over all objects.
+	constexpr uint32_t UPDATE_BATCH_SIZE = 4096;
+	static_assert(UPDATE_BATCH_SIZE % SIMD_WIDTH == 0, "Batches must hold whole SIMD iterations");
+
+	constexpr Float4 LIGHT_WORLD_POSITION{ 5.0f, 5.0f, 0.0f, 1.0f };
+
+	constexpr float FOV = ConvertToRadians(45.0f);
+	constexpr float NEAR_Z = 0.1f;
+	constexpr float FAR_Z = 1000.0f;
+
+	PrimitiveShape GetLodShape(bool bIcosphere, uint32_t level)
+	{
+		return bIcosphere ? PrimitiveShape{ PRIMITIVE_TYPE_ICOSPHERE, ICOSPHERE_LOD_LEVELS[level], 0 }
+			: PrimitiveShape{ PRIMITIVE_TYPE_UV_SPHERE, LOD_SEGMENT_COUNTS[level], LOD_SEGMENT_COUNTS[level] };
+	}
+
+	// Edges along a great circle of a level, the slices of a UV sphere
+	float GetLodSilhouetteEdgeCount(bool bIcosphere, uint32_t level)
+	{
+		return bIcosphere ? TWO_PI / ICOSAHEDRON_EDGE_ANGLE * (float)(1 << ICOSPHERE_LOD_LEVELS[level]) : (float)LOD_SEGMENT_COUNTS[level];
+	}
+}
+
+bool LightingScene::Init(RenderDevice* device, int32_t width, int32_t height)
+{
+	Device = device;
+	Width = width;
+	Height = height;
+
+	// Map the meshes and their meshlets from the cache file, or generate them when it does not hold these meshes
+	if (MeshCacheFileName && MeshFile.Open(MeshCacheFileName, GetMeshCacheKey(bIcosphere)) && (!bQuantizedVertices || MeshFile.GetView().QuantizedVertices)
+		&& (!bMeshletCulling || MeshFile.GetView().MeshletLodCount > MESHLET_MAX_LOD))
+	{
+		Meshes = MeshFile.GetView();
+	}
+	else
+	{
+		MeshFile.Close();
+		GenerateMeshes(bQuantizedVertices, GeneratedMeshes, &MeshStats, bIcosphere);
+		if (bMeshletCulling)
+		{
+			GenerateMeshlets(GeneratedMeshes);
+		}
+		Meshes = GeneratedMeshes.GetView();
+	}
+	Lods.assign(Meshes.Lods, Meshes.Lods + Meshes.LodCount);
+	if (bQuantizedVertices)
+	{
+		QuantizationError = Meshes.QuantizationError;
+	}
+
+	// Meshlets are ranges of Meshes.MeshletIndices, which holds the triangles of their levels in meshlet order. Whole levels
+	// are still drawn from the index buffer in the optimized order, which holds the same triangles.
+	if (bMeshletCulling)
+	{
+		LodMeshlets.resize(MESHLET_MAX_LOD + 1);
+		uint32_t firstMeshlet = 0;
+		for (uint32_t level = 0; level <= MESHLET_MAX_LOD; ++level)
+		{
+			LoadMeshletRecords(Meshes.Meshlets + firstMeshlet, Meshes.MeshletLodCounts[level], LodMeshlets[level]);
+			firstMeshlet += Meshes.MeshletLodCounts[level];
+		}
+	}
+
+	// Create vertex buffer, straight from the mapped file when there is one (from its decoded copy when it is compressed)
+	uint32_t vertexBufferSize = 0;
+	if (!ComputeBufferByteWidth(GetVertexSize(), Meshes.VertexCount, vertexBufferSize))
+	{
+		return false;
+	}
+
+	VertexBuffer = Device->CreateBuffer({ BUFFER_TYPE_VERTEX, BUFFER_USAGE_DEFAULT, vertexBufferSize },
+		bQuantizedVertices ? (const void*)Meshes.QuantizedVertices : (const void*)Meshes.Vertices);
+	if (!VertexBuffer.IsValid())
+	{
+		return false;
+	}
+
+	// Create index buffer
+	uint32_t indexBufferSize = 0;
+	if (!ComputeBufferByteWidth(Meshes.GetIndexSize(), Meshes.IndexCount, indexBufferSize))
+	{
+		return false;
+	}
+
+	IndexBuffer = Device->CreateBuffer({ BUFFER_TYPE_INDEX, BUFFER_USAGE_DEFAULT, indexBufferSize }, Meshes.Indices);
+	if (!IndexBuffer.IsValid())
+	{
+		return false;
+	}
+
+	if (bMeshletCulling)
+	{
+		MeshletDraws.resize(InstanceCount);
+		if (!MeshletIndexRingBuffer.Init(Device, BUFFER_TYPE_INDEX, MESHLET_INDEX_RING_BUFFER_SIZE))
+		{
+			return false;
+		}
+	}
+
+	// Place the spheres
+	std::vector<Float3> instancePositions;
+	std::vector<Float4> instanceColors;
+	GenerateInstanceGrid(InstanceCount, INSTANCE_SPACING, instancePositions, instanceColors);
+
+	Transforms.Resize(InstanceCount);
+	for (uint32_t i = 0; i < InstanceCount; ++i)
+	{
+		Transforms.PositionX[i] = instancePositions[i].x;
+		Transforms.PositionY[i] = instancePositions[i].y;
+		Transforms.PositionZ[i] = instancePositions[i].z;
+	}
+
+	Colors = instanceColors;
+	VisibleIndices.resize(InstanceCount);
+	DrawKeys.resize(InstanceCount);
+	DrawSorter.Reserve(InstanceCount);
+	VisibleTransforms.Resize(InstanceCount);
+	BatchVisibleCounts.resize((InstanceCount + UPDATE_BATCH_SIZE - 1) / UPDATE_BATCH_SIZE);
+
+	// The spheres only spin around their centers, so their bounds never change
+	ComputeSphereBounds(Transforms, Float3{ 0.0f, 0.0f, 0.0f }, SPHERE_RADIUS, Bounds);
+
+	// Level i lasts until LOD_EDGE_PIXELS pixels per silhouette edge of circumference
+	float lodMaxRadii[LOD_COUNT];
+	for (uint32_t i = 0; i < LOD_COUNT; ++i)
+	{
+		lodMaxRadii[i] = LOD_EDGE_PIXELS * GetLodSilhouetteEdgeCount(bIcosphere, i) / TWO_PI;
+	}
+	LodSelection.Init(lodMaxRadii, LOD_COUNT, InstanceCount, LOD_HYSTERESIS);
+	ProjectionScale = 0.5f * Height / tanf(0.5f * FOV);
+
+	// Create occlusion buffer
+	if (OccluderBudget > 0)
+	{
+		// Both spheres are small enough to be baked, so this copies them rather than generating them
+		std::vector<VertexData> occluderVertices;
+		MeshIndices occluderIndices;
+		GetPrimitiveMesh(GetLodShape(bIcosphere, OCCLUDER_MAX_LOD), occluderVertices, occluderIndices);
+		const float occluderRadius = ComputeInnerRadius(occluderVertices.data(), occluderIndices.Indices16.data(), occluderIndices.GetCount()) * SPHERE_RADIUS;
+
+		GetPrimitiveMesh(PrimitiveShape{ PRIMITIVE_TYPE_UV_SPHERE, OCCLUDER_SLICE_COUNT, OCCLUDER_RING_COUNT }, occluderVertices, occluderIndices);
+		Occluder.Indices = std::move(occluderIndices.Indices16);
+		Occluder.Positions.resize(occluderVertices.size());
+		for (size_t i = 0; i < occluderVertices.size(); ++i)
+		{
+			Occluder.Positions[i] = occluderVertices[i].Position * occluderRadius;
+		}
+
+		OccluderCandidates.resize(InstanceCount);
+		// Occlusion culling runs inside the update graph, so its tiles go to the same threads
+		if (!Occlusion.Init(OCCLUSION_BUFFER_WIDTH, OCCLUSION_BUFFER_WIDTH * Height / Width, Jobs))
+		{
+			return false;
+		}
+	}
+
+	// Create instance buffer, or the object constants without instancing
+	if (bInstancing)
+	{
+		uint32_t instanceBufferSize = 0;
+		if (!ComputeBufferByteWidth(sizeof(InstanceData), InstanceCount, instanceBufferSize))
+		{
+			return false;
+		}
+
+		Instances.resize(InstanceCount);
+		InstanceBuffer = Device->CreateBuffer({ BUFFER_TYPE_VERTEX, BUFFER_USAGE_DYNAMIC, instanceBufferSize }, nullptr);
+		if (!InstanceBuffer.IsValid())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		ObjectConstants.resize(InstanceCount);
+		if (!ObjectConstantRingBuffer.Init(Device, BUFFER_TYPE_CONSTANT, OBJECT_CONSTANT_RING_BUFFER_SIZE))
+		{
+			return false;
+		}
+
+		// Enough lists for the objects of one ring buffer write
+		if (bCommandLists)
+		{
+			const uint32_t objectsPerWrite = OBJECT_CONSTANT_RING_BUFFER_SIZE / sizeof(ObjectConstantBufferData);
+			const uint32_t maxObjectCount = InstanceCount < objectsPerWrite ? InstanceCount : objectsPerWrite;
+			ObjectCommandLists.resize((maxObjectCount + COMMAND_LIST_OBJECT_COUNT - 1) / COMMAND_LIST_OBJECT_COUNT);
+			for (CommandList*& commandList : ObjectCommandLists)
+			{
+				commandList = Device->CreateCommandList();
+				if (!commandList)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	// Create constant buffers
+	ProjectionMatrix = MatrixPerspectiveFovLH(FOV, Width / (float)Height, NEAR_Z, FAR_Z);
+
+	FrameConstants.WorldLightPosition = LIGHT_WORLD_POSITION;
+	FrameConstantBuffer = Device->CreateBuffer({ BUFFER_TYPE_CONSTANT, BUFFER_USAGE_DEFAULT, sizeof(FrameConstantBufferData) }, &FrameConstants);
+	if (!FrameConstantBuffer.IsValid())
+	{
+		return false;
+	}
+
+	ViewPosition = SceneCamera.Position;
+	ViewConstants.WorldCameraPosition = ToFloat4(ViewPosition, 1.0f);
+	ViewConstantBuffer = Device->CreateBuffer({ BUFFER_TYPE_CONSTANT, BUFFER_USAGE_DEFAULT, sizeof(ViewConstantBufferData) }, &ViewConstants);
+	if (!ViewConstantBuffer.IsValid())
+	{
+		return false;
+	}
+
+	if (bQuantizedVertices)
+	{
+		MeshConstantBuffer = Device->CreateBuffer({ BUFFER_TYPE_CONSTANT, BUFFER_USAGE_DEFAULT, sizeof(VertexQuantization) }, &Meshes.Quantization);
+		if (!MeshConstantBuffer.IsValid())
+		{
+			return false;
+		}
+	}
+
+	// Create rasterizer state
+	RasterizerDesc rasterizerDesc{ FILL_MODE_SOLID, CULL_MODE_NONE, false, true };
+	SolidRasterizerState = Device->CreateRasterizerState(rasterizerDesc);
+	if (!SolidRasterizerState.IsValid())
+	{
+		return false;
+	}
+
+	rasterizerDesc.FillMode = FILL_MODE_WIREFRAME;
+	WireframeRasterizerState = Device->CreateRasterizerState(rasterizerDesc);
+	if (!WireframeRasterizerState.IsValid())
+	{
+		return false;
+	}
+
+	// Depth test and opaque output, the defaults spelled out
+	DepthStencilState = Device->CreateDepthStencilState({ true, true, COMPARISON_FUNC_LESS });
+	BlendState = Device->CreateBlendState({ false, BLEND_ONE, BLEND_ZERO, BLEND_OP_ADD });
+	if (!DepthStencilState.IsValid() || !BlendState.IsValid())
+	{
+		return false;
+	}
+
+	// Create vertex shaders
+	VertexShader = Device->CreateVertexShader({ "Lighting.hlsl", nullptr, bQuantizedVertices ? "VSQuantized" : "VS", "vs_4_1" });
+	if (!VertexShader.IsValid())
+	{
+		return false;
+	}
+
+	PerObjectVertexShader = Device->CreateVertexShader({ "Lighting.hlsl", nullptr, bQuantizedVertices ? "VSQuantizedPerObject" : "VSPerObject", "vs_4_1" });
+	if (!PerObjectVertexShader.IsValid())
+	{
+		return false;
+	}
+
+	// Create input layouts
+	InputElementDesc elements[]
+	{
+		{ "POSITION", 0, VERTEX_FORMAT_FLOAT3, 0, 0 },
+		{ "NORMAL", 0, VERTEX_FORMAT_FLOAT3, 0, 12 },
+		{ "WORLDVIEWPROJECTION", 0, VERTEX_FORMAT_FLOAT4, 1, 0, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLDVIEWPROJECTION", 1, VERTEX_FORMAT_FLOAT4, 1, 16, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLDVIEWPROJECTION", 2, VERTEX_FORMAT_FLOAT4, 1, 32, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLDVIEWPROJECTION", 3, VERTEX_FORMAT_FLOAT4, 1, 48, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLD", 0, VERTEX_FORMAT_FLOAT4, 1, 64, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLD", 1, VERTEX_FORMAT_FLOAT4, 1, 80, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "WORLD", 2, VERTEX_FORMAT_FLOAT4, 1, 96, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "NORMALMATRIX", 0, VERTEX_FORMAT_FLOAT4, 1, 112, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "NORMALMATRIX", 1, VERTEX_FORMAT_FLOAT4, 1, 128, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "NORMALMATRIX", 2, VERTEX_FORMAT_FLOAT4, 1, 144, INPUT_CLASSIFICATION_PER_INSTANCE, 1 },
+		{ "COLOR", 0, VERTEX_FORMAT_FLOAT4, 1, 160, INPUT_CLASSIFICATION_PER_INSTANCE, 1 }
+	};
+	constexpr uint32_t numElements = (uint32_t)std::size(elements);
+
+	if (bQuantizedVertices)
+	{
+		elements[0] = { "POSITION", 0, VERTEX_FORMAT_SHORT4_SNORM, 0, 0 };
+		elements[1] = { "NORMAL", 0, VERTEX_FORMAT_SHORT2_SNORM, 0, 8 };
+	}
+
+	InputLayout = Device->CreateInputLayout(elements, numElements, VertexShader);
+	if (!InputLayout.IsValid())
+	{
+		return false;
+	}
+
+	// Only the per-vertex elements
+	PerObjectInputLayout = Device->CreateInputLayout(elements, 2, PerObjectVertexShader);
+	if (!PerObjectInputLayout.IsValid())
+	{
+		return false;
+	}
+
+	// Create pixel shader
+	PixelShader = Device->CreatePixelShader({ "Lighting.hlsl", nullptr, "PS", "ps_4_1" });
+	if (!PixelShader.IsValid())
+	{
+		return false;
+	}
+
+	CurrentRasterizerState = SolidRasterizerState;
+	Device->SetRasterizerState(CurrentRasterizerState);
+	Device->SetDepthStencilState(DepthStencilState);
+	Device->SetBlendState(BlendState);
+	Device->SetInputLayout(bInstancing ? InputLayout : PerObjectInputLayout);
+	Device->SetVertexBuffer(0, VertexBuffer, GetVertexSize(), 0);
+	Device->SetVertexBuffer(1, InstanceBuffer, sizeof(InstanceData), 0);
+	Device->SetIndexBuffer(IndexBuffer, Meshes.IndexFormat, 0);
+	Device->SetVertexShader(bInstancing ? VertexShader : PerObjectVertexShader);
+	Device->SetVertexConstantBuffer(0, FrameConstantBuffer);
+	Device->SetVertexConstantBuffer(1, ViewConstantBuffer);
+	if (bQuantizedVertices)
+	{
+		Device->SetVertexConstantBuffer(3, MeshConstantBuffer);
+	}
+	Device->SetPixelShader(PixelShader);
+
+	if (!Jobs.Init(UpdateThreadCount))
+	{
+		return false;
+	}
+	BuildUpdateGraph();
+
+	// The first frame shows the state before any step
+	LastSimulationState = GetSimulationState();
+	SimulationSnapshot& snapshot = Snapshots.GetWriteSlot();
+	snapshot.Previous = LastSimulationState;
+	snapshot.Current = LastSimulationState;
+	snapshot.DeltaTime = 0.0f;
+	snapshot.Ticks = Clock::GetTicks();
+	Snapshots.Publish();
+
+	return true;
+}
+
+void LightingScene::Update(float deltaTime, const InputState& input)
+{
+	if (input.Flags & INPUT_FLAGS_1)
+	{
+		CurrentRasterizerState = SolidRasterizerState;
+		Device->SetRasterizerState(CurrentRasterizerState);
+	}
+	if (input.Flags & INPUT_FLAGS_2)
+	{
+		CurrentRasterizerState = WireframeRasterizerState;
+		Device->SetRasterizerState(CurrentRasterizerState);
+	}
+
+	if (bSimulationThread)
+	{
+		SimulationInputs.GetWriteSlot() = input;
+		SimulationInputs.Publish();
+	}
+	else
+	{
+		SimulateStep(deltaTime, input);
+	}
+
+	// The newest snapshot stays in the read slot until a newer one comes
+	Snapshots.Acquire();
+	const SimulationSnapshot& snapshot = Snapshots.GetReadSlot();
+	SimulationState state = snapshot.Current;
+
+	// The frame lags one step behind the simulation thread, so that it falls between the two states of the newest snapshot.
+	// When the thread falls behind, the frame holds at its last state instead of guessing ahead.
+	if (bSimulationThread && snapshot.DeltaTime > 0.0f)
+	{
+		const float alpha = (float)(Clock::TicksToMilliseconds(Clock::GetTicks() - snapshot.Ticks) / (1000.0 * snapshot.DeltaTime));
+		if (alpha < 1.0f)
+		{
+			const SimulationState& previous = snapshot.Previous;
+			const SimulationState& current = snapshot.Current;
+			state.CameraPosition = previous.CameraPosition + (current.CameraPosition - previous.CameraPosition) * alpha;
+			state.CameraForward = Normalize(previous.CameraForward + (current.CameraForward - previous.CameraForward) * alpha);
+			state.CameraUp = Normalize(previous.CameraUp + (current.CameraUp - previous.CameraUp) * alpha);
+			state.ObjectRotationAngle = previous.ObjectRotationAngle + (current.ObjectRotationAngle - previous.ObjectRotationAngle) * alpha;
+		}
+	}
+
+	ViewPosition = state.CameraPosition;
+	const float halfAngle = 0.5f * ConvertToRadians(state.ObjectRotationAngle);
+	ObjectRotationSin = sinf(halfAngle);
+	ObjectRotationCos = cosf(halfAngle);
+
+	ViewProjectionMatrix = MatrixLookAtLH(state.CameraPosition, state.CameraPosition + state.CameraForward, state.CameraUp) * ProjectionMatrix;
+	ViewFrustum = ExtractFrustumPlanes(ViewProjectionMatrix);
+
+	UpdateGraph.Run(Jobs);
+}
+
+void LightingScene::Simulate(float deltaTime)
+{
+	SimulationInputs.Acquire();
+	SimulateStep(deltaTime, SimulationInputs.GetReadSlot());
+}
+
+void LightingScene::SimulateStep(float deltaTime, const InputState& input)
+{
+	SceneCamera.Update(deltaTime, input);
+	ObjectRotationAngle += OBJECT_ROTATION_SPEED * deltaTime;
+
+	SimulationSnapshot& snapshot = Snapshots.GetWriteSlot();
+	snapshot.Previous = LastSimulationState;
+	LastSimulationState = GetSimulationState();
+	snapshot.Current = LastSimulationState;
+	snapshot.DeltaTime = deltaTime;
+	snapshot.Ticks = Clock::GetTicks();
+	Snapshots.Publish();
+}
+
+LightingScene::SimulationState LightingScene::GetSimulationState() const
+{
+	SimulationState state;
+	state.CameraPosition = SceneCamera.Position;
+	state.CameraForward = SceneCamera.Forward;
+	state.CameraUp = SceneCamera.Up;
+	state.ObjectRotationAngle = ObjectRotationAngle;
+	return state;
+}
+
+// Spinning and culling do not touch the same data and start together. Level selection needs the culled objects, occlusion
+// culling the levels and the rotations. Meshlet culling and the matrices both follow the sorted objects, side by side.
+void LightingScene::BuildUpdateGraph()
+{
+	UpdateGraph.Clear();
+	const uint32_t spin = UpdateGraph.AddJob([this](uint32_t) { SpinObjects(); });
+	const uint32_t cull = UpdateGraph.AddJob([this](uint32_t) { CullObjects(); });
+	const uint32_t lods = UpdateGraph.AddJob([this](uint32_t) { SelectLods(); });
+	const uint32_t occlusion = UpdateGraph.AddJob([this](uint32_t) { CullOccludedObjects(); });
+	const uint32_t sort = UpdateGraph.AddJob([this](uint32_t) { SortObjects(); });
+	const uint32_t meshlets = UpdateGraph.AddJob([this](uint32_t) { CullMeshlets(); });
+	const uint32_t matrices = UpdateGraph.AddJob([this](uint32_t) { ComputeMatrices(); });
+
+	UpdateGraph.AddDependency(lods, cull);
+	UpdateGraph.AddDependency(occlusion, spin);
+	UpdateGraph.AddDependency(occlusion, lods);
+	UpdateGraph.AddDependency(sort, occlusion);
+	UpdateGraph.AddDependency(meshlets, sort);
+	UpdateGraph.AddDependency(matrices, sort);
+}
+
+// Every sphere spins in place around Y
+void LightingScene::SpinObjects()
+{
+	Jobs.ParallelFor(InstanceCount, UPDATE_BATCH_SIZE, [this](uint32_t begin, uint32_t end, uint32_t)
+		{
+			std::fill(Transforms.RotationY.begin() + begin, Transforms.RotationY.begin() + end, ObjectRotationSin);
+			std::fill(Transforms.RotationW.begin() + begin, Transforms.RotationW.begin() + end, ObjectRotationCos);
+		});
+}
+
+// Only objects inside the view frustum are kept. Every batch is culled into its own part of VisibleIndices, then the parts
+// are moved together.
+void LightingScene::CullObjects()
+{
+	Jobs.ParallelFor(InstanceCount, UPDATE_BATCH_SIZE, [this](uint32_t begin, uint32_t end, uint32_t)
+		{
+			BatchVisibleCounts[begin / UPDATE_BATCH_SIZE] = CullSpheres(ViewFrustum, Bounds, begin, end, VisibleIndices.data() + begin);
+		});
+
+	VisibleCount = 0;
+	for (uint32_t batch = 0; batch < (uint32_t)BatchVisibleCounts.size(); ++batch)
+	{
+		if (VisibleCount != batch * UPDATE_BATCH_SIZE)
+		{
+			memmove(VisibleIndices.data() + VisibleCount, VisibleIndices.data() + batch * UPDATE_BATCH_SIZE, BatchVisibleCounts[batch] * sizeof(uint32_t));
+		}
+		VisibleCount += BatchVisibleCounts[batch];
+	}
+}
+
+// Every object only writes its own level
+void LightingScene::SelectLods()
+{
+	Jobs.ParallelFor(VisibleCount, UPDATE_BATCH_SIZE, [this](uint32_t begin, uint32_t end, uint32_t)
+		{
+			LodSelection.Update(Bounds, VisibleIndices.data() + begin, end - begin, ViewPosition, ProjectionScale);
+		});
+}
+
+// Objects hidden behind the closest ones are dropped, the occlusion buffer spreads its tiles over the update jobs
+void LightingScene::CullOccludedObjects()
+{
+	if (OccluderBudget == 0)
+	{
+		return;
+	}
+
+	// The occluder only fits inside the detailed levels
+	uint32_t candidateCount = 0;
+	for (uint32_t i = 0; i < VisibleCount; ++i)
+	{
+		if (LodSelection.GetLevel(VisibleIndices[i]) <= OCCLUDER_MAX_LOD)
+		{
+			OccluderCandidates[candidateCount++] = VisibleIndices[i];
+		}
+	}
+
+	Occlusion.BeginFrame(ViewProjectionMatrix);
+	Occlusion.RasterizeClosestOccluders(Occluder, Transforms, OccluderCandidates.data(), candidateCount, ViewPosition, OccluderBudget);
+	VisibleCount = Occlusion.CullSpheres(Bounds, VisibleIndices.data(), VisibleCount);
+}
+
+// Objects are drawn by their keys, with the level of detail as the mesh and the distance of their bounds to the camera as the depth
+void LightingScene::SortObjects()
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+	const uint32_t shader = bInstancing ? VertexShader.Id : PerObjectVertexShader.Id;
+	const uint32_t state = CurrentRasterizerState.Id;
+	Jobs.ParallelFor(VisibleCount, UPDATE_BATCH_SIZE, [this, shader, state](uint32_t begin, uint32_t end, uint32_t)
+	{
+		for (uint32_t i = begin; i < end; ++i)
+		{
+			const uint32_t index = VisibleIndices[i];
+			const float dx = Bounds.CenterX[index] - ViewPosition.x;
+			const float dy = Bounds.CenterY[index] - ViewPosition.y;
+			const float dz = Bounds.CenterZ[index] - ViewPosition.z;
+			DrawKeys[i] = MakeDrawKey(DRAW_PASS_OPAQUE, shader, state, LodSelection.GetLevel(index), QuantizeDrawDepth(dx * dx + dy * dy + dz * dz));
+		}
+	});
+	const double keyTime = Clock::TicksToMilliseconds(Clock::GetTicks() - beginTicks);
+	const uint32_t unsortedStateChangeCount = CountDrawStateChanges(DrawKeys.data(), VisibleCount);
+
+	DrawSorter.Sort(DrawKeys.data(), VisibleIndices.data(), VisibleCount, &Jobs);
+
+	memset(LodObjectCounts, 0, sizeof(LodObjectCounts));
+	for (uint32_t i = 0; i < VisibleCount; ++i)
+	{
+		++LodObjectCounts[GetDrawKeyMesh(DrawKeys[i])];
+	}
+
+	const RadixSortStats& sortStats = DrawSorter.GetStats();
+	FrameDrawSortStats.KeyCount = VisibleCount;
+	FrameDrawSortStats.UnsortedStateChangeCount = unsortedStateChangeCount;
+	FrameDrawSortStats.StateChangeCount = CountDrawStateChanges(DrawKeys.data(), VisibleCount);
+	FrameDrawSortStats.PassCount = sortStats.PassCount;
+	FrameDrawSortStats.SkippedPassCount = sortStats.SkippedPassCount;
+	FrameDrawSortStats.KeyTime = keyTime;
+	FrameDrawSortStats.SortTime = sortStats.SortTime;
+
+	FrameLodStats.LevelCount = LOD_COUNT;
+	FrameLodStats.TriangleCount = 0;
+	for (uint32_t level = 0; level < LOD_COUNT; ++level)
+	{
+		FrameLodStats.ObjectCounts[level] = LodObjectCounts[level];
+		FrameLodStats.TriangleCount += (uint64_t)LodObjectCounts[level] * (Lods[level].IndexCount / 3);
+	}
+}
+
+// The detailed levels come first, their objects keep only the meshlets facing the camera inside the frustum.
+// The compacted indices are appended in order, so this stays on one thread.
+void LightingScene::CullMeshlets()
+{
+	MeshletObjectCount = 0;
+	if (!bMeshletCulling)
+	{
+		return;
+	}
+
+	const uint32_t indexSize = Meshes.GetIndexSize();
+	Meshlets.BeginFrame(indexSize);
+	for (uint32_t i = 0; i < VisibleCount; ++i)
+	{
+		const uint32_t level = LodSelection.GetLevel(VisibleIndices[i]);
+		if (level > MESHLET_MAX_LOD || Meshlets.GetIndexDataSize() + Lods[level].IndexCount * indexSize > MeshletIndexRingBuffer.GetSize())
+		{
+			break;
+		}
+
+		MeshletDraws[i] = Meshlets.CullObject(LodMeshlets[level], Meshes.MeshletIndices, Transforms, VisibleIndices[i], ViewFrustum, ViewPosition);
+		++MeshletObjectCount;
+	}
+}
+
+// Matrices are written straight into the instance stream or the object constants
+void LightingScene::ComputeMatrices()
+{
+	Jobs.ParallelFor(VisibleCount, UPDATE_BATCH_SIZE, [this](uint32_t begin, uint32_t end, uint32_t)
+		{
+			GatherTransforms(Transforms, VisibleIndices.data(), begin, end, VisibleTransforms);
+			if (bInstancing)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					Instances[i].Color = Colors[VisibleIndices[i]];
+				}
+				ComputeObjectMatrices(VisibleTransforms, begin, end, ViewProjectionMatrix, &Instances[begin].Matrices, sizeof(InstanceData));
+			}
+			else
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					ObjectConstants[i].Color = Colors[VisibleIndices[i]];
+				}
+				ComputeObjectMatrices(VisibleTransforms, begin, end, ViewProjectionMatrix, &ObjectConstants[begin].Matrices, sizeof(ObjectConstantBufferData));
+			}
+		});
+}
+
+void LightingScene::Render()
+{
+	Device->Clear(CLEAR_COLOR, 1.0f);
+
+	// Frame and view constants are only written when they change
+	FrameConstantBufferData frameConstants;
+	frameConstants.WorldLightPosition = LIGHT_WORLD_POSITION;
+	if (memcmp(&frameConstants, &FrameConstants, sizeof(frameConstants)) != 0)
+	{
+		FrameConstants = frameConstants;
+		Device->UpdateBuffer(FrameConstantBuffer, &FrameConstants, sizeof(FrameConstants));
+	}
+
+	ViewConstantBufferData viewConstants;
+	viewConstants.WorldCameraPosition = ToFloat4(ViewPosition, 1.0f);
+	if (memcmp(&viewConstants, &ViewConstants, sizeof(viewConstants)) != 0)
+	{
+		ViewConstants = viewConstants;
+		Device->UpdateBuffer(ViewConstantBuffer, &ViewConstants, sizeof(ViewConstants));
+	}
+
+	if (bInstancing)
+	{
+		RenderInstanced();
+	}
+	else
+	{
+		RenderPerObject();
+	}
+
+	Device->Present();
+}
+
+void LightingScene::RenderInstanced()
+{
+	if (VisibleCount == 0)
+	{
+		return;
+	}
+
+	// One upload for every visible instance and one draw per level of detail
+	Device->UpdateBuffer(InstanceBuffer, Instances.data(), (uint32_t)(sizeof(InstanceData) * VisibleCount));
+
+	// Objects culled per meshlet each draw their own indices, as a single instance
+	if (UploadMeshletIndices())
+	{
+		Device->SetIndexBuffer(MeshletIndexRingBuffer.GetBuffer(), Meshes.IndexFormat, MeshletIndexOffset);
+		for (uint32_t i = 0; i < MeshletObjectCount; ++i)
+		{
+			if (MeshletDraws[i].IndexCount > 0)
+			{
+				const MeshLod& lod = Lods[LodSelection.GetLevel(VisibleIndices[i])];
+				Device->DrawIndexedInstanced(MeshletDraws[i].IndexCount, 1, MeshletDraws[i].StartIndex, lod.BaseVertex, i);
+			}
+		}
+		Device->SetIndexBuffer(IndexBuffer, Meshes.IndexFormat, 0);
+	}
+
+	uint32_t levelStart = 0;
+	for (uint32_t level = 0; level < LOD_COUNT; ++level)
+	{
+		const uint32_t levelEnd = levelStart + LodObjectCounts[level];
+		const uint32_t firstInstance = levelStart > MeshletObjectCount ? levelStart : MeshletObjectCount;
+		if (levelEnd > firstInstance)
+		{
+			const MeshLod& lod = Lods[level];
+			Device->DrawIndexedInstanced(lod.IndexCount, levelEnd - firstInstance, lod.StartIndex, lod.BaseVertex, firstInstance);
+		}
+		levelStart = levelEnd;
+	}
+}
+
+void LightingScene::RenderPerObject()
+{
+	// Command lists bind their state themselves
+	const bool bMeshletIndicesBound = UploadMeshletIndices();
+	if (!bCommandLists)
+	{
+		BindPerObjectState(*Device, bMeshletIndicesBound);
+	}
+	FrameCommandListStats = CommandListStats{};
+
+	// Object constants go to the ring buffer in as few writes as fit, then every draw binds its own range.
+	// The draws of a write are submitted before the next write, which may discard the buffer.
+	const uint32_t objectsPerWrite = ObjectConstantRingBuffer.GetSize() / sizeof(ObjectConstantBufferData);
+	for (uint32_t first = 0; first < VisibleCount; first += objectsPerWrite)
+	{
+		const uint32_t objectCount = VisibleCount - first < objectsPerWrite ? VisibleCount - first : objectsPerWrite;
+		const uint32_t offset = ObjectConstantRingBuffer.Write(&ObjectConstants[first], objectCount * sizeof(ObjectConstantBufferData), CONSTANT_BUFFER_ALIGNMENT);
+		if (bCommandLists)
+		{
+			RecordObjectCommandLists(first, objectCount, offset, bMeshletIndicesBound);
+		}
+		else
+		{
+			DrawObjects(*Device, first, first + objectCount, first, offset, bMeshletIndicesBound);
+		}
+	}
+}
+
+void LightingScene::BindPerObjectState(RenderContext& context, bool bMeshletIndices)
+{
+	context.SetRasterizerState(CurrentRasterizerState);
+	context.SetDepthStencilState(DepthStencilState);
+	context.SetBlendState(BlendState);
+	context.SetInputLayout(PerObjectInputLayout);
+	context.SetVertexBuffer(0, VertexBuffer, GetVertexSize(), 0);
+	if (bMeshletIndices)
+	{
+		context.SetIndexBuffer(MeshletIndexRingBuffer.GetBuffer(), Meshes.IndexFormat, MeshletIndexOffset);
+	}
+	else
+	{
+		context.SetIndexBuffer(IndexBuffer, Meshes.IndexFormat, 0);
+	}
+	context.SetVertexShader(PerObjectVertexShader);
+	context.SetVertexConstantBuffer(0, FrameConstantBuffer);
+	context.SetVertexConstantBuffer(1, ViewConstantBuffer);
+	if (bQuantizedVertices)
+	{
+		context.SetVertexConstantBuffer(3, MeshConstantBuffer);
+	}
+	context.SetPixelShader(PixelShader);
+}
+
+void LightingScene::DrawObjects(RenderContext& context, uint32_t begin, uint32_t end, uint32_t first, uint32_t constantOffset, bool bMeshletIndicesBound)
+{
+	for (uint32_t object = begin; object < end; ++object)
+	{
+		if (object < MeshletObjectCount && MeshletDraws[object].IndexCount == 0)
+		{
+			continue;
+		}
+
+		// The objects culled per meshlet come first, the rest use the whole levels again
+		if (object == MeshletObjectCount && bMeshletIndicesBound)
+		{
+			context.SetIndexBuffer(IndexBuffer, Meshes.IndexFormat, 0);
+		}
+
+		context.SetVertexConstantBufferRange(2, ObjectConstantRingBuffer.GetBuffer(), constantOffset + (object - first) * sizeof(ObjectConstantBufferData), sizeof(ObjectConstantBufferData));
+		const MeshLod& lod = Lods[LodSelection.GetLevel(VisibleIndices[object])];
+		if (object < MeshletObjectCount)
+		{
+			context.DrawIndexed(MeshletDraws[object].IndexCount, MeshletDraws[object].StartIndex, lod.BaseVertex);
+		}
+		else
+		{
+			context.DrawIndexed(lod.IndexCount, lod.StartIndex, lod.BaseVertex);
+		}
+	}
+}
+
+void LightingScene::RecordObjectCommandLists(uint32_t first, uint32_t objectCount, uint32_t constantOffset, bool bMeshletIndicesBound)
+{
+	const uint64_t beginTicks = Clock::GetTicks();
+	Jobs.ParallelFor(objectCount, COMMAND_LIST_OBJECT_COUNT, [&](uint32_t begin, uint32_t end, uint32_t)
+		{
+			// A list that starts right at MeshletObjectCount switches to the whole levels in DrawObjects
+			const bool bMeshletIndices = bMeshletIndicesBound && first + begin <= MeshletObjectCount;
+			CommandList& commandList = *ObjectCommandLists[begin / COMMAND_LIST_OBJECT_COUNT];
+			commandList.Begin();
+			BindPerObjectState(commandList, bMeshletIndices);
+			DrawObjects(commandList, first + begin, first + end, first, constantOffset, bMeshletIndices);
+			commandList.End();
+		});
+
+	const uint64_t recordTicks = Clock::GetTicks();
+	const uint32_t listCount = (objectCount + COMMAND_LIST_OBJECT_COUNT - 1) / COMMAND_LIST_OBJECT_COUNT;
+	for (uint32_t list = 0; list < listCount; ++list)
+	{
+		Device->ExecuteCommandList(ObjectCommandLists[list]);
+		FrameCommandListStats.CommandCount += ObjectCommandLists[list]->GetCommandCount();
+	}
+
+	FrameCommandListStats.ListCount += listCount;
+	FrameCommandListStats.RecordTime += Clock::TicksToMilliseconds(recordTicks - beginTicks);
+	FrameCommandListStats.ExecuteTime += Clock::TicksToMilliseconds(Clock::GetTicks() - recordTicks);
+}
+
+bool LightingScene::UploadMeshletIndices()
+{
+	if (MeshletObjectCount == 0 || Meshlets.GetIndexDataSize() == 0)
+	{
+		return false;
+	}
+
+	MeshletIndexOffset = MeshletIndexRingBuffer.Write(Meshlets.GetIndexData(), Meshlets.GetIndexDataSize(), Meshes.GetIndexSize());
+	return true;
+}
+
+void LightingScene::Free()
+{
+	// Lists are owned by the device
+	ObjectCommandLists.clear();
+	Jobs.Free();
+	UpdateGraph.Clear();
+	Occlusion.Free();
+	MeshFile.Close();
+
+	// Resources are owned by the device
+	Device = nullptr;
+}
+
+void LightingScene::GenerateMeshes(bool bQuantize, MeshCacheData& outMeshes, MeshOptimizationStats* outStats, bool bIcosphere)
+{
+	PrimitiveShape shapes[LOD_COUNT];
+	for (uint32_t i = 0; i < LOD_COUNT; ++i)
+	{
+		shapes[i] = GetLodShape(bIcosphere, i);
+	}
+	GeneratePrimitiveLodMeshes(shapes, LOD_COUNT, bQuantize, outMeshes, outStats);
+}
+
+void LightingScene::GenerateMeshlets(MeshCacheData& inOutMeshes)
+{
+	BuildLodMeshlets(MESHLET_MAX_LOD + 1, inOutMeshes);
+}
+
+// UV sphere chains keep the key of the files written before there were icosphere chains
+uint64_t LightingScene::GetMeshCacheKey(bool bIcosphere)
+{
+	if (!bIcosphere)
+	{
+		return ComputeMeshCacheKey(LOD_SEGMENT_COUNTS, sizeof(LOD_SEGMENT_COUNTS), MESH_GENERATOR_VERSION);
+	}
+
+	PrimitiveShape shapes[LOD_COUNT];
+	for (uint32_t i = 0; i < LOD_COUNT; ++i)
+	{
+		shapes[i] = GetLodShape(true, i);
+	}
+	return ComputeMeshCacheKey(shapes, sizeof(shapes), MESH_GENERATOR_VERSION);
+}
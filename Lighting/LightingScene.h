@@ -0,0 +1,293 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "../Common/Camera.h"
+#include "../Common/DrawSortKey.h"
+#include "../Common/DynamicRingBuffer.h"
+#include "../Common/FrustumCulling.h"
+#include "../Common/JobSystem.h"
+#include "../Common/LodSelection.h"
+#include "../Common/MathTypes.h"
+#include "../Common/MeshCache.h"
+#include "../Common/MeshGenerator.h"
+#include "../Common/MeshOptimizer.h"
+#include "../Common/Meshlets.h"
+#include "../Common/ObjectTransforms.h"
+#include "../Common/OcclusionCulling.h"
+#include "../Common/RadixSort.h"
+#include "../Common/Scene.h"
+#include "../Common/TripleBuffer.h"
+#include "../Common/VertexQuantization.h"
+#include "../Common/VertexTypes.h"
+
+// Written next to Lighting.hlsl by MeshCacheWriter
+constexpr const char* LIGHTING_MESH_CACHE_FILE_NAME = "Lighting.mesh";
+
+// How LightingScene draws and updates its spheres. The members are described with the scene below.
+struct LightingSceneOptions
+{
+	uint32_t InstanceCount = 1;
+	bool bInstancing = true;
+
+	// Occluders drawn per frame. Off by default: from the default camera the grid shows the tops of the objects behind the
+	// closest ones, so they hide nothing and would only cost their rasterization.
+	uint32_t OccluderBudget = 0;
+	bool bQuantizedVertices = false;
+	bool bMeshletCulling = true;
+	const char* MeshCacheFileName = LIGHTING_MESH_CACHE_FILE_NAME;
+	bool bIcosphere = false;
+
+	// 0 for one per hardware thread
+	uint32_t UpdateThreadCount = 0;
+	bool bSimulationThread = false;
+	bool bCommandLists = false;
+};
+
+// Spheres lit by a point light (Lighting.hlsl). 1: Solid 2: Wireframe
+// Spheres outside the view frustum or behind the closest spheres (OcclusionCuller) are culled, and the matrices and colors
+// of the rest are uploaded once per frame into a per-instance vertex stream.
+// Every sphere is drawn at a level of detail picked from its size on screen (LodSelector), with one instanced draw per level.
+// Without bInstancing every sphere is drawn on its own, with its constants suballocated from a dynamic ring buffer.
+// With bCommandLists those draws are recorded by the update threads into one CommandList per chunk of visible spheres,
+// and the lists are executed in order.
+// With bMeshletCulling the detailed levels are split into meshlets, and the meshlets of every sphere drawn at them that face away
+// from the camera or are outside the view frustum are dropped on the CPU (MeshletCuller). The indices left are uploaded once per frame.
+// With bQuantizedVertices the mesh is uploaded as 12-byte QuantizedVertexData and decoded by VSQuantized.
+// The LOD chain and its meshlets are mapped from MeshCacheFileName and handed to CreateBuffer as they are, and only generated
+// when the file is missing or was written for other meshes.
+// With bIcosphere the levels are geodesic icospheres (GenerateIcosphere) rather than UV spheres, with triangles of about the same
+// size everywhere instead of thin ones crowded at the poles.
+// Frame and view constants are only written when they change.
+// WorldViewProjection and normal matrices of every visible sphere are composed on the CPU by ComputeObjectMatrices.
+// Update runs as a job graph on UpdateThreadCount threads (0 for one per hardware thread): spinning, culling and level selection
+// fan out over batches of objects, meshlet culling runs next to the matrices, and Render submits once all of them are done.
+// The frame is the same on any number of threads.
+// The camera and the spinning are simulated apart from the rest: every step publishes the state before and after it as an
+// immutable snapshot through a lock-free triple buffer, and Update builds the frame from the newest snapshot. With
+// bSimulationThread the steps run on another thread through Simulate, and Update shows the frame one step behind, interpolated
+// between the two states of the snapshot. Without it Update runs the step itself and shows its result as it is.
+class LightingScene : public Scene
+{
+public:
+	explicit LightingScene(const LightingSceneOptions& options = LightingSceneOptions{})
+		: InstanceCount(options.InstanceCount), bInstancing(options.bInstancing), OccluderBudget(options.OccluderBudget), bQuantizedVertices(options.bQuantizedVertices),
+		bMeshletCulling(options.bMeshletCulling), MeshCacheFileName(options.MeshCacheFileName), bIcosphere(options.bIcosphere),
+		UpdateThreadCount(options.UpdateThreadCount), bSimulationThread(options.bSimulationThread), bCommandLists(options.bCommandLists) {}
+
+	const char* GetName() const override { return "Lighting"; }
+
+	bool Init(RenderDevice* device, int32_t width, int32_t height) override;
+	void Update(float deltaTime, const InputState& input) override;
+	void Render() override;
+	void Free() override;
+
+	// One simulation step with the input last handed to Update. Only called from the simulation thread, with bSimulationThread.
+	void Simulate(float deltaTime);
+
+	// Owned by the simulation thread while it runs
+	const Camera& GetCamera() const { return SceneCamera; }
+	const OcclusionStats& GetOcclusionStats() const { return Occlusion.GetStats(); }
+	const LodStats& GetLodStats() const { return FrameLodStats; }
+	const MeshOptimizationStats& GetMeshOptimizationStats() const { return MeshStats; }
+	const MeshletStats& GetMeshletStats() const { return Meshlets.GetStats(); }
+	uint32_t GetUpdateThreadCount() const { return Jobs.GetThreadCount(); }
+	const CommandListStats& GetCommandListStats() const { return FrameCommandListStats; }
+	const DrawSortStats& GetDrawSortStats() const { return FrameDrawSortStats; }
+
+	// True when the meshes came from the cache file, MeshOptimizationStats are only known for generated meshes
+	bool IsMeshCacheLoaded() const { return MeshFile.IsOpen(); }
+
+	// The meshes of the scene as generated at startup without a cache file, and the key their cache files are written with
+	static void GenerateMeshes(bool bQuantize, MeshCacheData& outMeshes, MeshOptimizationStats* outStats = nullptr, bool bIcosphere = false);
+	// Adds the meshlets of the levels culled per meshlet, which bMeshletCulling needs in the cache file too
+	static void GenerateMeshlets(MeshCacheData& inOutMeshes);
+	static uint64_t GetMeshCacheKey(bool bIcosphere = false);
+
+	// Bytes of every vertex in the vertex buffer, and the precision lost to quantization (all zero without bQuantizedVertices)
+	uint32_t GetVertexSize() const { return bQuantizedVertices ? sizeof(QuantizedVertexData) : sizeof(VertexData); }
+	const VertexQuantizationError& GetVertexQuantizationError() const { return QuantizationError; }
+
+private:
+	struct FrameConstantBufferData
+	{
+		Float4 WorldLightPosition;
+	};
+
+	struct ViewConstantBufferData
+	{
+		Float4 WorldCameraPosition;
+	};
+
+	// Padded to one constant buffer range
+	struct ObjectConstantBufferData
+	{
+		ObjectMatrices Matrices;
+		Float4 Color;
+		Float4 Padding[5];
+	};
+	static_assert(sizeof(ObjectConstantBufferData) == CONSTANT_BUFFER_ALIGNMENT, "ObjectConstantBufferData must fill one range");
+
+	// What a frame needs of the simulation
+	struct SimulationState
+	{
+		Float3 CameraPosition;
+		Float3 CameraForward;
+		Float3 CameraUp;
+		float ObjectRotationAngle;
+	};
+
+	// Published after every step: the states before and after it, and when it was published
+	struct SimulationSnapshot
+	{
+		SimulationState Previous;
+		SimulationState Current;
+		float DeltaTime;
+		uint64_t Ticks;
+	};
+
+	// Advances SceneCamera and ObjectRotationAngle and publishes the snapshot
+	void SimulateStep(float deltaTime, const InputState& input);
+	SimulationState GetSimulationState() const;
+
+	// Stages of Update, in the order they are added to UpdateGraph
+	void BuildUpdateGraph();
+	void SpinObjects();
+	void CullObjects();
+	void SelectLods();
+	void CullOccludedObjects();
+	void SortObjects();
+	void CullMeshlets();
+	void ComputeMatrices();
+
+	void RenderInstanced();
+	void RenderPerObject();
+
+	// Binds everything the per-object draws need, every frame on the immediate context, where the state filter drops what is
+	// bound already, and on every command list, which starts with nothing bound
+	void BindPerObjectState(RenderContext& context, bool bMeshletIndices);
+
+	// Binds the object constants and draws the visible objects [begin, end). Their constants were written from object first
+	// on at constantOffset of the ring buffer. Switches to the whole levels at MeshletObjectCount when bMeshletIndicesBound.
+	void DrawObjects(RenderContext& context, uint32_t begin, uint32_t end, uint32_t first, uint32_t constantOffset, bool bMeshletIndicesBound);
+
+	// Draws of objects [first, first + objectCount) recorded in parallel, one list per COMMAND_LIST_OBJECT_COUNT objects
+	void RecordObjectCommandLists(uint32_t first, uint32_t objectCount, uint32_t constantOffset, bool bMeshletIndicesBound);
+
+	// Uploads the compacted indices to MeshletIndexOffset, returns false when no object has any meshlet left
+	bool UploadMeshletIndices();
+
+	RenderDevice* Device = nullptr;
+	int32_t Width = 0;
+	int32_t Height = 0;
+
+	BufferHandle VertexBuffer;
+	BufferHandle IndexBuffer;
+	BufferHandle InstanceBuffer;
+	BufferHandle FrameConstantBuffer;
+	BufferHandle ViewConstantBuffer;
+	BufferHandle MeshConstantBuffer;
+	DynamicRingBuffer ObjectConstantRingBuffer;
+	InputLayoutHandle InputLayout;
+	InputLayoutHandle PerObjectInputLayout;
+	VertexShaderHandle VertexShader;
+	VertexShaderHandle PerObjectVertexShader;
+	PixelShaderHandle PixelShader;
+	RasterizerStateHandle SolidRasterizerState;
+	RasterizerStateHandle WireframeRasterizerState;
+	RasterizerStateHandle CurrentRasterizerState;
+	DepthStencilStateHandle DepthStencilState;
+	BlendStateHandle BlendState;
+	std::vector<MeshLod> Lods;
+	MeshOptimizationStats MeshStats{};
+
+	uint32_t InstanceCount;
+	bool bInstancing;
+	TransformArrays Transforms;
+	std::vector<Float4> Colors;
+	SphereBoundsArrays Bounds;
+
+	// The closest visible objects are drawn as occluders into a small CPU depth buffer, and objects behind them are dropped
+	uint32_t OccluderBudget;
+	OccluderMesh Occluder;
+	OcclusionCuller Occlusion;
+	std::vector<uint32_t> OccluderCandidates;
+
+	// Vertices are quantized into the whole SNORM16 range of the bounds of the LOD chain
+	bool bQuantizedVertices;
+	VertexQuantizationError QuantizationError{};
+
+	// Meshlets of the levels up to MESHLET_MAX_LOD, loaded from Meshes. Their ranges are copied from Meshes.MeshletIndices.
+	bool bMeshletCulling;
+	std::vector<MeshletMesh> LodMeshlets;
+	MeshletCuller Meshlets;
+	DynamicRingBuffer MeshletIndexRingBuffer;
+	uint32_t MeshletIndexOffset = 0;
+
+	// The first MeshletObjectCount visible objects are drawn from the compacted indices, with MeshletDraws[i] for the i-th
+	uint32_t MeshletObjectCount = 0;
+	std::vector<MeshletDraw> MeshletDraws;
+
+	// Meshes points into MeshFile when it is open, or into GeneratedMeshes
+	const char* MeshCacheFileName;
+	MeshCache MeshFile;
+	MeshCacheData GeneratedMeshes;
+	MeshCacheView Meshes{};
+
+	// Icospheres rather than UV spheres for every level of detail
+	bool bIcosphere;
+
+	// Update stages and what they share within a frame
+	uint32_t UpdateThreadCount;
+	JobSystem Jobs;
+	JobGraph UpdateGraph;
+	Float4x4 ViewProjectionMatrix = MatrixIdentity();
+	Frustum ViewFrustum{};
+	float ObjectRotationSin = 0.0f;
+	float ObjectRotationCos = 1.0f;
+	std::vector<uint32_t> BatchVisibleCounts;
+
+	// Level of detail of every object, kept between frames for the hysteresis
+	LodSelector LodSelection;
+	float ProjectionScale = 0.0f;
+
+	// Objects that intersect the view frustum and are not occluded this frame. Instances or ObjectConstants hold only these, in the same order.
+	std::vector<uint32_t> VisibleIndices;
+	uint32_t VisibleCount = 0;
+
+	// VisibleIndices are sorted by their draw keys. Shader and state are the same for every object of a frame, so that
+	// leaves them by level, most detailed first with LodObjectCounts objects per level, and front to back inside a level.
+	std::vector<uint64_t> DrawKeys;
+	RadixSorter DrawSorter;
+	DrawSortStats FrameDrawSortStats{};
+	uint32_t LodObjectCounts[MAX_LOD_COUNT]{};
+	LodStats FrameLodStats{};
+	TransformArrays VisibleTransforms;
+	std::vector<InstanceData> Instances;
+	std::vector<ObjectConstantBufferData> ObjectConstants;
+
+	// Last written contents of the frame and view constant buffers
+	FrameConstantBufferData FrameConstants{};
+	ViewConstantBufferData ViewConstants{};
+
+	// Simulation state, only touched by whoever runs the steps
+	float ObjectRotationAngle = 0.0f;
+	Camera SceneCamera;
+	SimulationState LastSimulationState{};
+
+	// Snapshots from the steps to Update, and with bSimulationThread the input from Update to the steps
+	bool bSimulationThread;
+	TripleBuffer<SimulationSnapshot> Snapshots;
+	TripleBuffer<InputState> SimulationInputs;
+
+	// Lists for the per-object draws of one ring buffer write, recorded by the update threads
+	bool bCommandLists;
+	std::vector<CommandList*> ObjectCommandLists;
+	CommandListStats FrameCommandListStats{};
+
+	// Camera position of the frame, interpolated between the last two simulation states with bSimulationThread
+	Float3 ViewPosition{};
+
+	Float4x4 ProjectionMatrix = MatrixIdentity();
+};
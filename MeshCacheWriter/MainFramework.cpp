@@ -0,0 +1,245 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+#include "../Common/Clock.h"
+#include "../Common/MeshCache.h"
+#include "../Common/MeshImporter.h"
+#include "../Common/MeshSimplifier.h"
+#include "../Common/ThreadPool.h"
+#include "../Lighting/LightingScene.h"
+
+namespace
+{
+	// Levels written by --import without --lods, and the most that --lods takes
+	constexpr uint32_t DEFAULT_IMPORT_LOD_COUNT = 1;
+	constexpr uint32_t MAX_IMPORT_LOD_COUNT = 8;
+
+	// Every generated level keeps this fraction of the triangles of the one before
+	constexpr float IMPORT_LOD_TRIANGLE_RATIO = 0.25f;
+}
+
+bool ImportMeshes(const char* sourceFileName, uint32_t lodCount, MeshCacheData& outMeshes);
+void AppendSimplifiedLod(const ImportedMesh& mesh, uint32_t targetIndexCount, ThreadPool& threadPool, MeshCacheData& outMeshes);
+bool WriteAndVerify(const char* fileName, uint64_t sourceKey, const MeshCacheData& meshes, bool bCompress, uint64_t& outFileSize,
+	double& outWriteMilliseconds);
+bool IsSameMeshes(const MeshCacheView& meshes, const MeshCacheView& referenceMeshes);
+
+// Generates the meshes of the samples, or imports an asset, and writes them into a cache file that is mapped at startup
+int main(int argc, char** argv)
+{
+	const bool bImport = argc >= 3 && !strcmp(argv[1], "--import");
+	uint32_t lodCount = DEFAULT_IMPORT_LOD_COUNT;
+	bool bCompress = false;
+	const char* outputFileName = nullptr;
+	bool bValidArguments = true;
+	for (int i = bImport ? 3 : 1; i < argc && bValidArguments; ++i)
+	{
+		if (!strcmp(argv[i], "--compress"))
+		{
+			bCompress = true;
+		}
+		else if (bImport && !strcmp(argv[i], "--lods") && i + 1 < argc)
+		{
+			lodCount = (uint32_t)strtoul(argv[++i], nullptr, 10);
+			bValidArguments = lodCount >= 1 && lodCount <= MAX_IMPORT_LOD_COUNT;
+		}
+		else
+		{
+			bValidArguments = !outputFileName && argv[i][0] != '-';
+			outputFileName = argv[i];
+		}
+	}
+	if (!bValidArguments)
+	{
+		printf("Usage: %s [--compress] [output.mesh]\n", argv[0]);
+		printf("       %s --import model.obj|model.gltf|model.glb [--lods N] [--compress] [output.mesh]\n", argv[0]);
+		printf("Writes the Lighting meshes, %s by default. Copy the file next to Lighting.hlsl.\n", LIGHTING_MESH_CACHE_FILE_NAME);
+		printf("With --import, writes the mesh of an OBJ or glTF file, model.mesh by default. --lods adds simplified levels up to %u in all,\n",
+			MAX_IMPORT_LOD_COUNT);
+		printf("each with %.0f%% of the triangles of the one before.\n", IMPORT_LOD_TRIANGLE_RATIO * 100.0f);
+		printf("--compress stores the vertices and indices encoded, decoded when the file is opened.\n");
+		return 1;
+	}
+
+	std::string fileName = LIGHTING_MESH_CACHE_FILE_NAME;
+	uint64_t sourceKey = LightingScene::GetMeshCacheKey();
+	MeshCacheData meshes;
+	const uint64_t generateTicks = Clock::GetTicks();
+	if (bImport)
+	{
+		const char* sourceFileName = argv[2];
+		const char* extension = strrchr(sourceFileName, '.');
+		fileName = outputFileName ? std::string(outputFileName)
+			: std::string(sourceFileName, extension ? extension : sourceFileName + strlen(sourceFileName)) + ".mesh";
+		sourceKey = ComputeImportedMeshCacheKey(sourceFileName);
+		if (!ImportMeshes(sourceFileName, lodCount, meshes))
+		{
+			return 1;
+		}
+	}
+	else
+	{
+		// Both vertex streams are written, so one file serves the samples with and without --quantized-vertices
+		if (outputFileName)
+		{
+			fileName = outputFileName;
+		}
+		LightingScene::GenerateMeshes(true, meshes);
+		LightingScene::GenerateMeshlets(meshes);
+	}
+	const double generateMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - generateTicks);
+
+	uint64_t fileSize = 0;
+	double writeMilliseconds = 0.0;
+	if (!WriteAndVerify(fileName.c_str(), sourceKey, meshes, bCompress, fileSize, writeMilliseconds))
+	{
+		return 1;
+	}
+
+	const MeshCacheView view = meshes.GetView();
+	printf("%s: %llu bytes    %u vertices    %u indices (%u-bit)    %u levels    %u meshlets    %s: %.3f ms    write: %.3f ms\n", fileName.c_str(),
+		(unsigned long long)fileSize, view.VertexCount, view.IndexCount, view.IndexFormat == INDEX_FORMAT_UINT16 ? 16 : 32, view.LodCount,
+		view.MeshletCount, bImport ? "import" : "generate", generateMilliseconds, writeMilliseconds);
+
+	return 0;
+}
+
+// Imports on every hardware thread and reports the throughput, simplifies the other levels from the imported mesh, then
+// optimizes every level with both vertex streams
+bool ImportMeshes(const char* sourceFileName, uint32_t lodCount, MeshCacheData& outMeshes)
+{
+	ThreadPool threadPool;
+	threadPool.Init(0);
+
+	ImportedMesh mesh;
+	MeshImportStats stats;
+	if (!ImportMesh(sourceFileName, mesh, &threadPool, &stats))
+	{
+		printf("Failed to import %s: %s\n", sourceFileName, stats.Error);
+		return false;
+	}
+
+	printf("%s: %.2f MB    %u threads    %u tasks    map: %.3f ms    parse: %.3f ms    weld: %.3f ms    total: %.3f ms    %.1f MB/s    peak memory: %.1f MB\n",
+		sourceFileName, stats.FileSize / (1024.0 * 1024.0), stats.ThreadCount, stats.TaskCount, stats.MapMilliseconds, stats.ParseMilliseconds,
+		stats.WeldMilliseconds, stats.TotalMilliseconds, stats.GetThroughput(), stats.PeakMemory / (1024.0 * 1024.0));
+	printf("%llu source vertices    %llu corners    welded into %u vertices    %u triangles    %u generated normals\n", (unsigned long long)stats.SourceVertexCount,
+		(unsigned long long)stats.CornerCount, stats.VertexCount, stats.TriangleCount, stats.GeneratedNormalCount);
+
+	const uint32_t vertexCount = (uint32_t)mesh.Vertices.size();
+	const uint32_t indexCount = mesh.Indices.GetCount();
+	outMeshes.Vertices.assign(mesh.Vertices.begin(), mesh.Vertices.end());
+	outMeshes.Indices = mesh.Indices;
+	outMeshes.Lods.assign(1, MeshLod{ 0, indexCount, 0, vertexCount });
+
+	// Every level is simplified from the imported mesh rather than from the level before, so the errors do not add up
+	float triangleRatio = 1.0f;
+	for (uint32_t lod = 1; lod < lodCount; ++lod)
+	{
+		triangleRatio *= IMPORT_LOD_TRIANGLE_RATIO;
+		AppendSimplifiedLod(mesh, (uint32_t)(indexCount / 3 * triangleRatio) * 3, threadPool, outMeshes);
+	}
+
+	for (uint32_t lod = 0; lod < (uint32_t)outMeshes.Lods.size(); ++lod)
+	{
+		const MeshLod& meshLod = outMeshes.Lods[lod];
+		MeshOptimizationStats optimizationStats;
+		OptimizeMesh(outMeshes.Vertices.data() + meshLod.BaseVertex, meshLod.VertexCount, sizeof(VertexData), outMeshes.Indices, meshLod.StartIndex,
+			meshLod.IndexCount, &optimizationStats);
+		printf("LOD %u: %u vertices    %u triangles    ACMR: %.3f -> %.3f\n", lod, meshLod.VertexCount, meshLod.IndexCount / 3,
+			optimizationStats.Before.GetAcmr(), optimizationStats.After.GetAcmr());
+	}
+
+	const uint32_t totalVertexCount = (uint32_t)outMeshes.Vertices.size();
+	outMeshes.Quantization = ComputeVertexQuantization(outMeshes.Vertices.data(), totalVertexCount, sizeof(VertexData));
+	outMeshes.QuantizedVertices.resize(totalVertexCount);
+	QuantizeVertices(outMeshes.Vertices.data(), totalVertexCount, outMeshes.Quantization, outMeshes.QuantizedVertices.data());
+	outMeshes.QuantizationError = MeasureQuantizationError(outMeshes.Vertices.data(), outMeshes.QuantizedVertices.data(), totalVertexCount,
+		outMeshes.Quantization);
+	return true;
+}
+
+// Simplifies the imported mesh and appends the vertices it still uses as a level of its own, in the index format of the mesh
+void AppendSimplifiedLod(const ImportedMesh& mesh, uint32_t targetIndexCount, ThreadPool& threadPool, MeshCacheData& outMeshes)
+{
+	const uint32_t vertexCount = (uint32_t)mesh.Vertices.size();
+	MeshIndices indices;
+	MeshSimplificationStats stats;
+	SimplifyMesh(mesh.Vertices.data(), vertexCount, sizeof(VertexData), mesh.Indices, 0, mesh.Indices.GetCount(), targetIndexCount, indices,
+		VERTEX_DATA_SIMPLIFY_ATTRIBUTES, FLT_MAX, &threadPool, &stats);
+	printf("Simplified to %u of %u triangles (target %u)    %u passes    error: %g    quadrics: %.3f ms    collapses: %.3f ms    %.2f Mtriangles/s\n",
+		stats.TriangleCount, stats.SourceTriangleCount, targetIndexCount / 3, stats.PassCount, stats.Error, stats.QuadricMilliseconds,
+		stats.CollapseMilliseconds, stats.GetTrianglesPerSecond() / 1000000.0);
+
+	// The level indexes a subset of the imported vertices, which OptimizeVertexFetch moves to the front of a copy
+	std::vector<VertexData> vertices(mesh.Vertices);
+	const uint32_t lodIndexCount = indices.GetCount();
+	const uint32_t usedVertexCount = indices.Format == INDEX_FORMAT_UINT16
+		? OptimizeVertexFetch(vertices.data(), vertexCount, sizeof(VertexData), indices.Indices16.data(), lodIndexCount)
+		: OptimizeVertexFetch(vertices.data(), vertexCount, sizeof(VertexData), indices.Indices32.data(), lodIndexCount);
+
+	outMeshes.Lods.push_back(MeshLod{ outMeshes.Indices.GetCount(), lodIndexCount, (int32_t)outMeshes.Vertices.size(), usedVertexCount });
+	outMeshes.Vertices.insert(outMeshes.Vertices.end(), vertices.begin(), vertices.begin() + usedVertexCount);
+	if (indices.Format == INDEX_FORMAT_UINT16)
+	{
+		outMeshes.Indices.Indices16.insert(outMeshes.Indices.Indices16.end(), indices.Indices16.begin(), indices.Indices16.end());
+	}
+	else
+	{
+		outMeshes.Indices.Indices32.insert(outMeshes.Indices.Indices32.end(), indices.Indices32.begin(), indices.Indices32.end());
+	}
+}
+
+bool WriteAndVerify(const char* fileName, uint64_t sourceKey, const MeshCacheData& meshes, bool bCompress, uint64_t& outFileSize,
+	double& outWriteMilliseconds)
+{
+	const uint64_t writeTicks = Clock::GetTicks();
+	if (!WriteMeshCache(fileName, sourceKey, meshes.GetView(), bCompress))
+	{
+		printf("Failed to write %s\n", fileName);
+		return false;
+	}
+	outWriteMilliseconds = Clock::TicksToMilliseconds(Clock::GetTicks() - writeTicks);
+
+	// Read the file back the way the samples do
+	MeshCache cache;
+	if (!cache.Open(fileName, sourceKey) || !IsSameMeshes(cache.GetView(), meshes.GetView()))
+	{
+		printf("%s does not read back as written\n", fileName);
+		return false;
+	}
+	outFileSize = cache.GetFileSize();
+
+	// Vertex streams and both index orders against their encoded sections, the levels and meshlets stay as they are
+	if (cache.IsCompressed())
+	{
+		const MeshCacheView view = cache.GetView();
+		const MeshCacheSection* sections = cache.GetHeader().Sections;
+		const uint64_t rawSize = (uint64_t)view.VertexCount * (sizeof(VertexData) + (view.QuantizedVertices ? sizeof(QuantizedVertexData) : 0))
+			+ (uint64_t)view.IndexCount * view.GetIndexSize() * (view.MeshletIndices ? 2 : 1);
+		const uint64_t encodedSize = sections[MESH_CACHE_SECTION_VERTICES].Size + sections[MESH_CACHE_SECTION_QUANTIZED_VERTICES].Size
+			+ sections[MESH_CACHE_SECTION_INDICES].Size + sections[MESH_CACHE_SECTION_MESHLET_INDICES].Size;
+		const double decodeMilliseconds = cache.GetDecodeMilliseconds();
+		printf("Compressed %llu into %llu bytes    ratio: %.2f    decode: %.3f ms    %.1f MB/s\n", (unsigned long long)rawSize,
+			(unsigned long long)encodedSize, (double)rawSize / encodedSize, decodeMilliseconds,
+			decodeMilliseconds > 0.0 ? rawSize / (1024.0 * 1024.0) / (decodeMilliseconds / 1000.0) : 0.0);
+	}
+	return true;
+}
+
+bool IsSameMeshes(const MeshCacheView& meshes, const MeshCacheView& referenceMeshes)
+{
+	return meshes.VertexCount == referenceMeshes.VertexCount && meshes.IndexFormat == referenceMeshes.IndexFormat
+		&& meshes.IndexCount == referenceMeshes.IndexCount && meshes.LodCount == referenceMeshes.LodCount
+		&& !memcmp(meshes.Vertices, referenceMeshes.Vertices, meshes.VertexCount * sizeof(VertexData))
+		&& !memcmp(meshes.QuantizedVertices, referenceMeshes.QuantizedVertices, meshes.VertexCount * sizeof(QuantizedVertexData))
+		&& !memcmp(meshes.Indices, referenceMeshes.Indices, (size_t)meshes.IndexCount * meshes.GetIndexSize())
+		&& !memcmp(meshes.Lods, referenceMeshes.Lods, meshes.LodCount * sizeof(MeshLod))
+		&& meshes.MeshletLodCount == referenceMeshes.MeshletLodCount && meshes.MeshletCount == referenceMeshes.MeshletCount
+		&& (!meshes.MeshletIndices || !memcmp(meshes.MeshletIndices, referenceMeshes.MeshletIndices, (size_t)meshes.IndexCount * meshes.GetIndexSize()))
+		&& !memcmp(meshes.MeshletLodCounts, referenceMeshes.MeshletLodCounts, meshes.MeshletLodCount * sizeof(uint32_t))
+		&& !memcmp(meshes.Meshlets, referenceMeshes.Meshlets, meshes.MeshletCount * sizeof(MeshletRecord));
+}